@@ -9,6 +9,8 @@ Copyright Glare Technologies Limited 2026 -
 #include "../meshoptimizer/src/meshoptimizer.h"
 #include "../utils/InStream.h"
 #include "../utils/RandomAccessInStream.h"
+#include "../utils/BufferViewInStream.h"
+#include "../utils/BufferInStream.h"
 #include "../utils/OutStream.h"
 #include "../utils/Exception.h"
 #include "../utils/StringUtils.h"
@@ -37,14 +39,25 @@ void AnimationNodeData::writeToStream(OutStream& stream) const
 }
 
 
+// Reads the node data.  Templated on the stream type so that reads from the concrete buffer streams are non-virtual.
+template <class StreamType>
+static void readAnimationNodeData(StreamType& stream, AnimationNodeData& node)
+{
+	// Read inverse_bind_matrix, trans, rot and scale with a single read, so there is only one bounds check.
+	float fixed_data[16 + 4 * 3];
+	stream.readData(fixed_data, sizeof(fixed_data));
+	std::memcpy(node.inverse_bind_matrix.e, &fixed_data[0],  sizeof(float) * 16);
+	std::memcpy(&node.trans.x,              &fixed_data[16], sizeof(float) * 4);
+	std::memcpy(&node.rot.v.x,              &fixed_data[20], sizeof(float) * 4);
+	std::memcpy(&node.scale.x,              &fixed_data[24], sizeof(float) * 4);
+	node.name = stream.readStringLengthFirst(10000);
+	node.parent_index = stream.readInt32();
+}
+
+
 void AnimationNodeData::readFromStream(InStream& stream)
 {
-	stream.readData(inverse_bind_matrix.e, sizeof(float) * 16);
-	stream.readData(trans.x, sizeof(float) * 4);
-	stream.readData(rot.v.x, sizeof(float) * 4);
-	stream.readData(scale.x, sizeof(float) * 4);
-	name = stream.readStringLengthFirst(10000);
-	parent_index = stream.readInt32();
+	readAnimationNodeData(stream, *this);
 }
 
 
@@ -59,14 +72,13 @@ void PerAnimationNodeData::writeToStream(OutStream& stream) const
 }
 
 
+// PerAnimationNodeData is serialised as 6 consecutive int32s, which is the same as its in-memory layout, so it can be read with a single readData call.
+static_assert(sizeof(PerAnimationNodeData) == sizeof(int32) * 6, "sizeof(PerAnimationNodeData) == sizeof(int32) * 6");
+
+
 void PerAnimationNodeData::readFromStream(InStream& stream)
 {
-	translation_input_accessor	= stream.readInt32();
-	translation_output_accessor	= stream.readInt32();
-	rotation_input_accessor		= stream.readInt32();
-	rotation_output_accessor	= stream.readInt32();
-	scale_input_accessor		= stream.readInt32();
-	scale_output_accessor		= stream.readInt32();
+	stream.readData(this, sizeof(PerAnimationNodeData));
 }
 
 
@@ -81,18 +93,18 @@ void AnimationDatum::writeToStream(OutStream& stream) const
 }
 
 
-void AnimationDatum::readFromStream(uint32 file_version, InStream& stream, js::Vector<KeyFrameTimeInfo>& old_keyframe_times_out, js::Vector<js::Vector<Vec4f, 16> >& old_output_data)
+template <class StreamType>
+static void readAnimationDatum(uint32 file_version, StreamType& stream, AnimationDatum& datum, js::Vector<KeyFrameTimeInfo>& old_keyframe_times_out, js::Vector<js::Vector<Vec4f, 16> >& old_output_data)
 {
-	name = stream.readStringLengthFirst(10000);
+	datum.name = stream.readStringLengthFirst(10000);
 
 	// Read raw_per_anim_node_data
 	{
 		const uint32 num = stream.readUInt32();
 		if(num > 100000)
 			throw glare::Exception("invalid num");
-		raw_per_anim_node_data.resize(num);
-		for(size_t i=0; i<raw_per_anim_node_data.size(); ++i)
-			raw_per_anim_node_data[i].readFromStream(stream);
+		datum.raw_per_anim_node_data.resize(num);
+		stream.readData(datum.raw_per_anim_node_data.data(), sizeof(PerAnimationNodeData) * datum.raw_per_anim_node_data.size()); // Read all with a single bounds check.  See static_assert above.
 	}
 
 	// Read keyframe_times
@@ -133,10 +145,40 @@ void AnimationDatum::readFromStream(uint32 file_version, InStream& stream, js::V
 }
 
 
-void AnimationDatum::checkData(const js::Vector<KeyFrameTimeInfo>& shared_keyframe_times, const js::Vector<js::Vector<Vec4f, 16> >& shared_output_data) const
+void AnimationDatum::readFromStream(uint32 file_version, InStream& stream, js::Vector<KeyFrameTimeInfo>& old_keyframe_times_out, js::Vector<js::Vector<Vec4f, 16> >& old_output_data)
+{
+	readAnimationDatum(file_version, stream, *this, old_keyframe_times_out, old_output_data);
+}
+
+
+// Returns the number of values of each output accessor, whether the output data is compressed or not.
+static void getOutputDataSizes(const js::Vector<js::Vector<Vec4f, 16> >& output_data, const js::Vector<CompressedOutputTrack, 16>& compressed_output_data, std::vector<size_t>& sizes_out)
+{
+	if(!compressed_output_data.empty())
+	{
+		sizes_out.resize(compressed_output_data.size());
+		for(size_t i=0; i<compressed_output_data.size(); ++i)
+			sizes_out[i] = compressed_output_data[i].num_values;
+	}
+	else
+	{
+		sizes_out.resize(output_data.size());
+		for(size_t i=0; i<output_data.size(); ++i)
+			sizes_out[i] = output_data[i].size();
+	}
+}
+
+
+void AnimationDatum::checkData(const js::Vector<KeyFrameTimeInfo>& shared_keyframe_times, const js::Vector<js::Vector<Vec4f, 16> >& shared_output_data, 
+	const js::Vector<CompressedOutputTrack, 16>& shared_compressed_output_data) const
 {
 	const js::Vector<KeyFrameTimeInfo>&       keyframe_times = (!m_keyframe_times.empty()) ? m_keyframe_times : shared_keyframe_times;
-	const js::Vector<js::Vector<Vec4f, 16> >& output_data    = (!m_output_data.empty())    ? m_output_data    : shared_output_data;
+
+	std::vector<size_t> output_data_sizes;
+	if(!m_output_data.empty() || !m_compressed_output_data.empty())
+		getOutputDataSizes(m_output_data, m_compressed_output_data, output_data_sizes);
+	else
+		getOutputDataSizes(shared_output_data, shared_compressed_output_data, output_data_sizes);
 
 	// Bounds-check data
 	for(size_t i=0; i<raw_per_anim_node_data.size(); ++i)
@@ -147,9 +189,9 @@ void AnimationDatum::checkData(const js::Vector<KeyFrameTimeInfo>& shared_keyfra
 		checkProperty(data.rotation_input_accessor     >= -1 && data.rotation_input_accessor      < (int)keyframe_times.size(), "invalid input accessor index");
 		checkProperty(data.scale_input_accessor        >= -1 && data.scale_input_accessor         < (int)keyframe_times.size(), "invalid input accessor index");
 
-		checkProperty(data.translation_output_accessor >= -1 && data.translation_output_accessor  < (int)output_data.size(), "invalid output accessor index");
-		checkProperty(data.rotation_output_accessor    >= -1 && data.rotation_output_accessor     < (int)output_data.size(), "invalid output accessor index");
-		checkProperty(data.scale_output_accessor       >= -1 && data.scale_output_accessor        < (int)output_data.size(), "invalid output accessor index");
+		checkProperty(data.translation_output_accessor >= -1 && data.translation_output_accessor  < (int)output_data_sizes.size(), "invalid output accessor index");
+		checkProperty(data.rotation_output_accessor    >= -1 && data.rotation_output_accessor     < (int)output_data_sizes.size(), "invalid output accessor index");
+		checkProperty(data.scale_output_accessor       >= -1 && data.scale_output_accessor        < (int)output_data_sizes.size(), "invalid output accessor index");
 
 		if(data.translation_input_accessor >= 0) checkProperty(keyframe_times[data.translation_input_accessor].times.size() >= 1, "invalid num keyframes");
 		if(data.rotation_input_accessor    >= 0) checkProperty(keyframe_times[data.rotation_input_accessor   ].times.size() >= 1, "invalid num keyframes");
@@ -159,17 +201,17 @@ void AnimationDatum::checkData(const js::Vector<KeyFrameTimeInfo>& shared_keyfra
 		if(data.translation_input_accessor >= 0)
 		{
 			checkProperty(data.translation_output_accessor >= 0, "invalid output_accessor, must be >= 0 for >= 0 input accessor.");
-			checkProperty(keyframe_times[data.translation_input_accessor].times.size() == output_data[data.translation_output_accessor].size(), "num keyframes != output_data size");
+			checkProperty(keyframe_times[data.translation_input_accessor].times.size() == output_data_sizes[data.translation_output_accessor], "num keyframes != output_data size");
 		}
 		if(data.rotation_input_accessor    >= 0)
 		{
 			checkProperty(data.rotation_output_accessor >= 0, "invalid output_accessor, must be >= 0 for >= 0 input accessor.");
-			checkProperty(keyframe_times[data.rotation_input_accessor   ].times.size() == output_data[data.rotation_output_accessor   ].size(), "num keyframes != output_data size");
+			checkProperty(keyframe_times[data.rotation_input_accessor   ].times.size() == output_data_sizes[data.rotation_output_accessor   ], "num keyframes != output_data size");
 		}
 		if(data.scale_input_accessor       >= 0)
 		{
 			checkProperty(data.scale_output_accessor >= 0, "invalid output_accessor, must be >= 0 for >= 0 input accessor.");
-			checkProperty(keyframe_times[data.scale_input_accessor      ].times.size() == output_data[data.scale_output_accessor      ].size(), "num keyframes != output_data size");
+			checkProperty(keyframe_times[data.scale_input_accessor      ].times.size() == output_data_sizes[data.scale_output_accessor      ], "num keyframes != output_data size");
 		}
 	}
 }
@@ -188,10 +230,19 @@ size_t AnimationDatum::getTotalMemUsage() const
 	for(size_t i=0; i<m_output_data.size(); ++i)
 		sum += m_output_data[i].capacitySizeBytes();
 
+	for(size_t i=0; i<m_compressed_output_data.size(); ++i)
+		sum += m_compressed_output_data[i].getTotalMemUsage();
+
 	return sum;
 }
 
 
+size_t CompressedOutputTrack::getTotalMemUsage() const
+{
+	return sizeof(CompressedOutputTrack) + quantised.capacitySizeBytes() + full_values.capacitySizeBytes();
+}
+
+
 static const uint32 ANIMATION_DATA_VERSION = 4;
 // Version 3: Added serialisation of vrm_data if present
 // Version 4: Added compression of quaternions.  Removed old_skeleton_root_transform serialisation.
@@ -205,6 +256,9 @@ void AnimationData::writeToStream(OutStream& stream) const
 {
 	ZoneScoped; // Tracy profiler
 
+	if(isOutputDataCompressed())
+		throw glare::Exception("Can't write animation data with compressed output data.");
+
 	stream.writeUInt32(ANIMATION_DATA_VERSION);
 
 	// Write nodes
@@ -317,6 +371,19 @@ void AnimationData::readFromStream(RandomAccessInStream& stream)
 {
 	ZoneScoped; // Tracy profiler
 
+	// Use the non-virtual, inlined read methods if the stream is one of the concrete buffer stream types.
+	if(BufferViewInStream* buffer_view_stream = dynamic_cast<BufferViewInStream*>(&stream))
+		readFromStreamImpl(*buffer_view_stream);
+	else if(BufferInStream* buffer_stream = dynamic_cast<BufferInStream*>(&stream))
+		readFromStreamImpl(*buffer_stream);
+	else
+		readFromStreamImpl(stream);
+}
+
+
+template <class StreamType>
+void AnimationData::readFromStreamImpl(StreamType& stream)
+{
 	const uint32 version = stream.readUInt32();
 	if(version > ANIMATION_DATA_VERSION)
 		throw glare::Exception("Invalid animation data version: " + toString(version));
@@ -334,7 +401,7 @@ void AnimationData::readFromStream(RandomAccessInStream& stream)
 			throw glare::Exception("invalid num nodes: " + toString(num));
 		nodes.resize(num);
 		for(size_t i=0; i<nodes.size(); ++i)
-			nodes[i].readFromStream(stream);
+			readAnimationNodeData(stream, nodes[i]);
 	}
 
 	// Read sorted_nodes
@@ -478,7 +545,7 @@ void AnimationData::readFromStream(RandomAccessInStream& stream)
 			js::Vector<KeyFrameTimeInfo> old_keyframe_times;
 			js::Vector<js::Vector<Vec4f, 16> > old_output_data;
 
-			animations[i]->readFromStream(version, stream, old_keyframe_times, old_output_data);
+			readAnimationDatum(version, stream, *animations[i], old_keyframe_times, old_output_data);
 
 			// Do backwards-compat handling
 			if(version == 1)
@@ -501,7 +568,7 @@ void AnimationData::readFromStream(RandomAccessInStream& stream)
 				}
 			}
 
-			animations[i]->checkData(keyframe_times, output_data);
+			animations[i]->checkData(keyframe_times, output_data, compressed_output_data);
 		}
 	}
 
@@ -839,6 +906,7 @@ void AnimationData::prepareForMultipleUse()
 	runtimeCheck(animations.size() > 0);
 	animations[0]->m_keyframe_times.takeFrom(keyframe_times);
 	animations[0]->m_output_data   .takeFrom(output_data);
+	animations[0]->m_compressed_output_data.takeFrom(compressed_output_data);
 }
 
 
@@ -910,6 +978,7 @@ void AnimationData::operator =(const AnimationData& other)
 	joint_nodes = other.joint_nodes;
 	keyframe_times = other.keyframe_times;
 	output_data = other.output_data;
+	compressed_output_data = other.compressed_output_data;
 
 	animations = other.animations; // Note: shallow copy.
 
@@ -972,7 +1041,7 @@ void AnimationData::checkDataIsValid() const
 	for(size_t a=0; a<animations.size(); ++a)
 	{
 		const AnimationDatum* datum = animations[a].ptr();
-		datum->checkData(this->keyframe_times, this->output_data);
+		datum->checkData(this->keyframe_times, this->output_data, this->compressed_output_data);
 	}
 }
 
@@ -1470,6 +1539,7 @@ void AnimationData::loadAndRetargetAnim(const AnimationData& other)
 	this->joint_nodes = other.joint_nodes;
 	this->keyframe_times = other.keyframe_times;
 	this->output_data = other.output_data;
+	this->compressed_output_data = other.compressed_output_data;
 	this->animations = other.animations;
 	this->per_anim_node_data = other.per_anim_node_data;
 	this->vrm_data = other.vrm_data;
@@ -1954,6 +2024,480 @@ Vec4f AnimationData::getNodePositionModelSpace(const std::string& name, bool use
 }
 
 
+// For each input accessor that the animation uses, we have an array of keyframe times.
+// For each such array, find the current and next keyframe, and interpolation fraction, based on the current time.
+// Store in a AnimationKeyFrameLocation in key_frame_locs.
+//
+// We are doing 2 important optimisations here:
+// The first is that many nodes in a skeleton may use the same input accessor.  We don't want to search the keyframe times for the correct keyframe every time
+// the input accessor is used by a node, so we do the search once for the input accessor, and store the results in key_frame_locs.
+//
+// The second optimisation is that a particular animation may only use 1 or a few input accessors.
+// For example the avatar idle animation only uses input accessor 9, and there are 33 input accessors in total.
+// So for the idle animation we only need to do the keyframe search for input accessor 9, not the 32 other accessors.
+static void computeKeyFrameLocations(const js::Vector<KeyFrameTimeInfo>& keyframe_times, const AnimationDatum& anim_datum, float in_anim_time, AnimationKeyFrameLocation* key_frame_locs)
+{
+	for(size_t q=0; q<anim_datum.used_input_accessor_indices.size(); ++q)
+	{
+		const int input_accessor_i = anim_datum.used_input_accessor_indices[q];
+
+		const KeyFrameTimeInfo& keyframe_time_info = keyframe_times[input_accessor_i];
+		assert(keyframe_time_info.times_size == (int)keyframe_time_info.times.size());
+
+		AnimationKeyFrameLocation& key_frame_loc = key_frame_locs[input_accessor_i];
+
+		// If keyframe times are equally spaced, we can skip the binary search stuff, and just compute the keyframes we are between directly.
+		if(keyframe_time_info.equally_spaced && (keyframe_time_info.t_back == anim_datum.anim_len))
+		{
+			if(in_anim_time < keyframe_time_info.t_0)
+			{
+				key_frame_loc.i_0 = 0;
+				key_frame_loc.i_1 = 0;
+				key_frame_loc.frac = 0;
+			}
+			else
+			{
+				const float t_minus_t_0 = in_anim_time - keyframe_time_info.t_0;
+				assert(t_minus_t_0 >= 0);
+
+				int index = (int)(t_minus_t_0 * keyframe_time_info.recip_spacing);
+
+				const float frac = (t_minus_t_0 - (float)index * keyframe_time_info.spacing) * keyframe_time_info.recip_spacing; // Fraction of way through frame
+				assert(frac >= -0.001f && frac < 1.001f);
+
+				if(index >= keyframe_time_info.times_size)
+					index = 0;
+
+				int next_index = index + 1;
+				if(next_index >= keyframe_time_info.times_size)
+					next_index = 0;
+
+				key_frame_loc.i_0 = index;
+				key_frame_loc.i_1 = next_index;
+				key_frame_loc.frac = frac;
+			}
+		}
+		else
+		{
+			const std::vector<float>& time_vals = keyframe_time_info.times;
+
+			if(keyframe_time_info.times_size != 0)
+			{
+				if(keyframe_time_info.times_size == 1)
+				{
+					key_frame_loc.i_0 = 0;
+					key_frame_loc.i_1 = 0;
+					key_frame_loc.frac = 0;
+				}
+				else
+				{
+					assert(time_vals.size() >= 2);
+
+					/*
+					frame 0                     frame 1                        frame 2                      frame 3
+					|----------------------------|-----------------------------|-----------------------------|-------------------------> time
+					^                            ^            ^                ^
+					cur_frame_i                             in_anim_time
+					index                        next_index
+					*/
+
+					// Find current frame: index = index of the last keyframe with time <= in_anim_time, or -1 if there is no such keyframe.
+					// key_frame_loc.i_0 holds the keyframe found by the previous call (if key_frame_locs was kept around), and animation time usually advances
+					// by less than a keyframe per frame, so check that keyframe and the one after it before falling back to a binary search.
+					const int num_times = keyframe_time_info.times_size;
+					const int hint = key_frame_loc.i_0;
+					int index;
+					if(hint >= 0 && hint < num_times && time_vals[hint] <= in_anim_time && (hint + 1 >= num_times || in_anim_time < time_vals[hint + 1]))
+						index = hint;
+					else if(hint >= 0 && hint + 1 < num_times && time_vals[hint + 1] <= in_anim_time && (hint + 2 >= num_times || in_anim_time < time_vals[hint + 2]))
+						index = hint + 1;
+					else
+					{
+						auto res = std::upper_bound(time_vals.begin(), time_vals.end(), in_anim_time); // "Finds the position of the first element in an ordered range that has a value that is greater than a specified value"
+						index = (int)(res - time_vals.begin()) - 1;
+					}
+					assert(index >= -1 && index < (int)time_vals.size());
+
+					const int next_index = myMin(index + 1, num_times - 1);
+					assert(next_index >= 0 && next_index < (int)time_vals.size());
+
+					if(index < 0) // This is the case when in_anim_time < t_0.  In this case we want to clamp the output values to the keyframe 0 values.
+					{
+						key_frame_loc.i_0 = 0;
+						key_frame_loc.i_1 = 0;
+						key_frame_loc.frac = 0;
+					}
+					else
+					{
+						const float index_time = time_vals[index];
+
+						float frac;
+						frac = (in_anim_time - index_time) / (time_vals[next_index] - index_time);
+
+						if(!(frac >= 0 && frac <= 1)) // TEMP: handle NaNs
+							frac = 0;
+
+						key_frame_loc.i_0 = index;
+						key_frame_loc.i_1 = next_index;
+						key_frame_loc.frac = frac;
+					}
+				}
+			}
+		}
+	}
+}
+
+
+// Reads output accessor values from either full-precision or compressed output data.
+struct OutputDataReader
+{
+	OutputDataReader(const js::Vector<js::Vector<Vec4f, 16> >& full_, const js::Vector<CompressedOutputTrack, 16>& compressed_) : full(full_), compressed(compressed_), use_compressed(!compressed_.empty()) {}
+
+	GLARE_STRONG_INLINE const Vec4f getValue(int accessor, int i) const
+	{
+		return use_compressed ? compressed[accessor].getValue(i) : full[accessor][i];
+	}
+
+	const js::Vector<js::Vector<Vec4f, 16> >& full;
+	const js::Vector<CompressedOutputTrack, 16>& compressed;
+	bool use_compressed;
+};
+
+
+// Get a reader for the output data used by the given animation: the animation's own output data if it has any, otherwise the shared output data.
+static inline OutputDataReader getOutputDataReader(const AnimationData& data, const AnimationDatum& anim_datum)
+{
+	if(!anim_datum.m_output_data.empty() || !anim_datum.m_compressed_output_data.empty())
+		return OutputDataReader(anim_datum.m_output_data, anim_datum.m_compressed_output_data);
+	else
+		return OutputDataReader(data.output_data, data.compressed_output_data);
+}
+
+
+// Sample the translation and scale of a node for a single animation.  Values that are not animated are left unchanged.
+static inline void sampleNodeTransAndScale(const PerAnimationNodeData& node, const AnimationKeyFrameLocation* key_frame_locs, const OutputDataReader& output_data, 
+	Vec4f& trans, Vec4f& scale)
+{
+	if(node.translation_input_accessor >= 0)
+	{
+		const AnimationKeyFrameLocation& loc = key_frame_locs[node.translation_input_accessor];
+
+		// read translation values from output accessor.
+		const Vec4f trans_0 = output_data.getValue(node.translation_output_accessor, loc.i_0);
+		const Vec4f trans_1 = output_data.getValue(node.translation_output_accessor, loc.i_1);
+		trans = Maths::lerp(trans_0, trans_1, loc.frac); // TODO: handle step interpolation, cubic lerp etc..
+	}
+
+	if(node.scale_input_accessor >= 0)
+	{
+		const AnimationKeyFrameLocation& loc = key_frame_locs[node.scale_input_accessor];
+
+		// read scale values from output accessor
+		const Vec4f scale_0 = output_data.getValue(node.scale_output_accessor, loc.i_0);
+		const Vec4f scale_1 = output_data.getValue(node.scale_output_accessor, loc.i_1);
+		scale = Maths::lerp(scale_0, scale_1, loc.frac);
+	}
+}
+
+
+// Get the two rotation keyframe values of a node for a single animation, and the fraction to interpolate between them.
+// If the rotation is not animated, both keyframe values are set to default_rot.
+static inline void getNodeRotationKeys(const PerAnimationNodeData& node, const AnimationKeyFrameLocation* key_frame_locs, const OutputDataReader& output_data, 
+	const Vec4f& default_rot, Vec4f& rot_0_out, Vec4f& rot_1_out, float& frac_out)
+{
+	if(node.rotation_input_accessor >= 0)
+	{
+		const AnimationKeyFrameLocation& loc = key_frame_locs[node.rotation_input_accessor];
+
+		// read rotation values from output accessor
+		rot_0_out = output_data.getValue(node.rotation_output_accessor, loc.i_0);
+		rot_1_out = output_data.getValue(node.rotation_output_accessor, loc.i_1);
+		frac_out = loc.frac;
+	}
+	else
+	{
+		rot_0_out = default_rot;
+		rot_1_out = default_rot;
+		frac_out = 0;
+	}
+}
+
+
+// Computes Quatf::nlerp(q0, q1, t) for 4 quaternions at once.  The quaternions are in SoA form: q0[0] holds the x components of the 4 quaternions, q0[1] the y components etc.
+static GLARE_STRONG_INLINE void nlerp4(const Vec4f* q0, const Vec4f* q1, const Vec4f& t, Vec4f* res_out)
+{
+	const Vec4f dot = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3];
+
+	// Where the dot product is negative, negate q1 (by flipping the sign bits) so we interpolate the shorter way around, as Quatf::nlerp does.
+	const Vec4f sign_flip = _mm_and_ps(parallelLessThan(dot, Vec4f(0.f)).v, _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000)));
+
+	const Vec4f one_minus_t = Vec4f(1.f) - t;
+	Vec4f r[4];
+	for(int c=0; c<4; ++c)
+		r[c] = q0[c] * one_minus_t + Vec4f(_mm_xor_ps(q1[c].v, sign_flip.v)) * t;
+
+	const Vec4f len = sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + r[3] * r[3]);
+	for(int c=0; c<4; ++c)
+		res_out[c] = div(r[c], len);
+}
+
+
+void AnimationData::samplePose(int anim_a_i, int anim_b_i, float in_anim_time_a, float in_anim_time_b, float transition_frac, js::Vector<AnimationKeyFrameLocation, 16>& key_frame_locs, 
+	AnimationPose& pose_out) const
+{
+	assert(!animations.empty());
+	anim_a_i = myClamp(anim_a_i, 0, (int)animations.size() - 1);
+	anim_b_i = myClamp(anim_b_i, 0, (int)animations.size() - 1);
+
+	const AnimationDatum& anim_datum_a                        = *animations       [anim_a_i];
+	const std::vector<PerAnimationNodeData>& anim_a_node_data = per_anim_node_data[anim_a_i];
+	const AnimationDatum& anim_datum_b                        = *animations       [anim_b_i];
+	const std::vector<PerAnimationNodeData>& anim_b_node_data = per_anim_node_data[anim_b_i];
+
+	const size_t keyframe_times_size = myMax(keyframe_times.size(), anim_datum_a.m_keyframe_times.size(), anim_datum_b.m_keyframe_times.size());
+	if(key_frame_locs.size() != keyframe_times_size * 2) // keyframe times for animation a are first, then keyframe times for animation b.
+	{
+		// Zero-initialise so the keyframe search hints are valid.  When the size doesn't change we keep the existing locations to use as hints.
+		const AnimationKeyFrameLocation zero_loc = { 0, 0, 0.f };
+		key_frame_locs.resize(keyframe_times_size * 2, zero_loc);
+	}
+
+	AnimationKeyFrameLocation* const key_frame_locs_a = key_frame_locs.data();
+	AnimationKeyFrameLocation* const key_frame_locs_b = key_frame_locs.data() + keyframe_times_size; // The keyframe_times_size offset is to get keyframe locations for animation b.
+
+	const bool use_a = transition_frac < 1.f; // At transition_frac = 1, result is fully animation b, a is used if transition_frac < 1
+	const bool use_b = transition_frac > 0.f; // At transition_frac = 0, result is fully animation a, b is used if transition_frac > 0
+
+	if(use_a)
+		computeKeyFrameLocations((!anim_datum_a.m_keyframe_times.empty()) ? anim_datum_a.m_keyframe_times : keyframe_times, anim_datum_a, in_anim_time_a, key_frame_locs_a);
+
+	if(use_b)
+		computeKeyFrameLocations((!anim_datum_b.m_keyframe_times.empty()) ? anim_datum_b.m_keyframe_times : keyframe_times, anim_datum_b, in_anim_time_b, key_frame_locs_b);
+
+	const OutputDataReader output_data_a = getOutputDataReader(*this, anim_datum_a);
+	const OutputDataReader output_data_b = getOutputDataReader(*this, anim_datum_b);
+
+	const size_t num_nodes = nodes.size();
+	pose_out.trans.resizeNoCopy(num_nodes);
+	pose_out.rot.resizeNoCopy(num_nodes);
+	pose_out.scale.resizeNoCopy(num_nodes);
+
+	// Translations and scales
+	for(size_t node_i=0; node_i<num_nodes; ++node_i)
+	{
+		const AnimationNodeData& node_data = nodes[node_i];
+
+		Vec4f trans_a = node_data.trans;
+		Vec4f trans_b = node_data.trans;
+		Vec4f scale_a = node_data.scale;
+		Vec4f scale_b = node_data.scale;
+
+		if(use_a)
+			sampleNodeTransAndScale(anim_a_node_data[node_i], key_frame_locs_a, output_data_a, trans_a, scale_a);
+
+		if(use_b)
+			sampleNodeTransAndScale(anim_b_node_data[node_i], key_frame_locs_b, output_data_b, trans_b, scale_b);
+
+		pose_out.trans[node_i] = Maths::lerp(trans_a, trans_b, transition_frac);
+		pose_out.scale[node_i] = Maths::lerp(scale_a, scale_b, transition_frac);
+	}
+
+	// Rotations.  The nlerps are the expensive part, so do them 4 nodes at a time: gather the keyframe values for 4 nodes, transpose to SoA form, 
+	// nlerp between keyframes for animation a and for animation b, then nlerp between a and b.
+	const Vec4f transition_frac_v(transition_frac);
+	for(size_t group_begin=0; group_begin<num_nodes; group_begin += 4)
+	{
+		Vec4f a_0[4], a_1[4], b_0[4], b_1[4];
+		float frac_a[4], frac_b[4];
+		for(size_t z=0; z<4; ++z)
+		{
+			const size_t node_i = group_begin + z;
+			if(node_i < num_nodes)
+			{
+				const Vec4f default_rot = nodes[node_i].rot.v;
+				if(use_a)
+					getNodeRotationKeys(anim_a_node_data[node_i], key_frame_locs_a, output_data_a, default_rot, a_0[z], a_1[z], frac_a[z]);
+				else
+				{
+					a_0[z] = a_1[z] = default_rot;
+					frac_a[z] = 0;
+				}
+
+				if(use_b)
+					getNodeRotationKeys(anim_b_node_data[node_i], key_frame_locs_b, output_data_b, default_rot, b_0[z], b_1[z], frac_b[z]);
+				else
+				{
+					b_0[z] = b_1[z] = default_rot;
+					frac_b[z] = 0;
+				}
+			}
+			else // Pad the last group with identity rotations.
+			{
+				a_0[z] = a_1[z] = b_0[z] = b_1[z] = Vec4f(0, 0, 0, 1);
+				frac_a[z] = frac_b[z] = 0;
+			}
+		}
+
+		Vec4f a_0_soa[4], a_1_soa[4], b_0_soa[4], b_1_soa[4];
+		transpose(a_0[0], a_0[1], a_0[2], a_0[3], a_0_soa[0], a_0_soa[1], a_0_soa[2], a_0_soa[3]);
+		transpose(a_1[0], a_1[1], a_1[2], a_1[3], a_1_soa[0], a_1_soa[1], a_1_soa[2], a_1_soa[3]);
+		transpose(b_0[0], b_0[1], b_0[2], b_0[3], b_0_soa[0], b_0_soa[1], b_0_soa[2], b_0_soa[3]);
+		transpose(b_1[0], b_1[1], b_1[2], b_1[3], b_1_soa[0], b_1_soa[1], b_1_soa[2], b_1_soa[3]);
+
+		Vec4f rot_a[4], rot_b[4], rot[4];
+		nlerp4(a_0_soa, a_1_soa, loadUnalignedVec4f(frac_a), rot_a);
+		nlerp4(b_0_soa, b_1_soa, loadUnalignedVec4f(frac_b), rot_b);
+		nlerp4(rot_a, rot_b, transition_frac_v, rot);
+
+		Vec4f res[4];
+		transpose(rot[0], rot[1], rot[2], rot[3], res[0], res[1], res[2], res[3]);
+
+		const size_t group_size = myMin<size_t>(4, num_nodes - group_begin);
+		for(size_t z=0; z<group_size; ++z)
+			pose_out.rot[group_begin + z] = Quatf(res[z]);
+	}
+}
+
+
+static float maxAbsDecodeError(const js::Vector<Vec4f, 16>& values, const CompressedOutputTrack& track)
+{
+	Vec4f max_err(0.f);
+	for(size_t i=0; i<values.size(); ++i)
+		max_err = max(max_err, abs(track.getValue(i) - values[i]));
+	return myMax(max_err[0], max_err[1], myMax(max_err[2], max_err[3]));
+}
+
+
+// Compress the values of a single output accessor, using the most compact encoding that keeps the error of all decoded components <= max_error.
+static void compressOutputTrack(const js::Vector<Vec4f, 16>& values, bool is_rotation, float max_error, CompressedOutputTrack& track)
+{
+	track.num_values = (uint32)values.size();
+	track.offset = Vec4f(0.f);
+	track.scale = Vec4f(0.f);
+	track.quantised.clearAndFreeMem();
+	track.full_values.clearAndFreeMem();
+
+	Vec4f min_v( std::numeric_limits<float>::infinity());
+	Vec4f max_v(-std::numeric_limits<float>::infinity());
+	for(size_t i=0; i<values.size(); ++i)
+	{
+		min_v = min(min_v, values[i]);
+		max_v = max(max_v, values[i]);
+	}
+
+	// Keyframe reduction: if all values are within the error bound of the mid-point, just store the mid-point.
+	if(!values.empty())
+	{
+		track.encoding = CompressedOutputTrack::Encoding_Constant;
+		track.offset = (min_v + max_v) * 0.5f;
+		track.max_error = maxAbsDecodeError(values, track);
+		if(track.max_error <= max_error)
+			return;
+	}
+
+	// Quantise to 16 bits per component.
+	track.quantised.resizeNoCopy(values.size() * 4);
+	if(is_rotation)
+	{
+		track.encoding = CompressedOutputTrack::Encoding_QuantisedQuat;
+		for(size_t i=0; i<values.size(); ++i)
+			for(int c=0; c<4; ++c)
+				track.quantised[i * 4 + c] = (uint16)(int16)meshopt_quantizeSnorm(values[i][c], /*N=*/16);
+	}
+	else
+	{
+		track.encoding = CompressedOutputTrack::Encoding_QuantisedVec;
+		track.offset = min_v;
+		track.scale = (max_v - min_v) * (1 / 65535.f);
+		for(size_t i=0; i<values.size(); ++i)
+			for(int c=0; c<4; ++c)
+				track.quantised[i * 4 + c] = (track.scale[c] > 0) ? (uint16)myClamp((int)((values[i][c] - min_v[c]) / track.scale[c] + 0.5f), 0, 65535) : 0;
+	}
+	track.max_error = maxAbsDecodeError(values, track);
+	if(track.max_error <= max_error)
+		return;
+
+	// Else quantisation error is too large, store full precision values.
+	track.encoding = CompressedOutputTrack::Encoding_Full;
+	track.quantised.clearAndFreeMem();
+	track.full_values = values;
+	track.max_error = 0;
+}
+
+
+// Compress the output data vectors used by the animations in anims.  The error bound for each output vector is determined by what it is used for.
+// Frees output_data.
+static void compressOutputData(js::Vector<js::Vector<Vec4f, 16> >& output_data, const std::vector<const AnimationDatum*>& anims, const AnimationCompressionParams& params, 
+	js::Vector<CompressedOutputTrack, 16>& compressed_out)
+{
+	std::vector<float> max_error(output_data.size(), std::numeric_limits<float>::infinity()); // Output vectors that are not used can be reduced to a single value.
+	std::vector<int> num_rot_uses(output_data.size(), 0);
+	std::vector<int> num_non_rot_uses(output_data.size(), 0);
+	for(size_t a=0; a<anims.size(); ++a)
+		for(size_t i=0; i<anims[a]->raw_per_anim_node_data.size(); ++i)
+		{
+			const PerAnimationNodeData& data = anims[a]->raw_per_anim_node_data[i];
+			if(data.translation_output_accessor >= 0 && data.translation_output_accessor < (int)output_data.size())
+			{
+				max_error[data.translation_output_accessor] = myMin(max_error[data.translation_output_accessor], params.max_translation_error);
+				num_non_rot_uses[data.translation_output_accessor]++;
+			}
+			if(data.rotation_output_accessor >= 0 && data.rotation_output_accessor < (int)output_data.size())
+			{
+				max_error[data.rotation_output_accessor] = myMin(max_error[data.rotation_output_accessor], params.max_rotation_error);
+				num_rot_uses[data.rotation_output_accessor]++;
+			}
+			if(data.scale_output_accessor >= 0 && data.scale_output_accessor < (int)output_data.size())
+			{
+				max_error[data.scale_output_accessor] = myMin(max_error[data.scale_output_accessor], params.max_scale_error);
+				num_non_rot_uses[data.scale_output_accessor]++;
+			}
+		}
+
+	compressed_out.resize(output_data.size());
+	for(size_t i=0; i<output_data.size(); ++i)
+	{
+		const bool is_rotation = (num_rot_uses[i] > 0) && (num_non_rot_uses[i] == 0);
+		compressOutputTrack(output_data[i], is_rotation, max_error[i], compressed_out[i]);
+	}
+
+	output_data.clearAndFreeMem();
+}
+
+
+void AnimationData::compressOutputData(const AnimationCompressionParams& params)
+{
+	ZoneScoped; // Tracy profiler
+
+	std::vector<const AnimationDatum*> anims_using_shared_data;
+	for(size_t i=0; i<animations.size(); ++i)
+	{
+		AnimationDatum& anim = *animations[i];
+		if(!anim.m_output_data.empty())
+		{
+			std::vector<const AnimationDatum*> anims(1, &anim);
+			::compressOutputData(anim.m_output_data, anims, params, anim.m_compressed_output_data);
+		}
+		else if(anim.m_compressed_output_data.empty())
+			anims_using_shared_data.push_back(&anim);
+	}
+
+	if(!output_data.empty())
+		::compressOutputData(output_data, anims_using_shared_data, params, compressed_output_data);
+}
+
+
+bool AnimationData::isOutputDataCompressed() const
+{
+	if(!compressed_output_data.empty())
+		return true;
+	for(size_t i=0; i<animations.size(); ++i)
+		if(!animations[i]->m_compressed_output_data.empty())
+			return true;
+	return false;
+}
+
+
 size_t AnimationData::getTotalMemUsage() const
 {
 	size_t sum =
@@ -1967,6 +2511,9 @@ size_t AnimationData::getTotalMemUsage() const
 	for(size_t i=0; i<output_data.size(); ++i)
 		sum += output_data[i].capacitySizeBytes();
 
+	for(size_t i=0; i<compressed_output_data.size(); ++i)
+		sum += compressed_output_data[i].getTotalMemUsage();
+
 	for(size_t i=0; i<animations.size(); ++i)
 		if(animations[i]->getRefCount() == 1) // Only count animation mem usage if this is the only user of the animation data.  Don't count shared animation data. (walk anim shared by all avatars etc.)
 			sum += animations[i]->getTotalMemUsage();
@@ -2032,6 +2579,665 @@ static inline float dequantiseSNorm(int x)
 }
 
 
+// Finds the keyframes either side of time with a linear search, and the fraction to interpolate between them.  Times before the first keyframe and after
+// the last keyframe are clamped to the first and last keyframe.
+static void findKeyFramesReference(const std::vector<float>& times, float time, int& i_0_out, int& i_1_out, float& frac_out)
+{
+	i_0_out = i_1_out = 0;
+	frac_out = 0;
+	if(times.size() < 2 || time < times[0])
+		return;
+
+	size_t i = 0;
+	while(i + 1 < times.size() && times[i + 1] <= time)
+		i++;
+
+	i_0_out = (int)i;
+	i_1_out = (int)myMin(i + 1, times.size() - 1);
+	if(i_1_out != i_0_out)
+		frac_out = (time - times[i_0_out]) / (times[i_1_out] - times[i_0_out]);
+}
+
+
+// Samples a channel (translation, rotation or scale) of a node for one animation, returning the two keyframe values and the fraction to interpolate between them.
+// Returns false if the channel is not animated.
+static bool sampleChannelReference(const AnimationData& data, const AnimationDatum& anim_datum, int input_accessor, int output_accessor, float time, float* v_0_out, float* v_1_out, float& frac_out)
+{
+	if(input_accessor < 0)
+		return false;
+
+	const js::Vector<KeyFrameTimeInfo>& keyframe_times = (!anim_datum.m_keyframe_times.empty()) ? anim_datum.m_keyframe_times : data.keyframe_times;
+	const js::Vector<js::Vector<Vec4f, 16> >& output_data = (!anim_datum.m_output_data.empty()) ? anim_datum.m_output_data : data.output_data;
+
+	int i_0, i_1;
+	findKeyFramesReference(keyframe_times[input_accessor].times, time, i_0, i_1, frac_out);
+	for(int c=0; c<4; ++c)
+	{
+		v_0_out[c] = output_data[output_accessor][i_0][c];
+		v_1_out[c] = output_data[output_accessor][i_1][c];
+	}
+	return true;
+}
+
+
+static void nlerpReference(const float* q_0, const float* q_1, float t, float* res_out)
+{
+	const float dot = q_0[0] * q_1[0] + q_0[1] * q_1[1] + q_0[2] * q_1[2] + q_0[3] * q_1[3];
+	const float q_1_sign = (dot < 0) ? -1.f : 1.f; // Interpolate the shorter way around.
+
+	float len2 = 0;
+	for(int c=0; c<4; ++c)
+	{
+		res_out[c] = q_0[c] * (1 - t) + q_1_sign * q_1[c] * t;
+		len2 += res_out[c] * res_out[c];
+	}
+	const float len = std::sqrt(len2);
+	for(int c=0; c<4; ++c)
+		res_out[c] /= len;
+}
+
+
+// A straightforward scalar version of samplePose(), one node and component at a time, with a linear keyframe search, for checking samplePose() against.
+// Only handles uncompressed output data.
+static void samplePoseReference(const AnimationData& data, int anim_a_i, int anim_b_i, float in_anim_time_a, float in_anim_time_b, float transition_frac, AnimationPose& pose_out)
+{
+	testAssert(!data.isOutputDataCompressed());
+
+	const size_t num_nodes = data.nodes.size();
+	pose_out.trans.resize(num_nodes);
+	pose_out.rot.resize(num_nodes);
+	pose_out.scale.resize(num_nodes);
+
+	const int anim_i[2] = { anim_a_i, anim_b_i };
+	const float in_anim_time[2] = { in_anim_time_a, in_anim_time_b };
+	const bool used[2] = { transition_frac < 1.f, transition_frac > 0.f };
+
+	for(size_t node_i=0; node_i<num_nodes; ++node_i)
+	{
+		const AnimationNodeData& node_data = data.nodes[node_i];
+
+		// The translation, rotation and scale for animations a and b.  Start with the node's default values, in case they are not animated or the animation is not used.
+		float trans[2][4], rot[2][4], scale[2][4];
+		for(int z=0; z<2; ++z)
+			for(int c=0; c<4; ++c)
+			{
+				trans[z][c] = node_data.trans[c];
+				rot[z][c] = node_data.rot.v[c];
+				scale[z][c] = node_data.scale[c];
+			}
+
+		for(int z=0; z<2; ++z)
+		{
+			if(!used[z])
+				continue;
+
+			const AnimationDatum& anim_datum = *data.animations[anim_i[z]];
+			const PerAnimationNodeData& node = data.per_anim_node_data[anim_i[z]][node_i];
+
+			float v_0[4], v_1[4], frac;
+			if(sampleChannelReference(data, anim_datum, node.translation_input_accessor, node.translation_output_accessor, in_anim_time[z], v_0, v_1, frac))
+				for(int c=0; c<4; ++c)
+					trans[z][c] = v_0[c] * (1 - frac) + v_1[c] * frac;
+
+			if(sampleChannelReference(data, anim_datum, node.rotation_input_accessor, node.rotation_output_accessor, in_anim_time[z], v_0, v_1, frac))
+				nlerpReference(v_0, v_1, frac, rot[z]);
+
+			if(sampleChannelReference(data, anim_datum, node.scale_input_accessor, node.scale_output_accessor, in_anim_time[z], v_0, v_1, frac))
+				for(int c=0; c<4; ++c)
+					scale[z][c] = v_0[c] * (1 - frac) + v_1[c] * frac;
+		}
+
+		// Blend between animations a and b.
+		float blended_rot[4];
+		nlerpReference(rot[0], rot[1], transition_frac, blended_rot);
+		for(int c=0; c<4; ++c)
+		{
+			pose_out.trans[node_i][c] = trans[0][c] * (1 - transition_frac) + trans[1][c] * transition_frac;
+			pose_out.rot[node_i].v[c] = blended_rot[c];
+			pose_out.scale[node_i][c] = scale[0][c] * (1 - transition_frac) + scale[1][c] * transition_frac;
+		}
+	}
+}
+
+
+// Builds the node transformation matrix, translation * rotation * scale, element by element.
+static void makeNodeMatrixReference(const Vec4f& trans, const Quatf& rot, const Vec4f& scale, Matrix4f& mat_out)
+{
+	const float x = rot.v[0], y = rot.v[1], z = rot.v[2], w = rot.v[3];
+	const float r[3][3] = {
+		{ 1 - 2*(y*y + z*z),	2*(x*y - z*w),		2*(x*z + y*w) },
+		{ 2*(x*y + z*w),		1 - 2*(x*x + z*z),	2*(y*z - x*w) },
+		{ 2*(x*z - y*w),		2*(y*z + x*w),		1 - 2*(x*x + y*y) }
+	};
+
+	for(int row=0; row<3; ++row)
+	{
+		for(int col=0; col<3; ++col)
+			mat_out.elem(row, col) = r[row][col] * scale[col];
+		mat_out.elem(row, 3) = trans[row];
+	}
+	mat_out.elem(3, 0) = mat_out.elem(3, 1) = mat_out.elem(3, 2) = 0;
+	mat_out.elem(3, 3) = 1;
+}
+
+
+// The samplePose() code path from before the SIMD rotation nlerp and the keyframe search cursor were added, kept as the baseline for the perf
+// test in testSamplePose().  Only handles uncompressed output data.
+// This is computeKeyFrameLocations() as it was then: a binary search for every used input accessor, on every call.
+static void computeKeyFrameLocationsPreCursor(const js::Vector<KeyFrameTimeInfo>& keyframe_times, const AnimationDatum& anim_datum, float in_anim_time, AnimationKeyFrameLocation* key_frame_locs)
+{
+	for(size_t q=0; q<anim_datum.used_input_accessor_indices.size(); ++q)
+	{
+		const int input_accessor_i = anim_datum.used_input_accessor_indices[q];
+
+		const KeyFrameTimeInfo& keyframe_time_info = keyframe_times[input_accessor_i];
+		assert(keyframe_time_info.times_size == (int)keyframe_time_info.times.size());
+
+		AnimationKeyFrameLocation& key_frame_loc = key_frame_locs[input_accessor_i];
+
+		// If keyframe times are equally spaced, we can skip the binary search stuff, and just compute the keyframes we are between directly.
+		if(keyframe_time_info.equally_spaced && (keyframe_time_info.t_back == anim_datum.anim_len))
+		{
+			if(in_anim_time < keyframe_time_info.t_0)
+			{
+				key_frame_loc.i_0 = 0;
+				key_frame_loc.i_1 = 0;
+				key_frame_loc.frac = 0;
+			}
+			else
+			{
+				const float t_minus_t_0 = in_anim_time - keyframe_time_info.t_0;
+				assert(t_minus_t_0 >= 0);
+
+				int index = (int)(t_minus_t_0 * keyframe_time_info.recip_spacing);
+
+				const float frac = (t_minus_t_0 - (float)index * keyframe_time_info.spacing) * keyframe_time_info.recip_spacing; // Fraction of way through frame
+				assert(frac >= -0.001f && frac < 1.001f);
+
+				if(index >= keyframe_time_info.times_size)
+					index = 0;
+
+				int next_index = index + 1;
+				if(next_index >= keyframe_time_info.times_size)
+					next_index = 0;
+
+				key_frame_loc.i_0 = index;
+				key_frame_loc.i_1 = next_index;
+				key_frame_loc.frac = frac;
+			}
+		}
+		else
+		{
+			const std::vector<float>& time_vals = keyframe_time_info.times;
+
+			if(keyframe_time_info.times_size != 0)
+			{
+				if(keyframe_time_info.times_size == 1)
+				{
+					key_frame_loc.i_0 = 0;
+					key_frame_loc.i_1 = 0;
+					key_frame_loc.frac = 0;
+				}
+				else
+				{
+					assert(time_vals.size() >= 2);
+
+					// TODO: use incremental search based on the position last frame, instead of using upper_bound.  (or combine)
+
+					/*
+					frame 0                     frame 1                        frame 2                      frame 3
+					|----------------------------|-----------------------------|-----------------------------|-------------------------> time
+					^                            ^            ^                ^
+					cur_frame_i                             in_anim_time
+					index                        next_index
+					*/
+
+					// Find current frame
+					auto res = std::upper_bound(time_vals.begin(), time_vals.end(), in_anim_time); // "Finds the position of the first element in an ordered range that has a value that is greater than a specified value"
+					int next_index = (int)(res - time_vals.begin());
+					assert(next_index >= 0 && next_index <= (int)time_vals.size());
+					int index = next_index - 1;
+					assert(index >= -1 && index < (int)time_vals.size());
+
+					next_index = myMin(next_index, keyframe_time_info.times_size - 1);
+					assert(next_index >= 0 && next_index < (int)time_vals.size());
+
+					if(index < 0) // This is the case when in_anim_time < t_0.  In this case we want to clamp the output values to the keyframe 0 values.
+					{
+						key_frame_loc.i_0 = 0;
+						key_frame_loc.i_1 = 0;
+						key_frame_loc.frac = 0;
+					}
+					else
+					{
+						const float index_time = time_vals[index];
+
+						float frac;
+						frac = (in_anim_time - index_time) / (time_vals[next_index] - index_time);
+
+						if(!(frac >= 0 && frac <= 1)) // TEMP: handle NaNs
+							frac = 0;
+
+						key_frame_loc.i_0 = index;
+						key_frame_loc.i_1 = next_index;
+						key_frame_loc.frac = frac;
+					}
+				}
+			}
+		}
+	}
+}
+
+
+// Sample the translation, rotation and scale of a node for a single animation.  Values that are not animated are left unchanged.
+static inline void sampleNodeTRSPreSIMD(const PerAnimationNodeData& node, const AnimationKeyFrameLocation* key_frame_locs, const js::Vector<js::Vector<Vec4f, 16> >& output_data, 
+	Vec4f& trans, Quatf& rot, Vec4f& scale)
+{
+	if(node.translation_input_accessor >= 0)
+	{
+		const AnimationKeyFrameLocation& loc = key_frame_locs[node.translation_input_accessor];
+
+		// read translation values from output accessor.
+		const Vec4f trans_0 = (output_data[node.translation_output_accessor])[loc.i_0];
+		const Vec4f trans_1 = (output_data[node.translation_output_accessor])[loc.i_1];
+		trans = Maths::lerp(trans_0, trans_1, loc.frac); // TODO: handle step interpolation, cubic lerp etc..
+	}
+
+	if(node.rotation_input_accessor >= 0)
+	{
+		const AnimationKeyFrameLocation& loc = key_frame_locs[node.rotation_input_accessor];
+
+		// read rotation values from output accessor
+		const Quatf rot_0 = Quatf((output_data[node.rotation_output_accessor])[loc.i_0]);
+		const Quatf rot_1 = Quatf((output_data[node.rotation_output_accessor])[loc.i_1]);
+		rot = Quatf::nlerp(rot_0, rot_1, loc.frac);
+	}
+
+	if(node.scale_input_accessor >= 0)
+	{
+		const AnimationKeyFrameLocation& loc = key_frame_locs[node.scale_input_accessor];
+
+		// read scale values from output accessor
+		const Vec4f scale_0 = (output_data[node.scale_output_accessor])[loc.i_0];
+		const Vec4f scale_1 = (output_data[node.scale_output_accessor])[loc.i_1];
+		scale = Maths::lerp(scale_0, scale_1, loc.frac);
+	}
+}
+
+
+static void samplePosePreSIMD(const AnimationData& data, int anim_a_i, int anim_b_i, float in_anim_time_a, float in_anim_time_b, float transition_frac, js::Vector<AnimationKeyFrameLocation, 16>& key_frame_locs, 
+	AnimationPose& pose_out)
+{
+	const std::vector<Reference<AnimationDatum> >& animations = data.animations;
+	const std::vector<std::vector<PerAnimationNodeData> >& per_anim_node_data = data.per_anim_node_data;
+	const js::Vector<KeyFrameTimeInfo>& keyframe_times = data.keyframe_times;
+	const js::Vector<js::Vector<Vec4f, 16> >& output_data = data.output_data;
+	const std::vector<AnimationNodeData>& nodes = data.nodes;
+
+	assert(!animations.empty());
+	anim_a_i = myClamp(anim_a_i, 0, (int)animations.size() - 1);
+	anim_b_i = myClamp(anim_b_i, 0, (int)animations.size() - 1);
+
+	const AnimationDatum& anim_datum_a                        = *animations       [anim_a_i];
+	const std::vector<PerAnimationNodeData>& anim_a_node_data = per_anim_node_data[anim_a_i];
+	const AnimationDatum& anim_datum_b                        = *animations       [anim_b_i];
+	const std::vector<PerAnimationNodeData>& anim_b_node_data = per_anim_node_data[anim_b_i];
+
+	const size_t keyframe_times_size = myMax(keyframe_times.size(), anim_datum_a.m_keyframe_times.size(), anim_datum_b.m_keyframe_times.size());
+	key_frame_locs.resizeNoCopy(keyframe_times_size * 2); // keyframe times for animation a are first, then keyframe times for animation b.
+
+	AnimationKeyFrameLocation* const key_frame_locs_a = key_frame_locs.data();
+	AnimationKeyFrameLocation* const key_frame_locs_b = key_frame_locs.data() + keyframe_times_size; // The keyframe_times_size offset is to get keyframe locations for animation b.
+
+	if(transition_frac < 1.f) // At transition_frac = 1, result is fully animation b, a is used if transition_frac < 1
+		computeKeyFrameLocationsPreCursor((!anim_datum_a.m_keyframe_times.empty()) ? anim_datum_a.m_keyframe_times : keyframe_times, anim_datum_a, in_anim_time_a, key_frame_locs_a);
+
+	if(transition_frac > 0.f) // At transition_frac = 0, result is fully animation a, b is used if transition_frac > 0
+		computeKeyFrameLocationsPreCursor((!anim_datum_b.m_keyframe_times.empty()) ? anim_datum_b.m_keyframe_times : keyframe_times, anim_datum_b, in_anim_time_b, key_frame_locs_b);
+
+	const js::Vector<js::Vector<Vec4f, 16> >& output_data_a = (!anim_datum_a.m_output_data.empty()) ? anim_datum_a.m_output_data : output_data;
+	const js::Vector<js::Vector<Vec4f, 16> >& output_data_b = (!anim_datum_b.m_output_data.empty()) ? anim_datum_b.m_output_data : output_data;
+
+	const size_t num_nodes = nodes.size();
+	pose_out.trans.resizeNoCopy(num_nodes);
+	pose_out.rot.resizeNoCopy(num_nodes);
+	pose_out.scale.resizeNoCopy(num_nodes);
+
+	for(size_t node_i=0; node_i<num_nodes; ++node_i)
+	{
+		const AnimationNodeData& node_data = nodes[node_i];
+
+		Vec4f trans_a = node_data.trans;
+		Vec4f trans_b = node_data.trans;
+		Quatf rot_a   = node_data.rot;
+		Quatf rot_b   = node_data.rot;
+		Vec4f scale_a = node_data.scale;
+		Vec4f scale_b = node_data.scale;
+
+		if(transition_frac < 1.f)
+			sampleNodeTRSPreSIMD(anim_a_node_data[node_i], key_frame_locs_a, output_data_a, trans_a, rot_a, scale_a);
+
+		if(transition_frac > 0.f)
+			sampleNodeTRSPreSIMD(anim_b_node_data[node_i], key_frame_locs_b, output_data_b, trans_b, rot_b, scale_b);
+
+		pose_out.trans[node_i] = Maths::lerp(trans_a, trans_b, transition_frac);
+		pose_out.rot[node_i]   = Quatf::nlerp(rot_a, rot_b, transition_frac);
+		pose_out.scale[node_i] = Maths::lerp(scale_a, scale_b, transition_frac);
+	}
+}
+
+
+// Perf test, against the code path samplePose() replaced.  Times are wrapped into the animations and advanced by a frame at a time, as OpenGLEngine does.
+static void perfTestSamplePose(const std::string& name, const AnimationData& data, int anim_a, int anim_b)
+{
+	const int N = 100000;
+	js::Vector<float, 16> times_a(N), times_b(N);
+	for(int i=0; i<N; ++i)
+	{
+		times_a[i] = Maths::floatMod(i * 0.016f, data.animations[anim_a]->anim_len);
+		times_b[i] = Maths::floatMod(i * 0.016f, data.animations[anim_b]->anim_len);
+	}
+
+	js::Vector<AnimationKeyFrameLocation, 16> key_frame_locs;
+	AnimationPose pose;
+	float sum = 0;
+
+	Timer timer;
+	for(int i=0; i<N; ++i)
+	{
+		samplePosePreSIMD(data, anim_a, anim_b, times_a[i], times_b[i], 0.5f, key_frame_locs, pose);
+		sum += pose.rot[0].v[3];
+	}
+	const double old_time = timer.elapsed() / N;
+
+	key_frame_locs.clear();
+	timer.reset();
+	for(int i=0; i<N; ++i)
+	{
+		data.samplePose(anim_a, anim_b, times_a[i], times_b[i], 0.5f, key_frame_locs, pose);
+		sum += pose.rot[0].v[3];
+	}
+	const double simd_time = timer.elapsed() / N;
+
+	conPrint("samplePose() for " + name + ", " + toString(data.nodes.size()) + " nodes: previous code path: " + doubleToStringNSigFigs(old_time * 1.0e6, 4) + " us, SIMD with keyframe cursor: " + 
+		doubleToStringNSigFigs(simd_time * 1.0e6, 4) + " us (" + doubleToStringNSigFigs(old_time / simd_time, 3) + "x speedup)  (sum: " + toString(sum) + ")");
+}
+
+
+static void testSamplePose()
+{
+	BatchedMeshRef mesh = BatchedMesh::readFromFile(TestUtils::getTestReposDir() + "/testfiles/bmesh/Fox_glb_3500729461392160556.bmesh", NULL);
+	const AnimationData& data = mesh->animation_data;
+	testAssert(data.animations.size() >= 2);
+	const int num_anims = (int)data.animations.size();
+
+	// Check the SIMD rotation path and the keyframe search cursor against the reference.  Advance time steadily so the cursor hint is usually right,
+	// with some jumps backwards and changes of animation so the binary search fallback is exercised as well.
+	{
+		js::Vector<AnimationKeyFrameLocation, 16> key_frame_locs; // Kept between calls, as OpenGLEngine does.
+		AnimationPose pose, ref_pose;
+		float t = 0;
+		for(int i=0; i<2000; ++i)
+		{
+			const int anim_a = (i / 500) % num_anims;
+			const int anim_b = (anim_a + 1) % num_anims;
+			const float transition_frac = (i % 3 == 0) ? 0.f : ((i % 3 == 1) ? 1.f : (i % 100) * 0.01f);
+			t = (i % 250 == 0) ? 0.f : t + 0.016f;
+
+			// Wrap the times into the animations, as OpenGLEngine does.
+			const float t_a = Maths::floatMod(t,        data.animations[anim_a]->anim_len);
+			const float t_b = Maths::floatMod(t * 0.7f, data.animations[anim_b]->anim_len);
+
+			data.samplePose(anim_a, anim_b, t_a, t_b, transition_frac, key_frame_locs, pose);
+			samplePoseReference(data, anim_a, anim_b, t_a, t_b, transition_frac, ref_pose);
+
+			testAssert(pose.rot.size() == data.nodes.size());
+			for(size_t n=0; n<data.nodes.size(); ++n)
+			{
+				// samplePose() finds the keyframes and fractions differently, and uses SIMD, so allow for rounding error.
+				testAssert(epsEqual(pose.trans[n], ref_pose.trans[n], 1.0e-4f));
+				testAssert(epsEqual(pose.scale[n], ref_pose.scale[n], 1.0e-4f));
+				testAssert(epsEqual(pose.rot[n].v, ref_pose.rot[n].v, 1.0e-4f));
+
+				// Check the node matrices built from the poses match as well.
+				Matrix4f ref_node_matrix;
+				makeNodeMatrixReference(ref_pose.trans[n], ref_pose.rot[n], ref_pose.scale[n], ref_node_matrix);
+				const Matrix4f node_matrix = Matrix4f::translationMatrix(pose.trans[n]) * pose.rot[n].toMatrix() * Matrix4f::scaleMatrix(pose.scale[n][0], pose.scale[n][1], pose.scale[n][2]);
+				for(int e=0; e<16; ++e)
+					testAssert(epsEqual(node_matrix.e[e], ref_node_matrix.e[e], 1.0e-3f));
+			}
+		}
+	}
+
+	perfTestSamplePose("Fox", data, 0, 1);
+
+	// Perf test with a bigger skeleton: an avatar with the Idle animation retargeted onto it.
+	try
+	{
+		BatchedMeshRef avatar_mesh = BatchedMesh::readFromFile(TestUtils::getTestReposDir() + "/testfiles/bmesh/meebit_09842_t_solid_vrm.bmesh", NULL);
+		Reference<AnimationData> idle_data = new AnimationData();
+		FileInStream file(TestUtils::getTestReposDir() + "/testfiles/animations/Idle.subanim");
+		file.advanceReadIndex(4); // Skip magic number
+		idle_data->readFromStream(file);
+		idle_data->prepareForMultipleUse();
+		avatar_mesh->animation_data.loadAndRetargetAnim(*idle_data);
+
+		const int idle_i = (int)avatar_mesh->animation_data.animations.size() - 1;
+		perfTestSamplePose("meebit avatar, Idle", avatar_mesh->animation_data, idle_i, idle_i);
+	}
+	catch(glare::Exception& e)
+	{
+		failTest(e.what());
+	}
+}
+
+
+// Compresses the output data of a copy of data, and checks that poses sampled from the compressed data are close to those from the original data.
+static void testCompressionRoundTrip(const std::string& name, const AnimationData& data, AnimationData& compressed_data)
+{
+	const AnimationCompressionParams params;
+
+	const size_t uncompressed_mem = compressed_data.getTotalMemUsage();
+	Timer timer;
+	compressed_data.compressOutputData(params);
+	const double compress_time = timer.elapsed();
+	const size_t compressed_mem = compressed_data.getTotalMemUsage();
+	testAssert(compressed_data.isOutputDataCompressed());
+	testAssert(compressed_data.output_data.empty());
+
+	// Check the measured error of each track is within the bounds
+	int num_encoding[4] = { 0, 0, 0, 0 };
+	std::vector<const js::Vector<CompressedOutputTrack, 16>*> track_vectors(1, &compressed_data.compressed_output_data);
+	for(size_t i=0; i<compressed_data.animations.size(); ++i)
+		track_vectors.push_back(&compressed_data.animations[i]->m_compressed_output_data);
+	for(size_t v=0; v<track_vectors.size(); ++v)
+		for(size_t i=0; i<track_vectors[v]->size(); ++i)
+		{
+			const CompressedOutputTrack& track = (*track_vectors[v])[i];
+			testAssert(track.max_error <= myMax(params.max_translation_error, params.max_rotation_error, params.max_scale_error) || (track.encoding == CompressedOutputTrack::Encoding_Constant));
+			num_encoding[track.encoding]++;
+		}
+
+	// Compare sampled poses
+	js::Vector<AnimationKeyFrameLocation, 16> key_frame_locs, compressed_key_frame_locs;
+	AnimationPose pose, compressed_pose;
+	float max_trans_err = 0, max_rot_err = 0, max_scale_err = 0;
+	for(size_t anim_i=0; anim_i<data.animations.size(); ++anim_i)
+		for(int i=0; i<200; ++i)
+		{
+			const float t = i * 0.0123f;
+			data.samplePose((int)anim_i, (int)anim_i, t, t, 0.f, key_frame_locs, pose);
+			compressed_data.samplePose((int)anim_i, (int)anim_i, t, t, 0.f, compressed_key_frame_locs, compressed_pose);
+			for(size_t n=0; n<pose.trans.size(); ++n)
+			{
+				max_trans_err = myMax(max_trans_err, horizontalMax(abs(pose.trans[n] - compressed_pose.trans[n]).v));
+				max_scale_err = myMax(max_scale_err, horizontalMax(abs(pose.scale[n] - compressed_pose.scale[n]).v));
+				max_rot_err   = myMax(max_rot_err,   horizontalMax(abs(pose.rot[n].v - compressed_pose.rot[n].v).v));
+			}
+		}
+
+	// Interpolated values are within the error bounds of the key values.  Rotations are renormalised after interpolation, which can increase the error slightly.
+	testAssert(max_trans_err <= params.max_translation_error * 1.01f);
+	testAssert(max_scale_err <= params.max_scale_error * 1.01f);
+	testAssert(max_rot_err <= params.max_rotation_error * 4);
+
+	// Time sampling from the compressed data
+	const int N = 10000;
+	double sample_time[2];
+	for(int z=0; z<2; ++z)
+	{
+		const AnimationData& sample_data = (z == 0) ? data : compressed_data;
+		timer.reset();
+		for(int i=0; i<N; ++i)
+			sample_data.samplePose(0, 0, i * 0.016f, i * 0.016f, 0.f, key_frame_locs, pose);
+		sample_time[z] = timer.elapsed() / N;
+	}
+
+	conPrint(name + ": output data compression: mem usage " + toString(uncompressed_mem) + " B -> " + toString(compressed_mem) + " B (" + doubleToStringNSigFigs((double)uncompressed_mem / compressed_mem, 3) + 
+		"x smaller), compression took " + doubleToStringNSigFigs(compress_time * 1.0e3, 3) + " ms");
+	conPrint("    tracks: " + toString(num_encoding[CompressedOutputTrack::Encoding_Constant]) + " constant, " + toString(num_encoding[CompressedOutputTrack::Encoding_QuantisedQuat]) + " quantised quat, " + 
+		toString(num_encoding[CompressedOutputTrack::Encoding_QuantisedVec]) + " quantised vec, " + toString(num_encoding[CompressedOutputTrack::Encoding_Full]) + " full");
+	conPrint("    max pose error: trans: " + doubleToStringNSigFigs(max_trans_err, 3) + ", rot: " + doubleToStringNSigFigs(max_rot_err, 3) + ", scale: " + doubleToStringNSigFigs(max_scale_err, 3));
+	conPrint("    samplePose(): uncompressed: " + doubleToStringNSigFigs(sample_time[0] * 1.0e6, 4) + " us, compressed: " + doubleToStringNSigFigs(sample_time[1] * 1.0e6, 4) + " us");
+
+	// Writing compressed data should fail.
+	try
+	{
+		BufferOutStream buf;
+		compressed_data.writeToStream(buf);
+		failTest("Expected exception");
+	}
+	catch(glare::Exception&)
+	{}
+}
+
+
+static void testCompression()
+{
+	// Animation data in a mesh
+	{
+		BatchedMeshRef mesh = BatchedMesh::readFromFile(TestUtils::getTestReposDir() + "/testfiles/bmesh/Fox_glb_3500729461392160556.bmesh", NULL);
+		BatchedMeshRef mesh2 = BatchedMesh::readFromFile(TestUtils::getTestReposDir() + "/testfiles/bmesh/Fox_glb_3500729461392160556.bmesh", NULL);
+		testCompressionRoundTrip("Fox", mesh->animation_data, mesh2->animation_data);
+	}
+
+	// Animation data loaded from a .subanim file, with the output data in the AnimationDatum, as used for avatar animations.
+	{
+		Reference<AnimationData> data[2];
+		for(int z=0; z<2; ++z)
+		{
+			data[z] = new AnimationData();
+			FileInStream file(TestUtils::getTestReposDir() + "/testfiles/animations/Idle.subanim");
+			file.advanceReadIndex(4); // Skip magic number
+			data[z]->readFromStream(file);
+			data[z]->prepareForMultipleUse();
+		}
+		testCompressionRoundTrip("Idle.subanim", *data[0], *data[1]);
+
+		// Retargetting onto an avatar should work with compressed data.
+		BatchedMeshRef mesh = BatchedMesh::readFromFile(TestUtils::getTestReposDir() + "/testfiles/bmesh/meebit_09842_t_solid_vrm.bmesh", NULL);
+		mesh->animation_data.loadAndRetargetAnim(*data[1]);
+		js::Vector<AnimationKeyFrameLocation, 16> key_frame_locs;
+		AnimationPose pose;
+		mesh->animation_data.samplePose(0, 0, 0.5f, 0.5f, 0.f, key_frame_locs, pose);
+		testAssert(pose.rot.size() == mesh->animation_data.nodes.size());
+	}
+}
+
+
+// Reads node data with a virtual call and bounds check per field, as AnimationNodeData::readFromStream used to.  Used for perf comparison.
+static void readAnimationNodeDataPerField(InStream& stream, AnimationNodeData& node)
+{
+	stream.readData(node.inverse_bind_matrix.e, sizeof(float) * 16);
+	stream.readData(node.trans.x, sizeof(float) * 4);
+	stream.readData(node.rot.v.x, sizeof(float) * 4);
+	stream.readData(node.scale.x, sizeof(float) * 4);
+	node.name = stream.readStringLengthFirst(10000);
+	node.parent_index = stream.readInt32();
+}
+
+
+static void readPerAnimationNodeDataPerField(InStream& stream, PerAnimationNodeData& data)
+{
+	data.translation_input_accessor		= stream.readInt32();
+	data.translation_output_accessor	= stream.readInt32();
+	data.rotation_input_accessor		= stream.readInt32();
+	data.rotation_output_accessor		= stream.readInt32();
+	data.scale_input_accessor			= stream.readInt32();
+	data.scale_output_accessor			= stream.readInt32();
+}
+
+
+// Times decoding of just the node and per-animation node data (no decompression or build()), with per-field virtual reads vs bulk-checked inlined reads.
+static void testNodeDataReadPerf(const AnimationData& data)
+{
+	const int num_copies = 1000;
+	BufferOutStream out_stream;
+	for(int i=0; i<num_copies; ++i)
+	{
+		for(size_t z=0; z<data.nodes.size(); ++z)
+			data.nodes[z].writeToStream(out_stream);
+		for(size_t a=0; a<data.animations.size(); ++a)
+			for(size_t z=0; z<data.animations[a]->raw_per_anim_node_data.size(); ++z)
+				data.animations[a]->raw_per_anim_node_data[z].writeToStream(out_stream);
+	}
+	const ArrayRef<uint8> buf(out_stream.buf.data(), out_stream.buf.size());
+
+	std::vector<AnimationNodeData> nodes(data.nodes.size());
+	std::vector<PerAnimationNodeData> per_anim_node_data;
+
+	double min_per_field_time = 1.0e10;
+	double min_inlined_time = 1.0e10;
+	for(int trial=0; trial<10; ++trial)
+	{
+		{
+			BufferViewInStream buffer_stream(buf);
+			InStream& stream = buffer_stream; // Use the generic InStream interface, so reads are virtual calls.
+			Timer timer;
+			for(int i=0; i<num_copies; ++i)
+			{
+				for(size_t z=0; z<nodes.size(); ++z)
+					readAnimationNodeDataPerField(stream, nodes[z]);
+				for(size_t a=0; a<data.animations.size(); ++a)
+				{
+					per_anim_node_data.resize(data.animations[a]->raw_per_anim_node_data.size());
+					for(size_t z=0; z<per_anim_node_data.size(); ++z)
+						readPerAnimationNodeDataPerField(stream, per_anim_node_data[z]);
+				}
+			}
+			min_per_field_time = myMin(min_per_field_time, timer.elapsed());
+			testAssert(buffer_stream.endOfStream());
+		}
+		{
+			BufferViewInStream stream(buf);
+			Timer timer;
+			for(int i=0; i<num_copies; ++i)
+			{
+				for(size_t z=0; z<nodes.size(); ++z)
+					readAnimationNodeData(stream, nodes[z]);
+				for(size_t a=0; a<data.animations.size(); ++a)
+				{
+					per_anim_node_data.resize(data.animations[a]->raw_per_anim_node_data.size());
+					stream.readData(per_anim_node_data.data(), sizeof(PerAnimationNodeData) * per_anim_node_data.size());
+				}
+			}
+			min_inlined_time = myMin(min_inlined_time, timer.elapsed());
+			testAssert(stream.endOfStream());
+		}
+	}
+
+	for(size_t z=0; z<nodes.size(); ++z)
+	{
+		testAssert(nodes[z].name == data.nodes[z].name);
+		testAssert(nodes[z].inverse_bind_matrix == data.nodes[z].inverse_bind_matrix);
+		testAssert(nodes[z].parent_index == data.nodes[z].parent_index);
+	}
+
+	conPrint("Node data decode (" + toString(buf.size() / 1024) + " KB): per-field virtual reads: " + doubleToStringNSigFigs(min_per_field_time * 1.0e3, 4) + " ms, inlined bulk reads: " + 
+		doubleToStringNSigFigs(min_inlined_time * 1.0e3, 4) + " ms (" + doubleToStringNSigFigs(min_per_field_time / min_inlined_time, 3) + "x speedup)");
+}
+
+
 void AnimationData::test()
 {
 	int a = meshopt_quantizeSnorm(-1.0f, /*N=*/16);
@@ -2058,6 +3264,53 @@ void AnimationData::test()
 	}
 
 
+	// Compare read speed through the generic virtual InStream methods (FileInStream) with the inlined BufferViewInStream path.
+	{
+		FileInStream file(TestUtils::getTestReposDir() + "/testfiles/animations/Idle.subanim");
+		const ArrayRef<uint8> file_data((const uint8*)file.fileData(), file.fileSize());
+
+		const int num_trials = 100;
+		double min_generic_time = 1.0e10;
+		double min_inlined_time = 1.0e10;
+		for(int i=0; i<num_trials; ++i)
+		{
+			AnimationData generic_data;
+			{
+				file.setReadIndex(4); // Skip magic number
+				Timer timer;
+				generic_data.readFromStream(file);
+				min_generic_time = myMin(min_generic_time, timer.elapsed());
+			}
+
+			AnimationData inlined_data;
+			{
+				BufferViewInStream buffer_stream(file_data);
+				buffer_stream.setReadIndex(4); // Skip magic number
+				Timer timer;
+				inlined_data.readFromStream(buffer_stream);
+				min_inlined_time = myMin(min_inlined_time, timer.elapsed());
+			}
+
+			testAssert(inlined_data.nodes.size() == generic_data.nodes.size());
+			testAssert(inlined_data.animations.size() == generic_data.animations.size());
+			for(size_t z=0; z<inlined_data.nodes.size(); ++z)
+			{
+				testAssert(inlined_data.nodes[z].name == generic_data.nodes[z].name);
+				testAssert(inlined_data.nodes[z].inverse_bind_matrix == generic_data.nodes[z].inverse_bind_matrix);
+				testAssert(inlined_data.nodes[z].parent_index == generic_data.nodes[z].parent_index);
+			}
+		}
+		conPrint("readFromStream() with FileInStream (virtual reads):        " + doubleToStringNSigFigs(min_generic_time * 1.0e6, 4) + " us");
+		conPrint("readFromStream() with BufferViewInStream (inlined reads):  " + doubleToStringNSigFigs(min_inlined_time * 1.0e6, 4) + " us");
+
+		AnimationData data;
+		BufferViewInStream buffer_stream(file_data);
+		buffer_stream.setReadIndex(4); // Skip magic number
+		data.readFromStream(buffer_stream);
+		testNodeDataReadPerf(data);
+	}
+
+
 	// Test animation retargetting
 	{
 		BatchedMeshRef mesh = BatchedMesh::readFromFile(TestUtils::getTestReposDir() + "/testfiles/bmesh/meebit_09842_t_solid_vrm.bmesh", NULL);
@@ -2071,6 +3324,10 @@ void AnimationData::test()
 
 		testAssert(mesh->animation_data.nodes.size() == 68);
 	}
+
+	testSamplePose();
+
+	testCompression();
 }
 
 
@@ -83,6 +83,70 @@ struct KeyFrameTimeInfo
 };
 
 
+// A compressed in-memory representation of the values of an output accessor (translations, rotations or scales), built by AnimationData::compressOutputData().
+// Values are decoded on the fly when sampling.
+struct CompressedOutputTrack
+{
+	enum Encoding
+	{
+		Encoding_Constant,			// All values are within the error bound of a single value, stored in offset.
+		Encoding_QuantisedQuat,		// Values are quaternions stored as 4 x int16 SNORM per value.
+		Encoding_QuantisedVec,		// Values are stored as 4 x uint16 per value, value = offset + quantised * scale.
+		Encoding_Full				// Quantisation would exceed the error bound, so values are stored in full_values.
+	};
+
+	GLARE_ALIGNED_16_NEW_DELETE
+
+	inline const Vec4f getValue(size_t i) const;
+
+	size_t getTotalMemUsage() const;
+
+	Vec4f offset;
+	Vec4f scale;
+	js::Vector<uint16, 16> quantised; // 4 components per value.
+	js::Vector<Vec4f, 16> full_values;
+	uint32 num_values;
+	Encoding encoding;
+	float max_error; // Max absolute error of any decoded value component, measured when compressing.
+};
+
+
+const Vec4f CompressedOutputTrack::getValue(size_t i) const
+{
+	assert(i < num_values);
+	switch(encoding)
+	{
+	case Encoding_Constant:
+		return offset;
+	case Encoding_QuantisedQuat:
+	{
+		const __m128i q16 = _mm_loadl_epi64((const __m128i*)(quantised.data() + i * 4));
+		const __m128i q32 = _mm_srai_epi32(_mm_unpacklo_epi16(q16, q16), 16); // Sign-extend to 32 bits.
+		return Vec4f(_mm_cvtepi32_ps(q32)) * (1 / 32767.f);
+	}
+	case Encoding_QuantisedVec:
+	{
+		const __m128i q16 = _mm_loadl_epi64((const __m128i*)(quantised.data() + i * 4));
+		const __m128i q32 = _mm_unpacklo_epi16(q16, _mm_setzero_si128()); // Zero-extend to 32 bits.
+		return offset + Vec4f(_mm_cvtepi32_ps(q32)) * scale;
+	}
+	default:
+		return full_values[i];
+	}
+}
+
+
+// Error bounds for AnimationData::compressOutputData().  Errors are the max absolute error in each component of a decoded value.
+struct AnimationCompressionParams
+{
+	AnimationCompressionParams() : max_translation_error(1.0e-4f), max_rotation_error(1.0e-4f), max_scale_error(1.0e-4f) {}
+
+	float max_translation_error; // In model space units, so usually metres.
+	float max_rotation_error; // For unit quaternion components.
+	float max_scale_error;
+};
+
+
 // Data that can be loaded once and shared among multiple different meshes.  Will not be changed by retargetting.
 struct AnimationDatum : public ThreadSafeRefCounted
 {
@@ -91,7 +155,7 @@ struct AnimationDatum : public ThreadSafeRefCounted
 	void writeToStream(OutStream& stream) const;
 	void readFromStream(uint32 file_version, InStream& stream, js::Vector<KeyFrameTimeInfo>& old_keyframe_times_out, js::Vector<js::Vector<Vec4f, 16> >& old_output_data);
 
-	void checkData(const js::Vector<KeyFrameTimeInfo>& keyframe_times, const js::Vector<js::Vector<Vec4f, 16> >& output_data) const;
+	void checkData(const js::Vector<KeyFrameTimeInfo>& keyframe_times, const js::Vector<js::Vector<Vec4f, 16> >& output_data, const js::Vector<CompressedOutputTrack, 16>& compressed_output_data) const;
 
 	size_t getTotalMemUsage() const;
 
@@ -104,11 +168,30 @@ struct AnimationDatum : public ThreadSafeRefCounted
 	// These can be empty, in which case the base AnimationData::keyframe_times and outout_data are used.  They should be non-empty for AnimationDatum objects shared by multiple avatars, that need to do retargetting.
 	js::Vector<KeyFrameTimeInfo> m_keyframe_times; // For each input accessor index, a vector of input keyframe times, and some precomputed info about the times.
 	js::Vector<js::Vector<Vec4f, 16> > m_output_data; // For each output accessor index, a vector of translations, rotations or scales.
+	js::Vector<CompressedOutputTrack, 16> m_compressed_output_data; // If non-empty, the compressed form of m_output_data, which will have been freed.
 
 	float anim_len;
 };
 
 
+struct AnimationKeyFrameLocation
+{
+	int i_0;
+	int i_1;
+	float frac;
+};
+
+
+// The sampled local (relative to parent node) transformation of each node, at some time in an animation, possibly blended between two animations.
+// Indexed by node index.
+struct AnimationPose
+{
+	js::Vector<Vec4f, 16> trans;
+	js::Vector<Quatf, 16> rot;
+	js::Vector<Vec4f, 16> scale;
+};
+
+
 struct VRMBoneInfo
 {
 	int node_index;
@@ -198,10 +281,26 @@ struct AnimationData : public ThreadSafeRefCounted
 
 	size_t getTotalMemUsage() const;
 
+	// Replaces output_data, and the output data of each animation, with quantised versions that are within the error bounds given by params.  
+	// Constant tracks are reduced to a single value.  Shared AnimationDatum objects are compressed in place, so this should be done at load time, before the data is used.
+	// After compression the data can be sampled with samplePose() and retargeted, but not written to a stream.
+	void compressOutputData(const AnimationCompressionParams& params);
+	bool isOutputDataCompressed() const;
+
+	// Samples animation anim_a_i at in_anim_time_a and animation anim_b_i at in_anim_time_b, and blends between them with transition_frac 
+	// (0 = fully animation a, 1 = fully animation b).  Writes the local transformation of each node to pose_out.
+	// key_frame_locs is working space.  If it is kept between calls, the keyframes found by the previous call are used as the starting point for the keyframe search,
+	// which avoids a binary search when the animation times are advancing steadily.
+	void samplePose(int anim_a_i, int anim_b_i, float in_anim_time_a, float in_anim_time_b, float transition_frac, js::Vector<AnimationKeyFrameLocation, 16>& key_frame_locs, 
+		AnimationPose& pose_out) const;
+
 	static void test();
 private:
 	Matrix4f getNodeToObjectSpaceTransform(int node_index, bool use_retarget_adjustment) const;
 	Vec4f transformPointToNodeParentSpace(int node_index, bool use_retarget_adjustment, const Vec4f& point_node_space) const;
+
+	// Templated on the stream type, so that reads from the final buffer stream classes are non-virtual and can be inlined.
+	template <class StreamType> void readFromStreamImpl(StreamType& stream);
 public:
 	
 	// NOTE: update operator = if changing fields.
@@ -213,6 +312,7 @@ public:
 	js::Vector<KeyFrameTimeInfo> keyframe_times; // For each input accessor index, a vector of input keyframe times, and some precomputed info about the times.
 
 	js::Vector<js::Vector<Vec4f, 16> > output_data; // For each output accessor index, a vector of translations, rotations or scales.
+	js::Vector<CompressedOutputTrack, 16> compressed_output_data; // If non-empty, the compressed form of output_data, which will have been freed.  See compressOutputData().
 
 	std::vector<Reference<AnimationDatum> > animations;
 
@@ -222,11 +322,3 @@ public:
 
 	bool retarget_adjustments_set; // A single AnimationData can be referenced by multiple avatars with the same glmeshdata.  Use this to make sure we only do retargetting once for the animation data. 
 };
-
-
-struct AnimationKeyFrameLocation
-{
-	int i_0;
-	int i_1;
-	float frac;
-};
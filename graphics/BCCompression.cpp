@@ -0,0 +1,1664 @@
+/*=====================================================================
+BCCompression.cpp
+-----------------
+Copyright Glare Technologies Limited 2026 -
+=====================================================================*/
+#include "BCCompression.h"
+
+
+#include "../maths/mathstypes.h"
+#include "../utils/Task.h"
+#include "../utils/TaskManager.h"
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+
+
+namespace BCCompression
+{
+
+
+// Accumulates bits into a 128-bit block, least significant bit first.
+struct BlockBitWriter
+{
+	BlockBitWriter() : lo(0), hi(0), pos(0) {}
+
+	void write(uint64 val, int num_bits)
+	{
+		assert(num_bits < 64 && pos + num_bits <= 128);
+		if(pos < 64)
+		{
+			lo |= val << pos;
+			if(pos + num_bits > 64)
+				hi |= val >> (64 - pos);
+		}
+		else
+			hi |= val << (pos - 64);
+		pos += num_bits;
+	}
+
+	void writeTo(uint8* block_out) const
+	{
+		assert(pos == 128);
+		std::memcpy(block_out, &lo, 8);
+		std::memcpy(block_out + 8, &hi, 8);
+	}
+
+	uint64 lo, hi;
+	int pos;
+};
+
+
+struct BlockBitReader
+{
+	BlockBitReader(const uint8* block) : pos(0)
+	{
+		std::memcpy(&lo, block, 8);
+		std::memcpy(&hi, block + 8, 8);
+	}
+
+	uint32 read(int num_bits)
+	{
+		assert(num_bits < 32 && pos + num_bits <= 128);
+		uint64 v;
+		if(pos < 64)
+		{
+			v = lo >> pos;
+			if(pos + num_bits > 64)
+				v |= hi << (64 - pos);
+		}
+		else
+			v = hi >> (pos - 64);
+		pos += num_bits;
+		return (uint32)(v & ((1ull << num_bits) - 1));
+	}
+
+	uint64 lo, hi;
+	int pos;
+};
+
+
+//=========================================== BC7 ===========================================
+
+
+// Interpolation weights for 2, 3 and 4-bit BC7 indices, out of 64.
+static const int bc7_weights2[4] = { 0, 21, 43, 64 };
+static const int bc7_weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const int bc7_weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+
+static inline const int* getBC7Weights(int index_bits)
+{
+	return (index_bits == 2) ? bc7_weights2 : ((index_bits == 3) ? bc7_weights3 : bc7_weights4);
+}
+
+
+// Subset of each pixel, for each of the 64 two-subset partitions.
+static const uint8 bc7_partition2[64 * 16] =
+{
+	0,0,1,1,0,0,1,1,0,0,1,1,0,0,1,1,
+	0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,1,
+	0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1,
+	0,0,0,1,0,0,1,1,0,0,1,1,0,1,1,1,
+	0,0,0,0,0,0,0,1,0,0,0,1,0,0,1,1,
+	0,0,1,1,0,1,1,1,0,1,1,1,1,1,1,1,
+	0,0,0,1,0,0,1,1,0,1,1,1,1,1,1,1,
+	0,0,0,0,0,0,0,1,0,0,1,1,0,1,1,1,
+	0,0,0,0,0,0,0,0,0,0,0,1,0,0,1,1,
+	0,0,1,1,0,1,1,1,1,1,1,1,1,1,1,1,
+	0,0,0,0,0,0,0,1,0,1,1,1,1,1,1,1,
+	0,0,0,0,0,0,0,0,0,0,0,1,0,1,1,1,
+	0,0,0,1,0,1,1,1,1,1,1,1,1,1,1,1,
+	0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1,
+	0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1,
+	0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1,
+	0,0,0,0,1,0,0,0,1,1,1,0,1,1,1,1,
+	0,1,1,1,0,0,0,1,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,1,0,0,0,1,1,1,0,
+	0,1,1,1,0,0,1,1,0,0,0,1,0,0,0,0,
+	0,0,1,1,0,0,0,1,0,0,0,0,0,0,0,0,
+	0,0,0,0,1,0,0,0,1,1,0,0,1,1,1,0,
+	0,0,0,0,0,0,0,0,1,0,0,0,1,1,0,0,
+	0,1,1,1,0,0,1,1,0,0,1,1,0,0,0,1,
+	0,0,1,1,0,0,0,1,0,0,0,1,0,0,0,0,
+	0,0,0,0,1,0,0,0,1,0,0,0,1,1,0,0,
+	0,1,1,0,0,1,1,0,0,1,1,0,0,1,1,0,
+	0,0,1,1,0,1,1,0,0,1,1,0,1,1,0,0,
+	0,0,0,1,0,1,1,1,1,1,1,0,1,0,0,0,
+	0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0,
+	0,1,1,1,0,0,0,1,1,0,0,0,1,1,1,0,
+	0,0,1,1,1,0,0,1,1,0,0,1,1,1,0,0,
+	0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,
+	0,0,0,0,1,1,1,1,0,0,0,0,1,1,1,1,
+	0,1,0,1,1,0,1,0,0,1,0,1,1,0,1,0,
+	0,0,1,1,0,0,1,1,1,1,0,0,1,1,0,0,
+	0,0,1,1,1,1,0,0,0,0,1,1,1,1,0,0,
+	0,1,0,1,0,1,0,1,1,0,1,0,1,0,1,0,
+	0,1,1,0,1,0,0,1,0,1,1,0,1,0,0,1,
+	0,1,0,1,1,0,1,0,1,0,1,0,0,1,0,1,
+	0,1,1,1,0,0,1,1,1,1,0,0,1,1,1,0,
+	0,0,0,1,0,0,1,1,1,1,0,0,1,0,0,0,
+	0,0,1,1,0,0,1,0,0,1,0,0,1,1,0,0,
+	0,0,1,1,1,0,1,1,1,1,0,1,1,1,0,0,
+	0,1,1,0,1,0,0,1,1,0,0,1,0,1,1,0,
+	0,0,1,1,1,1,0,0,1,1,0,0,0,0,1,1,
+	0,1,1,0,0,1,1,0,1,0,0,1,1,0,0,1,
+	0,0,0,0,0,1,1,0,0,1,1,0,0,0,0,0,
+	0,1,0,0,1,1,1,0,0,1,0,0,0,0,0,0,
+	0,0,1,0,0,1,1,1,0,0,1,0,0,0,0,0,
+	0,0,0,0,0,0,1,0,0,1,1,1,0,0,1,0,
+	0,0,0,0,0,1,0,0,1,1,1,0,0,1,0,0,
+	0,1,1,0,1,1,0,0,1,0,0,1,0,0,1,1,
+	0,0,1,1,0,1,1,0,1,1,0,0,1,0,0,1,
+	0,1,1,0,0,0,1,1,1,0,0,1,1,1,0,0,
+	0,0,1,1,1,0,0,1,1,1,0,0,0,1,1,0,
+	0,1,1,0,1,1,0,0,1,1,0,0,1,0,0,1,
+	0,1,1,0,0,0,1,1,0,0,1,1,1,0,0,1,
+	0,1,1,1,1,1,1,0,1,0,0,0,0,0,0,1,
+	0,0,0,1,1,0,0,0,1,1,1,0,0,1,1,1,
+	0,0,0,0,1,1,1,1,0,0,1,1,0,0,1,1,
+	0,0,1,1,0,0,1,1,1,1,1,1,0,0,0,0,
+	0,0,1,0,0,0,1,0,1,1,1,0,1,1,1,0,
+	0,1,0,0,0,1,0,0,0,1,1,1,0,1,1,1,
+};
+
+
+// Index of the anchor pixel of the second subset, for each two-subset partition.  The anchor pixel of the first subset is always pixel 0.
+static const uint8 bc7_anchor_second_subset[64] =
+{
+	15,15,15,15,15,15,15,15, 15,15,15,15,15,15,15,15,
+	15, 2, 8, 2, 2, 8, 8,15,  2, 8, 2, 2, 8, 8, 2, 2,
+	15,15, 6, 8, 2, 8,15,15,  2, 8, 2, 2, 2,15,15, 6,
+	 6, 2, 6, 8,15,15, 2, 2, 15,15,15,15,15, 2, 2,15
+};
+
+
+// Describes how the endpoints and indices of a subset are stored in a particular mode.
+struct BC7SubsetFormat
+{
+	int num_channels;  // Number of channels stored in the endpoints.  Pixel values for any following channels should be zero.
+	int endpoint_bits; // Bits per endpoint channel, not including any p-bit.
+	int num_pbits;     // 0: no p-bits, 1: one p-bit shared by both endpoints, 2: a p-bit for each endpoint.
+	int index_bits;
+};
+
+static const BC7SubsetFormat bc7_mode1_format        = { 3, 6, 1, 3 };
+static const BC7SubsetFormat bc7_mode5_colour_format = { 3, 7, 0, 2 };
+static const BC7SubsetFormat bc7_mode5_alpha_format  = { 1, 8, 0, 2 };
+static const BC7SubsetFormat bc7_mode6_format        = { 4, 7, 2, 4 };
+
+
+// Quantised endpoints and indices for the pixels of a subset.
+struct BC7SubsetEncoding
+{
+	int q[2][4]; // Quantised endpoint values.  Zero for channels not stored.
+	int p[2]; // p-bits.  Both the same for a shared p-bit, and zero if the format has no p-bits.
+	uint8 indices[16]; // Index for each pixel of the subset
+};
+
+
+static inline int unquantiseBC7(int q, int p, const BC7SubsetFormat& format)
+{
+	const int has_p = (format.num_pbits > 0) ? 1 : 0;
+	const int bits = format.endpoint_bits + has_p;
+	const int v = (q << has_p) | p;
+	return (v << (8 - bits)) | (v >> (2 * bits - 8)); // Replicate the high bits into the low bits.
+}
+
+
+static inline void computeBC7Palette(const BC7SubsetEncoding& enc, const BC7SubsetFormat& format, int palette[16][4])
+{
+	int e0[4] = { 0, 0, 0, 0 };
+	int e1[4] = { 0, 0, 0, 0 };
+	for(int c=0; c<format.num_channels; ++c)
+	{
+		e0[c] = unquantiseBC7(enc.q[0][c], enc.p[0], format);
+		e1[c] = unquantiseBC7(enc.q[1][c], enc.p[1], format);
+	}
+
+	const int* const weights = getBC7Weights(format.index_bits);
+	const int num_indices = 1 << format.index_bits;
+	for(int i=0; i<num_indices; ++i)
+	{
+		const int w = weights[i];
+		for(int c=0; c<4; ++c)
+			palette[i][c] = ((64 - w) * e0[c] + w * e1[c] + 32) >> 6;
+	}
+}
+
+
+static inline int paletteEntryError(const int px[4], const int entry[4])
+{
+	const int dr = px[0] - entry[0];
+	const int dg = px[1] - entry[1];
+	const int db = px[2] - entry[2];
+	const int da = px[3] - entry[3];
+	return dr*dr + dg*dg + db*db + da*da;
+}
+
+
+// Chooses indices for the endpoints in enc.  Returns the total squared error over the pixels.
+// If exhaustive is false, the indices are found by projecting onto the line between the endpoints, and checking the neighbouring indices.
+static int computeBC7Indices(const int px[16][4], int num_px, const BC7SubsetFormat& format, BC7SubsetEncoding& enc, bool exhaustive)
+{
+	int palette[16][4];
+	computeBC7Palette(enc, format, palette);
+	const int max_index = (1 << format.index_bits) - 1;
+
+	int total_err = 0;
+	if(exhaustive)
+	{
+		for(int i=0; i<num_px; ++i)
+		{
+			int best_err = std::numeric_limits<int>::max();
+			int best_index = 0;
+			for(int z=0; z<=max_index; ++z)
+			{
+				const int err = paletteEntryError(px[i], palette[z]);
+				if(err < best_err)
+				{
+					best_err = err;
+					best_index = z;
+				}
+			}
+			enc.indices[i] = (uint8)best_index;
+			total_err += best_err;
+		}
+	}
+	else
+	{
+		int dir[4];
+		for(int c=0; c<4; ++c)
+			dir[c] = palette[max_index][c] - palette[0][c];
+		const int len2 = dir[0]*dir[0] + dir[1]*dir[1] + dir[2]*dir[2] + dir[3]*dir[3];
+		const float scale = (len2 > 0) ? ((float)max_index / (float)len2) : 0.f;
+
+		for(int i=0; i<num_px; ++i)
+		{
+			const int dot = (px[i][0] - palette[0][0]) * dir[0] + (px[i][1] - palette[0][1]) * dir[1] + (px[i][2] - palette[0][2]) * dir[2] + (px[i][3] - palette[0][3]) * dir[3];
+			const int guess = myClamp((int)((float)dot * scale + 0.5f), 0, max_index);
+
+			int best_index = guess;
+			int best_err = paletteEntryError(px[i], palette[guess]);
+			if(guess > 0)
+			{
+				const int err = paletteEntryError(px[i], palette[guess - 1]);
+				if(err < best_err) { best_err = err; best_index = guess - 1; }
+			}
+			if(guess < max_index)
+			{
+				const int err = paletteEntryError(px[i], palette[guess + 1]);
+				if(err < best_err) { best_err = err; best_index = guess + 1; }
+			}
+			enc.indices[i] = (uint8)best_index;
+			total_err += best_err;
+		}
+	}
+	return total_err;
+}
+
+
+// Quantises the endpoint e with the given p-bit.  Returns the squared quantisation error.
+static float quantiseBC7Endpoint(const float e[4], int p, const BC7SubsetFormat& format, int q_out[4])
+{
+	const int has_p = (format.num_pbits > 0) ? 1 : 0;
+	const int max_q = (1 << format.endpoint_bits) - 1;
+	const float scale = (float)((1 << (format.endpoint_bits + has_p)) - 1) * (1.f / 255);
+
+	float err = 0;
+	for(int c=0; c<4; ++c)
+	{
+		if(c >= format.num_channels)
+		{
+			q_out[c] = 0;
+			continue;
+		}
+
+		// Unquantisation isn't quite linear, so check the quantised values around the estimate.
+		const int q_guess = myClamp((int)std::floor((e[c] * scale - (float)p) / (float)(1 << has_p) + 0.5f), 0, max_q);
+		float best_d2 = std::numeric_limits<float>::max();
+		for(int q = myMax(0, q_guess - 1); q <= myMin(max_q, q_guess + 1); ++q)
+		{
+			const float d = e[c] - (float)unquantiseBC7(q, p, format);
+			if(d * d < best_d2)
+			{
+				best_d2 = d * d;
+				q_out[c] = q;
+			}
+		}
+		err += best_d2;
+	}
+	return err;
+}
+
+
+// Quantises the endpoints e0, e1 with the p-bit combinations appropriate for the format and quality level, computes indices, and updates best and best_err if the result has lower error.
+static void tryBC7Endpoints(const int px[16][4], int num_px, const BC7SubsetFormat& format, const float e0[4], const float e1[4], Quality quality, bool opaque, BC7SubsetEncoding& best, int& best_err)
+{
+	int p_combos[4][2];
+	int num_p_combos;
+	int q_temp[4];
+	if(format.num_pbits == 0)
+	{
+		p_combos[0][0] = p_combos[0][1] = 0;
+		num_p_combos = 1;
+	}
+	else if(opaque)
+	{
+		// Alpha can only be exactly 255 with p = 1 for both endpoints.
+		assert(format.num_pbits == 2 && format.num_channels == 4);
+		p_combos[0][0] = p_combos[0][1] = 1;
+		num_p_combos = 1;
+	}
+	else if(format.num_pbits == 1)
+	{
+		if(quality == Quality_High)
+		{
+			p_combos[0][0] = p_combos[0][1] = 0;
+			p_combos[1][0] = p_combos[1][1] = 1;
+			num_p_combos = 2;
+		}
+		else
+		{
+			const float err_0 = quantiseBC7Endpoint(e0, 0, format, q_temp) + quantiseBC7Endpoint(e1, 0, format, q_temp);
+			const float err_1 = quantiseBC7Endpoint(e0, 1, format, q_temp) + quantiseBC7Endpoint(e1, 1, format, q_temp);
+			p_combos[0][0] = p_combos[0][1] = (err_1 < err_0) ? 1 : 0;
+			num_p_combos = 1;
+		}
+	}
+	else if(quality == Quality_High)
+	{
+		for(int i=0; i<4; ++i)
+		{
+			p_combos[i][0] = i & 1;
+			p_combos[i][1] = i >> 1;
+		}
+		num_p_combos = 4;
+	}
+	else
+	{
+		// Choose the p-bit for each endpoint that minimises its quantisation error.
+		p_combos[0][0] = (quantiseBC7Endpoint(e0, 1, format, q_temp) < quantiseBC7Endpoint(e0, 0, format, q_temp)) ? 1 : 0;
+		p_combos[0][1] = (quantiseBC7Endpoint(e1, 1, format, q_temp) < quantiseBC7Endpoint(e1, 0, format, q_temp)) ? 1 : 0;
+		num_p_combos = 1;
+	}
+
+	for(int i=0; i<num_p_combos; ++i)
+	{
+		BC7SubsetEncoding enc;
+		enc.p[0] = p_combos[i][0];
+		enc.p[1] = p_combos[i][1];
+		quantiseBC7Endpoint(e0, enc.p[0], format, enc.q[0]);
+		quantiseBC7Endpoint(e1, enc.p[1], format, enc.q[1]);
+		if(opaque)
+			enc.q[0][3] = enc.q[1][3] = 127;
+
+		const int err = computeBC7Indices(px, num_px, format, enc, /*exhaustive=*/quality != Quality_Fast);
+		if(err < best_err)
+		{
+			best = enc;
+			best_err = err;
+		}
+	}
+}
+
+
+// Finds endpoints and indices for the pixels px[0, num_px) in the given format.  Returns the total squared error.
+// If opaque is true, the format must be the mode 6 format and the pixels must all have alpha 255.  The encoded alpha is then exactly 255.
+static int fitBC7Subset(const int px[16][4], int num_px, const BC7SubsetFormat& format, Quality quality, bool opaque, BC7SubsetEncoding& best)
+{
+	assert(num_px > 0);
+
+	// Compute mean and covariance
+	float mean[4] = { 0, 0, 0, 0 };
+	int min_col[4] = { 255, 255, 255, 255 };
+	int max_col[4] = { 0, 0, 0, 0 };
+	for(int i=0; i<num_px; ++i)
+		for(int c=0; c<4; ++c)
+		{
+			mean[c] += (float)px[i][c];
+			min_col[c] = myMin(min_col[c], px[i][c]);
+			max_col[c] = myMax(max_col[c], px[i][c]);
+		}
+	for(int c=0; c<4; ++c)
+		mean[c] *= 1.f / (float)num_px;
+
+	float cov[4][4] = { { 0 } };
+	for(int i=0; i<num_px; ++i)
+	{
+		float d[4];
+		for(int c=0; c<4; ++c)
+			d[c] = (float)px[i][c] - mean[c];
+		for(int a=0; a<4; ++a)
+			for(int b=a; b<4; ++b)
+				cov[a][b] += d[a] * d[b];
+	}
+	for(int a=0; a<4; ++a)
+		for(int b=0; b<a; ++b)
+			cov[a][b] = cov[b][a];
+
+	// Find the principal axis with power iteration, starting from the bounding box diagonal.
+	float axis[4];
+	for(int c=0; c<4; ++c)
+		axis[c] = (float)(max_col[c] - min_col[c]);
+	for(int iter=0; iter<8; ++iter)
+	{
+		float new_axis[4];
+		float max_comp = 0;
+		for(int a=0; a<4; ++a)
+		{
+			new_axis[a] = cov[a][0] * axis[0] + cov[a][1] * axis[1] + cov[a][2] * axis[2] + cov[a][3] * axis[3];
+			max_comp = myMax(max_comp, std::fabs(new_axis[a]));
+		}
+		if(max_comp < 1.0e-6f)
+			break; // Keep the previous axis
+		for(int a=0; a<4; ++a)
+			axis[a] = new_axis[a] * (1.f / max_comp);
+	}
+	const float axis_len2 = axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2] + axis[3]*axis[3];
+
+	// Endpoints are given by the extent of the pixels along the axis.
+	float t_min = 0;
+	float t_max = 0;
+	if(axis_len2 > 0) // axis_len2 is zero if all the pixels are the same.
+		for(int i=0; i<num_px; ++i)
+		{
+			const float t = (((float)px[i][0] - mean[0]) * axis[0] + ((float)px[i][1] - mean[1]) * axis[1] + ((float)px[i][2] - mean[2]) * axis[2] + ((float)px[i][3] - mean[3]) * axis[3]) / axis_len2;
+			t_min = myMin(t_min, t);
+			t_max = myMax(t_max, t);
+		}
+
+	float e0[4], e1[4];
+	for(int c=0; c<4; ++c)
+	{
+		e0[c] = myClamp(mean[c] + t_min * axis[c], 0.f, 255.f);
+		e1[c] = myClamp(mean[c] + t_max * axis[c], 0.f, 255.f);
+	}
+
+	int best_err = std::numeric_limits<int>::max();
+	tryBC7Endpoints(px, num_px, format, e0, e1, quality, opaque, best, best_err);
+
+	// Refine the endpoints by solving for the least-squares optimal endpoints given the current indices.
+	const int* const weights = getBC7Weights(format.index_bits);
+	const int num_refinement_passes = (quality == Quality_Fast) ? 0 : ((quality == Quality_Normal) ? 1 : 3);
+	for(int pass=0; pass<num_refinement_passes && best_err > 0; ++pass)
+	{
+		float aa = 0, ab = 0, bb = 0;
+		float x0[4] = { 0, 0, 0, 0 };
+		float x1[4] = { 0, 0, 0, 0 };
+		for(int i=0; i<num_px; ++i)
+		{
+			const float w = weights[best.indices[i]] * (1.f / 64);
+			const float one_minus_w = 1.f - w;
+			aa += one_minus_w * one_minus_w;
+			ab += one_minus_w * w;
+			bb += w * w;
+			for(int c=0; c<4; ++c)
+			{
+				x0[c] += one_minus_w * (float)px[i][c];
+				x1[c] += w * (float)px[i][c];
+			}
+		}
+
+		const float det = aa * bb - ab * ab;
+		if(std::fabs(det) < 1.0e-6f)
+			break; // All pixels use the same index.
+
+		const float recip_det = 1.f / det;
+		for(int c=0; c<4; ++c)
+		{
+			e0[c] = myClamp((bb * x0[c] - ab * x1[c]) * recip_det, 0.f, 255.f);
+			e1[c] = myClamp((aa * x1[c] - ab * x0[c]) * recip_det, 0.f, 255.f);
+		}
+
+		const int prev_best_err = best_err;
+		tryBC7Endpoints(px, num_px, format, e0, e1, quality, opaque, best, best_err);
+		if(best_err >= prev_best_err)
+			break;
+	}
+
+	return best_err;
+}
+
+
+// Table of the best endpoints for representing a single value with mode 6, for each p-bit combination and index.
+// Used for solid-colour blocks, which are common, and which the general encoder can't represent exactly when the channels need different p-bits.
+struct BC7SolidEntry
+{
+	uint8 q0, q1, err;
+};
+
+class BC7Mode6SolidTable
+{
+public:
+	BC7Mode6SolidTable()
+	{
+		for(int p0=0; p0<2; ++p0)
+		for(int p1=0; p1<2; ++p1)
+		for(int index=0; index<16; ++index)
+		{
+			const int w = bc7_weights4[index];
+			for(int v=0; v<256; ++v)
+			{
+				BC7SolidEntry best = { 0, 0, 255 };
+				for(int q0=0; q0<128 && best.err > 0; ++q0)
+				{
+					const int e0 = (q0 << 1) | p0;
+					if(w == 0)
+					{
+						const int err = std::abs(e0 - v);
+						if(err < best.err) { best.q0 = (uint8)q0; best.q1 = (uint8)q0; best.err = (uint8)err; }
+						continue;
+					}
+
+					// Solve ((64 - w) * e0 + w * e1 + 32) >> 6 = v for e1, then check the nearby quantised values.
+					const float e1_target = (64.f * v - (64 - w) * e0) / w;
+					const int q1_guess = (int)std::floor((e1_target - p1) * 0.5f + 0.5f);
+					for(int q1 = myMax(0, q1_guess - 1); q1 <= myMin(127, q1_guess + 1); ++q1)
+					{
+						const int e1 = (q1 << 1) | p1;
+						const int err = std::abs((((64 - w) * e0 + w * e1 + 32) >> 6) - v);
+						if(err < best.err) { best.q0 = (uint8)q0; best.q1 = (uint8)q1; best.err = (uint8)err; }
+					}
+				}
+				entries[p0][p1][index][v] = best;
+			}
+		}
+	}
+
+	BC7SolidEntry entries[2][2][16][256];
+};
+
+
+static const BC7Mode6SolidTable& getBC7SolidTable()
+{
+	static const BC7Mode6SolidTable table; // Built on first use.  Initialisation of function-local statics is threadsafe.
+	return table;
+}
+
+
+static void encodeBC7Mode6SolidBlock(const int col[4], bool opaque, BC7SubsetEncoding& enc_out)
+{
+	const BC7Mode6SolidTable& table = getBC7SolidTable();
+
+	int best_err = std::numeric_limits<int>::max();
+	for(int p0 = (opaque ? 1 : 0); p0<2; ++p0)
+	for(int p1 = (opaque ? 1 : 0); p1<2; ++p1)
+	for(int index=0; index<16; ++index)
+	{
+		int err = 0;
+		for(int c=0; c<4; ++c)
+		{
+			const int e = table.entries[p0][p1][index][col[c]].err;
+			err += e * e;
+		}
+		if(err < best_err)
+		{
+			best_err = err;
+			enc_out.p[0] = p0;
+			enc_out.p[1] = p1;
+			for(int c=0; c<4; ++c)
+			{
+				enc_out.q[0][c] = table.entries[p0][p1][index][col[c]].q0;
+				enc_out.q[1][c] = table.entries[p0][p1][index][col[c]].q1;
+			}
+			for(int i=0; i<16; ++i)
+				enc_out.indices[i] = (uint8)index;
+		}
+	}
+}
+
+
+// The most significant bit of the index of an anchor pixel is implicitly 0, so swap the endpoints of the subset if needed.
+static void fixBC7AnchorIndex(BC7SubsetEncoding& enc, int num_px, const BC7SubsetFormat& format, int anchor_i)
+{
+	if(enc.indices[anchor_i] & (1 << (format.index_bits - 1)))
+	{
+		for(int c=0; c<4; ++c)
+			mySwap(enc.q[0][c], enc.q[1][c]);
+		mySwap(enc.p[0], enc.p[1]);
+		const int max_index = (1 << format.index_bits) - 1;
+		for(int i=0; i<num_px; ++i)
+			enc.indices[i] = (uint8)(max_index - enc.indices[i]);
+	}
+}
+
+
+static void writeBC7Mode6Block(BC7SubsetEncoding enc, uint8* block_out)
+{
+	fixBC7AnchorIndex(enc, 16, bc7_mode6_format, 0);
+
+	BlockBitWriter writer;
+	writer.write(1 << 6, 7); // Mode 6: 6 zero bits followed by a one bit.
+	for(int c=0; c<4; ++c)
+	{
+		writer.write(enc.q[0][c], 7);
+		writer.write(enc.q[1][c], 7);
+	}
+	writer.write(enc.p[0], 1);
+	writer.write(enc.p[1], 1);
+	writer.write(enc.indices[0], 3);
+	for(int i=1; i<16; ++i)
+		writer.write(enc.indices[i], 4);
+	writer.writeTo(block_out);
+}
+
+
+static void writeBC7Mode5Block(int rotation, BC7SubsetEncoding colour_enc, BC7SubsetEncoding alpha_enc, uint8* block_out)
+{
+	fixBC7AnchorIndex(colour_enc, 16, bc7_mode5_colour_format, 0);
+	fixBC7AnchorIndex(alpha_enc,  16, bc7_mode5_alpha_format,  0);
+
+	BlockBitWriter writer;
+	writer.write(1 << 5, 6); // Mode 5
+	writer.write(rotation, 2);
+	for(int c=0; c<3; ++c)
+	{
+		writer.write(colour_enc.q[0][c], 7);
+		writer.write(colour_enc.q[1][c], 7);
+	}
+	writer.write(alpha_enc.q[0][0], 8);
+	writer.write(alpha_enc.q[1][0], 8);
+	writer.write(colour_enc.indices[0], 1);
+	for(int i=1; i<16; ++i)
+		writer.write(colour_enc.indices[i], 2);
+	writer.write(alpha_enc.indices[0], 1);
+	for(int i=1; i<16; ++i)
+		writer.write(alpha_enc.indices[i], 2);
+	writer.writeTo(block_out);
+}
+
+
+// Gets the pixel indices of each subset of the two-subset partition, in block order.
+static void getBC7PartitionPixels(int partition, int subset_pixels[2][16], int num_subset_pixels[2])
+{
+	num_subset_pixels[0] = num_subset_pixels[1] = 0;
+	for(int i=0; i<16; ++i)
+	{
+		const int s = bc7_partition2[partition * 16 + i];
+		subset_pixels[s][num_subset_pixels[s]++] = i;
+	}
+}
+
+
+// The subset encodings have indices for the pixels of each subset, in the order given by getBC7PartitionPixels().
+static void writeBC7Mode1Block(int partition, BC7SubsetEncoding subset_enc[2], uint8* block_out)
+{
+	int subset_pixels[2][16];
+	int num_subset_pixels[2];
+	getBC7PartitionPixels(partition, subset_pixels, num_subset_pixels);
+
+	const int anchor_pixel[2] = { 0, bc7_anchor_second_subset[partition] };
+	uint8 block_indices[16];
+	for(int s=0; s<2; ++s)
+	{
+		for(int i=0; i<num_subset_pixels[s]; ++i)
+			if(subset_pixels[s][i] == anchor_pixel[s])
+				fixBC7AnchorIndex(subset_enc[s], num_subset_pixels[s], bc7_mode1_format, i);
+
+		for(int i=0; i<num_subset_pixels[s]; ++i)
+			block_indices[subset_pixels[s][i]] = subset_enc[s].indices[i];
+	}
+
+	BlockBitWriter writer;
+	writer.write(1 << 1, 2); // Mode 1
+	writer.write(partition, 6);
+	for(int c=0; c<3; ++c)
+		for(int s=0; s<2; ++s)
+		{
+			writer.write(subset_enc[s].q[0][c], 6);
+			writer.write(subset_enc[s].q[1][c], 6);
+		}
+	writer.write(subset_enc[0].p[0], 1); // Shared p-bits
+	writer.write(subset_enc[1].p[0], 1);
+	for(int i=0; i<16; ++i)
+		writer.write(block_indices[i], (i == anchor_pixel[0] || i == anchor_pixel[1]) ? 2 : 3);
+	writer.writeTo(block_out);
+}
+
+
+// Estimates how well a set of pixels can be represented by a line segment in colour space, by the variance away from their principal axis.
+static float bc7SubsetResidualEstimate(const float sum[3], const float sum_sq[3][3], int n)
+{
+	if(n <= 1)
+		return 0;
+
+	float cov[3][3];
+	const float recip_n = 1.f / (float)n;
+	for(int a=0; a<3; ++a)
+		for(int b=0; b<3; ++b)
+			cov[a][b] = sum_sq[a][b] - sum[a] * sum[b] * recip_n;
+
+	// Start power iteration from the row with the largest variance.
+	const int start = (cov[0][0] >= cov[1][1] && cov[0][0] >= cov[2][2]) ? 0 : ((cov[1][1] >= cov[2][2]) ? 1 : 2);
+	float v[3] = { cov[start][0], cov[start][1], cov[start][2] };
+	for(int iter=0; iter<3; ++iter)
+	{
+		const float nv0 = cov[0][0] * v[0] + cov[0][1] * v[1] + cov[0][2] * v[2];
+		const float nv1 = cov[1][0] * v[0] + cov[1][1] * v[1] + cov[1][2] * v[2];
+		const float nv2 = cov[2][0] * v[0] + cov[2][1] * v[1] + cov[2][2] * v[2];
+		const float max_comp = myMax(std::fabs(nv0), myMax(std::fabs(nv1), std::fabs(nv2)));
+		if(max_comp < 1.0e-6f)
+			return 0;
+		v[0] = nv0 / max_comp; v[1] = nv1 / max_comp; v[2] = nv2 / max_comp;
+	}
+
+	// The largest eigenvalue is approximated by the Rayleigh quotient.
+	const float cv0 = cov[0][0] * v[0] + cov[0][1] * v[1] + cov[0][2] * v[2];
+	const float cv1 = cov[1][0] * v[0] + cov[1][1] * v[1] + cov[1][2] * v[2];
+	const float cv2 = cov[2][0] * v[0] + cov[2][1] * v[1] + cov[2][2] * v[2];
+	const float lambda = (v[0] * cv0 + v[1] * cv1 + v[2] * cv2) / (v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+
+	return myMax(0.f, cov[0][0] + cov[1][1] + cov[2][2] - lambda);
+}
+
+
+// Encodes a block of 16 RGBA pixels, choosing between the modes tried for the quality level.
+// Mode 6 is always tried.  Mode 5 (separate alpha indices) is tried for non-opaque blocks, and mode 1 (two subsets) for opaque blocks at Quality_High.
+static void encodeBC7Block(const uint8* rgba_block, Quality quality, uint8* block_out)
+{
+	int px[16][4];
+	bool solid = true;
+	bool opaque = true;
+	for(int i=0; i<16; ++i)
+	{
+		for(int c=0; c<4; ++c)
+		{
+			px[i][c] = rgba_block[i*4 + c];
+			if(px[i][c] != px[0][c])
+				solid = false;
+		}
+		if(px[i][3] != 255)
+			opaque = false;
+	}
+
+	if(solid)
+	{
+		BC7SubsetEncoding enc;
+		encodeBC7Mode6SolidBlock(px[0], opaque, enc);
+		writeBC7Mode6Block(enc, block_out);
+		return;
+	}
+
+	BC7SubsetEncoding mode6_enc;
+	int best_err = fitBC7Subset(px, 16, bc7_mode6_format, quality, opaque, mode6_enc);
+	writeBC7Mode6Block(mode6_enc, block_out);
+
+	// Mode 5 has separate indices for alpha, which is much better when alpha does not vary along with the colour.
+	// The rotation swaps alpha with one of the colour channels, so that channel gets the separate indices instead.
+	if(!opaque && best_err > 0)
+	{
+		const int num_rotations = (quality == Quality_High) ? 4 : 1;
+		for(int rotation=0; rotation<num_rotations; ++rotation)
+		{
+			int colour_px[16][4];
+			int alpha_px[16][4];
+			for(int i=0; i<16; ++i)
+			{
+				int v[4] = { px[i][0], px[i][1], px[i][2], px[i][3] };
+				if(rotation > 0)
+					mySwap(v[3], v[rotation - 1]);
+				colour_px[i][0] = v[0];
+				colour_px[i][1] = v[1];
+				colour_px[i][2] = v[2];
+				colour_px[i][3] = 0;
+				alpha_px[i][0] = v[3];
+				alpha_px[i][1] = alpha_px[i][2] = alpha_px[i][3] = 0;
+			}
+
+			BC7SubsetEncoding colour_enc, alpha_enc;
+			const int err = fitBC7Subset(colour_px, 16, bc7_mode5_colour_format, quality, /*opaque=*/false, colour_enc) +
+				fitBC7Subset(alpha_px, 16, bc7_mode5_alpha_format, quality, /*opaque=*/false, alpha_enc);
+			if(err < best_err)
+			{
+				best_err = err;
+				writeBC7Mode5Block(rotation, colour_enc, alpha_enc, block_out);
+			}
+		}
+	}
+
+	// Mode 1 splits the block into two subsets, using one of 64 partitions, each with its own endpoints.
+	// Estimate the error for all the partitions cheaply, then fit the most promising few.
+	if(opaque && quality == Quality_High && best_err > 0)
+	{
+		float px_sq[16][3][3];
+		for(int i=0; i<16; ++i)
+			for(int a=0; a<3; ++a)
+				for(int b=0; b<3; ++b)
+					px_sq[i][a][b] = (float)(px[i][a] * px[i][b]);
+
+		const int num_candidates = 4;
+		int candidates[num_candidates];
+		float candidate_est[num_candidates];
+		for(int i=0; i<num_candidates; ++i)
+		{
+			candidates[i] = -1;
+			candidate_est[i] = std::numeric_limits<float>::max();
+		}
+
+		for(int partition=0; partition<64; ++partition)
+		{
+			float sum[2][3] = { { 0 } };
+			float sum_sq[2][3][3] = { { { 0 } } };
+			int n[2] = { 0, 0 };
+			for(int i=0; i<16; ++i)
+			{
+				const int s = bc7_partition2[partition * 16 + i];
+				n[s]++;
+				for(int a=0; a<3; ++a)
+				{
+					sum[s][a] += (float)px[i][a];
+					for(int b=0; b<3; ++b)
+						sum_sq[s][a][b] += px_sq[i][a][b];
+				}
+			}
+
+			const float est = bc7SubsetResidualEstimate(sum[0], sum_sq[0], n[0]) + bc7SubsetResidualEstimate(sum[1], sum_sq[1], n[1]);
+
+			// Insert into the sorted candidate list
+			for(int i=0; i<num_candidates; ++i)
+				if(est < candidate_est[i])
+				{
+					for(int z=num_candidates-1; z>i; --z)
+					{
+						candidates[z] = candidates[z - 1];
+						candidate_est[z] = candidate_est[z - 1];
+					}
+					candidates[i] = partition;
+					candidate_est[i] = est;
+					break;
+				}
+		}
+
+		for(int i=0; i<num_candidates; ++i)
+		{
+			const int partition = candidates[i];
+
+			int subset_pixels[2][16];
+			int num_subset_pixels[2];
+			getBC7PartitionPixels(partition, subset_pixels, num_subset_pixels);
+
+			BC7SubsetEncoding subset_enc[2];
+			int err = 0;
+			for(int s=0; s<2 && err < best_err; ++s)
+			{
+				int subset_px[16][4];
+				for(int z=0; z<num_subset_pixels[s]; ++z)
+				{
+					const int* const p = px[subset_pixels[s][z]];
+					subset_px[z][0] = p[0];
+					subset_px[z][1] = p[1];
+					subset_px[z][2] = p[2];
+					subset_px[z][3] = 0;
+				}
+				err += fitBC7Subset(subset_px, num_subset_pixels[s], bc7_mode1_format, quality, /*opaque=*/false, subset_enc[s]);
+			}
+
+			if(err < best_err)
+			{
+				best_err = err;
+				writeBC7Mode1Block(partition, subset_enc, block_out);
+			}
+		}
+	}
+}
+
+
+static void readBC7Indices(BlockBitReader& reader, int index_bits, const int anchor_pixel[2], uint8 indices_out[16])
+{
+	for(int i=0; i<16; ++i)
+		indices_out[i] = (uint8)reader.read((i == anchor_pixel[0] || i == anchor_pixel[1]) ? (index_bits - 1) : index_bits);
+}
+
+
+bool decodeBC7Block(const uint8* block, uint8* rgba_out)
+{
+	BlockBitReader reader(block);
+	int mode = 0;
+	while(mode < 8 && reader.read(1) == 0) // The mode is given by the number of zero bits before the first one bit.
+		mode++;
+
+	if(mode == 6)
+	{
+		BC7SubsetEncoding enc;
+		for(int c=0; c<4; ++c)
+		{
+			enc.q[0][c] = (int)reader.read(7);
+			enc.q[1][c] = (int)reader.read(7);
+		}
+		enc.p[0] = (int)reader.read(1);
+		enc.p[1] = (int)reader.read(1);
+		const int anchor_pixel[2] = { 0, 0 };
+		readBC7Indices(reader, 4, anchor_pixel, enc.indices);
+
+		int palette[16][4];
+		computeBC7Palette(enc, bc7_mode6_format, palette);
+		for(int i=0; i<16; ++i)
+			for(int c=0; c<4; ++c)
+				rgba_out[i*4 + c] = (uint8)palette[enc.indices[i]][c];
+		return true;
+	}
+	else if(mode == 5)
+	{
+		const int rotation = (int)reader.read(2);
+		BC7SubsetEncoding colour_enc, alpha_enc;
+		for(int c=0; c<3; ++c)
+		{
+			colour_enc.q[0][c] = (int)reader.read(7);
+			colour_enc.q[1][c] = (int)reader.read(7);
+		}
+		alpha_enc.q[0][0] = (int)reader.read(8);
+		alpha_enc.q[1][0] = (int)reader.read(8);
+		colour_enc.p[0] = colour_enc.p[1] = alpha_enc.p[0] = alpha_enc.p[1] = 0;
+		const int anchor_pixel[2] = { 0, 0 };
+		readBC7Indices(reader, 2, anchor_pixel, colour_enc.indices);
+		readBC7Indices(reader, 2, anchor_pixel, alpha_enc.indices);
+
+		int colour_palette[16][4], alpha_palette[16][4];
+		computeBC7Palette(colour_enc, bc7_mode5_colour_format, colour_palette);
+		computeBC7Palette(alpha_enc, bc7_mode5_alpha_format, alpha_palette);
+		for(int i=0; i<16; ++i)
+		{
+			int v[4] = { colour_palette[colour_enc.indices[i]][0], colour_palette[colour_enc.indices[i]][1], colour_palette[colour_enc.indices[i]][2], alpha_palette[alpha_enc.indices[i]][0] };
+			if(rotation > 0)
+				mySwap(v[3], v[rotation - 1]);
+			for(int c=0; c<4; ++c)
+				rgba_out[i*4 + c] = (uint8)v[c];
+		}
+		return true;
+	}
+	else if(mode == 1)
+	{
+		const int partition = (int)reader.read(6);
+		BC7SubsetEncoding subset_enc[2];
+		for(int c=0; c<3; ++c)
+			for(int s=0; s<2; ++s)
+			{
+				subset_enc[s].q[0][c] = (int)reader.read(6);
+				subset_enc[s].q[1][c] = (int)reader.read(6);
+			}
+		for(int s=0; s<2; ++s)
+			subset_enc[s].p[0] = subset_enc[s].p[1] = (int)reader.read(1);
+
+		const int anchor_pixel[2] = { 0, bc7_anchor_second_subset[partition] };
+		uint8 indices[16];
+		readBC7Indices(reader, 3, anchor_pixel, indices);
+
+		int palettes[2][16][4];
+		computeBC7Palette(subset_enc[0], bc7_mode1_format, palettes[0]);
+		computeBC7Palette(subset_enc[1], bc7_mode1_format, palettes[1]);
+		for(int i=0; i<16; ++i)
+		{
+			const int s = bc7_partition2[partition * 16 + i];
+			for(int c=0; c<3; ++c)
+				rgba_out[i*4 + c] = (uint8)palettes[s][indices[i]][c];
+			rgba_out[i*4 + 3] = 255;
+		}
+		return true;
+	}
+	else
+		return false;
+}
+
+
+//=========================================== BC4 / BC5 ===========================================
+
+
+static inline void computeBC4Palette(int e0, int e1, int palette[8])
+{
+	palette[0] = e0;
+	palette[1] = e1;
+	if(e0 > e1)
+	{
+		for(int i=1; i<7; ++i)
+			palette[i + 1] = ((7 - i) * e0 + i * e1 + 3) / 7;
+	}
+	else
+	{
+		for(int i=1; i<5; ++i)
+			palette[i + 1] = ((5 - i) * e0 + i * e1 + 2) / 5;
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+}
+
+
+// Returns the total squared error
+static int computeBC4Indices(const uint8* vals, int e0, int e1, uint8 indices_out[16])
+{
+	int palette[8];
+	computeBC4Palette(e0, e1, palette);
+
+	int total_err = 0;
+	for(int i=0; i<16; ++i)
+	{
+		int best_err = std::numeric_limits<int>::max();
+		int best_index = 0;
+		for(int z=0; z<8; ++z)
+		{
+			const int d = (int)vals[i] - palette[z];
+			if(d*d < best_err)
+			{
+				best_err = d*d;
+				best_index = z;
+			}
+		}
+		indices_out[i] = (uint8)best_index;
+		total_err += best_err;
+	}
+	return total_err;
+}
+
+
+static void encodeBC4Block(const uint8* vals, Quality quality, uint8* block_out)
+{
+	int min_v = 255;
+	int max_v = 0;
+	int min_inner_v = 255; // Min and max over values that are not 0 or 255
+	int max_inner_v = 0;
+	for(int i=0; i<16; ++i)
+	{
+		min_v = myMin(min_v, (int)vals[i]);
+		max_v = myMax(max_v, (int)vals[i]);
+		if(vals[i] != 0 && vals[i] != 255)
+		{
+			min_inner_v = myMin(min_inner_v, (int)vals[i]);
+			max_inner_v = myMax(max_inner_v, (int)vals[i]);
+		}
+	}
+
+	uint8 best_indices[16];
+	int best_e0 = max_v;
+	int best_e1 = min_v;
+	int best_err = computeBC4Indices(vals, best_e0, best_e1, best_indices);
+
+	// Try endpoints moved in from the extremes, which can reduce the error for the interior values.
+	const int search_radius = (quality == Quality_Fast) ? 0 : ((quality == Quality_Normal) ? 1 : 3);
+	for(int d0=0; d0<=search_radius && best_err > 0; ++d0)
+	for(int d1=0; d1<=search_radius && best_err > 0; ++d1)
+	{
+		const int e0 = max_v - d0;
+		const int e1 = min_v + d1;
+		if(e0 <= e1 || (d0 == 0 && d1 == 0))
+			continue;
+
+		uint8 indices[16];
+		const int err = computeBC4Indices(vals, e0, e1, indices);
+		if(err < best_err)
+		{
+			best_err = err;
+			best_e0 = e0;
+			best_e1 = e1;
+			std::memcpy(best_indices, indices, 16);
+		}
+	}
+
+	// Try the 6-value mode, which has explicit 0 and 255 values, for blocks that contain them.
+	if(quality == Quality_High && best_err > 0 && min_inner_v <= max_inner_v && (min_v == 0 || max_v == 255))
+	{
+		uint8 indices[16];
+		const int err = computeBC4Indices(vals, min_inner_v, max_inner_v, indices);
+		if(err < best_err)
+		{
+			best_err = err;
+			best_e0 = min_inner_v;
+			best_e1 = max_inner_v;
+			std::memcpy(best_indices, indices, 16);
+		}
+	}
+
+	block_out[0] = (uint8)best_e0;
+	block_out[1] = (uint8)best_e1;
+	uint64 index_bits = 0;
+	for(int i=0; i<16; ++i)
+		index_bits |= (uint64)best_indices[i] << (3 * i);
+	for(int i=0; i<6; ++i)
+		block_out[2 + i] = (uint8)(index_bits >> (8 * i));
+}
+
+
+static void decodeBC4Block(const uint8* block, uint8* vals_out, size_t stride)
+{
+	int palette[8];
+	computeBC4Palette(block[0], block[1], palette);
+
+	uint64 index_bits = 0;
+	for(int i=0; i<6; ++i)
+		index_bits |= (uint64)block[2 + i] << (8 * i);
+
+	for(int i=0; i<16; ++i)
+		vals_out[i * stride] = (uint8)palette[(index_bits >> (3 * i)) & 7];
+}
+
+
+void decodeBC5Block(const uint8* block, uint8* rg_out)
+{
+	decodeBC4Block(block,     rg_out,     /*stride=*/2);
+	decodeBC4Block(block + 8, rg_out + 1, /*stride=*/2);
+}
+
+
+//=========================================== BC1 / BC3 decoding ===========================================
+
+
+void decodeBC1Block(const uint8* block, uint8* rgba_out)
+{
+	const uint32 c0 = block[0] | ((uint32)block[1] << 8);
+	const uint32 c1 = block[2] | ((uint32)block[3] << 8);
+
+	int palette[4][4];
+	const uint32 cols[2] = { c0, c1 };
+	for(int i=0; i<2; ++i)
+	{
+		const uint32 r = (cols[i] >> 11) & 31;
+		const uint32 g = (cols[i] >> 5) & 63;
+		const uint32 b = cols[i] & 31;
+		palette[i][0] = (int)((r << 3) | (r >> 2));
+		palette[i][1] = (int)((g << 2) | (g >> 4));
+		palette[i][2] = (int)((b << 3) | (b >> 2));
+		palette[i][3] = 255;
+	}
+	for(int c=0; c<3; ++c)
+	{
+		if(c0 > c1)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		else
+		{
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+			palette[3][c] = 0;
+		}
+	}
+	palette[2][3] = 255;
+	palette[3][3] = (c0 > c1) ? 255 : 0;
+
+	const uint32 index_bits = block[4] | ((uint32)block[5] << 8) | ((uint32)block[6] << 16) | ((uint32)block[7] << 24);
+	for(int i=0; i<16; ++i)
+	{
+		const uint32 index = (index_bits >> (2 * i)) & 3;
+		for(int c=0; c<4; ++c)
+			rgba_out[i*4 + c] = (uint8)palette[index][c];
+	}
+}
+
+
+void decodeBC3Block(const uint8* block, uint8* rgba_out)
+{
+	decodeBC1Block(block + 8, rgba_out);
+	decodeBC4Block(block, rgba_out + 3, /*stride=*/4); // Alpha
+}
+
+
+//=========================================== Image compression ===========================================
+
+
+class BCCompressTask : public glare::Task
+{
+public:
+	virtual void run(size_t /*thread_index*/)
+	{
+		const size_t W = src_W;
+		const size_t H = src_H;
+		const size_t bytes_pp = src_bytes_pp;
+		const size_t num_blocks_x = Maths::roundedUpDivide(W, (size_t)4);
+		const uint8* const src_data = src_image_data;
+
+		uint8* write_ptr = compressed + num_blocks_x * (begin_y / 4) * 16; // 16 bytes per block for both BC5 and BC7.
+
+		if(format == Format_BC7)
+		{
+			uint8 rgba_block[4*4*4];
+			for(size_t by=begin_y; by<end_y; by += 4) // by = y coordinate of block
+				for(size_t bx=0; bx<W; bx += 4)
+				{
+					int z = 0;
+					for(size_t y=by; y<by+4; ++y)
+						for(size_t x=bx; x<bx+4; ++x) // For each pixel in block:
+						{
+							const size_t use_x = myMin(x, W-1); // Clamp to image width/height in order to pad edges with edge pixel data.
+							const size_t use_y = myMin(y, H-1);
+							const uint8* const pixel = src_data + (use_x + W * use_y) * bytes_pp;
+							rgba_block[z + 0] = pixel[0];
+							rgba_block[z + 1] = pixel[1];
+							rgba_block[z + 2] = pixel[2];
+							rgba_block[z + 3] = (bytes_pp == 4) ? pixel[3] : 255;
+							z += 4;
+						}
+
+					encodeBC7Block(rgba_block, quality, write_ptr);
+					write_ptr += 16;
+				}
+		}
+		else
+		{
+			assert(format == Format_BC5);
+			uint8 r_block[16];
+			uint8 g_block[16];
+			for(size_t by=begin_y; by<end_y; by += 4) // by = y coordinate of block
+				for(size_t bx=0; bx<W; bx += 4)
+				{
+					int z = 0;
+					for(size_t y=by; y<by+4; ++y)
+						for(size_t x=bx; x<bx+4; ++x) // For each pixel in block:
+						{
+							const size_t use_x = myMin(x, W-1);
+							const size_t use_y = myMin(y, H-1);
+							const uint8* const pixel = src_data + (use_x + W * use_y) * bytes_pp;
+							r_block[z] = pixel[0];
+							g_block[z] = pixel[1];
+							z++;
+						}
+
+					encodeBC4Block(r_block, quality, write_ptr);
+					encodeBC4Block(g_block, quality, write_ptr + 8);
+					write_ptr += 16;
+				}
+		}
+	}
+	Format format;
+	Quality quality;
+	size_t begin_y, end_y;
+	uint8* compressed;
+	size_t src_W;
+	size_t src_H;
+	size_t src_bytes_pp;
+	const uint8* src_image_data;
+};
+
+
+size_t getCompressedSizeBytes(size_t W, size_t H)
+{
+	const size_t num_blocks_x = Maths::roundedUpDivide(W, (size_t)4);
+	const size_t num_blocks_y = Maths::roundedUpDivide(H, (size_t)4);
+	return num_blocks_x * num_blocks_y * 16;
+}
+
+
+void compress(glare::TaskManager* task_manager, TempData& temp_data, Format format, Quality quality, size_t src_W, size_t src_H, size_t src_bytes_pp, const uint8* src_image_data,
+	uint8* compressed_data_out, size_t compressed_data_out_size)
+{
+	const size_t W = src_W;
+	const size_t H = src_H;
+	assert((format == Format_BC7) ? (src_bytes_pp == 3 || src_bytes_pp == 4) : (src_bytes_pp >= 2 && src_bytes_pp <= 4));
+
+	const size_t num_blocks_x = Maths::roundedUpDivide(W, (size_t)4);
+	const size_t num_blocks_y = Maths::roundedUpDivide(H, (size_t)4);
+	const size_t num_blocks = num_blocks_x * num_blocks_y;
+
+	assert(compressed_data_out_size >= num_blocks * 16);
+	(void)compressed_data_out_size;
+
+	// Encoding a block is a lot slower than with DXT compression, so tasks can have fewer blocks than in DXTCompression::compress().
+	const size_t min_blocks_per_task = 256;
+
+	if(!task_manager || (num_blocks < min_blocks_per_task))
+	{
+		BCCompressTask task;
+		task.format = format;
+		task.quality = quality;
+		task.compressed = compressed_data_out;
+		task.src_W = src_W;
+		task.src_H = src_H;
+		task.src_bytes_pp = src_bytes_pp;
+		task.src_image_data = src_image_data;
+		task.begin_y = 0;
+		task.end_y = H;
+		task.run(0);
+	}
+	else
+	{
+		if(temp_data.task_group.isNull())
+			temp_data.task_group = new glare::TaskGroup();
+
+		// Create temp_data compress_tasks if not already created.
+		std::vector<Reference<glare::Task> >& compress_tasks = temp_data.compress_tasks;
+		compress_tasks.resize(myMax<size_t>(1, task_manager->getConcurrency()));
+
+		for(size_t z=0; z<compress_tasks.size(); ++z)
+			if(compress_tasks[z].isNull())
+				compress_tasks[z] = new BCCompressTask();
+
+		// Avoid creating tasks with too small an amount of work.
+		const size_t min_y_blocks_per_task = myMax<size_t>(1, min_blocks_per_task / num_blocks_x);
+
+		const size_t even_divided_blocks_per_task = Maths::roundedUpDivide((size_t)num_blocks_y, compress_tasks.size());
+		const size_t y_blocks_per_task = myMax(min_y_blocks_per_task, even_divided_blocks_per_task);
+
+		const size_t use_num_tasks = Maths::roundedUpDivide(num_blocks_y, y_blocks_per_task);
+		assert(y_blocks_per_task * use_num_tasks >= num_blocks_y);
+
+		temp_data.task_group->tasks.resize(use_num_tasks);
+
+		for(size_t z=0; z<use_num_tasks; ++z)
+		{
+			temp_data.task_group->tasks[z] = compress_tasks[z];
+
+			assert(dynamic_cast<BCCompressTask*>(compress_tasks[z].ptr()));
+			BCCompressTask* task = static_cast<BCCompressTask*>(compress_tasks[z].ptr());
+			task->format = format;
+			task->quality = quality;
+			task->compressed = compressed_data_out;
+			task->src_W = src_W;
+			task->src_H = src_H;
+			task->src_bytes_pp = src_bytes_pp;
+			task->src_image_data = src_image_data;
+			task->begin_y = (size_t)myMin((size_t)H, (z       * y_blocks_per_task) * 4);
+			task->end_y   = (size_t)myMin((size_t)H, ((z + 1) * y_blocks_per_task) * 4);
+		}
+		task_manager->runTaskGroup(temp_data.task_group);
+	}
+}
+
+
+} // end namespace BCCompression
+
+
+#if BUILD_TESTS
+
+
+#include "../utils/TestUtils.h"
+#include "../utils/ConPrint.h"
+#include "../utils/StringUtils.h"
+#include "../maths/PCG32.h"
+#include <encoder/basisu_gpu_texture.h>
+
+
+namespace BCCompression
+{
+
+
+static int blockSquaredError(const uint8* a, const uint8* b, int num_vals)
+{
+	int sum = 0;
+	for(int i=0; i<num_vals; ++i)
+		sum += ((int)a[i] - (int)b[i]) * ((int)a[i] - (int)b[i]);
+	return sum;
+}
+
+
+// Check our decoders against the basis universal decoders, so that the encoder isn't just tested against its own reading of the BC7 and BC4 specs.
+// BC7 interpolation is specified exactly in integer arithmetic, so should match exactly.
+// BC4 interpolated values are specified at higher than 8-bit precision: basisu truncates them and we round, so allow an error of 1.
+static void checkBC7DecodingMatchesReference(const uint8* block, const uint8* decoded)
+{
+	basisu::color_rgba ref[16];
+	testAssert(basisu::unpack_bc7(block, ref));
+	for(int z=0; z<16; ++z)
+		for(int c=0; c<4; ++c)
+			testAssert(ref[z][c] == decoded[z*4 + c]);
+}
+
+
+static void checkBC5DecodingMatchesReference(const uint8* block, const uint8* decoded)
+{
+	basisu::color_rgba ref[16];
+	basisu::unpack_bc5(block, ref);
+	for(int z=0; z<16; ++z)
+		for(int c=0; c<2; ++c)
+			testAssert(std::abs((int)ref[z][c] - (int)decoded[z*2 + c]) <= 1);
+}
+
+
+static void checkBC4DecodingMatchesReference(const uint8* block, const uint8* decoded)
+{
+	uint8 ref[16];
+	basisu::unpack_bc4(block, ref, /*stride=*/1);
+	for(int z=0; z<16; ++z)
+		testAssert(std::abs((int)ref[z] - (int)decoded[z]) <= 1);
+}
+
+
+void test()
+{
+	conPrint("BCCompression::test()");
+
+	PCG32 rng(1);
+
+	// Test bit writing and reading
+	{
+		BlockBitWriter writer;
+		for(int i=0; i<16; ++i)
+			writer.write((uint64)(i * 37) & 0x7F, 7); // 112 bits
+		writer.write(0xABCD, 16);
+		uint8 block[16];
+		writer.writeTo(block);
+
+		BlockBitReader reader(block);
+		for(int i=0; i<16; ++i)
+			testAssert(reader.read(7) == ((uint32)(i * 37) & 0x7F));
+		testAssert(reader.read(16) == 0xABCD);
+	}
+
+	// Test that all solid-colour blocks are encoded with a small error, and exactly for opaque alpha.
+	{
+		int max_channel_err = 0;
+		for(int i=0; i<10000; ++i)
+		{
+			uint8 rgba[64];
+			const uint8 col[4] = { (uint8)(rng.unitRandom() * 256), (uint8)(rng.unitRandom() * 256), (uint8)(rng.unitRandom() * 256), (uint8)((i % 2 == 0) ? 255 : (int)(rng.unitRandom() * 256)) };
+			for(int z=0; z<16; ++z)
+				std::memcpy(&rgba[z*4], col, 4);
+
+			uint8 block[16];
+			encodeBC7Block(rgba, Quality_Fast, block);
+			uint8 decoded[64];
+			testAssert(decodeBC7Block(block, decoded));
+			checkBC7DecodingMatchesReference(block, decoded);
+			for(int z=0; z<64; ++z)
+				max_channel_err = myMax(max_channel_err, std::abs((int)decoded[z] - (int)rgba[z]));
+			if(col[3] == 255)
+				for(int z=0; z<16; ++z)
+					testAssert(decoded[z*4 + 3] == 255);
+		}
+		testAssert(max_channel_err <= 1);
+	}
+
+	// Test random and gradient blocks: check that the decoded block matches what the encoder computed, and that higher quality levels don't increase the error.
+	{
+		int64 total_err[3] = { 0, 0, 0 };
+		for(int i=0; i<2000; ++i)
+		{
+			uint8 rgba[64];
+			const bool opaque = (i % 2) == 0;
+			for(int z=0; z<16; ++z)
+			{
+				const float t = (float)((z % 4) + (z / 4)) / 6.f;
+				for(int c=0; c<4; ++c)
+					rgba[z*4 + c] = (uint8)myClamp((int)(t * 200 + c * 10 + ((i % 4 == 1) ? rng.unitRandom() * 60 : 0)), 0, 255);
+				if(opaque)
+					rgba[z*4 + 3] = 255;
+			}
+
+			for(int q=0; q<3; ++q)
+			{
+				uint8 block[16];
+				encodeBC7Block(rgba, (Quality)q, block);
+				uint8 decoded[64];
+				testAssert(decodeBC7Block(block, decoded));
+				checkBC7DecodingMatchesReference(block, decoded);
+				total_err[q] += blockSquaredError(rgba, decoded, 64);
+				if(opaque)
+					for(int z=0; z<16; ++z)
+						testAssert(decoded[z*4 + 3] == 255);
+			}
+		}
+		conPrint("BC7 block total squared error: fast: " + toString(total_err[0]) + ", normal: " + toString(total_err[1]) + ", high: " + toString(total_err[2]));
+		testAssert(total_err[1] <= total_err[0]);
+		testAssert(total_err[2] <= total_err[1]);
+	}
+
+	// Test a block where alpha varies independently of the colour.  Mode 5, with separate alpha indices, should be used.
+	{
+		uint8 rgba[64];
+		for(int z=0; z<16; ++z)
+		{
+			rgba[z*4 + 0] = (uint8)(z * 16);
+			rgba[z*4 + 1] = (uint8)(z * 8);
+			rgba[z*4 + 2] = 40;
+			rgba[z*4 + 3] = (uint8)((z % 4) * 80);
+		}
+
+		int err[3];
+		for(int q=0; q<3; ++q)
+		{
+			uint8 block[16];
+			encodeBC7Block(rgba, (Quality)q, block);
+			testAssert(block[0] == (1 << 5)); // Mode 5, no rotation
+			uint8 decoded[64];
+			testAssert(decodeBC7Block(block, decoded));
+			checkBC7DecodingMatchesReference(block, decoded);
+			err[q] = blockSquaredError(rgba, decoded, 64);
+		}
+		testAssert(err[1] <= err[0]);
+		testAssert(err[2] <= err[1]);
+	}
+
+	// Test an opaque block with two different colour gradients.  Mode 1, with two subsets, should be used at high quality.
+	{
+		uint8 rgba[64];
+		for(int z=0; z<16; ++z)
+		{
+			const bool left = (z % 4) < 2;
+			rgba[z*4 + 0] = (uint8)(left ? (200 - z * 5) : 30);
+			rgba[z*4 + 1] = (uint8)(left ? 20 : (100 + z * 9));
+			rgba[z*4 + 2] = (uint8)(left ? (z * 3) : 220);
+			rgba[z*4 + 3] = 255;
+		}
+
+		int err[3];
+		for(int q=0; q<3; ++q)
+		{
+			uint8 block[16];
+			encodeBC7Block(rgba, (Quality)q, block);
+			if(q == 2)
+				testAssert((block[0] & 3) == 2); // Mode 1
+			uint8 decoded[64];
+			testAssert(decodeBC7Block(block, decoded));
+			checkBC7DecodingMatchesReference(block, decoded);
+			for(int z=0; z<16; ++z)
+				testAssert(decoded[z*4 + 3] == 255);
+			err[q] = blockSquaredError(rgba, decoded, 64);
+		}
+		testAssert(err[2] * 4 < err[1]);
+	}
+
+	// Test that BC7 blocks with modes that are not written by the encoder are rejected by the decoder.
+	{
+		uint8 block[16];
+		std::memset(block, 0, 16);
+		block[0] = 1; // Mode 0
+		uint8 decoded[64];
+		testAssert(!decodeBC7Block(block, decoded));
+	}
+
+	// Test BC5
+	{
+		// A block with just two distinct values per channel should be encoded exactly.
+		{
+			uint8 rg[32];
+			for(int z=0; z<16; ++z)
+			{
+				rg[z*2 + 0] = (z % 3 == 0) ? 10 : 200;
+				rg[z*2 + 1] = (z % 2 == 0) ? 0 : 255;
+			}
+			uint8 r_block[16], g_block[16];
+			for(int z=0; z<16; ++z) { r_block[z] = rg[z*2]; g_block[z] = rg[z*2 + 1]; }
+
+			uint8 block[16];
+			encodeBC4Block(r_block, Quality_Normal, block);
+			encodeBC4Block(g_block, Quality_Normal, block + 8);
+			uint8 decoded[32];
+			decodeBC5Block(block, decoded);
+			checkBC5DecodingMatchesReference(block, decoded);
+			testAssert(blockSquaredError(rg, decoded, 32) == 0);
+		}
+
+		// Solid block
+		{
+			uint8 vals[16];
+			for(int z=0; z<16; ++z)
+				vals[z] = 77;
+			uint8 block[8];
+			encodeBC4Block(vals, Quality_Fast, block);
+			uint8 decoded[16];
+			decodeBC4Block(block, decoded, 1);
+			checkBC4DecodingMatchesReference(block, decoded);
+			testAssert(blockSquaredError(vals, decoded, 16) == 0);
+		}
+
+		// Random blocks
+		int64 total_err[3] = { 0, 0, 0 };
+		for(int i=0; i<2000; ++i)
+		{
+			uint8 vals[16];
+			const int base = (int)(rng.unitRandom() * 256);
+			const int range = (int)(rng.unitRandom() * 100);
+			for(int z=0; z<16; ++z)
+				vals[z] = (uint8)myClamp(base + (int)(rng.unitRandom() * range) - range / 2, 0, 255);
+
+			for(int q=0; q<3; ++q)
+			{
+				uint8 block[8];
+				encodeBC4Block(vals, (Quality)q, block);
+				uint8 decoded[16];
+				decodeBC4Block(block, decoded, 1);
+				checkBC4DecodingMatchesReference(block, decoded);
+				total_err[q] += blockSquaredError(vals, decoded, 16);
+			}
+		}
+		conPrint("BC4 block total squared error: fast: " + toString(total_err[0]) + ", normal: " + toString(total_err[1]) + ", high: " + toString(total_err[2]));
+		testAssert(total_err[1] <= total_err[0]);
+		testAssert(total_err[2] <= total_err[1]);
+	}
+
+	// Test that multi-threaded compression gives the same results as single-threaded compression, for sizes that aren't a multiple of 4.
+	{
+		glare::TaskManager task_manager;
+		TempData temp_data;
+		for(int f=0; f<2; ++f)
+		{
+			const Format format = (f == 0) ? Format_BC5 : Format_BC7;
+			const size_t W = 301;
+			const size_t H = 257;
+			const size_t N = 4;
+			std::vector<uint8> image(W * H * N);
+			for(size_t i=0; i<image.size(); ++i)
+				image[i] = (uint8)(((i / N) % W + (i / N) / W) + rng.unitRandom() * 30);
+
+			const size_t compressed_size = getCompressedSizeBytes(W, H);
+			testAssert(compressed_size == 76 * 65 * 16);
+			std::vector<uint8> single_threaded(compressed_size);
+			std::vector<uint8> multi_threaded(compressed_size);
+			compress(/*task manager=*/NULL, temp_data, format, Quality_Normal, W, H, N, image.data(), single_threaded.data(), compressed_size);
+			compress(&task_manager, temp_data, format, Quality_Normal, W, H, N, image.data(), multi_threaded.data(), compressed_size);
+			testAssert(single_threaded == multi_threaded);
+
+			for(size_t b=0; b<compressed_size / 16; ++b)
+			{
+				const uint8* block = &single_threaded[b * 16];
+				uint8 decoded[64];
+				if(format == Format_BC5)
+				{
+					decodeBC5Block(block, decoded);
+					checkBC5DecodingMatchesReference(block, decoded);
+				}
+				else
+				{
+					testAssert(decodeBC7Block(block, decoded));
+					checkBC7DecodingMatchesReference(block, decoded);
+				}
+			}
+		}
+	}
+
+	conPrint("BCCompression::test() done.");
+}
+
+
+} // end namespace BCCompression
+
+
+#endif // BUILD_TESTS
@@ -0,0 +1,69 @@
+/*=====================================================================
+BCCompression.h
+---------------
+Copyright Glare Technologies Limited 2026 -
+=====================================================================*/
+#pragma once
+
+
+#include "../utils/Task.h"
+#include <vector>
+namespace glare { class TaskManager; }
+
+
+/*=====================================================================
+BCCompression
+-------------
+BC7 and BC5 block compression of 8-bit image data.
+See DXTCompression for BC1 and BC3.
+
+BC7 blocks are encoded with a subset of the BC7 modes:
+Mode 6: a single pair of RGBA endpoints with 7 bits per channel plus a p-bit, and 4-bit indices.
+Mode 5: separate indices for alpha (or one colour channel, with a channel rotation), for blocks where alpha doesn't vary with the colour.
+Mode 1: two subsets of pixels, given by one of 64 fixed partitions, each with its own RGB endpoints.  Opaque blocks only.
+This gives noticeably better quality than BC1 and BC3 on colour textures, at the same size as BC3 (16 bytes per block).
+
+BC5 stores the first two channels as two BC4 blocks, 16 bytes per block.  It is intended for
+tangent-space normal maps, with the Z component reconstructed in the shader.
+
+Tests are in BCCompression::test() and TextureProcessingTests.cpp
+=====================================================================*/
+namespace BCCompression
+{
+	enum Format
+	{
+		Format_BC5,
+		Format_BC7
+	};
+
+	enum Quality
+	{
+		Quality_Fast,   // Endpoints from the extent of the block along its principal axis.  Indices are found by projecting onto the endpoint line.
+		Quality_Normal, // Exhaustive index search and a least-squares endpoint refinement pass.  BC4 endpoints are refined by a small offset search.
+		Quality_High    // Tries all p-bit combinations, several refinement passes, all mode 5 rotations, and mode 1.  Larger BC4 endpoint search.
+	};
+
+	size_t getCompressedSizeBytes(size_t W, size_t H); // Same for BC5 and BC7.
+
+	struct TempData
+	{
+		std::vector<Reference<glare::Task> > compress_tasks;
+		glare::TaskGroupRef task_group;
+	};
+
+	// For Format_BC7, src_bytes_pp must be 3 or 4.  With 3 bytes per pixel, the encoded alpha is 255.
+	// For Format_BC5, src_bytes_pp must be 2, 3 or 4, and the first two channels are encoded.
+	// Multi-thread if task_manager is non-null
+	void compress(glare::TaskManager* task_manager, TempData& temp_data, Format format, Quality quality, size_t src_W, size_t src_H, size_t src_bytes_pp, const uint8* src_image_data,
+		uint8* compressed_data_out, size_t compressed_data_out_size);
+
+
+	// Block decoders, used for measuring compression error.  Decoded pixels are written in row-major order.
+	bool decodeBC7Block(const uint8* block, uint8* rgba_out); // Only handles modes 1, 5 and 6, as written by compress().  Returns false for other modes.
+	void decodeBC5Block(const uint8* block, uint8* rg_out);
+	void decodeBC1Block(const uint8* block, uint8* rgba_out);
+	void decodeBC3Block(const uint8* block, uint8* rgba_out);
+
+
+	void test();
+};
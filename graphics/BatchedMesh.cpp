@@ -22,6 +22,8 @@ Copyright Glare Technologies Limited 2020
 #include "../utils/HashMap.h"
 #include "../utils/Hasher.h"
 #include "../utils/BufferViewInStream.h"
+#include "../utils/BufferOutStream.h"
+#include "../utils/TaskManager.h"
 #include "../utils/RuntimeCheck.h"
 #include "../meshoptimizer/src/meshoptimizer.h"
 #include <limits>
@@ -790,15 +792,21 @@ void BatchedMesh::operator = (const BatchedMesh& other)
 
 
 static const uint32 MAGIC_NUMBER = 12456751;
-static const uint32 FORMAT_VERSION = 3;
+static const uint32 FORMAT_VERSION = 5;
 // Version 2: Added meshopt encoding and filtering.
 // Version 3: Added uv0_scale, uv1_scale
+// Version 4: Added progressive meshes (FLAG_PROGRESSIVE_LODS).  Only progressive meshes are written with version 4.
+// Version 5: Added multi-frame compression (FLAG_MULTI_FRAME_COMPRESSION).  Only meshes using it are written with version 5.
 
 static const uint32 ANIMATION_DATA_CHUNK = 10000;
 
 static const uint32 FLAG_USE_COMPRESSION = 1;
 static const uint32 FLAG_USE_MESHOPT = 2;
 static const uint32 FLAG_COMPRESS_VERT_ATTRIBUTES_TOGETHER = 4;
+static const uint32 FLAG_PROGRESSIVE_LODS = 8;
+static const uint32 FLAG_MULTI_FRAME_COMPRESSION = 16;
+
+static const uint32 MAX_NUM_LOD_LEVELS = 16;
 
 
 struct BatchedMeshHeader
@@ -844,18 +852,15 @@ static void getAttributeData(const BatchedMesh& mesh, const BatchedMesh::VertAtt
 
 // Encode some raw vertex data for an attribute with meshopt (using meshopt_encodeVertexBuffer),
 // then compress with Zstandard.
-static void encodeAndCompressData(const BatchedMesh& mesh, const glare::AllocatorVector<uint8>& filtered_data_in, js::Vector<uint8>& compressed_data_out, int compression_level, int meshopt_vertex_version)
+static void encodeAndCompressData(const uint8* filtered_data, size_t num_verts, size_t attr_size, js::Vector<uint8>& compressed_data_out, int compression_level, int meshopt_vertex_version)
 {
-	runtimeCheck(mesh.numVerts() > 0);
-
-	const size_t attr_size = filtered_data_in.size() / mesh.numVerts();
 	checkProperty(attr_size <= 256, "Attribute or vertex size too large for meshoptimizer."); // meshopt assumes vertex size is <= 256 B and may crash if over.
 
-	const size_t bound = meshopt_encodeVertexBufferBound(mesh.numVerts(), attr_size);
+	const size_t bound = meshopt_encodeVertexBufferBound(num_verts, attr_size);
 	js::Vector<uint8> buf(bound);
 
 	// Note 2 is the default meshopt compression level.
-	const size_t res_encoded_vert_buf_size = meshopt_encodeVertexBufferLevel(buf.data(), buf.size(), filtered_data_in.data(), mesh.numVerts(), attr_size, /*compression level=*/2, /*vertex version=*/meshopt_vertex_version);
+	const size_t res_encoded_vert_buf_size = meshopt_encodeVertexBufferLevel(buf.data(), buf.size(), filtered_data, num_verts, attr_size, /*compression level=*/2, /*vertex version=*/meshopt_vertex_version);
 	buf.resize(res_encoded_vert_buf_size);
 
 	// conPrint("meshopt res_encoded_vert_buf_size: " + toString(res_encoded_vert_buf_size) + " B");
@@ -870,12 +875,17 @@ static void encodeAndCompressData(const BatchedMesh& mesh, const glare::Allocato
 }
 
 
-static void readAndDecompressData(BufferViewInStream& file, uint64 max_decompressed_size, glare::AllocatorVector<uint8>& decompressed_out)
+static void encodeAndCompressData(size_t num_verts, const glare::AllocatorVector<uint8>& filtered_data_in, js::Vector<uint8>& compressed_data_out, int compression_level, int meshopt_vertex_version)
 {
-	const size_t compressed_size = file.readUInt32();
-	if(!file.canReadNBytes(compressed_size))
-		throw glare::Exception("Invalid compressed_size");
-	const uint64 decompressed_size = ZSTD_getFrameContentSize(file.currentReadPtr(), compressed_size);
+	runtimeCheck(num_verts > 0);
+
+	encodeAndCompressData(filtered_data_in.data(), num_verts, /*attr size=*/filtered_data_in.size() / num_verts, compressed_data_out, compression_level, meshopt_vertex_version);
+}
+
+
+static void decompressData(const void* compressed_data, size_t compressed_size, uint64 max_decompressed_size, glare::AllocatorVector<uint8>& decompressed_out)
+{
+	const uint64 decompressed_size = ZSTD_getFrameContentSize(compressed_data, compressed_size);
 	if(decompressed_size == ZSTD_CONTENTSIZE_UNKNOWN || decompressed_size == ZSTD_CONTENTSIZE_ERROR)
 		throw glare::Exception("Failed to get decompressed_size");
 
@@ -883,11 +893,21 @@ static void readAndDecompressData(BufferViewInStream& file, uint64 max_decompres
 		throw glare::Exception("decompressed_size too large.");
 
 	decompressed_out.resizeNoCopy(decompressed_size);
-	const size_t res = ZSTD_decompress(/*des=*/decompressed_out.data(), decompressed_out.size(), file.currentReadPtr(), compressed_size);
+	const size_t res = ZSTD_decompress(/*des=*/decompressed_out.data(), decompressed_out.size(), compressed_data, compressed_size);
 	if(ZSTD_isError(res))
 		throw glare::Exception("Decompression of buffer failed: " + toString(res));
 	if(res < decompressed_size)
 		throw glare::Exception("Decompression of buffer failed: not enough bytes in result");
+}
+
+
+static void readAndDecompressData(BufferViewInStream& file, uint64 max_decompressed_size, glare::AllocatorVector<uint8>& decompressed_out)
+{
+	const size_t compressed_size = file.readUInt32();
+	if(!file.canReadNBytes(compressed_size))
+		throw glare::Exception("Invalid compressed_size");
+
+	decompressData(file.currentReadPtr(), compressed_size, max_decompressed_size, decompressed_out);
 
 	file.advanceReadIndex(compressed_size);
 }
@@ -896,7 +916,408 @@ static void readAndDecompressData(BufferViewInStream& file, uint64 max_decompres
 static const bool PRINT_STATS = false;
 
 
-void BatchedMesh::writeToFile(const std::string& dest_path, const WriteOptions& write_options) const // throws glare::Exception on failure
+// Encode triangle indices with meshopt (using meshopt_encodeIndexBuffer), then compress with Zstandard.
+// meshopt_encodeIndexVersion() should have been called first.  It's not called here as it sets global state, and this may be called from multiple threads.
+static void encodeAndCompressIndices(const uint32* indices, size_t num_indices, size_t num_verts, js::Vector<uint8>& compressed_data_out, int compression_level)
+{
+	js::Vector<uint8> encoded_indices(meshopt_encodeIndexBufferBound(num_indices, num_verts));
+	encoded_indices.resize(meshopt_encodeIndexBuffer(encoded_indices.data(), encoded_indices.size(), indices, num_indices));
+
+	compressed_data_out.resizeNoCopy(ZSTD_compressBound(encoded_indices.size()));
+	const size_t compressed_size = ZSTD_compress(compressed_data_out.data(), compressed_data_out.size(), encoded_indices.data(), encoded_indices.size(), compression_level);
+	if(ZSTD_isError(compressed_size))
+		throw glare::Exception(std::string("Compression failed: ") + ZSTD_getErrorName(compressed_size));
+	compressed_data_out.resize(compressed_size);
+}
+
+
+// Get vertex positions as floats, for mesh simplification.  Quantised positions are used without dequantising.
+static void getPositionsForSimplification(const BatchedMesh& mesh, js::Vector<Vec3f, 16>& positions_out)
+{
+	const BatchedMesh::VertAttribute& pos_attr = mesh.getAttribute(BatchedMesh::VertAttribute_Position);
+	const size_t num_verts = mesh.numVerts();
+	const size_t vert_size = mesh.vertexSize();
+	const uint8* src = mesh.vertex_data.data() + pos_attr.offset_B;
+
+	positions_out.resizeNoCopy(num_verts);
+	for(size_t i=0; i<num_verts; ++i)
+	{
+		if(pos_attr.component_type == BatchedMesh::ComponentType_Float)
+			std::memcpy(&positions_out[i], src + i * vert_size, sizeof(Vec3f));
+		else if(pos_attr.component_type == BatchedMesh::ComponentType_Half)
+		{
+			half p[3];
+			std::memcpy(p, src + i * vert_size, sizeof(half) * 3);
+			positions_out[i] = Vec3f((float)p[0], (float)p[1], (float)p[2]);
+		}
+		else if(pos_attr.component_type == BatchedMesh::ComponentType_UInt16)
+		{
+			uint16 p[3];
+			std::memcpy(p, src + i * vert_size, sizeof(uint16) * 3);
+			positions_out[i] = Vec3f((float)p[0], (float)p[1], (float)p[2]);
+		}
+		else
+			throw glare::Exception("Unhandled position component type for progressive mesh: " + BatchedMesh::componentTypeString(pos_attr.component_type));
+	}
+}
+
+
+/*
+Progressive mesh layout, after the header:
+
+uv0_scale, uv1_scale
+num LOD levels
+vert attributes
+animation data size, animation data
+chunk for each level, coarsest first:
+	chunk size
+	num verts, num indices, num batches for this level
+	batches
+	compressed index data (if num indices > 0)
+	compressed vertex data for the vertices added by this level (if any)
+
+The header batch count and data sizes are those of the finest level.
+*/
+static void writeProgressiveMesh(const BatchedMesh& mesh, OutStream& file, const BatchedMesh::WriteOptions& write_options)
+{
+	const size_t num_verts = mesh.numVerts();
+	const size_t vert_size = mesh.vertexSize();
+	const int num_levels = write_options.num_progressive_lod_levels;
+	checkProperty(num_levels >= 2 && num_levels <= (int)MAX_NUM_LOD_LEVELS, "Invalid num_progressive_lod_levels.");
+	checkProperty(!write_options.write_mesh_version_2, "Progressive meshes can't be written with mesh version 2.");
+	checkProperty(write_options.use_compression && write_options.use_meshopt, "Progressive meshes are always compressed with meshopt and Zstandard, so use_compression and use_meshopt must be set.");
+	checkProperty(write_options.multi_frame_size_B == 0, "Progressive meshes can't be written with multiple frames.");
+	checkProperty(vert_size <= 256, "Vertex size too large for meshoptimizer.");
+	checkProperty(mesh.numIndices() % 3 == 0, "num indices must be a multiple of 3.");
+
+	//------------------------------------ Build the index data of each level ------------------------------------
+	// Each level is simplified from the next finer level, to about a quarter of the triangles.
+	// Batches are simplified separately, so each level has the same batches and materials, although coarse batches may be empty.
+	std::vector<js::Vector<uint32, 16>> level_indices(num_levels);
+	std::vector<std::vector<BatchedMesh::IndicesBatch>> level_batches(num_levels);
+	mesh.toUInt32Indices(level_indices[num_levels - 1]);
+	level_batches[num_levels - 1] = mesh.batches;
+
+	js::Vector<Vec3f, 16> positions;
+	getPositionsForSimplification(mesh, positions);
+
+	js::Vector<uint32, 16> simplified;
+	for(int l=num_levels-2; l>=0; --l)
+	{
+		const js::Vector<uint32, 16>& finer_indices = level_indices[l + 1];
+		for(size_t b=0; b<level_batches[l + 1].size(); ++b)
+		{
+			const BatchedMesh::IndicesBatch& finer_batch = level_batches[l + 1][b];
+			checkProperty(finer_batch.num_indices % 3 == 0 && (size_t)finer_batch.indices_start + finer_batch.num_indices <= finer_indices.size(), "Invalid batch.");
+
+			size_t num_simplified_indices = 0;
+			if(finer_batch.num_indices > 0)
+			{
+				simplified.resizeNoCopy(finer_batch.num_indices);
+				num_simplified_indices = meshopt_simplify(simplified.data(), &finer_indices[finer_batch.indices_start], finer_batch.num_indices, &positions[0].x, num_verts, sizeof(Vec3f),
+					/*target index count=*/finer_batch.num_indices / 12 * 3, /*target error=*/1.f, /*options=*/0, /*result error=*/NULL); // Coarse levels are chosen by triangle count, not error.
+			}
+
+			BatchedMesh::IndicesBatch batch;
+			batch.indices_start = (uint32)level_indices[l].size();
+			batch.num_indices = (uint32)num_simplified_indices;
+			batch.material_index = finer_batch.material_index;
+			level_batches[l].push_back(batch);
+
+			level_indices[l].resize(level_indices[l].size() + num_simplified_indices);
+			if(num_simplified_indices > 0)
+				std::memcpy(&level_indices[l][batch.indices_start], simplified.data(), num_simplified_indices * sizeof(uint32));
+		}
+	}
+
+	//------------------------------------ Reorder vertices in order of first use, coarsest level first ------------------------------------
+	// Then the vertices used by each level are a prefix of the vertex data.
+	js::Vector<uint32, 16> all_indices;
+	for(int l=0; l<num_levels; ++l)
+		all_indices.append(level_indices[l]);
+
+	std::vector<uint32> remap(num_verts);
+	size_t num_used_verts = meshopt_optimizeVertexFetchRemap(remap.data(), all_indices.data(), all_indices.size(), num_verts);
+	for(size_t i=0; i<num_verts; ++i)
+		if(remap[i] == ~0u) // If vertex is not used by any triangle, put it at the end.
+			remap[i] = (uint32)num_used_verts++;
+	runtimeCheck(num_used_verts == num_verts);
+
+	glare::AllocatorVector<uint8, 16> reordered_vertex_data(mesh.vertex_data.size());
+	for(size_t i=0; i<num_verts; ++i)
+		std::memcpy(&reordered_vertex_data[remap[i] * vert_size], &mesh.vertex_data[i * vert_size], vert_size);
+
+	//------------------------------------ Write header, vert attributes and animation data ------------------------------------
+	BatchedMeshHeader header;
+	header.magic_number = MAGIC_NUMBER;
+	header.format_version = 4; // Progressive meshes only need version 4, so keep them readable by version 4 readers.
+	header.header_size = sizeof(BatchedMeshHeader);
+	header.flags = FLAG_USE_COMPRESSION | FLAG_USE_MESHOPT | FLAG_PROGRESSIVE_LODS;
+	header.num_vert_attributes = (uint32)mesh.vert_attributes.size();
+	header.num_batches = (uint32)mesh.batches.size();
+	header.index_type = (uint32)mesh.index_type;
+	header.index_data_size_B = (uint32)mesh.index_data.size();
+	header.vertex_data_size_B = (uint32)mesh.vertex_data.size();
+	header.aabb_min = Vec3f(mesh.aabb_os.min_);
+	header.aabb_max = Vec3f(mesh.aabb_os.max_);
+	file.writeData(&header, sizeof(BatchedMeshHeader));
+
+	file.writeFloat(mesh.uv0_scale);
+	file.writeFloat(mesh.uv1_scale);
+	file.writeUInt32((uint32)num_levels);
+
+	for(size_t i=0; i<mesh.vert_attributes.size(); ++i)
+	{
+		file.writeUInt32((uint32)mesh.vert_attributes[i].type);
+		file.writeUInt32((uint32)mesh.vert_attributes[i].component_type);
+	}
+
+	// Animation data is written before the levels, since every level needs it.
+	BufferOutStream anim_data;
+	if(!mesh.animation_data.animations.empty() || !mesh.animation_data.joint_nodes.empty())
+		mesh.animation_data.writeToStream(anim_data);
+	file.writeUInt32((uint32)anim_data.buf.size());
+	file.writeData(anim_data.buf.data(), anim_data.buf.size());
+
+	//------------------------------------ Write a chunk for each level ------------------------------------
+	meshopt_encodeIndexVersion(1);
+
+	BufferOutStream chunk;
+	js::Vector<uint8> compressed_data;
+	glare::AllocatorVector<uint8> new_vertex_data;
+	size_t level_num_verts = 0;
+	size_t prev_level_num_verts = 0;
+	for(int l=0; l<num_levels; ++l)
+	{
+		js::Vector<uint32, 16>& indices = level_indices[l];
+		for(size_t i=0; i<indices.size(); ++i)
+		{
+			indices[i] = remap[indices[i]];
+			level_num_verts = myMax(level_num_verts, (size_t)indices[i] + 1);
+		}
+		if(l == num_levels - 1)
+			level_num_verts = num_verts;
+
+		chunk.clear();
+		chunk.writeUInt32((uint32)level_num_verts);
+		chunk.writeUInt32((uint32)indices.size());
+		chunk.writeUInt32((uint32)level_batches[l].size());
+		if(!level_batches[l].empty())
+			chunk.writeData(level_batches[l].data(), level_batches[l].size() * sizeof(BatchedMesh::IndicesBatch));
+
+		if(!indices.empty())
+		{
+			encodeAndCompressIndices(indices.data(), indices.size(), level_num_verts, compressed_data, write_options.compression_level);
+			chunk.writeUInt32((uint32)compressed_data.size());
+			chunk.writeData(compressed_data.data(), compressed_data.size());
+		}
+
+		if(level_num_verts > prev_level_num_verts)
+		{
+			new_vertex_data.resizeNoCopy((level_num_verts - prev_level_num_verts) * vert_size);
+			std::memcpy(new_vertex_data.data(), &reordered_vertex_data[prev_level_num_verts * vert_size], new_vertex_data.size());
+
+			encodeAndCompressData(level_num_verts - prev_level_num_verts, new_vertex_data, compressed_data, write_options.compression_level, write_options.meshopt_vertex_version);
+			chunk.writeUInt32((uint32)compressed_data.size());
+			chunk.writeData(compressed_data.data(), compressed_data.size());
+		}
+
+		file.writeUInt32((uint32)chunk.buf.size());
+		file.writeData(chunk.buf.data(), chunk.buf.size());
+
+		if(PRINT_STATS) conPrint("LOD level " + toString(l) + ": " + toString(indices.size() / 3) + " tris, " + toString(level_num_verts) + " verts, chunk size: " + toString(chunk.buf.size()) + " B");
+
+		prev_level_num_verts = level_num_verts;
+	}
+}
+
+
+
+
+/*
+Multi-frame compressed data layout:
+
+num frames
+num indices or vertices per frame
+compressed size of each frame
+frames
+
+Each frame is encoded with meshopt and compressed with Zstandard independently of the others, so the frames can be compressed and decompressed in parallel.
+The frame size only depends on WriteOptions::multi_frame_size_B, so the written file doesn't depend on the number of threads.
+*/
+class CompressFrameTask : public glare::Task
+{
+public:
+	virtual void run(size_t /*thread_index*/) override
+	{
+		try
+		{
+			if(indices)
+				encodeAndCompressIndices(indices + begin, end - begin, num_verts, *compressed_data_out, compression_level);
+			else
+				encodeAndCompressData(vertex_data + begin * vert_size, end - begin, vert_size, *compressed_data_out, compression_level, meshopt_vertex_version);
+		}
+		catch(glare::Exception& e)
+		{
+			error = true;
+			error_msg = e.what();
+		}
+	}
+
+	const uint32* indices; // If non-null, compress indices [begin, end).  Otherwise compress vertices [begin, end) of vertex_data.
+	const uint8* vertex_data;
+	size_t vert_size;
+	size_t num_verts;
+	size_t begin, end;
+	int compression_level;
+	int meshopt_vertex_version;
+	js::Vector<uint8>* compressed_data_out;
+	bool error;
+	std::string error_msg;
+};
+
+
+// Compresses and writes either indices (if indices is non-null) or vertex_data.  Multi-threaded if task_manager is non-null.
+static void writeMultiFrameData(OutStream& file, const uint32* indices, const uint8* vertex_data, size_t vert_size, size_t num_verts, size_t num_elems, size_t num_elems_per_frame, 
+	const BatchedMesh::WriteOptions& write_options, glare::TaskManager* task_manager)
+{
+	assert(num_elems_per_frame > 0);
+	const size_t num_frames = Maths::roundedUpDivide(num_elems, num_elems_per_frame);
+
+	std::vector<js::Vector<uint8>> compressed_frames(num_frames);
+	glare::TaskGroupRef group = new glare::TaskGroup();
+	for(size_t i=0; i<num_frames; ++i)
+	{
+		Reference<CompressFrameTask> task = new CompressFrameTask();
+		task->indices = indices;
+		task->vertex_data = vertex_data;
+		task->vert_size = vert_size;
+		task->num_verts = num_verts;
+		task->begin = i * num_elems_per_frame;
+		task->end = myMin(num_elems, (i + 1) * num_elems_per_frame);
+		task->compression_level = write_options.compression_level;
+		task->meshopt_vertex_version = write_options.meshopt_vertex_version;
+		task->compressed_data_out = &compressed_frames[i];
+		task->error = false;
+		group->tasks.push_back(task);
+	}
+
+	if(task_manager && num_frames > 1)
+		task_manager->runTaskGroup(group);
+	else
+		for(size_t i=0; i<group->tasks.size(); ++i)
+			group->tasks[i]->run(/*thread index=*/0);
+
+	for(size_t i=0; i<group->tasks.size(); ++i)
+	{
+		const CompressFrameTask* task = group->tasks[i].downcastToPtr<CompressFrameTask>();
+		if(task->error)
+			throw glare::Exception(task->error_msg);
+	}
+
+	file.writeUInt32((uint32)num_frames);
+	file.writeUInt32((uint32)num_elems_per_frame);
+	for(size_t i=0; i<num_frames; ++i)
+		file.writeUInt32((uint32)compressed_frames[i].size());
+	for(size_t i=0; i<num_frames; ++i)
+		file.writeData(compressed_frames[i].data(), compressed_frames[i].size());
+
+	if(PRINT_STATS) conPrint((indices ? "Indices: " : "Vertices: ") + toString(num_frames) + " frames");
+}
+
+
+class DecompressFrameTask : public glare::Task
+{
+public:
+	virtual void run(size_t /*thread_index*/) override
+	{
+		try
+		{
+			// Use the default allocator for the temporary buffer, as the mesh allocator may not be thread-safe.
+			glare::AllocatorVector<uint8> decompressed;
+			decompressData(compressed_data, compressed_size, max_decompressed_size, decompressed);
+
+			if(is_indices)
+			{
+				if(meshopt_decodeIndexBuffer(/*dest=*/dest + begin * elem_size, /*index count=*/end - begin, /*index size=*/elem_size, decompressed.data(), decompressed.size()) != 0)
+					throw glare::Exception("meshopt_decodeIndexBuffer failed.");
+			}
+			else
+			{
+				if(meshopt_decodeVertexBuffer(/*destination=*/dest + begin * elem_size, end - begin, /*vertex size=*/elem_size, decompressed.data(), decompressed.size()) != 0)
+					throw glare::Exception("meshopt_decodeVertexBuffer failed.");
+			}
+		}
+		catch(glare::Exception& e)
+		{
+			error = true;
+			error_msg = e.what();
+		}
+	}
+
+	const uint8* compressed_data;
+	size_t compressed_size;
+	uint64 max_decompressed_size;
+	bool is_indices;
+	uint8* dest;
+	size_t elem_size; // Index or vertex size in bytes.
+	size_t begin, end; // Range of indices or vertices in dest.
+	bool error;
+	std::string error_msg;
+};
+
+
+// Reads data written by writeMultiFrameData() and decodes it into dest, which should have room for num_elems indices or vertices.  Multi-threaded if task_manager is non-null.
+static void readMultiFrameData(BufferViewInStream& file, bool is_indices, uint8* dest, size_t elem_size, size_t num_elems, uint64 max_decompressed_size, glare::TaskManager* task_manager)
+{
+	const uint32 num_frames = file.readUInt32();
+	const uint32 num_elems_per_frame = file.readUInt32();
+	if(num_elems_per_frame == 0 || (is_indices && num_elems_per_frame % 3 != 0) || num_frames != Maths::roundedUpDivide<size_t>(num_elems, num_elems_per_frame))
+		throw glare::Exception("Invalid multi-frame data.");
+
+	if(!file.canReadNBytes((size_t)num_frames * sizeof(uint32)))
+		throw glare::Exception("Invalid multi-frame data.");
+	std::vector<uint32> compressed_sizes(num_frames);
+	file.readData(compressed_sizes.data(), num_frames * sizeof(uint32));
+
+	glare::TaskGroupRef group = new glare::TaskGroup();
+	for(size_t i=0; i<num_frames; ++i)
+	{
+		if(!file.canReadNBytes(compressed_sizes[i]))
+			throw glare::Exception("Invalid compressed_size");
+
+		Reference<DecompressFrameTask> task = new DecompressFrameTask();
+		task->compressed_data = (const uint8*)file.currentReadPtr();
+		task->compressed_size = compressed_sizes[i];
+		task->max_decompressed_size = max_decompressed_size;
+		task->is_indices = is_indices;
+		task->dest = dest;
+		task->elem_size = elem_size;
+		task->begin = i * num_elems_per_frame;
+		task->end = myMin<size_t>(num_elems, (i + 1) * num_elems_per_frame);
+		task->error = false;
+		group->tasks.push_back(task);
+
+		file.advanceReadIndex(compressed_sizes[i]);
+	}
+
+	if(task_manager && num_frames > 1)
+		task_manager->runTaskGroup(group);
+	else
+		for(size_t i=0; i<group->tasks.size(); ++i)
+			group->tasks[i]->run(/*thread index=*/0);
+
+	// Report the error from the first frame that failed.
+	for(size_t i=0; i<group->tasks.size(); ++i)
+	{
+		const DecompressFrameTask* task = group->tasks[i].downcastToPtr<DecompressFrameTask>();
+		if(task->error)
+			throw glare::Exception(task->error_msg);
+	}
+}
+
+
+void BatchedMesh::writeToFile(const std::string& dest_path, const WriteOptions& write_options, glare::TaskManager* task_manager) const // throws glare::Exception on failure
 {
 	const size_t num_verts = numVerts();
 	if(num_verts == 0)
@@ -904,11 +1325,11 @@ void BatchedMesh::writeToFile(const std::string& dest_path, const WriteOptions&
 
 	FileOutStream file(dest_path);
 
-	writeToOutStream(file, write_options);
+	writeToOutStream(file, write_options, task_manager);
 }
 
 
-void BatchedMesh::writeToOutStream(OutStream& file, const WriteOptions& write_options) const
+void BatchedMesh::writeToOutStream(OutStream& file, const WriteOptions& write_options, glare::TaskManager* task_manager) const
 {
 	//Timer write_timer;
 
@@ -916,14 +1337,24 @@ void BatchedMesh::writeToOutStream(OutStream& file, const WriteOptions& write_op
 	if(num_verts == 0)
 		throw glare::Exception("BatchedMesh::writeToOutStream(): mesh must have at least one vertex.");
 
-	const uint32 version_to_write = write_options.write_mesh_version_2 ? 2 : FORMAT_VERSION;
+	if(write_options.num_progressive_lod_levels > 1)
+	{
+		writeProgressiveMesh(*this, file, write_options);
+		return;
+	}
+
 	const bool compress_vert_attributes_together = !write_options.write_mesh_version_2;
+	const bool multi_frame = write_options.use_compression && write_options.use_meshopt && compress_vert_attributes_together && (write_options.multi_frame_size_B > 0);
+
+	// Only write a version newer than 3 if it's needed, so the mesh can be read by older readers.
+	const uint32 version_to_write = write_options.write_mesh_version_2 ? 2 : (multi_frame ? 5 : 3);
 
 	BatchedMeshHeader header;
 	header.magic_number = MAGIC_NUMBER;
 	header.format_version = version_to_write;
 	header.header_size = sizeof(BatchedMeshHeader);
-	header.flags = (write_options.use_compression ? FLAG_USE_COMPRESSION : 0) | (write_options.use_meshopt ? FLAG_USE_MESHOPT : 0) | (compress_vert_attributes_together ? FLAG_COMPRESS_VERT_ATTRIBUTES_TOGETHER : 0);
+	header.flags = (write_options.use_compression ? FLAG_USE_COMPRESSION : 0) | (write_options.use_meshopt ? FLAG_USE_MESHOPT : 0) | (compress_vert_attributes_together ? FLAG_COMPRESS_VERT_ATTRIBUTES_TOGETHER : 0) | 
+		(multi_frame ? FLAG_MULTI_FRAME_COMPRESSION : 0);
 	header.num_vert_attributes = (uint32)vert_attributes.size();
 	header.num_batches = (uint32)batches.size();
 	header.index_type = (uint32)index_type;
@@ -983,29 +1414,47 @@ void BatchedMesh::writeToOutStream(OutStream& file, const WriteOptions& write_op
 
 				meshopt_encodeIndexVersion(1);
 
-				const size_t index_buffer_bound = meshopt_encodeIndexBufferBound(num_indices, numVerts());
-				js::Vector<uint8> encoded_indices(index_buffer_bound);
+				if(multi_frame)
+				{
+					// Frames have a whole number of triangles.
+					const size_t indices_per_frame = myMax<size_t>(3, write_options.multi_frame_size_B / componentTypeSize(index_type) / 3 * 3);
+					writeMultiFrameData(file, uint32_indices_data, /*vertex data=*/NULL, /*vert size=*/0, num_verts, num_indices, indices_per_frame, write_options, task_manager);
+				}
+				else
+				{
+					const size_t index_buffer_bound = meshopt_encodeIndexBufferBound(num_indices, numVerts());
+					js::Vector<uint8> encoded_indices(index_buffer_bound);
 			
-				const size_t res_encoded_index_buf_size = meshopt_encodeIndexBuffer(encoded_indices.data(), encoded_indices.size(), uint32_indices_data, num_indices);
-				encoded_indices.resize(res_encoded_index_buf_size);
+					const size_t res_encoded_index_buf_size = meshopt_encodeIndexBuffer(encoded_indices.data(), encoded_indices.size(), uint32_indices_data, num_indices);
+					encoded_indices.resize(res_encoded_index_buf_size);
 
-				const size_t compressed_bound = ZSTD_compressBound(encoded_indices.size());
-				js::Vector<uint8> compressed_data(compressed_bound);
+					const size_t compressed_bound = ZSTD_compressBound(encoded_indices.size());
+					js::Vector<uint8> compressed_data(compressed_bound);
 
-				// Compress the index buffer with Zstandard
-				const size_t compressed_size = ZSTD_compress(compressed_data.data(), compressed_data.size(), encoded_indices.data(), encoded_indices.size(), write_options.compression_level);
-				if(ZSTD_isError(compressed_size))
-					throw glare::Exception(std::string("Compression failed: ") + ZSTD_getErrorName(compressed_size));
+					// Compress the index buffer with Zstandard
+					const size_t compressed_size = ZSTD_compress(compressed_data.data(), compressed_data.size(), encoded_indices.data(), encoded_indices.size(), write_options.compression_level);
+					if(ZSTD_isError(compressed_size))
+						throw glare::Exception(std::string("Compression failed: ") + ZSTD_getErrorName(compressed_size));
 
-				// Now write compressed data to disk
-				file.writeUInt32((uint32)compressed_size);
-				file.writeData(compressed_data.data(), compressed_size);
+					// Now write compressed data to disk
+					file.writeUInt32((uint32)compressed_size);
+					file.writeData(compressed_data.data(), compressed_size);
 
-				if(PRINT_STATS) conPrint("Indices: compressed size: " + toString(compressed_size) + " B");
+					if(PRINT_STATS) conPrint("Indices: compressed size: " + toString(compressed_size) + " B");
+				}
 			}
 
 			// Compress and write vertex data
-			if(compress_vert_attributes_together)
+			if(multi_frame)
+			{
+				const size_t vertex_size = vertexSize();
+				if(vertex_size % 4 != 0)
+					throw glare::Exception("Vertex size must be a multiple of 4 bytes for meshopt compression.");
+
+				const size_t verts_per_frame = myMax<size_t>(1, write_options.multi_frame_size_B / vertex_size);
+				writeMultiFrameData(file, /*indices=*/NULL, vertex_data.data(), vertex_size, num_verts, num_verts, verts_per_frame, write_options, task_manager);
+			}
+			else if(compress_vert_attributes_together)
 			{
 				// We will compress all attributes together.
 				glare::AllocatorVector<uint8, 16> combined_filtered = vertex_data;
@@ -1015,7 +1464,7 @@ void BatchedMesh::writeToOutStream(OutStream& file, const WriteOptions& write_op
 
 				// Compress combined, filtered data with meshopt_encodeVertexBuffer and zstd.
 				js::Vector<uint8> compressed_data;
-				encodeAndCompressData(*this, combined_filtered, /*compressed_data_out=*/compressed_data, write_options.compression_level, write_options.meshopt_vertex_version);
+				encodeAndCompressData(num_verts, combined_filtered, /*compressed_data_out=*/compressed_data, write_options.compression_level, write_options.meshopt_vertex_version);
 
 				// Write compressed data to output stream / disk
 				file.writeUInt32((uint32)compressed_data.size());
@@ -1051,7 +1500,7 @@ void BatchedMesh::writeToOutStream(OutStream& file, const WriteOptions& write_op
 						/*bits=*/write_options.pos_mantissa_bits, (const float*)attr_data.data(), meshopt_EncodeExpSharedComponent);
 
 					js::Vector<uint8> compressed_data;
-					encodeAndCompressData(*this, filtered, /*compressed_data_out=*/compressed_data, write_options.compression_level, write_options.meshopt_vertex_version);
+					encodeAndCompressData(num_verts, filtered, /*compressed_data_out=*/compressed_data, write_options.compression_level, write_options.meshopt_vertex_version);
 
 					// Write to output stream / disk
 					file.writeUInt32((uint32)compressed_data.size());
@@ -1087,7 +1536,7 @@ void BatchedMesh::writeToOutStream(OutStream& file, const WriteOptions& write_op
 						meshopt_encodeFilterOct(filtered.data(), /*count=*/num_verts, /*stride=*/4, /*bits=*/8, (const float*)unpacked_n.data());
 
 						js::Vector<uint8> compressed_data;
-						encodeAndCompressData(*this, filtered, /*compressed_data_out=*/compressed_data, write_options.compression_level, write_options.meshopt_vertex_version);
+						encodeAndCompressData(num_verts, filtered, /*compressed_data_out=*/compressed_data, write_options.compression_level, write_options.meshopt_vertex_version);
 
 						// Write to output stream / disk
 						file.writeUInt32((uint32)compressed_data.size());
@@ -1124,7 +1573,7 @@ void BatchedMesh::writeToOutStream(OutStream& file, const WriteOptions& write_op
 							throw glare::Exception("Unhandled UV 0 type.");
 
 						js::Vector<uint8> compressed_data;
-						encodeAndCompressData(*this, filtered, /*compressed_data_out=*/compressed_data, write_options.compression_level, write_options.meshopt_vertex_version);
+						encodeAndCompressData(num_verts, filtered, /*compressed_data_out=*/compressed_data, write_options.compression_level, write_options.meshopt_vertex_version);
 
 						// Write to output stream / disk
 						file.writeUInt32((uint32)compressed_data.size());
@@ -1143,7 +1592,7 @@ void BatchedMesh::writeToOutStream(OutStream& file, const WriteOptions& write_op
 
 						js::Vector<uint8> compressed_data;
 						//glare::AllocatorVector<uint8> use_attr_data
-						encodeAndCompressData(*this, attr_data, /*compressed_data_out=*/compressed_data, write_options.compression_level, write_options.meshopt_vertex_version);
+						encodeAndCompressData(num_verts, attr_data, /*compressed_data_out=*/compressed_data, write_options.compression_level, write_options.meshopt_vertex_version);
 
 						// Write to output stream / disk
 						file.writeUInt32((uint32)compressed_data.size());
@@ -1324,17 +1773,64 @@ void BatchedMesh::writeToOutStream(OutStream& file, const WriteOptions& write_op
 
 static const uint32 MAX_NUM_VERT_ATTRIBUTES = 100;
 static const uint32 MAX_NUM_BATCHES = 1000000;
+static const uint32 MAX_INDEX_DATA_SIZE = 1 << 29; // 512 MB
+static const uint32 MAX_VERTEX_DATA_SIZE = 1 << 29; // 512 MB
+
+
+// Reads the vert attribute types and component types, and computes the attribute offsets.
+static void readVertAttributes(BufferViewInStream& file, uint32 num_vert_attributes, BatchedMesh& mesh_out)
+{
+	if(num_vert_attributes == 0)
+		throw glare::Exception("Zero vert attributes.");
+	if(num_vert_attributes > MAX_NUM_VERT_ATTRIBUTES)
+		throw glare::Exception("Too many vert attributes.");
+
+	mesh_out.vert_attributes.resize(num_vert_attributes);
+	size_t cur_offset = 0;
+	for(size_t i=0; i<mesh_out.vert_attributes.size(); ++i)
+	{
+		const uint32 type = file.readUInt32();
+		if(type > BatchedMesh::MAX_VERT_ATTRIBUTE_TYPE_VALUE)
+			throw glare::Exception("Invalid vert attribute type value.");
+		mesh_out.vert_attributes[i].type = (BatchedMesh::VertAttributeType)type;
 
+		const uint32 component_type = file.readUInt32();
+		if(component_type > BatchedMesh::MAX_COMPONENT_TYPE_VALUE)
+			throw glare::Exception("Invalid vert attribute component type value.");
+		mesh_out.vert_attributes[i].component_type = (BatchedMesh::ComponentType)component_type;
 
-Reference<BatchedMesh> BatchedMesh::readFromFile(const std::string& src_path, glare::Allocator* mem_allocator)
+		// Special case for an oct16 normal immediately following a uint16*3 position, put at offset 6:
+		if(i == 1 && 
+			(mesh_out.vert_attributes[0].type == BatchedMesh::VertAttribute_Position) && (mesh_out.vert_attributes[0].component_type == BatchedMesh::ComponentType_UInt16) &&
+			(mesh_out.vert_attributes[1].type == BatchedMesh::VertAttribute_Normal)   && (mesh_out.vert_attributes[1].component_type == BatchedMesh::ComponentType_Oct16))
+		{
+			cur_offset = sizeof(uint16) * 3;
+		}
+
+		mesh_out.vert_attributes[i].offset_B = cur_offset;
+		
+		const size_t vert_attr_size_B = BatchedMesh::vertAttributeSize(mesh_out.vert_attributes[i]);
+		cur_offset += vert_attr_size_B;
+		cur_offset = Maths::roundUpToMultipleOfPowerOf2<size_t>(cur_offset, 4);
+	}
+	runtimeCheck(mesh_out.vertexSize() == cur_offset);
+
+	if((cur_offset % 4) != 0)
+		throw glare::Exception("Invalid vertex size (" + toString(cur_offset) + " B): must be a multiple of 4 bytes.");
+}
+
+
+Reference<BatchedMesh> BatchedMesh::readFromFile(const std::string& src_path, glare::Allocator* mem_allocator, glare::TaskManager* task_manager, 
+	const AnimationCompressionParams* anim_compression_params)
 {
 	FileInStream file(src_path);
 
-	return readFromData(file.fileData(), file.fileSize(), mem_allocator);
+	return readFromData(file.fileData(), file.fileSize(), mem_allocator, task_manager, anim_compression_params);
 }
 
 
-Reference<BatchedMesh> BatchedMesh::readFromData(const void* data, size_t data_len, glare::Allocator* mem_allocator)
+Reference<BatchedMesh> BatchedMesh::readFromData(const void* data, size_t data_len, glare::Allocator* mem_allocator, glare::TaskManager* task_manager, 
+	const AnimationCompressionParams* anim_compression_params)
 {
 	ZoneScoped; // Tracy profiler
 
@@ -1352,6 +1848,14 @@ Reference<BatchedMesh> BatchedMesh::readFromData(const void* data, size_t data_l
 		if(header.format_version > FORMAT_VERSION)
 			throw glare::Exception("Unsupported format version " + toString(header.format_version) + ".");
 
+		if(header.format_version >= 4 && (header.flags & FLAG_PROGRESSIVE_LODS) != 0)
+		{
+			BatchedMeshProgressiveReader reader(mem_allocator);
+			Reference<BatchedMesh> mesh = reader.readFinestLevel(data, data_len);
+			if(anim_compression_params)
+				mesh->animation_data.compressOutputData(*anim_compression_params);
+			return mesh;
+		}
 		
 		// Skip past rest of header
 		if(header.header_size > 10000 || header.header_size > file.size())
@@ -1373,45 +1877,8 @@ Reference<BatchedMesh> BatchedMesh::readFromData(const void* data, size_t data_l
 
 
 		// Read vert attributes
-		if(header.num_vert_attributes == 0)
-			throw glare::Exception("Zero vert attributes.");
-		if(header.num_vert_attributes > MAX_NUM_VERT_ATTRIBUTES)
-			throw glare::Exception("Too many vert attributes.");
-		
-
 		BatchedMesh& mesh_out = *batched_mesh;
-		mesh_out.vert_attributes.resize(header.num_vert_attributes);
-		size_t cur_offset = 0;
-		for(size_t i=0; i<mesh_out.vert_attributes.size(); ++i)
-		{
-			const uint32 type = file.readUInt32();
-			if(type > MAX_VERT_ATTRIBUTE_TYPE_VALUE)
-				throw glare::Exception("Invalid vert attribute type value.");
-			mesh_out.vert_attributes[i].type = (VertAttributeType)type;
-
-			const uint32 component_type = file.readUInt32();
-			if(component_type > MAX_COMPONENT_TYPE_VALUE)
-				throw glare::Exception("Invalid vert attribute component type value.");
-			mesh_out.vert_attributes[i].component_type = (ComponentType)component_type;
-
-			// Special case for an oct16 normal immediately following a uint16*3 position, put at offset 6:
-			if(i == 1 && 
-				(mesh_out.vert_attributes[0].type == VertAttribute_Position) && (mesh_out.vert_attributes[0].component_type == ComponentType_UInt16) &&
-				(mesh_out.vert_attributes[1].type == VertAttribute_Normal)   && (mesh_out.vert_attributes[1].component_type == ComponentType_Oct16))
-			{
-				cur_offset = sizeof(uint16) * 3;
-			}
-
-			mesh_out.vert_attributes[i].offset_B = cur_offset;
-			
-			const size_t vert_attr_size_B = vertAttributeSize(mesh_out.vert_attributes[i]);
-			cur_offset += vert_attr_size_B;
-			cur_offset = Maths::roundUpToMultipleOfPowerOf2<size_t>(cur_offset, 4);
-		}
-		runtimeCheck(mesh_out.vertexSize() == cur_offset);
-
-		if((cur_offset % 4) != 0)
-			throw glare::Exception("Invalid vertex size (" + toString(cur_offset) + " B): must be a multiple of 4 bytes.");
+		readVertAttributes(file, header.num_vert_attributes, mesh_out);
 		
 		// Read batches
 		if(header.num_batches > MAX_NUM_BATCHES)
@@ -1436,7 +1903,6 @@ Reference<BatchedMesh> BatchedMesh::readFromData(const void* data, size_t data_l
 
 		const size_t num_indices = header.index_data_size_B / componentTypeSize((ComponentType)header.index_type);
 
-		const uint32 MAX_INDEX_DATA_SIZE = 1 << 29; // 512 MB
 		if(header.index_data_size_B > MAX_INDEX_DATA_SIZE)
 			throw glare::Exception("Invalid index_data_size_B (too large).");
 
@@ -1447,7 +1913,6 @@ Reference<BatchedMesh> BatchedMesh::readFromData(const void* data, size_t data_l
 		if(header.vertex_data_size_B % mesh_out.vertexSize() != 0)
 			throw glare::Exception("Invalid vertex_data_size_B: " + toString(header.vertex_data_size_B));
 
-		const uint32 MAX_VERTEX_DATA_SIZE = 1 << 29; // 512 MB
 		if(header.vertex_data_size_B > MAX_VERTEX_DATA_SIZE)
 			throw glare::Exception("Invalid vertex_data_size_B (" + toString(header.vertex_data_size_B) + ", too large, max is " + toString(MAX_VERTEX_DATA_SIZE) + ").");
 
@@ -1460,7 +1925,18 @@ Reference<BatchedMesh> BatchedMesh::readFromData(const void* data, size_t data_l
 		const bool compression = (header.flags & FLAG_USE_COMPRESSION) != 0;
 		if(compression)
 		{
-			if((header.flags & FLAG_USE_MESHOPT) != 0)
+			if((header.flags & FLAG_USE_MESHOPT) != 0 && (header.flags & FLAG_MULTI_FRAME_COMPRESSION) != 0)
+			{
+				checkProperty((header.flags & FLAG_COMPRESS_VERT_ATTRIBUTES_TOGETHER) != 0, "Multi-frame compression requires vertex attributes to be compressed together.");
+
+				const size_t vert_size = batched_mesh->vertexSize();
+				checkProperty(vert_size <= 256, "vertex size too large for meshoptimizer."); // meshopt assumes vertex size is <= 256 B and may crash if over.
+
+				// Note that uint8 indices are decoded as uint16 indices.
+				readMultiFrameData(file, /*is indices=*/true, batched_mesh->index_data.data(), componentTypeSize(mesh_out.index_type), num_indices, MAX_INDEX_DATA_SIZE, task_manager);
+				readMultiFrameData(file, /*is indices=*/false, batched_mesh->vertex_data.data(), vert_size, batched_mesh->numVerts(), MAX_VERTEX_DATA_SIZE, task_manager);
+			}
+			else if((header.flags & FLAG_USE_MESHOPT) != 0)
 			{
 				//--------------------------------------- decompress vertex indices ---------------------------------------
 				{
@@ -1785,6 +2261,9 @@ Reference<BatchedMesh> BatchedMesh::readFromData(const void* data, size_t data_l
 				// Timer timer;
 				mesh_out.animation_data.readFromStream(file);
 				// conPrint("Reading animation data took " + timer.elapsedStringNSigFigs(4));
+
+				if(anim_compression_params)
+					mesh_out.animation_data.compressOutputData(*anim_compression_params);
 			}
 			else
 				throw glare::Exception("invalid chunk value: " + toString(chunk));
@@ -1801,6 +2280,258 @@ Reference<BatchedMesh> BatchedMesh::readFromData(const void* data, size_t data_l
 }
 
 
+BatchedMeshProgressiveReader::BatchedMeshProgressiveReader(glare::Allocator* mem_allocator_)
+:	mem_allocator(mem_allocator_),
+	vertex_data(mem_allocator_),
+	total_num_indices(0),
+	total_num_verts(0),
+	next_chunk_offset(0),
+	num_levels(0),
+	num_levels_decoded(0),
+	finest_level_only(false)
+{}
+
+
+BatchedMeshRef BatchedMeshProgressiveReader::readFinestLevel(const void* data, size_t data_len)
+{
+	finest_level_only = true;
+	update(data, data_len);
+	if(!isComplete())
+		throw glare::Exception("Progressive mesh data is truncated.");
+	return mesh;
+}
+
+
+bool BatchedMeshProgressiveReader::update(const void* data, size_t data_len)
+{
+	try
+	{
+		if(num_levels == 0)
+			if(!readPreamble(data, data_len))
+				return false;
+
+		bool decoded_new_level = false;
+		while(num_levels_decoded < num_levels)
+		{
+			// Decode the next level if its chunk has been received.
+			BufferViewInStream file(ArrayRef<uint8>((const uint8*)data, data_len));
+			if(!file.canReadNBytes(next_chunk_offset + sizeof(uint32)))
+				break;
+			file.setReadIndex(next_chunk_offset);
+			const uint32 chunk_size = file.readUInt32();
+			if(!file.canReadNBytes(chunk_size))
+				break;
+
+			decodeLevel((const uint8*)file.currentReadPtr(), chunk_size);
+
+			next_chunk_offset += sizeof(uint32) + chunk_size;
+			decoded_new_level = true;
+		}
+		return decoded_new_level;
+	}
+	catch(std::bad_alloc&)
+	{
+		throw glare::Exception("Bad allocation while reading progressive mesh.");
+	}
+}
+
+
+// Reads the header, vert attributes and animation data.  Returns false if not all of it has been received yet.
+bool BatchedMeshProgressiveReader::readPreamble(const void* data, size_t data_len)
+{
+	BufferViewInStream file(ArrayRef<uint8>((const uint8*)data, data_len));
+
+	if(!file.canReadNBytes(sizeof(BatchedMeshHeader)))
+		return false;
+	BatchedMeshHeader header;
+	file.readData(&header, sizeof(header));
+
+	if(header.magic_number != MAGIC_NUMBER)
+		throw glare::Exception("Invalid magic number.");
+	if(header.format_version > FORMAT_VERSION)
+		throw glare::Exception("Unsupported format version " + toString(header.format_version) + ".");
+	if(header.format_version < 4 || (header.flags & FLAG_PROGRESSIVE_LODS) == 0)
+		throw glare::Exception("Not a progressive mesh.");
+
+	if(header.header_size > 10000)
+		throw glare::Exception("Header size too large.");
+	if(!file.canReadNBytes(header.header_size)) // Check relative to the start of the file.
+		return false;
+	file.setReadIndex(header.header_size);
+
+	if(!file.canReadNBytes(sizeof(float) * 2 + sizeof(uint32)))
+		return false;
+	const float uv0_scale = file.readFloat();
+	const float uv1_scale = file.readFloat();
+	const uint32 file_num_levels = file.readUInt32();
+	if(file_num_levels < 1 || file_num_levels > MAX_NUM_LOD_LEVELS)
+		throw glare::Exception("Invalid number of levels of detail.");
+
+	if(header.num_vert_attributes > MAX_NUM_VERT_ATTRIBUTES)
+		throw glare::Exception("Too many vert attributes.");
+	if(!file.canReadNBytes(header.num_vert_attributes * sizeof(uint32) * 2 + sizeof(uint32)))
+		return false;
+
+	BatchedMeshRef new_template = new BatchedMesh();
+	readVertAttributes(file, header.num_vert_attributes, *new_template);
+	const size_t vert_size = new_template->vertexSize();
+	checkProperty(vert_size <= 256, "vertex size too large for meshoptimizer."); // meshopt assumes vertex size is <= 256 B and may crash if over.
+
+	const uint32 anim_data_size = file.readUInt32();
+	if(!file.canReadNBytes(anim_data_size))
+		return false;
+	if(anim_data_size > 0)
+	{
+		BufferViewInStream anim_stream(ArrayRef<uint8>((const uint8*)file.currentReadPtr(), anim_data_size));
+		new_template->animation_data.readFromStream(anim_stream);
+		file.advanceReadIndex(anim_data_size);
+	}
+
+	if(!(header.index_type == BatchedMesh::ComponentType_UInt8 || header.index_type == BatchedMesh::ComponentType_UInt16 || header.index_type == BatchedMesh::ComponentType_UInt32))
+		throw glare::Exception("Invalid index type value.");
+	if(header.index_data_size_B > MAX_INDEX_DATA_SIZE || header.index_data_size_B % BatchedMesh::componentTypeSize((BatchedMesh::ComponentType)header.index_type) != 0)
+		throw glare::Exception("Invalid index_data_size_B.");
+	if(header.vertex_data_size_B > MAX_VERTEX_DATA_SIZE || header.vertex_data_size_B % vert_size != 0)
+		throw glare::Exception("Invalid vertex_data_size_B.");
+
+	// Use uint16 instead of uint8 indices, as in BatchedMesh::readFromData().
+	new_template->index_type = (header.index_type == BatchedMesh::ComponentType_UInt8) ? BatchedMesh::ComponentType_UInt16 : (BatchedMesh::ComponentType)header.index_type;
+	new_template->aabb_os.min_ = Vec4f(header.aabb_min.x, header.aabb_min.y, header.aabb_min.z, 1.f);
+	new_template->aabb_os.max_ = Vec4f(header.aabb_max.x, header.aabb_max.y, header.aabb_max.z, 1.f);
+	new_template->uv0_scale = uv0_scale;
+	new_template->uv1_scale = uv1_scale;
+
+	mesh_template = new_template;
+	total_num_indices = header.index_data_size_B / (uint32)BatchedMesh::componentTypeSize((BatchedMesh::ComponentType)header.index_type);
+	total_num_verts = header.vertex_data_size_B / (uint32)vert_size;
+	next_chunk_offset = file.getReadIndex();
+	num_levels = (int)file_num_levels;
+	return true;
+}
+
+
+// Decompresses and decodes the vertices added by a level, appending them to vertex_data.
+void BatchedMeshProgressiveReader::decodeLevelVertices(BufferViewInStream& chunk, size_t prev_num_verts, size_t num_verts)
+{
+	if(num_verts > prev_num_verts)
+	{
+		const size_t vert_size = mesh_template->vertexSize();
+
+		glare::AllocatorVector<uint8> decompressed(mem_allocator);
+		readAndDecompressData(chunk, MAX_VERTEX_DATA_SIZE, decompressed);
+
+		vertex_data.resize(num_verts * vert_size);
+		if(meshopt_decodeVertexBuffer(/*destination=*/&vertex_data[prev_num_verts * vert_size], num_verts - prev_num_verts, /*vertex size=*/vert_size, decompressed.data(), decompressed.size()) != 0)
+		{
+			vertex_data.resize(prev_num_verts * vert_size);
+			throw glare::Exception("meshopt_decodeVertexBuffer failed.");
+		}
+	}
+}
+
+
+void BatchedMeshProgressiveReader::decodeLevel(const uint8* chunk_data, size_t chunk_size)
+{
+	BufferViewInStream chunk(ArrayRef<uint8>(chunk_data, chunk_size));
+
+	const size_t vert_size = mesh_template->vertexSize();
+	const size_t prev_num_verts = vertex_data.size() / vert_size;
+	const bool finest_level = num_levels_decoded == num_levels - 1;
+
+	const uint32 num_verts   = chunk.readUInt32();
+	const uint32 num_indices = chunk.readUInt32();
+	const uint32 num_batches = chunk.readUInt32();
+	if(num_verts < prev_num_verts || num_verts > total_num_verts || (finest_level && num_verts != total_num_verts))
+		throw glare::Exception("Invalid level num verts.");
+	if(num_indices % 3 != 0 || num_indices > total_num_indices || (finest_level && num_indices != total_num_indices))
+		throw glare::Exception("Invalid level num indices.");
+	if(num_batches > MAX_NUM_BATCHES)
+		throw glare::Exception("Too many batches.");
+
+	// If only the finest level is wanted, a coarser level just needs the vertices it adds, which the finer levels use as well.
+	// Skip over its batches and index data, and don't build a mesh for it.
+	if(finest_level_only && !finest_level)
+	{
+		chunk.advanceReadIndex(num_batches * sizeof(BatchedMesh::IndicesBatch));
+		if(num_indices > 0)
+			chunk.advanceReadIndex(chunk.readUInt32()); // Skip compressed index data.
+
+		decodeLevelVertices(chunk, prev_num_verts, num_verts);
+
+		num_levels_decoded++;
+		return;
+	}
+
+	BatchedMeshRef level_mesh = new BatchedMesh();
+	if(mem_allocator)
+	{
+		level_mesh->vertex_data.setAllocator(mem_allocator);
+		level_mesh->index_data.setAllocator(mem_allocator);
+	}
+
+	level_mesh->batches.resize(num_batches);
+	chunk.readData(level_mesh->batches.data(), num_batches * sizeof(BatchedMesh::IndicesBatch));
+	for(size_t b=0; b<level_mesh->batches.size(); ++b)
+	{
+		const BatchedMesh::IndicesBatch& batch = level_mesh->batches[b];
+		if(batch.num_indices % 3 != 0 || CheckedMaths::addUnsignedInts(batch.indices_start, batch.num_indices) > num_indices)
+			throw glare::Exception("Invalid batch index range");
+	}
+
+	//--------------------------------------- Decompress and decode indices ---------------------------------------
+	const size_t index_size = BatchedMesh::componentTypeSize(mesh_template->index_type);
+	level_mesh->index_data.resize(num_indices * index_size);
+	if(num_indices > 0)
+	{
+		glare::AllocatorVector<uint8> decompressed(mem_allocator);
+		readAndDecompressData(chunk, MAX_INDEX_DATA_SIZE, decompressed);
+
+		if(meshopt_decodeIndexBuffer(/*dest=*/level_mesh->index_data.data(), /*index count=*/num_indices, /*index size=*/index_size, decompressed.data(), decompressed.size()) != 0)
+			throw glare::Exception("meshopt_decodeIndexBuffer failed.");
+
+		// Check indices are in range, since each level may be used as soon as it is decoded.
+		uint32 max_index = 0;
+		if(index_size == sizeof(uint16))
+		{
+			const uint16* const indices = (const uint16*)level_mesh->index_data.data();
+			for(size_t i=0; i<num_indices; ++i)
+				max_index = myMax(max_index, (uint32)indices[i]);
+		}
+		else
+		{
+			const uint32* const indices = (const uint32*)level_mesh->index_data.data();
+			for(size_t i=0; i<num_indices; ++i)
+				max_index = myMax(max_index, indices[i]);
+		}
+		if(max_index >= num_verts)
+			throw glare::Exception("Triangle vertex index is out of bounds.");
+	}
+
+	//--------------------------------------- Decompress and decode the vertices added by this level ---------------------------------------
+	decodeLevelVertices(chunk, prev_num_verts, num_verts);
+
+	// The finest level can take the vertex data, as no more levels will be added to it.
+	if(finest_level)
+		level_mesh->vertex_data.swapWith(vertex_data);
+	else
+	{
+		level_mesh->vertex_data.resizeNoCopy(vertex_data.size());
+		if(!vertex_data.empty())
+			std::memcpy(level_mesh->vertex_data.data(), vertex_data.data(), vertex_data.size());
+	}
+
+	level_mesh->vert_attributes = mesh_template->vert_attributes;
+	level_mesh->index_type = mesh_template->index_type;
+	level_mesh->aabb_os = mesh_template->aabb_os; // Bounds the finest level, so also bounds the coarser levels.
+	level_mesh->uv0_scale = mesh_template->uv0_scale;
+	level_mesh->uv1_scale = mesh_template->uv1_scale;
+	level_mesh->animation_data = mesh_template->animation_data;
+
+	mesh = level_mesh;
+	num_levels_decoded++;
+}
+
+
 const BatchedMesh::VertAttribute* BatchedMesh::findAttribute(VertAttributeType type) const // returns NULL if not present.
 {
 	for(size_t b=0; b<vert_attributes.size(); ++b)
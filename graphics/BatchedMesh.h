@@ -18,7 +18,9 @@ Copyright Glare Technologies Limited 2020
 
 
 namespace Indigo { class Mesh; }
+namespace glare { class TaskManager; }
 class OutStream;
+class BufferViewInStream;
 
 
 /*=====================================================================
@@ -44,7 +46,7 @@ public:
 	/// @throws glare::Exception on failure.
 	struct WriteOptions
 	{
-		WriteOptions() : write_mesh_version_2(false), use_compression(true), use_meshopt(false), compression_level(3), pos_mantissa_bits(16), uv_mantissa_bits(10), meshopt_vertex_version(1)  {}
+		WriteOptions() : write_mesh_version_2(false), use_compression(true), use_meshopt(false), compression_level(3), pos_mantissa_bits(16), uv_mantissa_bits(10), meshopt_vertex_version(1), num_progressive_lod_levels(1), multi_frame_size_B(0)  {}
 		
 		bool write_mesh_version_2; // Write an older batched mesh version for backwards compatibility.  Default is false.
 		bool use_compression;
@@ -53,20 +55,30 @@ public:
 		int pos_mantissa_bits; // For meshopt filtering.  Should be >= 1 and <= 24.  Only used in the write_mesh_version_2 case.
 		int uv_mantissa_bits;  // For meshopt filtering.  Should be >= 1 and <= 24.  Only used in the write_mesh_version_2 case.
 		int meshopt_vertex_version; // Can be 0 or 1.  Default is 1.
+		int num_progressive_lod_levels; // If > 1, write a progressive mesh with this many levels of detail.  See BatchedMeshProgressiveReader.  Progressive meshes are always compressed with meshopt and Zstandard, so need use_compression and use_meshopt to be set.  Default is 1 (not progressive).
+		size_t multi_frame_size_B; // If non-zero, compress the index and vertex data as independent frames of about this many uncompressed bytes each, so they can be compressed and decompressed in parallel.  Only used with use_meshopt, and not with write_mesh_version_2 or progressive meshes.  Default is 0 (one frame each).
 	};
-	void writeToFile(const std::string& dest_path, const WriteOptions& write_options = WriteOptions()) const;
+	// Compresses frames in parallel if task_manager is non-null and multi_frame_size_B is non-zero.
+	void writeToFile(const std::string& dest_path, const WriteOptions& write_options = WriteOptions(), glare::TaskManager* task_manager = NULL) const;
 
-	void writeToOutStream(OutStream& out_stream, const WriteOptions& write_options) const;
+	void writeToOutStream(OutStream& out_stream, const WriteOptions& write_options, glare::TaskManager* task_manager = NULL) const;
 
 	/// Read a BatchedMesh object from disk.
+	/// Progressive meshes are read in full, and the finest level of detail is returned.
 	/// Memory allocator param can be null.
 	/// @param src_path			Path on disk to read from.
 	/// @param mem_allocator	Memory allocator.  Can be null.
 	/// @param mesh_out			Mesh object to read to.
+	/// @param task_manager		If non-null, frames of multi-frame compressed data are decompressed in parallel.
+	/// @param anim_compression_params	If non-null, the animation output data is compressed with AnimationData::compressOutputData() after it is read.
+	///							The returned mesh can then be rendered, but not written.  This is opt-in, for loaders that only render the mesh;
+	///							the import, simplification and write paths in this tree leave it null, since they write the mesh back out.
 	/// @throws glare::Exception on failure.
-	static Reference<BatchedMesh> readFromFile(const std::string& src_path, glare::Allocator* mem_allocator);
+	static Reference<BatchedMesh> readFromFile(const std::string& src_path, glare::Allocator* mem_allocator, glare::TaskManager* task_manager = NULL, 
+		const AnimationCompressionParams* anim_compression_params = NULL);
 
-	static Reference<BatchedMesh> readFromData(const void* data, size_t data_len, glare::Allocator* mem_allocator);
+	static Reference<BatchedMesh> readFromData(const void* data, size_t data_len, glare::Allocator* mem_allocator, glare::TaskManager* task_manager = NULL, 
+		const AnimationCompressionParams* anim_compression_params = NULL);
 
 	// Check vertex, joint indices are in bounds etc.
 	// Throws glare::Exception on invalid mesh.
@@ -201,6 +213,66 @@ public:
 typedef Reference<BatchedMesh> BatchedMeshRef;
 
 
+/*=====================================================================
+BatchedMeshProgressiveReader
+----------------------------
+Decodes a progressive BatchedMesh file (written with
+WriteOptions::num_progressive_lod_levels > 1) while it is arriving, e.g. while
+it is being downloaded, so that a coarse level of detail can be used before the
+whole file has been received.
+
+A progressive file stores its levels of detail as independently compressed
+chunks, coarsest first.  The vertices are ordered so that each level only uses
+a prefix of the vertex data, and each chunk holds the vertices that its level
+adds to the prefix, and the complete index data and batches of the level.
+So a level can be decoded as soon as its chunk has arrived.
+
+The finest level has all the triangles and vertices of the written mesh, but
+with the vertices reordered.
+
+Tests are in BatchedMeshTests.
+=====================================================================*/
+class BatchedMeshProgressiveReader
+{
+public:
+	BatchedMeshProgressiveReader(glare::Allocator* mem_allocator); // Memory allocator can be null.
+
+	// data should be the start of the file, with data_len being the number of bytes received so far.
+	// Call again with the same start of the file and a larger data_len as more bytes arrive.
+	// Decodes any levels whose chunks have now been received.  Returns true if a new level was decoded.
+	// Throws glare::Exception on invalid data, or if the file is not a progressive mesh.
+	bool update(const void* data, size_t data_len);
+
+	// Returns the finest level decoded so far, or NULL if no level has been decoded yet.
+	// Each decoded level is a new BatchedMesh object, so references to coarser levels stay valid.
+	BatchedMeshRef getMesh() const { return mesh; }
+
+	int numLevels() const { return num_levels; } // Zero until the start of the file has been read.
+	int numLevelsDecoded() const { return num_levels_decoded; }
+	bool isComplete() const { return num_levels > 0 && num_levels_decoded == num_levels; }
+
+	// Reads a complete file, and returns the finest level.  Coarser levels are only read for the vertices they add, without decoding their indices or building meshes for them.
+	// Throws glare::Exception on invalid or truncated data.
+	BatchedMeshRef readFinestLevel(const void* data, size_t data_len);
+
+private:
+	bool readPreamble(const void* data, size_t data_len);
+	void decodeLevel(const uint8* chunk_data, size_t chunk_size);
+	void decodeLevelVertices(BufferViewInStream& chunk, size_t prev_num_verts, size_t num_verts);
+
+	glare::Allocator* mem_allocator;
+	BatchedMeshRef mesh_template; // Holds the vertex attributes, AABB, uv scales and animation data shared by all levels.
+	BatchedMeshRef mesh;
+	glare::AllocatorVector<uint8, 16> vertex_data; // Vertex data of all levels decoded so far.
+	uint32 total_num_indices;
+	uint32 total_num_verts;
+	size_t next_chunk_offset; // Offset in the file of the chunk for the next level.
+	int num_levels;
+	int num_levels_decoded;
+	bool finest_level_only; // Set by readFinestLevel().
+};
+
+
 size_t BatchedMesh::componentTypeSize(ComponentType t)
 {
 	switch(t)
@@ -22,6 +22,9 @@ Copyright Glare Technologies Limited 2020
 #include "../utils/Timer.h"
 #include "../utils/TestExceptionUtils.h"
 #include "../utils/BufferOutStream.h"
+#include "../utils/BufferInStream.h"
+#include "../utils/FileInStream.h"
+#include "../utils/TaskManager.h"
 #include "../maths/vec2.h"
 #include <algorithm>
 #include "../meshoptimizer/src/meshoptimizer.h"
@@ -144,6 +147,219 @@ static void testWritingAndReadingMesh(const BatchedMesh& batched_mesh, bool do_m
 }
 
 
+// Returns the format version from the header of a written mesh.
+static uint32 getWrittenFormatVersion(const BufferOutStream& out_stream)
+{
+	testAssert(out_stream.buf.size() >= 8);
+	uint32 version;
+	std::memcpy(&version, out_stream.buf.data() + 4, sizeof(uint32)); // The version follows the magic number.
+	return version;
+}
+
+
+// Check mesh_b has the same triangles as mesh_a.  Vertices are compared by value, since progressive meshes reorder the vertices,
+// and triangles may have their vertices rotated by meshopt index compression.
+static void checkSameTriangles(const BatchedMesh& mesh_a, const BatchedMesh& mesh_b)
+{
+	testAssert(mesh_a.vert_attributes == mesh_b.vert_attributes);
+	testAssert(mesh_a.numIndices() == mesh_b.numIndices());
+
+	const size_t vert_size = mesh_a.vertexSize();
+	for(size_t t=0; t<mesh_a.numIndices() / 3; ++t)
+	{
+		bool matched = false;
+		for(size_t r=0; r<3 && !matched; ++r)
+		{
+			matched = true;
+			for(size_t k=0; k<3 && matched; ++k)
+				matched = std::memcmp(&mesh_a.vertex_data[mesh_a.getIndexAsUInt32(t*3 + k) * vert_size], &mesh_b.vertex_data[mesh_b.getIndexAsUInt32(t*3 + (k + r) % 3) * vert_size], vert_size) == 0;
+		}
+		testAssert(matched);
+	}
+}
+
+
+static int numLevelsDecodedFromPrefix(const js::Vector<uint8, 16>& data, size_t prefix_len)
+{
+	BatchedMeshProgressiveReader reader(/*mem allocator=*/NULL);
+	reader.update(data.data(), prefix_len);
+	return reader.numLevelsDecoded();
+}
+
+
+static void testProgressiveMesh(const BatchedMesh& mesh, int num_levels)
+{
+	try
+	{
+		BufferOutStream out_stream;
+		BatchedMesh::WriteOptions write_options;
+		write_options.use_meshopt = true;
+		write_options.num_progressive_lod_levels = num_levels;
+		mesh.writeToOutStream(out_stream, write_options);
+		const js::Vector<uint8, 16> data(out_stream.buf.data(), out_stream.buf.data() + out_stream.buf.size());
+		testAssert(getWrittenFormatVersion(out_stream) == 4);
+
+		// Progressive meshes are always compressed with meshopt and Zstandard, in a single frame, so write options asking for anything else are rejected.
+		{
+			BufferOutStream bad_out_stream;
+			BatchedMesh::WriteOptions bad_options = write_options;
+			bad_options.use_meshopt = false;
+			testThrowsExcepContainingString([&]() { mesh.writeToOutStream(bad_out_stream, bad_options); }, "use_meshopt");
+			bad_options = write_options;
+			bad_options.use_compression = false;
+			testThrowsExcepContainingString([&]() { mesh.writeToOutStream(bad_out_stream, bad_options); }, "use_compression");
+			bad_options = write_options;
+			bad_options.multi_frame_size_B = 65536;
+			testThrowsExcepContainingString([&]() { mesh.writeToOutStream(bad_out_stream, bad_options); }, "multiple frames");
+		}
+
+		// Reading the whole file gives the finest level, which has the triangles of the written mesh.
+		BatchedMeshRef full_mesh = BatchedMesh::readFromData(data.data(), data.size(), /*mem allocator=*/NULL);
+		testAssert(full_mesh->batches == mesh.batches);
+		testAssert(full_mesh->numVerts() == mesh.numVerts());
+		testAssert(full_mesh->aabb_os == mesh.aabb_os);
+		testAssert(full_mesh->animation_data.nodes.size() == mesh.animation_data.nodes.size());
+		checkSameTriangles(mesh, *full_mesh);
+
+		// Find the number of bytes needed to decode each level.  The number of levels decoded from a prefix of the file increases with the prefix length, so use a binary search.
+		std::vector<size_t> level_min_len(num_levels);
+		for(int l=0; l<num_levels; ++l)
+		{
+			size_t lo = (l == 0) ? 0 : level_min_len[l - 1]; // Decodes at most l levels.
+			size_t hi = data.size(); // Decodes all levels.
+			while(hi - lo > 1)
+			{
+				const size_t mid = (lo + hi) / 2;
+				if(numLevelsDecodedFromPrefix(data, mid) > l)
+					hi = mid;
+				else
+					lo = mid;
+			}
+			level_min_len[l] = hi;
+			testAssert(numLevelsDecodedFromPrefix(data, hi - 1) == l);
+			testAssert(numLevelsDecodedFromPrefix(data, hi) == l + 1);
+		}
+		testAssert(level_min_len[num_levels - 1] == data.size());
+
+		// Feed a reader more and more of the file, as if it were being downloaded.
+		BatchedMeshProgressiveReader reader(/*mem allocator=*/NULL);
+		std::vector<BatchedMeshRef> levels;
+		const size_t step = myMax<size_t>(1, data.size() / 200);
+		for(size_t len=0; ; len = myMin(data.size(), len + step))
+		{
+			const bool decoded_new_level = reader.update(data.data(), len);
+			testAssert(decoded_new_level == (reader.numLevelsDecoded() > (int)levels.size()));
+			if(decoded_new_level)
+				levels.push_back(reader.getMesh());
+
+			// The reader should have decoded exactly the levels that have been received.
+			int expected_num_levels = 0;
+			while(expected_num_levels < num_levels && level_min_len[expected_num_levels] <= len)
+				expected_num_levels++;
+			testAssert(reader.numLevelsDecoded() == expected_num_levels);
+
+			if(len < data.size())
+			{
+				testAssert(!reader.isComplete());
+				try
+				{
+					BatchedMesh::readFromData(data.data(), len, /*mem allocator=*/NULL);
+					failTest("Expected exception reading truncated progressive mesh.");
+				}
+				catch(glare::Exception&)
+				{}
+			}
+			else
+				break;
+		}
+		testAssert(reader.isComplete());
+		testAssert(levels.size() == (size_t)num_levels);
+		checkSameTriangles(*full_mesh, *reader.getMesh());
+		testAssert(full_mesh->vertex_data == reader.getMesh()->vertex_data);
+
+		std::string level_info;
+		for(int l=0; l<num_levels; ++l)
+		{
+			BatchedMeshRef level = levels[l];
+			testAssert(level->batches.size() == mesh.batches.size());
+			testAssert(level->numIndices() <= ((l + 1 < num_levels) ? levels[l + 1]->numIndices() : mesh.numIndices()));
+			testAssert(level->numVerts() <= mesh.numVerts());
+			if(l + 1 < num_levels)
+				level->checkValidAndSanitiseMesh();
+
+			level_info += "level " + toString(l) + ": " + toString(level->numIndices() / 3) + " tris after " + doubleToStringNSigFigs(100.0 * level_min_len[l] / data.size(), 3) + "% of the file" + ((l + 1 < num_levels) ? ", " : "");
+		}
+		conPrint("Progressive mesh (" + toString(data.size()) + " B): " + level_info);
+
+		// Check corrupted files either throw an exception or decode.
+		for(size_t i=0; i<data.size(); i += myMax<size_t>(1, data.size() / 100))
+		{
+			js::Vector<uint8, 16> corrupted = data;
+			corrupted[i] ^= 0x5A;
+			try
+			{
+				BatchedMesh::readFromData(corrupted.data(), corrupted.size(), /*mem allocator=*/NULL);
+			}
+			catch(glare::Exception&)
+			{}
+		}
+	}
+	catch(glare::Exception& e)
+	{
+		failTest(e.what());
+	}
+}
+
+
+// Write mesh with multi-frame compression, and check it reads back the same with and without a task manager, and that truncated data is rejected.
+static void testMultiFrameCompression(const BatchedMesh& mesh, size_t multi_frame_size_B, glare::TaskManager& task_manager)
+{
+	try
+	{
+		BatchedMesh::WriteOptions write_options;
+		write_options.use_meshopt = true;
+		write_options.multi_frame_size_B = multi_frame_size_B;
+
+		BufferOutStream out_stream;
+		mesh.writeToOutStream(out_stream, write_options, &task_manager);
+		const js::Vector<uint8, 16> data(out_stream.buf.data(), out_stream.buf.data() + out_stream.buf.size());
+		testAssert(getWrittenFormatVersion(out_stream) == 5);
+
+		// The output should not depend on whether the frames were compressed in parallel.
+		out_stream.clear();
+		mesh.writeToOutStream(out_stream, write_options, /*task manager=*/NULL);
+		testAssert(out_stream.buf.size() == data.size() && std::memcmp(out_stream.buf.data(), data.data(), data.size()) == 0);
+
+		BatchedMeshRef mesh_serial   = BatchedMesh::readFromData(data.data(), data.size(), /*mem allocator=*/NULL);
+		BatchedMeshRef mesh_parallel = BatchedMesh::readFromData(data.data(), data.size(), /*mem allocator=*/NULL, &task_manager);
+		for(int i=0; i<2; ++i)
+		{
+			const BatchedMesh& mesh2 = (i == 0) ? *mesh_serial : *mesh_parallel;
+			testAssert(mesh2.batches == mesh.batches);
+			testAssert(mesh2.aabb_os == mesh.aabb_os);
+			testAssert(mesh2.vertex_data == mesh.vertex_data);
+			checkSameTriangles(mesh, mesh2);
+		}
+		testAssert(mesh_serial->index_data == mesh_parallel->index_data);
+
+		for(size_t len=0; len<data.size(); len += myMax<size_t>(1, data.size() / 100))
+		{
+			try
+			{
+				BatchedMesh::readFromData(data.data(), len, /*mem allocator=*/NULL, &task_manager);
+				failTest("Expected exception reading truncated multi-frame mesh.");
+			}
+			catch(glare::Exception&)
+			{}
+		}
+	}
+	catch(glare::Exception& e)
+	{
+		failTest(e.what());
+	}
+}
+
+
 static void testIndigoMeshConversion(const BatchedMesh& batched_mesh)
 {
 	try
@@ -281,6 +497,12 @@ static void fuzzWritingMeshToStream(BatchedMeshRef batched_mesh)
 	options.use_meshopt = true;
 	options.write_mesh_version_2 = true;
 	batched_mesh->writeToOutStream(buffer_out_stream, options);
+
+	// Write as a progressive mesh.
+	buffer_out_stream.clear();
+	options.write_mesh_version_2 = false;
+	options.num_progressive_lod_levels = 3;
+	batched_mesh->writeToOutStream(buffer_out_stream, options);
 }
 
 
@@ -749,6 +971,51 @@ void BatchedMeshTests::test()
 		}
 
 
+		// Test compressing the animation data when loading, for plain and progressive meshes.
+		{
+			const std::string path = TestUtils::getTestReposDir() + "/testfiles/bmesh/Fox_glb_3500729461392160556.bmesh";
+			BatchedMeshRef mesh = BatchedMesh::readFromFile(path, /*mem allocator=*/NULL);
+			testAssert(!mesh->animation_data.animations.empty());
+			testAssert(!mesh->animation_data.isOutputDataCompressed());
+
+			BufferOutStream progressive_out_stream;
+			BatchedMesh::WriteOptions write_options;
+			write_options.use_meshopt = true;
+			write_options.num_progressive_lod_levels = 2;
+			mesh->writeToOutStream(progressive_out_stream, write_options);
+
+			const AnimationCompressionParams params;
+			BatchedMeshRef compressed_mesh = BatchedMesh::readFromFile(path, /*mem allocator=*/NULL, /*task manager=*/NULL, &params);
+			BatchedMeshRef compressed_progressive_mesh = BatchedMesh::readFromData(progressive_out_stream.buf.data(), progressive_out_stream.buf.size(), /*mem allocator=*/NULL, 
+				/*task manager=*/NULL, &params);
+
+			for(int z=0; z<2; ++z)
+			{
+				const AnimationData& compressed_data = ((z == 0) ? compressed_mesh : compressed_progressive_mesh)->animation_data;
+				testAssert(compressed_data.isOutputDataCompressed());
+				testAssert(compressed_data.getTotalMemUsage() < mesh->animation_data.getTotalMemUsage());
+				testAssert(compressed_data.nodes.size() == mesh->animation_data.nodes.size());
+
+				// Poses sampled from the compressed data should be close to the poses from the original data.
+				js::Vector<AnimationKeyFrameLocation, 16> key_frame_locs, compressed_key_frame_locs;
+				AnimationPose pose, compressed_pose;
+				for(int anim_i=0; anim_i<(int)mesh->animation_data.animations.size(); ++anim_i)
+					for(int i=0; i<50; ++i)
+					{
+						const float t = i * 0.033f;
+						mesh->animation_data.samplePose(anim_i, anim_i, t, t, 0.f, key_frame_locs, pose);
+						compressed_data.samplePose(anim_i, anim_i, t, t, 0.f, compressed_key_frame_locs, compressed_pose);
+						for(size_t n=0; n<pose.rot.size(); ++n)
+						{
+							testAssert(epsEqual(pose.trans[n], compressed_pose.trans[n], 1.0e-3f));
+							testAssert(epsEqual(pose.rot[n].v, compressed_pose.rot[n].v, 1.0e-3f) || epsEqual(pose.rot[n].v, -compressed_pose.rot[n].v, 1.0e-3f)); // q and -q are the same rotation.
+							testAssert(epsEqual(pose.scale[n], compressed_pose.scale[n], 1.0e-3f));
+						}
+					}
+			}
+		}
+
+
 		// Test a mesh with 2 UV sets (from lightmap unwrapping)
 		{
 			Indigo::Mesh indigo_mesh;
@@ -773,6 +1040,151 @@ void BatchedMeshTests::test()
 		}
 
 
+		// Test writing and decoding progressive meshes, including from truncated data.
+		{
+			// Mesh with animation data
+			BatchedMeshRef mesh = BatchedMesh::readFromFile(TestUtils::getTestReposDir() + "/testfiles/bmesh/meebit_09842_t_solid_vrm.bmesh", /*mem allocator=*/NULL);
+			testProgressiveMesh(*mesh, /*num levels=*/4);
+			testProgressiveMesh(*mesh, /*num levels=*/2);
+
+			// Quantised mesh, with uint16 positions and oct16 normals
+			mesh = BatchedMesh::readFromFile(TestUtils::getTestReposDir() + "/testfiles/bmesh/chunk_128_0_2.bmesh", /*mem allocator=*/NULL);
+			testProgressiveMesh(*mesh->buildQuantisedMesh(BatchedMesh::QuantiseOptions()), /*num levels=*/3);
+
+			// Single triangle
+			testProgressiveMesh(*makeMesh(), /*num levels=*/2);
+
+			// The coarsest level should arrive well before the whole file.
+			mesh = BatchedMesh::readFromFile(TestUtils::getTestReposDir() + "/testfiles/bmesh/meebit_09842_t_solid_vrm.bmesh", /*mem allocator=*/NULL);
+			BufferOutStream out_stream;
+			BatchedMesh::WriteOptions write_options;
+			write_options.use_meshopt = true;
+			write_options.num_progressive_lod_levels = 4;
+			mesh->writeToOutStream(out_stream, write_options);
+			BatchedMeshProgressiveReader reader(/*mem allocator=*/NULL);
+			testAssert(reader.update(out_stream.buf.data(), out_stream.buf.size() / 2));
+			testAssert(reader.numLevelsDecoded() >= 1 && !reader.isComplete());
+			testAssert(reader.getMesh()->numIndices() < mesh->numIndices());
+
+			// Non-progressive files are rejected by the progressive reader.
+			out_stream.clear();
+			mesh->writeToOutStream(out_stream, BatchedMesh::WriteOptions());
+			testAssert(getWrittenFormatVersion(out_stream) == 3);
+			BatchedMeshProgressiveReader reader2(/*mem allocator=*/NULL);
+			testExceptionExpected([&]() { reader2.update(out_stream.buf.data(), out_stream.buf.size()); });
+		}
+
+
+		// Test writing and reading meshes compressed as multiple independent frames.
+		{
+			glare::TaskManager task_manager;
+
+			BatchedMeshRef mesh = BatchedMesh::readFromFile(TestUtils::getTestReposDir() + "/testfiles/bmesh/meebit_09842_t_solid_vrm.bmesh", /*mem allocator=*/NULL);
+			testMultiFrameCompression(*mesh, /*multi_frame_size_B=*/1000, task_manager);
+			testMultiFrameCompression(*mesh, /*multi_frame_size_B=*/65536, task_manager);
+			testMultiFrameCompression(*mesh, /*multi_frame_size_B=*/1 << 30, task_manager); // One frame each for indices and vertices.
+
+			// Quantised mesh, with uint16 positions and oct16 normals
+			mesh = BatchedMesh::readFromFile(TestUtils::getTestReposDir() + "/testfiles/bmesh/chunk_128_0_2.bmesh", /*mem allocator=*/NULL);
+			testMultiFrameCompression(*mesh->buildQuantisedMesh(BatchedMesh::QuantiseOptions()), /*multi_frame_size_B=*/1000, task_manager);
+
+			// Single triangle, with uint8 indices.  The frame size is smaller than a triangle.
+			testMultiFrameCompression(*makeMesh(), /*multi_frame_size_B=*/1, task_manager);
+		}
+
+
+		// Perf test of single-frame vs multi-frame compression.  Use a multi-core machine and a large mesh to see the effect of parallel frames.
+		if(false)
+		{
+			glare::TaskManager task_manager;
+
+			GLTFLoadedData gltf_data;
+			BatchedMeshRef mesh = FormatDecoderGLTF::loadGLBFile(TestUtils::getTestReposDir() + "/testfiles/gltf/2CylinderEngine.glb", gltf_data);
+			const double uncompressed_MB = (mesh->index_data.size() + mesh->vertex_data.size()) * 1.0e-6;
+
+			const int levels[] = { 3, 9, 19 };
+			const size_t frame_sizes[] = { 0, 65536, 262144 }; // 0 = single frame.
+			for(int l=0; l<3; ++l)
+			for(int f=0; f<3; ++f)
+			{
+				BatchedMesh::WriteOptions write_options;
+				write_options.use_meshopt = true;
+				write_options.compression_level = levels[l];
+				write_options.multi_frame_size_B = frame_sizes[f];
+
+				BufferOutStream out_stream;
+				double min_write_time = 1.0e10;
+				for(int i=0; i<3; ++i)
+				{
+					out_stream.clear();
+					Timer timer;
+					mesh->writeToOutStream(out_stream, write_options, &task_manager);
+					min_write_time = myMin(min_write_time, timer.elapsed());
+				}
+
+				double min_read_time = 1.0e10;
+				for(int i=0; i<10; ++i)
+				{
+					Timer timer;
+					BatchedMeshRef mesh2 = BatchedMesh::readFromData(out_stream.buf.data(), out_stream.buf.size(), /*mem allocator=*/NULL, &task_manager);
+					min_read_time = myMin(min_read_time, timer.elapsed());
+				}
+
+				conPrint("Compression level " + toString(levels[l]) + ", frame size " + (frame_sizes[f] ? toString(frame_sizes[f]) + " B" : std::string("unlimited")) + ": " + toString(out_stream.buf.size()) + " B, compression: " + 
+					doubleToStringNSigFigs(uncompressed_MB / min_write_time, 4) + " MB/s, decompression: " + doubleToStringNSigFigs(uncompressed_MB / min_read_time, 4) + " MB/s");
+			}
+		}
+
+
+		// Perf test of decoding with the inlined buffer stream read methods.
+		{
+			std::vector<unsigned char> bmesh_data;
+			FileUtils::readEntireFile(TestUtils::getTestReposDir() + "/testfiles/bmesh/meebit_09842_t_solid_vrm.bmesh", bmesh_data);
+
+			double min_read_time = 1.0e10;
+			for(int i=0; i<20; ++i)
+			{
+				Timer timer;
+				BatchedMeshRef mesh = BatchedMesh::readFromData(bmesh_data.data(), bmesh_data.size(), /*mem allocator=*/NULL);
+				min_read_time = myMin(min_read_time, timer.elapsed());
+			}
+			conPrint("BatchedMesh::readFromData() time: " + doubleToStringNSigFigs(min_read_time * 1.0e3, 4) + " ms");
+
+			// Compare reading the animation data chunk through the virtual InStream methods (FileInStream) with the inlined BufferInStream path.
+			BatchedMeshRef mesh = BatchedMesh::readFromData(bmesh_data.data(), bmesh_data.size(), /*mem allocator=*/NULL);
+			BufferOutStream anim_out_stream;
+			mesh->animation_data.writeToStream(anim_out_stream);
+
+			const std::string anim_data_path = PlatformUtils::getTempDirPath() + "/anim_data_perf_test.bin";
+			FileUtils::writeEntireFile(anim_data_path, (const char*)anim_out_stream.buf.data(), anim_out_stream.buf.size());
+
+			double min_generic_time = 1.0e10;
+			double min_inlined_time = 1.0e10;
+			for(int i=0; i<100; ++i)
+			{
+				{
+					FileInStream file(anim_data_path);
+					AnimationData data;
+					Timer timer;
+					data.readFromStream(file);
+					min_generic_time = myMin(min_generic_time, timer.elapsed());
+					testAssert(data.nodes.size() == mesh->animation_data.nodes.size());
+				}
+				{
+					BufferInStream buffer_stream(ArrayRef<unsigned char>(anim_out_stream.buf.data(), anim_out_stream.buf.size()));
+					AnimationData data;
+					Timer timer;
+					data.readFromStream(buffer_stream);
+					min_inlined_time = myMin(min_inlined_time, timer.elapsed());
+					testAssert(data.nodes.size() == mesh->animation_data.nodes.size());
+					testAssert(buffer_stream.endOfStream());
+				}
+			}
+			conPrint("AnimationData::readFromStream() with FileInStream (virtual reads):     " + doubleToStringNSigFigs(min_generic_time * 1.0e6, 4) + " us");
+			conPrint("AnimationData::readFromStream() with BufferInStream (inlined reads):   " + doubleToStringNSigFigs(min_inlined_time * 1.0e6, 4) + " us");
+		}
+
+
 
 		// Test convertToSigned
 		{
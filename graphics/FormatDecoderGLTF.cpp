@@ -23,9 +23,13 @@ Copyright Glare Technologies Limited 2021 -
 #include "../utils/Base64.h"
 #include "../utils/RuntimeCheck.h"
 #include "../utils/Timer.h"
+#include "../utils/Task.h"
+#include "../utils/TaskManager.h"
 #include "../maths/Quat.h"
+#include "../maths/vec2.h"
 #include "../graphics/Colour4f.h"
 #include "../graphics/BatchedMesh.h"
+#include "../meshoptimizer/src/meshoptimizer.h"
 #include <assert.h>
 #include <vector>
 #include <map>
@@ -35,7 +39,7 @@ Copyright Glare Technologies Limited 2021 -
 
 struct GLTFBuffer : public RefCounted
 {
-	GLTFBuffer() : file(NULL), binary_data(NULL) {}
+	GLTFBuffer() : file(NULL), binary_data(NULL), data_size(0), meshopt_fallback(false) {}
 	~GLTFBuffer() { delete file; }
 	
 	MemMappedFile* file;
@@ -45,11 +49,29 @@ struct GLTFBuffer : public RefCounted
 	std::vector<unsigned char> decoded_base64_data;
 
 	std::vector<uint8> copied_data;
+
+	bool meshopt_fallback; // Fallback buffer for EXT_meshopt_compression buffer views.  We always decode the compressed data instead, so this buffer is never loaded.
 };
 typedef Reference<GLTFBuffer> GLTFBufferRef;
 
 
 // https://github.com/KhronosGroup/glTF/blob/master/specification/2.0/README.md#reference-bufferview
+// See https://github.com/KhronosGroup/glTF/blob/main/extensions/2.0/Vendor/EXT_meshopt_compression/README.md
+struct GLTFMeshoptCompression
+{
+	GLTFMeshoptCompression() : present(false) {}
+
+	bool present;
+	size_t buffer; // Buffer holding the compressed data.
+	size_t byte_offset;
+	size_t byte_length;
+	size_t byte_stride; // Size of each decoded element.
+	size_t count; // Number of decoded elements.
+	std::string mode; // "ATTRIBUTES", "TRIANGLES" or "INDICES"
+	std::string filter; // "NONE", "OCTAHEDRAL", "QUATERNION" or "EXPONENTIAL"
+};
+
+
 struct GLTFBufferView : public RefCounted
 {
 	size_t buffer;
@@ -58,6 +80,8 @@ struct GLTFBufferView : public RefCounted
 	size_t byte_stride; // The stride, in bytes, between vertex attributes. When this is not defined, data is tightly packed.
 	std::string name;
 	size_t target;
+
+	GLTFMeshoptCompression meshopt;
 };
 typedef Reference<GLTFBufferView> GLTFBufferViewRef;
 
@@ -106,6 +130,7 @@ struct GLTFAccessor : public RefCounted
 	// min
 	// max
 	std::string type;
+	bool normalised; // Integer components are mapped to [0, 1] (unsigned) or [-1, 1] (signed).
 };
 typedef Reference<GLTFAccessor> GLTFAccessorRef;
 
@@ -139,12 +164,19 @@ typedef Reference<GLTFScene> GLTFSceneRef;
 
 struct GLTFTextureObject
 {
-	GLTFTextureObject() : index(std::numeric_limits<size_t>::max()) {}
+	GLTFTextureObject() : index(std::numeric_limits<size_t>::max()), texCoord(0), KHR_texture_transform_present(false), offset(0.f), rotation(0.f), scale(1.f) {}
 
 	bool valid() const { return index != std::numeric_limits<size_t>::max(); }
 
 	size_t index;
-	size_t texCoord;
+	size_t texCoord; // Overridden by the KHR_texture_transform texCoord, if present.
+
+	//----------- From KHR_texture_transform extension:------------
+	bool KHR_texture_transform_present;
+	Vec2f offset;
+	float rotation;
+	Vec2f scale;
+	//----------- End from KHR_texture_transform extension:------------
 };
 
 
@@ -254,7 +286,7 @@ typedef Reference<GLTFSkin> GLTFSkinRef;
 
 struct GLTFData
 {
-	GLTFData() : scene(0) {}
+	GLTFData() : scene(0), mesh_quantization_used(false) {}
 
 	std::vector<GLTFBufferRef> buffers;
 	std::vector<GLTFBufferViewRef> buffer_views;
@@ -269,6 +301,7 @@ struct GLTFData
 	std::vector<GLTFSceneRef> scenes;
 	GLTFVRMExtensionRef vrm_data;
 	size_t scene;
+	bool mesh_quantization_used; // True if the file uses KHR_mesh_quantization.
 
 	AttributesPresent attr_present; // Attributes present on any of the meshes.
 };
@@ -386,6 +419,27 @@ static Colour4f parseColour4ChildArrayWithDefault(const JSONParser& parser, cons
 }
 
 
+static Vec2f parseVec2ChildArrayWithDefault(const JSONParser& parser, const JSONNode& node, const std::string& name, const Vec2f& default_val)
+{
+	if(node.type != JSONNode::Type_Object)
+		throw glare::Exception("Expected type object.");
+
+	for(size_t i=0; i<node.name_val_pairs.size(); ++i)
+		if(node.name_val_pairs[i].name == name)
+		{
+			const JSONNode& array_node = parser.nodes[node.name_val_pairs[i].value_node_index];
+			checkNodeType(array_node, JSONNode::Type_Array);
+
+			if(array_node.child_indices.size() != 2)
+				throw glare::Exception("Expected 2 elements in array.");
+
+			return Vec2f((float)parser.nodes[array_node.child_indices[0]].getDoubleValue(), (float)parser.nodes[array_node.child_indices[1]].getDoubleValue());
+		}
+
+	return default_val;
+}
+
+
 static GLTFTextureObject parseTextureIfPresent(const JSONParser& parser, const JSONNode& node, const std::string& name)
 {
 	if(node.hasChild(name))
@@ -395,6 +449,22 @@ static GLTFTextureObject parseTextureIfPresent(const JSONParser& parser, const J
 		GLTFTextureObject tex;
 		tex.index		= tex_node.getChildUIntValueWithDefaultVal(parser, "index", std::numeric_limits<size_t>::max());
 		tex.texCoord	= tex_node.getChildUIntValueWithDefaultVal(parser, "texCoord", 0);
+
+		// See https://github.com/KhronosGroup/glTF/tree/main/extensions/2.0/Khronos/KHR_texture_transform
+		if(tex_node.hasChild("extensions"))
+		{
+			const JSONNode& extensions_node = tex_node.getChildObject(parser, "extensions");
+			if(extensions_node.hasChild("KHR_texture_transform"))
+			{
+				const JSONNode& transform_node = extensions_node.getChildObject(parser, "KHR_texture_transform");
+
+				tex.KHR_texture_transform_present = true;
+				tex.offset		= parseVec2ChildArrayWithDefault(parser, transform_node, "offset", Vec2f(0.f));
+				tex.rotation	= (float)transform_node.getChildDoubleValueWithDefaultVal(parser, "rotation", 0.0);
+				tex.scale		= parseVec2ChildArrayWithDefault(parser, transform_node, "scale", Vec2f(1.f));
+				tex.texCoord	= transform_node.getChildUIntValueWithDefaultVal(parser, "texCoord", tex.texCoord);
+			}
+		}
 		return tex;
 	}
 	else
@@ -472,6 +542,54 @@ static size_t typeNumComponents(const std::string& type)
 }
 
 
+// Integer component types allowed for quantised attributes by KHR_mesh_quantization.
+static inline bool isQuantisedComponentType(size_t t)
+{
+	return t == GLTF_COMPONENT_TYPE_BYTE || t == GLTF_COMPONENT_TYPE_UNSIGNED_BYTE || t == GLTF_COMPONENT_TYPE_SHORT || t == GLTF_COMPONENT_TYPE_UNSIGNED_SHORT;
+}
+
+
+// Read num_components components of the given type, converting them to float.
+// Normalised integer components are converted as in https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#_accessor_normalized
+static inline void readComponentsAsFloat(const uint8* src, size_t component_type, bool normalised, int num_components, float* out)
+{
+	for(int c=0; c<num_components; ++c)
+	{
+		switch(component_type)
+		{
+		case GLTF_COMPONENT_TYPE_BYTE:
+		{
+			const int8 v = (int8)src[c];
+			out[c] = normalised ? myMax((float)v / 127.f, -1.f) : (float)v;
+			break;
+		}
+		case GLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+			out[c] = normalised ? (float)src[c] / 255.f : (float)src[c];
+			break;
+		case GLTF_COMPONENT_TYPE_SHORT:
+		{
+			int16 v;
+			std::memcpy(&v, src + c * sizeof(int16), sizeof(int16));
+			out[c] = normalised ? myMax((float)v / 32767.f, -1.f) : (float)v;
+			break;
+		}
+		case GLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+		{
+			uint16 v;
+			std::memcpy(&v, src + c * sizeof(uint16), sizeof(uint16));
+			out[c] = normalised ? (float)v / 65535.f : (float)v;
+			break;
+		}
+		case GLTF_COMPONENT_TYPE_FLOAT:
+			std::memcpy(&out[c], src + c * sizeof(float), sizeof(float));
+			break;
+		default:
+			throw glare::Exception("Invalid component type: " + componentTypeString(component_type));
+		}
+	}
+}
+
+
 // Just ignore primitives that do not have mode GLTF_MODE_TRIANGLES for now, instead of throwing an error.
 static inline bool shouldLoadPrimitive(const GLTFPrimitive& primitive)
 {
@@ -691,56 +809,221 @@ static void checkAccessorBounds(const size_t vert_byte_stride, const size_t offs
 }
 
 
-// uint32_indices_out should have sufficient capacity for all indices, but does need to be resized for new indices.
-// mesh_out.vertex_data should have sufficient size for all vertex data (has already been resized)
-static void processNode(GLTFData& data, GLTFNode& node, size_t node_index, const Matrix4f& parent_transform, BatchedMesh& mesh_out, js::Vector<uint32, 16>& uint32_indices_out, size_t& vert_write_i)
+// Decodes the data of a buffer view compressed with EXT_meshopt_compression into decoded_buffer_out.
+// See https://github.com/KhronosGroup/glTF/blob/main/extensions/2.0/Vendor/EXT_meshopt_compression/README.md
+static void decodeMeshoptBufferView(GLTFData& data, const GLTFBufferView& view, GLTFBuffer& decoded_buffer_out)
 {
-	const bool statically_apply_transform = data.skins.empty();
+	const GLTFMeshoptCompression& meshopt = view.meshopt;
+
+	const GLTFBuffer& src_buffer = getBuffer(data, meshopt.buffer);
+	if(src_buffer.meshopt_fallback)
+		throw glare::Exception("EXT_meshopt_compression buffer view refers to a fallback buffer.");
+	if(meshopt.byte_offset > src_buffer.data_size || meshopt.byte_length > src_buffer.data_size - meshopt.byte_offset)
+		throw glare::Exception("EXT_meshopt_compression buffer view is out of bounds.");
+
+	// Check the element size and count, as the meshopt decoding functions just assert that they are valid.
+	const size_t stride = meshopt.byte_stride;
+	const size_t count = meshopt.count;
+	if(count > 1000000000)
+		throw glare::Exception("EXT_meshopt_compression count is too large: " + toString(count));
+	if(meshopt.mode == "ATTRIBUTES")
+		checkProperty(stride > 0 && stride <= 256 && stride % 4 == 0, "Invalid EXT_meshopt_compression byteStride");
+	else if(meshopt.mode == "TRIANGLES")
+		checkProperty((stride == 2 || stride == 4) && count % 3 == 0, "Invalid EXT_meshopt_compression byteStride or count");
+	else if(meshopt.mode == "INDICES")
+		checkProperty(stride == 2 || stride == 4, "Invalid EXT_meshopt_compression byteStride");
+	else
+		throw glare::Exception("Invalid EXT_meshopt_compression mode: '" + meshopt.mode + "'");
+
+	// The decoded data should exactly fill the buffer view.  Check this, and limit the decoded size, before allocating, as count and byteStride are user controlled.
+	if(view.byte_length > 1000000000ull)
+		throw glare::Exception("EXT_meshopt_compression buffer view byteLength is too large.");
+	if(count * stride != view.byte_length) // count <= 10^9 and stride <= 256 so this can't overflow.
+		throw glare::Exception("EXT_meshopt_compression count * byteStride does not match buffer view byteLength.");
+
+	decoded_buffer_out.copied_data.resize(count * stride);
+	uint8* const decoded = decoded_buffer_out.copied_data.data();
+	const uint8* const src = src_buffer.binary_data + meshopt.byte_offset;
+
+	int res;
+	if(meshopt.mode == "ATTRIBUTES")
+		res = meshopt_decodeVertexBuffer(decoded, count, stride, src, meshopt.byte_length);
+	else if(meshopt.mode == "TRIANGLES")
+		res = meshopt_decodeIndexBuffer(decoded, count, stride, src, meshopt.byte_length);
+	else
+		res = meshopt_decodeIndexSequence(decoded, count, stride, src, meshopt.byte_length);
+	if(res != 0)
+		throw glare::Exception("Failed to decode EXT_meshopt_compression buffer view (error code " + toString(res) + ")");
 
-	const Matrix4f trans = Matrix4f::translationMatrix(node.translation.x, node.translation.y, node.translation.z);
-	const Matrix4f rot = normalise(node.rotation).toMatrix();
-	const Matrix4f scale = Matrix4f::scaleMatrix(node.scale.x, node.scale.y, node.scale.z);
-	const Matrix4f node_transform = parent_transform * node.matrix * trans * rot * scale; // Matrix and T,R,S transforms should be mutually exclusive in GLTF files.  Just multiply them together however.
+	// Undo the filter, if any, which is applied in place.
+	if(meshopt.filter == "NONE")
+	{}
+	else if(meshopt.filter == "OCTAHEDRAL")
+	{
+		checkProperty(meshopt.mode == "ATTRIBUTES" && (stride == 4 || stride == 8), "Invalid byteStride for EXT_meshopt_compression OCTAHEDRAL filter");
+		meshopt_decodeFilterOct(decoded, count, stride);
+	}
+	else if(meshopt.filter == "QUATERNION")
+	{
+		checkProperty(meshopt.mode == "ATTRIBUTES" && stride == 8, "Invalid byteStride for EXT_meshopt_compression QUATERNION filter");
+		meshopt_decodeFilterQuat(decoded, count, stride);
+	}
+	else if(meshopt.filter == "EXPONENTIAL")
+	{
+		checkProperty(meshopt.mode == "ATTRIBUTES", "Invalid mode for EXT_meshopt_compression EXPONENTIAL filter"); // stride is a multiple of 4 for ATTRIBUTES
+		meshopt_decodeFilterExp(decoded, count, stride);
+	}
+	else
+		throw glare::Exception("Invalid EXT_meshopt_compression filter: '" + meshopt.filter + "'");
 
-	// Process mesh
-	if(node.mesh != std::numeric_limits<size_t>::max())
+	decoded_buffer_out.binary_data = decoded;
+	decoded_buffer_out.data_size = decoded_buffer_out.copied_data.size();
+}
+
+
+class DecodeMeshoptBufferViewTask : public glare::Task
+{
+public:
+	virtual void run(size_t /*thread_index*/) override
 	{
-		GLTFMesh& mesh = getMesh(data, node.mesh);
+		try
+		{
+			decodeMeshoptBufferView(*data, *view, *decoded_buffer);
+		}
+		catch(glare::Exception& e)
+		{
+			error = true;
+			error_msg = e.what();
+		}
+		catch(std::bad_alloc&)
+		{
+			error = true;
+			error_msg = "Bad allocation while decoding EXT_meshopt_compression buffer view.";
+		}
+	}
 
-		for(size_t i=0; i<mesh.primitives.size(); ++i)
+	GLTFData* data;
+	const GLTFBufferView* view;
+	GLTFBuffer* decoded_buffer;
+	bool error;
+	std::string error_msg;
+};
+
+
+// Decode each buffer view compressed with EXT_meshopt_compression into a new buffer, and point the buffer view at the new buffer.
+// Decodes the buffer views in parallel if task_manager is non-null.
+static void decodeMeshoptBufferViews(GLTFData& data, glare::TaskManager* task_manager)
+{
+	std::vector<GLTFBufferView*> views;
+	std::vector<GLTFBufferRef> decoded_buffers;
+	for(size_t i=0; i<data.buffer_views.size(); ++i)
+		if(data.buffer_views[i]->meshopt.present)
 		{
-			GLTFPrimitive& primitive = *mesh.primitives[i];
+			views.push_back(data.buffer_views[i].ptr());
+			decoded_buffers.push_back(new GLTFBuffer());
+		}
 
-			if(!shouldLoadPrimitive(primitive))
-				continue;
+	if(views.empty())
+		return;
 
+	if(task_manager && views.size() > 1)
+	{
+		glare::TaskGroupRef group = new glare::TaskGroup();
+		for(size_t i=0; i<views.size(); ++i)
+		{
+			Reference<DecodeMeshoptBufferViewTask> task = new DecodeMeshoptBufferViewTask();
+			task->data = &data;
+			task->view = views[i];
+			task->decoded_buffer = decoded_buffers[i].ptr();
+			task->error = false;
+			group->tasks.push_back(task);
+		}
+		task_manager->runTaskGroup(group);
 
-			uint16 use_joint_index = 0;
-			if(!data.skins.empty() && (node.skin == std::numeric_limits<size_t>::max())) // If we have a skin, and if this is a mesh node that doesn't use a skin, then this node uses rigid-body animation.
-			{
-				// Use the skin-based animation system for it - add this node to the list of joints.
-				use_joint_index = (uint16)data.skins.back()->joints.size();
-				data.skins.back()->joints.push_back((int)node_index);
-			}
+		for(size_t i=0; i<group->tasks.size(); ++i)
+		{
+			const DecodeMeshoptBufferViewTask* task = group->tasks[i].downcastToPtr<DecodeMeshoptBufferViewTask>();
+			if(task->error)
+				throw glare::Exception(task->error_msg);
+		}
+	}
+	else
+	{
+		for(size_t i=0; i<views.size(); ++i)
+			decodeMeshoptBufferView(data, *views[i], *decoded_buffers[i]);
+	}
+
+	for(size_t i=0; i<views.size(); ++i)
+	{
+		views[i]->buffer = data.buffers.size();
+		views[i]->byte_offset = 0;
+		data.buffers.push_back(decoded_buffers[i]);
+	}
+}
+
+
+// A primitive to be loaded, and where its vertices and indices are written.
+struct GLTFPrimitiveToLoad
+{
+	GLARE_ALIGNED_16_NEW_DELETE
+
+	Matrix4f node_transform;
+	const GLTFPrimitive* primitive;
+	uint16 use_joint_index;
+	size_t vert_write_i; // Index of the primitive's first vertex in the mesh.
+	size_t indices_write_i; // Index of the primitive's first index in uint32_indices.
+	size_t num_verts;
+	size_t num_indices;
+
+	js::AABBox aabb; // Bounds of the primitive's vertex positions, set by loadPrimitiveRange().
+	bool error;
+	std::string error_msg;
+};
+
+
+// Vertex UVs are shared by all the textures of a material, so only one KHR_texture_transform can be applied to them.  Returns the texture whose transform
+// to use: the first one with a transform, roughly in order of importance.  Only TEXCOORD_0 is loaded, so transforms of textures using other UV sets are ignored.
+static const GLTFTextureObject* getUVTransformTexture(const GLTFMaterial& mat)
+{
+	const GLTFTextureObject* textures[] = { &mat.baseColorTexture, &mat.diffuseTexture, &mat.normalTexture, &mat.metallicRoughnessTexture, &mat.specularGlossinessTexture, &mat.emissiveTexture };
+	for(size_t i=0; i<staticArrayNumElems(textures); ++i)
+		if(textures[i]->valid() && textures[i]->KHR_texture_transform_present && (textures[i]->texCoord == 0))
+			return textures[i];
+	return NULL;
+}
+
+
+// Reads the indices and vertex attributes of primitives [begin, end), and writes each one to the ranges of uint32_indices_out and mesh_out.vertex_data starting at
+// prim.indices_write_i and prim.vert_write_i.  Nothing outside those ranges is written, so different primitives can be loaded concurrently.
+// uint32_indices_out and mesh_out.vertex_data should have already been resized to hold all primitives.
+// If loading a primitive fails, its error and error_msg are set, and the remaining primitives are still loaded.
+static void loadPrimitiveRange(GLTFData& data, std::vector<GLTFPrimitiveToLoad>& primitives, size_t begin, size_t end, BatchedMesh& mesh_out, js::Vector<uint32, 16>& uint32_indices_out)
+{
+	for(size_t prim_i=begin; prim_i<end; ++prim_i)
+	{
+		GLTFPrimitiveToLoad& prim = primitives[prim_i];
+		try
+		{
+			const GLTFPrimitive& primitive = *prim.primitive;
+			const Matrix4f& node_transform = prim.node_transform;
+			const bool statically_apply_transform = data.skins.empty();
+			const uint16 use_joint_index = prim.use_joint_index;
+			const size_t vert_write_i = prim.vert_write_i;
+			const size_t indices_write_i = prim.indices_write_i;
 
-			
 			const GLTFAccessor& pos_accessor = getAccessorForAttribute(data, primitive, "POSITION");
 			const size_t vert_pos_count = pos_accessor.count;
 
-			//--------------------------------------- Read indices ---------------------------------------
-			const size_t indices_write_i = uint32_indices_out.size();
+			// The ranges were computed from the same accessor counts as the total sizes, so should be in bounds.
+			runtimeCheck(vert_pos_count == prim.num_verts);
+			runtimeCheck((vert_write_i + vert_pos_count) * mesh_out.vertexSize() <= mesh_out.vertex_data.size());
 
+			//--------------------------------------- Read indices ---------------------------------------
 			size_t primitive_num_indices;
 			if(primitive.indices == std::numeric_limits<size_t>::max())
 			{
 				// Write one index per vertex.
-				BatchedMesh::IndicesBatch batch;
-				batch.indices_start = (uint32)indices_write_i;
-				batch.material_index = (uint32)primitive.material;
-				batch.num_indices = (uint32)vert_pos_count;
-				mesh_out.batches.push_back(batch);
-
-				uint32_indices_out.resize(uint32_indices_out.size() + vert_pos_count);
+				runtimeCheck(indices_write_i + vert_pos_count <= uint32_indices_out.size());
 
 				for(size_t z=0; z<vert_pos_count; ++z)
 					uint32_indices_out[indices_write_i + z] = (uint32)(z + vert_write_i);
@@ -759,13 +1042,7 @@ static void processNode(GLTFData& data, GLTFNode& node, size_t node_index, const
 
 				checkAccessorBounds(byte_stride, offset_B, value_size_B, index_accessor, buffer, /*expected_num_components=*/1);
 
-				BatchedMesh::IndicesBatch batch;
-				batch.indices_start = (uint32)indices_write_i;
-				batch.material_index = (uint32)primitive.material;
-				batch.num_indices = (uint32)index_accessor.count;
-				mesh_out.batches.push_back(batch);
-
-				uint32_indices_out.resize(uint32_indices_out.size() + index_accessor.count);
+				runtimeCheck(indices_write_i + index_accessor.count <= uint32_indices_out.size());
 
 				if(index_accessor.component_type == GLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
 				{
@@ -802,7 +1079,7 @@ static void processNode(GLTFData& data, GLTFNode& node, size_t node_index, const
 			const BatchedMesh::VertAttribute& pos_attr = mesh_out.getAttribute(BatchedMesh::VertAttribute_Position);
 			{
 				const Matrix4f transform = statically_apply_transform ? node_transform : Matrix4f::identity();
-				
+		
 				const GLTFBufferView& buf_view = getBufferView(data, pos_accessor.buffer_view);
 				const GLTFBuffer& buffer = getBuffer(data, buf_view.buffer);
 
@@ -818,32 +1095,48 @@ static void processNode(GLTFData& data, GLTFNode& node, size_t node_index, const
 
 				runtimeCheck(pos_attr.component_type == BatchedMesh::ComponentType_Float); // We store positions in float format.
 
-				// POSITION attribute must have FLOAT component types (https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#meshes-overview)
-				checkProperty(pos_accessor.component_type == GLTF_COMPONENT_TYPE_FLOAT, "Invalid POSITION component type");
-				
+				// POSITION attribute must have FLOAT component types (https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#meshes-overview),
+				// or may be quantised to an integer type with KHR_mesh_quantization.
+				const bool float_components = pos_accessor.component_type == GLTF_COMPONENT_TYPE_FLOAT;
+				checkProperty(float_components || isQuantisedComponentType(pos_accessor.component_type), "Invalid POSITION component type");
+		
 				// Check alignment before we start reading and writing floats
-				// The source alignments should be valid for valid GLTF files.
-				checkProperty((uint64)(offset_base) % 4 == 0, "source offset_base not multiple of 4");
-				checkProperty(byte_stride % 4 == 0, "source byte stride not multiple of 4");
+				// The source alignments should be valid for valid GLTF files.  Quantised components are read with memcpy so don't need alignment.
+				if(float_components)
+				{
+					checkProperty((uint64)(offset_base) % 4 == 0, "source offset_base not multiple of 4");
+					checkProperty(byte_stride % 4 == 0, "source byte stride not multiple of 4");
+				}
 				// Destination alignments should be valid since dest_vert_stride_B should be a multiple of 4 due to the attribute types we choose, and vertex_data is 16-byte aligned.
 				runtimeCheck(dest_vert_stride_B % 4 == 0);
 				runtimeCheck(dest_attr_offset_B % 4 == 0);
 
+				js::AABBox aabb = js::AABBox::emptyAABBox();
 				for(size_t z=0; z<pos_accessor.count; ++z)
 				{
-					const Vec4f p_os(
-						((const float*)(offset_base + byte_stride * z))[0],
-						((const float*)(offset_base + byte_stride * z))[1],
-						((const float*)(offset_base + byte_stride * z))[2],
-						1
-					);
+					Vec4f p_os;
+					if(float_components)
+						p_os = Vec4f(
+							((const float*)(offset_base + byte_stride * z))[0],
+							((const float*)(offset_base + byte_stride * z))[1],
+							((const float*)(offset_base + byte_stride * z))[2],
+							1
+						);
+					else
+					{
+						readComponentsAsFloat(offset_base + byte_stride * z, pos_accessor.component_type, pos_accessor.normalised, /*num_components=*/3, p_os.x);
+						p_os[3] = 1;
+					}
 
 					const Vec4f p_ws = transform * p_os;
 
 					((float*)&mesh_out.vertex_data[(vert_write_i + z) * dest_vert_stride_B + dest_attr_offset_B])[0] = p_ws[0];
 					((float*)&mesh_out.vertex_data[(vert_write_i + z) * dest_vert_stride_B + dest_attr_offset_B])[1] = p_ws[1];
 					((float*)&mesh_out.vertex_data[(vert_write_i + z) * dest_vert_stride_B + dest_attr_offset_B])[2] = p_ws[2];
+
+					aabb.enlargeToHoldPoint(Vec4f(p_ws[0], p_ws[1], p_ws[2], 1));
 				}
+				prim.aabb = aabb;
 			}
 			//conPrint("Process vertex positions: " + timer.elapsedString());
 
@@ -876,25 +1169,38 @@ static void processNode(GLTFData& data, GLTFNode& node, size_t node_index, const
 
 				runtimeCheck(normals_attr.component_type == BatchedMesh::ComponentType_PackedNormal); // We store normals in packed format.
 
-				// NORMAL attribute must have FLOAT component types (https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#meshes-overview)
-				checkProperty(accessor.component_type == GLTF_COMPONENT_TYPE_FLOAT, "Invalid POSITION component type");
+				// NORMAL attribute must have FLOAT component types (https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#meshes-overview),
+				// or may be normalised BYTE or SHORT with KHR_mesh_quantization.
+				const bool float_components = accessor.component_type == GLTF_COMPONENT_TYPE_FLOAT;
+				checkProperty(float_components || (accessor.normalised && (accessor.component_type == GLTF_COMPONENT_TYPE_BYTE || accessor.component_type == GLTF_COMPONENT_TYPE_SHORT)), 
+					"Invalid NORMAL component type");
 
 				// Check alignment before we start reading and writing floats
 				// The source alignments should be valid for valid GLTF files.
-				checkProperty((uint64)(offset_base) % 4 == 0, "source offset_base not multiple of 4");
-				checkProperty(byte_stride % 4 == 0, "source byte stride not multiple of 4");
+				if(float_components)
+				{
+					checkProperty((uint64)(offset_base) % 4 == 0, "source offset_base not multiple of 4");
+					checkProperty(byte_stride % 4 == 0, "source byte stride not multiple of 4");
+				}
 				// Destination alignments should be valid since dest_vert_stride_B should be a multiple of 4 due to the attribute types we choose, and vertex_data is 16-byte aligned.
 				runtimeCheck(dest_vert_stride_B % 4 == 0);
 				runtimeCheck(dest_attr_offset_B % 4 == 0);
 
 				for(size_t z=0; z<accessor.count; ++z)
 				{
-					const Vec4f n_os(
-						((const float*)(offset_base + byte_stride * z))[0],
-						((const float*)(offset_base + byte_stride * z))[1],
-						((const float*)(offset_base + byte_stride * z))[2],
-						0
-					);
+					Vec4f n_os;
+					if(float_components)
+						n_os = Vec4f(
+							((const float*)(offset_base + byte_stride * z))[0],
+							((const float*)(offset_base + byte_stride * z))[1],
+							((const float*)(offset_base + byte_stride * z))[2],
+							0
+						);
+					else
+					{
+						readComponentsAsFloat(offset_base + byte_stride * z, accessor.component_type, /*normalised=*/true, /*num_components=*/3, n_os.x);
+						n_os[3] = 0;
+					}
 
 					const Vec4f n_ws = normalise(normal_transform * n_os);
 
@@ -928,8 +1234,6 @@ static void processNode(GLTFData& data, GLTFNode& node, size_t node_index, const
 						*(uint32*)(&mesh_out.vertex_data[(vert_write_i + z) * dest_vert_stride_B + dest_attr_offset_B]) = packed;
 					}
 
-					const size_t total_num_verts = mesh_out.vertex_data.size() / dest_vert_stride_B;
-
 					for(size_t z=0; z<primitive_num_indices/3; z++) // For each tri, splat geometric normal to the vert normal for each vert
 					{
 						const uint32 v0i = uint32_indices_out[indices_write_i + z * 3 + 0];
@@ -937,9 +1241,10 @@ static void processNode(GLTFData& data, GLTFNode& node, size_t node_index, const
 						const uint32 v2i = uint32_indices_out[indices_write_i + z * 3 + 2];
 
 						// Vert indices are not checked yet (are still user-controlled) so check before we use them.
-						checkProperty(v0i < total_num_verts, "vert index out of bounds");
-						checkProperty(v1i < total_num_verts, "vert index out of bounds");
-						checkProperty(v2i < total_num_verts, "vert index out of bounds");
+						// They must refer to this primitive's vertices, which also means we don't touch the vertices of primitives that may be being loaded on other threads.
+						checkProperty(v0i >= vert_write_i && v0i < vert_write_i + vert_pos_count, "vert index out of bounds");
+						checkProperty(v1i >= vert_write_i && v1i < vert_write_i + vert_pos_count, "vert index out of bounds");
+						checkProperty(v2i >= vert_write_i && v2i < vert_write_i + vert_pos_count, "vert index out of bounds");
 
 						const size_t v0_offset_B = v0i * dest_vert_stride_B + pos_attr.offset_B;
 						const size_t v1_offset_B = v1i * dest_vert_stride_B + pos_attr.offset_B;
@@ -1006,17 +1311,18 @@ static void processNode(GLTFData& data, GLTFNode& node, size_t node_index, const
 
 				runtimeCheck(tangents_attr.component_type == BatchedMesh::ComponentType_PackedNormal); // We store normals in packed format.
 
-				// Check alignment before we start reading and writing floats
-				// The source alignments should be valid for valid GLTF files.
-				checkProperty((uint64)(offset_base) % 4 == 0, "source offset_base not multiple of 4");
-				checkProperty(byte_stride % 4 == 0, "source byte stride not multiple of 4");
 				// Destination alignments should be valid since dest_vert_stride_B should be a multiple of 4 due to the attribute types we choose, and vertex_data is 16-byte aligned.
 				runtimeCheck(dest_vert_stride_B % 4 == 0);
 				runtimeCheck(dest_attr_offset_B % 4 == 0);
 
-				// TANGENT must be FLOAT
+				// TANGENT must be FLOAT, or normalised BYTE or SHORT with KHR_mesh_quantization.
 				if(accessor.component_type == GLTF_COMPONENT_TYPE_FLOAT)
 				{
+					// Check alignment before we start reading floats
+					// The source alignments should be valid for valid GLTF files.
+					checkProperty((uint64)(offset_base) % 4 == 0, "source offset_base not multiple of 4");
+					checkProperty(byte_stride % 4 == 0, "source byte stride not multiple of 4");
+
 					for(size_t z=0; z<accessor.count; ++z)
 					{
 						const Vec4f tangent_os(
@@ -1027,11 +1333,27 @@ static void processNode(GLTFData& data, GLTFNode& node, size_t node_index, const
 						);
 
 						Vec4f tangent_ws = normalise(normal_transform * maskWToZero(tangent_os));
-						
+				
+						tangent_ws[3] = tangent_os[3]; // Copy w component (sign)
+
+						const uint32 packed_tangent = batchedMeshPackNormalWithW(tangent_ws);
+				
+						*(uint32*)(&mesh_out.vertex_data[(vert_write_i + z) * dest_vert_stride_B + dest_attr_offset_B]) = packed_tangent;
+					}
+				}
+				else if(accessor.normalised && (accessor.component_type == GLTF_COMPONENT_TYPE_BYTE || accessor.component_type == GLTF_COMPONENT_TYPE_SHORT))
+				{
+					for(size_t z=0; z<accessor.count; ++z)
+					{
+						Vec4f tangent_os;
+						readComponentsAsFloat(offset_base + byte_stride * z, accessor.component_type, /*normalised=*/true, /*num_components=*/4, tangent_os.x);
+
+						Vec4f tangent_ws = normalise(normal_transform * maskWToZero(tangent_os));
+				
 						tangent_ws[3] = tangent_os[3]; // Copy w component (sign)
 
 						const uint32 packed_tangent = batchedMeshPackNormalWithW(tangent_ws);
-						
+				
 						*(uint32*)(&mesh_out.vertex_data[(vert_write_i + z) * dest_vert_stride_B + dest_attr_offset_B]) = packed_tangent;
 					}
 				}
@@ -1158,20 +1480,52 @@ static void processNode(GLTFData& data, GLTFNode& node, size_t node_index, const
 				runtimeCheck(texcoord_0_attr.component_type == BatchedMesh::ComponentType_Float); // We store texcoords in float format for now.
 
 				// TEXCOORD_0 must be FLOAT, UNSIGNED_BYTE, or UNSIGNED_SHORT.
+				// KHR_mesh_quantization also allows BYTE and SHORT, and integer components that are not normalised.
+				// Integer components are always normalised in files not using KHR_mesh_quantization, so treat them as normalised even if the accessor doesn't say so.
+				const bool normalised = accessor.normalised || !data.mesh_quantization_used;
 				if(accessor.component_type == GLTF_COMPONENT_TYPE_FLOAT)
 				{
 					copyData<float, float, 2>(accessor.count, offset_base, byte_stride, mesh_out.vertex_data, vert_write_i, dest_vert_stride_B, dest_attr_offset_B, /*scale=*/1.f);
 				}
 				else if(accessor.component_type == GLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
 				{
-					copyData<uint8, float, 2>(accessor.count, offset_base, byte_stride, mesh_out.vertex_data, vert_write_i, dest_vert_stride_B, dest_attr_offset_B, /*scale=*/1.f / 255);
+					copyData<uint8, float, 2>(accessor.count, offset_base, byte_stride, mesh_out.vertex_data, vert_write_i, dest_vert_stride_B, dest_attr_offset_B, /*scale=*/normalised ? (1.f / 255) : 1.f);
 				}
 				else if(accessor.component_type == GLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
 				{
-					copyData<uint16, float, 2>(accessor.count, offset_base, byte_stride, mesh_out.vertex_data, vert_write_i, dest_vert_stride_B, dest_attr_offset_B, /*scale=*/1.f / 65535);
+					copyData<uint16, float, 2>(accessor.count, offset_base, byte_stride, mesh_out.vertex_data, vert_write_i, dest_vert_stride_B, dest_attr_offset_B, /*scale=*/normalised ? (1.f / 65535) : 1.f);
+				}
+				else if(data.mesh_quantization_used && (accessor.component_type == GLTF_COMPONENT_TYPE_BYTE || accessor.component_type == GLTF_COMPONENT_TYPE_SHORT))
+				{
+					for(size_t z=0; z<accessor.count; ++z)
+						readComponentsAsFloat(offset_base + byte_stride * z, accessor.component_type, normalised, /*num_components=*/2, 
+							(float*)&mesh_out.vertex_data[(vert_write_i + z) * dest_vert_stride_B + dest_attr_offset_B]);
 				}
 				else
 					throw glare::Exception("Invalid TEXCOORD_0 component type");
+
+				// Apply the material's KHR_texture_transform, if it has one.  gltfpack, for example, quantises UVs to integers over their bounds, and uses the transform
+				// offset and scale to map them back.
+				if(primitive.material < data.materials.size())
+				{
+					const GLTFTextureObject* transform_tex = getUVTransformTexture(*data.materials[primitive.material]);
+					if(transform_tex)
+					{
+						// uv' = offset + R * (scale * uv), where R rotates by the transform's rotation.  See the matrix in the KHR_texture_transform spec.
+						const Vec2f offset = transform_tex->offset;
+						const Vec2f scale = transform_tex->scale;
+						const float cos_r = std::cos(transform_tex->rotation);
+						const float sin_r = std::sin(transform_tex->rotation);
+						for(size_t z=0; z<accessor.count; ++z)
+						{
+							float* uv = (float*)&mesh_out.vertex_data[(vert_write_i + z) * dest_vert_stride_B + dest_attr_offset_B];
+							const float u = uv[0] * scale.x;
+							const float v = uv[1] * scale.y;
+							uv[0] = offset.x + cos_r * u + sin_r * v;
+							uv[1] = offset.y - sin_r * u + cos_r * v;
+						}
+					}
+				}
 			}
 			else
 			{
@@ -1314,11 +1668,71 @@ static void processNode(GLTFData& data, GLTFNode& node, size_t node_index, const
 					}
 				}
 			}
+		}
+		catch(glare::Exception& e)
+		{
+			prim.error = true;
+			prim.error_msg = e.what();
+		}
+	}
+}
 
-			vert_write_i += vert_pos_count;
 
-		} // End for each primitive batch
-	} // End if(node.mesh != std::numeric_limits<size_t>::max())
+// Walks the node hierarchy, adding a batch to mesh_out and an entry to primitives_out for each primitive to load, in file order.
+// Assigns each primitive its range of vertices and indices.
+static void processNode(GLTFData& data, GLTFNode& node, size_t node_index, const Matrix4f& parent_transform, BatchedMesh& mesh_out, std::vector<GLTFPrimitiveToLoad>& primitives_out,
+	size_t& vert_write_i, size_t& indices_write_i)
+{
+	const Matrix4f trans = Matrix4f::translationMatrix(node.translation.x, node.translation.y, node.translation.z);
+	const Matrix4f rot = normalise(node.rotation).toMatrix();
+	const Matrix4f scale = Matrix4f::scaleMatrix(node.scale.x, node.scale.y, node.scale.z);
+	const Matrix4f node_transform = parent_transform * node.matrix * trans * rot * scale; // Matrix and T,R,S transforms should be mutually exclusive in GLTF files.  Just multiply them together however.
+
+	// Process mesh
+	if(node.mesh != std::numeric_limits<size_t>::max())
+	{
+		GLTFMesh& mesh = getMesh(data, node.mesh);
+
+		for(size_t i=0; i<mesh.primitives.size(); ++i)
+		{
+			GLTFPrimitive& primitive = *mesh.primitives[i];
+
+			if(!shouldLoadPrimitive(primitive))
+				continue;
+
+
+			uint16 use_joint_index = 0;
+			if(!data.skins.empty() && (node.skin == std::numeric_limits<size_t>::max())) // If we have a skin, and if this is a mesh node that doesn't use a skin, then this node uses rigid-body animation.
+			{
+				// Use the skin-based animation system for it - add this node to the list of joints.
+				use_joint_index = (uint16)data.skins.back()->joints.size();
+				data.skins.back()->joints.push_back((int)node_index);
+			}
+
+			const size_t vert_pos_count = getAccessorForAttribute(data, primitive, "POSITION").count;
+			const size_t num_indices = (primitive.indices == std::numeric_limits<size_t>::max()) ? vert_pos_count : getAccessor(data, primitive.indices).count; // If there is no indices accessor, we will use one index per vertex.
+
+			BatchedMesh::IndicesBatch batch;
+			batch.indices_start = (uint32)indices_write_i;
+			batch.material_index = (uint32)primitive.material;
+			batch.num_indices = (uint32)num_indices;
+			mesh_out.batches.push_back(batch);
+
+			primitives_out.push_back(GLTFPrimitiveToLoad());
+			GLTFPrimitiveToLoad& prim = primitives_out.back();
+			prim.node_transform = node_transform;
+			prim.primitive = &primitive;
+			prim.use_joint_index = use_joint_index;
+			prim.vert_write_i = vert_write_i;
+			prim.indices_write_i = indices_write_i;
+			prim.num_verts = vert_pos_count;
+			prim.num_indices = num_indices;
+			prim.error = false;
+
+			vert_write_i += vert_pos_count;
+			indices_write_i += num_indices;
+		}
+	}
 
 
 	// Process child nodes
@@ -1329,8 +1743,69 @@ static void processNode(GLTFData& data, GLTFNode& node, size_t node_index, const
 
 		GLTFNode& child = *data.nodes[node.children[i]];
 
-		processNode(data, child, node.children[i], node_transform, mesh_out, uint32_indices_out, vert_write_i);
+		processNode(data, child, node.children[i], node_transform, mesh_out, primitives_out, vert_write_i, indices_write_i);
+	}
+}
+
+
+class LoadPrimitivesTask : public glare::Task
+{
+public:
+	virtual void run(size_t /*thread_index*/) override
+	{
+		loadPrimitiveRange(*data, *primitives, begin, end, *mesh, *uint32_indices);
+	}
+
+	GLTFData* data;
+	std::vector<GLTFPrimitiveToLoad>* primitives;
+	BatchedMesh* mesh;
+	js::Vector<uint32, 16>* uint32_indices;
+	size_t begin, end;
+};
+
+
+// Loads all primitives, in parallel if task_manager is non-null.
+static void loadPrimitives(GLTFData& data, std::vector<GLTFPrimitiveToLoad>& primitives, BatchedMesh& mesh_out, js::Vector<uint32, 16>& uint32_indices_out, glare::TaskManager* task_manager)
+{
+	if(task_manager && primitives.size() > 1)
+	{
+		// Group consecutive primitives into tasks with roughly equal numbers of vertices and indices, with a few tasks per thread.
+		// A single large primitive gets a task to itself.
+		size_t total_work = 0;
+		for(size_t i=0; i<primitives.size(); ++i)
+			total_work += primitives[i].num_verts + primitives[i].num_indices;
+		const size_t target_task_work = myMax<size_t>(1, total_work / (task_manager->getConcurrency() * 4));
+
+		glare::TaskGroupRef group = new glare::TaskGroup();
+		size_t task_begin = 0;
+		size_t task_work = 0;
+		for(size_t i=0; i<primitives.size(); ++i)
+		{
+			task_work += primitives[i].num_verts + primitives[i].num_indices;
+			if(task_work >= target_task_work || i + 1 == primitives.size())
+			{
+				Reference<LoadPrimitivesTask> task = new LoadPrimitivesTask();
+				task->data = &data;
+				task->primitives = &primitives;
+				task->mesh = &mesh_out;
+				task->uint32_indices = &uint32_indices_out;
+				task->begin = task_begin;
+				task->end = i + 1;
+				group->tasks.push_back(task);
+
+				task_begin = i + 1;
+				task_work = 0;
+			}
+		}
+		task_manager->runTaskGroup(group);
 	}
+	else
+		loadPrimitiveRange(data, primitives, /*begin=*/0, /*end=*/primitives.size(), mesh_out, uint32_indices_out);
+
+	// Report the error from the first primitive that failed, so the error doesn't depend on the order primitives were loaded in.
+	for(size_t i=0; i<primitives.size(); ++i)
+		if(primitives[i].error)
+			throw glare::Exception(primitives[i].error_msg);
 }
 
 
@@ -1344,8 +1819,23 @@ static std::string sanitiseString(const std::string& s)
 }
 
 
-// Returns path
-static std::string saveImageForMimeType(const std::string& image_name, const std::string& mime_type, const uint8* data, size_t data_size, bool write_images_to_disk)
+// An image embedded in the GLTF data, to be saved to disk so our image loaders can load it.
+struct GLTFImageToSave
+{
+	GLTFImageToSave() : data(NULL), data_size(0), error(false) {}
+
+	std::string path; // Empty if the image is not embedded.
+	const uint8* data;
+	size_t data_size;
+	std::vector<unsigned char> decoded_data; // Holds the decoded data for images with data URIs.
+
+	bool error;
+	std::string error_msg;
+};
+
+
+// Returns the temp path to save the image data to.
+static std::string getPathForImage(const std::string& image_name, const std::string& mime_type, const uint8* data, size_t data_size)
 {
 	// Work out extension to use - see https://developer.mozilla.org/en-US/docs/Web/HTTP/Basics_of_HTTP/MIME_types
 	std::string extension;
@@ -1376,23 +1866,25 @@ static std::string saveImageForMimeType(const std::string& image_name, const std
 	else
 		base_name = "GLB_image";
 
-	const std::string path = PlatformUtils::getTempDirPath() + "/" + base_name + "_" + toString(hash) + "." + extension;
+	return PlatformUtils::getTempDirPath() + "/" + base_name + "_" + toString(hash) + "." + extension;
+}
+
 
+static void saveImage(const GLTFImageToSave& image)
+{
 	try
 	{
-		if(write_images_to_disk)
-			FileUtils::writeEntireFile(path, (const char*)data, data_size);
+		FileUtils::writeEntireFile(image.path, (const char*)image.data, image.data_size);
 	}
 	catch(FileUtils::FileUtilsExcep& e)
 	{
 		throw glare::Exception("Error while writing temp image file: " + e.what());
 	}
-
-	return path;
 }
 
 
-static void processImage(GLTFData& data, GLTFImage& image, const std::string& gltf_folder, bool write_images_to_disk)
+// Updates the image URI of embedded images to the path they will be saved to, and sets image_to_save_out to the data to save there.
+static void processImage(GLTFData& data, GLTFImage& image, const std::string& gltf_folder, GLTFImageToSave& image_to_save_out)
 {
 	if(image.uri.empty())
 	{
@@ -1417,9 +1909,11 @@ static void processImage(GLTFData& data, GLTFImage& image, const std::string& gl
 		else
 			use_name = removeDotAndExtension(buffer_view.name); // Texture filenames seem to be stored in the buffer views sometimes.
 
-		const std::string path = saveImageForMimeType(use_name, image.mime_type, (const uint8*)buffer.binary_data + buffer_view.byte_offset, buffer_view.byte_length, write_images_to_disk);
+		image_to_save_out.data = (const uint8*)buffer.binary_data + buffer_view.byte_offset;
+		image_to_save_out.data_size = buffer_view.byte_length;
+		image_to_save_out.path = getPathForImage(use_name, image.mime_type, image_to_save_out.data, image_to_save_out.data_size);
 
-		image.uri = path; // Update GLTF image to use URI on disk
+		image.uri = image_to_save_out.path; // Update GLTF image to use URI on disk
 	}
 	else // else if !image.uri.empty():
 	{
@@ -1439,26 +1933,134 @@ static void processImage(GLTFData& data, GLTFImage& image, const std::string& gl
 				throw glare::Exception("Failed to parse base64 encoding type string from image URI");
 
 			const std::string data_base64(image.uri.begin() + parser.currentPos(), image.uri.end());
-			std::vector<unsigned char> decoded_data;
-			Base64::decode(data_base64, /*data out=*/decoded_data);
+			Base64::decode(data_base64, /*data out=*/image_to_save_out.decoded_data);
 
-			const std::string path = saveImageForMimeType(image.name, toString(mime_type), decoded_data.data(), decoded_data.size(), write_images_to_disk);
+			image_to_save_out.data = image_to_save_out.decoded_data.data();
+			image_to_save_out.data_size = image_to_save_out.decoded_data.size();
+			image_to_save_out.path = getPathForImage(image.name, toString(mime_type), image_to_save_out.data, image_to_save_out.data_size);
 			
-			image.uri = path; // Update GLTF image to use URI on disk
+			image.uri = image_to_save_out.path; // Update GLTF image to use URI on disk
 		}
 	}
 }
 
 
-static void processMaterial(GLTFData& data, GLTFMaterial& mat, const std::string& gltf_folder, GLTFResultMaterial& mat_out)
+class ProcessImageTask : public glare::Task
 {
-	mat_out.colour_factor = Colour3f(mat.baseColorFactor.x[0], mat.baseColorFactor.x[1], mat.baseColorFactor.x[2]);
-	mat_out.alpha = mat.baseColorFactor[3];
-	if(mat.baseColorTexture.valid())
+public:
+	virtual void run(size_t /*thread_index*/) override
 	{
-		GLTFTexture& texture = getTexture(data, mat.baseColorTexture.index);
-		GLTFImage& image = getImage(data, texture.source);
-		const std::string path = FileUtils::join(gltf_folder, image.uri);
+		try
+		{
+			processImage(*data, *image, *gltf_folder, *image_to_save);
+		}
+		catch(glare::Exception& e)
+		{
+			image_to_save->error = true;
+			image_to_save->error_msg = e.what();
+		}
+	}
+
+	GLTFData* data;
+	GLTFImage* image;
+	const std::string* gltf_folder;
+	GLTFImageToSave* image_to_save;
+};
+
+
+class SaveImageTask : public glare::Task
+{
+public:
+	virtual void run(size_t /*thread_index*/) override
+	{
+		try
+		{
+			saveImage(*image_to_save);
+		}
+		catch(glare::Exception& e)
+		{
+			image_to_save->error = true;
+			image_to_save->error_msg = e.what();
+		}
+	}
+
+	GLTFImageToSave* image_to_save;
+};
+
+
+// For any image embedded in the GLTF data, save it to disk in a temp location, and update the image URI to point to it.
+// Decoding data URIs and hashing the image data is done for all images first, then each distinct file is written.  Both steps are done
+// in parallel over the images if task_manager is non-null.
+static void processImages(GLTFData& data, const std::string& gltf_folder, bool write_images_to_disk, glare::TaskManager* task_manager)
+{
+	std::vector<GLTFImageToSave> images_to_save(data.images.size());
+
+	if(task_manager && data.images.size() > 1)
+	{
+		glare::TaskGroupRef group = new glare::TaskGroup();
+		for(size_t i=0; i<data.images.size(); ++i)
+		{
+			Reference<ProcessImageTask> task = new ProcessImageTask();
+			task->data = &data;
+			task->image = data.images[i].ptr();
+			task->gltf_folder = &gltf_folder;
+			task->image_to_save = &images_to_save[i];
+			group->tasks.push_back(task);
+		}
+		task_manager->runTaskGroup(group);
+
+		for(size_t i=0; i<images_to_save.size(); ++i)
+			if(images_to_save[i].error)
+				throw glare::Exception(images_to_save[i].error_msg);
+	}
+	else
+	{
+		for(size_t i=0; i<data.images.size(); ++i)
+			processImage(data, *data.images[i], gltf_folder, images_to_save[i]);
+	}
+
+	if(!write_images_to_disk)
+		return;
+
+	// Images with the same name and data have the same path, so only write each path once.
+	std::vector<GLTFImageToSave*> unique_images;
+	std::set<std::string> paths;
+	for(size_t i=0; i<images_to_save.size(); ++i)
+		if(!images_to_save[i].path.empty() && paths.insert(images_to_save[i].path).second)
+			unique_images.push_back(&images_to_save[i]);
+
+	if(task_manager && unique_images.size() > 1)
+	{
+		glare::TaskGroupRef group = new glare::TaskGroup();
+		for(size_t i=0; i<unique_images.size(); ++i)
+		{
+			Reference<SaveImageTask> task = new SaveImageTask();
+			task->image_to_save = unique_images[i];
+			group->tasks.push_back(task);
+		}
+		task_manager->runTaskGroup(group);
+
+		for(size_t i=0; i<unique_images.size(); ++i)
+			if(unique_images[i]->error)
+				throw glare::Exception(unique_images[i]->error_msg);
+	}
+	else
+	{
+		for(size_t i=0; i<unique_images.size(); ++i)
+			saveImage(*unique_images[i]);
+	}
+}
+
+
+static void processMaterial(GLTFData& data, GLTFMaterial& mat, const std::string& gltf_folder, GLTFResultMaterial& mat_out)
+{
+	mat_out.colour_factor = Colour3f(mat.baseColorFactor.x[0], mat.baseColorFactor.x[1], mat.baseColorFactor.x[2]);
+	mat_out.alpha = mat.baseColorFactor[3];
+	if(mat.baseColorTexture.valid())
+	{
+		GLTFTexture& texture = getTexture(data, mat.baseColorTexture.index);
+		GLTFImage& image = getImage(data, texture.source);
+		const std::string path = FileUtils::join(gltf_folder, image.uri);
 		mat_out.diffuse_map.path = path;
 	}
 	mat_out.roughness = mat.roughnessFactor;
@@ -1642,13 +2244,13 @@ static const uint32 CHUNK_TYPE_JSON = 0x4E4F534A;
 static const uint32 CHUNK_TYPE_BIN  = 0x004E4942;
 
 
-Reference<BatchedMesh> FormatDecoderGLTF::loadGLBFile(const std::string& pathname, GLTFLoadedData& data_out) // throws glare::Exception on failure
+Reference<BatchedMesh> FormatDecoderGLTF::loadGLBFile(const std::string& pathname, GLTFLoadedData& data_out, glare::TaskManager* task_manager) // throws glare::Exception on failure
 {
 	MemMappedFile file(pathname);
 
 	const std::string gltf_base_dir = FileUtils::getDirectory(pathname);
 
-	return loadGLBFileFromData(file.fileData(), file.fileSize(), gltf_base_dir, /*write_images_to_disk=*/true, data_out);
+	return loadGLBFileFromData(file.fileData(), file.fileSize(), gltf_base_dir, /*write_images_to_disk=*/true, data_out, task_manager);
 }
 
 
@@ -1657,7 +2259,8 @@ static_assert(sizeof(GLBChunkHeader) == 8, "sizeof(GLBChunkHeader) == 8");
 
 
 // Takes raw data pointer so we can use for fuzzing.
-Reference<BatchedMesh> FormatDecoderGLTF::loadGLBFileFromData(const void* file_data, const size_t file_size, const std::string& gltf_base_dir, bool write_images_to_disk, GLTFLoadedData& data_out)
+Reference<BatchedMesh> FormatDecoderGLTF::loadGLBFileFromData(const void* file_data, const size_t file_size, const std::string& gltf_base_dir, bool write_images_to_disk, GLTFLoadedData& data_out,
+	glare::TaskManager* task_manager)
 {
 	BufferViewInStream stream(ArrayRef<uint8>((const uint8*)file_data, file_size));
 
@@ -1733,31 +2336,32 @@ Reference<BatchedMesh> FormatDecoderGLTF::loadGLBFileFromData(const void* file_d
 	JSONParser parser;
 	parser.parseBuffer((const char*)file_data + 20, json_header.chunk_length);
 
-	return loadGivenJSON(parser, gltf_base_dir, buffer, write_images_to_disk, data_out);
+	return loadGivenJSON(parser, gltf_base_dir, buffer, write_images_to_disk, data_out, task_manager);
 }
 
 
-Reference<BatchedMesh> FormatDecoderGLTF::loadGLTFFile(const std::string& pathname, GLTFLoadedData& data_out)
+Reference<BatchedMesh> FormatDecoderGLTF::loadGLTFFile(const std::string& pathname, GLTFLoadedData& data_out, glare::TaskManager* task_manager)
 {
 	MemMappedFile file(pathname);
 
 	const std::string gltf_base_dir = FileUtils::getDirectory(pathname);
 
-	return loadGLTFFileFromData(file.fileData(), file.fileSize(), gltf_base_dir, /*write_images_to_disk=*/true, data_out);
+	return loadGLTFFileFromData(file.fileData(), file.fileSize(), gltf_base_dir, /*write_images_to_disk=*/true, data_out, task_manager);
 }
 
 
-Reference<BatchedMesh> FormatDecoderGLTF::loadGLTFFileFromData(const void* data, const size_t datalen, const std::string& gltf_base_dir, bool write_images_to_disk, GLTFLoadedData& data_out)
+Reference<BatchedMesh> FormatDecoderGLTF::loadGLTFFileFromData(const void* data, const size_t datalen, const std::string& gltf_base_dir, bool write_images_to_disk, GLTFLoadedData& data_out,
+	glare::TaskManager* task_manager)
 {
 	JSONParser parser;
 	parser.parseBuffer((const char*)data, datalen);
 
-	return loadGivenJSON(parser, gltf_base_dir, /*glb_bin_buffer=*/NULL, write_images_to_disk, data_out);
+	return loadGivenJSON(parser, gltf_base_dir, /*glb_bin_buffer=*/NULL, write_images_to_disk, data_out, task_manager);
 }
 
 
 Reference<BatchedMesh> FormatDecoderGLTF::loadGivenJSON(JSONParser& parser, const std::string gltf_base_dir, const GLTFBufferRef& glb_bin_buffer, bool write_images_to_disk,
-	GLTFLoadedData& data_out) // throws glare::Exception on failure
+	GLTFLoadedData& data_out, glare::TaskManager* task_manager) // throws glare::Exception on failure
 {
 	const JSONNode& root = parser.nodes[0];
 	checkNodeType(root, JSONNode::Type_Object);
@@ -1776,7 +2380,13 @@ Reference<BatchedMesh> FormatDecoderGLTF::loadGivenJSON(JSONParser& parser, cons
 				const JSONNode& buffer_node = parser.nodes[buffers_node_array.child_indices[z]];
 
 				GLTFBufferRef buffer = new GLTFBuffer();
-				if(buffer_node.hasChild("uri"))
+				if(buffer_node.hasChild("extensions") && buffer_node.getChildObject(parser, "extensions").hasChild("EXT_meshopt_compression") &&
+					buffer_node.getChildObject(parser, "extensions").getChildObject(parser, "EXT_meshopt_compression").getChildBoolValueWithDefaultVal(parser, "fallback", false))
+				{
+					// This buffer is only referenced by compressed buffer views, and may not have any data, so don't load it.
+					buffer->meshopt_fallback = true;
+				}
+				else if(buffer_node.hasChild("uri"))
 				{
 					buffer->uri = buffer_node.getChildStringValue(parser, "uri");
 
@@ -1827,6 +2437,23 @@ Reference<BatchedMesh> FormatDecoderGLTF::loadGivenJSON(JSONParser& parser, cons
 				view->byte_stride = view_node.getChildUIntValueWithDefaultVal(parser, "byteStride", 0);
 				view->name =		view_node.getChildStringValueWithDefaultVal(parser, "name", "");
 				view->target =		view_node.getChildUIntValueWithDefaultVal(parser, "target", 0);
+
+				if(view_node.hasChild("extensions"))
+				{
+					const JSONNode& extensions_node = view_node.getChildObject(parser, "extensions");
+					if(extensions_node.hasChild("EXT_meshopt_compression"))
+					{
+						const JSONNode& meshopt_node = extensions_node.getChildObject(parser, "EXT_meshopt_compression");
+						view->meshopt.present = true;
+						view->meshopt.buffer		= meshopt_node.getChildUIntValue(parser, "buffer");
+						view->meshopt.byte_offset	= meshopt_node.getChildUIntValueWithDefaultVal(parser, "byteOffset", 0);
+						view->meshopt.byte_length	= meshopt_node.getChildUIntValue(parser, "byteLength");
+						view->meshopt.byte_stride	= meshopt_node.getChildUIntValue(parser, "byteStride");
+						view->meshopt.count			= meshopt_node.getChildUIntValue(parser, "count");
+						view->meshopt.mode			= meshopt_node.getChildStringValue(parser, "mode");
+						view->meshopt.filter		= meshopt_node.getChildStringValueWithDefaultVal(parser, "filter", "NONE");
+					}
+				}
 				data.buffer_views.push_back(view);
 			}
 		}
@@ -1849,6 +2476,7 @@ Reference<BatchedMesh> FormatDecoderGLTF::loadGivenJSON(JSONParser& parser, cons
 				accessor->component_type	= accessor_node.getChildUIntValue(parser, "componentType");
 				accessor->count				= accessor_node.getChildUIntValue(parser, "count");
 				accessor->type				= accessor_node.getChildStringValue(parser, "type");
+				accessor->normalised		= accessor_node.getChildBoolValueWithDefaultVal(parser, "normalized", false);
 				data.accessors.push_back(accessor);
 			}
 		}
@@ -2288,13 +2916,25 @@ Reference<BatchedMesh> FormatDecoderGLTF::loadGivenJSON(JSONParser& parser, cons
 			{
 				const std::string& extension = parser.nodes[extensions_node.child_indices[z]].getStringValue();
 
-				if(extension == "KHR_materials_pbrSpecularGlossiness")
+				if(extension == "KHR_materials_pbrSpecularGlossiness" || extension == "KHR_mesh_quantization" || extension == "EXT_meshopt_compression" || extension == "KHR_texture_transform")
 				{}
 				else
 					throw glare::Exception("Unsupported extension that file requires: '" + extension + "'");
 			}
 		}
 
+	// Load extensionsUsed.  (Any extension in extensionsRequired must also be in extensionsUsed)
+	for(size_t i=0; i<root.name_val_pairs.size(); ++i)
+		if(root.name_val_pairs[i].name == "extensionsUsed")
+		{
+			const JSONNode& extensions_node = parser.nodes[root.name_val_pairs[i].value_node_index];
+			checkNodeType(extensions_node, JSONNode::Type_Array);
+
+			for(size_t z=0; z<extensions_node.child_indices.size(); ++z)
+				if(parser.nodes[extensions_node.child_indices[z]].getStringValue() == "KHR_mesh_quantization")
+					data.mesh_quantization_used = true;
+		}
+
 
 
 	//======================== Process GLTF data ================================
@@ -2322,7 +2962,7 @@ Reference<BatchedMesh> FormatDecoderGLTF::loadGivenJSON(JSONParser& parser, cons
 	// Load all unloaded buffers
 	for(size_t i=0; i<data.buffers.size(); ++i)
 	{
-		if(data.buffers[i]->binary_data == NULL)
+		if(data.buffers[i]->binary_data == NULL && !data.buffers[i]->meshopt_fallback)
 		{
 			const std::string path = gltf_base_dir + "/" + data.buffers[i]->uri;
 			data.buffers[i]->file = new MemMappedFile(path);
@@ -2331,6 +2971,9 @@ Reference<BatchedMesh> FormatDecoderGLTF::loadGivenJSON(JSONParser& parser, cons
 		}
 	}
 
+	// Decode any buffer views compressed with EXT_meshopt_compression.
+	decodeMeshoptBufferViews(data, task_manager);
+
 
 	// Process meshes to get the set of attributes used
 	for(size_t i=0; i<data.meshes.size(); ++i)
@@ -2436,12 +3079,14 @@ Reference<BatchedMesh> FormatDecoderGLTF::loadGivenJSON(JSONParser& parser, cons
 	assert(batched_mesh->vertexSize() % 4 == 0); // All attributes we choose above currently have a length of a multiple of 4 bytes.
 
 
+	// The vertex data and indices are sized for all primitives up front, and each primitive is written straight into its own range of them.
 	batched_mesh->vertex_data.resize(batched_mesh->vertexSize() * total_num_verts);
 
-	js::Vector<uint32, 16> uint32_indices;
-	uint32_indices.reserve(total_num_indices);
+	js::Vector<uint32, 16> uint32_indices(total_num_indices);
 	size_t vert_write_i = 0;
+	size_t indices_write_i = 0;
 
+	std::vector<GLTFPrimitiveToLoad> primitives;
 	for(size_t i=0; i<scene_node.nodes.size(); ++i)
 	{
 		if(scene_node.nodes[i] >= data.nodes.size())
@@ -2450,44 +3095,29 @@ Reference<BatchedMesh> FormatDecoderGLTF::loadGivenJSON(JSONParser& parser, cons
 
 		Matrix4f current_transform = Matrix4f::identity();
 
-		processNode(data, root_node, scene_node.nodes[i], current_transform, *batched_mesh, uint32_indices, vert_write_i);
+		processNode(data, root_node, scene_node.nodes[i], current_transform, *batched_mesh, primitives, vert_write_i, indices_write_i);
 	}
 
-	assert(uint32_indices.size() == total_num_indices);
-	assert(vert_write_i == total_num_verts);
+	runtimeCheck(indices_write_i == total_num_indices);
+	runtimeCheck(vert_write_i == total_num_verts);
+
+	loadPrimitives(data, primitives, *batched_mesh, uint32_indices, task_manager);
 
 
 	batched_mesh->setIndexDataFromIndices(uint32_indices, total_num_verts);
 
-	// Compute AABB
-	// Assuming we are storing float vert positions here.
+	// Compute AABB from the bounds of the primitives, which were computed from the vertex positions as they were written.
 	// We could also read the bounds from the GLTF file, but they may be incorrect.
 	{
 		js::AABBox aabb = js::AABBox::emptyAABBox();
-		const size_t vert_size_B = batched_mesh->vertexSize();
-		const BatchedMesh::VertAttribute& pos_attr = batched_mesh->getAttribute(BatchedMesh::VertAttribute_Position);
-		runtimeCheck(pos_attr.component_type == BatchedMesh::ComponentType_Float);
-		runtimeCheck(vert_size_B % 4 == 0); // Check alignment
-		runtimeCheck(pos_attr.offset_B % 4 == 0); // Check alignment
-
-		for(size_t v=0; v<total_num_verts; ++v)
-		{
-			const Vec4f vert_pos(
-				((float*)&batched_mesh->vertex_data[v * vert_size_B + pos_attr.offset_B])[0],
-				((float*)&batched_mesh->vertex_data[v * vert_size_B + pos_attr.offset_B])[1],
-				((float*)&batched_mesh->vertex_data[v * vert_size_B + pos_attr.offset_B])[2],
-				1);
-			aabb.enlargeToHoldPoint(vert_pos);
-		}
+		for(size_t i=0; i<primitives.size(); ++i)
+			aabb.enlargeToHoldAABBox(primitives[i].aabb);
 		batched_mesh->aabb_os = aabb;
 	}
 
 
 	// Process images - for any image embedded in the GLB file data, save onto disk in a temp location
-	for(size_t i=0; i<data.images.size(); ++i)
-	{
-		processImage(data, *data.images[i], gltf_base_dir, write_images_to_disk);
-	}
+	processImages(data, gltf_base_dir, write_images_to_disk, task_manager);
 
 	// Process materials
 	data_out.materials.materials.resize(data.materials.size());
@@ -2746,17 +3376,115 @@ static int gltfComponentType(BatchedMesh::ComponentType t)
 };
 
 
-void FormatDecoderGLTF::makeGLTFJSONAndBin(const BatchedMesh& mesh, const std::string& bin_path, std::string& json_out, js::Vector<uint8, 16>& bin_out)
+// Returns true if all components of a float vertex attribute are in [0, 1], so can be stored as normalised unsigned integers.
+static bool attributeInUnitRange(const BatchedMesh& mesh, const BatchedMesh::VertAttribute& attr, size_t num_components)
+{
+	if(attr.component_type != BatchedMesh::ComponentType_Float)
+		return false;
+
+	const size_t mesh_vert_size = mesh.vertexSize();
+	const size_t num_verts = mesh.numVerts();
+	for(size_t i=0; i<num_verts; ++i)
+	{
+		float v[4];
+		std::memcpy(v, &mesh.vertex_data[mesh_vert_size * i + attr.offset_B], sizeof(float) * num_components);
+		for(size_t c=0; c<num_components; ++c)
+			if(!(v[c] >= 0.f && v[c] <= 1.f))
+				return false;
+	}
+	return true;
+}
+
+
+// Writes a unit-range float vertex attribute as normalised uint16s.
+static void writeUnitRangeAttributeAsUInt16(const uint8* src, size_t num_components, uint8* dest)
 {
+	uint16 q[4];
+	for(size_t c=0; c<num_components; ++c)
+	{
+		float v;
+		std::memcpy(&v, src + sizeof(float) * c, sizeof(float));
+		q[c] = (uint16)meshopt_quantizeUnorm(v, 16);
+	}
+	std::memcpy(dest, q, sizeof(uint16) * num_components);
+}
+
+
+void FormatDecoderGLTF::makeGLTFJSONAndBin(const BatchedMesh& mesh, const std::string& bin_path, const GLTFWriteOptions& options, std::string& json_out, js::Vector<uint8, 16>& bin_out)
+{
+	const BatchedMesh::VertAttribute* pos_attr = mesh.findAttribute(BatchedMesh::VertAttribute_Position);
+	const BatchedMesh::VertAttribute* normal_attr = mesh.findAttribute(BatchedMesh::VertAttribute_Normal);
+	const BatchedMesh::VertAttribute* colour_attr = mesh.findAttribute(BatchedMesh::VertAttribute_Colour);
+	const BatchedMesh::VertAttribute* uv0_attr = mesh.findAttribute(BatchedMesh::VertAttribute_UV_0);
+	const BatchedMesh::VertAttribute* uv1_attr = mesh.findAttribute(BatchedMesh::VertAttribute_UV_1);
+
+	if(!pos_attr)
+		throw glare::Exception("pos_attr was missing.");
+	if(pos_attr->component_type != BatchedMesh::ComponentType_Float)
+		throw glare::Exception("Unhandled pos component type: " + toString((int)pos_attr->component_type));
+
+	const size_t mesh_vert_size = mesh.vertexSize();
+	const size_t num_verts = mesh.numVerts();
+	const size_t num_indices = mesh.numIndices();
+
+	// With quantise_attributes (KHR_mesh_quantization), positions are stored as uint16s on a grid over the bounds of the positions, and the node transform maps
+	// them back to the original positions.  The grid spacing is the same along each axis, so the node transform has a uniform scale and doesn't change normals.
+	// Normals are stored as normalised int8s.  Colours and UVs are stored as normalised uint16s if they are all in [0, 1], otherwise as floats.
+	const bool quantise = options.quantise_attributes;
+	const bool quantise_colour = quantise && colour_attr && attributeInUnitRange(mesh, *colour_attr, 3);
+	const bool quantise_uv0 = quantise && uv0_attr && attributeInUnitRange(mesh, *uv0_attr, 2);
+	const bool quantise_uv1 = quantise && uv1_attr && attributeInUnitRange(mesh, *uv1_attr, 2);
+
+	Vec3f pos_min(0.f);
+	float pos_step = 1.f;
+	if(quantise && num_verts > 0)
+	{
+		js::AABBox pos_aabb = js::AABBox::emptyAABBox();
+		for(size_t i=0; i<num_verts; ++i)
+		{
+			Vec3f p;
+			std::memcpy(&p, &mesh.vertex_data[mesh_vert_size * i + pos_attr->offset_B], sizeof(Vec3f));
+			pos_aabb.enlargeToHoldPoint(Vec4f(p.x, p.y, p.z, 1));
+		}
+		pos_min = Vec3f(pos_aabb.min_[0], pos_aabb.min_[1], pos_aabb.min_[2]);
+		const float max_extent = pos_aabb.axisLength(pos_aabb.longestAxis());
+		if(max_extent > 0)
+			pos_step = max_extent / 65535;
+	}
+	const float recip_pos_step = 1 / pos_step;
+
+	// The node transform dequantises positions.
+	const std::string node_transform_json = quantise ?
+		(",\n"
+		"		\"translation\": [" + formatDouble(pos_min.x) + ", " + formatDouble(pos_min.y) + ", " + formatDouble(pos_min.z) + "],\n"
+		"		\"scale\": [" + formatDouble(pos_step) + ", " + formatDouble(pos_step) + ", " + formatDouble(pos_step) + "]\n") :
+		"\n";
+
+	std::string extensions;
+	if(quantise)
+		extensions += "\"KHR_mesh_quantization\"";
+	if(options.use_meshopt_compression)
+		extensions += std::string(extensions.empty() ? "" : ", ") + "\"EXT_meshopt_compression\"";
+
 	json_out = 
 		"{\n"
 		"\"asset\": {\n"
 		"	\"generator\": \"Glare Technologies GLTF Writer\",\n"
 		"	\"version\": \"2.0\"\n"
-		"},\n"
+		"},\n";
+
+	if(!extensions.empty())
+	{
+		// We don't write uncompressed fallback data or unquantised attributes, so the extensions are required.
+		json_out +=
+			"\"extensionsUsed\": [" + extensions + "],\n"
+			"\"extensionsRequired\": [" + extensions + "],\n";
+	}
+
+	json_out +=
 		"\"nodes\": [\n"
 		"	{\n"
-		"		\"mesh\": 0\n"
+		"		\"mesh\": 0" + node_transform_json +
 		"	}\n"
 		"],\n"
 		"\"scenes\": [\n"
@@ -2770,173 +3498,292 @@ void FormatDecoderGLTF::makeGLTFJSONAndBin(const BatchedMesh& mesh, const std::s
 		"\"scene\": 0,\n";
 
 
-	// Compute new vert size, putting data in GLTF compatible format
-
-	const BatchedMesh::VertAttribute* pos_attr = mesh.findAttribute(BatchedMesh::VertAttribute_Position);
-	const BatchedMesh::VertAttribute* normal_attr = mesh.findAttribute(BatchedMesh::VertAttribute_Normal);
-	const BatchedMesh::VertAttribute* colour_attr = mesh.findAttribute(BatchedMesh::VertAttribute_Colour);
-	const BatchedMesh::VertAttribute* uv0_attr = mesh.findAttribute(BatchedMesh::VertAttribute_UV_0);
-	const BatchedMesh::VertAttribute* uv1_attr = mesh.findAttribute(BatchedMesh::VertAttribute_UV_1);
-
-	if(!pos_attr)
-		throw glare::Exception("pos_attr was missing.");
+	// Compute new vert size, putting data in GLTF compatible format.
+	// Quantised attributes are padded so each attribute starts at a multiple of 4 bytes, as required for vertex attributes.
 
-	size_t dest_vert_size = sizeof(Vec3f); // position
+	const size_t pos_size = quantise ? sizeof(uint16) * 4 : sizeof(Vec3f);
+	size_t dest_vert_size = pos_size; // position
 	int normal_offset = -1;
 	if(normal_attr)
 	{
 		normal_offset = (int)dest_vert_size;
-		dest_vert_size += sizeof(Vec3f);
+		dest_vert_size += quantise ? sizeof(int8) * 4 : sizeof(Vec3f);
 	};
 	int colour_offset = -1;
 	if(colour_attr)
 	{
 		colour_offset = (int)dest_vert_size;
-		dest_vert_size += sizeof(Vec3f);
+		dest_vert_size += quantise_colour ? sizeof(uint16) * 4 : sizeof(Vec3f);
 	};
 	int uv0_offset = -1;
 	if(uv0_attr)
 	{
 		uv0_offset = (int)dest_vert_size;
-		dest_vert_size += sizeof(float) * 2;
+		dest_vert_size += quantise_uv0 ? sizeof(uint16) * 2 : sizeof(float) * 2;
 	};
 	int uv1_offset = -1;
 	if(uv1_attr)
 	{
 		uv1_offset = (int)dest_vert_size;
-		dest_vert_size += sizeof(float) * 2;
+		dest_vert_size += quantise_uv1 ? sizeof(uint16) * 2 : sizeof(float) * 2;
 	};
 
-	const size_t mesh_vert_size = mesh.vertexSize();
-	const size_t num_verts = mesh.numVerts();
 	const size_t total_vert_data_size = num_verts * dest_vert_size;
 
+	// meshopt index compression only handles 16 and 32 bit indices.
+	const BatchedMesh::ComponentType index_type = (options.use_meshopt_compression && mesh.index_type == BatchedMesh::ComponentType_UInt8) ? BatchedMesh::ComponentType_UInt16 : mesh.index_type;
+	const size_t index_type_size = BatchedMesh::componentTypeSize(index_type);
+
 	// The vertex data needs to be 4-byte aligned, so pad the index data.
-	const size_t tri_index_data_size = mesh.index_data.size();
+	const size_t tri_index_data_size = num_indices * index_type_size;
 	const size_t padded_tri_index_data_size = Maths::roundUpToMultipleOfPowerOf2<size_t>(tri_index_data_size, 4);
 	const size_t tri_index_padding_bytes = padded_tri_index_data_size - tri_index_data_size;
 	assert(tri_index_padding_bytes < 4);
 
-	// Build and then write data binary (.bin) file.
-	js::Vector<uint8, 16>& data = bin_out;
+	// Build the uncompressed data.  If we are using meshopt compression this is only used as the source for the compressed data, otherwise it is the data binary (.bin) file.
+	js::Vector<uint8, 16> uncompressed_data;
+	js::Vector<uint8, 16>& data = options.use_meshopt_compression ? uncompressed_data : bin_out;
 	data.resize(padded_tri_index_data_size + total_vert_data_size);
 
-	std::memcpy(data.data(), mesh.index_data.data(), mesh.index_data.size()); // Copy vert indices
+	if(index_type == mesh.index_type)
+		std::memcpy(data.data(), mesh.index_data.data(), mesh.index_data.size()); // Copy vert indices
+	else
+	{
+		assert(mesh.index_type == BatchedMesh::ComponentType_UInt8 && index_type == BatchedMesh::ComponentType_UInt16);
+		for(size_t i=0; i<num_indices; ++i)
+		{
+			const uint16 index = mesh.index_data[i];
+			std::memcpy(&data[i * sizeof(uint16)], &index, sizeof(uint16));
+		}
+	}
 
 	// Zero out padding if present
 	if(tri_index_padding_bytes > 0)
 		std::memset(&data[tri_index_data_size], 0, tri_index_padding_bytes);
 
-	float* write_pos = (float*)(data.data() + padded_tri_index_data_size);
+	int quantised_pos_min[3] = { 65535, 65535, 65535 };
+	int quantised_pos_max[3] = { 0, 0, 0 };
+
+	uint8* write_pos = data.data() + padded_tri_index_data_size;
 	for(size_t i=0; i<num_verts; ++i)
 	{
-		//float* write_pos = (float*)(data.data() + padded_tri_index_data_size + dest_vert_size * i);
+		const uint8* const src_vert = &mesh.vertex_data[mesh_vert_size * i];
 
-		if(pos_attr->component_type == BatchedMesh::ComponentType_Float)
+		if(quantise)
 		{
-			std::memcpy(write_pos, &mesh.vertex_data[mesh_vert_size * i], sizeof(Indigo::Vec3f)); // Copy vert position
-			write_pos += 3;
+			float p[3];
+			std::memcpy(p, src_vert + pos_attr->offset_B, sizeof(float) * 3);
+			uint16 q[4] = { 0, 0, 0, 0 };
+			for(int c=0; c<3; ++c)
+			{
+				const int q_c = myClamp((int)((p[c] - pos_min[c]) * recip_pos_step + 0.5f), 0, 65535);
+				q[c] = (uint16)q_c;
+				quantised_pos_min[c] = myMin(quantised_pos_min[c], q_c);
+				quantised_pos_max[c] = myMax(quantised_pos_max[c], q_c);
+			}
+			std::memcpy(write_pos, q, sizeof(uint16) * 4);
 		}
 		else
-			throw glare::Exception("Unhandled pos component type: " + toString((int)pos_attr->component_type));
+			std::memcpy(write_pos, src_vert + pos_attr->offset_B, sizeof(Indigo::Vec3f)); // Copy vert position
+		write_pos += pos_size;
 
 		if(normal_attr)
 		{
+			Vec4f vert_normal;
 			if(normal_attr->component_type == BatchedMesh::ComponentType_Float)
 			{
-				std::memcpy(write_pos, &mesh.vertex_data[mesh_vert_size * i + normal_attr->offset_B], sizeof(Indigo::Vec3f)); // Copy vert position
-				write_pos += 3;
+				std::memcpy(vert_normal.x, src_vert + normal_attr->offset_B, sizeof(Indigo::Vec3f));
 			}
 			else if(normal_attr->component_type == BatchedMesh::ComponentType_PackedNormal)
 			{
 				uint32 packed_normal;
-				std::memcpy(&packed_normal, &mesh.vertex_data[mesh_vert_size * i + normal_attr->offset_B], sizeof(uint32));
-				const Vec4f vert_normal = batchedMeshUnpackNormal(packed_normal);
-				std::memcpy(write_pos, vert_normal.x, sizeof(Indigo::Vec3f)); // Copy vert normal
-				write_pos += 3;
+				std::memcpy(&packed_normal, src_vert + normal_attr->offset_B, sizeof(uint32));
+				vert_normal = batchedMeshUnpackNormal(packed_normal);
 			}
 			else
 				throw glare::Exception("Unhandled normal component type: " + toString((int)normal_attr->component_type));
+
+			if(quantise)
+			{
+				const int8 q[4] = { (int8)meshopt_quantizeSnorm(vert_normal[0], 8), (int8)meshopt_quantizeSnorm(vert_normal[1], 8), (int8)meshopt_quantizeSnorm(vert_normal[2], 8), 0 };
+				std::memcpy(write_pos, q, sizeof(int8) * 4);
+				write_pos += sizeof(int8) * 4;
+			}
+			else
+			{
+				std::memcpy(write_pos, vert_normal.x, sizeof(Indigo::Vec3f)); // Copy vert normal
+				write_pos += sizeof(Indigo::Vec3f);
+			}
 		}
 
 		if(colour_attr)
 		{
-			if(colour_attr->component_type == BatchedMesh::ComponentType_Float)
+			if(colour_attr->component_type != BatchedMesh::ComponentType_Float)
+				throw glare::Exception("Unhandled colour component type: " + toString((int)colour_attr->component_type));
+
+			if(quantise_colour)
 			{
-				std::memcpy(write_pos, &mesh.vertex_data[mesh_vert_size * i + colour_attr->offset_B], sizeof(Indigo::Vec3f)); // Copy vert colour
-				write_pos += 3;
+				std::memset(write_pos, 0, sizeof(uint16) * 4);
+				writeUnitRangeAttributeAsUInt16(src_vert + colour_attr->offset_B, 3, write_pos);
+				write_pos += sizeof(uint16) * 4;
 			}
 			else
-				throw glare::Exception("Unhandled colour component type: " + toString((int)colour_attr->component_type));
+			{
+				std::memcpy(write_pos, src_vert + colour_attr->offset_B, sizeof(Indigo::Vec3f)); // Copy vert colour
+				write_pos += sizeof(Indigo::Vec3f);
+			}
 		}
 
 		if(uv0_attr)
 		{
-			if(uv0_attr->component_type == BatchedMesh::ComponentType_Float)
+			if(uv0_attr->component_type != BatchedMesh::ComponentType_Float)
+				throw glare::Exception("Unhandled uv0 component type: " + toString((int)uv0_attr->component_type));
+
+			if(quantise_uv0)
 			{
-				std::memcpy(write_pos, &mesh.vertex_data[mesh_vert_size * i + uv0_attr->offset_B], sizeof(Indigo::Vec2f)); // Copy vert UV
-				write_pos += 2;
+				writeUnitRangeAttributeAsUInt16(src_vert + uv0_attr->offset_B, 2, write_pos);
+				write_pos += sizeof(uint16) * 2;
 			}
 			else
-				throw glare::Exception("Unhandled uv0 component type: " + toString((int)uv0_attr->component_type));
+			{
+				std::memcpy(write_pos, src_vert + uv0_attr->offset_B, sizeof(Indigo::Vec2f)); // Copy vert UV
+				write_pos += sizeof(Indigo::Vec2f);
+			}
 		}
 
 		if(uv1_attr)
 		{
-			if(uv1_attr->component_type == BatchedMesh::ComponentType_Float)
+			if(uv1_attr->component_type != BatchedMesh::ComponentType_Float)
+				throw glare::Exception("Unhandled uv1 component type: " + toString((int)uv1_attr->component_type));
+
+			if(quantise_uv1)
 			{
-				std::memcpy(write_pos, &mesh.vertex_data[mesh_vert_size * i + uv1_attr->offset_B], sizeof(Indigo::Vec2f)); // Copy vert UV
-				write_pos += 2;
+				writeUnitRangeAttributeAsUInt16(src_vert + uv1_attr->offset_B, 2, write_pos);
+				write_pos += sizeof(uint16) * 2;
 			}
 			else
-				throw glare::Exception("Unhandled uv0 component type: " + toString((int)uv1_attr->component_type));
+			{
+				std::memcpy(write_pos, src_vert + uv1_attr->offset_B, sizeof(Indigo::Vec2f)); // Copy vert UV
+				write_pos += sizeof(Indigo::Vec2f);
+			}
 		}
 	}
-	assert(write_pos == (float*)(data.data() + padded_tri_index_data_size + dest_vert_size * num_verts));
+	assert(write_pos == data.data() + padded_tri_index_data_size + dest_vert_size * num_verts);
 
 
-	if(bin_path.empty())
+	// Encode the index and vertex data with meshopt (EXT_meshopt_compression).  The compressed data is the data binary file, and the uncompressed data
+	// is described by a fallback buffer, which isn't stored.
+	size_t compressed_index_data_size = 0;
+	size_t compressed_vert_data_offset = 0;
+	size_t compressed_vert_data_size = 0;
+	if(options.use_meshopt_compression)
 	{
-		json_out +=
-			"\"buffers\": [\n"
-			"	{\n"
-			"		\"byteLength\": " + toString(data.size()) + "\n"
-			"	}\n"
-			"],\n";
+		// The indices of all batches are encoded together, as one triangle list.
+		js::Vector<uint32, 16> uint32_indices(num_indices);
+		for(size_t i=0; i<num_indices; ++i)
+		{
+			if(index_type == BatchedMesh::ComponentType_UInt16)
+			{
+				uint16 index;
+				std::memcpy(&index, &data[i * sizeof(uint16)], sizeof(uint16));
+				uint32_indices[i] = index;
+			}
+			else
+				std::memcpy(&uint32_indices[i], &data[i * sizeof(uint32)], sizeof(uint32));
+		}
+
+		if(num_indices % 3 != 0)
+			throw glare::Exception("Number of indices must be a multiple of 3 for meshopt compression.");
+
+		meshopt_encodeIndexVersion(1);
+		bin_out.resize(meshopt_encodeIndexBufferBound(num_indices, num_verts));
+		compressed_index_data_size = meshopt_encodeIndexBuffer(bin_out.data(), bin_out.size(), uint32_indices.data(), num_indices);
+		if(compressed_index_data_size == 0)
+			throw glare::Exception("meshopt_encodeIndexBuffer failed.");
+
+		// The compressed vertex data doesn't need to be aligned, but align it anyway.
+		compressed_vert_data_offset = Maths::roundUpToMultipleOfPowerOf2<size_t>(compressed_index_data_size, 4);
+		const size_t vert_data_bound = meshopt_encodeVertexBufferBound(num_verts, dest_vert_size);
+		bin_out.resize(compressed_vert_data_offset + vert_data_bound);
+		std::memset(&bin_out[compressed_index_data_size], 0, compressed_vert_data_offset - compressed_index_data_size); // Zero out padding
+
+		// EXT_meshopt_compression only allows version 0 of the vertex encoding.
+		compressed_vert_data_size = meshopt_encodeVertexBufferLevel(&bin_out[compressed_vert_data_offset], vert_data_bound, &data[padded_tri_index_data_size], num_verts, dest_vert_size,
+			/*compression level=*/2, /*vertex version=*/0);
+		if(compressed_vert_data_size == 0)
+			throw glare::Exception("meshopt_encodeVertexBufferLevel failed.");
+		bin_out.resize(compressed_vert_data_offset + compressed_vert_data_size);
 	}
-	else
-	{
-		const std::string bin_filename = FileUtils::getFilename(bin_path);
 
-		// Write buffer element
-		// See https://github.com/KhronosGroup/glTF/tree/master/specification/2.0#binary-data-storage
-		json_out +=
+
+	// Write buffer element
+	// See https://github.com/KhronosGroup/glTF/tree/master/specification/2.0#binary-data-storage
+	json_out +=
 		"\"buffers\": [\n"
 		"	{\n"
+		"		\"byteLength\": " + toString(bin_out.size()) + (bin_path.empty() ? "" : ",\n"
+		"		\"uri\": \"" + FileUtils::getFilename(bin_path) + "\"") + "\n"
+		"	}\n";
+
+	if(options.use_meshopt_compression)
+	{
+		json_out +=
+		"	,{\n" // Fallback buffer, for the uncompressed data
 		"		\"byteLength\": " + toString(data.size()) + ",\n"
-		"		\"uri\": \"" + bin_filename + "\"\n"
-		"	}\n"
-		"],\n";
+		"		\"extensions\": {\n"
+		"			\"EXT_meshopt_compression\": {\n"
+		"				\"fallback\": true\n"
+		"			}\n"
+		"		}\n"
+		"	}\n";
 	}
+	json_out += "],\n";
 
+	const std::string uncompressed_buffer = options.use_meshopt_compression ? "1" : "0";
 
 	// Write bufferViews
 	json_out += "\"bufferViews\": [\n";
 
 	json_out +=
 	"	{\n" // Buffer view for triangle vert indices (for all chunks)
-	"		\"buffer\": 0,\n"
+	"		\"buffer\": " + uncompressed_buffer + ",\n"
 	"		\"byteLength\": " + toString(tri_index_data_size) + ",\n"
-	"		\"byteOffset\": 0,\n"
+	"		\"byteOffset\": 0,\n";
+	if(options.use_meshopt_compression)
+		json_out +=
+		"		\"extensions\": {\n"
+		"			\"EXT_meshopt_compression\": {\n"
+		"				\"buffer\": 0,\n"
+		"				\"byteOffset\": 0,\n"
+		"				\"byteLength\": " + toString(compressed_index_data_size) + ",\n"
+		"				\"byteStride\": " + toString(index_type_size) + ",\n"
+		"				\"count\": " + toString(num_indices) + ",\n"
+		"				\"mode\": \"TRIANGLES\"\n"
+		"			}\n"
+		"		},\n";
+	json_out +=
 	"		\"target\": 34963\n" // 34963 = ELEMENT_ARRAY_BUFFER
 	"	},\n";
 	
 	json_out +=
 	"	{\n" // Buffer view for vertex data
-	"		\"buffer\": 0,\n"
+	"		\"buffer\": " + uncompressed_buffer + ",\n"
 	"		\"byteLength\": " + toString(total_vert_data_size) + ",\n"
 	"		\"byteOffset\": " + toString(padded_tri_index_data_size) + ",\n"
-	"		\"byteStride\": " + toString(dest_vert_size) + ",\n"
+	"		\"byteStride\": " + toString(dest_vert_size) + ",\n";
+	if(options.use_meshopt_compression)
+		json_out +=
+		"		\"extensions\": {\n"
+		"			\"EXT_meshopt_compression\": {\n"
+		"				\"buffer\": 0,\n"
+		"				\"byteOffset\": " + toString(compressed_vert_data_offset) + ",\n"
+		"				\"byteLength\": " + toString(compressed_vert_data_size) + ",\n"
+		"				\"byteStride\": " + toString(dest_vert_size) + ",\n"
+		"				\"count\": " + toString(num_verts) + ",\n"
+		"				\"mode\": \"ATTRIBUTES\"\n"
+		"			}\n"
+		"		},\n";
+	json_out +=
 	"		\"target\": 34962\n" // 34962 = ARRAY_BUFFER
 	"	}\n"
 	"],\n";
@@ -2944,8 +3791,6 @@ void FormatDecoderGLTF::makeGLTFJSONAndBin(const BatchedMesh& mesh, const std::s
 	// Write accessors
 	json_out += "\"accessors\": [\n";
 
-	const size_t index_type_size = BatchedMesh::componentTypeSize(mesh.index_type);
-
 	for(size_t i=0; i<mesh.batches.size(); ++i)
 	{
 		const BatchedMesh::IndicesBatch& batch = mesh.batches[i];
@@ -2955,7 +3800,7 @@ void FormatDecoderGLTF::makeGLTFJSONAndBin(const BatchedMesh& mesh, const std::s
 			"	" + ((i > 0) ? std::string(",") : std::string(""))  + "{\n"
 			"		\"bufferView\": 0,\n" // buffer view 0 is the index buffer view
 			"		\"byteOffset\": " + toString(batch.indices_start * index_type_size) + ",\n"
-			"		\"componentType\": " + toString(gltfComponentType(mesh.index_type)) + ",\n"
+			"		\"componentType\": " + toString(gltfComponentType(index_type)) + ",\n"
 			"		\"count\": " + toString(batch.num_indices) + ",\n"
 			"		\"type\": \"SCALAR\"\n"
 			"	}\n";
@@ -2966,24 +3811,48 @@ void FormatDecoderGLTF::makeGLTFJSONAndBin(const BatchedMesh& mesh, const std::s
 
 	// Write accessor for vertex position
 	const int position_accessor = next_accessor++;
-	json_out +=
-	"	,{\n"
-	"		\"bufferView\": 1,\n"
-	"		\"byteOffset\": 0,\n"
-	"		\"componentType\": " + toString(GLTF_COMPONENT_TYPE_FLOAT) + ",\n"
-	"		\"count\": " + toString(mesh.numVerts()) + ",\n"
-	"		\"max\": [\n"
-	"			" + formatDouble(mesh.aabb_os.max_[0]) + ",\n"
-	"			" + formatDouble(mesh.aabb_os.max_[1]) + ",\n"
-	"			" + formatDouble(mesh.aabb_os.max_[2]) + "\n"
-	"		],\n"
-	"		\"min\": [\n"
-	"			" + formatDouble(mesh.aabb_os.min_[0]) + ",\n"
-	"			" + formatDouble(mesh.aabb_os.min_[1]) + ",\n"
-	"			" + formatDouble(mesh.aabb_os.min_[2]) + "\n"
-	"		],\n"
-	"		\"type\": \"VEC3\"\n"
-	"	}\n";
+	if(quantise)
+	{
+		json_out +=
+		"	,{\n"
+		"		\"bufferView\": 1,\n"
+		"		\"byteOffset\": 0,\n"
+		"		\"componentType\": " + toString(GLTF_COMPONENT_TYPE_UNSIGNED_SHORT) + ",\n"
+		"		\"count\": " + toString(mesh.numVerts()) + ",\n"
+		"		\"max\": [\n"
+		"			" + toString(quantised_pos_max[0]) + ",\n"
+		"			" + toString(quantised_pos_max[1]) + ",\n"
+		"			" + toString(quantised_pos_max[2]) + "\n"
+		"		],\n"
+		"		\"min\": [\n"
+		"			" + toString(quantised_pos_min[0]) + ",\n"
+		"			" + toString(quantised_pos_min[1]) + ",\n"
+		"			" + toString(quantised_pos_min[2]) + "\n"
+		"		],\n"
+		"		\"type\": \"VEC3\"\n"
+		"	}\n";
+	}
+	else
+	{
+		json_out +=
+		"	,{\n"
+		"		\"bufferView\": 1,\n"
+		"		\"byteOffset\": 0,\n"
+		"		\"componentType\": " + toString(GLTF_COMPONENT_TYPE_FLOAT) + ",\n"
+		"		\"count\": " + toString(mesh.numVerts()) + ",\n"
+		"		\"max\": [\n"
+		"			" + formatDouble(mesh.aabb_os.max_[0]) + ",\n"
+		"			" + formatDouble(mesh.aabb_os.max_[1]) + ",\n"
+		"			" + formatDouble(mesh.aabb_os.max_[2]) + "\n"
+		"		],\n"
+		"		\"min\": [\n"
+		"			" + formatDouble(mesh.aabb_os.min_[0]) + ",\n"
+		"			" + formatDouble(mesh.aabb_os.min_[1]) + ",\n"
+		"			" + formatDouble(mesh.aabb_os.min_[2]) + "\n"
+		"		],\n"
+		"		\"type\": \"VEC3\"\n"
+		"	}\n";
+	}
 
 	int vert_normal_accessor = -1;
 	if(normal_attr)
@@ -2993,7 +3862,8 @@ void FormatDecoderGLTF::makeGLTFJSONAndBin(const BatchedMesh& mesh, const std::s
 		"	,{\n"
 		"		\"bufferView\": 1,\n"
 		"		\"byteOffset\": " + toString(normal_offset) + ",\n"
-		"		\"componentType\": " + toString(GLTF_COMPONENT_TYPE_FLOAT) + ",\n"
+		"		\"componentType\": " + toString(quantise ? GLTF_COMPONENT_TYPE_BYTE : GLTF_COMPONENT_TYPE_FLOAT) + ",\n" +
+		(quantise ? "		\"normalized\": true,\n" : "") +
 		"		\"count\": " + toString(mesh.numVerts()) + ",\n"
 		"		\"type\": \"VEC3\"\n"
 		"	}\n";
@@ -3009,7 +3879,8 @@ void FormatDecoderGLTF::makeGLTFJSONAndBin(const BatchedMesh& mesh, const std::s
 		"	,{\n"
 		"		\"bufferView\": 1,\n"
 		"		\"byteOffset\": " + toString(colour_offset) + ",\n"
-		"		\"componentType\": " + toString(GLTF_COMPONENT_TYPE_FLOAT) + ",\n"
+		"		\"componentType\": " + toString(quantise_colour ? GLTF_COMPONENT_TYPE_UNSIGNED_SHORT : GLTF_COMPONENT_TYPE_FLOAT) + ",\n" +
+		(quantise_colour ? "		\"normalized\": true,\n" : "") +
 		"		\"count\": " + toString(mesh.numVerts()) + ",\n"
 		"		\"type\": \"VEC3\"\n"
 		"	}\n";
@@ -3024,7 +3895,8 @@ void FormatDecoderGLTF::makeGLTFJSONAndBin(const BatchedMesh& mesh, const std::s
 		"	,{\n"
 		"		\"bufferView\": 1,\n"
 		"		\"byteOffset\": " + toString(uv0_offset) + ",\n"
-		"		\"componentType\": " + toString(GLTF_COMPONENT_TYPE_FLOAT) + ",\n"
+		"		\"componentType\": " + toString(quantise_uv0 ? GLTF_COMPONENT_TYPE_UNSIGNED_SHORT : GLTF_COMPONENT_TYPE_FLOAT) + ",\n" +
+		(quantise_uv0 ? "		\"normalized\": true,\n" : "") +
 		"		\"count\": " + toString(mesh.numVerts()) + ",\n"
 		"		\"type\": \"VEC2\"\n"
 		"	}\n";
@@ -3039,7 +3911,8 @@ void FormatDecoderGLTF::makeGLTFJSONAndBin(const BatchedMesh& mesh, const std::s
 			"	,{\n"
 			"		\"bufferView\": 1,\n"
 			"		\"byteOffset\": " + toString(uv1_offset) + ",\n"
-			"		\"componentType\": " + toString(GLTF_COMPONENT_TYPE_FLOAT) + ",\n"
+			"		\"componentType\": " + toString(quantise_uv1 ? GLTF_COMPONENT_TYPE_UNSIGNED_SHORT : GLTF_COMPONENT_TYPE_FLOAT) + ",\n" +
+			(quantise_uv1 ? "		\"normalized\": true,\n" : "") +
 			"		\"count\": " + toString(mesh.numVerts()) + ",\n"
 			"		\"type\": \"VEC2\"\n"
 			"	}\n";
@@ -3184,7 +4057,7 @@ void FormatDecoderGLTF::writeBatchedMeshToGLTFFile(const BatchedMesh& mesh, cons
 
 	std::string json;
 	js::Vector<uint8, 16> bin;
-	makeGLTFJSONAndBin(mesh, bin_path, json, bin);
+	makeGLTFJSONAndBin(mesh, bin_path, options, json, bin);
 
 	std::ofstream file(path);
 	file << json;
@@ -3198,7 +4071,7 @@ void FormatDecoderGLTF::writeBatchedMeshToGLBFile(const BatchedMesh& mesh, const
 	// Make the JSON and binary buffer
 	std::string json;
 	js::Vector<uint8, 16> bin;
-	makeGLTFJSONAndBin(mesh, /*bin_path=*/"", json, bin);
+	makeGLTFJSONAndBin(mesh, /*bin_path=*/"", options, json, bin);
 
 
 	FileOutStream file(path);
@@ -3258,6 +4131,7 @@ void FormatDecoderGLTF::writeBatchedMeshToGLBFile(const BatchedMesh& mesh, const
 #include "../utils/FileUtils.h"
 #include "../utils/ConPrint.h"
 #include "../utils/PlatformUtils.h"
+#include "../maths/vec2.h"
 
 
 static void testWriting(const Reference<BatchedMesh>& mesh, const GLTFLoadedData& data)
@@ -3377,10 +4251,420 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
 #endif // FUZZING
 
 
+// Load the file with and without a task manager, check the results are identical, and print the load times.
+static void testParallelLoadMatchesSerialLoad(const std::string& path, glare::TaskManager& task_manager)
+{
+	const bool is_glb = !hasExtension(path, "gltf");
+
+	const int num_trials = 4;
+	double min_serial_time = 1.0e10;
+	double min_parallel_time = 1.0e10;
+	Reference<BatchedMesh> serial_mesh, parallel_mesh;
+	for(int i=0; i<num_trials; ++i)
+	{
+		{
+			Timer timer;
+			GLTFLoadedData data;
+			serial_mesh = is_glb ? FormatDecoderGLTF::loadGLBFile(path, data) : FormatDecoderGLTF::loadGLTFFile(path, data);
+			min_serial_time = myMin(min_serial_time, timer.elapsed());
+		}
+		{
+			Timer timer;
+			GLTFLoadedData data;
+			parallel_mesh = is_glb ? FormatDecoderGLTF::loadGLBFile(path, data, &task_manager) : FormatDecoderGLTF::loadGLTFFile(path, data, &task_manager);
+			min_parallel_time = myMin(min_parallel_time, timer.elapsed());
+		}
+	}
+
+	testAssert(parallel_mesh->vertexSize() == serial_mesh->vertexSize());
+	testAssert(parallel_mesh->vertex_data.size() == serial_mesh->vertex_data.size());
+	testAssert(serial_mesh->vertex_data.empty() || std::memcmp(parallel_mesh->vertex_data.data(), serial_mesh->vertex_data.data(), serial_mesh->vertex_data.size()) == 0);
+	testAssert(parallel_mesh->index_type == serial_mesh->index_type);
+	testAssert(parallel_mesh->index_data.size() == serial_mesh->index_data.size());
+	testAssert(serial_mesh->index_data.empty() || std::memcmp(parallel_mesh->index_data.data(), serial_mesh->index_data.data(), serial_mesh->index_data.size()) == 0);
+	testAssert(parallel_mesh->batches == serial_mesh->batches);
+	testAssert(parallel_mesh->aabb_os == serial_mesh->aabb_os);
+
+	conPrint(FileUtils::getFilename(path) + ": " + toString(serial_mesh->numVerts()) + " verts, " + toString(serial_mesh->batches.size()) + " batches, serial load: " +
+		doubleToStringNSigFigs(min_serial_time * 1.0e3, 4) + " ms, parallel load (" + toString(task_manager.getNumThreads()) + " threads): " + doubleToStringNSigFigs(min_parallel_time * 1.0e3, 4) + " ms");
+}
+
+
+// Returns true if vertex i of mesh and vertex i2 of mesh2 are the same, to within the quantisation error if quantising.
+static bool writtenVertexMatches(const BatchedMesh& mesh, size_t i, const BatchedMesh& mesh2, size_t i2, const GLTFWriteOptions& options)
+{
+	// Quantised positions are on a grid with spacing of 1/65535 of the largest dimension of the bounds.
+	const float pos_tolerance = options.quantise_attributes ? (mesh.aabb_os.axisLength(mesh.aabb_os.longestAxis()) / 65535 * 0.51f + 1.0e-6f) : 0.f;
+	const float unit_range_tolerance = options.quantise_attributes ? (0.51f / 65535) : 0.f;
+
+	const BatchedMesh::VertAttribute& pos_attr = mesh.getAttribute(BatchedMesh::VertAttribute_Position);
+	const BatchedMesh::VertAttribute& pos_attr2 = mesh2.getAttribute(BatchedMesh::VertAttribute_Position);
+	const BatchedMesh::VertAttribute* normal_attr = mesh.findAttribute(BatchedMesh::VertAttribute_Normal);
+	const BatchedMesh::VertAttribute* normal_attr2 = mesh2.findAttribute(BatchedMesh::VertAttribute_Normal);
+	const BatchedMesh::VertAttribute* uv0_attr = mesh.findAttribute(BatchedMesh::VertAttribute_UV_0);
+	const BatchedMesh::VertAttribute* uv0_attr2 = mesh2.findAttribute(BatchedMesh::VertAttribute_UV_0);
+
+	Vec3f p, p2;
+	std::memcpy(&p, &mesh.vertex_data[i * mesh.vertexSize() + pos_attr.offset_B], sizeof(Vec3f));
+	std::memcpy(&p2, &mesh2.vertex_data[i2 * mesh2.vertexSize() + pos_attr2.offset_B], sizeof(Vec3f));
+	for(int c=0; c<3; ++c)
+		if(!(std::fabs(p[c] - p2[c]) <= pos_tolerance))
+			return false;
+
+	if(normal_attr)
+	{
+		testAssert(normal_attr->component_type == BatchedMesh::ComponentType_PackedNormal && normal_attr2->component_type == BatchedMesh::ComponentType_PackedNormal);
+		uint32 n, n2;
+		std::memcpy(&n, &mesh.vertex_data[i * mesh.vertexSize() + normal_attr->offset_B], sizeof(uint32));
+		std::memcpy(&n2, &mesh2.vertex_data[i2 * mesh2.vertexSize() + normal_attr2->offset_B], sizeof(uint32));
+		if(!(dot(normalise(batchedMeshUnpackNormal(n)), normalise(batchedMeshUnpackNormal(n2))) > (options.quantise_attributes ? 0.995f : 0.9999f)))
+			return false;
+	}
+
+	if(uv0_attr)
+	{
+		Vec2f uv, uv2;
+		std::memcpy(&uv, &mesh.vertex_data[i * mesh.vertexSize() + uv0_attr->offset_B], sizeof(Vec2f));
+		std::memcpy(&uv2, &mesh2.vertex_data[i2 * mesh2.vertexSize() + uv0_attr2->offset_B], sizeof(Vec2f));
+		// UVs are only quantised if they are all in [0, 1], otherwise they are written exactly.
+		if(uv.x >= 0 && uv.x <= 1 && uv.y >= 0 && uv.y <= 1)
+		{
+			if(!(std::fabs(uv.x - uv2.x) <= unit_range_tolerance + 1.0e-7f && std::fabs(uv.y - uv2.y) <= unit_range_tolerance + 1.0e-7f))
+				return false;
+		}
+		else if(!(uv == uv2))
+			return false;
+	}
+	return true;
+}
+
+
+// Write the mesh with the given options, load it again, and check the loaded mesh is the same, to within the quantisation error if quantising.
+static void testWriteAndReload(const BatchedMesh& mesh, const GLTFWriteOptions& options, const std::string& path)
+{
+	if(hasExtension(path, "gltf"))
+		FormatDecoderGLTF::writeBatchedMeshToGLTFFile(mesh, path, options);
+	else
+		FormatDecoderGLTF::writeBatchedMeshToGLBFile(mesh, path, options);
+
+	GLTFLoadedData data;
+	Reference<BatchedMesh> mesh2 = hasExtension(path, "gltf") ? FormatDecoderGLTF::loadGLTFFile(path, data) : FormatDecoderGLTF::loadGLBFile(path, data);
+
+	// Each batch is written as a primitive referencing all the vertices, and the loader duplicates the vertices for each primitive, so
+	// we compare the vertices referenced by each index.
+	testAssert(mesh2->numVerts() == mesh.numVerts() * mesh.batches.size());
+	testEqual(mesh2->numIndices(), mesh.numIndices());
+	testAssert(mesh2->batches == mesh.batches);
+	testAssert((mesh.findAttribute(BatchedMesh::VertAttribute_Normal) != NULL) == (mesh2->findAttribute(BatchedMesh::VertAttribute_Normal) != NULL));
+	testAssert((mesh.findAttribute(BatchedMesh::VertAttribute_UV_0) != NULL) == (mesh2->findAttribute(BatchedMesh::VertAttribute_UV_0) != NULL));
+
+	// Meshopt index compression keeps the triangle order and winding, but may rotate the vertices of each triangle.
+	for(size_t t=0; t<mesh.numIndices() / 3; ++t)
+	{
+		bool matched = false;
+		for(size_t r=0; r<3 && !matched; ++r)
+		{
+			matched = true;
+			for(size_t k=0; k<3 && matched; ++k)
+				matched = writtenVertexMatches(mesh, mesh.getIndexAsUInt32(t * 3 + k), *mesh2, mesh2->getIndexAsUInt32(t * 3 + (k + r) % 3), options);
+		}
+		testAssert(matched);
+		if(!options.use_meshopt_compression)
+			testAssert(writtenVertexMatches(mesh, mesh.getIndexAsUInt32(t * 3), *mesh2, mesh2->getIndexAsUInt32(t * 3), options));
+	}
+}
+
+
+static void testWritingWithQuantisationAndCompression(const std::string& src_path)
+{
+	GLTFLoadedData data;
+	Reference<BatchedMesh> mesh = hasExtension(src_path, "gltf") ? FormatDecoderGLTF::loadGLTFFile(src_path, data) : FormatDecoderGLTF::loadGLBFile(src_path, data);
+
+	std::string sizes;
+	for(int i=0; i<4; ++i)
+	{
+		GLTFWriteOptions options;
+		options.quantise_attributes = (i & 1) != 0;
+		options.use_meshopt_compression = (i & 2) != 0;
+
+		const std::string path = PlatformUtils::getTempDirPath() + "/gltf_write_test_" + toString(i) + ".glb";
+		testWriteAndReload(*mesh, options, path);
+
+		sizes += std::string(options.quantise_attributes ? "quantised" : "float") + (options.use_meshopt_compression ? " + meshopt: " : ": ") + toString(FileUtils::getFileSize(path)) + " B" + ((i < 3) ? ", " : "");
+	}
+	conPrint(FileUtils::getFilename(src_path) + " GLB sizes: " + sizes);
+
+	// Test writing a .gltf file with a separate .bin file, for which the compressed data is in the .bin file and the fallback buffer has no URI.
+	GLTFWriteOptions options;
+	options.quantise_attributes = true;
+	options.use_meshopt_compression = true;
+	testWriteAndReload(*mesh, options, PlatformUtils::getTempDirPath() + "/gltf_write_test.gltf");
+}
+
+
+// Makes a glTF file with a single triangle, with all buffer views compressed with EXT_meshopt_compression, and normals quantised to bytes with the octahedral filter.
+// This is similar to what gltfpack writes.
+static std::string makeMeshoptTriangleGLTF(const std::string& normal_filter, bool corrupt_index_data)
+{
+	const float positions[3 * 3] = { 0,0,0,  1,0,0,  0,1,0 };
+	const float normals[3 * 4] = { 0,0,1,0,  0,0.6f,0.8f,0,  0.6f,0,0.8f,0 }; // meshopt_encodeFilterOct takes 4 floats per normal.
+	const unsigned int indices[3] = { 0, 1, 2 };
+
+	int8 filtered_normals[3 * 4];
+	meshopt_encodeFilterOct(filtered_normals, /*count=*/3, /*stride=*/4, /*bits=*/8, normals);
+
+	js::Vector<uint8, 16> bin(1024);
+	meshopt_encodeIndexVersion(1);
+	const size_t index_size = meshopt_encodeIndexBuffer(bin.data(), bin.size(), indices, 3);
+	const size_t pos_offset = Maths::roundUpToMultipleOfPowerOf2<size_t>(index_size, 4);
+	const size_t pos_size = meshopt_encodeVertexBufferLevel(&bin[pos_offset], bin.size() - pos_offset, positions, 3, sizeof(float) * 3, /*level=*/2, /*version=*/0);
+	const size_t normal_offset = Maths::roundUpToMultipleOfPowerOf2<size_t>(pos_offset + pos_size, 4);
+	const size_t normal_size = meshopt_encodeVertexBufferLevel(&bin[normal_offset], bin.size() - normal_offset, filtered_normals, 3, sizeof(int8) * 4, /*level=*/2, /*version=*/0);
+	testAssert(index_size > 0 && pos_size > 0 && normal_size > 0);
+	bin.resize(normal_offset + normal_size);
+
+	if(corrupt_index_data)
+		bin[0] = 0; // Clobber the header byte
+
+	std::string bin_base64;
+	Base64::encode(bin.data(), bin.size(), bin_base64);
+
+	return
+		"{\n"
+		"\"asset\": { \"version\": \"2.0\" },\n"
+		"\"extensionsUsed\": [\"EXT_meshopt_compression\", \"KHR_mesh_quantization\"],\n"
+		"\"extensionsRequired\": [\"EXT_meshopt_compression\", \"KHR_mesh_quantization\"],\n"
+		"\"buffers\": [\n"
+		"	{ \"byteLength\": " + toString(bin.size()) + ", \"uri\": \"data:application/octet-stream;base64," + bin_base64 + "\" },\n"
+		"	{ \"byteLength\": 56, \"extensions\": { \"EXT_meshopt_compression\": { \"fallback\": true } } }\n"
+		"],\n"
+		"\"bufferViews\": [\n"
+		"	{ \"buffer\": 1, \"byteOffset\": 0, \"byteLength\": 6, \"extensions\": { \"EXT_meshopt_compression\": { \"buffer\": 0, \"byteOffset\": 0, \"byteLength\": " + toString(index_size) +
+			", \"byteStride\": 2, \"count\": 3, \"mode\": \"TRIANGLES\" } } },\n"
+		"	{ \"buffer\": 1, \"byteOffset\": 8, \"byteLength\": 36, \"byteStride\": 12, \"extensions\": { \"EXT_meshopt_compression\": { \"buffer\": 0, \"byteOffset\": " + toString(pos_offset) + 
+			", \"byteLength\": " + toString(pos_size) + ", \"byteStride\": 12, \"count\": 3, \"mode\": \"ATTRIBUTES\" } } },\n"
+		"	{ \"buffer\": 1, \"byteOffset\": 44, \"byteLength\": 12, \"byteStride\": 4, \"extensions\": { \"EXT_meshopt_compression\": { \"buffer\": 0, \"byteOffset\": " + toString(normal_offset) + 
+			", \"byteLength\": " + toString(normal_size) + ", \"byteStride\": 4, \"count\": 3, \"mode\": \"ATTRIBUTES\", \"filter\": \"" + normal_filter + "\" } } }\n"
+		"],\n"
+		"\"accessors\": [\n"
+		"	{ \"bufferView\": 0, \"componentType\": 5123, \"count\": 3, \"type\": \"SCALAR\" },\n"
+		"	{ \"bufferView\": 1, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\", \"min\": [0, 0, 0], \"max\": [1, 1, 0] },\n"
+		"	{ \"bufferView\": 2, \"componentType\": 5120, \"normalized\": true, \"count\": 3, \"type\": \"VEC3\" }\n"
+		"],\n"
+		"\"meshes\": [ { \"primitives\": [ { \"attributes\": { \"POSITION\": 1, \"NORMAL\": 2 }, \"indices\": 0, \"mode\": 4 } ] } ],\n"
+		"\"nodes\": [ { \"mesh\": 0 } ],\n"
+		"\"scenes\": [ { \"nodes\": [0] } ],\n"
+		"\"scene\": 0\n"
+		"}\n";
+}
+
+
+static void testLoadingMeshoptCompressedData()
+{
+	{
+		const std::string gltf = makeMeshoptTriangleGLTF("OCTAHEDRAL", /*corrupt_index_data=*/false);
+		GLTFLoadedData data;
+		Reference<BatchedMesh> mesh = FormatDecoderGLTF::loadGLTFFileFromData(gltf.data(), gltf.size(), "dummy_path", /*write_images_to_disk=*/false, data);
+
+		testEqual(mesh->numVerts(), (size_t)3);
+		testEqual(mesh->numIndices(), (size_t)3);
+		for(size_t i=0; i<3; ++i)
+			testEqual(mesh->getIndexAsUInt32(i), (uint32)i);
+		testAssert(mesh->aabb_os == js::AABBox(Vec4f(0,0,0,1), Vec4f(1,1,0,1)));
+
+		const Vec4f expected_normals[3] = { Vec4f(0,0,1,0), Vec4f(0,0.6f,0.8f,0), Vec4f(0.6f,0,0.8f,0) };
+		const BatchedMesh::VertAttribute& normal_attr = mesh->getAttribute(BatchedMesh::VertAttribute_Normal);
+		for(size_t i=0; i<3; ++i)
+		{
+			uint32 packed_normal;
+			std::memcpy(&packed_normal, &mesh->vertex_data[i * mesh->vertexSize() + normal_attr.offset_B], sizeof(uint32));
+			testAssert(dot(normalise(batchedMeshUnpackNormal(packed_normal)), expected_normals[i]) > 0.995f); // Allow for 8-bit quantisation
+		}
+	}
+
+	// Test invalid data and parameters are reported as errors
+	try
+	{
+		const std::string gltf = makeMeshoptTriangleGLTF("OCTAHEDRAL", /*corrupt_index_data=*/true);
+		GLTFLoadedData data;
+		FormatDecoderGLTF::loadGLTFFileFromData(gltf.data(), gltf.size(), "dummy_path", /*write_images_to_disk=*/false, data);
+		failTest("Expected exception");
+	}
+	catch(glare::Exception&)
+	{}
+
+	try
+	{
+		const std::string gltf = makeMeshoptTriangleGLTF("QUATERNION", /*corrupt_index_data=*/false); // QUATERNION filter needs a stride of 8.
+		GLTFLoadedData data;
+		FormatDecoderGLTF::loadGLTFFileFromData(gltf.data(), gltf.size(), "dummy_path", /*write_images_to_disk=*/false, data);
+		failTest("Expected exception");
+	}
+	catch(glare::Exception&)
+	{}
+
+	// A large count should be rejected before the decoded data is allocated, whether or not it matches the buffer view byteLength.
+	{
+		glare::TaskManager task_manager;
+		const std::string gltf = makeMeshoptTriangleGLTF("OCTAHEDRAL", /*corrupt_index_data=*/false);
+		const std::string pos_view = "\"byteLength\": 36, \"byteStride\": 12,";
+		testAssert(gltf.find(pos_view) != std::string::npos && gltf.find("\"count\": 3, \"mode\": \"ATTRIBUTES\"") != std::string::npos);
+
+		std::string count_mismatch_gltf = gltf;
+		count_mismatch_gltf.replace(count_mismatch_gltf.find("\"count\": 3, \"mode\": \"ATTRIBUTES\""), 10, "\"count\": 900000000");
+		std::string huge_gltf = count_mismatch_gltf;
+		huge_gltf.replace(huge_gltf.find(pos_view), pos_view.size(), "\"byteLength\": 10800000000, \"byteStride\": 12,");
+
+		for(int use_task_manager=0; use_task_manager<2; ++use_task_manager)
+		{
+			try
+			{
+				GLTFLoadedData data;
+				FormatDecoderGLTF::loadGLTFFileFromData(count_mismatch_gltf.data(), count_mismatch_gltf.size(), "dummy_path", /*write_images_to_disk=*/false, data, use_task_manager ? &task_manager : NULL);
+				failTest("Expected exception");
+			}
+			catch(glare::Exception&)
+			{}
+			try
+			{
+				GLTFLoadedData data;
+				FormatDecoderGLTF::loadGLTFFileFromData(huge_gltf.data(), huge_gltf.size(), "dummy_path", /*write_images_to_disk=*/false, data, use_task_manager ? &task_manager : NULL);
+				failTest("Expected exception");
+			}
+			catch(glare::Exception&)
+			{}
+		}
+	}
+}
+
+
+// Makes a triangle with quantised UVs, laid out as gltfpack writes them: non-normalised uint16 UVs (with KHR_mesh_quantization), and a KHR_texture_transform
+// on each texture of the material mapping them back to the original UVs.
+static std::string makeTextureTransformTriangleGLTF(const std::string& transform_json)
+{
+	const float positions[3 * 3] = { 0,0,0,  1,0,0,  0,1,0 };
+	const uint16 uvs[3 * 2] = { 0,0,  4095,0,  0,4095 };
+
+	std::vector<uint8> bin(sizeof(positions) + sizeof(uvs));
+	std::memcpy(bin.data(), positions, sizeof(positions));
+	std::memcpy(bin.data() + sizeof(positions), uvs, sizeof(uvs));
+
+	std::string bin_base64;
+	Base64::encode(bin.data(), bin.size(), bin_base64);
+
+	const std::string texture_info = "{ \"index\": 0, \"extensions\": { \"KHR_texture_transform\": " + transform_json + " } }";
+
+	return
+		"{\n"
+		"\"asset\": { \"version\": \"2.0\" },\n"
+		"\"extensionsUsed\": [\"KHR_mesh_quantization\", \"KHR_texture_transform\"],\n"
+		"\"extensionsRequired\": [\"KHR_mesh_quantization\", \"KHR_texture_transform\"],\n"
+		"\"buffers\": [ { \"byteLength\": " + toString(bin.size()) + ", \"uri\": \"data:application/octet-stream;base64," + bin_base64 + "\" } ],\n"
+		"\"bufferViews\": [\n"
+		"	{ \"buffer\": 0, \"byteOffset\": 0, \"byteLength\": 36, \"byteStride\": 12 },\n"
+		"	{ \"buffer\": 0, \"byteOffset\": 36, \"byteLength\": 12, \"byteStride\": 4 }\n"
+		"],\n"
+		"\"accessors\": [\n"
+		"	{ \"bufferView\": 0, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\", \"min\": [0, 0, 0], \"max\": [1, 1, 0] },\n"
+		"	{ \"bufferView\": 1, \"componentType\": 5123, \"count\": 3, \"type\": \"VEC2\" }\n"
+		"],\n"
+		"\"images\": [ { \"uri\": \"dummy.png\" } ],\n"
+		"\"textures\": [ { \"source\": 0 } ],\n"
+		"\"materials\": [ { \"pbrMetallicRoughness\": { \"baseColorTexture\": " + texture_info + " }, \"normalTexture\": " + texture_info + " } ],\n"
+		"\"meshes\": [ { \"primitives\": [ { \"attributes\": { \"POSITION\": 0, \"TEXCOORD_0\": 1 }, \"material\": 0, \"mode\": 4 } ] } ],\n"
+		"\"nodes\": [ { \"mesh\": 0 } ],\n"
+		"\"scenes\": [ { \"nodes\": [0] } ],\n"
+		"\"scene\": 0\n"
+		"}\n";
+}
+
+
+static void testLoadingTextureTransform()
+{
+	// The raw uvs in makeTextureTransformTriangleGLTF().
+	const Vec2f raw_uvs[3] = { Vec2f(0, 0), Vec2f(4095, 0), Vec2f(0, 4095) };
+
+	for(int use_rotation=0; use_rotation<2; ++use_rotation)
+	{
+		const Vec2f offset(0.25f, 0.5f);
+		const Vec2f scale(0.5f / 4095, 0.25f / 4095);
+		const float rotation = use_rotation ? (Maths::pi<float>() / 2) : 0.f;
+		const std::string gltf = makeTextureTransformTriangleGLTF("{ \"offset\": [0.25, 0.5], \"scale\": [" + formatDouble(scale.x) + ", " + 
+			formatDouble(scale.y) + "]" + (use_rotation ? (", \"rotation\": " + formatDouble(rotation)) : std::string()) + " }");
+
+		GLTFLoadedData data;
+		Reference<BatchedMesh> mesh = FormatDecoderGLTF::loadGLTFFileFromData(gltf.data(), gltf.size(), "dummy_path", /*write_images_to_disk=*/false, data);
+		testEqual(mesh->numVerts(), (size_t)3);
+
+		const BatchedMesh::VertAttribute& uv_attr = mesh->getAttribute(BatchedMesh::VertAttribute_UV_0);
+		for(size_t i=0; i<3; ++i)
+		{
+			Vec2f uv;
+			std::memcpy(&uv, &mesh->vertex_data[i * mesh->vertexSize() + uv_attr.offset_B], sizeof(Vec2f));
+
+			// Rotating by 90 degrees maps (u, v) to (v, -u).  The transform is only applied once, even though both textures have it.
+			const Vec2f scaled(raw_uvs[i].x * scale.x, raw_uvs[i].y * scale.y);
+			const Vec2f expected = use_rotation ? (offset + Vec2f(scaled.y, -scaled.x)) : (offset + scaled);
+			testAssert(epsEqual(uv.x, expected.x, 1.0e-5f) && epsEqual(uv.y, expected.y, 1.0e-5f));
+		}
+	}
+}
+
+
 void FormatDecoderGLTF::test()
 {
 	conPrint("FormatDecoderGLTF::test()");
 
+	//----------------------------------- Test KHR_mesh_quantization and EXT_meshopt_compression -----------------------------------
+	try
+	{
+		testLoadingMeshoptCompressedData();
+
+		testLoadingTextureTransform();
+
+		testWritingWithQuantisationAndCompression(TestUtils::getTestReposDir() + "/testfiles/gltf/duck/Duck.gltf");
+		testWritingWithQuantisationAndCompression(TestUtils::getTestReposDir() + "/testfiles/VRMs/meebit_09842_t_solid.vrm");
+		testWritingWithQuantisationAndCompression(TestUtils::getTestReposDir() + "/testfiles/gltf/VertexColorTest.glb");
+		testWritingWithQuantisationAndCompression(TestUtils::getTestReposDir() + "/testfiles/gltf/Box.glb"); // Has UInt8 indices
+	}
+	catch(glare::Exception& e)
+	{
+		failTest(e.what());
+	}
+
+	//----------------------------------- Test loading with a task manager gives the same results as loading without one -----------------------------------
+	try
+	{
+		glare::TaskManager task_manager;
+
+		// Scenes with many primitives
+		testParallelLoadMatchesSerialLoad(TestUtils::getTestReposDir() + "/testfiles/gltf/2CylinderEngine.glb", task_manager);
+		testParallelLoadMatchesSerialLoad(TestUtils::getTestReposDir() + "/testfiles/gltf/MetalRoughSpheresNoTextures.glb", task_manager);
+
+		// Skinned avatars
+		testParallelLoadMatchesSerialLoad(TestUtils::getTestReposDir() + "/testfiles/VRMs/meebit_09842_t_solid.vrm", task_manager);
+		testParallelLoadMatchesSerialLoad(TestUtils::getTestReposDir() + "/testfiles/gltf/CesiumMan.glb", task_manager);
+		testParallelLoadMatchesSerialLoad(TestUtils::getTestReposDir() + "/testfiles/gltf/Fox.glb", task_manager);
+
+		// Embedded images
+		testParallelLoadMatchesSerialLoad(TestUtils::getTestReposDir() + "/testfiles/gltf/duck_with_embedded_texture.gltf", task_manager);
+		testParallelLoadMatchesSerialLoad(TestUtils::getTestReposDir() + "/testfiles/gltf/BoxTextured.glb", task_manager);
+
+		// Check errors are still reported when loading with a task manager.
+		try
+		{
+			GLTFLoadedData data;
+			loadGLBFile(TestUtils::getTestReposDir() + "/testfiles/gltf/crash-357f6ffbac1bf40494ac432acafd26c3af217e21.glb", data, &task_manager);
+			failTest("Expected exception");
+		}
+		catch(glare::Exception&)
+		{}
+	}
+	catch(glare::Exception& e)
+	{
+		failTest(e.what());
+	}
+
 	//================= Test writeBatchedMeshToGLBFile =================
 	/*try
 	{
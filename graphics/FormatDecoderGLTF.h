@@ -13,6 +13,7 @@ Copyright Glare Technologies Limited 2021 -
 #include <string>
 #include <vector>
 namespace Indigo { class Mesh; }
+namespace glare { class TaskManager; }
 class JSONParser;
 struct GLTFBuffer;
 class BatchedMesh;
@@ -61,9 +62,12 @@ struct GLTFLoadedData
 
 struct GLTFWriteOptions
 {
-	GLTFWriteOptions()/* : write_vert_normals(true) */{}
+	GLTFWriteOptions() : quantise_attributes(false), use_meshopt_compression(false)/*, write_vert_normals(true) */{}
 
 	//bool write_vert_normals; // Write vertex normals, if present in mesh.
+
+	bool quantise_attributes; // Store vertex attributes as 8 and 16 bit integers, using KHR_mesh_quantization.  Positions are dequantised by the node transform.
+	bool use_meshopt_compression; // Compress the vertex and index data with EXT_meshopt_compression.  No uncompressed fallback data is written.
 };
 
 
@@ -77,16 +81,25 @@ Current limitations:
 May duplicate vertices when loading them if the same vertices are referenced from multiple primitives.
 Doesn't support morph targets.
 Doesn't support non-skinned animations.
+Doesn't support KHR_texture_transform, so integer UVs that are not normalised (allowed by KHR_mesh_quantization) are loaded as-is.
 
 TODO: when loading multiple primitives using the same vertex accessors, don't duplicate verts.
+
+If a task_manager is passed to the load functions, mesh primitives are loaded
+concurrently, each into its own range of the pre-sized vertex and index data,
+and embedded images are decoded and written to disk concurrently.
+
+Supports loading and writing files using KHR_mesh_quantization and EXT_meshopt_compression.
+Compressed buffer views are decoded once when the file is loaded, and fallback buffers are never read.
 =====================================================================*/
 class FormatDecoderGLTF
 {
 public:
 
-	static Reference<BatchedMesh> loadGLBFile(const std::string& filename, GLTFLoadedData& data_out); // throws glare::Exception on failure
+	// Multi-thread if task_manager is non-null
+	static Reference<BatchedMesh> loadGLBFile(const std::string& filename, GLTFLoadedData& data_out, glare::TaskManager* task_manager = NULL); // throws glare::Exception on failure
 
-	static Reference<BatchedMesh> loadGLTFFile(const std::string& filename, GLTFLoadedData& data_out); // throws glare::Exception on failure
+	static Reference<BatchedMesh> loadGLTFFile(const std::string& filename, GLTFLoadedData& data_out, glare::TaskManager* task_manager = NULL); // throws glare::Exception on failure
 
 	static void writeBatchedMeshToGLTFFile(const BatchedMesh& mesh, const std::string& path, const GLTFWriteOptions& options); // throws glare::Exception on failure
 
@@ -95,12 +108,14 @@ public:
 	static void test();
 
 	// For fuzz testing:
-	static Reference<BatchedMesh> loadGLBFileFromData(const void* data, const size_t datalen, const std::string& gltf_base_dir, bool write_images_to_disk, GLTFLoadedData& data_out);
+	static Reference<BatchedMesh> loadGLBFileFromData(const void* data, const size_t datalen, const std::string& gltf_base_dir, bool write_images_to_disk, GLTFLoadedData& data_out,
+		glare::TaskManager* task_manager = NULL);
 
-	static Reference<BatchedMesh> loadGLTFFileFromData(const void* data, const size_t datalen, const std::string& gltf_base_dir, bool write_images_to_disk, GLTFLoadedData& data_out);
+	static Reference<BatchedMesh> loadGLTFFileFromData(const void* data, const size_t datalen, const std::string& gltf_base_dir, bool write_images_to_disk, GLTFLoadedData& data_out,
+		glare::TaskManager* task_manager = NULL);
 private:
 	static Reference<BatchedMesh> loadGivenJSON(JSONParser& parser, const std::string gltf_base_dir, const Reference<GLTFBuffer>& glb_bin_buffer, bool write_images_to_disk,
-		GLTFLoadedData& data_out); // throws glare::Exception on failure
+		GLTFLoadedData& data_out, glare::TaskManager* task_manager); // throws glare::Exception on failure
 
-	static void makeGLTFJSONAndBin(const BatchedMesh& mesh, const std::string& bin_path, std::string& json_out, js::Vector<uint8, 16>& bin_out);
+	static void makeGLTFJSONAndBin(const BatchedMesh& mesh, const std::string& bin_path, const GLTFWriteOptions& options, std::string& json_out, js::Vector<uint8, 16>& bin_out);
 };
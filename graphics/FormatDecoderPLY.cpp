@@ -7,130 +7,1182 @@ Code By Nicholas Chapman.
 #include "FormatDecoderPLY.h"
 
 
-// Grab rply src from: http://www.cs.princeton.edu/~diego/professional/rply/
-
-
 #include "../dll/include/IndigoMesh.h"
+#include "../dll/include/IndigoException.h"
+#include "../dll/IndigoStringUtils.h"
+#include "../maths/mathstypes.h"
 #include "../utils/Exception.h"
-#include "../rply-1.1.1/rply.h"
+#include "../utils/MemMappedFile.h"
+#include "../utils/Parser.h"
+#include "../utils/StringUtils.h"
+#include "../utils/Task.h"
+#include "../utils/TaskManager.h"
+#include "../utils/Vector.h"
 #include <assert.h>
+#include <cstring>
+#include <limits>
 #include <vector>
 
 
 using namespace Indigo;
 
 
-//dirty nasty global variables
-static Vec3f current_vert_pos;//NOTE TEMP HACK GLOBAL VAR
-static const std::vector<Vec2f> texcoord_sets;
-static unsigned int current_vert_indices[3];
-static float ply_scale = 1.0f;//TEMP NASTY HACK
+void FormatDecoderPLY::streamModel(const std::string& pathname, Indigo::Mesh& handler, float scale, glare::TaskManager* task_manager)
+{
+	try
+	{
+		MemMappedFile file(pathname);
+		loadModelFromBuffer((const uint8*)file.fileData(), file.fileSize(), handler, scale, task_manager);
+	}
+	catch(glare::Exception& e)
+	{
+		throw glare::Exception("Error while reading '" + pathname + "': " + e.what());
+	}
+}
+
+
+//=================================== Parallel parsing =====================================
 
 
-static int vertex_callback(p_ply_argument argument) 
+namespace
 {
 
-	//------------------------------------------------------------------------
-	//get pointer to current mesh, current component of vertex pos.
-	//------------------------------------------------------------------------
-	long current_cmpnt = 0;
-	void* pointer_usrdata = NULL;
-	ply_get_argument_user_data(argument, &pointer_usrdata, &current_cmpnt);
 
-	//PlyMesh* current_mesh = static_cast<PlyMesh*>(pointer_usrdata);
-	//assert(current_mesh);
+enum PLYType
+{
+	PLYType_Int8,
+	PLYType_UInt8,
+	PLYType_Int16,
+	PLYType_UInt16,
+	PLYType_Int32,
+	PLYType_UInt32,
+	PLYType_Float32,
+	PLYType_Float64
+};
+
+
+inline size_t plyTypeSize(PLYType type)
+{
+	static const size_t sizes[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+	return sizes[type];
+}
 
-	Indigo::Mesh* handler =  static_cast<Indigo::Mesh*>(pointer_usrdata);
 
+bool parsePLYType(const std::string& s, PLYType& type_out)
+{
+	if(s == "char" || s == "int8")						type_out = PLYType_Int8;
+	else if(s == "uchar" || s == "uint8")				type_out = PLYType_UInt8;
+	else if(s == "short" || s == "int16")				type_out = PLYType_Int16;
+	else if(s == "ushort" || s == "uint16")				type_out = PLYType_UInt16;
+	else if(s == "int" || s == "int32")					type_out = PLYType_Int32;
+	else if(s == "uint" || s == "uint32")				type_out = PLYType_UInt32;
+	else if(s == "float" || s == "float32")				type_out = PLYType_Float32;
+	else if(s == "double" || s == "float64")			type_out = PLYType_Float64;
+	else
+		return false;
+	return true;
+}
+
+
+struct PLYProperty
+{
+	std::string name;
+	PLYType type; // For list properties, the type of the list values.
+	bool is_list;
+	PLYType list_count_type;
+};
 
-	//get vert index
-	long vertindex;
-	ply_get_argument_element(argument, NULL, &vertindex);
 
-	//current_mesh->verts[vertindex].pos[current_cmpnt] = ply_get_argument_value(argument);
-	current_vert_pos[current_cmpnt] = (float)ply_get_argument_value(argument);
-	if(current_cmpnt == 2)
+struct PLYElement
+{
+	std::string name;
+	uint64 count;
+	std::vector<PLYProperty> properties;
+	size_t fixed_size; // The size of each element in a binary file if it has no list properties, 0 otherwise.
+};
+
+
+enum PLYFormat
+{
+	PLYFormat_ASCII,
+	PLYFormat_BinaryLittleEndian,
+	PLYFormat_BinaryBigEndian
+};
+
+
+struct PLYHeader
+{
+	PLYFormat format;
+	std::vector<PLYElement> elements;
+	size_t body_offset;
+
+	int vertex_element; // Index of the "vertex" element, or -1 if there isn't one with x, y and z properties.
+	int pos_props[3]; // Indices of the x, y and z properties of the vertex element.
+	int face_element; // Index of the "face" element, or -1 if there isn't one with a vertex index list.
+	int face_indices_prop; // Index of the vertex index list property of the face element.
+};
+
+
+void tokenisePLYLine(string_view line, std::vector<std::string>& tokens_out)
+{
+	tokens_out.clear();
+	Parser parser(line.data(), line.size());
+	while(1)
 	{
-		handler->addVertex(current_vert_pos * ply_scale/*, Vec3f(0, 0, 1)*/); // , texcoord_sets);//NOTE: FUCKING NASTY HARD CODED NORMAL HERE
+		parser.parseWhiteSpace();
+		string_view token;
+		if(!parser.parseNonWSToken(token))
+			break;
+		tokens_out.push_back(toString(token));
 	}
-		
-    return 1;
 }
 
 
-static int face_callback(p_ply_argument argument) 
+void parsePLYHeader(const uint8* data, size_t len, PLYHeader& header)
 {
-	//------------------------------------------------------------------------
-	//get pointer to current mesh
-	//------------------------------------------------------------------------
-	void* pointer_usrdata = NULL;
-	ply_get_argument_user_data(argument, &pointer_usrdata, NULL);
+	Parser parser((const char*)data, len);
+	std::vector<std::string> tokens;
+
+	string_view line;
+	parser.parseLine(line);
+	tokenisePLYLine(line, tokens);
+	if(tokens.size() != 1 || tokens[0] != "ply")
+		throw glare::Exception("Invalid PLY file: expected 'ply' on first line.");
+
+	bool have_format = false;
+	while(1)
+	{
+		if(parser.eof())
+			throw glare::Exception("Unexpected end of file in PLY header.");
+
+		parser.parseLine(line);
+		tokenisePLYLine(line, tokens);
+		if(tokens.empty())
+			continue;
+
+		if(tokens[0] == "end_header")
+			break;
+		else if(tokens[0] == "format")
+		{
+			if(tokens.size() != 3)
+				throw glare::Exception("Invalid format line in PLY header.");
+			if(tokens[1] == "ascii")
+				header.format = PLYFormat_ASCII;
+			else if(tokens[1] == "binary_little_endian")
+				header.format = PLYFormat_BinaryLittleEndian;
+			else if(tokens[1] == "binary_big_endian")
+				header.format = PLYFormat_BinaryBigEndian;
+			else
+				throw glare::Exception("Unknown PLY format '" + tokens[1] + "'.");
+			have_format = true;
+		}
+		else if(tokens[0] == "element")
+		{
+			PLYElement element;
+			if(tokens.size() != 3)
+				throw glare::Exception("Invalid element line in PLY header.");
+			Parser count_parser(tokens[2]);
+			if(!count_parser.parseUInt64(element.count) || count_parser.notEOF())
+				throw glare::Exception("Invalid element count in PLY header.");
+			element.name = tokens[1];
+			header.elements.push_back(element);
+		}
+		else if(tokens[0] == "property")
+		{
+			if(header.elements.empty())
+				throw glare::Exception("PLY property before first element.");
+			PLYProperty prop;
+			if(tokens.size() == 5 && tokens[1] == "list")
+			{
+				prop.is_list = true;
+				if(!parsePLYType(tokens[2], prop.list_count_type) || !parsePLYType(tokens[3], prop.type))
+					throw glare::Exception("Invalid property type in PLY header.");
+				prop.name = tokens[4];
+			}
+			else if(tokens.size() == 3)
+			{
+				prop.is_list = false;
+				prop.list_count_type = PLYType_UInt8;
+				if(!parsePLYType(tokens[1], prop.type))
+					throw glare::Exception("Invalid property type '" + tokens[1] + "' in PLY header.");
+				prop.name = tokens[2];
+			}
+			else
+				throw glare::Exception("Invalid property line in PLY header.");
+			header.elements.back().properties.push_back(prop);
+		}
+		// Other lines, such as comment and obj_info lines, and any keywords from extensions to the format, are ignored.
+	}
+
+	if(!have_format)
+		throw glare::Exception("PLY header has no format line.");
+	header.body_offset = parser.currentPos();
+
+	header.vertex_element = -1;
+	header.face_element = -1;
+	for(size_t e=0; e<header.elements.size(); ++e)
+	{
+		PLYElement& element = header.elements[e];
+
+		element.fixed_size = 0;
+		for(size_t p=0; p<element.properties.size(); ++p)
+		{
+			if(element.properties[p].is_list)
+			{
+				element.fixed_size = 0;
+				break;
+			}
+			element.fixed_size += plyTypeSize(element.properties[p].type);
+		}
+
+		if(element.name == "vertex" && header.vertex_element == -1)
+		{
+			const char* const pos_names[3] = { "x", "y", "z" };
+			int num_found = 0;
+			for(int c=0; c<3; ++c)
+				for(size_t p=0; p<element.properties.size(); ++p)
+					if(!element.properties[p].is_list && element.properties[p].name == pos_names[c])
+					{
+						header.pos_props[c] = (int)p;
+						num_found++;
+						break;
+					}
+			if(num_found == 3)
+				header.vertex_element = (int)e;
+		}
+		else if(element.name == "face" && header.face_element == -1)
+		{
+			for(size_t p=0; p<element.properties.size(); ++p)
+				if(element.properties[p].is_list && (element.properties[p].name == "vertex_indices" || element.properties[p].name == "vertex_index"))
+				{
+					header.face_element = (int)e;
+					header.face_indices_prop = (int)p;
+					break;
+				}
+		}
+	}
+}
+
+
+inline double readPLYValue(const uint8* p, PLYType type, bool swap_endianness)
+{
+	uint8 buf[8];
+	const size_t size = plyTypeSize(type);
+	if(swap_endianness)
+	{
+		for(size_t i=0; i<size; ++i)
+			buf[i] = p[size - 1 - i];
+	}
+	else
+		std::memcpy(buf, p, size);
+
+	switch(type)
+	{
+	case PLYType_Int8:    { int8 x;   std::memcpy(&x, buf, sizeof(x)); return x; }
+	case PLYType_UInt8:   { uint8 x;  std::memcpy(&x, buf, sizeof(x)); return x; }
+	case PLYType_Int16:   { int16 x;  std::memcpy(&x, buf, sizeof(x)); return x; }
+	case PLYType_UInt16:  { uint16 x; std::memcpy(&x, buf, sizeof(x)); return x; }
+	case PLYType_Int32:   { int32 x;  std::memcpy(&x, buf, sizeof(x)); return x; }
+	case PLYType_UInt32:  { uint32 x; std::memcpy(&x, buf, sizeof(x)); return x; }
+	case PLYType_Float32: { float x;  std::memcpy(&x, buf, sizeof(x)); return x; }
+	default:              { double x; std::memcpy(&x, buf, sizeof(x)); return x; }
+	}
+}
+
+
+// Returns the value converted to a vertex index, or throws glare::Exception if it isn't a valid one.
+inline uint32 toPLYVertexIndex(double x)
+{
+	if(!(x >= 0 && x < 4294967296.0))
+		throw glare::Exception("Invalid vertex index.");
+	return (uint32)x;
+}
+
+
+// Returns a pointer to the end of the binary element starting at p, or throws glare::Exception if it extends past end.
+inline const uint8* skipBinaryPLYElement(const PLYElement& element, const uint8* p, const uint8* end, bool swap_endianness)
+{
+	if(element.fixed_size != 0)
+	{
+		if((size_t)(end - p) < element.fixed_size)
+			throw glare::Exception("Unexpected end of file.");
+		return p + element.fixed_size;
+	}
+
+	for(size_t i=0; i<element.properties.size(); ++i)
+	{
+		const PLYProperty& prop = element.properties[i];
+		if(prop.is_list)
+		{
+			const size_t count_size = plyTypeSize(prop.list_count_type);
+			if((size_t)(end - p) < count_size)
+				throw glare::Exception("Unexpected end of file.");
+			const double count = readPLYValue(p, prop.list_count_type, swap_endianness);
+			if(count < 0)
+				throw glare::Exception("Invalid list length.");
+			p += count_size;
+			if((double)(end - p) < count * plyTypeSize(prop.type))
+				throw glare::Exception("Unexpected end of file.");
+			p += (size_t)count * plyTypeSize(prop.type);
+		}
+		else
+		{
+			if((size_t)(end - p) < plyTypeSize(prop.type))
+				throw glare::Exception("Unexpected end of file.");
+			p += plyTypeSize(prop.type);
+		}
+	}
+	return p;
+}
+
+
+// A part of the body, parsed by a single task.
+struct PLYRange
+{
+	const uint8* data;
+	size_t data_size;
+
+	// For binary files, a range covers instances [begin_instance, end_instance) of a single element, and data points to the first of them.
+	size_t element_index;
+	uint64 begin_instance, end_instance;
+
+	// For ASCII files with one element per line, a range covers whole lines, which may be in several elements.  Lines with only whitespace are ignored.
+	// Otherwise there is a single range covering the whole body.
+	uint64 num_data_lines;
+	uint64 first_data_line; // The number of non-empty lines before this range in the body.
+
+	js::Vector<uint32, 16> tri_vert_indices; // 3 per triangle, for faces in this range.  Faces with more than 3 vertices are triangulated as fans.
+
+	bool error;
+	std::string error_msg;
+};
+
+
+struct PLYParseContext
+{
+	const PLYHeader* header;
+	bool ascii_one_element_per_line; // For ASCII files: does each non-blank line of the body hold exactly one element?
+	Vec3f* positions;
+	float scale;
+	bool swap_endianness;
+};
+
+
+inline bool isBlankPLYLine(const char* line, size_t line_len)
+{
+	for(size_t i=0; i<line_len; ++i)
+		if(!isWhitespace(line[i]))
+			return false;
+	return true;
+}
+
+
+uint64 countPLYDataLines(const char* text, size_t text_size)
+{
+	uint64 num_lines = 0;
+	size_t line_begin = 0;
+	while(line_begin < text_size)
+	{
+		const char* newline = (const char*)std::memchr(text + line_begin, '\n', text_size - line_begin);
+		const size_t line_end = newline ? (newline - text) : text_size;
+		if(!isBlankPLYLine(text + line_begin, line_end - line_begin))
+			num_lines++;
+		line_begin = line_end + 1;
+	}
+	return num_lines;
+}
+
+
+// Adds the triangles of a face with the given vertex indices.  Faces with more than 3 vertices are triangulated as a fan around the first vertex.
+// Call for each vertex of the face in turn, with i the vertex's position in the face.
+inline void addPLYFaceVertex(size_t i, uint32 index, uint32& first_index, uint32& prev_index, js::Vector<uint32, 16>& tri_vert_indices)
+{
+	if(i == 0)
+		first_index = index;
+	else if(i >= 2)
+	{
+		tri_vert_indices.push_back(first_index);
+		tri_vert_indices.push_back(prev_index);
+		tri_vert_indices.push_back(index);
+	}
+	prev_index = index;
+}
+
+
+// Parses the values of one element from the parser.  Values are separated by any whitespace, including newlines.
+void parseASCIIPLYElement(const PLYParseContext& context, const PLYElement& element, size_t element_index, uint64 instance, Parser& parser, js::Vector<uint32, 16>& tri_vert_indices)
+{
+	const PLYHeader& header = *context.header;
+	const bool is_vertex = (int)element_index == header.vertex_element;
+	const bool is_face = (int)element_index == header.face_element;
+
+	float pos[3] = { 0, 0, 0 };
+	for(size_t p=0; p<element.properties.size(); ++p)
+	{
+		const PLYProperty& prop = element.properties[p];
+		double value;
+		parser.parseWhiteSpace();
+		if(!parser.parseDouble(value))
+			throw glare::Exception("Failed to parse property '" + prop.name + "'.");
+
+		if(prop.is_list)
+		{
+			if(!(value >= 0 && value <= (double)(parser.getTextSize() - parser.currentPos())))
+				throw glare::Exception("Invalid list length.");
+			const size_t count = (size_t)value;
+			const bool is_face_indices = is_face && (int)p == header.face_indices_prop;
+			uint32 first_index = 0;
+			uint32 prev_index = 0;
+			for(size_t i=0; i<count; ++i)
+			{
+				parser.parseWhiteSpace();
+				if(!parser.parseDouble(value))
+					throw glare::Exception("Failed to parse property '" + prop.name + "'.");
+				if(is_face_indices)
+					addPLYFaceVertex(i, toPLYVertexIndex(value), first_index, prev_index, tri_vert_indices);
+			}
+		}
+		else if(is_vertex)
+		{
+			for(int c=0; c<3; ++c)
+				if((int)p == header.pos_props[c])
+					pos[c] = (float)value;
+		}
+	}
+
+	if(is_vertex)
+		context.positions[instance] = Vec3f(pos[0], pos[1], pos[2]) * context.scale;
+}
+
+
+void parseBinaryPLYElement(const PLYParseContext& context, const PLYElement& element, size_t element_index, uint64 instance, const uint8*& p, const uint8* end, js::Vector<uint32, 16>& tri_vert_indices)
+{
+	const PLYHeader& header = *context.header;
+	const bool swap = context.swap_endianness;
+
+	if((int)element_index == header.vertex_element)
+	{
+		const uint8* const element_begin = p;
+		p = skipBinaryPLYElement(element, p, end, swap);
+
+		// Get the offsets of the position properties.
+		float pos[3];
+		const uint8* prop_p = element_begin;
+		for(size_t i=0; i<element.properties.size(); ++i)
+		{
+			const PLYProperty& prop = element.properties[i];
+			if(prop.is_list)
+			{
+				const double count = readPLYValue(prop_p, prop.list_count_type, swap); // Bounds were checked by skipBinaryPLYElement().
+				prop_p += plyTypeSize(prop.list_count_type) + (size_t)count * plyTypeSize(prop.type);
+			}
+			else
+			{
+				for(int c=0; c<3; ++c)
+					if((int)i == header.pos_props[c])
+						pos[c] = (float)readPLYValue(prop_p, prop.type, swap);
+				prop_p += plyTypeSize(prop.type);
+			}
+		}
+		context.positions[instance] = Vec3f(pos[0], pos[1], pos[2]) * context.scale;
+	}
+	else if((int)element_index == header.face_element)
+	{
+		const uint8* const element_begin = p;
+		p = skipBinaryPLYElement(element, p, end, swap);
+
+		const uint8* prop_p = element_begin;
+		for(size_t i=0; i<element.properties.size(); ++i)
+		{
+			const PLYProperty& prop = element.properties[i];
+			if(prop.is_list)
+			{
+				const size_t count = (size_t)readPLYValue(prop_p, prop.list_count_type, swap);
+				prop_p += plyTypeSize(prop.list_count_type);
+				if((int)i == header.face_indices_prop)
+				{
+					uint32 first_index = 0;
+					uint32 prev_index = 0;
+					for(size_t z=0; z<count; ++z)
+						addPLYFaceVertex(z, toPLYVertexIndex(readPLYValue(prop_p + z * plyTypeSize(prop.type), prop.type, swap)), first_index, prev_index, tri_vert_indices);
+				}
+				prop_p += count * plyTypeSize(prop.type);
+			}
+			else
+				prop_p += plyTypeSize(prop.type);
+		}
+	}
+	else
+		p = skipBinaryPLYElement(element, p, end, swap);
+}
+
+
+void doParsePLYRange(const PLYParseContext& context, PLYRange& range)
+{
+	const PLYHeader& header = *context.header;
+
+	if(header.format == PLYFormat_ASCII && !context.ascii_one_element_per_line)
+	{
+		// Parse the whole body as a single stream of values.
+		assert(range.data_size == 0 || range.first_data_line == 0);
+		Parser parser((const char*)range.data, range.data_size);
+		for(size_t e=0; e<header.elements.size(); ++e)
+			for(uint64 instance=0; instance<header.elements[e].count; ++instance)
+			{
+				try
+				{
+					parseASCIIPLYElement(context, header.elements[e], e, instance, parser, range.tri_vert_indices);
+				}
+				catch(glare::Exception& ex)
+				{
+					throw glare::Exception("Error parsing " + header.elements[e].name + " " + toString(instance) + ": " + ex.what());
+				}
+			}
+
+		parser.parseWhiteSpace();
+		if(parser.notEOF())
+			throw glare::Exception("Unexpected data after the last element.");
+	}
+	else if(header.format == PLYFormat_ASCII)
+	{
+		// Find the element and instance of the first line.
+		size_t e = 0;
+		uint64 instance = range.first_data_line;
+		while(e < header.elements.size() && instance >= header.elements[e].count)
+		{
+			instance -= header.elements[e].count;
+			e++;
+		}
+
+		const char* const text = (const char*)range.data;
+		size_t line_begin = 0;
+		while(line_begin < range.data_size)
+		{
+			const char* newline = (const char*)std::memchr(text + line_begin, '\n', range.data_size - line_begin);
+			const size_t line_end = newline ? (newline - text) : range.data_size;
+			if(!isBlankPLYLine(text + line_begin, line_end - line_begin))
+			{
+				assert(e < header.elements.size()); // The line count matched the number of elements.
+				try
+				{
+					Parser parser(text + line_begin, line_end - line_begin);
+					parseASCIIPLYElement(context, header.elements[e], e, instance, parser, range.tri_vert_indices);
+					parser.parseWhiteSpace();
+					if(parser.notEOF())
+						throw glare::Exception("Unexpected data at end of line.");
+				}
+				catch(glare::Exception& ex)
+				{
+					throw glare::Exception("Error parsing " + header.elements[e].name + " " + toString(instance) + ": " + ex.what());
+				}
+
+				instance++;
+				while(e < header.elements.size() && instance >= header.elements[e].count)
+				{
+					instance = 0;
+					e++;
+				}
+			}
+			line_begin = line_end + 1;
+		}
+	}
+	else
+	{
+		const PLYElement& element = header.elements[range.element_index];
+		const uint8* p = range.data;
+		const uint8* const end = range.data + range.data_size;
+		for(uint64 instance = range.begin_instance; instance < range.end_instance; ++instance)
+		{
+			try
+			{
+				parseBinaryPLYElement(context, element, range.element_index, instance, p, end, range.tri_vert_indices);
+			}
+			catch(glare::Exception& ex)
+			{
+				throw glare::Exception("Error parsing " + element.name + " " + toString(instance) + ": " + ex.what());
+			}
+		}
+	}
+}
 
-	//PlyMesh* current_mesh = static_cast<PlyMesh*>(pointer_usrdata);
-	//assert(current_mesh);
-	Indigo::Mesh* handler =  static_cast<Indigo::Mesh*>(pointer_usrdata);
+
+void parsePLYRange(const PLYParseContext& context, PLYRange& range)
+{
+	try
+	{
+		doParsePLYRange(context, range);
+	}
+	catch(glare::Exception& e)
+	{
+		range.error = true;
+		range.error_msg = e.what();
+	}
+}
 
 
-	//get current tri index
-	long tri_index;
-	ply_get_argument_element(argument, NULL, &tri_index);
+class CountPLYLinesTask : public glare::Task
+{
+public:
+	virtual void run(size_t /*thread_index*/) override
+	{
+		range->num_data_lines = countPLYDataLines((const char*)range->data, range->data_size);
+	}
 
+	PLYRange* range;
+};
 
-	long length, value_index;
-    ply_get_argument_property(argument, NULL, &length, &value_index);
 
-	if(value_index >= 0 && value_index <= 2)
+class ParsePLYRangeTask : public glare::Task
+{
+public:
+	virtual void run(size_t /*thread_index*/) override
 	{
-		//current_mesh->tris[tri_index].vert_indices[value_index] = (int)ply_get_argument_value(argument);
+		parsePLYRange(*context, *range);
+	}
 
-		current_vert_indices[value_index] = (unsigned int)ply_get_argument_value(argument);
+	const PLYParseContext* context;
+	PLYRange* range;
+};
 
-		if(value_index == 2)
+
+void parsePLYRanges(const PLYParseContext& context, std::vector<PLYRange>& ranges, glare::TaskManager* task_manager)
+{
+	if(task_manager && ranges.size() > 1)
+	{
+		glare::TaskGroupRef group = new glare::TaskGroup();
+		for(size_t i=0; i<ranges.size(); ++i)
 		{
-			const unsigned int mat_index = 0;
-			const unsigned int uv_indices[] = {0, 0, 0};
-			handler->addTriangle(current_vert_indices, uv_indices, mat_index);
+			Reference<ParsePLYRangeTask> task = new ParsePLYRangeTask();
+			task->context = &context;
+			task->range = &ranges[i];
+			group->tasks.push_back(task);
 		}
+		task_manager->runTaskGroup(group);
+	}
+	else
+	{
+		for(size_t i=0; i<ranges.size(); ++i)
+			parsePLYRange(context, ranges[i]);
 	}
+}
+
 
-    return 1;
+void addPLYRange(std::vector<PLYRange>& ranges, const uint8* data, size_t data_size, size_t element_index, uint64 begin_instance, uint64 end_instance)
+{
+	ranges.push_back(PLYRange());
+	PLYRange& range = ranges.back();
+	range.data = data;
+	range.data_size = data_size;
+	range.element_index = element_index;
+	range.begin_instance = begin_instance;
+	range.end_instance = end_instance;
+	range.num_data_lines = 0;
+	range.first_data_line = 0;
+	range.error = false;
 }
 
 
-void FormatDecoderPLY::streamModel(const std::string& pathname, Indigo::Mesh& handler, float scale)
+// Splits the body into about num_ranges ranges and parses them, in parallel if task_manager is non-null.  Then adds the vertices and
+// triangles to the handler in file order.
+void loadModelFromBufferInRanges(const uint8* data, size_t len, Indigo::Mesh& handler, float scale, glare::TaskManager* task_manager, size_t num_ranges)
 {
-	ply_scale = scale;
+	PLYHeader header;
+	parsePLYHeader(data, len, header);
+
+	const uint8* const body = data + header.body_offset;
+	const size_t body_size = len - header.body_offset;
+	const size_t target_range_size = myMax<size_t>(1, body_size / myMax<size_t>(1, num_ranges));
+
+	std::vector<PLYRange> ranges;
+	PLYParseContext context;
+	context.header = &header;
+	context.scale = scale;
+	context.swap_endianness = header.format == PLYFormat_BinaryBigEndian; // Assumes a little-endian host, as elsewhere.
+	context.ascii_one_element_per_line = false;
 
+	if(header.format == PLYFormat_ASCII)
+	{
+		//-------------------------------- Split into ranges of lines and count the lines in each --------------------------------
+		const char* const text = (const char*)body;
+		size_t range_begin = 0;
+		for(size_t i=0; i<num_ranges && range_begin < body_size; ++i)
+		{
+			size_t range_end = body_size;
+			if(i + 1 < num_ranges)
+			{
+				const size_t offset = myMax(range_begin, (size_t)((double)body_size * (i + 1) / num_ranges));
+				const char* newline = (offset < body_size) ? (const char*)std::memchr(text + offset, '\n', body_size - offset) : NULL;
+				range_end = newline ? (newline - text + 1) : body_size;
+			}
+			if(range_end > range_begin)
+			{
+				addPLYRange(ranges, body + range_begin, range_end - range_begin, /*element index=*/0, 0, 0);
+			}
+			range_begin = range_end;
+		}
+
+		if(task_manager && ranges.size() > 1)
+		{
+			glare::TaskGroupRef group = new glare::TaskGroup();
+			for(size_t i=0; i<ranges.size(); ++i)
+			{
+				Reference<CountPLYLinesTask> task = new CountPLYLinesTask();
+				task->range = &ranges[i];
+				group->tasks.push_back(task);
+			}
+			task_manager->runTaskGroup(group);
+		}
+		else
+		{
+			for(size_t i=0; i<ranges.size(); ++i)
+				ranges[i].num_data_lines = countPLYDataLines((const char*)ranges[i].data, ranges[i].data_size);
+		}
+
+		uint64 num_data_lines = 0;
+		for(size_t i=0; i<ranges.size(); ++i)
+		{
+			ranges[i].first_data_line = num_data_lines;
+			num_data_lines += ranges[i].num_data_lines;
+		}
+
+		// Values may be split over lines in any way, but almost all files have one element per line, in which case the line counts
+		// give the element each range starts at.  Otherwise parse the body as a single range.
+		uint64 num_elements = 0;
+		bool too_many_elements = false;
+		for(size_t e=0; e<header.elements.size(); ++e)
+		{
+			too_many_elements = too_many_elements || (header.elements[e].count > std::numeric_limits<uint64>::max() - num_elements);
+			num_elements += header.elements[e].count;
+		}
+
+		context.ascii_one_element_per_line = !too_many_elements && (num_data_lines == num_elements);
+		if(!context.ascii_one_element_per_line)
+		{
+			ranges.clear();
+			addPLYRange(ranges, body, body_size, /*element index=*/0, 0, 0);
+		}
+	}
+	else
+	{
+		//-------------------------------- Split the vertex and face elements into ranges --------------------------------
+		const uint8* p = body;
+		const uint8* const end = body + body_size;
+		for(size_t e=0; e<header.elements.size(); ++e)
+		{
+			const PLYElement& element = header.elements[e];
+			const bool parse_element = (int)e == header.vertex_element || (int)e == header.face_element;
+
+			if(element.fixed_size != 0)
+			{
+				if((uint64)(end - p) / element.fixed_size < element.count)
+					throw glare::Exception("Unexpected end of file while reading " + element.name + " elements.");
+
+				if(parse_element)
+				{
+					const uint64 instances_per_range = myMax<uint64>(1, target_range_size / element.fixed_size);
+					for(uint64 i=0; i<element.count; i += instances_per_range)
+					{
+						const uint64 range_end = myMin(element.count, i + instances_per_range);
+						addPLYRange(ranges, p + i * element.fixed_size, (size_t)(range_end - i) * element.fixed_size, e, i, range_end);
+					}
+				}
+				p += element.count * element.fixed_size;
+			}
+			else
+			{
+				// The element sizes vary, so scan through the elements to find where each range starts.
+				const uint8* range_begin = p;
+				uint64 range_begin_instance = 0;
+				for(uint64 i=0; i<element.count; ++i)
+				{
+					try
+					{
+						p = skipBinaryPLYElement(element, p, end, context.swap_endianness);
+					}
+					catch(glare::Exception& ex)
+					{
+						throw glare::Exception("Error parsing " + element.name + " " + toString(i) + ": " + ex.what());
+					}
+
+					if(parse_element && ((size_t)(p - range_begin) >= target_range_size || i + 1 == element.count))
+					{
+						addPLYRange(ranges, range_begin, p - range_begin, e, range_begin_instance, i + 1);
+						range_begin = p;
+						range_begin_instance = i + 1;
+					}
+				}
+			}
+		}
+	}
+
+	//-------------------------------- Parse the ranges --------------------------------
+	const uint64 num_verts = (header.vertex_element >= 0) ? header.elements[header.vertex_element].count : 0;
+	if(num_verts > (uint64)std::numeric_limits<uint32>::max())
+		throw glare::Exception("Too many vertices.");
+	js::Vector<Vec3f, 16> positions((size_t)num_verts);
+	context.positions = positions.data();
+
+	parsePLYRanges(context, ranges, task_manager);
+
+	if(header.format == PLYFormat_ASCII && context.ascii_one_element_per_line)
+	{
+		bool error = false;
+		for(size_t i=0; i<ranges.size(); ++i)
+			error = error || ranges[i].error;
+
+		// The line count can match the element count even if some elements span lines, if other lines hold several elements.  So
+		// if parsing line by line failed, parse the body as a single range instead, which also gives the same error message however the body was split.
+		if(error)
+		{
+			context.ascii_one_element_per_line = false;
+			ranges.clear();
+			addPLYRange(ranges, body, body_size, /*element index=*/0, 0, 0);
+			parsePLYRanges(context, ranges, /*task manager=*/NULL);
+		}
+	}
+
+	// Report the first error in the file.
+	for(size_t i=0; i<ranges.size(); ++i)
+		if(ranges[i].error)
+			throw glare::Exception(ranges[i].error_msg);
+
+	//-------------------------------- Add to handler --------------------------------
 	handler.setMaxNumTexcoordSets(0);
 	handler.addMaterialUsed("default");
-	//handler.addUVSetExposition("default", 0);
 
+	handler.vert_positions.reserve(positions.size());
+	for(size_t i=0; i<positions.size(); ++i)
+		handler.addVertex(positions[i]);
 
-	p_ply ply = ply_open(pathname.c_str(), NULL, 0, NULL);
+	size_t num_tris = 0;
+	for(size_t i=0; i<ranges.size(); ++i)
+		num_tris += ranges[i].tri_vert_indices.size() / 3;
+	handler.triangles.reserve(num_tris);
 
-    if(!ply) 
-		throw glare::Exception("could not open file '" + pathname + "' for reading.");
-    
-	if(!ply_read_header(ply))
-		throw glare::Exception("could not read header.");
-		
-    //const long nvertices =
-	ply_set_read_cb(ply, "vertex", "x", vertex_callback, &handler, 0);
+	const uint32 uv_indices[] = {0, 0, 0};
+	const uint32 mat_index = 0;
+	for(size_t i=0; i<ranges.size(); ++i)
+	{
+		const js::Vector<uint32, 16>& tri_vert_indices = ranges[i].tri_vert_indices;
+		for(size_t t=0; t<tri_vert_indices.size(); t += 3)
+		{
+			if(tri_vert_indices[t] >= num_verts || tri_vert_indices[t + 1] >= num_verts || tri_vert_indices[t + 2] >= num_verts)
+				throw glare::Exception("Face vertex index out of bounds.");
+			handler.addTriangle(&tri_vert_indices[t], uv_indices, mat_index);
+		}
+	}
 
-	//mesh_out.verts.resize(nvertices);
+	handler.endOfModel();
+}
 
-    ply_set_read_cb(ply, "vertex", "y", vertex_callback, &handler, 1);
-    ply_set_read_cb(ply, "vertex", "z", vertex_callback, &handler, 2);
 
-    //const long ntriangles = 
-	ply_set_read_cb(ply, "face", "vertex_indices", face_callback, &handler, 0);
+} // end anonymous namespace
 
-	//mesh_out.tris.resize(ntriangles);
-	
-    if(!ply_read(ply)) 
-		throw glare::Exception("read of body failed.");
 
-    ply_close(ply);
+void FormatDecoderPLY::loadModelFromBuffer(const uint8* data, size_t len, Indigo::Mesh& handler, float scale, glare::TaskManager* task_manager)
+{
+	try
+	{
+		// As for OBJ files, use several ranges per thread, each big enough that the per-range overhead is negligible.
+		const size_t min_range_size = 1 << 20;
+		const size_t num_ranges = task_manager ? myMax<size_t>(1, myMin(task_manager->getConcurrency() * 4, len / min_range_size)) : 1;
 
-	handler.endOfModel();
+		loadModelFromBufferInRanges(data, len, handler, scale, task_manager, num_ranges);
+	}
+	catch(Indigo::IndigoException& e)
+	{
+		throw glare::Exception(toStdString(e.what()));
+	}
 }
+
+
+#if BUILD_TESTS
+
+
+#include "../utils/TestUtils.h"
+#include "../utils/ConPrint.h"
+#include "../utils/FileUtils.h"
+#include "../utils/Timer.h"
+
+
+static void appendPLYValue(std::string& s, PLYFormat format, PLYType type, double x)
+{
+	if(format == PLYFormat_ASCII)
+	{
+		s += ((type == PLYType_Float32 || type == PLYType_Float64) ? toString(x) : toString((int64)x)) + " ";
+		return;
+	}
+
+	uint8 buf[8];
+	switch(type)
+	{
+	case PLYType_Int8:    { const int8 v = (int8)x;     std::memcpy(buf, &v, sizeof(v)); break; }
+	case PLYType_UInt8:   { const uint8 v = (uint8)x;   std::memcpy(buf, &v, sizeof(v)); break; }
+	case PLYType_Int16:   { const int16 v = (int16)x;   std::memcpy(buf, &v, sizeof(v)); break; }
+	case PLYType_UInt16:  { const uint16 v = (uint16)x; std::memcpy(buf, &v, sizeof(v)); break; }
+	case PLYType_Int32:   { const int32 v = (int32)x;   std::memcpy(buf, &v, sizeof(v)); break; }
+	case PLYType_UInt32:  { const uint32 v = (uint32)x; std::memcpy(buf, &v, sizeof(v)); break; }
+	case PLYType_Float32: { const float v = (float)x;   std::memcpy(buf, &v, sizeof(v)); break; }
+	default:              { const double v = x;         std::memcpy(buf, &v, sizeof(v)); break; }
+	}
+	const size_t size = plyTypeSize(type);
+	for(size_t i=0; i<size; ++i)
+		s.push_back((char)buf[format == PLYFormat_BinaryBigEndian ? (size - 1 - i) : i]);
+}
+
+
+// Makes a PLY file with a grid of grid_res x grid_res quads, some of them split into triangles, so 2 * grid_res * grid_res triangles are loaded.  There is an element with a list
+// before the vertices, to test finding the vertex data in binary files, and extra properties, including a list after the vertex indices.
+static std::string makeTestPLY(PLYFormat format, int grid_res)
+{
+	const int verts_per_row = grid_res + 1;
+	const int num_faces = grid_res * grid_res + (grid_res * grid_res + 2) / 3; // Every third quad is split into two triangles.
+
+	std::string s = "ply\n";
+	s += std::string("format ") + (format == PLYFormat_ASCII ? "ascii" : (format == PLYFormat_BinaryLittleEndian ? "binary_little_endian" : "binary_big_endian")) + " 1.0\n";
+	s += "comment test file\n";
+	s += "element material 2\nproperty list uchar float values\n";
+	s += "element vertex " + toString(verts_per_row * verts_per_row) + "\nproperty float x\nproperty double y\nproperty float z\nproperty uchar red\n";
+	s += "element face " + toString(num_faces) + "\nproperty short flags\nproperty list uchar uint vertex_indices\nproperty list uchar float texcoord\n";
+	s += "end_header\n";
+
+	for(int m=0; m<2; ++m)
+	{
+		appendPLYValue(s, format, PLYType_UInt8, 1 + m);
+		for(int i=0; i<1 + m; ++i)
+			appendPLYValue(s, format, PLYType_Float32, i * 0.5);
+		if(format == PLYFormat_ASCII) s += "\n";
+	}
+
+	for(int y=0; y<verts_per_row; ++y)
+		for(int x=0; x<verts_per_row; ++x)
+		{
+			appendPLYValue(s, format, PLYType_Float32, x * 0.25);
+			appendPLYValue(s, format, PLYType_Float64, y * 0.25);
+			appendPLYValue(s, format, PLYType_Float32, ((x * 7 + y * 3) % 11) * 0.125);
+			appendPLYValue(s, format, PLYType_UInt8, (x + y) % 256);
+			if(format == PLYFormat_ASCII) s += "\n";
+			if(format == PLYFormat_ASCII && x % 50 == 0) s += "  \n"; // Blank lines should be ignored.
+		}
+
+	int num_faces_written = 0;
+	for(int y=0; y<grid_res; ++y)
+		for(int x=0; x<grid_res; ++x)
+		{
+			const int corners[4] = { y * verts_per_row + x, y * verts_per_row + x + 1, (y + 1) * verts_per_row + x + 1, (y + 1) * verts_per_row + x };
+			const int num_tris = ((y * grid_res + x) % 3 == 0) ? 2 : 1;
+			for(int t=0; t<num_tris; ++t)
+			{
+				appendPLYValue(s, format, PLYType_Int16, -t);
+				if(num_tris == 2)
+				{
+					appendPLYValue(s, format, PLYType_UInt8, 3);
+					appendPLYValue(s, format, PLYType_UInt32, corners[0]);
+					appendPLYValue(s, format, PLYType_UInt32, corners[t + 1]);
+					appendPLYValue(s, format, PLYType_UInt32, corners[t + 2]);
+				}
+				else
+				{
+					appendPLYValue(s, format, PLYType_UInt8, 4); // Loaded as two triangles.
+					for(int i=0; i<4; ++i)
+						appendPLYValue(s, format, PLYType_UInt32, corners[i]);
+				}
+				appendPLYValue(s, format, PLYType_UInt8, x % 3);
+				for(int i=0; i<x % 3; ++i)
+					appendPLYValue(s, format, PLYType_Float32, i);
+				if(format == PLYFormat_ASCII) s += "\n";
+				num_faces_written++;
+			}
+		}
+	assert(num_faces_written == num_faces);
+	return s;
+}
+
+
+// Loads the file split into various numbers of ranges, with and without a task manager, and checks the result is the same as for a single range,
+// or that the same exception is thrown.  Returns the checksum of the loaded mesh.
+static uint64 testRangedLoadMatchesSequentialLoad(const std::string& ply, glare::TaskManager& task_manager)
+{
+	std::string ref_excep_msg;
+	uint64 ref_checksum = 0;
+	try
+	{
+		Indigo::Mesh mesh;
+		loadModelFromBufferInRanges((const uint8*)ply.data(), ply.size(), mesh, 1.f, /*task manager=*/NULL, /*num ranges=*/1);
+		ref_checksum = mesh.checksum();
+	}
+	catch(glare::Exception& e)
+	{
+		ref_excep_msg = e.what();
+	}
+
+	const size_t range_counts[] = { 2, 3, 7, 64, 1000 };
+	for(size_t z=0; z<staticArrayNumElems(range_counts); ++z)
+		for(int use_task_manager=0; use_task_manager<2; ++use_task_manager)
+		{
+			try
+			{
+				Indigo::Mesh mesh;
+				loadModelFromBufferInRanges((const uint8*)ply.data(), ply.size(), mesh, 1.f, use_task_manager ? &task_manager : NULL, range_counts[z]);
+				testAssert(ref_excep_msg.empty());
+				testAssert(mesh.checksum() == ref_checksum);
+			}
+			catch(glare::Exception& e)
+			{
+				testEqual(std::string(e.what()), ref_excep_msg);
+			}
+		}
+
+	return ref_checksum;
+}
+
+
+static void testPLYLoadFails(const std::string& ply, glare::TaskManager& task_manager)
+{
+	try
+	{
+		Indigo::Mesh mesh;
+		loadModelFromBufferInRanges((const uint8*)ply.data(), ply.size(), mesh, 1.f, /*task manager=*/NULL, /*num ranges=*/1);
+		failTest("Expected exception");
+	}
+	catch(glare::Exception&)
+	{}
+
+	testRangedLoadMatchesSequentialLoad(ply, task_manager);
+}
+
+
+void FormatDecoderPLY::test()
+{
+	conPrint("FormatDecoderPLY::test()");
+
+	glare::TaskManager task_manager;
+
+	try
+	{
+		//=================================== Test loading a file from disk =====================================
+		{
+			const std::string path = TestUtils::getTestReposDir() + "/testfiles/bun_zipper.ply";
+
+			Indigo::Mesh mesh;
+			streamModel(path, mesh, 2.f, &task_manager);
+			testAssert(mesh.vert_positions.size() == 35947);
+			testAssert(mesh.triangles.size() == 69451);
+			testAssert(mesh.vert_positions[0] == Vec3f(-0.0378297f, 0.12794f, 0.00447467f) * 2.f);
+			testAssert(mesh.triangles[0].vertex_indices[0] == 21216 && mesh.triangles[0].vertex_indices[1] == 21215 && mesh.triangles[0].vertex_indices[2] == 20399);
+			testAssert(mesh.triangles.back().vertex_indices[0] == 17277 && mesh.triangles.back().vertex_indices[1] == 17346 && mesh.triangles.back().vertex_indices[2] == 17345);
+			testAssert(mesh.used_materials.size() == 1);
+
+			const std::string contents = FileUtils::readEntireFile(path);
+			testRangedLoadMatchesSequentialLoad(contents, task_manager);
+		}
+
+		//=================================== Test the formats give the same results =====================================
+		{
+			const int grid_res = 40;
+			const uint64 ascii_checksum   = testRangedLoadMatchesSequentialLoad(makeTestPLY(PLYFormat_ASCII, grid_res), task_manager);
+			const uint64 le_checksum      = testRangedLoadMatchesSequentialLoad(makeTestPLY(PLYFormat_BinaryLittleEndian, grid_res), task_manager);
+			const uint64 be_checksum      = testRangedLoadMatchesSequentialLoad(makeTestPLY(PLYFormat_BinaryBigEndian, grid_res), task_manager);
+			testAssert(ascii_checksum == le_checksum);
+			testAssert(ascii_checksum == be_checksum);
+
+			const std::string ply = makeTestPLY(PLYFormat_BinaryBigEndian, grid_res);
+			Indigo::Mesh mesh;
+			loadModelFromBufferInRanges((const uint8*)ply.data(), ply.size(), mesh, 1.f, &task_manager, /*num ranges=*/16);
+			testAssert(mesh.vert_positions.size() == (grid_res + 1) * (grid_res + 1));
+			testAssert(mesh.vert_positions[(grid_res + 1) * 2 + 3] == Vec3f(0.75f, 0.5f, ((3 * 7 + 2 * 3) % 11) * 0.125f));
+			testAssert(mesh.triangles.size() == 2 * grid_res * grid_res);
+			for(size_t i=0; i<mesh.triangles.size(); ++i) // Each triangle should be within a single grid cell.
+			{
+				const Vec3f& v0 = mesh.vert_positions[mesh.triangles[i].vertex_indices[0]];
+				for(int c=1; c<3; ++c)
+				{
+					const Vec3f& v = mesh.vert_positions[mesh.triangles[i].vertex_indices[c]];
+					testAssert(v.x - v0.x >= 0 && v.x - v0.x <= 0.25f && v.y - v0.y >= 0 && v.y - v0.y <= 0.25f);
+				}
+			}
+		}
+
+		//=================================== Test ASCII files without one element per line, polygons, and unknown header keywords =====================================
+		{
+			const std::string header = "ply\nformat ascii 1.0\nmade_up_keyword 1 2\nelement vertex 5\nproperty float x\nproperty float y\nproperty float z\n"
+				"element face 1\nproperty list uchar int vertex_indices\nend_header\n";
+			const std::string bodies[] = {
+				"0 0 0 1 0\n0\n1 1 0 0 1 0\n0.5 2 0\n5 0 1 2 3 4\n", // Fewer lines than elements
+				"0 0 0 1 0 0 1\n1 0\n0 1 0 0.5\n2 0\n5\n0 1 2 3 4\n" // As many lines as elements, but not one element per line
+			};
+			for(size_t i=0; i<staticArrayNumElems(bodies); ++i)
+			{
+				const std::string ply = header + bodies[i];
+				testRangedLoadMatchesSequentialLoad(ply, task_manager);
+
+				Indigo::Mesh mesh;
+				loadModelFromBuffer((const uint8*)ply.data(), ply.size(), mesh, 1.f, &task_manager);
+				testAssert(mesh.vert_positions.size() == 5);
+				testAssert(mesh.vert_positions[2] == Vec3f(1, 1, 0));
+				testAssert(mesh.vert_positions[4] == Vec3f(0.5f, 2, 0));
+
+				// The pentagon should be triangulated as a fan.
+				testAssert(mesh.triangles.size() == 3);
+				for(uint32 t=0; t<3; ++t)
+					testAssert(mesh.triangles[t].vertex_indices[0] == 0 && mesh.triangles[t].vertex_indices[1] == t + 1 && mesh.triangles[t].vertex_indices[2] == t + 2);
+			}
+
+			testPLYLoadFails(header + bodies[0] + "1\n", task_manager); // Extra value after the last element
+			testPLYLoadFails(header + "0 0 0 1 0\n0\n1 1 0 0 1 0\n0.5 2 0\n5 0 1 2 3\n", task_manager); // Missing value
+		}
+
+		//=================================== Test invalid files =====================================
+		{
+			const std::string ascii = makeTestPLY(PLYFormat_ASCII, 20);
+			const std::string binary = makeTestPLY(PLYFormat_BinaryLittleEndian, 20);
+
+			testPLYLoadFails(ascii.substr(0, ascii.size() - 100), task_manager); // Truncated
+			testPLYLoadFails(binary.substr(0, binary.size() - 1), task_manager);
+			testPLYLoadFails(binary.substr(0, binary.size() / 2), task_manager);
+			const size_t line_start = ascii.find('\n', ascii.size() / 2) + 1;
+			testPLYLoadFails(ascii.substr(0, line_start) + "1 2 3 4 5 6\n" + ascii.substr(line_start), task_manager); // Extra line
+			testPLYLoadFails(ascii.substr(0, ascii.size() / 2) + " x" + ascii.substr(ascii.size() / 2), task_manager);
+			testPLYLoadFails("ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\nproperty float y\nproperty float z\nelement face 1\nproperty list uchar int vertex_indices\nend_header\n0 0 0\n3 0 0 1\n", task_manager); // Index out of bounds
+			testPLYLoadFails("ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\nproperty float y\nproperty float z\nelement face 1\nproperty list uchar int vertex_indices\nend_header\n0 0 0\n3 0 0 -1\n", task_manager);
+			testPLYLoadFails("ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\nproperty float y\nproperty float z\n", task_manager); // No end_header
+			testPLYLoadFails("ply\nformat binary_middle_endian 1.0\nend_header\n", task_manager);
+			testPLYLoadFails("ply\nformat ascii 1.0\nelement vertex 1\nproperty int128 x\nend_header\n", task_manager);
+			testPLYLoadFails("ply\nformat ascii 1.0\nelement vertex -1\nend_header\n", task_manager);
+			testPLYLoadFails("ply\nformat binary_little_endian 1.0\nelement vertex 100000000000000000\nproperty float x\nproperty float y\nproperty float z\nend_header\n", task_manager);
+			testPLYLoadFails("", task_manager);
+		}
+
+		//=================================== Measure parse speed =====================================
+		{
+			// Use a grid_res of around 6000 to test multi-GB files.
+			const int grid_res = 300;
+			const PLYFormat formats[] = { PLYFormat_ASCII, PLYFormat_BinaryLittleEndian };
+			for(size_t f=0; f<staticArrayNumElems(formats); ++f)
+			{
+				const std::string ply = makeTestPLY(formats[f], grid_res);
+				const double size_MB = ply.size() / (1024.0 * 1024.0);
+				for(int use_task_manager=0; use_task_manager<2; ++use_task_manager)
+				{
+					Indigo::Mesh mesh;
+					Timer timer;
+					loadModelFromBuffer((const uint8*)ply.data(), ply.size(), mesh, 1.f, use_task_manager ? &task_manager : NULL);
+					const double elapsed = timer.elapsed();
+
+					conPrint("Parsed " + doubleToStringNSigFigs(size_MB, 4) + " MB " + (formats[f] == PLYFormat_ASCII ? "ASCII" : "binary") + " PLY " +
+						(use_task_manager ? ("with " + toString(task_manager.getConcurrency()) + " threads") : std::string("single-threaded")) + " in " +
+						doubleToStringNSigFigs(elapsed, 4) + " s (" + doubleToStringNSigFigs(size_MB / elapsed, 4) + " MB/s)");
+				}
+			}
+		}
+	}
+	catch(glare::Exception& e)
+	{
+		failTest(e.what());
+	}
+
+	conPrint("FormatDecoderPLY::test() done.");
+}
+
+
+#endif // BUILD_TESTS
@@ -7,17 +7,41 @@ Code By Nicholas Chapman.
 #pragma once
 
 
+#include "../utils/Platform.h"
 #include <string>
 namespace Indigo { class Mesh; }
+namespace glare { class TaskManager; }
 
 
 /*=====================================================================
 FormatDecoderPLY
 ----------------
+Loads the vertex positions and faces of PLY files.  Faces with more than
+three vertices are triangulated as fans.
 
+streamModel() memory maps the file and uses loadModelFromBuffer(), which 
+splits the body into ranges, and parses them in parallel if task_manager is 
+non-null.
+For binary files, ranges are whole numbers of elements, found directly from the element size for
+elements without list properties, and with a quick scan of the list
+lengths otherwise.  For ASCII files, the body is split at line boundaries,
+the lines in each range are counted in parallel, and a prefix sum over the
+counts gives the element each line belongs to.  That needs one element per 
+line, which is almost always the case.  If the line count shows otherwise, 
+or parsing line by line fails, the body is parsed as a single stream of 
+values instead.
+
+The vertices and triangles are then added to the handler in file order.
+
+Tests are in FormatDecoderPLY::test()
 =====================================================================*/
 class FormatDecoderPLY
 {
 public:
-	static void streamModel(const std::string& filename, Indigo::Mesh& handler, float scale); // Throws glare::Exception on failure.
+	// Multi-thread if task_manager is non-null.
+	static void streamModel(const std::string& filename, Indigo::Mesh& handler, float scale, glare::TaskManager* task_manager = NULL); // Throws glare::Exception on failure.
+
+	static void loadModelFromBuffer(const uint8* data, size_t len, Indigo::Mesh& handler, float scale, glare::TaskManager* task_manager = NULL); // Throws glare::Exception on failure.
+
+	static void test();
 };
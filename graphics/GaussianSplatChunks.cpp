@@ -0,0 +1,743 @@
+/*=====================================================================
+GaussianSplatChunks.cpp
+-----------------------
+Copyright Glare Technologies Limited 2026 -
+=====================================================================*/
+#include "GaussianSplatChunks.h"
+
+
+#include "../maths/Matrix4f.h"
+#include "../maths/Quat.h"
+#include "../utils/Sort.h"
+#include "../utils/Task.h"
+#include "../utils/TaskManager.h"
+#include <algorithm>
+#include <limits>
+
+
+namespace
+{
+
+
+// Spreads the lower 10 bits of x out so that there are two zero bits between each bit, for building Morton codes.
+inline uint32 spreadBits10(uint32 x)
+{
+	x &= 0x3FF;
+	x = (x | (x << 16)) & 0x030000FF;
+	x = (x | (x <<  8)) & 0x0300F00F;
+	x = (x | (x <<  4)) & 0x030C30C3;
+	x = (x | (x <<  2)) & 0x09249249;
+	return x;
+}
+
+
+struct MortonItem
+{
+	uint32 key;
+	uint32 splat_index;
+};
+
+struct MortonItemGetKey { inline uint32 operator () (const MortonItem& item) const { return item.key; } };
+
+
+// The splitting moves the positions around with the splat indices, so that it reads memory sequentially.
+struct SplitItem
+{
+	Vec3f pos;
+	uint32 splat_index;
+};
+
+struct SplitItemAxisLessThan
+{
+	SplitItemAxisLessThan(unsigned int axis_) : axis(axis_) {}
+
+	inline bool operator () (const SplitItem& a, const SplitItem& b) const { return a.pos[axis] < b.pos[axis]; }
+
+	unsigned int axis;
+};
+
+
+// Computes the eigenvalues and eigenvectors of the symmetric 3x3 matrix a, with the cyclic Jacobi method.
+// a is overwritten.  Eigenvector i is column i of v.
+void symmetricEigenDecomposition(double a[3][3], double eigenvalues_out[3], double v[3][3])
+{
+	for(int i=0; i<3; ++i)
+		for(int j=0; j<3; ++j)
+			v[i][j] = (i == j) ? 1.0 : 0.0;
+
+	for(int sweep=0; sweep<32; ++sweep)
+	{
+		const double off_diag = a[0][1]*a[0][1] + a[0][2]*a[0][2] + a[1][2]*a[1][2];
+		const double diag     = a[0][0]*a[0][0] + a[1][1]*a[1][1] + a[2][2]*a[2][2];
+		if(off_diag <= 1.0e-24 * diag)
+			break;
+
+		for(int p=0; p<2; ++p)
+			for(int q=p+1; q<3; ++q)
+			{
+				if(a[p][q] == 0)
+					continue;
+
+				// Compute the rotation that zeroes a[p][q], then apply A' = J^T A J, V' = V J.
+				const double theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+				const double t = (theta >= 0 ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1));
+				const double c = 1 / std::sqrt(t * t + 1);
+				const double s = t * c;
+
+				for(int k=0; k<3; ++k)
+				{
+					const double akp = a[k][p], akq = a[k][q];
+					a[k][p] = c * akp - s * akq;
+					a[k][q] = s * akp + c * akq;
+				}
+				for(int k=0; k<3; ++k)
+				{
+					const double apk = a[p][k], aqk = a[q][k];
+					a[p][k] = c * apk - s * aqk;
+					a[q][k] = s * apk + c * aqk;
+				}
+				for(int k=0; k<3; ++k)
+				{
+					const double vkp = v[k][p], vkq = v[k][q];
+					v[k][p] = c * vkp - s * vkq;
+					v[k][q] = s * vkp + c * vkq;
+				}
+			}
+	}
+
+	for(int i=0; i<3; ++i)
+		eigenvalues_out[i] = a[i][i];
+}
+
+
+// Adds weight * the covariance of the splat to cov.  The covariance is R diag(scale^2) R^T, where R is the splat's rotation matrix.
+inline void addSplatCovariance(const Vec3f& scale, const Vec4f& rot, double weight, double cov[3][3])
+{
+	const Vec4f q = normalise(rot);
+	const Matrix4f R = Quat<float>(q).toMatrix();
+	for(int i=0; i<3; ++i)
+		for(int j=0; j<3; ++j)
+		{
+			double sum = 0;
+			for(int k=0; k<3; ++k)
+				sum += (double)R.elem(i, k) * (double)R.elem(j, k) * ((double)scale[k] * (double)scale[k]);
+			cov[i][j] += weight * sum;
+		}
+}
+
+
+// Area of the splat's largest cross section, up to a constant factor.
+inline float crossSectionArea(const Vec3f& scale)
+{
+	const float smallest = myMin(scale.x, myMin(scale.y, scale.z));
+	return (scale.x * scale.y * scale.z) / myMax(smallest, 1.0e-30f);
+}
+
+
+// Merges the given splats into one, by matching the weighted mean and covariance.  Returns the largest distance from a splat centre to the merged centre.
+template <class SplatSource>
+float mergeSplats(const SplatSource& splat_data, const uint32* indices, size_t num, GaussianSplatData& lod_splats, size_t lod_index)
+{
+	// Load the splats once, since they are generally scattered through the source arrays.
+	Vec3f positions[GaussianSplatChunks::lod_merge_size];
+	Vec3f scales[GaussianSplatChunks::lod_merge_size];
+	Vec4f rotations[GaussianSplatChunks::lod_merge_size];
+	Vec4f colours[GaussianSplatChunks::lod_merge_size];
+	for(size_t i=0; i<num; ++i)
+	{
+		positions[i] = splat_data.getPosition(indices[i]);
+		scales[i]    = splat_data.getScale(indices[i]);
+		rotations[i] = splat_data.getRotation(indices[i]);
+		colours[i]   = splat_data.getColour(indices[i]);
+	}
+
+	// Weight each splat by opacity * area, which is roughly its contribution to the image.
+	double weights[GaussianSplatChunks::lod_merge_size];
+	double weight_sum = 0;
+	for(size_t i=0; i<num; ++i)
+	{
+		weights[i] = (double)myMax(0.f, colours[i][3]) * (double)crossSectionArea(scales[i]);
+		weight_sum += weights[i];
+	}
+
+	// If all the splats are fully transparent or degenerate, just average them.  The merged splat will be transparent anyway.
+	const bool use_uniform_weights = !(weight_sum > 0);
+	if(use_uniform_weights)
+	{
+		for(size_t i=0; i<num; ++i)
+			weights[i] = 1;
+		weight_sum = (double)num;
+	}
+
+	double mean[3] = { 0, 0, 0 };
+	double colour[3] = { 0, 0, 0 };
+	for(size_t i=0; i<num; ++i)
+	{
+		for(int c=0; c<3; ++c)
+		{
+			mean[c]   += weights[i] * positions[i][c];
+			colour[c] += weights[i] * colours[i][c];
+		}
+	}
+	for(int c=0; c<3; ++c)
+	{
+		mean[c]   /= weight_sum;
+		colour[c] /= weight_sum;
+	}
+
+	// The merged covariance is the weighted sum of each splat's covariance plus the outer product of its offset from the mean.
+	double cov[3][3] = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } };
+	float max_dist = 0;
+	for(size_t i=0; i<num; ++i)
+	{
+		addSplatCovariance(scales[i], rotations[i], weights[i], cov);
+
+		const double d[3] = { positions[i].x - mean[0], positions[i].y - mean[1], positions[i].z - mean[2] };
+		for(int r=0; r<3; ++r)
+			for(int c=0; c<3; ++c)
+				cov[r][c] += weights[i] * d[r] * d[c];
+
+		max_dist = myMax(max_dist, (float)std::sqrt(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]));
+	}
+	for(int r=0; r<3; ++r)
+		for(int c=0; c<3; ++c)
+			cov[r][c] /= weight_sum;
+
+	double eigenvalues[3];
+	double V[3][3];
+	symmetricEigenDecomposition(cov, eigenvalues, V);
+
+	// Make the eigenvectors a right-handed basis, so they form a rotation matrix.
+	const double det =
+		V[0][0] * (V[1][1] * V[2][2] - V[2][1] * V[1][2]) -
+		V[0][1] * (V[1][0] * V[2][2] - V[2][0] * V[1][2]) +
+		V[0][2] * (V[1][0] * V[2][1] - V[2][0] * V[1][1]);
+	if(det < 0)
+		for(int r=0; r<3; ++r)
+			V[r][2] = -V[r][2];
+
+	const Matrix4f R(
+		Vec4f((float)V[0][0], (float)V[1][0], (float)V[2][0], 0),
+		Vec4f((float)V[0][1], (float)V[1][1], (float)V[2][1], 0),
+		Vec4f((float)V[0][2], (float)V[1][2], (float)V[2][2], 0),
+		Vec4f(0, 0, 0, 1)
+	);
+
+	const Vec3f scale((float)std::sqrt(myMax(eigenvalues[0], 0.0)), (float)std::sqrt(myMax(eigenvalues[1], 0.0)), (float)std::sqrt(myMax(eigenvalues[2], 0.0)));
+
+	// Choose the opacity so that opacity * area is conserved, up to full opacity.
+	const float opacity = use_uniform_weights ? 0.f : (float)myMin(1.0, weight_sum / myMax((double)crossSectionArea(scale), 1.0e-30));
+
+	lod_splats.positions[lod_index] = Vec3f((float)mean[0], (float)mean[1], (float)mean[2]);
+	lod_splats.scales[lod_index] = scale;
+	lod_splats.rotations[lod_index] = normalise(Quat<float>::fromMatrix(R).v);
+	lod_splats.colours[lod_index] = Vec4f((float)colour[0], (float)colour[1], (float)colour[2], opacity);
+
+	return max_dist;
+}
+
+
+// Puts the splats of chunks [chunks_begin, chunks_end) in Morton order within each chunk, and merges them to make the chunks' coarse LOD splats.
+// The chunks' ranges have already been set by the splitting.
+template <class SplatSource>
+void buildChunkLODs(const SplatSource& splat_data, const SplitItem* items, GaussianSplatChunks& res, size_t chunks_begin, size_t chunks_end)
+{
+	js::Vector<MortonItem, 16> morton_items(GaussianSplatChunks::max_splats_per_chunk);
+	js::Vector<MortonItem, 16> morton_working_space(GaussianSplatChunks::max_splats_per_chunk);
+	js::Vector<uint32, 16> temp_counts(6144); // The size Sort::radixSort32BitKey() requires.
+
+	uint32* const order = res.splat_order.data();
+	const float inf = std::numeric_limits<float>::infinity();
+
+	for(size_t c=chunks_begin; c<chunks_end; ++c)
+	{
+		GaussianSplatChunks::Chunk& chunk = res.chunks[c];
+		const size_t begin = chunk.begin;
+		const size_t chunk_num_splats = chunk.end - chunk.begin;
+
+		Vec3f min_pos(inf), max_pos(-inf);
+		for(size_t i=begin; i<chunk.end; ++i)
+		{
+			min_pos = min(min_pos, items[i].pos);
+			max_pos = max(max_pos, items[i].pos);
+		}
+		const Vec3f extent = max_pos - min_pos;
+
+		// Put the chunk's splats in Morton order, so that runs of consecutive splats to merge are compact.
+		const Vec3f morton_scale(
+			(extent.x > 0) ? (1023.f / extent.x) : 0.f,
+			(extent.y > 0) ? (1023.f / extent.y) : 0.f,
+			(extent.z > 0) ? (1023.f / extent.z) : 0.f
+		);
+		for(size_t i=0; i<chunk_num_splats; ++i)
+		{
+			const Vec3f rel = (items[begin + i].pos - min_pos) * morton_scale;
+			morton_items[i].key = spreadBits10((uint32)rel.x) | (spreadBits10((uint32)rel.y) << 1) | (spreadBits10((uint32)rel.z) << 2);
+			morton_items[i].splat_index = items[begin + i].splat_index;
+		}
+		Sort::radixSort32BitKey(morton_items.data(), morton_working_space.data(), chunk_num_splats, MortonItemGetKey(), temp_counts.data(), temp_counts.size());
+		for(size_t i=0; i<chunk_num_splats; ++i)
+			order[begin + i] = morton_items[i].splat_index;
+
+		chunk.lod_error = 0;
+		size_t lod_index = chunk.lod_begin;
+		for(size_t i=chunk.begin; i<chunk.end; i += GaussianSplatChunks::lod_merge_size)
+		{
+			const size_t group_size = myMin(GaussianSplatChunks::lod_merge_size, chunk.end - i);
+			chunk.lod_error = myMax(chunk.lod_error, mergeSplats(splat_data, order + i, group_size, res.lod_splats, lod_index));
+			lod_index++;
+		}
+		assert(lod_index == chunk.lod_end);
+	}
+}
+
+
+template <class SplatSource>
+class BuildChunkLODsTask : public glare::Task
+{
+public:
+	virtual void run(size_t /*thread_index*/) override
+	{
+		buildChunkLODs(*splat_data, items, *res, chunks_begin, chunks_end);
+	}
+
+	const SplatSource* splat_data;
+	const SplitItem* items;
+	GaussianSplatChunks* res;
+	size_t chunks_begin, chunks_end;
+};
+
+
+template <class SplatSource>
+Reference<GaussianSplatChunks> buildChunks(const SplatSource& splat_data, glare::TaskManager* task_manager)
+{
+	const size_t num_splats = splat_data.numSplats();
+
+	Reference<GaussianSplatChunks> res = new GaussianSplatChunks();
+	res->splat_order.resizeNoCopy(num_splats);
+
+	js::Vector<SplitItem, 16> items(num_splats);
+	for(size_t i=0; i<num_splats; ++i)
+	{
+		items[i].pos = splat_data.getPosition(i);
+		items[i].splat_index = (uint32)i;
+	}
+
+	SplitItem* const split_items = items.data();
+	const float inf = std::numeric_limits<float>::infinity();
+	size_t num_lod_splats = 0;
+
+	// Split depth first, left half first, so that chunks next to each other in the chunk list tend to be near each other in space.
+	std::vector<std::pair<size_t, size_t> > stack;
+	if(num_splats > 0)
+		stack.push_back(std::make_pair((size_t)0, num_splats));
+
+	while(!stack.empty())
+	{
+		const size_t begin = stack.back().first;
+		const size_t end   = stack.back().second;
+		stack.pop_back();
+
+		if(end - begin > GaussianSplatChunks::max_splats_per_chunk)
+		{
+			Vec3f min_pos(inf), max_pos(-inf);
+			for(size_t i=begin; i<end; ++i)
+			{
+				min_pos = min(min_pos, items[i].pos);
+				max_pos = max(max_pos, items[i].pos);
+			}
+			const Vec3f extent = max_pos - min_pos;
+
+			const unsigned int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : ((extent.y >= extent.z) ? 1 : 2);
+			const size_t mid = begin + (end - begin) / 2;
+			std::nth_element(split_items + begin, split_items + mid, split_items + end, SplitItemAxisLessThan(axis));
+
+			stack.push_back(std::make_pair(mid, end));
+			stack.push_back(std::make_pair(begin, mid));
+		}
+		else
+		{
+			GaussianSplatChunks::Chunk chunk;
+			chunk.begin = (uint32)begin;
+			chunk.end = (uint32)end;
+			chunk.lod_begin = (uint32)num_lod_splats;
+			num_lod_splats += Maths::roundedUpDivide(end - begin, GaussianSplatChunks::lod_merge_size);
+			chunk.lod_end = (uint32)num_lod_splats;
+			chunk.lod_error = 0;
+			res->chunks.push_back(chunk);
+		}
+	}
+
+	GaussianSplatData& lod_splats = res->lod_splats;
+	lod_splats.positions.resizeNoCopy(num_lod_splats);
+	lod_splats.scales.resizeNoCopy(num_lod_splats);
+	lod_splats.rotations.resizeNoCopy(num_lod_splats);
+	lod_splats.colours.resizeNoCopy(num_lod_splats);
+
+	// Now that each chunk's output ranges are known, the chunks can be processed independently.
+	const size_t num_chunks = res->chunks.size();
+	const size_t num_tasks = (task_manager && num_chunks > 1) ? myMin(num_chunks, task_manager->getConcurrency()) : 1;
+	if(num_tasks <= 1)
+		buildChunkLODs(splat_data, items.data(), *res, 0, num_chunks);
+	else
+	{
+		glare::TaskGroupRef group = new glare::TaskGroup();
+		for(size_t t=0; t<num_tasks; ++t)
+		{
+			Reference<BuildChunkLODsTask<SplatSource> > task = new BuildChunkLODsTask<SplatSource>();
+			task->splat_data = &splat_data;
+			task->items = items.data();
+			task->res = res.ptr();
+			task->chunks_begin = num_chunks * t / num_tasks;
+			task->chunks_end = num_chunks * (t + 1) / num_tasks;
+			group->tasks.push_back(task);
+		}
+		task_manager->runTaskGroup(group);
+	}
+
+	lod_splats.aabb_os = js::AABBox::emptyAABBox();
+	for(size_t i=0; i<num_lod_splats; ++i)
+		lod_splats.aabb_os.enlargeToHoldPoint(lod_splats.positions[i].toVec4fPoint());
+
+	return res;
+}
+
+
+} // end anonymous namespace
+
+
+Reference<GaussianSplatChunks> GaussianSplatChunks::build(const GaussianSplatData& splat_data, glare::TaskManager* task_manager)
+{
+	return buildChunks(splat_data, task_manager);
+}
+
+
+Reference<GaussianSplatChunks> GaussianSplatChunks::build(const QuantisedGaussianSplatData& splat_data, glare::TaskManager* task_manager)
+{
+	return buildChunks(splat_data, task_manager);
+}
+
+
+size_t GaussianSplatChunks::memUsageBytes() const
+{
+	return chunks.size() * sizeof(Chunk) + splat_order.dataSizeBytes() +
+		lod_splats.positions.dataSizeBytes() + lod_splats.scales.dataSizeBytes() + lod_splats.rotations.dataSizeBytes() + lod_splats.colours.dataSizeBytes();
+}
+
+
+GaussianSplatChunks::ChunkLOD GaussianSplatChunks::selectChunkLOD(const js::AABBox& chunk_aabb_ws, float lod_error_ws, const ViewParams& view_params)
+{
+	// The chunk is outside the frustum if it is entirely in front of any of the planes.  Test the corner of the box furthest behind each plane.
+	for(int i=0; i<view_params.num_frustum_planes; ++i)
+	{
+		const Planef& plane = view_params.frustum_planes[i];
+		const Vec4f& n = plane.getNormal();
+		const Vec4f corner(
+			(n[0] >= 0) ? chunk_aabb_ws.min_[0] : chunk_aabb_ws.max_[0],
+			(n[1] >= 0) ? chunk_aabb_ws.min_[1] : chunk_aabb_ws.max_[1],
+			(n[2] >= 0) ? chunk_aabb_ws.min_[2] : chunk_aabb_ws.max_[2],
+			1.f
+		);
+		if(dot(n, corner) >= plane.getD())
+			return ChunkLOD_Culled;
+	}
+
+	const float dist = chunk_aabb_ws.distanceToPoint(view_params.cam_pos_ws); // Zero if the camera is inside the chunk bounds.
+	return (lod_error_ws * view_params.lod_dist_factor < dist) ? ChunkLOD_Coarse : ChunkLOD_Full;
+}
+
+
+#if BUILD_TESTS
+
+
+#include "../utils/TestUtils.h"
+#include "../utils/ConPrint.h"
+#include "../utils/StringUtils.h"
+#include "../utils/Timer.h"
+#include "../maths/PCG32.h"
+
+
+static GaussianSplatDataRef makeTestSplats(PCG32& rng, size_t num_splats)
+{
+	GaussianSplatDataRef splats = new GaussianSplatData();
+	splats->positions.resize(num_splats);
+	splats->scales.resize(num_splats);
+	splats->rotations.resize(num_splats);
+	splats->colours.resize(num_splats);
+	splats->aabb_os = js::AABBox::emptyAABBox();
+
+	// Put the splats in random order, so the chunking can't rely on the input order.
+	for(size_t i=0; i<num_splats; ++i)
+	{
+		splats->positions[i] = Vec3f(rng.unitRandom(), rng.unitRandom(), rng.unitRandom()) * 100.f;
+		splats->scales[i] = Vec3f(0.01f + 0.1f * rng.unitRandom(), 0.01f + 0.1f * rng.unitRandom(), 0.01f + 0.1f * rng.unitRandom());
+		splats->rotations[i] = normalise(Vec4f(rng.unitRandom() - 0.5f, rng.unitRandom() - 0.5f, rng.unitRandom() - 0.5f, rng.unitRandom() - 0.5f));
+		splats->colours[i] = Vec4f(rng.unitRandom(), rng.unitRandom(), rng.unitRandom(), rng.unitRandom());
+		splats->aabb_os.enlargeToHoldPoint(splats->positions[i].toVec4fPoint());
+	}
+	return splats;
+}
+
+
+static void computeCovariance(const Vec3f& scale, const Vec4f& rot, double cov[3][3])
+{
+	for(int i=0; i<3; ++i)
+		for(int j=0; j<3; ++j)
+			cov[i][j] = 0;
+	addSplatCovariance(scale, rot, 1.0, cov);
+}
+
+
+static void checkChunkStructure(const GaussianSplatData& splats, const GaussianSplatChunks& chunks)
+{
+	const size_t N = splats.numSplats();
+	testAssert(chunks.numSplats() == N);
+
+	// Every splat should be in exactly one chunk.
+	std::vector<int> count(N, 0);
+	for(size_t i=0; i<N; ++i)
+	{
+		testAssert(chunks.splat_order[i] < N);
+		count[chunks.splat_order[i]]++;
+	}
+	for(size_t i=0; i<N; ++i)
+		testAssert(count[i] == 1);
+
+	size_t next_begin = 0, next_lod_begin = 0;
+	for(size_t c=0; c<chunks.chunks.size(); ++c)
+	{
+		const GaussianSplatChunks::Chunk& chunk = chunks.chunks[c];
+		testAssert(chunk.begin == next_begin && chunk.end > chunk.begin && chunk.end - chunk.begin <= GaussianSplatChunks::max_splats_per_chunk);
+		testAssert(chunk.lod_begin == next_lod_begin);
+		testAssert(chunk.lod_end - chunk.lod_begin == Maths::roundedUpDivide<uint32>(chunk.end - chunk.begin, (uint32)GaussianSplatChunks::lod_merge_size));
+		next_begin = chunk.end;
+		next_lod_begin = chunk.lod_end;
+
+		// Check lod_error bounds the distance from each splat to the coarse splat it was merged into.
+		for(uint32 i=chunk.begin; i<chunk.end; ++i)
+		{
+			const size_t lod_i = chunk.lod_begin + (i - chunk.begin) / GaussianSplatChunks::lod_merge_size;
+			testAssert(splats.positions[chunks.splat_order[i]].getDist(chunks.lod_splats.positions[lod_i]) <= chunk.lod_error * 1.0001f + 1.0e-5f);
+		}
+	}
+	testAssert(next_begin == N);
+	testAssert(next_lod_begin == chunks.numLODSplats());
+
+	for(size_t i=0; i<chunks.numLODSplats(); ++i)
+	{
+		testAssert(isFinite(chunks.lod_splats.positions[i].x) && isFinite(chunks.lod_splats.scales[i].x));
+		testEpsEqualWithEps(chunks.lod_splats.rotations[i].length(), 1.f, 1.0e-4f);
+		testAssert(chunks.lod_splats.colours[i][3] >= 0.f && chunks.lod_splats.colours[i][3] <= 1.f);
+	}
+}
+
+
+void GaussianSplatChunks::test()
+{
+	conPrint("GaussianSplatChunks::test()");
+
+	PCG32 rng(1);
+
+	//------------------------------ Test an empty cloud ------------------------------
+	{
+		GaussianSplatData splats;
+		splats.aabb_os = js::AABBox::emptyAABBox();
+		GaussianSplatChunksRef chunks = GaussianSplatChunks::build(splats);
+		testAssert(chunks->chunks.empty() && chunks->numSplats() == 0 && chunks->numLODSplats() == 0);
+	}
+
+	//------------------------------ Test chunk structure on random clouds ------------------------------
+	{
+		const size_t counts[] = { 1, 7, 8, 9, 4096, 4097, 50000 };
+		for(size_t z=0; z<staticArrayNumElems(counts); ++z)
+		{
+			GaussianSplatDataRef splats = makeTestSplats(rng, counts[z]);
+			GaussianSplatChunksRef chunks = GaussianSplatChunks::build(*splats);
+			checkChunkStructure(*splats, *chunks);
+		}
+
+		// The chunks of a large uniformly distributed cloud should each cover a small part of it.
+		GaussianSplatDataRef splats = makeTestSplats(rng, 100000);
+		GaussianSplatChunksRef chunks = GaussianSplatChunks::build(*splats);
+		testAssert(chunks->chunks.size() >= 100000 / max_splats_per_chunk);
+		double sum_chunk_volume = 0;
+		for(size_t c=0; c<chunks->chunks.size(); ++c)
+		{
+			js::AABBox aabb = js::AABBox::emptyAABBox();
+			for(uint32 i=chunks->chunks[c].begin; i<chunks->chunks[c].end; ++i)
+				aabb.enlargeToHoldPoint(splats->positions[chunks->splat_order[i]].toVec4fPoint());
+			sum_chunk_volume += aabb.volume();
+		}
+		testAssert(sum_chunk_volume < 1.01 * splats->aabb_os.volume());
+	}
+
+	//------------------------------ Test building from quantised data gives the same chunks as from the dequantised data ------------------------------
+	{
+		GaussianSplatDataRef splats = makeTestSplats(rng, 10000);
+		QuantisedGaussianSplatDataRef quantised = QuantisedGaussianSplatData::quantise(*splats);
+		GaussianSplatData dequantised;
+		quantised->dequantise(dequantised);
+
+		GaussianSplatChunksRef chunks_a = GaussianSplatChunks::build(*quantised);
+		GaussianSplatChunksRef chunks_b = GaussianSplatChunks::build(dequantised);
+		checkChunkStructure(dequantised, *chunks_a);
+		testAssert(chunks_a->chunks.size() == chunks_b->chunks.size());
+		for(size_t i=0; i<chunks_a->numSplats(); ++i)
+			testAssert(chunks_a->splat_order[i] == chunks_b->splat_order[i]);
+		for(size_t i=0; i<chunks_a->numLODSplats(); ++i)
+			testAssert(chunks_a->lod_splats.positions[i] == chunks_b->lod_splats.positions[i]);
+	}
+
+	//------------------------------ Test a multi-threaded build gives the same result as a single-threaded build ------------------------------
+	{
+		glare::TaskManager task_manager(4);
+		GaussianSplatDataRef splats = makeTestSplats(rng, 50000);
+
+		GaussianSplatChunksRef chunks_a = GaussianSplatChunks::build(*splats);
+		GaussianSplatChunksRef chunks_b = GaussianSplatChunks::build(*splats, &task_manager);
+		checkChunkStructure(*splats, *chunks_b);
+		testAssert(chunks_a->chunks.size() == chunks_b->chunks.size());
+		for(size_t c=0; c<chunks_a->chunks.size(); ++c)
+			testAssert(chunks_a->chunks[c].lod_error == chunks_b->chunks[c].lod_error);
+		for(size_t i=0; i<chunks_a->numSplats(); ++i)
+			testAssert(chunks_a->splat_order[i] == chunks_b->splat_order[i]);
+		for(size_t i=0; i<chunks_a->numLODSplats(); ++i)
+			testAssert(chunks_a->lod_splats.positions[i] == chunks_b->lod_splats.positions[i] && chunks_a->lod_splats.colours[i] == chunks_b->lod_splats.colours[i]);
+		testAssert(chunks_a->lod_splats.aabb_os == chunks_b->lod_splats.aabb_os);
+	}
+
+	//------------------------------ Test merging identical splats ------------------------------
+	{
+		GaussianSplatData splats;
+		const Vec3f scale(0.1f, 0.2f, 0.4f);
+		const Vec4f rot = normalise(Vec4f(0.1f, 0.2f, 0.3f, 0.9f));
+		splats.positions.resize(lod_merge_size, Vec3f(1.f, 2.f, 3.f));
+		splats.scales.resize(lod_merge_size, scale);
+		splats.rotations.resize(lod_merge_size, rot);
+		splats.colours.resize(lod_merge_size, Vec4f(0.2f, 0.4f, 0.6f, 0.1f));
+
+		GaussianSplatChunksRef chunks = GaussianSplatChunks::build(splats);
+		testAssert(chunks->chunks.size() == 1 && chunks->numLODSplats() == 1);
+		testAssert(chunks->chunks[0].lod_error == 0);
+
+		const GaussianSplatData& lod = chunks->lod_splats;
+		testAssert(epsEqual(lod.positions[0], Vec3f(1.f, 2.f, 3.f)));
+		testAssert(epsEqual(lod.colours[0], Vec4f(0.2f, 0.4f, 0.6f, 0.1f * lod_merge_size), 1.0e-5f));
+
+		// The merged splat should have the same shape, although its axes may be permuted.
+		double expected_cov[3][3], cov[3][3];
+		computeCovariance(scale, rot, expected_cov);
+		computeCovariance(lod.scales[0], lod.rotations[0], cov);
+		for(int i=0; i<3; ++i)
+			for(int j=0; j<3; ++j)
+				testEpsEqualWithEps((float)cov[i][j], (float)expected_cov[i][j], 1.0e-5f);
+	}
+
+	//------------------------------ Test merging two separated splats ------------------------------
+	{
+		GaussianSplatData splats;
+		splats.positions.push_back(Vec3f(-1.f, 0.f, 0.f));
+		splats.positions.push_back(Vec3f( 1.f, 0.f, 0.f));
+		splats.scales.resize(2, Vec3f(0.1f));
+		splats.rotations.resize(2, Vec4f(0, 0, 0, 1));
+		splats.colours.push_back(Vec4f(1, 0, 0, 1));
+		splats.colours.push_back(Vec4f(0, 0, 1, 1));
+
+		GaussianSplatChunksRef chunks = GaussianSplatChunks::build(splats);
+		testAssert(chunks->numLODSplats() == 1);
+		testEpsEqualWithEps(chunks->chunks[0].lod_error, 1.f, 1.0e-5f);
+
+		const GaussianSplatData& lod = chunks->lod_splats;
+		testAssert(epsEqual(lod.positions[0], Vec3f(0.f)));
+		// The total opacity * area of the two splats, 2 * 0.1^2, is spread over the merged splat's cross section, sqrt(1.01) * 0.1.
+		testAssert(epsEqual(lod.colours[0], Vec4f(0.5f, 0, 0.5f, 0.02f / (std::sqrt(1.01f) * 0.1f)), 1.0e-5f));
+
+		// Variance along x should be 0.1^2 + 1, and 0.1^2 along y and z.
+		double cov[3][3];
+		computeCovariance(lod.scales[0], lod.rotations[0], cov);
+		testEpsEqualWithEps((float)cov[0][0], 1.01f, 1.0e-4f);
+		testEpsEqualWithEps((float)cov[1][1], 0.01f, 1.0e-4f);
+		testEpsEqualWithEps((float)cov[2][2], 0.01f, 1.0e-4f);
+		testEpsEqualWithEps((float)cov[0][1], 0.f, 1.0e-4f);
+	}
+
+	//------------------------------ Test merging fully transparent splats ------------------------------
+	{
+		GaussianSplatData splats;
+		splats.positions.resize(3, Vec3f(1.f));
+		splats.scales.resize(3, Vec3f(0.f)); // Zero size as well.
+		splats.rotations.resize(3, Vec4f(0, 0, 0, 1));
+		splats.colours.resize(3, Vec4f(0.5f, 0.5f, 0.5f, 0.f));
+
+		GaussianSplatChunksRef chunks = GaussianSplatChunks::build(splats);
+		testAssert(chunks->numLODSplats() == 1);
+		testAssert(epsEqual(chunks->lod_splats.positions[0], Vec3f(1.f)));
+		testAssert(chunks->lod_splats.colours[0][3] == 0.f);
+	}
+
+	//------------------------------ Test chunk selection ------------------------------
+	{
+		// A frustum looking down the -z axis from the origin, with a 90 degree field of view.
+		const float r = 0.70710678f;
+		const Planef planes[5] = {
+			Planef(Vec4f(0, 0, 1, 0), 0.f), // Near plane, through the camera.
+			Planef(Vec4f( r, 0, r, 0), 0.f),
+			Planef(Vec4f(-r, 0, r, 0), 0.f),
+			Planef(Vec4f(0,  r, r, 0), 0.f),
+			Planef(Vec4f(0, -r, r, 0), 0.f)
+		};
+
+		ViewParams view_params;
+		view_params.frustum_planes = planes;
+		view_params.num_frustum_planes = 5;
+		view_params.cam_pos_ws = Vec4f(0, 0, 0, 1);
+		view_params.lod_dist_factor = 1000.f / 2.f; // 1000 px focal length, 2 px max error.
+
+		const float lod_error = 0.01f; // Coarse beyond 5 m
+
+		// Behind the camera
+		testAssert(selectChunkLOD(js::AABBox(Vec4f(-1, -1, 1, 1), Vec4f(1, 1, 2, 1)), lod_error, view_params) == ChunkLOD_Culled);
+		// Off to the side
+		testAssert(selectChunkLOD(js::AABBox(Vec4f(20, -1, -10, 1), Vec4f(22, 1, -9, 1)), lod_error, view_params) == ChunkLOD_Culled);
+		testAssert(selectChunkLOD(js::AABBox(Vec4f(-1, -22, -10, 1), Vec4f(1, -20, -9, 1)), lod_error, view_params) == ChunkLOD_Culled);
+		// Straddling a plane
+		testAssert(selectChunkLOD(js::AABBox(Vec4f(9, -1, -10, 1), Vec4f(11, 1, -9, 1)), lod_error, view_params) != ChunkLOD_Culled);
+		// In front, near
+		testAssert(selectChunkLOD(js::AABBox(Vec4f(-1, -1, -4, 1), Vec4f(1, 1, -3, 1)), lod_error, view_params) == ChunkLOD_Full);
+		// Containing the camera
+		testAssert(selectChunkLOD(js::AABBox(Vec4f(-1, -1, -1, 1), Vec4f(1, 1, 1, 1)), lod_error, view_params) == ChunkLOD_Full);
+		// In front, far
+		testAssert(selectChunkLOD(js::AABBox(Vec4f(-1, -1, -11, 1), Vec4f(1, 1, -10, 1)), lod_error, view_params) == ChunkLOD_Coarse);
+		testAssert(selectChunkLOD(js::AABBox(Vec4f(-1, -1, -11, 1), Vec4f(1, 1, -10, 1)), /*lod error=*/0.1f, view_params) == ChunkLOD_Full);
+	}
+
+	//------------------------------ Measure build speed ------------------------------
+	{
+		const size_t num_splats = 1000000;
+		GaussianSplatDataRef splats = makeTestSplats(rng, num_splats);
+		QuantisedGaussianSplatDataRef quantised = QuantisedGaussianSplatData::quantise(*splats);
+
+		Timer timer;
+		GaussianSplatChunksRef chunks = GaussianSplatChunks::build(*splats);
+		const double build_time = timer.elapsed();
+
+		glare::TaskManager task_manager;
+		timer.reset();
+		GaussianSplatChunks::build(*splats, &task_manager);
+		const double parallel_build_time = timer.elapsed();
+
+		timer.reset();
+		GaussianSplatChunksRef quantised_chunks = GaussianSplatChunks::build(*quantised);
+		const double quantised_build_time = timer.elapsed();
+
+		conPrint("Built " + toString(chunks->chunks.size()) + " chunks, " + toString(chunks->numLODSplats()) + " LOD splats, for " + toString(num_splats) + " splats in " +
+			doubleToStringNSigFigs(build_time * 1.0e3, 3) + " ms (" + doubleToStringNSigFigs(quantised_build_time * 1.0e3, 3) + " ms from quantised data, " +
+			doubleToStringNSigFigs(parallel_build_time * 1.0e3, 3) + " ms with " + toString(task_manager.getConcurrency()) + " threads), " +
+			getMBSizeString(chunks->memUsageBytes()));
+	}
+
+	conPrint("GaussianSplatChunks::test() done.");
+}
+
+
+#endif // BUILD_TESTS
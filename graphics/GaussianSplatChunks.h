@@ -0,0 +1,91 @@
+/*=====================================================================
+GaussianSplatChunks.h
+---------------------
+Copyright Glare Technologies Limited 2026 -
+=====================================================================*/
+#pragma once
+
+
+#include "GaussianSplatData.h"
+#include "QuantisedGaussianSplatData.h"
+#include "../maths/plane.h"
+#include <vector>
+namespace glare { class TaskManager; }
+
+
+/*=====================================================================
+GaussianSplatChunks
+-------------------
+Splits a splat cloud into spatially compact chunks, each with a coarse
+level of detail, so that a renderer can cull and LOD-select chunks
+rather than drawing and sorting the whole cloud.
+
+Chunks are built by recursively splitting the splats at the median along
+the longest axis of their bounds, until each chunk has at most
+max_splats_per_chunk splats.
+
+Each chunk's coarse LOD has one splat for each lod_merge_size splats in the
+chunk.  The splats of a chunk are put in Morton order within the chunk, and each
+run of lod_merge_size splats is merged into one by matching the first two
+moments: the merged splat has the weighted mean position and covariance of the
+splats it replaces, with each splat weighted by its opacity times the area of
+its largest cross section.
+
+Everything here is in the object space of the source splat data, and is
+independent of the pose the cloud is drawn with.
+
+Tests are in GaussianSplatChunks::test()
+=====================================================================*/
+class GaussianSplatChunks : public ThreadSafeRefCounted
+{
+public:
+	static const size_t max_splats_per_chunk = 4096;
+	static const size_t lod_merge_size = 8; // The number of splats merged into each coarse LOD splat.
+
+	// Multi-thread if task_manager is non-null
+	static Reference<GaussianSplatChunks> build(const GaussianSplatData& splat_data, glare::TaskManager* task_manager = NULL);
+	static Reference<GaussianSplatChunks> build(const QuantisedGaussianSplatData& splat_data, glare::TaskManager* task_manager = NULL);
+
+	struct Chunk
+	{
+		uint32 begin, end; // The range of splat_order holding this chunk's splats.
+		uint32 lod_begin, lod_end; // The range of lod_splats holding this chunk's coarse LOD splats.
+		float lod_error; // The largest distance from a splat centre to the centre of the coarse splat it was merged into.
+	};
+
+	size_t numSplats() const { return splat_order.size(); }
+	size_t numLODSplats() const { return lod_splats.numSplats(); }
+
+	size_t memUsageBytes() const;
+
+
+	// Per-frame chunk selection
+	enum ChunkLOD
+	{
+		ChunkLOD_Culled,
+		ChunkLOD_Full, // Draw the chunk's splats.
+		ChunkLOD_Coarse // Draw the chunk's coarse LOD splats.
+	};
+
+	struct ViewParams
+	{
+		const Planef* frustum_planes; // Plane normals point out of the frustum.
+		int num_frustum_planes;
+		Vec4f cam_pos_ws;
+		float lod_dist_factor; // The coarse LOD is used when lod_error_ws * lod_dist_factor < the distance to the chunk, e.g. focal length in pixels / max LOD error in pixels.
+	};
+
+	// chunk_aabb_ws should bound the extent of the chunk's splats, at both levels of detail, not just their centres.
+	static ChunkLOD selectChunkLOD(const js::AABBox& chunk_aabb_ws, float lod_error_ws, const ViewParams& view_params);
+
+
+	std::vector<Chunk> chunks;
+	js::Vector<uint32, 16> splat_order; // Indices of the source splats, grouped by chunk.
+	GaussianSplatData lod_splats; // The coarse LOD splats of all chunks, grouped by chunk.
+
+
+	static void test();
+};
+
+
+typedef Reference<GaussianSplatChunks> GaussianSplatChunksRef;
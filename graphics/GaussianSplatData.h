@@ -27,12 +27,20 @@ they were decoded from (see SOGDecoder.h).
 
 Note that only the DC term (sh0) of the spherical harmonics is kept, so
 colours are view-independent.
+
+See QuantisedGaussianSplatData for a more compact form.  Both have the same
+get*() accessors, so code templated on the splat source type can read either.
 =====================================================================*/
 class GaussianSplatData : public ThreadSafeRefCounted
 {
 public:
 	size_t numSplats() const { return positions.size(); }
 
+	const Vec3f& getPosition(size_t i) const { return positions[i]; }
+	const Vec3f& getScale(size_t i) const { return scales[i]; }
+	const Vec4f& getRotation(size_t i) const { return rotations[i]; }
+	const Vec4f& getColour(size_t i) const { return colours[i]; }
+
 	js::Vector<Vec3f, 16> positions;
 	js::Vector<Vec3f, 16> scales; // Per-axis linear scale factors (already exponentiated out of the log domain the file stores them in).
 	js::Vector<Vec4f, 16> rotations; // Unit quaternions, stored as (x, y, z, w).
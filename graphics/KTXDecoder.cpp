@@ -303,6 +303,14 @@ Reference<Map2D> KTXDecoder::decodeKTX2FromBuffer(const void* data, size_t size,
 		{
 			format = OpenGLTextureFormat::Format_Compressed_DXT_SRGBA_Uint8;
 		}
+		else if(vkFormat == VK_FORMAT_BC5_UNORM_BLOCK)
+		{
+			format = OpenGLTextureFormat::Format_Compressed_BC5_Uint8;
+		}
+		else if(vkFormat == VK_FORMAT_BC7_UNORM_BLOCK || vkFormat == VK_FORMAT_BC7_SRGB_BLOCK)
+		{
+			format = OpenGLTextureFormat::Format_Compressed_BC7_SRGBA_Uint8;
+		}
 		else
 			throw glare::Exception("Unhandled vkFormat " + toString(vkFormat) + ".");
 
@@ -470,6 +478,12 @@ void KTXDecoder::supercompressKTX2File(const std::string& path_in, const std::st
 void KTXDecoder::writeKTX2File(Format format, bool supercompression, int w, int h, const std::vector<std::vector<uint8> >& level_image_data, const std::string& path_out)
 {
 	FileOutStream file(path_out);
+	writeKTX2ToStream(format, supercompression, w, h, level_image_data, file);
+}
+
+
+void KTXDecoder::writeKTX2ToStream(Format format, bool supercompression, int w, int h, const std::vector<std::vector<uint8> >& level_image_data, OutStream& file)
+{
 	file.writeData(ktx2_file_id, 12);
 
 	uint32 vk_format;
@@ -478,7 +492,9 @@ void KTXDecoder::writeKTX2File(Format format, bool supercompression, int w, int
 		// case Format_SRGB_Uint8: vk_format = VK_FORMAT_R8G8B8_SRGB;         break;
 		case Format_BC1:        vk_format = VK_FORMAT_BC1_RGB_UNORM_BLOCK; break;
 		case Format_BC3:        vk_format = VK_FORMAT_BC3_UNORM_BLOCK;     break;
+		case Format_BC5:        vk_format = VK_FORMAT_BC5_UNORM_BLOCK;     break;
 		case Format_BC6H:       vk_format = VK_FORMAT_BC6H_UFLOAT_BLOCK;   break;
+		case Format_BC7:        vk_format = VK_FORMAT_BC7_UNORM_BLOCK;     break;
 		default: throw glare::Exception("Invalid format");
 	}
 
@@ -512,7 +528,8 @@ void KTXDecoder::writeKTX2File(Format format, bool supercompression, int w, int
 
 	std::vector<LevelData> level_data(level_image_data.size());
 
-	const size_t mip_level_byte_start = file.getWriteIndex() + level_data.size() * sizeof(LevelData);
+	const size_t header_size = 80;
+	const size_t mip_level_byte_start = header_size + level_data.size() * sizeof(LevelData);
 	size_t level_byte_write_i = mip_level_byte_start;
 
 	js::Vector<uint8, 16> compressed_data;
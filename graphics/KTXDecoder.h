@@ -9,8 +9,10 @@ Copyright Glare Technologies Limited 2023 -
 #include "../utils/Reference.h"
 #include "../utils/ArrayRef.h"
 #include <string>
+#include <vector>
 namespace glare { class Allocator; }
 class Map2D;
+class OutStream;
 
 
 /*=====================================================================
@@ -44,11 +46,16 @@ public:
 		//Format_SRGB_Uint8,
 		Format_BC1, // Aka DXT1 (DXT without alpha)
 		Format_BC3, // Aka DXT5 (DXT with alpha)
-		Format_BC6H
+		Format_BC5, // Two channel, aka RGTC2
+		Format_BC6H,
+		Format_BC7
 	};
 
 	static void writeKTX2File(Format format, bool supercompression, int w, int h, const std::vector<std::vector<uint8> >& level_image_data, const std::string& path_out);
 
+	// Writes a complete KTX2 file to stream.  Nothing should have been written to the stream yet, as the level offsets written are relative to the start of the stream.
+	static void writeKTX2ToStream(Format format, bool supercompression, int w, int h, const std::vector<std::vector<uint8> >& level_image_data, OutStream& stream);
+
 
 	static void test();
 };
@@ -0,0 +1,341 @@
+/*=====================================================================
+QuantisedGaussianSplatData.cpp
+------------------------------
+Copyright Glare Technologies Limited 2026 -
+=====================================================================*/
+#include "QuantisedGaussianSplatData.h"
+
+
+#include <limits>
+
+
+// Scales are clamped to at least this before taking the log, so a zero scale doesn't give an infinite log scale range for the chunk.
+static const float min_scale = 1.0e-10f;
+
+
+// Computes the step size for quantising values in [min_val, max_val] to integers in [0, max_quantised], and its reciprocal for encoding.
+// If all the values are the same, the step is zero, and every value quantises to zero.
+static void computeSteps(const Vec3f& min_val, const Vec3f& max_val, uint32 max_quantised, Vec3f& step_out, Vec3f& inv_step_out)
+{
+	for(unsigned int c=0; c<3; ++c)
+	{
+		const float extent = max_val[c] - min_val[c];
+		step_out[c]     = extent / (float)max_quantised;
+		inv_step_out[c] = (extent > 0) ? ((float)max_quantised / extent) : 0.f;
+	}
+}
+
+
+static inline uint32 quantiseValue(float x, float min_val, float inv_step, uint32 max_quantised)
+{
+	return (uint32)myClamp((x - min_val) * inv_step + 0.5f, 0.f, (float)max_quantised); // Adding 0.5 before truncating rounds to nearest.
+}
+
+
+static inline uint32 quantiseRotation(const Vec4f& rot)
+{
+	const float max_component = 0.70710678f;
+	const float scale = 1023 / (2 * max_component);
+
+	Vec4f q = rot;
+	const float len2 = dot(q, q);
+	if(!(len2 > 0)) // Also catches NaNs.
+		q = Vec4f(0, 0, 0, 1);
+	else
+		q *= 1 / std::sqrt(len2);
+
+	uint32 largest_i = 0;
+	for(uint32 c=1; c<4; ++c)
+		if(std::fabs(q[c]) > std::fabs(q[largest_i]))
+			largest_i = c;
+
+	// q and -q are the same rotation, so negate if needed to make the dropped component positive, so it can be reconstructed as a positive square root.
+	if(q[largest_i] < 0)
+		q = -q;
+
+	uint32 v = largest_i << 30;
+	int shift = 20;
+	for(uint32 c=0; c<4; ++c)
+		if(c != largest_i)
+		{
+			v |= quantiseValue(q[c], -max_component, scale, 1023) << shift;
+			shift -= 10;
+		}
+	return v;
+}
+
+
+Reference<QuantisedGaussianSplatData> QuantisedGaussianSplatData::quantise(const GaussianSplatData& splat_data)
+{
+	const size_t num_splats = splat_data.numSplats();
+	const size_t num_chunks = Maths::roundedUpDivide(num_splats, chunk_size);
+
+	Reference<QuantisedGaussianSplatData> res = new QuantisedGaussianSplatData();
+	res->chunks.resizeNoCopy(num_chunks);
+	res->positions.resizeNoCopy(num_splats * 3);
+	res->scales.resizeNoCopy(num_splats * 3);
+	res->rotations.resizeNoCopy(num_splats);
+	res->colours.resizeNoCopy(num_splats);
+	res->aabb_os = splat_data.aabb_os;
+
+	const float inf = std::numeric_limits<float>::infinity();
+
+	for(size_t chunk_i=0; chunk_i<num_chunks; ++chunk_i)
+	{
+		const size_t begin = chunk_i * chunk_size;
+		const size_t end = myMin(begin + chunk_size, num_splats);
+
+		// Compute the chunk's ranges
+		Vec3f pos_min(inf), pos_max(-inf), log_scale_min(inf), log_scale_max(-inf), colour_min(inf), colour_max(-inf);
+		for(size_t i=begin; i<end; ++i)
+		{
+			const Vec3f& pos = splat_data.positions[i];
+			const Vec3f& scale = splat_data.scales[i];
+			const Vec3f log_scale(std::log(myMax(scale.x, min_scale)), std::log(myMax(scale.y, min_scale)), std::log(myMax(scale.z, min_scale)));
+			const Vec3f colour(splat_data.colours[i][0], splat_data.colours[i][1], splat_data.colours[i][2]);
+
+			pos_min = min(pos_min, pos);                   pos_max = max(pos_max, pos);
+			log_scale_min = min(log_scale_min, log_scale); log_scale_max = max(log_scale_max, log_scale);
+			colour_min = min(colour_min, colour);          colour_max = max(colour_max, colour);
+		}
+
+		Chunk& chunk = res->chunks[chunk_i];
+		Vec3f pos_inv_step, log_scale_inv_step, colour_inv_step;
+		chunk.pos_min = pos_min;
+		chunk.log_scale_min = log_scale_min;
+		chunk.colour_min = colour_min;
+		computeSteps(pos_min, pos_max, 65535, chunk.pos_step, pos_inv_step);
+		computeSteps(log_scale_min, log_scale_max, 255, chunk.log_scale_step, log_scale_inv_step);
+		computeSteps(colour_min, colour_max, 255, chunk.colour_step, colour_inv_step);
+
+		// Quantise the chunk's splats
+		for(size_t i=begin; i<end; ++i)
+		{
+			const Vec3f& pos = splat_data.positions[i];
+			const Vec3f& scale = splat_data.scales[i];
+			const Vec4f& colour = splat_data.colours[i];
+			for(unsigned int c=0; c<3; ++c)
+			{
+				res->positions[i * 3 + c] = (uint16)quantiseValue(pos[c], pos_min[c], pos_inv_step[c], 65535);
+				res->scales   [i * 3 + c] = (uint8) quantiseValue(std::log(myMax(scale[c], min_scale)), log_scale_min[c], log_scale_inv_step[c], 255);
+			}
+
+			res->rotations[i] = quantiseRotation(splat_data.rotations[i]);
+
+			res->colours[i] =
+				 quantiseValue(colour[0], colour_min[0], colour_inv_step[0], 255) |
+				(quantiseValue(colour[1], colour_min[1], colour_inv_step[1], 255) << 8) |
+				(quantiseValue(colour[2], colour_min[2], colour_inv_step[2], 255) << 16) |
+				(quantiseValue(colour[3], 0.f, 255.f, 255) << 24);
+		}
+	}
+
+	return res;
+}
+
+
+void QuantisedGaussianSplatData::dequantise(GaussianSplatData& splat_data_out) const
+{
+	const size_t num_splats = numSplats();
+	splat_data_out.positions.resizeNoCopy(num_splats);
+	splat_data_out.scales.resizeNoCopy(num_splats);
+	splat_data_out.rotations.resizeNoCopy(num_splats);
+	splat_data_out.colours.resizeNoCopy(num_splats);
+
+	for(size_t i=0; i<num_splats; ++i)
+	{
+		splat_data_out.positions[i] = getPosition(i);
+		splat_data_out.scales[i]    = getScale(i);
+		splat_data_out.rotations[i] = getRotation(i);
+		splat_data_out.colours[i]   = getColour(i);
+	}
+
+	splat_data_out.aabb_os = aabb_os;
+}
+
+
+size_t QuantisedGaussianSplatData::memUsageBytes() const
+{
+	return chunks.dataSizeBytes() + positions.dataSizeBytes() + scales.dataSizeBytes() + rotations.dataSizeBytes() + colours.dataSizeBytes();
+}
+
+
+#if BUILD_TESTS
+
+
+#include "../utils/TestUtils.h"
+#include "../utils/ConPrint.h"
+#include "../utils/StringUtils.h"
+#include "../utils/Timer.h"
+#include "../maths/PCG32.h"
+
+
+// Makes a cloud laid out like a decoded splat file: consecutive splats are near each other.
+static GaussianSplatDataRef makeTestSplats(PCG32& rng, size_t num_splats)
+{
+	GaussianSplatDataRef splats = new GaussianSplatData();
+	splats->positions.resize(num_splats);
+	splats->scales.resize(num_splats);
+	splats->rotations.resize(num_splats);
+	splats->colours.resize(num_splats);
+	splats->aabb_os = js::AABBox::emptyAABBox();
+
+	Vec3f cluster_centre(0.f);
+	for(size_t i=0; i<num_splats; ++i)
+	{
+		if(i % 100 == 0)
+			cluster_centre = Vec3f(rng.unitRandom(), rng.unitRandom(), rng.unitRandom()) * 200.f - Vec3f(100.f);
+
+		splats->positions[i] = cluster_centre + Vec3f(rng.unitRandom(), rng.unitRandom(), rng.unitRandom()) * 0.5f;
+		splats->scales[i] = Vec3f(std::exp(-8 + 6 * rng.unitRandom()), std::exp(-8 + 6 * rng.unitRandom()), std::exp(-8 + 6 * rng.unitRandom()));
+		splats->rotations[i] = normalise(Vec4f(rng.unitRandom() - 0.5f, rng.unitRandom() - 0.5f, rng.unitRandom() - 0.5f, rng.unitRandom() - 0.5f));
+		splats->colours[i] = Vec4f(-0.1f + 1.2f * rng.unitRandom(), -0.1f + 1.2f * rng.unitRandom(), -0.1f + 1.2f * rng.unitRandom(), rng.unitRandom()); // Base colours can be slightly outside [0, 1].
+
+		splats->aabb_os.enlargeToHoldPoint(Vec4f(splats->positions[i].x, splats->positions[i].y, splats->positions[i].z, 1.f));
+	}
+	return splats;
+}
+
+
+// Checks that each decoded splat is within the quantisation error of the original.
+static void checkQuantisationError(const GaussianSplatData& splats, const QuantisedGaussianSplatData& quantised)
+{
+	testAssert(quantised.numSplats() == splats.numSplats());
+
+	for(size_t i=0; i<splats.numSplats(); ++i)
+	{
+		const QuantisedGaussianSplatData::Chunk& chunk = quantised.chunks[i / QuantisedGaussianSplatData::chunk_size];
+
+		const Vec3f pos = quantised.getPosition(i);
+		const Vec3f scale = quantised.getScale(i);
+		const Vec4f colour = quantised.getColour(i);
+		for(unsigned int c=0; c<3; ++c)
+		{
+			testAssert(std::fabs(pos[c] - splats.positions[i][c]) <= chunk.pos_step[c] * 0.5f + 1.0e-4f);
+			testAssert(std::fabs(std::log(scale[c]) - std::log(splats.scales[i][c])) <= chunk.log_scale_step[c] * 0.5f + 1.0e-4f);
+			testAssert(std::fabs(colour[c] - splats.colours[i][c]) <= chunk.colour_step[c] * 0.5f + 1.0e-5f);
+		}
+		testAssert(std::fabs(colour[3] - splats.colours[i][3]) <= 0.5f / 255 + 1.0e-5f);
+
+		// q and -q are the same rotation, so compare with the absolute value of the dot product.
+		const Vec4f rot = quantised.getRotation(i);
+		testEpsEqualWithEps(dot(rot, rot), 1.f, 1.0e-5f);
+		testAssert(std::fabs(dot(rot, normalise(splats.rotations[i]))) > 0.99999f);
+	}
+}
+
+
+void QuantisedGaussianSplatData::test()
+{
+	conPrint("QuantisedGaussianSplatData::test()");
+
+	PCG32 rng(1);
+
+	//------------------------------ Test an empty cloud ------------------------------
+	{
+		GaussianSplatData splats;
+		splats.aabb_os = js::AABBox::emptyAABBox();
+		QuantisedGaussianSplatDataRef quantised = QuantisedGaussianSplatData::quantise(splats);
+		testAssert(quantised->numSplats() == 0);
+		testAssert(quantised->chunks.size() == 0);
+
+		GaussianSplatData dequantised;
+		quantised->dequantise(dequantised);
+		testAssert(dequantised.numSplats() == 0);
+	}
+
+	//------------------------------ Test random clouds, including partial last chunks ------------------------------
+	{
+		const size_t counts[] = { 1, 255, 256, 257, 1000, 10000 };
+		for(size_t z=0; z<staticArrayNumElems(counts); ++z)
+		{
+			GaussianSplatDataRef splats = makeTestSplats(rng, counts[z]);
+			QuantisedGaussianSplatDataRef quantised = QuantisedGaussianSplatData::quantise(*splats);
+			testAssert(quantised->chunks.size() == Maths::roundedUpDivide(counts[z], QuantisedGaussianSplatData::chunk_size));
+			testAssert(quantised->aabb_os == splats->aabb_os);
+			checkQuantisationError(*splats, *quantised);
+
+			// dequantise() should give the same results as the accessors.
+			GaussianSplatData dequantised;
+			quantised->dequantise(dequantised);
+			testAssert(dequantised.numSplats() == counts[z]);
+			for(size_t i=0; i<counts[z]; ++i)
+			{
+				testAssert(dequantised.positions[i] == quantised->getPosition(i));
+				testAssert(dequantised.scales[i]    == quantised->getScale(i));
+				testAssert(dequantised.rotations[i] == quantised->getRotation(i));
+				testAssert(dequantised.colours[i]   == quantised->getColour(i));
+			}
+
+			// The quantised data should be about 17 bytes per splat.
+			if(counts[z] >= 1000)
+				testAssert(quantised->memUsageBytes() < counts[z] * 18);
+		}
+	}
+
+	//------------------------------ Test degenerate values ------------------------------
+	{
+		GaussianSplatData splats;
+		const size_t N = 8;
+		splats.positions.resize(N, Vec3f(1.f, 2.f, 3.f)); // All the same position, so a zero position range.
+		splats.scales.resize(N, Vec3f(0.1f));
+		splats.rotations.resize(N);
+		splats.colours.resize(N, Vec4f(0.5f, 0.5f, 0.5f, 2.f)); // Opacity out of range, should be clamped.
+		splats.rotations[0] = Vec4f(0, 0, 0, 1);
+		splats.rotations[1] = Vec4f(0, 0, 0, -1); // Negated identity.
+		splats.rotations[2] = Vec4f(0, -0.8f, 0, 0.6f); // Largest component is negative.
+		splats.rotations[3] = Vec4f(0, 0, 0, 0); // Zero length, should give the identity.
+		splats.rotations[4] = Vec4f(0, 3, 0, 4); // Not normalised.
+		splats.rotations[5] = Vec4f(0.5f, 0.5f, 0.5f, 0.5f); // Components all the same magnitude.
+		splats.rotations[6] = Vec4f(-0.70710678f, 0, 0, 0.70710678f);
+		splats.rotations[7] = Vec4f(1, 0, 0, 0);
+		splats.scales[7] = Vec3f(0.f, 1.f, 1.0e-20f); // Scales below min_scale.
+		splats.aabb_os = js::AABBox(Vec4f(1, 2, 3, 1), Vec4f(1, 2, 3, 1));
+
+		QuantisedGaussianSplatDataRef quantised = QuantisedGaussianSplatData::quantise(splats);
+		for(size_t i=0; i<N; ++i)
+		{
+			testAssert(quantised->getPosition(i) == Vec3f(1.f, 2.f, 3.f));
+			testAssert(quantised->getColour(i)[3] == 1.f);
+		}
+
+		testAssert(epsEqual(quantised->getScale(0), Vec3f(0.1f), 1.0e-5f));
+		testAssert(std::fabs(quantised->getScale(7).x - min_scale) < 1.0e-12f);
+		testAssert(epsEqual(quantised->getScale(7).y, 1.f, 1.0e-3f));
+
+		testAssert(std::fabs(dot(quantised->getRotation(0), Vec4f(0, 0, 0, 1))) > 0.99999f);
+		testAssert(std::fabs(dot(quantised->getRotation(1), Vec4f(0, 0, 0, 1))) > 0.99999f);
+		testAssert(std::fabs(dot(quantised->getRotation(2), Vec4f(0, -0.8f, 0, 0.6f))) > 0.99999f);
+		testAssert(std::fabs(dot(quantised->getRotation(3), Vec4f(0, 0, 0, 1))) > 0.99999f);
+		testAssert(std::fabs(dot(quantised->getRotation(4), Vec4f(0, 0.6f, 0, 0.8f))) > 0.99999f);
+		testAssert(std::fabs(dot(quantised->getRotation(5), Vec4f(0.5f, 0.5f, 0.5f, 0.5f))) > 0.99999f);
+		testAssert(std::fabs(dot(quantised->getRotation(6), Vec4f(-0.70710678f, 0, 0, 0.70710678f))) > 0.99999f);
+		testAssert(std::fabs(dot(quantised->getRotation(7), Vec4f(1, 0, 0, 0))) > 0.99999f);
+	}
+
+	//------------------------------ Measure speed and memory use on a large cloud ------------------------------
+	{
+		const size_t num_splats = 4000000;
+		GaussianSplatDataRef splats = makeTestSplats(rng, num_splats);
+
+		Timer timer;
+		QuantisedGaussianSplatDataRef quantised = QuantisedGaussianSplatData::quantise(*splats);
+		const double quantise_time = timer.elapsed();
+
+		timer.reset();
+		GaussianSplatData dequantised;
+		quantised->dequantise(dequantised);
+		const double dequantise_time = timer.elapsed();
+
+		const size_t unquantised_size = num_splats * (2 * sizeof(Vec3f) + 2 * sizeof(Vec4f));
+		conPrint("Quantised " + toString(num_splats) + " splats: " + getMBSizeString(unquantised_size) + " -> " + getMBSizeString(quantised->memUsageBytes()) +
+			" (" + doubleToStringNSigFigs((double)quantised->memUsageBytes() / num_splats, 3) + " B/splat)");
+		conPrint("quantise:   " + doubleToStringNSigFigs(quantise_time * 1.0e3, 3) + " ms (" + doubleToStringNSigFigs(num_splats / quantise_time * 1.0e-6, 3) + " M splats/s)");
+		conPrint("dequantise: " + doubleToStringNSigFigs(dequantise_time * 1.0e3, 3) + " ms (" + doubleToStringNSigFigs(num_splats / dequantise_time * 1.0e-6, 3) + " M splats/s)");
+	}
+
+	conPrint("QuantisedGaussianSplatData::test() done.");
+}
+
+
+#endif // BUILD_TESTS
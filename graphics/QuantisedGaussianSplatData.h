@@ -0,0 +1,142 @@
+/*=====================================================================
+QuantisedGaussianSplatData.h
+----------------------------
+Copyright Glare Technologies Limited 2026 -
+=====================================================================*/
+#pragma once
+
+
+#include "GaussianSplatData.h"
+#include "../maths/mathstypes.h"
+#include <cmath>
+
+
+/*=====================================================================
+QuantisedGaussianSplatData
+--------------------------
+A compact, lossy form of GaussianSplatData, for keeping large splat clouds
+in memory.  Takes 17 bytes per splat, plus 72 bytes per chunk of 256 splats,
+vs 56 bytes per splat for GaussianSplatData.
+
+Splats are grouped into chunks of chunk_size consecutive splats.  Each chunk
+stores the range of its splats' positions, log scales and colours, and each
+splat is stored relative to its chunk's ranges:
+
+Position: 16 bits per axis.
+Scale:    8 bits per axis, in the log domain.
+Rotation: 'smallest three' encoding in 32 bits.  The largest magnitude
+          component is dropped (and reconstructed from the unit length), the
+          quaternion is negated if needed to make it positive, and the other
+          three components, which are then in [-1/sqrt(2), 1/sqrt(2)], get 10 bits each.
+          The top 2 bits hold the index of the dropped component.
+Colour:   8 bits per channel.  Opacity is always in [0, 1], so uses a fixed range.
+
+The chunk ranges are only tight when splats that are close together in space
+are close together in the arrays, which is the case for the usual splat file
+formats, as they are written in Morton order.
+
+Use the get*() accessors to decode individual splats.  They have the same
+signatures as the GaussianSplatData accessors, so code templated on the splat
+source type can read either.
+
+Tests are in QuantisedGaussianSplatData::test()
+=====================================================================*/
+class QuantisedGaussianSplatData : public ThreadSafeRefCounted
+{
+public:
+	static const size_t chunk_size_log2 = 8;
+	static const size_t chunk_size = (size_t)1 << chunk_size_log2;
+
+	static Reference<QuantisedGaussianSplatData> quantise(const GaussianSplatData& splat_data);
+
+	// Decodes every splat.  aabb_os is copied over, so still bounds the unquantised splat centres.
+	void dequantise(GaussianSplatData& splat_data_out) const;
+
+	size_t numSplats() const { return rotations.size(); }
+
+	size_t memUsageBytes() const;
+
+	inline Vec3f getPosition(size_t i) const;
+	inline Vec3f getScale(size_t i) const;
+	inline Vec4f getRotation(size_t i) const; // Unit quaternion, as (x, y, z, w).
+	inline Vec4f getColour(size_t i) const;
+
+	static void test();
+
+	struct Chunk
+	{
+		// For each: decoded value = min + quantised value * step
+		Vec3f pos_min, pos_step;
+		Vec3f log_scale_min, log_scale_step;
+		Vec3f colour_min, colour_step; // For r, g, b.
+	};
+
+	js::Vector<Chunk, 16> chunks;
+	js::Vector<uint16, 16> positions; // 3 values per splat.
+	js::Vector<uint8, 16> scales; // 3 values per splat.
+	js::Vector<uint32, 16> rotations;
+	js::Vector<uint32, 16> colours; // r in the lowest byte, opacity in the highest.
+
+	js::AABBox aabb_os; // Bounds the unquantised splat centres.
+};
+
+
+typedef Reference<QuantisedGaussianSplatData> QuantisedGaussianSplatDataRef;
+
+
+Vec3f QuantisedGaussianSplatData::getPosition(size_t i) const
+{
+	const Chunk& chunk = chunks[i >> chunk_size_log2];
+	const uint16* p = &positions[i * 3];
+	return Vec3f(
+		chunk.pos_min.x + (float)p[0] * chunk.pos_step.x,
+		chunk.pos_min.y + (float)p[1] * chunk.pos_step.y,
+		chunk.pos_min.z + (float)p[2] * chunk.pos_step.z
+	);
+}
+
+
+Vec3f QuantisedGaussianSplatData::getScale(size_t i) const
+{
+	const Chunk& chunk = chunks[i >> chunk_size_log2];
+	const uint8* s = &scales[i * 3];
+	return Vec3f(
+		std::exp(chunk.log_scale_min.x + (float)s[0] * chunk.log_scale_step.x),
+		std::exp(chunk.log_scale_min.y + (float)s[1] * chunk.log_scale_step.y),
+		std::exp(chunk.log_scale_min.z + (float)s[2] * chunk.log_scale_step.z)
+	);
+}
+
+
+Vec4f QuantisedGaussianSplatData::getRotation(size_t i) const
+{
+	const float max_component = 0.70710678f; // 1/sqrt(2): no component other than the largest magnitude one can exceed this in magnitude.
+	const float step = 2 * max_component / 1023;
+
+	const uint32 v = rotations[i];
+	const float a = (float)((v >> 20) & 1023) * step - max_component;
+	const float b = (float)((v >> 10) & 1023) * step - max_component;
+	const float c = (float)( v        & 1023) * step - max_component;
+	const float largest = std::sqrt(myMax(0.f, 1.f - (a*a + b*b + c*c)));
+
+	switch(v >> 30)
+	{
+	case 0:  return Vec4f(largest, a, b, c);
+	case 1:  return Vec4f(a, largest, b, c);
+	case 2:  return Vec4f(a, b, largest, c);
+	default: return Vec4f(a, b, c, largest);
+	}
+}
+
+
+Vec4f QuantisedGaussianSplatData::getColour(size_t i) const
+{
+	const Chunk& chunk = chunks[i >> chunk_size_log2];
+	const uint32 c = colours[i];
+	return Vec4f(
+		chunk.colour_min.x + (float)( c        & 0xFF) * chunk.colour_step.x,
+		chunk.colour_min.y + (float)((c >>  8) & 0xFF) * chunk.colour_step.y,
+		chunk.colour_min.z + (float)((c >> 16) & 0xFF) * chunk.colour_step.z,
+		(float)(c >> 24) * (1.f / 255)
+	);
+}
@@ -13,6 +13,8 @@ Copyright Glare Technologies Limited 2026 -
 #include "../utils/JSONParser.h"
 #include "../utils/MemMappedFile.h"
 #include "../utils/StringUtils.h"
+#include "../utils/Task.h"
+#include "../utils/TaskManager.h"
 #include "../utils/Vector.h"
 #include <cmath>
 #include <cstring>
@@ -328,10 +330,181 @@ void checkHasAlpha(const AttributeImage& image, const std::string& filename)
 }
 
 
+// Extracts and decodes one attribute image.  Exceptions are caught and stored, to be rethrown on the calling thread
+// once all the images are done.
+class DecodeAttributeImageTask : public glare::Task
+{
+public:
+	virtual void run(size_t /*thread_index*/) override
+	{
+		try
+		{
+			decodeAttributeImage(sog_data, sog_size, *index, filename, mem_allocator, *image_out);
+		}
+		catch(glare::Exception& e)
+		{
+			error_msg = e.what();
+			failed = true;
+		}
+	}
+
+	const uint8* sog_data;
+	size_t sog_size;
+	const ZipIndex* index;
+	std::string filename;
+	glare::Allocator* mem_allocator;
+	AttributeImage* image_out;
+
+	bool failed;
+	std::string error_msg;
+};
+
+
+//------------------------------------------------------------------------------------------
+// Splat reconstruction
+//------------------------------------------------------------------------------------------
+
+// The decoded attribute images and meta.json values needed to reconstruct the splats.
+struct SplatAttributes
+{
+	const AttributeImage* means_l;
+	const AttributeImage* means_u;
+	const AttributeImage* scales;
+	const AttributeImage* quats;
+	const AttributeImage* sh0;
+
+	double means_mins[3];
+	double means_maxs[3];
+	float scale_table[256]; // The scales codebook, already exponentiated out of the log domain.
+	float colour_table[256]; // The sh0 codebook, already evaluated as a base colour.
+};
+
+
+// Reconstructs splats [begin, end), and returns the bounds of their positions.
+js::AABBox unpackSplats(const SplatAttributes& attr, size_t begin, size_t end, GaussianSplatData& splats)
+{
+	js::AABBox aabb = js::AABBox::emptyAABBox();
+
+	for(size_t i=begin; i<end; ++i)
+	{
+		const uint8* const means_l_px = attr.means_l->pixel(i);
+		const uint8* const means_u_px = attr.means_u->pixel(i);
+		const uint8* const scales_px  = attr.scales ->pixel(i);
+		const uint8* const quats_px   = attr.quats  ->pixel(i);
+		const uint8* const sh0_px     = attr.sh0    ->pixel(i);
+
+		// Position: a 16-bit value per axis, split into a low and a high byte across two images, giving a normalised
+		// coordinate that is then mapped onto the [mins, maxs] range and decoded out of the log domain.
+		const uint32 quantised_x = ((uint32)means_u_px[0] << 8) | means_l_px[0];
+		const uint32 quantised_y = ((uint32)means_u_px[1] << 8) | means_l_px[1];
+		const uint32 quantised_z = ((uint32)means_u_px[2] << 8) | means_l_px[2];
+
+		const Vec3f pos(
+			unlog(lerp(attr.means_mins[0], attr.means_maxs[0], quantised_x * (1.f / 65535.f))),
+			unlog(lerp(attr.means_mins[1], attr.means_maxs[1], quantised_y * (1.f / 65535.f))),
+			unlog(lerp(attr.means_mins[2], attr.means_maxs[2], quantised_z * (1.f / 65535.f))));
+
+		splats.positions[i] = pos;
+		aabb.enlargeToHoldPoint(pos.toVec4fPoint());
+
+		// Scale: one codebook index per axis.
+		splats.scales[i] = Vec3f(attr.scale_table[scales_px[0]], attr.scale_table[scales_px[1]], attr.scale_table[scales_px[2]]);
+
+		// Rotation: the "smallest three" quaternion encoding.  The three stored components are in RGB, and alpha holds
+		// 252 + the index of the omitted (largest magnitude) component, which is recovered from the other three given
+		// that the quaternion is a unit one.  The stored components are scaled so that they span [-1/sqrt(2), 1/sqrt(2)],
+		// which is the range the three smallest components of a unit quaternion can take.
+		const float inv_sqrt_2 = 0.70710678118654752f;
+		const float qa = ((quats_px[0] * (1.f / 255.f)) - 0.5f) * 2.f * inv_sqrt_2;
+		const float qb = ((quats_px[1] * (1.f / 255.f)) - 0.5f) * 2.f * inv_sqrt_2;
+		const float qc = ((quats_px[2] * (1.f / 255.f)) - 0.5f) * 2.f * inv_sqrt_2;
+		const float qd = std::sqrt(myMax(0.f, 1.f - (qa*qa + qb*qb + qc*qc)));
+
+		// Rebuild the quaternion by writing the three stored components back into the components that weren't omitted,
+		// in order, and the recovered one into the omitted slot.  Note that the index in the alpha channel is into
+		// (w, x, y, z) order, which is not the (x, y, z, w) order we store.
+		const int omitted_index = (int)quats_px[3] - 252;
+
+		Vec4f rot;
+		if(omitted_index == 0)
+			rot = Vec4f(qd, qa, qb, qc);
+		else if(omitted_index == 1)
+			rot = Vec4f(qa, qd, qb, qc);
+		else if(omitted_index == 2)
+			rot = Vec4f(qa, qb, qd, qc);
+		else
+			rot = Vec4f(qa, qb, qc, qd);
+
+		splats.rotations[i] = swizzle<1, 2, 3, 0>(rot); // Convert from wxyz to xyzw order
+
+		// Base colour, from the DC spherical harmonic term, plus opacity.
+		splats.colours[i] = Vec4f(attr.colour_table[sh0_px[0]], attr.colour_table[sh0_px[1]], attr.colour_table[sh0_px[2]], sh0_px[3] * (1.f / 255.f));
+	}
+
+	return aabb;
+}
+
+
+class UnpackSplatsTask : public glare::Task
+{
+public:
+	virtual void run(size_t /*thread_index*/) override
+	{
+		aabb = unpackSplats(*attr, begin, end, *splats);
+	}
+
+	const SplatAttributes* attr;
+	GaussianSplatData* splats;
+	size_t begin, end;
+	js::AABBox aabb;
+};
+
+
+// Reconstructs splats [0, count).  Multi-threaded if task_manager is non-null.
+void unpackAllSplats(glare::TaskManager* task_manager, const SplatAttributes& attr, size_t count, GaussianSplatData& splats)
+{
+	splats.positions.resizeNoCopy(count);
+	splats.scales   .resizeNoCopy(count);
+	splats.rotations.resizeNoCopy(count);
+	splats.colours  .resizeNoCopy(count);
+
+	const size_t min_splats_per_task = 1 << 14;
+	const size_t num_tasks = task_manager ? myMax<size_t>(1, myMin(task_manager->getConcurrency(), count / min_splats_per_task)) : 1;
+
+	js::AABBox aabb;
+	if(num_tasks == 1)
+	{
+		aabb = unpackSplats(attr, 0, count, splats);
+	}
+	else
+	{
+		const size_t splats_per_task = Maths::roundedUpDivide(count, num_tasks);
+
+		glare::TaskGroupRef group = new glare::TaskGroup();
+		for(size_t t=0; t<num_tasks; ++t)
+		{
+			Reference<UnpackSplatsTask> task = new UnpackSplatsTask();
+			task->attr = &attr;
+			task->splats = &splats;
+			task->begin = myMin(t * splats_per_task, count);
+			task->end   = myMin((t + 1) * splats_per_task, count);
+			group->tasks.push_back(task);
+		}
+		task_manager->runTaskGroup(group);
+
+		aabb = js::AABBox::emptyAABBox();
+		for(size_t t=0; t<num_tasks; ++t)
+			aabb.enlargeToHoldAABBox(group->tasks[t].downcastToPtr<UnpackSplatsTask>()->aabb);
+	}
+
+	splats.aabb_os = (count > 0) ? aabb : js::AABBox(Vec4f(0, 0, 0, 1), Vec4f(0, 0, 0, 1));
+}
+
+
 } // end anonymous namespace
 
 
-GaussianSplatDataRef SOGDecoder::decodeFromBuffer(const void* data_, size_t size, glare::Allocator* mem_allocator)
+GaussianSplatDataRef SOGDecoder::decodeFromBuffer(const void* data_, size_t size, glare::Allocator* mem_allocator, glare::TaskManager* task_manager)
 {
 	const uint8* const data = (const uint8*)data_;
 
@@ -352,10 +525,6 @@ GaussianSplatDataRef SOGDecoder::decodeFromBuffer(const void* data_, size_t size
 	if(means_mins.size() != 3 || means_maxs.size() != 3 || means_files.size() != 2)
 		throw glare::Exception("SOGDecoder: malformed 'means' entry in meta.json.");
 
-	AttributeImage means_l, means_u;
-	decodeAttributeImage(data, size, index, means_files[0], mem_allocator, means_l);
-	decodeAttributeImage(data, size, index, means_files[1], mem_allocator, means_u);
-
 	//------------------------------ scales ------------------------------
 	const JSONNode& scales_node = root.getChildObject(json, "scales");
 	const std::vector<double> scales_codebook = getChildDoubleArray(json, scales_node, "codebook");
@@ -363,18 +532,12 @@ GaussianSplatDataRef SOGDecoder::decodeFromBuffer(const void* data_, size_t size
 	if(scales_codebook.size() != 256 || scales_files.size() != 1)
 		throw glare::Exception("SOGDecoder: malformed 'scales' entry in meta.json.");
 
-	AttributeImage scales_image;
-	decodeAttributeImage(data, size, index, scales_files[0], mem_allocator, scales_image);
-
 	//------------------------------ quats (rotations) ------------------------------
 	const JSONNode& quats_node = root.getChildObject(json, "quats");
 	const std::vector<std::string> quats_files = getChildStringArray(json, quats_node, "files");
 	if(quats_files.size() != 1)
 		throw glare::Exception("SOGDecoder: malformed 'quats' entry in meta.json.");
 
-	AttributeImage quats_image;
-	decodeAttributeImage(data, size, index, quats_files[0], mem_allocator, quats_image);
-
 	//------------------------------ sh0 (base colour and opacity) ------------------------------
 	const JSONNode& sh0_node = root.getChildObject(json, "sh0");
 	const std::vector<double> sh0_codebook = getChildDoubleArray(json, sh0_node, "codebook");
@@ -382,11 +545,47 @@ GaussianSplatDataRef SOGDecoder::decodeFromBuffer(const void* data_, size_t size
 	if(sh0_codebook.size() != 256 || sh0_files.size() != 1)
 		throw glare::Exception("SOGDecoder: malformed 'sh0' entry in meta.json.");
 
-	AttributeImage sh0_image;
-	decodeAttributeImage(data, size, index, sh0_files[0], mem_allocator, sh0_image);
-
 	// Note: any shN (higher order spherical harmonic) data is deliberately ignored - see the class comment.
 
+	//------------------------------ decode the attribute images ------------------------------
+	AttributeImage means_l, means_u, scales_image, quats_image, sh0_image;
+	{
+		const std::string* const filenames[] = { &means_files[0], &means_files[1], &scales_files[0], &quats_files[0], &sh0_files[0] };
+		AttributeImage* const images[]       = { &means_l,        &means_u,        &scales_image,    &quats_image,    &sh0_image };
+		static_assert(staticArrayNumElems(filenames) == staticArrayNumElems(images), "");
+
+		if(task_manager)
+		{
+			// Each image is an independent ZIP entry and WebP file, so they can all be decoded at once.
+			glare::TaskGroupRef group = new glare::TaskGroup();
+			for(size_t i=0; i<staticArrayNumElems(images); ++i)
+			{
+				Reference<DecodeAttributeImageTask> task = new DecodeAttributeImageTask();
+				task->sog_data = data;
+				task->sog_size = size;
+				task->index = &index;
+				task->filename = *filenames[i];
+				task->mem_allocator = mem_allocator;
+				task->image_out = images[i];
+				task->failed = false;
+				group->tasks.push_back(task);
+			}
+			task_manager->runTaskGroup(group);
+
+			for(size_t i=0; i<group->tasks.size(); ++i)
+			{
+				const DecodeAttributeImageTask* task = group->tasks[i].downcastToPtr<DecodeAttributeImageTask>();
+				if(task->failed)
+					throw glare::Exception(task->error_msg);
+			}
+		}
+		else
+		{
+			for(size_t i=0; i<staticArrayNumElems(images); ++i)
+				decodeAttributeImage(data, size, index, *filenames[i], mem_allocator, *images[i]);
+		}
+	}
+
 	//------------------------------ consistency checks ------------------------------
 	checkMatchingDims(means_u,      means_l, means_files[1]);
 	checkMatchingDims(scales_image, means_l, scales_files[0]);
@@ -405,93 +604,50 @@ GaussianSplatDataRef SOGDecoder::decodeFromBuffer(const void* data_, size_t size
 		throw glare::Exception("SOGDecoder: meta.json 'count' (" + toString(count) + ") exceeds the number of pixels in the attribute images (" + toString(num_pixels) + ").");
 
 	//------------------------------ reconstruct the splats ------------------------------
-	const float SH_C0 = 0.28209479177387814f; // The constant DC spherical harmonic basis function.
-
-	GaussianSplatDataRef splats = new GaussianSplatData();
-	splats->positions.resizeNoCopy(count);
-	splats->scales   .resizeNoCopy(count);
-	splats->rotations.resizeNoCopy(count);
-	splats->colours  .resizeNoCopy(count);
-
-	js::AABBox aabb = js::AABBox::emptyAABBox();
-
-	for(size_t i=0; i<count; ++i)
+	SplatAttributes attr;
+	attr.means_l = &means_l;
+	attr.means_u = &means_u;
+	attr.scales  = &scales_image;
+	attr.quats   = &quats_image;
+	attr.sh0     = &sh0_image;
+	for(int c=0; c<3; ++c)
 	{
-		const uint8* const means_l_px = means_l     .pixel(i);
-		const uint8* const means_u_px = means_u     .pixel(i);
-		const uint8* const scales_px  = scales_image.pixel(i);
-		const uint8* const quats_px   = quats_image .pixel(i);
-		const uint8* const sh0_px     = sh0_image   .pixel(i);
-
-		// Position: a 16-bit value per axis, split into a low and a high byte across two images, giving a normalised
-		// coordinate that is then mapped onto the [mins, maxs] range and decoded out of the log domain.
-		const uint32 quantised_x = ((uint32)means_u_px[0] << 8) | means_l_px[0];
-		const uint32 quantised_y = ((uint32)means_u_px[1] << 8) | means_l_px[1];
-		const uint32 quantised_z = ((uint32)means_u_px[2] << 8) | means_l_px[2];
-
-		const Vec3f pos(
-			unlog(lerp(means_mins[0], means_maxs[0], quantised_x * (1.f / 65535.f))),
-			unlog(lerp(means_mins[1], means_maxs[1], quantised_y * (1.f / 65535.f))),
-			unlog(lerp(means_mins[2], means_maxs[2], quantised_z * (1.f / 65535.f))));
-
-		splats->positions[i] = pos;
-		aabb.enlargeToHoldPoint(pos.toVec4fPoint());
-
-		// Scale: one codebook index per axis, where the codebook holds log-domain values.
-		splats->scales[i] = Vec3f(
-			std::exp((float)scales_codebook[scales_px[0]]),
-			std::exp((float)scales_codebook[scales_px[1]]),
-			std::exp((float)scales_codebook[scales_px[2]]));
-
-		// Rotation: the "smallest three" quaternion encoding.  The three stored components are in RGB, and alpha holds
-		// 252 + the index of the omitted (largest magnitude) component, which is recovered from the other three given
-		// that the quaternion is a unit one.  The stored components are scaled so that they span [-1/sqrt(2), 1/sqrt(2)],
-		// which is the range the three smallest components of a unit quaternion can take.
-		const float inv_sqrt_2 = 0.70710678118654752f;
-		const float qa = ((quats_px[0] * (1.f / 255.f)) - 0.5f) * 2.f * inv_sqrt_2;
-		const float qb = ((quats_px[1] * (1.f / 255.f)) - 0.5f) * 2.f * inv_sqrt_2;
-		const float qc = ((quats_px[2] * (1.f / 255.f)) - 0.5f) * 2.f * inv_sqrt_2;
-		const float qd = std::sqrt(myMax(0.f, 1.f - (qa*qa + qb*qb + qc*qc)));
-
-		// Rebuild the quaternion by writing the three stored components back into the components that weren't omitted,
-		// in order, and the recovered one into the omitted slot.  Note that the index in the alpha channel is into
-		// (w, x, y, z) order, which is not the (x, y, z, w) order we store.
-		const int omitted_index = (int)quats_px[3] - 252;
-
-		Vec4f rot;
-		if(omitted_index == 0)
-			rot = Vec4f(qd, qa, qb, qc);
-		else if(omitted_index == 1)
-			rot = Vec4f(qa, qd, qb, qc);
-		else if(omitted_index == 2)
-			rot = Vec4f(qa, qb, qd, qc);
-		else
-			rot = Vec4f(qa, qb, qc, qd);
+		attr.means_mins[c] = means_mins[c];
+		attr.means_maxs[c] = means_maxs[c];
+	}
 
-		splats->rotations[i] = swizzle<1, 2, 3, 0>(rot); // Convert from wxyz to xyzw order
-
-		// Base colour, from the DC spherical harmonic term, plus opacity.  Note that this is deliberately not clamped:
-		// evaluating the DC term can land slightly outside [0, 1] (real files have codebooks reaching low enough to
-		// give around -0.035), but it's the base that any higher-order, view-dependent terms would be added to, so
-		// clamping it here would be clipping an intermediate value.  Clamping is the renderer's job - see
-		// gaussian_splat_frag_shader.glsl.
-		splats->colours[i] = Vec4f(
-			0.5f + (float)sh0_codebook[sh0_px[0]] * SH_C0,
-			0.5f + (float)sh0_codebook[sh0_px[1]] * SH_C0,
-			0.5f + (float)sh0_codebook[sh0_px[2]] * SH_C0,
-			sh0_px[3] * (1.f / 255.f));
+	const float SH_C0 = 0.28209479177387814f; // The constant DC spherical harmonic basis function.
+	for(int i=0; i<256; ++i)
+	{
+		// Scales codebook values are in the log domain.
+		attr.scale_table[i] = std::exp((float)scales_codebook[i]);
+
+		// Note that the base colour is deliberately not clamped: evaluating the DC term can land slightly outside [0, 1]
+		// (real files have codebooks reaching low enough to give around -0.035), but it's the base that any higher-order,
+		// view-dependent terms would be added to, so clamping it here would be clipping an intermediate value.  Clamping
+		// is the renderer's job - see gaussian_splat_frag_shader.glsl.
+		attr.colour_table[i] = 0.5f + (float)sh0_codebook[i] * SH_C0;
 	}
 
-	splats->aabb_os = (count > 0) ? aabb : js::AABBox(Vec4f(0, 0, 0, 1), Vec4f(0, 0, 0, 1));
+	GaussianSplatDataRef splats = new GaussianSplatData();
+	unpackAllSplats(task_manager, attr, count, *splats);
 
 	return splats;
 }
 
 
-GaussianSplatDataRef SOGDecoder::decode(const std::string& path, glare::Allocator* mem_allocator)
+GaussianSplatDataRef SOGDecoder::decode(const std::string& path, glare::Allocator* mem_allocator, glare::TaskManager* task_manager)
 {
 	MemMappedFile file(path);
-	return decodeFromBuffer(file.fileData(), file.fileSize(), mem_allocator);
+	return decodeFromBuffer(file.fileData(), file.fileSize(), mem_allocator, task_manager);
+}
+
+
+QuantisedGaussianSplatDataRef SOGDecoder::decodeQuantised(const std::string& path, glare::Allocator* mem_allocator, glare::TaskManager* task_manager)
+{
+	// SOG files are written in Morton order, which keeps the quantisation chunks spatially compact.
+	GaussianSplatDataRef splats = decode(path, mem_allocator, task_manager);
+	return QuantisedGaussianSplatData::quantise(*splats);
 }
 
 
@@ -535,6 +691,7 @@ SOGDecoder::MetaSummary SOGDecoder::readMetaSummaryFromBuffer(const void* data_,
 #include "../utils/TestUtils.h"
 #include "../utils/ConPrint.h"
 #include "../utils/Timer.h"
+#include "../maths/PCG32.h"
 
 
 #if 0
@@ -564,6 +721,88 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
 #endif
 
 
+static void checkSplatsEqual(const GaussianSplatData& a, const GaussianSplatData& b)
+{
+	testAssert(a.numSplats() == b.numSplats());
+	for(size_t i=0; i<a.numSplats(); ++i)
+	{
+		testAssert(a.positions[i] == b.positions[i]);
+		testAssert(a.scales[i] == b.scales[i]);
+		testAssert(a.rotations[i] == b.rotations[i]);
+		testAssert(a.colours[i] == b.colours[i]);
+	}
+	testAssert(a.aabb_os == b.aabb_os);
+}
+
+
+static void makeRandomAttributeImage(PCG32& rng, size_t W, size_t H, size_t N, Reference<ImageMapUInt8>& map_out, AttributeImage& image_out)
+{
+	map_out = new ImageMapUInt8(W, H, N);
+	for(size_t i=0; i<map_out->getDataSize(); ++i)
+		map_out->getData()[i] = (uint8)rng.genrand_int32();
+
+	image_out.map = map_out;
+	image_out.data = map_out->getData();
+	image_out.N = N;
+	image_out.width = W;
+	image_out.height = H;
+}
+
+
+// Benchmarks the per-splat unpacking for a multi-million splat cloud, with random attribute images, since there is no
+// test file that large.
+static void testUnpackingLargeCloud()
+{
+	const size_t W = 2048;
+	const size_t H = 2048;
+	const size_t num_splats = W * H;
+
+	PCG32 rng(1);
+	Reference<ImageMapUInt8> maps[5];
+	AttributeImage means_l, means_u, scales, quats, sh0;
+	makeRandomAttributeImage(rng, W, H, 4, maps[0], means_l);
+	makeRandomAttributeImage(rng, W, H, 4, maps[1], means_u);
+	makeRandomAttributeImage(rng, W, H, 4, maps[2], scales);
+	makeRandomAttributeImage(rng, W, H, 4, maps[3], quats);
+	makeRandomAttributeImage(rng, W, H, 4, maps[4], sh0);
+	for(size_t i=0; i<num_splats; ++i)
+		maps[3]->getData()[i * 4 + 3] = (uint8)(252 + rng.genrand_int32() % 4); // Omitted quaternion component index.
+
+	SplatAttributes attr;
+	attr.means_l = &means_l;
+	attr.means_u = &means_u;
+	attr.scales  = &scales;
+	attr.quats   = &quats;
+	attr.sh0     = &sh0;
+	for(int c=0; c<3; ++c)
+	{
+		attr.means_mins[c] = -5.0;
+		attr.means_maxs[c] = 5.0;
+	}
+	for(int i=0; i<256; ++i)
+	{
+		attr.scale_table[i] = std::exp(-10.f + i * (8.f / 255.f));
+		attr.colour_table[i] = -0.5f + i * (2.f / 255.f);
+	}
+
+	GaussianSplatData serial_splats;
+	Timer timer;
+	unpackAllSplats(/*task_manager=*/NULL, attr, num_splats, serial_splats);
+	const double serial_time = timer.elapsed();
+
+	glare::TaskManager task_manager;
+	GaussianSplatData parallel_splats;
+	timer.reset();
+	unpackAllSplats(&task_manager, attr, num_splats, parallel_splats);
+	const double parallel_time = timer.elapsed();
+
+	checkSplatsEqual(serial_splats, parallel_splats);
+
+	conPrint("Unpacked " + toString(num_splats) + " splats: serial: " + doubleToStringNSigFigs(serial_time * 1.0e3, 3) + " ms, " +
+		toString(task_manager.getNumThreads()) + " threads: " + doubleToStringNSigFigs(parallel_time * 1.0e3, 3) + " ms (" + doubleToStringNSigFigs(num_splats / parallel_time * 1.0e-6, 3) + " M splats/s)");
+}
+
+
 void SOGDecoder::test()
 {
 	conPrint("SOGDecoder::test()");
@@ -603,6 +842,16 @@ void SOGDecoder::test()
 		const MetaSummary summary = SOGDecoder::readMetaSummaryFromBuffer(file.fileData(), file.fileSize());
 		testAssert(summary.aabb_os.containsAABBox(splats->aabb_os));
 
+		// A multi-threaded decode should give exactly the same result.
+		{
+			glare::TaskManager task_manager;
+			timer.reset();
+			GaussianSplatDataRef parallel_splats = SOGDecoder::decode(sog_path, /*mem_allocator=*/NULL, &task_manager);
+			conPrint("Decoded " + toString(parallel_splats->numSplats()) + " splats with " + toString(task_manager.getNumThreads()) + " threads in " + timer.elapsedStringNSigFigs(3));
+
+			checkSplatsEqual(*splats, *parallel_splats);
+		}
+
 		for(size_t i=0; i<splats->numSplats(); ++i)
 		{
 			// Rotations should be unit quaternions.
@@ -616,6 +865,20 @@ void SOGDecoder::test()
 			// Opacity should be a valid alpha value.
 			testAssert(splats->colours[i][3] >= 0.f && splats->colours[i][3] <= 1.f);
 		}
+
+		// Test decoding straight to the quantised form.
+		{
+			QuantisedGaussianSplatDataRef quantised = SOGDecoder::decodeQuantised(sog_path);
+			testAssert(quantised->numSplats() == splats->numSplats());
+			testAssert(quantised->memUsageBytes() * 3 < splats->numSplats() * 56);
+			for(size_t i=0; i<splats->numSplats(); ++i)
+			{
+				const QuantisedGaussianSplatData::Chunk& chunk = quantised->chunks[i / QuantisedGaussianSplatData::chunk_size];
+				const Vec3f pos = quantised->getPosition(i);
+				for(unsigned int c=0; c<3; ++c)
+					testAssert(std::fabs(pos[c] - splats->positions[i][c]) <= chunk.pos_step[c] * 0.5f + 1.0e-4f);
+			}
+		}
 	}
 	catch(glare::Exception& e)
 	{
@@ -641,6 +904,30 @@ void SOGDecoder::test()
 	catch(glare::Exception&)
 	{}
 
+	// Errors decoding attribute images on worker threads should be rethrown.
+	try
+	{
+		glare::TaskManager task_manager;
+		MemMappedFile file(sog_path);
+		std::vector<uint8> corrupted((const uint8*)file.fileData(), (const uint8*)file.fileData() + file.fileSize());
+
+		// Zero the middle of the largest entry, which will be an attribute image, leaving the ZIP structure and meta.json intact.
+		const ZipIndex index = readZipIndex(corrupted.data(), corrupted.size());
+		const ZipEntry* largest_entry = NULL;
+		for(auto it = index.begin(); it != index.end(); ++it)
+			if(!largest_entry || it->second.compressed_size > largest_entry->compressed_size)
+				largest_entry = &it->second;
+		testAssert(largest_entry != NULL);
+		std::memset(&corrupted[largest_entry->data_offset + largest_entry->compressed_size / 4], 0, largest_entry->compressed_size / 2);
+
+		SOGDecoder::decodeFromBuffer(corrupted.data(), corrupted.size(), /*mem_allocator=*/NULL, &task_manager);
+		failTest("Expected exception.");
+	}
+	catch(glare::Exception&)
+	{}
+
+	testUnpackingLargeCloud();
+
 	conPrint("SOGDecoder::test() done.");
 }
 
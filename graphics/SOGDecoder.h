@@ -7,9 +7,11 @@ Copyright Glare Technologies Limited 2026 -
 
 
 #include "GaussianSplatData.h"
+#include "QuantisedGaussianSplatData.h"
 #include "../physics/jscol_aabbox.h"
 #include <string>
 namespace glare { class Allocator; }
+namespace glare { class TaskManager; }
 
 
 /*=====================================================================
@@ -30,16 +32,25 @@ a loose meta.json alongside loose .webp files.
 
 Only the DC term (sh0) of the spherical harmonics is decoded - the shN data,
 if present, is ignored, so the resulting colours are view-independent.
+
+If a task manager is passed to decode(), the attribute images are decoded
+concurrently, one task per image, and the per-splat unpacking is split over
+tasks as well.  The result is the same as a single-threaded decode.
 =====================================================================*/
 class SOGDecoder
 {
 public:
 	// All methods throw glare::Exception on failure.
 
-	static GaussianSplatDataRef decode(const std::string& path, glare::Allocator* mem_allocator = NULL);
+	// Multi-threaded if task_manager is non-null.
+	static GaussianSplatDataRef decode(const std::string& path, glare::Allocator* mem_allocator = NULL, glare::TaskManager* task_manager = NULL);
 
 	// data/size is the contents of a .sog file.
-	static GaussianSplatDataRef decodeFromBuffer(const void* data, size_t size, glare::Allocator* mem_allocator = NULL);
+	static GaussianSplatDataRef decodeFromBuffer(const void* data, size_t size, glare::Allocator* mem_allocator = NULL, glare::TaskManager* task_manager = NULL);
+
+	// Decodes, then quantises the result and frees the unquantised data, for keeping large clouds in memory.  The result can be
+	// passed straight to GaussianSplatChunks::build() and GaussianSplatRenderer::addObject().
+	static QuantisedGaussianSplatDataRef decodeQuantised(const std::string& path, glare::Allocator* mem_allocator = NULL, glare::TaskManager* task_manager = NULL);
 
 
 	struct MetaSummary
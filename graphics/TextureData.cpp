@@ -17,7 +17,12 @@ bool isCompressed(OpenGLTextureFormat format)
 		format == Format_Compressed_ETC2_RGB_Uint8 ||
 		format == Format_Compressed_ETC2_RGBA_Uint8 ||
 		format == Format_Compressed_ETC2_SRGB_Uint8 ||
-		format == Format_Compressed_ETC2_SRGBA_Uint8;
+		format == Format_Compressed_ETC2_SRGBA_Uint8 ||
+		format == Format_Compressed_BC7_RGB_Uint8 ||
+		format == Format_Compressed_BC7_RGBA_Uint8 ||
+		format == Format_Compressed_BC7_SRGB_Uint8 ||
+		format == Format_Compressed_BC7_SRGBA_Uint8 ||
+		format == Format_Compressed_BC5_Uint8;
 
 };
 
@@ -65,6 +70,11 @@ size_t bytesPerBlock(OpenGLTextureFormat format)
 		case Format_Compressed_ETC2_RGBA_Uint8: return 16;
 		case Format_Compressed_ETC2_SRGB_Uint8: return 8;
 		case Format_Compressed_ETC2_SRGBA_Uint8: return 16;
+		case Format_Compressed_BC7_RGB_Uint8: return 16;
+		case Format_Compressed_BC7_RGBA_Uint8: return 16;
+		case Format_Compressed_BC7_SRGB_Uint8: return 16;
+		case Format_Compressed_BC7_SRGBA_Uint8: return 16;
+		case Format_Compressed_BC5_Uint8: return 16;
 		default:
 			assert(0);
 			return 1;
@@ -100,6 +110,11 @@ size_t numChannels(OpenGLTextureFormat format)
 		case Format_Compressed_ETC2_RGBA_Uint8: return 4;
 		case Format_Compressed_ETC2_SRGB_Uint8: return 3;
 		case Format_Compressed_ETC2_SRGBA_Uint8: return 4;
+		case Format_Compressed_BC7_RGB_Uint8: return 3;
+		case Format_Compressed_BC7_RGBA_Uint8: return 4;
+		case Format_Compressed_BC7_SRGB_Uint8: return 3;
+		case Format_Compressed_BC7_SRGBA_Uint8: return 4;
+		case Format_Compressed_BC5_Uint8: return 2;
 		default:
 			assert(0);
 			return 1;
@@ -135,6 +150,11 @@ const char* textureFormatString(OpenGLTextureFormat format)
 		case Format_Compressed_ETC2_RGBA_Uint8: return "Format_Compressed_ETC2_RGBA_Uint8";
 		case Format_Compressed_ETC2_SRGB_Uint8: return "Format_Compressed_ETC2_SRGB_Uint8";
 		case Format_Compressed_ETC2_SRGBA_Uint8: return "Format_Compressed_ETC2_SRGBA_Uint8";
+		case Format_Compressed_BC7_RGB_Uint8: return "Format_Compressed_BC7_RGB_Uint8";
+		case Format_Compressed_BC7_RGBA_Uint8: return "Format_Compressed_BC7_RGBA_Uint8";
+		case Format_Compressed_BC7_SRGB_Uint8: return "Format_Compressed_BC7_SRGB_Uint8";
+		case Format_Compressed_BC7_SRGBA_Uint8: return "Format_Compressed_BC7_SRGBA_Uint8";
+		case Format_Compressed_BC5_Uint8: return "Format_Compressed_BC5_Uint8";
 		default:
 			assert(0);
 			return "Unknown";
@@ -176,6 +196,11 @@ double TextureData::uncompressedBitsPerChannel() const
 		case Format_Compressed_ETC2_RGBA_Uint8: return 8;
 		case Format_Compressed_ETC2_SRGB_Uint8: return 8;
 		case Format_Compressed_ETC2_SRGBA_Uint8: return 8;
+		case Format_Compressed_BC7_RGB_Uint8: return 8;
+		case Format_Compressed_BC7_RGBA_Uint8: return 8;
+		case Format_Compressed_BC7_SRGB_Uint8: return 8;
+		case Format_Compressed_BC7_SRGBA_Uint8: return 8;
+		case Format_Compressed_BC5_Uint8: return 8;
 		default:
 			assert(0);
 			return 8;
@@ -0,0 +1,240 @@
+/*=====================================================================
+TextureDiskCache.cpp
+--------------------
+Copyright Glare Technologies Limited 2026 -
+=====================================================================*/
+#include "TextureDiskCache.h"
+
+
+#include "KTXDecoder.h"
+#include "CompressedImage.h"
+#include "ImageMap.h"
+#include "../utils/FileUtils.h"
+#include "../utils/StringUtils.h"
+#include "../utils/ConPrint.h"
+#include "../utils/Lock.h"
+#include "../utils/BufferOutStream.h"
+#include "../utils/IncludeXXHash.h"
+
+
+// Increment this when the texture processing code changes the output for a given input (e.g. a change to the DXT compressor or MIP level filtering),
+// so that stale cache entries will no longer be used.
+static const int32 TEXTURE_DISK_CACHE_EPOCH = 1;
+
+
+TextureDiskCache::TextureDiskCache(const std::string& cache_dir_, size_t max_size_B_)
+:	num_hits(0),
+	num_misses(0),
+	cache_dir(cache_dir_),
+	max_size_B(max_size_B_)
+{
+	try
+	{
+		FileUtils::createDirIfDoesNotExist(cache_dir);
+
+		const std::vector<std::string> filenames = FileUtils::getFilesInDir(cache_dir);
+
+		Lock lock(mutex);
+		for(size_t i=0; i<filenames.size(); ++i)
+		{
+			if(hasExtension(filenames[i], "ktx2"))
+			{
+				try
+				{
+					const uint64 key = hexStringToUInt64(removeDotAndExtension(filenames[i]));
+					const uint64 file_size = FileUtils::getFileSize(cache_dir + "/" + filenames[i]);
+					entries.insert(key, file_size, file_size);
+				}
+				catch(glare::Exception& e)
+				{
+					conPrint("Warning: ignoring texture cache file '" + filenames[i] + "': " + e.what());
+				}
+			}
+		}
+
+		removeLRUEntriesUntilUnderMaxSize();
+	}
+	catch(FileUtils::FileUtilsExcep& e)
+	{
+		throw glare::Exception("Failed to initialise texture disk cache dir: " + e.what());
+	}
+}
+
+
+TextureDiskCache::~TextureDiskCache()
+{
+}
+
+
+bool TextureDiskCache::computeKey(const Map2D& map, bool allow_compression, bool build_mipmaps, uint64& key_out, const BlockCompressionOptions& compression_options)
+{
+	// Only 8-bit images with compression and MIP-maps enabled result in block compressed texture data.  See TextureProcessing::buildUInt8MapTextureData().
+	const ImageMapUInt8* imagemap = dynamic_cast<const ImageMapUInt8*>(&map);
+	if(!imagemap || !allow_compression || !build_mipmaps)
+		return false;
+
+	if(imagemap->getWidth() <= 1 || imagemap->getHeight() <= 1) // 1-dimensional colour lookup textures are not compressed.
+		return false;
+
+	// The quality setting doesn't affect DXT compression, so don't let it change the key.
+	const int32 quality = (compression_options.format == BlockCompressionOptions::Format_DXT) ? 0 : (int32)compression_options.quality;
+
+	const int32 params[] = { TEXTURE_DISK_CACHE_EPOCH, (int32)imagemap->getWidth(), (int32)imagemap->getHeight(), (int32)imagemap->getN(), allow_compression ? 1 : 0, build_mipmaps ? 1 : 0,
+		(int32)compression_options.format, quality };
+
+	XXH64_state_t hash_state;
+	XXH64_reset(&hash_state, 1);
+	XXH64_update(&hash_state, params, sizeof(params));
+	XXH64_update(&hash_state, imagemap->getData(), imagemap->getDataSize() * sizeof(uint8));
+	key_out = XXH64_digest(&hash_state);
+	return true;
+}
+
+
+bool TextureDiskCache::isCacheable(const TextureData& texture_data)
+{
+	const OpenGLTextureFormat format = texture_data.format;
+	return (format == OpenGLTextureFormat::Format_Compressed_DXT_SRGB_Uint8 || format == OpenGLTextureFormat::Format_Compressed_DXT_SRGBA_Uint8 ||
+		format == OpenGLTextureFormat::Format_Compressed_BC7_SRGB_Uint8 || format == OpenGLTextureFormat::Format_Compressed_BC7_SRGBA_Uint8 || 
+		format == OpenGLTextureFormat::Format_Compressed_BC5_Uint8) &&
+		!texture_data.isMultiFrame() && !texture_data.isArrayTexture() && (texture_data.D == 1) && !texture_data.level_offsets.empty();
+}
+
+
+std::string TextureDiskCache::cacheFilePath(uint64 key) const
+{
+	return cache_dir + "/" + toHexString(key) + ".ktx2";
+}
+
+
+Reference<TextureData> TextureDiskCache::lookup(uint64 key, glare::Allocator* mem_allocator)
+{
+	{
+		Lock lock(mutex);
+		if(!entries.isInserted(key))
+		{
+			num_misses++;
+			return Reference<TextureData>();
+		}
+		entries.itemWasUsed(key);
+	}
+
+	try
+	{
+		// decodeKTX2 memory-maps the file.  Since the cache files are not supercompressed, the level data is just copied out.
+		Reference<Map2D> map = KTXDecoder::decodeKTX2(cacheFilePath(key), mem_allocator);
+		CompressedImage* compressed_image = dynamic_cast<CompressedImage*>(map.ptr());
+		if(!compressed_image)
+			throw glare::Exception("Cache file did not contain compressed image data.");
+
+		Lock lock(mutex);
+		num_hits++;
+		return compressed_image->texture_data;
+	}
+	catch(glare::Exception& e)
+	{
+		conPrint("Warning: failed to read texture cache file: " + e.what());
+
+		// Remove the bad entry, so it will be rebuilt and re-inserted.
+		Lock lock(mutex);
+		auto res = entries.find(key);
+		if(res != entries.end())
+		{
+			entries.erase(res);
+			try
+			{
+				FileUtils::deleteFile(cacheFilePath(key));
+			}
+			catch(FileUtils::FileUtilsExcep&)
+			{}
+		}
+		num_misses++;
+		return Reference<TextureData>();
+	}
+}
+
+
+void TextureDiskCache::insert(uint64 key, const TextureData& texture_data)
+{
+	if(!isCacheable(texture_data))
+		return;
+
+	{
+		Lock lock(mutex);
+		if(entries.isInserted(key))
+			return;
+	}
+
+	try
+	{
+		// Copy out the level data for the KTX2 writer.
+		std::vector<std::vector<uint8> > level_image_data(texture_data.level_offsets.size());
+		for(size_t i=0; i<texture_data.level_offsets.size(); ++i)
+		{
+			const TextureData::LevelOffsetData& level = texture_data.level_offsets[i];
+			if(level.offset + level.level_size > texture_data.mipmap_data.size())
+				throw glare::Exception("Invalid level offset.");
+			level_image_data[i].resize(level.level_size);
+			std::memcpy(level_image_data[i].data(), texture_data.mipmap_data.data() + level.offset, level.level_size);
+		}
+
+		KTXDecoder::Format format;
+		if(texture_data.format == OpenGLTextureFormat::Format_Compressed_DXT_SRGB_Uint8)
+			format = KTXDecoder::Format_BC1;
+		else if(texture_data.format == OpenGLTextureFormat::Format_Compressed_DXT_SRGBA_Uint8)
+			format = KTXDecoder::Format_BC3;
+		else if(texture_data.format == OpenGLTextureFormat::Format_Compressed_BC5_Uint8)
+			format = KTXDecoder::Format_BC5;
+		else
+			format = KTXDecoder::Format_BC7;
+
+		// Don't use supercompression, so that reading the file back is just a copy.  Block compressed data doesn't compress much further anyway.
+		BufferOutStream file_data;
+		KTXDecoder::writeKTX2ToStream(format, /*supercompression=*/false, (int)texture_data.W, (int)texture_data.H, level_image_data, file_data);
+
+		// Write atomically so that a concurrent lookup can't read a partially written file.
+		FileUtils::writeEntireFileAtomically(cacheFilePath(key), (const char*)file_data.buf.data(), file_data.buf.size());
+
+		Lock lock(mutex);
+		entries.insert(key, file_data.buf.size(), file_data.buf.size());
+		removeLRUEntriesUntilUnderMaxSize();
+	}
+	catch(glare::Exception& e)
+	{
+		conPrint("Warning: failed to write texture cache file: " + e.what());
+	}
+}
+
+
+void TextureDiskCache::removeLRUEntriesUntilUnderMaxSize()
+{
+	while(entries.totalValueSizeB() > max_size_B)
+	{
+		uint64 removed_key, removed_size;
+		if(!entries.removeLRUItem(removed_key, removed_size))
+			break;
+
+		try
+		{
+			FileUtils::deleteFile(cacheFilePath(removed_key));
+		}
+		catch(FileUtils::FileUtilsExcep& e)
+		{
+			conPrint("Warning: failed to delete texture cache file: " + e.what());
+		}
+	}
+}
+
+
+size_t TextureDiskCache::numEntries()
+{
+	Lock lock(mutex);
+	return entries.numItems();
+}
+
+
+size_t TextureDiskCache::totalSizeB()
+{
+	Lock lock(mutex);
+	return entries.totalValueSizeB();
+}
@@ -0,0 +1,78 @@
+/*=====================================================================
+TextureDiskCache.h
+------------------
+Copyright Glare Technologies Limited 2026 -
+=====================================================================*/
+#pragma once
+
+
+#include "TextureData.h"
+#include "TextureProcessing.h"
+#include "../utils/ThreadSafeRefCounted.h"
+#include "../utils/Reference.h"
+#include "../utils/Mutex.h"
+#include "../utils/LRUCache.h"
+#include <string>
+class Map2D;
+namespace glare { class Allocator; }
+
+
+/*=====================================================================
+TextureDiskCache
+----------------
+Persistent on-disk cache of processed texture data (all MIP levels, block compressed),
+as built by TextureProcessing::buildTextureData().
+Building the MIP levels and doing the block compression is expensive, so caching
+the result means subsequent loads of the same image just need to map the cache file
+and copy the level data out.
+
+Entries are keyed by a hash of the source image data and processing options,
+and are stored as KTX2 files in the cache dir.
+The total size of the cache files is kept under max_size_B by removing least recently used entries.
+Entries already on disk when the cache is constructed are treated as less recently used than any
+entry looked up or inserted since.
+
+Only single-frame, non-array, DXT, BC7 or BC5 compressed texture data is cached, since that is what
+KTX2 writing currently handles, and is the expensive case to build.
+
+Threadsafe.
+Tests are in TextureProcessingTests.cpp
+=====================================================================*/
+class TextureDiskCache : public ThreadSafeRefCounted
+{
+public:
+	// Creates cache_dir if it does not exist, and scans it for existing cache files.
+	// Throws glare::Exception if the dir could not be created or read.
+	TextureDiskCache(const std::string& cache_dir, size_t max_size_B);
+	~TextureDiskCache();
+
+	// Computes the cache key for the texture data that would be built from map with the given options.
+	// Returns false if the texture data for the map would not be cacheable (e.g. map is not an ImageMapUInt8 or compression is not allowed).
+	static bool computeKey(const Map2D& map, bool allow_compression, bool build_mipmaps, uint64& key_out, const BlockCompressionOptions& compression_options = BlockCompressionOptions());
+
+	static bool isCacheable(const TextureData& texture_data);
+
+	// Returns a null reference if there is no entry for the key, or if the cache file could not be read.
+	Reference<TextureData> lookup(uint64 key, glare::Allocator* mem_allocator);
+
+	// Writes the texture data to the cache, if it is cacheable and there is not already an entry for the key.
+	// Removes least recently used entries as needed to keep the total size under max_size_B.
+	// Failures to write are just printed as warnings.
+	void insert(uint64 key, const TextureData& texture_data);
+
+	size_t numEntries();
+	size_t totalSizeB();
+
+	Mutex mutex;
+	uint64 num_hits				GUARDED_BY(mutex);
+	uint64 num_misses			GUARDED_BY(mutex);
+private:
+	std::string cacheFilePath(uint64 key) const;
+	void removeLRUEntriesUntilUnderMaxSize() REQUIRES(mutex);
+
+	std::string cache_dir;
+	size_t max_size_B;
+	LRUCache<uint64, uint64> entries GUARDED_BY(mutex); // Map from key to cache file size.
+};
+
+typedef Reference<TextureDiskCache> TextureDiskCacheRef;
@@ -9,7 +9,9 @@ Copyright Glare Technologies Limited 2022 -
 #include "OpenGLEngine.h"
 #include "../graphics/ImageMap.h"
 #include "../graphics/DXTCompression.h"
+#include "../graphics/TextureDiskCache.h"
 #include "../maths/mathstypes.h"
+#include "../maths/SSE.h"
 #include "../utils/Timer.h"
 #include "../utils/Task.h"
 #include "../utils/TaskManager.h"
@@ -22,12 +24,107 @@ Copyright Glare Technologies Limited 2022 -
 #include <graphics/CompressedImage.h>
 
 
+// Downsamples the first (level_W / 4) * 4 pixels of a destination row of an RGBA image with a 2x2 box filter, 4 destination pixels at a time.
+// src_row_0 and src_row_1 are the two source rows.  Gives exactly the same results as the scalar code in downSampleToNextMipMapLevel().
+// Returns the number of destination pixels written.
+static size_t downSampleRGBARowSSE(const uint8* src_row_0, const uint8* src_row_1, size_t level_W, float alpha_scale, uint8* dst_row, int& num_opaque_px)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+	const __m128 alpha_scale_v = _mm_set1_ps(alpha_scale);
+	const __m128 max_alpha = _mm_set1_ps(255.f);
+	const __m128i opaque_threshold = _mm_set1_epi32(185);
+	__m128i opaque_counts = _mm_setzero_si128();
+
+	const size_t num_simd_px = level_W & ~(size_t)3;
+	for(size_t x=0; x<num_simd_px; x += 4)
+	{
+		// Load 8 source pixels from each row
+		const __m128i a0 = _mm_loadu_si128((const __m128i*)(src_row_0 + x*8));
+		const __m128i a1 = _mm_loadu_si128((const __m128i*)(src_row_0 + x*8 + 16));
+		const __m128i b0 = _mm_loadu_si128((const __m128i*)(src_row_1 + x*8));
+		const __m128i b1 = _mm_loadu_si128((const __m128i*)(src_row_1 + x*8 + 16));
+
+		// Vertical sums as 16-bit values, 2 source pixels per vector.
+		const __m128i v01 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+		const __m128i v23 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+		const __m128i v45 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+		const __m128i v67 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+		// Add horizontally adjacent source pixels to get destination pixels 0, 1 and 2, 3.
+		const __m128i d01 = _mm_add_epi16(_mm_unpacklo_epi64(v01, v23), _mm_unpackhi_epi64(v01, v23));
+		const __m128i d23 = _mm_add_epi16(_mm_unpacklo_epi64(v45, v67), _mm_unpackhi_epi64(v45, v67));
+
+		const __m128i avg = _mm_packus_epi16(_mm_srli_epi16(d01, 2), _mm_srli_epi16(d23, 2)); // Divide by 4 and pack to 8 bits.
+
+		// Scale alpha, using the same float operations as the scalar code.
+		const __m128i alpha = _mm_cvttps_epi32(_mm_min_ps(_mm_mul_ps(alpha_scale_v, _mm_cvtepi32_ps(_mm_srli_epi32(avg, 24))), max_alpha));
+		_mm_storeu_si128((__m128i*)(dst_row + x*4), _mm_or_si128(_mm_and_si128(avg, rgb_mask), _mm_slli_epi32(alpha, 24)));
+
+		opaque_counts = _mm_sub_epi32(opaque_counts, _mm_cmpgt_epi32(alpha, opaque_threshold)); // Comparison results are -1 where alpha >= 186.
+	}
+
+	SSE_ALIGN int32 counts[4];
+	_mm_store_si128((__m128i*)counts, opaque_counts);
+	num_opaque_px += counts[0] + counts[1] + counts[2] + counts[3];
+
+	return num_simd_px;
+}
+
+
+// As downSampleRGBARowSSE() but for RGB images.
+static size_t downSampleRGBRowSSE(const uint8* src_row_0, const uint8* src_row_1, size_t level_W, uint8* dst_row)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lanes_012_mask = _mm_setr_epi16(-1, -1, -1, 0, 0, 0, 0, 0);
+
+	const size_t num_simd_px = level_W & ~(size_t)3;
+	for(size_t x=0; x<num_simd_px; x += 4)
+	{
+		// Load 8 source pixels (24 bytes) from each row
+		const uint8* const s0 = src_row_0 + x*6;
+		const uint8* const s1 = src_row_1 + x*6;
+		const __m128i a0 = _mm_loadu_si128((const __m128i*)s0);
+		const __m128i a1 = _mm_loadl_epi64((const __m128i*)(s0 + 16));
+		const __m128i b0 = _mm_loadu_si128((const __m128i*)s1);
+		const __m128i b1 = _mm_loadl_epi64((const __m128i*)(s1 + 16));
+
+		// Vertical sums as 16-bit values.  sum_i holds the sums for source bytes [8i, 8i + 8).
+		const __m128i sum_0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+		const __m128i sum_1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+		const __m128i sum_2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+
+		// Move the sums for source pixels 2i and 2i + 1 (source bytes [6i, 6i + 6)) to lanes 0-5 of p_i.
+		const __m128i p0 = sum_0;
+		const __m128i p1 = _mm_or_si128(_mm_srli_si128(sum_0, 12), _mm_slli_si128(sum_1, 4));
+		const __m128i p2 = _mm_or_si128(_mm_srli_si128(sum_1, 8), _mm_slli_si128(sum_2, 8));
+		const __m128i p3 = _mm_srli_si128(sum_2, 4);
+
+		// Add the two source pixels and divide by 4, leaving destination pixel i in lanes 0-2 of d_i.
+		const __m128i d0 = _mm_and_si128(_mm_srli_epi16(_mm_add_epi16(p0, _mm_srli_si128(p0, 6)), 2), lanes_012_mask);
+		const __m128i d1 = _mm_and_si128(_mm_srli_epi16(_mm_add_epi16(p1, _mm_srli_si128(p1, 6)), 2), lanes_012_mask);
+		const __m128i d2 = _mm_and_si128(_mm_srli_epi16(_mm_add_epi16(p2, _mm_srli_si128(p2, 6)), 2), lanes_012_mask);
+		const __m128i d3 = _mm_and_si128(_mm_srli_epi16(_mm_add_epi16(p3, _mm_srli_si128(p3, 6)), 2), lanes_012_mask);
+
+		// Interleave the destination pixels into 12 bytes and store.
+		const __m128i lo = _mm_or_si128(d0, _mm_or_si128(_mm_slli_si128(d1, 6), _mm_slli_si128(d2, 12))); // Destination bytes 0-7
+		const __m128i hi = _mm_or_si128(_mm_srli_si128(d2, 4), _mm_slli_si128(d3, 2)); // Destination bytes 8-11 in lanes 0-3
+		const __m128i packed = _mm_packus_epi16(lo, hi);
+		_mm_storel_epi64((__m128i*)(dst_row + x*3), packed);
+		const int32 last_4_bytes = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+		std::memcpy(dst_row + x*3 + 8, &last_4_bytes, 4);
+	}
+
+	return num_simd_px;
+}
+
+
 // Downsize previous mip level image to current mip level.
 // Just uses kinda crappy 2x2 pixel box filter.
 // alpha_coverage_out: frac of pixels with alpha >= 0.5, set if N == 4.
 // N = num components per pixel.
 void TextureProcessing::downSampleToNextMipMapLevel(size_t prev_W, size_t prev_H, size_t N, const uint8* prev_level_image_data, float alpha_scale, size_t level_W, size_t level_H,
-	uint8* data_out, float& alpha_coverage_out)
+	uint8* data_out, float& alpha_coverage_out, bool use_simd)
 {
 	Timer timer;
 	uint8* const dst_data = data_out;
@@ -205,7 +302,12 @@ void TextureProcessing::downSampleToNextMipMapLevel(size_t prev_W, size_t prev_H
 
 			// In this case all reads should be in-bounds
 			for(int y=0; y<(int)level_H; ++y)
-				for(int x=0; x<(int)level_W; ++x)
+			{
+				int x = 0;
+				if(use_simd) // Do most of the row with SIMD code, then the remaining pixels with the scalar code below.
+					x = (int)downSampleRGBRowSSE(src_data + src_W * (y*2) * N, src_data + src_W * (y*2 + 1) * N, level_W, dst_data + level_W * y * N);
+
+				for(; x<(int)level_W; ++x)
 				{
 					int val[3] = { 0, 0, 0 };
 					int sx = x*2;
@@ -244,6 +346,7 @@ void TextureProcessing::downSampleToNextMipMapLevel(size_t prev_W, size_t prev_H
 					dest_pixel[1] = (uint8)(val[1] / 4);
 					dest_pixel[2] = (uint8)(val[2] / 4);
 				}
+			}
 		}
 	}
 	else // else if(N == 4):
@@ -329,7 +432,12 @@ void TextureProcessing::downSampleToNextMipMapLevel(size_t prev_W, size_t prev_H
 
 			// In this case all reads should be in-bounds
 			for(int y=0; y<(int)level_H; ++y)
-				for(int x=0; x<(int)level_W; ++x)
+			{
+				int x = 0;
+				if(use_simd) // Do most of the row with SIMD code, then the remaining pixels with the scalar code below.
+					x = (int)downSampleRGBARowSSE(src_data + src_W * (y*2) * N, src_data + src_W * (y*2 + 1) * N, level_W, alpha_scale, dst_data + level_W * y * N, num_opaque_px);
+
+				for(; x<(int)level_W; ++x)
 				{
 					int val[4] = { 0, 0, 0, 0 };
 					int sx = x*2;
@@ -376,6 +484,7 @@ void TextureProcessing::downSampleToNextMipMapLevel(size_t prev_W, size_t prev_H
 					if(dest_pixel[3] >= 186) // 186 = floor(256 * (0.5 ^ (1/2.2))), e.g. the value that when divided by 256 and then raised to the power of 2.2 (~ sRGB gamma), is 0.5.
 						num_opaque_px++;
 				}
+			}
 		}
 
 		alpha_coverage_out = num_opaque_px / (float)(level_W * level_H);
@@ -414,15 +523,14 @@ int TextureProcessing::computeNumMIPLevels(size_t W, size_t H)
 //
 // So temp_tex_buf_a is used for odd levels, with max size used for level 1, and temp_tex_buf_b is used for even levels >= 2, with max size used for level 2.
 //
-// Only defined for 8-bit image data
-static void computeMipLevelOffsets(TextureData* texture_data, bool do_compression, size_t& total_compressed_size_out, size_t& temp_tex_buf_a_size_out, size_t& temp_tex_buf_b_size_out)
+// Only defined for 8-bit image data.  bytes_pp is the number of bytes per pixel of the uncompressed data.
+static void computeMipLevelOffsets(TextureData* texture_data, bool do_compression, size_t bytes_pp, size_t& total_compressed_size_out, size_t& temp_tex_buf_a_size_out, size_t& temp_tex_buf_b_size_out)
 {
 	temp_tex_buf_a_size_out = 0;
 	temp_tex_buf_b_size_out = 0;
 
 	const size_t W			= texture_data->W;
 	const size_t H			= texture_data->H;
-	const size_t bytes_pp	= texture_data->numChannels();
 	
 	texture_data->level_offsets.reserve(16); // byte offset for each mipmap level
 	size_t cur_offset = 0;
@@ -438,7 +546,7 @@ static void computeMipLevelOffsets(TextureData* texture_data, bool do_compressio
 		else if(k == 2)
 			temp_tex_buf_b_size_out = level_uncompressed_tex_size;
 
-		const size_t result_level_compressed_size = do_compression ? DXTCompression::getCompressedSizeBytes(level_W, level_H, bytes_pp) : level_uncompressed_tex_size;
+		const size_t result_level_compressed_size = do_compression ? (TextureData::computeNum4PixelBlocksForLevel(W, H, k) * bytesPerBlock(texture_data->format)) : level_uncompressed_tex_size;
 
 		texture_data->level_offsets.push_back(TextureData::LevelOffsetData(cur_offset, result_level_compressed_size));
 
@@ -473,12 +581,12 @@ static float computeAlphaCoverage(const uint8* level_image_data, size_t level_W,
 // Stores the possibly-DXT compressed image data in texture_data->frames[cur_frame_i].compressed_data.
 // Uses task_manager for multi-threading if non-null.
 // Called by buildUInt8MapTextureData() and buildUInt8MapSequenceTextureData() to do the actual downsizing and compression work.
-void TextureProcessing::buildMipMapDataForImageFrame(bool do_compression, js::Vector<uint8, 16>& temp_tex_buf_a, js::Vector<uint8, 16>& temp_tex_buf_b, 
-	DXTCompression::TempData& compress_temp_data, TextureData* texture_data, size_t cur_frame_i, const ImageMapUInt8* source_image, glare::TaskManager* task_manager)
+void TextureProcessing::buildMipMapDataForImageFrame(bool do_compression, BCCompression::Quality bc_quality, js::Vector<uint8, 16>& temp_tex_buf_a, js::Vector<uint8, 16>& temp_tex_buf_b, 
+	DXTCompression::TempData& compress_temp_data, BCCompression::TempData& bc_compress_temp_data, TextureData* texture_data, size_t cur_frame_i, const ImageMapUInt8* source_image, glare::TaskManager* task_manager)
 {
 	const size_t W			= texture_data->W;
 	const size_t H			= texture_data->H;
-	const size_t bytes_pp	= texture_data->numChannels();
+	const size_t bytes_pp	= source_image->getN(); // May differ from the number of channels of the texture format, e.g. for BC7 or BC5 compression of an RGB image.
 
 	float level_0_alpha_coverage = 0;
 	for(size_t k=0; ; ++k) // For each mipmap level:
@@ -565,11 +673,22 @@ void TextureProcessing::buildMipMapDataForImageFrame(bool do_compression, js::Ve
 		const size_t level_size   = texture_data->level_offsets[k].level_size;
 		if(do_compression)
 		{
-			runtimeCheck((level_size == DXTCompression::getCompressedSizeBytes(level_W, level_H, bytes_pp)) && 
+			runtimeCheck((level_size == TextureData::computeNum4PixelBlocksForLevel(W, H, k) * bytesPerBlock(texture_data->format)) && 
 				(level_offset + level_size <= texture_data->mipmap_data.size()));
 
-			DXTCompression::compress(task_manager, compress_temp_data, level_W, level_H, bytes_pp, /*src data=*/level_uncompressed_data,
-				/*dst data=*/&texture_data->mipmap_data[level_offset], /*dst size=*/level_size);
+			const OpenGLTextureFormat format = texture_data->format;
+			if(format == OpenGLTextureFormat::Format_Compressed_BC7_SRGB_Uint8 || format == OpenGLTextureFormat::Format_Compressed_BC7_SRGBA_Uint8)
+				BCCompression::compress(task_manager, bc_compress_temp_data, BCCompression::Format_BC7, bc_quality, level_W, level_H, bytes_pp, /*src data=*/level_uncompressed_data,
+					/*dst data=*/&texture_data->mipmap_data[level_offset], /*dst size=*/level_size);
+			else if(format == OpenGLTextureFormat::Format_Compressed_BC5_Uint8)
+				BCCompression::compress(task_manager, bc_compress_temp_data, BCCompression::Format_BC5, bc_quality, level_W, level_H, bytes_pp, /*src data=*/level_uncompressed_data,
+					/*dst data=*/&texture_data->mipmap_data[level_offset], /*dst size=*/level_size);
+			else
+			{
+				runtimeCheck(level_size == DXTCompression::getCompressedSizeBytes(level_W, level_H, bytes_pp));
+				DXTCompression::compress(task_manager, compress_temp_data, level_W, level_H, bytes_pp, /*src data=*/level_uncompressed_data,
+					/*dst data=*/&texture_data->mipmap_data[level_offset], /*dst size=*/level_size);
+			}
 		}
 		else
 		{
@@ -593,13 +712,34 @@ static Reference<ImageMapUInt8> convertUInt16ToUInt8ImageMap(const ImageMap<uint
 }
 
 
-Reference<TextureData> TextureProcessing::buildTextureData(const Map2D* map, glare::Allocator* general_mem_allocator, glare::TaskManager* task_manager, bool allow_compression, bool build_mipmaps, bool convert_float_to_half)
+Reference<TextureData> TextureProcessing::buildTextureData(const Map2D* map, glare::Allocator* general_mem_allocator, glare::TaskManager* task_manager, bool allow_compression, bool build_mipmaps, bool convert_float_to_half, 
+	TextureDiskCache* disk_cache, const BlockCompressionOptions& compression_options)
 {
+	if(disk_cache)
+	{
+		uint64 cache_key;
+		if(TextureDiskCache::computeKey(*map, allow_compression, build_mipmaps, cache_key, compression_options))
+		{
+			Reference<TextureData> cached_texture_data = disk_cache->lookup(cache_key, general_mem_allocator);
+			if(cached_texture_data.nonNull())
+			{
+				// KTX2 files don't record whether BC7 data has meaningful alpha, so restore the opaque format that would have been built for images without alpha.
+				if(cached_texture_data->format == OpenGLTextureFormat::Format_Compressed_BC7_SRGBA_Uint8 && (map->numChannels() == 1 || map->numChannels() == 3))
+					cached_texture_data->format = OpenGLTextureFormat::Format_Compressed_BC7_SRGB_Uint8;
+				return cached_texture_data;
+			}
+
+			Reference<TextureData> texture_data = buildTextureData(map, general_mem_allocator, task_manager, allow_compression, build_mipmaps, convert_float_to_half, /*disk_cache=*/NULL, compression_options);
+			disk_cache->insert(cache_key, *texture_data); // Only inserted if cacheable.
+			return texture_data;
+		}
+	}
+
 	if(dynamic_cast<const ImageMapUInt8*>(map))
 	{
 		const ImageMapUInt8* imagemap = static_cast<const ImageMapUInt8*>(map);
 
-		return buildUInt8MapTextureData(imagemap, general_mem_allocator, task_manager, allow_compression, build_mipmaps);
+		return buildUInt8MapTextureData(imagemap, general_mem_allocator, task_manager, allow_compression, build_mipmaps, compression_options);
 	}
 	else if(dynamic_cast<const ImageMapSequenceUInt8*>(map))
 	{
@@ -612,7 +752,7 @@ Reference<TextureData> TextureProcessing::buildTextureData(const Map2D* map, gla
 		// Convert to 8-bit
 		Reference<ImageMapUInt8> im_map_uint8 = convertUInt16ToUInt8ImageMap(static_cast<const ImageMap<uint16, UInt16ComponentValueTraits>&>(*map));
 
-		return buildUInt8MapTextureData(im_map_uint8.ptr(), general_mem_allocator, task_manager, allow_compression, build_mipmaps);
+		return buildUInt8MapTextureData(im_map_uint8.ptr(), general_mem_allocator, task_manager, allow_compression, build_mipmaps, compression_options);
 	}
 	else if(dynamic_cast<const CompressedImage*>(map))
 	{
@@ -679,7 +819,7 @@ Reference<TextureData> TextureProcessing::buildTextureData(const Map2D* map, gla
 
 
 Reference<TextureData> TextureProcessing::buildUInt8MapTextureData(const ImageMapUInt8* imagemap, glare::Allocator* general_mem_allocator, 
-	glare::TaskManager* task_manager, bool allow_compression, bool build_mipmaps)
+	glare::TaskManager* task_manager, bool allow_compression, bool build_mipmaps, const BlockCompressionOptions& compression_options)
 {
 	if(imagemap->getWidth() == 0 || imagemap->getHeight() == 0 || imagemap->getN() == 0)
 		throw glare::Exception("zero sized image not allowed.");
@@ -751,22 +891,31 @@ Reference<TextureData> TextureProcessing::buildUInt8MapTextureData(const ImageMa
 	{
 		const bool do_compression = allow_compression && !is_one_dim_col_lookup_tex;
 		if(do_compression)
-			texture_data->format = (converted_image->getN() == 3) ? OpenGLTextureFormat::Format_Compressed_DXT_SRGB_Uint8 : OpenGLTextureFormat::Format_Compressed_DXT_SRGBA_Uint8;
+		{
+			if(compression_options.format == BlockCompressionOptions::Format_BC7)
+				texture_data->format = (converted_image->getN() == 3) ? OpenGLTextureFormat::Format_Compressed_BC7_SRGB_Uint8 : OpenGLTextureFormat::Format_Compressed_BC7_SRGBA_Uint8;
+			else if(compression_options.format == BlockCompressionOptions::Format_BC5)
+				texture_data->format = OpenGLTextureFormat::Format_Compressed_BC5_Uint8;
+			else
+				texture_data->format = (converted_image->getN() == 3) ? OpenGLTextureFormat::Format_Compressed_DXT_SRGB_Uint8 : OpenGLTextureFormat::Format_Compressed_DXT_SRGBA_Uint8;
+		}
 		else
 			texture_data->format = (converted_image->getN() == 1) ? OpenGLTextureFormat::Format_Greyscale_Uint8 : ((converted_image->getN() == 3) ? OpenGLTextureFormat::Format_SRGB_Uint8 : OpenGLTextureFormat::Format_SRGBA_Uint8);
 
 		size_t total_compressed_size, temp_tex_buf_a_size, temp_tex_buf_b_size;
-		computeMipLevelOffsets(texture_data.ptr(), do_compression, total_compressed_size, temp_tex_buf_a_size, temp_tex_buf_b_size);
+		computeMipLevelOffsets(texture_data.ptr(), do_compression, converted_image->getN(), total_compressed_size, temp_tex_buf_a_size, temp_tex_buf_b_size);
 
 		js::Vector<uint8, 16> temp_tex_buf_a(temp_tex_buf_a_size);
 		js::Vector<uint8, 16> temp_tex_buf_b(temp_tex_buf_b_size);
 		DXTCompression::TempData compress_temp_data;
+		BCCompression::TempData bc_compress_temp_data;
 
 		// Stores possibly-DXT compressed image data in texture_data->frames[cur_frame_i].mipmap_data.
 		texture_data->mipmap_data.resize(total_compressed_size);
 		texture_data->frame_size_B = total_compressed_size;
 
-		buildMipMapDataForImageFrame(/*total_compressed_size, */do_compression, temp_tex_buf_a, temp_tex_buf_b, compress_temp_data, texture_data.ptr(), /*cur frame i=*/0, /*source image=*/converted_image.ptr(), task_manager);
+		buildMipMapDataForImageFrame(/*total_compressed_size, */do_compression, compression_options.quality, temp_tex_buf_a, temp_tex_buf_b, compress_temp_data, bc_compress_temp_data, 
+			texture_data.ptr(), /*cur frame i=*/0, /*source image=*/converted_image.ptr(), task_manager);
 	}
 	else
 	{
@@ -812,7 +961,7 @@ Reference<TextureData> TextureProcessing::buildUInt8MapSequenceTextureData(const
 	texture_data->format = format;
 
 	size_t total_compressed_size, temp_tex_buf_a_size, temp_tex_buf_b_size;
-	computeMipLevelOffsets(texture_data.ptr(), do_compression, total_compressed_size, temp_tex_buf_a_size, temp_tex_buf_b_size);
+	computeMipLevelOffsets(texture_data.ptr(), do_compression, imagemap_0->getN(), total_compressed_size, temp_tex_buf_a_size, temp_tex_buf_b_size);
 
 	texture_data->mipmap_data.resize(total_compressed_size * seq->images.size()); // Allocate space for mipmap data
 	texture_data->frame_size_B = total_compressed_size;
@@ -821,6 +970,7 @@ Reference<TextureData> TextureProcessing::buildUInt8MapSequenceTextureData(const
 	js::Vector<uint8, 16> temp_tex_buf_a(temp_tex_buf_a_size);
 	js::Vector<uint8, 16> temp_tex_buf_b(temp_tex_buf_b_size);
 	DXTCompression::TempData compress_temp_data;
+	BCCompression::TempData bc_compress_temp_data;
 
 	for(size_t frame_i = 0; frame_i != texture_data->num_frames; ++frame_i)
 	{
@@ -828,10 +978,13 @@ Reference<TextureData> TextureProcessing::buildUInt8MapSequenceTextureData(const
 
 		if(imagemap->getN() != 3 && imagemap->getN() != 4)
 			throw glare::Exception("Texture has unhandled number of components: " + toString(imagemap->getN()));
+		if(imagemap->getN() != imagemap_0->getN() || imagemap->getWidth() != W || imagemap->getHeight() != H)
+			throw glare::Exception("Image sequence frames have differing dimensions or number of components.");
 
 		if(build_mipmaps)
 		{
-			buildMipMapDataForImageFrame(do_compression, temp_tex_buf_a, temp_tex_buf_b, compress_temp_data, texture_data.ptr(), /*cur frame i=*/frame_i, /*source image=*/imagemap, task_manager);
+			buildMipMapDataForImageFrame(do_compression, BCCompression::Quality_Normal, temp_tex_buf_a, temp_tex_buf_b, compress_temp_data, bc_compress_temp_data, 
+				texture_data.ptr(), /*cur frame i=*/frame_i, /*source image=*/imagemap, task_manager);
 		}
 		else
 		{
@@ -9,6 +9,7 @@ Copyright Glare Technologies Limited 2022 -
 #include "TextureData.h"
 #include "ImageMap.h"
 #include "ImageMapSequence.h"
+#include "BCCompression.h"
 #include "../utils/RefCounted.h"
 #include "../utils/ThreadSafeRefCounted.h"
 #include "../utils/Reference.h"
@@ -20,6 +21,25 @@ Copyright Glare Technologies Limited 2022 -
 namespace DXTCompression { struct TempData; }
 namespace glare { class TaskManager; }
 namespace glare { class Allocator; }
+class TextureDiskCache;
+
+
+// Block compression format and quality to use for 8-bit images, when compression is allowed.
+struct BlockCompressionOptions
+{
+	enum Format
+	{
+		Format_DXT, // BC1 for RGB images, BC3 for RGBA images.
+		Format_BC7, // BC7 for RGB and RGBA images.  Better quality than DXT, at the same size as BC3.  Requires BPTC support.
+		Format_BC5  // BC5, storing the first two channels only.  For tangent-space normal maps.
+	};
+
+	BlockCompressionOptions() : format(Format_DXT), quality(BCCompression::Quality_Normal) {}
+	BlockCompressionOptions(Format format_, BCCompression::Quality quality_) : format(format_), quality(quality_) {}
+
+	Format format;
+	BCCompression::Quality quality; // Only used for BC7 and BC5.
+};
 
 
 /*=====================================================================
@@ -38,18 +58,25 @@ public:
 
 	// Builds compressed, mip-map level data, if applicable.
 	// Uses task_manager for multi-threading if non-null.
+	// If disk_cache is non-null, cacheable texture data is looked up in, and added to, disk_cache.
+	// compression_options selects the block compression format for single 8-bit images.  Image sequences always use DXT compression.
 	// May return a reference to imagemap in the returned TextureData.
-	static Reference<TextureData> buildTextureData(const Map2D* map2d, glare::Allocator* general_mem_allocator, glare::TaskManager* task_manager, bool allow_compression, bool build_mipmaps, bool convert_float_to_half);
+	static Reference<TextureData> buildTextureData(const Map2D* map2d, glare::Allocator* general_mem_allocator, glare::TaskManager* task_manager, bool allow_compression, bool build_mipmaps, bool convert_float_to_half, 
+		TextureDiskCache* disk_cache = NULL, const BlockCompressionOptions& compression_options = BlockCompressionOptions());
 
 private:
-	static Reference<TextureData> buildUInt8MapTextureData(const ImageMapUInt8* imagemap, glare::Allocator* general_mem_allocator, glare::TaskManager* task_manager, bool allow_compression, bool build_mipmaps);
+	static Reference<TextureData> buildUInt8MapTextureData(const ImageMapUInt8* imagemap, glare::Allocator* general_mem_allocator, glare::TaskManager* task_manager, bool allow_compression, bool build_mipmaps, 
+		const BlockCompressionOptions& compression_options = BlockCompressionOptions());
 
 	// Builds compressed, mip-map level data for a sequence of images (e.g. animated gif)
 	static Reference<TextureData> buildUInt8MapSequenceTextureData(const ImageMapSequenceUInt8* imagemap, glare::Allocator* general_mem_allocator, glare::TaskManager* task_manager, bool allow_compression, bool build_mipmaps);
 
-	static void downSampleToNextMipMapLevel(size_t prev_W, size_t prev_H, size_t N, const uint8* prev_level_image_data, float alpha_scale, size_t level_W, size_t level_H, uint8* data_out, float& alpha_coverage_out);
+	// use_simd can be set to false to use just the scalar code, for testing and benchmarking.  The results are the same either way.
+	static void downSampleToNextMipMapLevel(size_t prev_W, size_t prev_H, size_t N, const uint8* prev_level_image_data, float alpha_scale, size_t level_W, size_t level_H, uint8* data_out, float& alpha_coverage_out, 
+		bool use_simd = true);
 
 	// Uses task_manager for multi-threading if non-null.
-	static void buildMipMapDataForImageFrame(bool do_compression, js::Vector<uint8, 16>& temp_tex_buf_a, js::Vector<uint8, 16>& temp_tex_buf_b, 
-		DXTCompression::TempData& compress_temp_data, TextureData* texture_data, size_t cur_frame_i, const ImageMapUInt8* source_image, glare::TaskManager* task_manager);
+	// The compression format is given by texture_data->format.  bc_quality is used for BC7 and BC5 compression.
+	static void buildMipMapDataForImageFrame(bool do_compression, BCCompression::Quality bc_quality, js::Vector<uint8, 16>& temp_tex_buf_a, js::Vector<uint8, 16>& temp_tex_buf_b, 
+		DXTCompression::TempData& compress_temp_data, BCCompression::TempData& bc_compress_temp_data, TextureData* texture_data, size_t cur_frame_i, const ImageMapUInt8* source_image, glare::TaskManager* task_manager);
 };
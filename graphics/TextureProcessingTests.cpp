@@ -13,7 +13,9 @@ Copyright Glare Technologies Limited 2022 -
 #include "jpegdecoder.h"
 #include "GifDecoder.h"
 #include "DXTCompression.h"
+#include "BCCompression.h"
 #include "TextureProcessing.h"
+#include "TextureDiskCache.h"
 #include "ImageMap.h"
 #include "../maths/mathstypes.h"
 #include "../utils/TestUtils.h"
@@ -24,6 +26,13 @@ Copyright Glare Technologies Limited 2022 -
 #include "../utils/ConPrint.h"
 #include "../utils/ArrayRef.h"
 #include "../utils/GeneralMemAllocator.h"
+#include "../utils/FileUtils.h"
+#include "../utils/PlatformUtils.h"
+#include <encoder/basisu_gpu_texture.h>
+#include "../utils/Lock.h"
+#include "../maths/PCG32.h"
+#include <cstring>
+#include <cmath>
 
 
 // Generate mipmaps for grey texture, check mipmaps are still same grey value.
@@ -55,6 +64,69 @@ void TextureProcessingTests::testDownSamplingGreyTexture(unsigned int W, unsigne
 }
 
 
+// Check the SIMD downsampling code gives the same results as the scalar code, and compare the speed.
+void TextureProcessingTests::testSIMDDownSampling()
+{
+	PCG32 rng(1);
+	const unsigned int sizes[][2] = { { 256, 256 }, { 250, 250 }, { 250, 7 }, { 7, 250 }, { 2, 2 }, { 9, 9 }, { 17, 3 }, { 1, 16 }, { 16, 1 } };
+	const float alpha_scales[] = { 1.f, 1.3f, 0.7f, 3.f };
+	for(size_t N=3; N<=4; ++N)
+	for(size_t i=0; i<staticArrayNumElems(sizes); ++i)
+	for(size_t z=0; z<staticArrayNumElems(alpha_scales); ++z)
+	{
+		const size_t W = sizes[i][0];
+		const size_t H = sizes[i][1];
+		ImageMapUInt8Ref map = new ImageMapUInt8(W, H, N);
+		for(size_t q=0; q<map->getDataSize(); ++q)
+			map->getData()[q] = (uint8)(rng.genrand_int32() % 256);
+
+		const size_t level_W = myMax((size_t)1, W / 2);
+		const size_t level_H = myMax((size_t)1, H / 2);
+		ImageMapUInt8Ref scalar_level = new ImageMapUInt8(level_W, level_H, N);
+		ImageMapUInt8Ref simd_level   = new ImageMapUInt8(level_W, level_H, N);
+		float scalar_alpha_coverage = 0, simd_alpha_coverage = 0;
+		TextureProcessing::downSampleToNextMipMapLevel(W, H, N, map->getData(), alpha_scales[z], level_W, level_H, scalar_level->getData(), scalar_alpha_coverage, /*use_simd=*/false);
+		TextureProcessing::downSampleToNextMipMapLevel(W, H, N, map->getData(), alpha_scales[z], level_W, level_H, simd_level->getData(), simd_alpha_coverage, /*use_simd=*/true);
+
+		testAssert(std::memcmp(scalar_level->getData(), simd_level->getData(), scalar_level->getDataSize()) == 0);
+		testAssert(scalar_alpha_coverage == simd_alpha_coverage);
+	}
+
+	// Perf test: downsample a 2048x2048 image to all MIP levels.
+	for(size_t N=3; N<=4; ++N)
+	{
+		const size_t W = 2048;
+		ImageMapUInt8Ref map = new ImageMapUInt8(W, W, N);
+		for(size_t q=0; q<map->getDataSize(); ++q)
+			map->getData()[q] = (uint8)(rng.genrand_int32() % 256);
+		ImageMapUInt8Ref level_a = new ImageMapUInt8(W / 2, W / 2, N);
+		ImageMapUInt8Ref level_b = new ImageMapUInt8(W / 2, W / 2, N);
+
+		double times[2];
+		for(int use_simd=0; use_simd<2; ++use_simd)
+		{
+			double min_time = 1.0e10;
+			for(int trial=0; trial<5; ++trial)
+			{
+				Timer timer;
+				const uint8* prev_level_data = map->getData();
+				for(size_t level_W = W / 2, k = 0; level_W >= 1; level_W /= 2, ++k)
+				{
+					uint8* level_data = (k % 2 == 0) ? level_a->getData() : level_b->getData();
+					float alpha_coverage;
+					TextureProcessing::downSampleToNextMipMapLevel(level_W * 2, level_W * 2, N, prev_level_data, /*alpha scale=*/1.1f, level_W, level_W, level_data, alpha_coverage, use_simd != 0);
+					prev_level_data = level_data;
+				}
+				min_time = myMin(min_time, timer.elapsed());
+			}
+			times[use_simd] = min_time;
+		}
+		conPrint("Downsampling 2048x2048 N=" + toString(N) + " to all MIP levels: scalar: " + doubleToStringNSigFigs(times[0] * 1.0e3, 4) + " ms, SIMD: " + 
+			doubleToStringNSigFigs(times[1] * 1.0e3, 4) + " ms (" + doubleToStringNSigFigs(times[0] / times[1], 3) + "x faster)");
+	}
+}
+
+
 void TextureProcessingTests::testBuildingTexDataForImage(glare::Allocator* allocator, unsigned int W, unsigned int H, unsigned int N)
 {
 	for(int i=0; i<2; ++i)
@@ -95,6 +167,369 @@ void TextureProcessingTests::testBuildingTexDataForImage(glare::Allocator* alloc
 	}
 }
 
+
+static ImageMapUInt8Ref makeTestImage(size_t W, size_t H, size_t N, uint32 seed)
+{
+	ImageMapUInt8Ref map = new ImageMapUInt8(W, H, N);
+	PCG32 rng(seed);
+	for(size_t y=0; y<H; ++y)
+	for(size_t x=0; x<W; ++x)
+	for(size_t c=0; c<N; ++c)
+		map->getPixel(x, y)[c] = (uint8)(((x + y * (c + 1)) & 0xFF) / 2 + (rng.unitRandom() * 64)); // Gradient plus some noise.
+	return map;
+}
+
+
+static void checkTextureDataEqual(const TextureData& a, const TextureData& b)
+{
+	testAssert(a.format == b.format);
+	testAssert(a.W == b.W && a.H == b.H);
+	testAssert(a.numMipLevels() == b.numMipLevels());
+	for(size_t k=0; k<a.level_offsets.size(); ++k)
+	{
+		testAssert(a.level_offsets[k].level_size == b.level_offsets[k].level_size);
+		testAssert(std::memcmp(a.mipmap_data.data() + a.level_offsets[k].offset, b.mipmap_data.data() + b.level_offsets[k].offset, a.level_offsets[k].level_size) == 0);
+	}
+}
+
+
+void TextureProcessingTests::testTextureDiskCache(glare::Allocator* allocator, glare::TaskManager& task_manager)
+{
+	const std::string cache_dir = PlatformUtils::getTempDirPath() + "/texture_disk_cache_test";
+	if(FileUtils::fileExists(cache_dir))
+		FileUtils::deleteFilesInDir(cache_dir);
+
+	// Test that non-cacheable texture data isn't given a key
+	{
+		ImageMapUInt8Ref map = makeTestImage(64, 64, 3, 1);
+		uint64 key;
+		testAssert(TextureDiskCache::computeKey(*map, /*allow compression=*/true, /*build mipmaps=*/true, key));
+		testAssert(!TextureDiskCache::computeKey(*map, /*allow compression=*/false, /*build mipmaps=*/true, key));
+		testAssert(!TextureDiskCache::computeKey(*map, /*allow compression=*/true, /*build mipmaps=*/false, key));
+
+		ImageMapFloatRef float_map = new ImageMapFloat(64, 64, 3);
+		testAssert(!TextureDiskCache::computeKey(*float_map, /*allow compression=*/true, /*build mipmaps=*/true, key));
+
+		// Changing the image data should change the key
+		uint64 key_b;
+		TextureDiskCache::computeKey(*map, true, true, key);
+		map->getPixel(10, 10)[0]++;
+		TextureDiskCache::computeKey(*map, true, true, key_b);
+		testAssert(key != key_b);
+	}
+
+	// Test a miss, then a hit, with RGB and RGBA images (BC1 and BC3)
+	for(size_t N=3; N<=4; ++N)
+	{
+		TextureDiskCacheRef cache = new TextureDiskCache(cache_dir, /*max size=*/100000000);
+		ImageMapUInt8Ref map = makeTestImage(250, 120, N, 2);
+
+		Reference<TextureData> built_data = TextureProcessing::buildTextureData(map.ptr(), allocator, &task_manager, /*allow compression=*/true, /*build mipmaps=*/true, /*convert_float_to_half=*/true, cache.ptr());
+		testAssert(built_data->isCompressed());
+		{
+			Lock lock(cache->mutex);
+			testAssert(cache->num_misses == 1 && cache->num_hits == 0);
+		}
+
+		Reference<TextureData> cached_data = TextureProcessing::buildTextureData(map.ptr(), allocator, &task_manager, /*allow compression=*/true, /*build mipmaps=*/true, /*convert_float_to_half=*/true, cache.ptr());
+		{
+			Lock lock(cache->mutex);
+			testAssert(cache->num_misses == 1 && cache->num_hits == 1);
+		}
+		testAssert(cached_data.ptr() != built_data.ptr());
+		checkTextureDataEqual(*built_data, *cached_data);
+	}
+
+	// Test existing cache files are picked up by a new cache object
+	{
+		TextureDiskCacheRef cache = new TextureDiskCache(cache_dir, /*max size=*/100000000);
+		testAssert(cache->numEntries() == 2);
+
+		ImageMapUInt8Ref map = makeTestImage(250, 120, 4, 2);
+		uint64 key;
+		testAssert(TextureDiskCache::computeKey(*map, true, true, key));
+		testAssert(cache->lookup(key, allocator).nonNull());
+	}
+
+	// Test a corrupted cache file is treated as a miss, and removed
+	{
+		TextureDiskCacheRef cache = new TextureDiskCache(cache_dir, /*max size=*/100000000);
+		ImageMapUInt8Ref map = makeTestImage(250, 120, 3, 2);
+		uint64 key;
+		testAssert(TextureDiskCache::computeKey(*map, true, true, key));
+
+		const std::vector<std::string> paths = FileUtils::getFilesInDirWithExtensionFullPaths(cache_dir, "ktx2");
+		for(size_t i=0; i<paths.size(); ++i)
+			if(StringUtils::containsString(paths[i], toHexString(key)))
+				FileUtils::writeEntireFile(paths[i], "not a ktx2 file");
+
+		testAssert(cache->lookup(key, allocator).isNull());
+		testAssert(cache->numEntries() == 1);
+
+		// Building should re-insert it.
+		TextureProcessing::buildTextureData(map.ptr(), allocator, &task_manager, true, true, true, cache.ptr());
+		testAssert(cache->numEntries() == 2);
+		testAssert(cache->lookup(key, allocator).nonNull());
+	}
+
+	// Test LRU eviction
+	{
+		FileUtils::deleteFilesInDir(cache_dir);
+
+		const size_t entry_size = 128 * 128 / 2 * 4 / 3 + 1000; // Roughly the BC1 size of a 128x128 image with MIP levels, plus a bit.
+		TextureDiskCacheRef cache = new TextureDiskCache(cache_dir, /*max size=*/entry_size * 2);
+
+		std::vector<uint64> keys;
+		for(uint32 i=0; i<3; ++i)
+		{
+			ImageMapUInt8Ref map = makeTestImage(128, 128, 3, /*seed=*/100 + i);
+			uint64 key;
+			testAssert(TextureDiskCache::computeKey(*map, true, true, key));
+			keys.push_back(key);
+			TextureProcessing::buildTextureData(map.ptr(), allocator, &task_manager, true, true, true, cache.ptr());
+
+			if(i == 1)
+				testAssert(cache->lookup(keys[0], allocator).nonNull()); // Use the first entry, so that the second entry is least recently used when the third is inserted.
+		}
+
+		testAssert(cache->numEntries() == 2);
+		testAssert(cache->totalSizeB() <= entry_size * 2);
+		testAssert(cache->lookup(keys[0], allocator).nonNull());
+		testAssert(cache->lookup(keys[1], allocator).isNull());
+		testAssert(cache->lookup(keys[2], allocator).nonNull());
+		testAssert(FileUtils::getFilesInDirWithExtensionFullPaths(cache_dir, "ktx2").size() == 2);
+	}
+
+	// Perf test: cold (build MIP levels and compress) vs warm (load from cache file) load time.
+	{
+		FileUtils::deleteFilesInDir(cache_dir);
+		TextureDiskCacheRef cache = new TextureDiskCache(cache_dir, /*max size=*/100000000);
+		ImageMapUInt8Ref map = makeTestImage(2048, 2048, 4, 3);
+
+		Timer timer;
+		Reference<TextureData> built_data = TextureProcessing::buildTextureData(map.ptr(), allocator, &task_manager, true, true, true, cache.ptr());
+		const double cold_time = timer.elapsed();
+
+		double warm_time = 1.0e10;
+		Reference<TextureData> cached_data;
+		for(int i=0; i<10; ++i)
+		{
+			timer.reset();
+			cached_data = TextureProcessing::buildTextureData(map.ptr(), allocator, &task_manager, true, true, true, cache.ptr());
+			warm_time = myMin(warm_time, timer.elapsed());
+		}
+		checkTextureDataEqual(*built_data, *cached_data);
+
+		conPrint("2048x2048 RGBA texture: cold buildTextureData(): " + doubleToStringNSigFigs(cold_time * 1.0e3, 4) + " ms, from disk cache: " + doubleToStringNSigFigs(warm_time * 1.0e3, 4) + 
+			" ms (" + doubleToStringNSigFigs(cold_time / warm_time, 3) + "x faster)");
+	}
+
+	FileUtils::deleteFilesInDir(cache_dir);
+}
+
+
+// Makes an image with smooth colour variation, hard edges and a little noise, roughly like a photo texture.
+static ImageMapUInt8Ref makeSmoothTestImage(size_t W, size_t H, size_t N, uint32 seed)
+{
+	ImageMapUInt8Ref map = new ImageMapUInt8(W, H, N);
+	PCG32 rng(seed);
+	for(size_t y=0; y<H; ++y)
+	for(size_t x=0; x<W; ++x)
+	{
+		const bool in_square = ((x / 64) + (y / 64)) % 5 == 0;
+		for(size_t c=0; c<N; ++c)
+		{
+			float v;
+			if(c == 3)
+				v = 255.f * (float)x / (float)W; // Alpha gradient
+			else if(in_square)
+				v = (float)(c * 80 + 20);
+			else
+				v = 128.f + 90.f * std::sin((float)x * (0.011f + 0.004f * c) + (float)y * (0.017f - 0.003f * c) + c);
+			map->getPixel(x, y)[c] = (uint8)myClamp((int)(v + (rng.unitRandom() - 0.5f) * 12.f), 0, 255);
+		}
+	}
+	return map;
+}
+
+
+// Makes a tangent-space normal map (XYZ encoded to RGB) of a bumpy height field.
+static ImageMapUInt8Ref makeTestNormalMap(size_t W, size_t H)
+{
+	ImageMapUInt8Ref map = new ImageMapUInt8(W, H, 3);
+	for(size_t y=0; y<H; ++y)
+	for(size_t x=0; x<W; ++x)
+	{
+		// h(x, y) = sin(0.05x) * cos(0.07y) * 4 + sin(0.23(x + y))
+		const float dh_dx = 0.2f  * std::cos(0.05f * x) * std::cos(0.07f * y) + 0.23f * std::cos(0.23f * (x + y));
+		const float dh_dy = -0.28f * std::sin(0.05f * x) * std::sin(0.07f * y) + 0.23f * std::cos(0.23f * (x + y));
+		const float len = std::sqrt(dh_dx * dh_dx + dh_dy * dh_dy + 1);
+		const float n[3] = { -dh_dx / len, -dh_dy / len, 1 / len };
+		for(size_t c=0; c<3; ++c)
+			map->getPixel(x, y)[c] = (uint8)myClamp((int)((n[c] * 0.5f + 0.5f) * 255.f + 0.5f), 0, 255);
+	}
+	return map;
+}
+
+
+// Decodes MIP level 0 of the texture data and returns the PSNR (in dB) compared to the source image, over the first num_channels channels.
+// Uses the basis universal block decoders, not the BCCompression ones, so the result doesn't depend on the encoder's own decoding.
+static double computeLevel0PSNR(const TextureData& texture_data, const ImageMapUInt8& src, size_t num_channels)
+{
+	const size_t W = texture_data.W;
+	const size_t H = texture_data.H;
+	const size_t num_blocks_x = Maths::roundedUpDivide<size_t>(W, 4);
+	const size_t block_B = bytesPerBlock(texture_data.format);
+	const uint8* const level_data = texture_data.mipmap_data.data() + texture_data.level_offsets[0].offset;
+
+	double sum_sqr_err = 0;
+	for(size_t by=0; by<H/4; ++by)
+	for(size_t bx=0; bx<W/4; ++bx)
+	{
+		const uint8* block = level_data + (by * num_blocks_x + bx) * block_B;
+		basisu::color_rgba decoded[16];
+		switch(texture_data.format)
+		{
+		case OpenGLTextureFormat::Format_Compressed_DXT_SRGB_Uint8:  basisu::unpack_bc1(block, decoded, /*set alpha=*/true); break;
+		case OpenGLTextureFormat::Format_Compressed_DXT_SRGBA_Uint8: basisu::unpack_bc3(block, decoded); break;
+		case OpenGLTextureFormat::Format_Compressed_BC5_Uint8:       basisu::unpack_bc5(block, decoded); break;
+		default: testAssert(basisu::unpack_bc7(block, decoded)); break;
+		}
+
+		for(size_t y=0; y<4; ++y)
+		for(size_t x=0; x<4; ++x)
+		for(size_t c=0; c<num_channels; ++c)
+		{
+			const double d = (double)decoded[y * 4 + x][(uint32)c] - (double)src.getPixel(bx * 4 + x, by * 4 + y)[c];
+			sum_sqr_err += d * d;
+		}
+	}
+	const double mse = sum_sqr_err / (double)((W/4) * (H/4) * 16 * num_channels);
+	return 10 * std::log10(255.0 * 255.0 / mse);
+}
+
+
+void TextureProcessingTests::testBC7AndBC5Compression(glare::Allocator* allocator, glare::TaskManager& task_manager)
+{
+	const char* quality_names[] = { "fast", "normal", "high" };
+
+	// Check BC7 texture data is built with the expected format and level sizes, and has better quality than DXT.
+	for(size_t N=3; N<=4; ++N)
+	{
+		ImageMapUInt8Ref map = makeSmoothTestImage(512, 512, N, /*seed=*/1);
+
+		Reference<TextureData> dxt_data = TextureProcessing::buildUInt8MapTextureData(map.ptr(), allocator, &task_manager, /*allow compression=*/true, /*build mipmaps=*/true);
+		const double dxt_psnr = computeLevel0PSNR(*dxt_data, *map, N);
+		conPrint("N=" + toString(N) + ": DXT PSNR: " + doubleToStringNSigFigs(dxt_psnr, 4) + " dB");
+
+		double prev_psnr = 0;
+		for(int q=0; q<3; ++q)
+		{
+			Reference<TextureData> bc7_data = TextureProcessing::buildUInt8MapTextureData(map.ptr(), allocator, &task_manager, /*allow compression=*/true, /*build mipmaps=*/true, 
+				BlockCompressionOptions(BlockCompressionOptions::Format_BC7, (BCCompression::Quality)q));
+			testAssert(bc7_data->format == ((N == 3) ? OpenGLTextureFormat::Format_Compressed_BC7_SRGB_Uint8 : OpenGLTextureFormat::Format_Compressed_BC7_SRGBA_Uint8));
+			testAssert(bc7_data->numMipLevels() == dxt_data->numMipLevels());
+			for(size_t k=0; k<bc7_data->level_offsets.size(); ++k)
+			{
+				testAssert(bc7_data->level_offsets[k].level_size == TextureData::computeNum4PixelBlocksForLevel(512, 512, k) * 16);
+				testAssert(bc7_data->level_offsets[k].offset + bc7_data->level_offsets[k].level_size <= bc7_data->mipmap_data.size());
+			}
+
+			const double psnr = computeLevel0PSNR(*bc7_data, *map, N);
+			conPrint("N=" + toString(N) + ": BC7 (" + quality_names[q] + ") PSNR: " + doubleToStringNSigFigs(psnr, 4) + " dB");
+			testAssert(psnr > dxt_psnr);
+			testAssert(psnr >= prev_psnr - 0.01);
+			prev_psnr = psnr;
+		}
+	}
+
+	// Check BC5 on a normal map has better quality for the X and Y components than DXT.
+	{
+		ImageMapUInt8Ref map = makeTestNormalMap(512, 512);
+
+		Reference<TextureData> dxt_data = TextureProcessing::buildUInt8MapTextureData(map.ptr(), allocator, &task_manager, /*allow compression=*/true, /*build mipmaps=*/true);
+		const double dxt_psnr = computeLevel0PSNR(*dxt_data, *map, /*num channels=*/2);
+		conPrint("Normal map: DXT PSNR (XY): " + doubleToStringNSigFigs(dxt_psnr, 4) + " dB");
+
+		for(int q=0; q<3; ++q)
+		{
+			Reference<TextureData> bc5_data = TextureProcessing::buildUInt8MapTextureData(map.ptr(), allocator, &task_manager, /*allow compression=*/true, /*build mipmaps=*/true, 
+				BlockCompressionOptions(BlockCompressionOptions::Format_BC5, (BCCompression::Quality)q));
+			testAssert(bc5_data->format == OpenGLTextureFormat::Format_Compressed_BC5_Uint8);
+			testAssert(bc5_data->level_offsets[0].level_size == 128 * 128 * 16);
+
+			const double psnr = computeLevel0PSNR(*bc5_data, *map, /*num channels=*/2);
+			conPrint("Normal map: BC5 (" + std::string(quality_names[q]) + ") PSNR (XY): " + doubleToStringNSigFigs(psnr, 4) + " dB");
+			testAssert(psnr > dxt_psnr + 3);
+		}
+	}
+
+	// Test BC7 texture data going through the disk cache.  KTX2 files don't distinguish opaque BC7 data, so check the format is restored.
+	{
+		const std::string cache_dir = PlatformUtils::getTempDirPath() + "/texture_disk_cache_bc7_test";
+		if(FileUtils::fileExists(cache_dir))
+			FileUtils::deleteFilesInDir(cache_dir);
+
+		TextureDiskCacheRef cache = new TextureDiskCache(cache_dir, /*max size=*/100000000);
+		for(size_t N=3; N<=4; ++N)
+		{
+			ImageMapUInt8Ref map = makeSmoothTestImage(128, 128, N, /*seed=*/2);
+			const BlockCompressionOptions options(BlockCompressionOptions::Format_BC7, BCCompression::Quality_Fast);
+
+			uint64 dxt_key, bc7_key;
+			testAssert(TextureDiskCache::computeKey(*map, true, true, dxt_key));
+			testAssert(TextureDiskCache::computeKey(*map, true, true, bc7_key, options));
+			testAssert(dxt_key != bc7_key);
+
+			Reference<TextureData> built_data = TextureProcessing::buildTextureData(map.ptr(), allocator, &task_manager, true, true, true, cache.ptr(), options);
+			Reference<TextureData> cached_data = TextureProcessing::buildTextureData(map.ptr(), allocator, &task_manager, true, true, true, cache.ptr(), options);
+			testAssert(built_data.ptr() != cached_data.ptr());
+			checkTextureDataEqual(*built_data, *cached_data);
+		}
+		{
+			Lock lock(cache->mutex);
+			testAssert(cache->num_hits == 2);
+		}
+		FileUtils::deleteFilesInDir(cache_dir);
+	}
+
+	// Measure compression speed of level 0 data, single and multi-threaded.
+	{
+		const size_t W = 1024;
+		const size_t H = 1024;
+		ImageMapUInt8Ref colour_map = makeSmoothTestImage(W, H, 4, /*seed=*/3);
+		ImageMapUInt8Ref normal_map = makeTestNormalMap(W, H);
+		std::vector<uint8> compressed(BCCompression::getCompressedSizeBytes(W, H));
+		BCCompression::TempData temp_data;
+
+		for(int f=0; f<2; ++f)
+		for(int q=0; q<3; ++q)
+		{
+			const BCCompression::Format format = (f == 0) ? BCCompression::Format_BC7 : BCCompression::Format_BC5;
+			const ImageMapUInt8* map = (f == 0) ? colour_map.ptr() : normal_map.ptr();
+
+			Timer timer;
+			BCCompression::compress(/*task manager=*/NULL, temp_data, format, (BCCompression::Quality)q, W, H, map->getN(), map->getData(), compressed.data(), compressed.size());
+			const double single_threaded_time = timer.elapsed();
+
+			timer.reset();
+			BCCompression::compress(&task_manager, temp_data, format, (BCCompression::Quality)q, W, H, map->getN(), map->getData(), compressed.data(), compressed.size());
+			const double multi_threaded_time = timer.elapsed();
+
+			const double mpix = (double)(W * H) * 1.0e-6;
+			conPrint(std::string((f == 0) ? "BC7" : "BC5") + " (" + quality_names[q] + "): single-threaded: " + doubleToStringNSigFigs(mpix / single_threaded_time, 4) + " MPix/s, " + 
+				toString(task_manager.getNumThreads()) + " threads: " + doubleToStringNSigFigs(mpix / multi_threaded_time, 4) + " MPix/s");
+		}
+
+		Timer timer;
+		DXTCompression::TempData dxt_temp_data;
+		std::vector<uint8> dxt_compressed(DXTCompression::getCompressedSizeBytes(W, H, 4));
+		DXTCompression::compress(/*task manager=*/NULL, dxt_temp_data, W, H, 4, colour_map->getData(), dxt_compressed.data(), dxt_compressed.size());
+		conPrint("DXT (BC3) for comparison: single-threaded: " + doubleToStringNSigFigs((double)(W * H) * 1.0e-6 / timer.elapsed(), 4) + " MPix/s");
+	}
+}
+
+
 #if 0
 static void testLoadingFile(const std::string& path, glare::TaskManager& task_manager)
 {
@@ -236,6 +671,13 @@ void TextureProcessingTests::test()
 	testDownSamplingGreyTexture(7, 250, 4);
 	testDownSamplingGreyTexture(2, 2, 4);
 
+	testSIMDDownSampling();
+
+	testTextureDiskCache(allocator.ptr(), task_manager);
+
+	BCCompression::test();
+	testBC7AndBC5Compression(allocator.ptr(), task_manager);
+
 	
 #if !defined(EMSCRIPTEN)
 	// Test loading animated gifs
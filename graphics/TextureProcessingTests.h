@@ -17,6 +17,9 @@ public:
 
 private:
 	static void testDownSamplingGreyTexture(unsigned int W, unsigned int H, unsigned int N);
+	static void testSIMDDownSampling();
 	static void testBuildingTexDataForImage(glare::Allocator* allocator, unsigned int W, unsigned int H, unsigned int N);
 	static void testLoadingAnimatedFile(const std::string& path, glare::Allocator* allocator, glare::TaskManager& task_manager);
+	static void testTextureDiskCache(glare::Allocator* allocator, glare::TaskManager& task_manager);
+	static void testBC7AndBC5Compression(glare::Allocator* allocator, glare::TaskManager& task_manager);
 };
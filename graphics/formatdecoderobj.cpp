@@ -20,7 +20,10 @@ Code By Nicholas Chapman.
 #include "../utils/Exception.h"
 #include "../utils/HashMap.h"
 #include "../utils/Hasher.h"
+#include "../utils/Task.h"
+#include "../utils/TaskManager.h"
 #include <unordered_map>
+#include <cstring>
 
 
 MTLTexMap::MTLTexMap()
@@ -98,11 +101,11 @@ static inline void skipWhitespace(Parser& parser)
 }
 
 
-void FormatDecoderObj::streamModel(const std::string& filename, Indigo::Mesh& handler, float scale, bool parse_mtllib, MLTLibMaterials& mtllib_mats_out)
+void FormatDecoderObj::streamModel(const std::string& filename, Indigo::Mesh& handler, float scale, bool parse_mtllib, MLTLibMaterials& mtllib_mats_out, glare::TaskManager* task_manager)
 {
 	MemMappedFile file(filename);
 
-	loadModelFromBuffer((const uint8*)file.fileData(), file.fileSize(), filename, handler, scale, parse_mtllib, mtllib_mats_out);
+	loadModelFromBuffer((const uint8*)file.fileData(), file.fileSize(), filename, handler, scale, parse_mtllib, mtllib_mats_out, task_manager);
 }
 
 
@@ -116,315 +119,770 @@ static std::string sanitiseString(const std::string& s)
 }
 
 
-void FormatDecoderObj::loadModelFromBuffer(const uint8* data, size_t len, const std::string& filename, Indigo::Mesh& handler, float scale, bool parse_mtllib, MLTLibMaterials& mtllib_mats_out) // Throws glare::Exception on failure.
+namespace
 {
-	// NOTE: pretty crufty and dubious old code.
-	// 
-	// Timer load_timer;
-	try
+
+
+// A face vertex.  Indices are zero-based.  Negative (relative) indices in the file are resolved against the number of elements
+// the sink has received so far.  When parsing in chunks that is only the chunk's own count, so a flag is set, and the preceding
+// chunks' counts are added when the chunks are merged.
+struct ObjFaceVert
+{
+	enum Flags
 	{
-		bool encountered_uvs = false;
+		HAS_UV_INDEX = 1,
+		HAS_NORMAL_INDEX = 2,
+		VERT_INDEX_RELATIVE = 4,
+		UV_INDEX_RELATIVE = 8,
+		NORMAL_INDEX_RELATIVE = 16
+	};
+
+	int vert_i;
+	int uv_i;
+	int norm_i;
+	uint32 flags;
+};
 
-		NameMap<int> materials;
 
-		int current_mat_index = -1;
+struct ObjFace
+{
+	uint32 first_vert; // Index into ObjChunk::face_verts.
+	uint32 num_verts;
+	int linenum; // Relative to the chunk.
+};
 
-		Indigo::Vector<Indigo::Vec2f> uv_vector(1);
 
-		Parser parser((const char*)data, len);
+// A run of consecutive faces in a chunk, with the number of positions, uvs and normals parsed in the chunk before the run.
+// A new run is started whenever those change, or a usemtl line is seen, so that the merge can check indices and switch
+// materials in the same order as a sequential parse would.
+struct ObjFaceRun
+{
+	uint32 begin_face;
+	uint32 num_positions;
+	uint32 num_uvs;
+	uint32 num_normals;
+	int material_name_index; // Index into ObjChunk::material_names if this run starts with a usemtl line, -1 otherwise.
+};
 
-		const unsigned int MAX_NUM_FACE_VERTICES = 256;
-		std::vector<unsigned int> face_uv_indices(MAX_NUM_FACE_VERTICES, 0);
 
-		// Positions, normals and UVs as parsed from the OBJ file.
-		std::vector<Indigo::Vec3f> vert_positions;
-		std::vector<Indigo::Vec3f> vert_normals;
-		std::vector<Indigo::Vec2f> uvs;
+// The parse results for a range of lines of the file.
+struct ObjChunk
+{
+	ObjChunk() : text(NULL), text_size(0), num_lines(0), error(false), error_linenum(0) {}
 
-		//std::unordered_map<Vert, unsigned int, VertHash> added_verts; // Hash map from Vertex to index of where the vertex was added to the Indigo Mesh.
-		Vert empty_key;
-		empty_key.vert_i = std::numeric_limits<unsigned int>::max();
-		empty_key.norm_i = std::numeric_limits<unsigned int>::max();
+	const char* text;
+	size_t text_size;
 
-		HashMap<Vert, unsigned int, VertHash> added_verts(empty_key,
-			45000
-		);
+	std::vector<Indigo::Vec3f> vert_positions;
+	std::vector<Indigo::Vec3f> vert_normals;
+	std::vector<Indigo::Vec2f> uvs;
 
-		unsigned int num_verts_added = 0;
-		std::vector<unsigned int> face_added_vert_indices(MAX_NUM_FACE_VERTICES);
+	std::vector<ObjFace> faces;
+	std::vector<ObjFaceVert> face_verts;
+	std::vector<ObjFaceRun> runs;
 
+	std::vector<std::string> material_names;
+	std::vector<std::string> mtllib_paths;
 
-		int linenum = 0;
-		string_view token;
-		while(parser.notEOF())
-		{
-			linenum++;
+	int num_lines;
 
-			parser.parseSpacesAndTabs();
+	// Set if parsing failed.  Parsing stops at the error, so the chunk holds everything before it.  The message is split around
+	// the line number, as the line number is only made absolute when the chunks are merged.
+	bool error;
+	std::string error_msg_before_linenum;
+	std::string error_msg_after_linenum;
+	int error_linenum;
+};
 
-			if(parser.currentIsChar('#')) // Skip comments
-			{
-				parser.advancePastLine();
-				continue;
-			}
 
-			if(parser.notEOF() && isAlphabetic(parser.current()))
-			{
-				const bool parsed_token = parser.parseAlphaToken(token);
-				if(!parsed_token)
-					throw glare::Exception("Failed to parse token at line " + toString(linenum));
+// Thrown by parseObjText().  See ObjChunk::error.
+struct ObjParseError
+{
+	ObjParseError(const std::string& before_, int linenum_, const std::string& after_ = "") : before(before_), linenum(linenum_), after(after_) {}
 
-				if(token == "v") // vertex position
-				{
-					Indigo::Vec3f pos;
-					skipWhitespace(parser);
-					const bool r1 = parser.parseFloat(pos.x);
-					skipWhitespace(parser);
-					const bool r2 = parser.parseFloat(pos.y);
-					skipWhitespace(parser);
-					const bool r3 = parser.parseFloat(pos.z);
+	std::string before;
+	int linenum;
+	std::string after;
+};
 
-					if(!r1 || !r2 || !r3)
-						throw glare::Exception("Parse error while reading position on line " + toString(linenum));
 
-					pos *= scale;
-			
-					vert_positions.push_back(pos);
-				}
-				else if(token == "vt") // vertex tex coordinate
-				{
-					Indigo::Vec2f texcoord;
-					skipWhitespace(parser);
-					const bool r1 = parser.parseFloat(texcoord.x);
-					skipWhitespace(parser);
-					const bool r2 = parser.parseFloat(texcoord.y);
+const unsigned int MAX_NUM_FACE_VERTICES = 256;
 
-					if(!r1 || !r2)
-						throw glare::Exception("Parse error while reading tex coord on line " + toString(linenum));
 
+// Parses OBJ text, passing positions, uvs, normals, faces, mtllib and usemtl lines to the sink as they are parsed.
+// linenum is kept up to date with the line being parsed.
+template <class Sink>
+void parseObjText(const char* text, size_t text_size, float scale, Sink& sink, int& linenum)
+{
+	ObjFaceVert face_verts[MAX_NUM_FACE_VERTICES];
 
-					// Assume one texcoord per vertex.
-					if(!encountered_uvs)
-					{
-						handler.setMaxNumTexcoordSets(1);
-						encountered_uvs = true;
-					}
+	Parser parser(text, text_size);
 
-					assert(uv_vector.size() == 1);
-					uv_vector[0] = texcoord;
-					handler.addUVs(uv_vector);
-					uvs.push_back(texcoord);
-				}
-				else if(token == "vn") // vertex normal
-				{
-					Indigo::Vec3f normal;
-					skipWhitespace(parser);
-					const bool r1 = parser.parseFloat(normal.x);
-					skipWhitespace(parser);
-					const bool r2 = parser.parseFloat(normal.y);
-					skipWhitespace(parser);
-					const bool r3 = parser.parseFloat(normal.z);
+	linenum = 0;
+	string_view token;
+	while(parser.notEOF())
+	{
+		linenum++;
 
-					if(!r1 || !r2 || !r3)
-						throw glare::Exception("Parse error while reading normal on line " + toString(linenum));
+		parser.parseSpacesAndTabs();
 
-					vert_normals.push_back(normal);
-				}
-				else if(token == "f") // face
+		if(parser.currentIsChar('#')) // Skip comments
+		{
+			parser.advancePastLine();
+			continue;
+		}
+
+		if(parser.notEOF() && isAlphabetic(parser.current()))
+		{
+			const bool parsed_token = parser.parseAlphaToken(token);
+			if(!parsed_token)
+				throw ObjParseError("Failed to parse token at line ", linenum);
+
+			if(token == "v") // vertex position
+			{
+				Indigo::Vec3f pos;
+				skipWhitespace(parser);
+				const bool r1 = parser.parseFloat(pos.x);
+				skipWhitespace(parser);
+				const bool r2 = parser.parseFloat(pos.y);
+				skipWhitespace(parser);
+				const bool r3 = parser.parseFloat(pos.z);
+
+				if(!r1 || !r2 || !r3)
+					throw ObjParseError("Parse error while reading position on line ", linenum);
+
+				pos *= scale;
+
+				sink.addPosition(pos);
+			}
+			else if(token == "vt") // vertex tex coordinate
+			{
+				Indigo::Vec2f texcoord;
+				skipWhitespace(parser);
+				const bool r1 = parser.parseFloat(texcoord.x);
+				skipWhitespace(parser);
+				const bool r2 = parser.parseFloat(texcoord.y);
+
+				if(!r1 || !r2)
+					throw ObjParseError("Parse error while reading tex coord on line ", linenum);
+
+				sink.addUV(texcoord);
+			}
+			else if(token == "vn") // vertex normal
+			{
+				Indigo::Vec3f normal;
+				skipWhitespace(parser);
+				const bool r1 = parser.parseFloat(normal.x);
+				skipWhitespace(parser);
+				const bool r2 = parser.parseFloat(normal.y);
+				skipWhitespace(parser);
+				const bool r3 = parser.parseFloat(normal.z);
+
+				if(!r1 || !r2 || !r3)
+					throw ObjParseError("Parse error while reading normal on line ", linenum);
+
+				sink.addNormal(normal);
+			}
+			else if(token == "f") // face
+			{
+				int numfaceverts = 0;
+				for(int i=0; i<(int)MAX_NUM_FACE_VERTICES; ++i)//for each vert in face polygon
 				{
-					int numfaceverts = 0;
+					skipWhitespace(parser);
+					if(parser.eof() || parser.current() == '\n' || parser.current() == '\r')
+						break; // end of line, we're done parsing this face.
 
-					for(int i=0; i<(int)MAX_NUM_FACE_VERTICES; ++i)//for each vert in face polygon
+					//------------------------------------------------------------------------
+					//Parse vert, texcoord, normal indices
+					//------------------------------------------------------------------------
+					ObjFaceVert& v = face_verts[i];
+					v.uv_i = 0;
+					v.norm_i = 0;
+					v.flags = 0;
+
+					// Read vertex position index
+					int vert_index;
+					if(parser.parseInt(vert_index))
 					{
-						skipWhitespace(parser);
-						if(parser.eof() || parser.current() == '\n' || parser.current() == '\r')
-							break; // end of line, we're done parsing this face.
-
-						//------------------------------------------------------------------------
-						//Parse vert, texcoord, normal indices
-						//------------------------------------------------------------------------
-						bool read_normal_index = false;
-						int zero_based_vert_index;
-						int zero_based_normal_index = 0;
-
-						// Read vertex position index
-						int vert_index;
-						if(parser.parseInt(vert_index))
-						{
-							numfaceverts++;
+						numfaceverts++;
 
-							if(vert_index < 0)
-								zero_based_vert_index = (unsigned int)vert_positions.size() + vert_index;
-							else if(vert_index > 0)
-								zero_based_vert_index = vert_index - 1; // Convert to 0-based index
-							else
-								throw glare::Exception("Position index invalid. (index '" + toString(vert_index) + "' out of bounds, on line " + toString(linenum) + ")");
+						if(vert_index < 0)
+						{
+							v.vert_i = (int)sink.numPositions() + vert_index;
+							v.flags |= ObjFaceVert::VERT_INDEX_RELATIVE;
+						}
+						else if(vert_index > 0)
+							v.vert_i = vert_index - 1; // Convert to 0-based index
+						else
+							throw ObjParseError("Position index invalid. (index '" + toString(vert_index) + "' out of bounds, on line ", linenum, ")");
 
-							// Try and read vertex texcoord index
-							if(parser.parseChar('/'))
+						// Try and read vertex texcoord index
+						if(parser.parseChar('/'))
+						{
+							int uv_index;
+							if(parser.parseInt(uv_index))
 							{
-								int uv_index;
-								if(parser.parseInt(uv_index))
+								if(uv_index < 0)
 								{
-									if(uv_index < 0)
-										face_uv_indices[i] = (unsigned int)uvs.size() + uv_index;
-									else if(uv_index > 0)
-										face_uv_indices[i] = uv_index - 1; // Convert to 0-based index
-									else
-										throw glare::Exception("Invalid tex coord index. (index '" + toString(uv_index) + "' out of bounds, on line " + toString(linenum) + ")");
+									v.uv_i = (int)sink.numUVs() + uv_index;
+									v.flags |= ObjFaceVert::UV_INDEX_RELATIVE;
 								}
+								else if(uv_index > 0)
+									v.uv_i = uv_index - 1; // Convert to 0-based index
+								else
+									throw ObjParseError("Invalid tex coord index. (index '" + toString(uv_index) + "' out of bounds, on line ", linenum, ")");
+								v.flags |= ObjFaceVert::HAS_UV_INDEX;
+							}
+
+							// Try and read vertex normal index
+							if(parser.parseChar('/'))
+							{
+								int normal_index;
+								if(!parser.parseInt(normal_index))
+									throw ObjParseError("syntax error: no integer following '/' (line ", linenum, ")");
 
-								// Try and read vertex normal index
-								if(parser.parseChar('/'))
+								if(normal_index < 0)
 								{
-									int normal_index;
-									if(!parser.parseInt(normal_index))
-										throw glare::Exception("syntax error: no integer following '/' (line " + toString(linenum) + ")");
-
-									if(normal_index < 0)
-										zero_based_normal_index = (unsigned int)vert_normals.size() + normal_index;
-									else if(normal_index > 0)
-										zero_based_normal_index = normal_index - 1; // Convert to 0-based index
-									else
-										throw glare::Exception("Invalid normal index. (index '" + toString(normal_index) + "' out of bounds, on line " + toString(linenum) + ")");
-						
-									read_normal_index = true;
+									v.norm_i = (int)sink.numNormals() + normal_index;
+									v.flags |= ObjFaceVert::NORMAL_INDEX_RELATIVE;
 								}
+								else if(normal_index > 0)
+									v.norm_i = normal_index - 1; // Convert to 0-based index
+								else
+									throw ObjParseError("Invalid normal index. (index '" + toString(normal_index) + "' out of bounds, on line ", linenum, ")");
+								v.flags |= ObjFaceVert::HAS_NORMAL_INDEX;
 							}
 						}
-						else 
-							throw glare::Exception("syntax error: no integer following 'f' (line " + toString(linenum) + ")");
+					}
+					else
+						throw ObjParseError("syntax error: no integer following 'f' (line ", linenum, ")");
+				}//end for each vertex
 
-						// Add the vertex to the mesh, if it hasn't been added already.
+				if(numfaceverts < 3)
+					throw ObjParseError("Invalid number of vertices in face: " + toString(numfaceverts) + " (line ", linenum, ")");
 
-						if((zero_based_vert_index < 0) || (zero_based_vert_index >= (int)vert_positions.size()))
-							throw glare::Exception("Position index invalid. (index '" + toString(zero_based_vert_index) + "' out of bounds, on line " + toString(linenum) + ")");
+				sink.addFace(face_verts, numfaceverts, linenum);
+			}
+			else if(token == "mtllib")
+			{
+				skipWhitespace(parser);
 
-						if(read_normal_index)
-						{
-							if((zero_based_normal_index < 0) || (zero_based_normal_index >= (int)vert_normals.size()))
-								throw glare::Exception("Normal index invalid. (index '" + toString(zero_based_normal_index) + "' out of bounds, on line " + toString(linenum) + ")");
+				string_view mtllib_path;
+				parser.parseNonWSToken(mtllib_path);
 
-							Vert v;
-							v.vert_i = zero_based_vert_index;
-							v.norm_i = zero_based_normal_index;
+				sink.addMTLLibPath(mtllib_path);
+			}
+			else if(token == "usemtl")  //material to use for subsequent faces
+			{
+				skipWhitespace(parser);
 
-							const auto insert_res = added_verts.insert(std::make_pair(v, num_verts_added)); // Try and add to map
-							if(insert_res.second)
-							{
-								// Vert was not in map, but is added now.
-								handler.addVertex(vert_positions[zero_based_vert_index], vert_normals[zero_based_normal_index]);
-								face_added_vert_indices[i] = num_verts_added;
-								num_verts_added++;
-							}
-							else
-							{
-								// Vert was in map already, and insert_res.first is an iterator referring to the existing item.
-								face_added_vert_indices[i] = insert_res.first->second;
-							}
-					
-						}
-						else
-						{
-							Vert v;
-							v.vert_i = zero_based_vert_index;
-							v.norm_i = 0;
-							const auto res = added_verts.find(v);
-							if(res == added_verts.end())
-							{
-								// Not added yet, add:
-								handler.addVertex(vert_positions[zero_based_vert_index]);
-								added_verts.insert(std::make_pair(v, num_verts_added));
-								face_added_vert_indices[i] = num_verts_added;
-								num_verts_added++;
-							}
-							else
-								face_added_vert_indices[i] = res->second;
-						}
+				string_view material_name;
+				parser.parseNonWSToken(material_name);
 
-					}//end for each vertex
+				sink.useMaterial(material_name);
+			}
+		}
 
-					//if(numfaceverts >= MAX_NUM_FACE_VERTICES)
-					//	conPrint("Warning, maximum number of verts per face reached or exceeded.");
+		parser.advancePastLine();
+	}
+}
 
-					if(numfaceverts < 3)
-						throw glare::Exception("Invalid number of vertices in face: " + toString(numfaceverts) + " (line " + toString(linenum) + ")");
 
-					//------------------------------------------------------------------------
-					//Check current material index
-					//------------------------------------------------------------------------
-					if(current_mat_index < 0)
-					{
-						//conPrint("WARNING: found faces without a 'usemtl' line first.  Using material 'default'");
-						current_mat_index = 0;
-						materials.insert("default", current_mat_index);
-						handler.addMaterialUsed("default");
-					}
+// If .mtl file does not exist, just skip trying to parse it instead of throwing an exception.
+void parseReferencedMTLLib(const std::string& mtllib_path, const std::string& obj_filename, MLTLibMaterials& mtllib_mats_out)
+{
+	// NOTE: what's the best way to handle this?  Should we allow a "./" prefix?
+	const std::string safe_mtl_path = sanitiseString(mtllib_path);
 
-					if(numfaceverts == 3)
-					{
-						handler.addTriangle(&face_added_vert_indices[0], &face_uv_indices[0], current_mat_index);
-					}
-					else if(numfaceverts == 4)
-					{
-						handler.addQuad(&face_added_vert_indices[0], &face_uv_indices[0], current_mat_index);
-					}
-					else
-					{
-						// Add all tris needed to make up the face polygon
-						for(int i=2; i<numfaceverts; ++i)
-						{
-							const unsigned int v_indices[3] = { face_added_vert_indices[0], face_added_vert_indices[i - 1], face_added_vert_indices[i] };
-							const unsigned int tri_uv_indices[3] = { face_uv_indices[0], face_uv_indices[i-1], face_uv_indices[i] };
-							handler.addTriangle(v_indices, tri_uv_indices, current_mat_index);
-						}
-					}
+	const std::string mtl_fullpath = FileUtils::join(FileUtils::getDirectory(obj_filename), safe_mtl_path);
+	if(FileUtils::fileExists(mtl_fullpath))
+		FormatDecoderObj::parseMTLLib(mtl_fullpath, mtllib_mats_out);
+}
 
-					// Finished handling face.
-				}
-				else if(token == "mtllib")
-				{
-					skipWhitespace(parser);
 
-					string_view mtllib_path;
-					parser.parseNonWSToken(mtllib_path);
+// Adds uvs, materials and faces to the handler, de-duplicating face vertices.  Used both when parsing sequentially and when
+// merging chunks.
+class ObjMeshBuilder
+{
+public:
+	ObjMeshBuilder(Indigo::Mesh& handler_)
+	:	handler(handler_),
+		encountered_uvs(false),
+		current_mat_index(-1),
+		uv_vector(1),
+		face_uv_indices(MAX_NUM_FACE_VERTICES, 0),
+		added_verts(emptyVertKey(), 45000),
+		num_verts_added(0),
+		face_added_vert_indices(MAX_NUM_FACE_VERTICES)
+	{}
 
-					if(parse_mtllib)
-					{
-						// NOTE: what's the best way to handle this?  Should we allow a "./" prefix?
-						const std::string safe_mtl_path = sanitiseString(toString(mtllib_path));
+	void addUV(const Indigo::Vec2f& uv)
+	{
+		// Assume one texcoord per vertex.
+		if(!encountered_uvs)
+		{
+			handler.setMaxNumTexcoordSets(1);
+			encountered_uvs = true;
+		}
 
-						// If .mtl file does not exist, just skip trying to parse it instead of throwing an exception.
-						const std::string mtl_fullpath = FileUtils::join(FileUtils::getDirectory(filename), safe_mtl_path);
-						if(FileUtils::fileExists(mtl_fullpath))
-							parseMTLLib(mtl_fullpath, mtllib_mats_out);
-					}
+		uv_vector[0] = uv;
+		handler.addUVs(uv_vector);
+	}
+
+	void useMaterial(const std::string& material_name)
+	{
+		/// See if material has already been created, create it if it hasn't been ///
+		if(materials.isInserted(material_name))
+			current_mat_index = materials.getValue(material_name);
+		else
+		{
+			current_mat_index = (int)materials.size();
+			materials.insert(material_name, current_mat_index);
+			handler.addMaterialUsed(toIndigoString(material_name));
+		}
+	}
+
+	// Indices flagged as relative are offset by positions_before, uvs_before and normals_before.  num_positions and num_normals
+	// are the number of positions and normals parsed before the face, which it may reference.
+	void addFace(const ObjFaceVert* face_verts, int numfaceverts, int linenum, size_t positions_before, size_t uvs_before, size_t normals_before,
+		const Indigo::Vec3f* vert_positions, size_t num_positions, const Indigo::Vec3f* vert_normals, size_t num_normals)
+	{
+		for(int i=0; i<numfaceverts; ++i)
+		{
+			const ObjFaceVert& face_vert = face_verts[i];
+
+			const int zero_based_vert_index = (face_vert.flags & ObjFaceVert::VERT_INDEX_RELATIVE) ? ((int)positions_before + face_vert.vert_i) : face_vert.vert_i;
+
+			if(face_vert.flags & ObjFaceVert::HAS_UV_INDEX)
+				face_uv_indices[i] = (face_vert.flags & ObjFaceVert::UV_INDEX_RELATIVE) ? (unsigned int)(uvs_before + face_vert.uv_i) : (unsigned int)face_vert.uv_i;
+
+			// Add the vertex to the mesh, if it hasn't been added already.
+
+			if((zero_based_vert_index < 0) || (zero_based_vert_index >= (int)num_positions))
+				throw glare::Exception("Position index invalid. (index '" + toString(zero_based_vert_index) + "' out of bounds, on line " + toString(linenum) + ")");
+
+			if(face_vert.flags & ObjFaceVert::HAS_NORMAL_INDEX)
+			{
+				const int zero_based_normal_index = (face_vert.flags & ObjFaceVert::NORMAL_INDEX_RELATIVE) ? ((int)normals_before + face_vert.norm_i) : face_vert.norm_i;
+
+				if((zero_based_normal_index < 0) || (zero_based_normal_index >= (int)num_normals))
+					throw glare::Exception("Normal index invalid. (index '" + toString(zero_based_normal_index) + "' out of bounds, on line " + toString(linenum) + ")");
+
+				Vert v;
+				v.vert_i = zero_based_vert_index;
+				v.norm_i = zero_based_normal_index;
+
+				const auto insert_res = added_verts.insert(std::make_pair(v, num_verts_added)); // Try and add to map
+				if(insert_res.second)
+				{
+					// Vert was not in map, but is added now.
+					handler.addVertex(vert_positions[zero_based_vert_index], vert_normals[zero_based_normal_index]);
+					face_added_vert_indices[i] = num_verts_added;
+					num_verts_added++;
 				}
-				else if(token == "usemtl")  //material to use for subsequent faces
+				else
 				{
-					/// Parse material name ///
-					skipWhitespace(parser);
+					// Vert was in map already, and insert_res.first is an iterator referring to the existing item.
+					face_added_vert_indices[i] = insert_res.first->second;
+				}
+			}
+			else
+			{
+				Vert v;
+				v.vert_i = zero_based_vert_index;
+				v.norm_i = 0;
+				const auto res = added_verts.find(v);
+				if(res == added_verts.end())
+				{
+					// Not added yet, add:
+					handler.addVertex(vert_positions[zero_based_vert_index]);
+					added_verts.insert(std::make_pair(v, num_verts_added));
+					face_added_vert_indices[i] = num_verts_added;
+					num_verts_added++;
+				}
+				else
+					face_added_vert_indices[i] = res->second;
+			}
+		}//end for each vertex
 
-					string_view material_name;
-					parser.parseNonWSToken(material_name);
+		//------------------------------------------------------------------------
+		//Check current material index
+		//------------------------------------------------------------------------
+		if(current_mat_index < 0)
+		{
+			//conPrint("WARNING: found faces without a 'usemtl' line first.  Using material 'default'");
+			current_mat_index = 0;
+			materials.insert("default", current_mat_index);
+			handler.addMaterialUsed("default");
+		}
 
-					/// See if material has already been created, create it if it hasn't been ///
-					if(materials.isInserted(toString(material_name)))
-						current_mat_index = materials.getValue(toString(material_name));
-					else
-					{
-						//conPrint("\tFound reference to material '" + material_name + "'.");
-						current_mat_index = (int)materials.size();
-						materials.insert(toString(material_name), current_mat_index);
-						handler.addMaterialUsed(toIndigoString(toString(material_name)));
-					}
-				}
+		if(numfaceverts == 3)
+		{
+			handler.addTriangle(&face_added_vert_indices[0], &face_uv_indices[0], current_mat_index);
+		}
+		else if(numfaceverts == 4)
+		{
+			handler.addQuad(&face_added_vert_indices[0], &face_uv_indices[0], current_mat_index);
+		}
+		else
+		{
+			// Add all tris needed to make up the face polygon
+			for(int i=2; i<numfaceverts; ++i)
+			{
+				const unsigned int v_indices[3] = { face_added_vert_indices[0], face_added_vert_indices[i - 1], face_added_vert_indices[i] };
+				const unsigned int tri_uv_indices[3] = { face_uv_indices[0], face_uv_indices[i-1], face_uv_indices[i] };
+				handler.addTriangle(v_indices, tri_uv_indices, current_mat_index);
 			}
+		}
+	}
 
-			parser.advancePastLine();
+private:
+	static Vert emptyVertKey()
+	{
+		Vert empty_key;
+		empty_key.vert_i = std::numeric_limits<unsigned int>::max();
+		empty_key.norm_i = std::numeric_limits<unsigned int>::max();
+		return empty_key;
+	}
+
+	Indigo::Mesh& handler;
+
+	bool encountered_uvs;
+
+	NameMap<int> materials;
+	int current_mat_index;
+
+	Indigo::Vector<Indigo::Vec2f> uv_vector;
+	std::vector<unsigned int> face_uv_indices;
+
+	HashMap<Vert, unsigned int, VertHash> added_verts;
+	unsigned int num_verts_added;
+	std::vector<unsigned int> face_added_vert_indices;
+};
+
+
+// Passes everything straight on to the ObjMeshBuilder as it is parsed.  Only the positions and normals are kept, as faces look them up.
+class ObjStreamSink
+{
+public:
+	ObjStreamSink(ObjMeshBuilder& builder_, const std::string& filename_, bool parse_mtllib_, MLTLibMaterials& mtllib_mats_out_)
+	:	builder(builder_), filename(filename_), parse_mtllib(parse_mtllib_), mtllib_mats_out(mtllib_mats_out_), num_uvs(0)
+	{}
+
+	size_t numPositions() const { return vert_positions.size(); }
+	size_t numUVs() const { return num_uvs; }
+	size_t numNormals() const { return vert_normals.size(); }
+
+	void addPosition(const Indigo::Vec3f& pos) { vert_positions.push_back(pos); }
+	void addUV(const Indigo::Vec2f& uv) { builder.addUV(uv); num_uvs++; }
+	void addNormal(const Indigo::Vec3f& normal) { vert_normals.push_back(normal); }
+
+	void addFace(const ObjFaceVert* face_verts, int numfaceverts, int linenum)
+	{
+		// Relative indices have already been resolved against the total counts, so there is nothing to add to them.
+		builder.addFace(face_verts, numfaceverts, linenum, /*positions before=*/0, /*uvs before=*/0, /*normals before=*/0,
+			vert_positions.data(), vert_positions.size(), vert_normals.data(), vert_normals.size());
+	}
+
+	void addMTLLibPath(string_view mtllib_path)
+	{
+		if(parse_mtllib)
+			parseReferencedMTLLib(toString(mtllib_path), filename, mtllib_mats_out);
+	}
+
+	void useMaterial(string_view material_name) { builder.useMaterial(toString(material_name)); }
+
+private:
+	ObjMeshBuilder& builder;
+	const std::string& filename;
+	bool parse_mtllib;
+	MLTLibMaterials& mtllib_mats_out;
+
+	std::vector<Indigo::Vec3f> vert_positions;
+	std::vector<Indigo::Vec3f> vert_normals;
+	size_t num_uvs;
+};
+
+
+// Stores everything in an ObjChunk, to be merged with the other chunks once they have all been parsed.
+class ObjChunkSink
+{
+public:
+	ObjChunkSink(ObjChunk& chunk_) : chunk(chunk_), counts_changed(true) {}
+
+	size_t numPositions() const { return chunk.vert_positions.size(); }
+	size_t numUVs() const { return chunk.uvs.size(); }
+	size_t numNormals() const { return chunk.vert_normals.size(); }
+
+	void addPosition(const Indigo::Vec3f& pos) { chunk.vert_positions.push_back(pos); counts_changed = true; }
+	void addUV(const Indigo::Vec2f& uv) { chunk.uvs.push_back(uv); counts_changed = true; }
+	void addNormal(const Indigo::Vec3f& normal) { chunk.vert_normals.push_back(normal); counts_changed = true; }
+
+	void addFace(const ObjFaceVert* face_verts, int numfaceverts, int linenum)
+	{
+		if(counts_changed)
+		{
+			startRun(/*material name index=*/-1);
+			counts_changed = false;
+		}
+
+		ObjFace face;
+		face.first_vert = (uint32)chunk.face_verts.size();
+		face.num_verts = (uint32)numfaceverts;
+		face.linenum = linenum;
+		chunk.faces.push_back(face);
+		chunk.face_verts.insert(chunk.face_verts.end(), face_verts, face_verts + numfaceverts);
+	}
+
+	void addMTLLibPath(string_view mtllib_path) { chunk.mtllib_paths.push_back(toString(mtllib_path)); }
+
+	void useMaterial(string_view material_name)
+	{
+		startRun((int)chunk.material_names.size());
+		chunk.material_names.push_back(toString(material_name));
+		counts_changed = false;
+	}
+
+private:
+	void startRun(int material_name_index)
+	{
+		ObjFaceRun run;
+		run.begin_face = (uint32)chunk.faces.size();
+		run.num_positions = (uint32)chunk.vert_positions.size();
+		run.num_uvs = (uint32)chunk.uvs.size();
+		run.num_normals = (uint32)chunk.vert_normals.size();
+		run.material_name_index = material_name_index;
+		chunk.runs.push_back(run);
+	}
+
+	ObjChunk& chunk;
+	bool counts_changed; // Have any positions, uvs or normals been parsed since the current run was started?
+};
+
+
+void parseObjChunk(ObjChunk& chunk, float scale)
+{
+	ObjChunkSink sink(chunk);
+	try
+	{
+		parseObjText(chunk.text, chunk.text_size, scale, sink, chunk.num_lines);
+	}
+	catch(ObjParseError& e)
+	{
+		chunk.error = true;
+		chunk.error_msg_before_linenum = e.before;
+		chunk.error_msg_after_linenum = e.after;
+		chunk.error_linenum = e.linenum;
+	}
+}
+
+
+class ParseObjChunkTask : public glare::Task
+{
+public:
+	virtual void run(size_t /*thread_index*/) override
+	{
+		parseObjChunk(*chunk, scale);
+	}
+
+	ObjChunk* chunk;
+	float scale;
+};
+
+
+// Returns the offset of the start of the first line at or after offset, such that the line before it can't continue onto
+// it.  A backslash in a line continues it onto the next line - see skipWhitespace() - so splitting after any line
+// containing one is avoided.
+size_t findObjChunkBoundary(const char* text, size_t text_size, size_t offset)
+{
+	while(offset < text_size)
+	{
+		const char* newline = (const char*)std::memchr(text + offset, '\n', text_size - offset);
+		if(!newline)
+			return text_size;
+
+		const size_t line_end = newline - text;
+		bool has_backslash = false;
+		for(size_t i=line_end; i > 0 && text[i - 1] != '\n'; --i)
+			if(text[i - 1] == '\\')
+			{
+				has_backslash = true;
+				break;
+			}
+
+		offset = line_end + 1;
+		if(!has_backslash)
+			return offset;
+	}
+	return text_size;
+}
+
+
+// Parses the buffer in a single pass, adding everything to the handler as it is parsed.
+void loadModelFromBufferSequentially(const uint8* data, size_t len, const std::string& filename, Indigo::Mesh& handler, float scale, bool parse_mtllib, MLTLibMaterials& mtllib_mats_out)
+{
+	ObjMeshBuilder builder(handler);
+	ObjStreamSink sink(builder, filename, parse_mtllib, mtllib_mats_out);
+	int linenum = 0;
+	try
+	{
+		parseObjText((const char*)data, len, scale, sink, linenum);
+	}
+	catch(ObjParseError& e)
+	{
+		throw glare::Exception(e.before + toString(e.linenum) + e.after);
+	}
+
+	handler.endOfModel();
+}
+
+
+// Splits the buffer into num_chunks chunks at line boundaries and parses them, in parallel if task_manager is non-null.  Then
+// merges the chunks in file order, resolving relative indices, de-duplicating vertices and adding everything to the handler,
+// in the same order as a sequential parse would.
+void loadModelFromBufferInChunks(const uint8* data, size_t len, const std::string& filename, Indigo::Mesh& handler, float scale, bool parse_mtllib, MLTLibMaterials& mtllib_mats_out,
+	glare::TaskManager* task_manager, size_t num_chunks)
+{
+	const char* const text = (const char*)data;
+
+	//-------------------------------- Split into chunks and parse them --------------------------------
+	std::vector<ObjChunk> chunks;
+	chunks.reserve(num_chunks);
+	size_t chunk_begin = 0;
+	for(size_t i=0; i<num_chunks && chunk_begin < len; ++i)
+	{
+		const size_t chunk_end = (i + 1 == num_chunks) ? len : findObjChunkBoundary(text, len, myMax(chunk_begin, len * (i + 1) / num_chunks));
+		if(chunk_end > chunk_begin)
+		{
+			chunks.push_back(ObjChunk());
+			chunks.back().text = text + chunk_begin;
+			chunks.back().text_size = chunk_end - chunk_begin;
+		}
+		chunk_begin = chunk_end;
+	}
+
+	if(task_manager && chunks.size() > 1)
+	{
+		glare::TaskGroupRef group = new glare::TaskGroup();
+		for(size_t i=0; i<chunks.size(); ++i)
+		{
+			Reference<ParseObjChunkTask> task = new ParseObjChunkTask();
+			task->chunk = &chunks[i];
+			task->scale = scale;
+			group->tasks.push_back(task);
+		}
+		task_manager->runTaskGroup(group);
+	}
+	else
+	{
+		for(size_t i=0; i<chunks.size(); ++i)
+			parseObjChunk(chunks[i], scale);
+	}
+
+	//-------------------------------- Merge --------------------------------
+	// Positions and normals are looked up by absolute index, so concatenate them.
+	size_t total_num_positions = 0, total_num_normals = 0;
+	for(size_t i=0; i<chunks.size(); ++i)
+	{
+		total_num_positions += chunks[i].vert_positions.size();
+		total_num_normals += chunks[i].vert_normals.size();
+	}
+	std::vector<Indigo::Vec3f> vert_positions(total_num_positions);
+	std::vector<Indigo::Vec3f> vert_normals(total_num_normals);
+	std::vector<size_t> chunk_num_positions(chunks.size());
+	std::vector<size_t> chunk_num_normals(chunks.size());
+	{
+		size_t pos_i = 0, normal_i = 0;
+		for(size_t i=0; i<chunks.size(); ++i)
+		{
+			chunk_num_positions[i] = chunks[i].vert_positions.size();
+			chunk_num_normals[i] = chunks[i].vert_normals.size();
+			if(chunk_num_positions[i] > 0)
+				std::memcpy(&vert_positions[pos_i], chunks[i].vert_positions.data(), chunk_num_positions[i] * sizeof(Indigo::Vec3f));
+			if(chunk_num_normals[i] > 0)
+				std::memcpy(&vert_normals[normal_i], chunks[i].vert_normals.data(), chunk_num_normals[i] * sizeof(Indigo::Vec3f));
+			pos_i += chunk_num_positions[i];
+			normal_i += chunk_num_normals[i];
+			chunks[i].vert_positions = std::vector<Indigo::Vec3f>(); // Free memory
+			chunks[i].vert_normals = std::vector<Indigo::Vec3f>();
+		}
+	}
+
+	ObjMeshBuilder builder(handler);
+
+	// The number of positions, uvs, normals and lines in the chunks before the current one.
+	size_t positions_before = 0, uvs_before = 0, normals_before = 0;
+	int lines_before = 0;
+
+	for(size_t c=0; c<chunks.size(); ++c)
+	{
+		const ObjChunk& chunk = chunks[c];
+
+		if(parse_mtllib)
+			for(size_t i=0; i<chunk.mtllib_paths.size(); ++i)
+				parseReferencedMTLLib(chunk.mtllib_paths[i], filename, mtllib_mats_out);
+
+		size_t num_uvs_added = 0; // From this chunk
+		for(size_t r=0; r<chunk.runs.size(); ++r)
+		{
+			const ObjFaceRun& run = chunk.runs[r];
+			const size_t run_end_face = (r + 1 < chunk.runs.size()) ? chunk.runs[r + 1].begin_face : chunk.faces.size();
+
+			// Add the uvs parsed before this run.  They are added as they are reached, rather than all up front, as the
+			// handler checks uv indices against the number of uvs added so far.
+			for(; num_uvs_added < run.num_uvs; ++num_uvs_added)
+				builder.addUV(chunk.uvs[num_uvs_added]);
+
+			if(run.material_name_index >= 0)
+				builder.useMaterial(chunk.material_names[run.material_name_index]);
+
+			// The number of positions and normals parsed before the faces of this run, and so which can be referenced by them.
+			const size_t num_positions = positions_before + run.num_positions;
+			const size_t num_normals   = normals_before   + run.num_normals;
+
+			for(size_t f=run.begin_face; f<run_end_face; ++f)
+			{
+				const ObjFace& face = chunk.faces[f];
+				builder.addFace(&chunk.face_verts[face.first_vert], (int)face.num_verts, lines_before + face.linenum, positions_before, uvs_before, normals_before,
+					vert_positions.data(), num_positions, vert_normals.data(), num_normals);
+			}
 		}
 
-		handler.endOfModel();
+		if(chunk.error)
+			throw glare::Exception(chunk.error_msg_before_linenum + toString(lines_before + chunk.error_linenum) + chunk.error_msg_after_linenum);
+
+		// Add any uvs after the last run.
+		for(; num_uvs_added < chunk.uvs.size(); ++num_uvs_added)
+			builder.addUV(chunk.uvs[num_uvs_added]);
+
+		positions_before += chunk_num_positions[c];
+		uvs_before += chunk.uvs.size();
+		normals_before += chunk_num_normals[c];
+		lines_before += chunk.num_lines;
+	}
+
+	handler.endOfModel();
+}
+
+
+} // end anonymous namespace
+
+
+void FormatDecoderObj::loadModelFromBuffer(const uint8* data, size_t len, const std::string& filename, Indigo::Mesh& handler, float scale, bool parse_mtllib, MLTLibMaterials& mtllib_mats_out,
+	glare::TaskManager* task_manager) // Throws glare::Exception on failure.
+{
+	// Timer load_timer;
+	try
+	{
+		// Each chunk should be big enough that the per-chunk overhead is negligible, with several chunks per thread, so that a
+		// chunk that is slow to parse, e.g. because it has many faces, doesn't hold everything up.
+		const size_t min_chunk_size = 1 << 20;
+		const size_t num_chunks = task_manager ? myMax<size_t>(1, myMin(task_manager->getConcurrency() * 4, len / min_chunk_size)) : 1;
+
+		if(num_chunks > 1)
+			loadModelFromBufferInChunks(data, len, filename, handler, scale, parse_mtllib, mtllib_mats_out, task_manager, num_chunks);
+		else
+			loadModelFromBufferSequentially(data, len, filename, handler, scale, parse_mtllib, mtllib_mats_out);
 		// conPrint("\tOBJ parse took " + toString(load_timer.getSecondsElapsed()) + "s");
 	}
 	catch(Indigo::IndigoException& e)
@@ -579,6 +1037,107 @@ void FormatDecoderObj::parseMTLLibFromBuffer(const uint8* data, size_t len, cons
 
 #include "../utils/TestUtils.h"
 #include "../utils/FileUtils.h"
+#include "../utils/ConPrint.h"
+
+
+// Makes an OBJ file with a grid of grid_res x grid_res quads, using most of the syntax the parser handles: normals, uvs, relative
+// indices, polygons, materials, comments and line continuations.  Each row of vertices is followed by the faces using it, as
+// streaming exporters write them, so relative indices refer back across many lines.
+static std::string makeTestOBJ(int grid_res)
+{
+	const int verts_per_row = grid_res + 1;
+
+	std::string s;
+	s.reserve((size_t)verts_per_row * verts_per_row * 110);
+	s += "# Test file\nmtllib test.mtl\n";
+
+	for(int y=0; y<verts_per_row; ++y)
+	{
+		for(int x=0; x<verts_per_row; ++x)
+		{
+			s += "v " + toString(x * 0.1f) + " " + toString(y * 0.1f) + " " + toString(((x * 7 + y * 3) % 11) * 0.01f) + "\n";
+			s += "vt " + toString(x / (float)grid_res) + " " + toString(y / (float)grid_res) + "\n";
+			s += "vn 0 " + toString(((x + y) % 5) * 0.1f) + " 1\n";
+		}
+
+		if(y == 0)
+			continue;
+
+		if(y % 7 == 0)
+			s += "usemtl mat_" + toString(y % 3) + "\n";
+		if(y % 13 == 0)
+			s += "# row " + toString(y) + "\n";
+
+		const int num_verts_so_far = (y + 1) * verts_per_row;
+		for(int x=0; x<grid_res; ++x)
+		{
+			const int corners[4] = { (y - 1) * verts_per_row + x, (y - 1) * verts_per_row + x + 1, y * verts_per_row + x + 1, y * verts_per_row + x }; // Zero-based
+			std::string corner_strings[4];
+			for(int i=0; i<4; ++i)
+			{
+				const int index = ((x + y) % 5 == 0) ? (corners[i] - num_verts_so_far) : (corners[i] + 1); // Relative or absolute
+				corner_strings[i] = toString(index) + "/" + toString(index) + "/" + toString(index);
+			}
+
+			if((x + y) % 17 == 0)
+				s += "f " + corner_strings[0] + " " + corner_strings[1] + " \\\n " + corner_strings[2] + " " + corner_strings[3] + "\n"; // Continued onto the next line
+			else if((x + y) % 11 == 0)
+				s += "f " + corner_strings[0] + " " + corner_strings[1] + " " + corner_strings[2] + "\nf " + corner_strings[0] + " " + corner_strings[2] + " " + corner_strings[3] + "\n";
+			else
+				s += "f " + corner_strings[0] + " " + corner_strings[1] + " " + corner_strings[2] + " " + corner_strings[3] + "\n";
+		}
+	}
+	return s;
+}
+
+
+static void testChunkedLoadMatchesSequentialLoad(const std::string& obj, glare::TaskManager& task_manager)
+{
+	std::string ref_excep_msg;
+	uint64 ref_checksum = 0;
+	size_t ref_num_mats = 0;
+	{
+		Indigo::Mesh mesh;
+		MLTLibMaterials mats;
+		try
+		{
+			loadModelFromBufferSequentially((const uint8*)obj.data(), obj.size(), "dummy_filename", mesh, 1.f, /*parse mtllib=*/false, mats);
+			ref_checksum = mesh.checksum();
+			ref_num_mats = mesh.used_materials.size();
+		}
+		catch(glare::Exception& e)
+		{
+			ref_excep_msg = e.what();
+		}
+		catch(Indigo::IndigoException& e)
+		{
+			ref_excep_msg = toStdString(e.what());
+		}
+	}
+
+	const size_t chunk_counts[] = { 1, 2, 3, 7, 64, 1000 };
+	for(size_t z=0; z<staticArrayNumElems(chunk_counts); ++z)
+		for(int use_task_manager=0; use_task_manager<2; ++use_task_manager)
+		{
+			Indigo::Mesh mesh;
+			MLTLibMaterials mats;
+			try
+			{
+				loadModelFromBufferInChunks((const uint8*)obj.data(), obj.size(), "dummy_filename", mesh, 1.f, /*parse mtllib=*/false, mats, use_task_manager ? &task_manager : NULL, chunk_counts[z]);
+				testAssert(ref_excep_msg.empty());
+				testAssert(mesh.checksum() == ref_checksum);
+				testAssert(mesh.used_materials.size() == ref_num_mats);
+			}
+			catch(glare::Exception& e)
+			{
+				testEqual(std::string(e.what()), ref_excep_msg);
+			}
+			catch(Indigo::IndigoException& e)
+			{
+				testEqual(toStdString(e.what()), ref_excep_msg);
+			}
+		}
+}
 
 
 #if 0
@@ -759,6 +1318,75 @@ void FormatDecoderObj::test()
 		failTest(e.what());
 	}
 
+	//=================================== Test that parsing in chunks gives the same results as parsing sequentially =====================================
+	try
+	{
+		glare::TaskManager task_manager(4);
+
+		const char* test_files[] = { "/testfiles/a_test_mesh.obj", "/testfiles/sphere.obj", "/testfiles/sphere_with_backslashes.obj", "/testfiles/teapot.obj",
+			"/testfiles/obj/neg pos indices.obj", "/testfiles/obj/neg normal indices.obj", "/testfiles/obj/neg uv indices.obj" };
+		for(size_t i=0; i<staticArrayNumElems(test_files); ++i)
+		{
+			std::string contents;
+			FileUtils::readEntireFile(TestUtils::getTestReposDir() + test_files[i], contents);
+			testChunkedLoadMatchesSequentialLoad(contents, task_manager);
+		}
+
+		const std::string test_obj = makeTestOBJ(100);
+		testChunkedLoadMatchesSequentialLoad(test_obj, task_manager);
+
+		// Errors should be reported with the same line number however the file is split.
+		testChunkedLoadMatchesSequentialLoad(test_obj + "v 1 2\n", task_manager);
+		testChunkedLoadMatchesSequentialLoad(test_obj.substr(0, test_obj.size() / 2) + "f 1/1/1 2/2/2\n" + test_obj.substr(test_obj.size() / 2), task_manager);
+		testChunkedLoadMatchesSequentialLoad(test_obj.substr(0, test_obj.size() / 2) + "f -100000000 1 2\n" + test_obj.substr(test_obj.size() / 2), task_manager);
+		testChunkedLoadMatchesSequentialLoad(test_obj.substr(0, test_obj.size() / 3) + "f 1//1000000 2 3\n" + test_obj.substr(test_obj.size() / 3), task_manager);
+
+		// Check the relative indices resolved to the same vertices as the absolute indices would: each quad's vertices should be in the same row or the next.
+		{
+			Indigo::Mesh mesh;
+			MLTLibMaterials mats;
+			loadModelFromBufferInChunks((const uint8*)test_obj.data(), test_obj.size(), "dummy_filename", mesh, 1.f, /*parse mtllib=*/false, mats, &task_manager, /*num chunks=*/16);
+			testAssert(mesh.used_materials.size() == 4); // "default" and mat_0 to mat_2.
+			testAssert(mesh.quads.size() + mesh.triangles.size() / 2 == 100 * 100);
+			for(size_t i=0; i<mesh.quads.size(); ++i)
+			{
+				const float y0 = mesh.vert_positions[mesh.quads[i].vertex_indices[0]].y;
+				const float y2 = mesh.vert_positions[mesh.quads[i].vertex_indices[2]].y;
+				testAssert(epsEqual(y2 - y0, 0.1f));
+			}
+		}
+	}
+	catch(glare::Exception& e)
+	{
+		failTest(e.what());
+	}
+
+	//=================================== Measure parse speed =====================================
+	try
+	{
+		// Use a grid_res of around 4500 to test multi-GB files.
+		const int grid_res = 400;
+		const std::string test_obj = makeTestOBJ(grid_res);
+		const double size_MB = test_obj.size() / (1024.0 * 1024.0);
+
+		glare::TaskManager task_manager;
+		for(int use_task_manager=0; use_task_manager<2; ++use_task_manager)
+		{
+			Indigo::Mesh mesh;
+			MLTLibMaterials mats;
+			Timer timer;
+			loadModelFromBuffer((const uint8*)test_obj.data(), test_obj.size(), "dummy_filename", mesh, 1.f, /*parse mtllib=*/false, mats, use_task_manager ? &task_manager : NULL);
+			const double elapsed = timer.elapsed();
+
+			conPrint("Parsed " + doubleToStringNSigFigs(size_MB, 4) + " MB OBJ " + (use_task_manager ? ("with " + toString(task_manager.getConcurrency()) + " threads") : std::string("single-threaded")) + " in " +
+				doubleToStringNSigFigs(elapsed, 4) + " s (" + doubleToStringNSigFigs(size_MB / elapsed, 4) + " MB/s)");
+		}
+	}
+	catch(glare::Exception& e)
+	{
+		failTest(e.what());
+	}
+
 	//=================================== Test parsing of .mtl files =====================================
 	try
 	{
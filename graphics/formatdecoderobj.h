@@ -11,6 +11,7 @@ Code By Nicholas Chapman.
 #include <string>
 #include <vector>
 namespace Indigo { class Mesh; }
+namespace glare { class TaskManager; }
 
 
 // See http://www.fileformat.info/format/material/
@@ -51,15 +52,26 @@ struct MLTLibMaterials
 /*=====================================================================
 FormatDecoderObj
 ----------------
-
+Without a task manager, or for small files, the file is parsed in a single
+pass, with faces added to the mesh as they are parsed.
+Otherwise the file is split into chunks at line boundaries, which are parsed
+in parallel into per-chunk position, normal, uv and face arrays.  The chunks
+are then merged in file order: relative (negative) indices are made absolute,
+vertices are de-duplicated and everything is added to the mesh, in the same
+order as the single pass parse would, so the result doesn't depend on the
+number of chunks.
 =====================================================================*/
 class FormatDecoderObj
 {
 public:
-	static void streamModel(const std::string& filename, Indigo::Mesh& handler, float scale, bool parse_mtllib, MLTLibMaterials& mtllib_mats_out); // Throws glare::Exception on failure.
+	// Multi-thread if task_manager is non-null.
+	static void streamModel(const std::string& filename, Indigo::Mesh& handler, float scale, bool parse_mtllib, MLTLibMaterials& mtllib_mats_out,
+		glare::TaskManager* task_manager = NULL); // Throws glare::Exception on failure.
 
 	// filename is used for finding .mtl file, if parse_mtllib is true.
-	static void loadModelFromBuffer(const uint8* data, size_t len, const std::string& filename, Indigo::Mesh& handler, float scale, bool parse_mtllib, MLTLibMaterials& mtllib_mats_out); // Throws glare::Exception on failure.
+	// Multi-thread if task_manager is non-null.
+	static void loadModelFromBuffer(const uint8* data, size_t len, const std::string& filename, Indigo::Mesh& handler, float scale, bool parse_mtllib, MLTLibMaterials& mtllib_mats_out,
+		glare::TaskManager* task_manager = NULL); // Throws glare::Exception on failure.
 
 	static void parseMTLLib(const std::string& filename, MLTLibMaterials& mtllib_mats_out);
 
@@ -10,10 +10,41 @@ Copyright Glare Technologies Limited 2024 -
 #include "../utils/Exception.h"
 #include "../utils/ConPrint.h"
 #include "../utils/StringUtils.h"
+#include "../utils/FileUtils.h"
+#include "../utils/IncludeXXHash.h"
+#include "../utils/Lock.h"
 #include <lualib.h>
 #include <Luau/Compiler.h>
+#include "Luau/Bytecode.h"
 #include "Luau/BytecodeBuilder.h"
 #include "Luau/ParseResult.h"
+#include <cstring>
+
+
+static void getCompileOptions(Luau::CompileOptions& compile_options)
+{
+	compile_options.optimizationLevel = 1;
+	compile_options.debugLevel = 1;
+	compile_options.typeInfoLevel = 0;
+	compile_options.coverageLevel = 0;
+	compile_options.vectorLib = NULL;
+	compile_options.vectorCtor = "Vec3f";
+	compile_options.vectorType = "Vec3f";
+	compile_options.mutableGlobals = NULL;
+}
+
+
+// Throws Luau::ParseErrors or Luau::ParseError on failure.
+static std::string compileBytecode(const std::string& script_src, const Luau::CompileOptions& compile_options)
+{
+	// Use C++ compilation API instead of C API so we can get error locations via the Luau::ParseError/Luau::ParseErrors exceptions.
+	Luau::ParseOptions parse_options;
+	Luau::BytecodeBuilder bytecode_builder(/*encoder*/NULL);
+
+	Luau::compileOrThrow(bytecode_builder, script_src, compile_options, parse_options);
+
+	return bytecode_builder.getBytecode();
+}
 
 
 LuaScript::LuaScript(LuaVM* lua_vm_, const LuaScriptOptions& options_, const std::string& script_src)
@@ -47,22 +78,9 @@ LuaScript::LuaScript(LuaVM* lua_vm_, const LuaScriptOptions& options_, const std
 		luaL_sandboxthread(thread_state);
 
 		Luau::CompileOptions compile_options;
-		compile_options.optimizationLevel = 1;
-		compile_options.debugLevel = 1;
-		compile_options.typeInfoLevel = 0;
-		compile_options.coverageLevel = 0;
-		compile_options.vectorLib = NULL;
-		compile_options.vectorCtor = "Vec3f";
-		compile_options.vectorType = "Vec3f";
-		compile_options.mutableGlobals = NULL;
-
-		// Use C++ compilation API instead of C API so we can get error locations via the Luau::ParseError/Luau::ParseErrors exceptions.
-		Luau::ParseOptions parse_options;
-		Luau::BytecodeBuilder bytecode_builder(/*encoder*/NULL);
-
-		Luau::compileOrThrow(bytecode_builder, script_src, compile_options, parse_options);
+		getCompileOptions(compile_options);
 
-		const std::string bytecode = bytecode_builder.getBytecode();
+		const std::string bytecode = options.bytecode_cache ? options.bytecode_cache->getOrCompileBytecode(script_src, compile_options) : compileBytecode(script_src, compile_options);
 
 		const std::string chunkname = "script";
 		const int result = luau_load(thread_state, chunkname.c_str(), bytecode.c_str(), bytecode.size(), /*env=*/0);
@@ -147,6 +165,163 @@ void LuaScript::exec()
 }
 
 
+static const uint32 BYTECODE_CACHE_EPOCH = 1; // This can be incremented to effectively invalidate the disk cache, since keys will change.
+static const uint32 BYTECODE_CACHE_FILE_MAGIC = 0x4342554C; // "LUBC" in little-endian
+
+
+static void hashCString(XXH64_state_t& hash_state, const char* s)
+{
+	if(s)
+		XXH64_update(&hash_state, s, std::strlen(s) + 1); // Include the null terminator so adjacent strings can't run together.
+	else
+		XXH64_update(&hash_state, "", 0);
+}
+
+
+// Computes hash over script source and compile options, which we will use as the cache key.
+// Hash over the Luau bytecode version so that a Luau upgrade will effectively invalidate existing cached bytecode.
+static uint64 computeBytecodeHashCode(const std::string& script_src, const Luau::CompileOptions& compile_options)
+{
+	const int32 options_ints[] = { compile_options.optimizationLevel, compile_options.debugLevel, compile_options.typeInfoLevel, compile_options.coverageLevel, 
+		(int32)LBC_VERSION_TARGET, (int32)BYTECODE_CACHE_EPOCH };
+
+	XXH64_state_t hash_state;
+	XXH64_reset(&hash_state, 1);
+	XXH64_update(&hash_state, script_src.data(), script_src.size());
+	XXH64_update(&hash_state, options_ints, sizeof(options_ints));
+	hashCString(hash_state, compile_options.vectorLib);
+	hashCString(hash_state, compile_options.vectorCtor);
+	hashCString(hash_state, compile_options.vectorType);
+	if(compile_options.mutableGlobals)
+		for(const char* const* g = compile_options.mutableGlobals; *g; ++g)
+			hashCString(hash_state, *g);
+	return XXH64_digest(&hash_state);
+}
+
+
+LuaBytecodeCache::LuaBytecodeCache()
+:	num_mem_hits(0),
+	num_disk_hits(0),
+	num_misses(0)
+{}
+
+
+LuaBytecodeCache::LuaBytecodeCache(const std::string& disk_cache_dir_)
+:	num_mem_hits(0),
+	num_disk_hits(0),
+	num_misses(0),
+	disk_cache_dir(disk_cache_dir_)
+{
+	try
+	{
+		FileUtils::createDirIfDoesNotExist(disk_cache_dir);
+	}
+	catch(FileUtils::FileUtilsExcep& e)
+	{
+		throw glare::Exception("Failed to create Lua bytecode cache dir: " + e.what());
+	}
+}
+
+
+std::string LuaBytecodeCache::getOrCompileBytecode(const std::string& script_src, const Luau::CompileOptions& compile_options)
+{
+	const uint64 hashcode = computeBytecodeHashCode(script_src, compile_options);
+
+	// Check in-memory cache
+	{
+		Lock lock(mutex);
+		auto it = mem_cache.find(hashcode);
+		if(it != mem_cache.end())
+		{
+			num_mem_hits++;
+			return it->second;
+		}
+	}
+
+	// Check disk cache.  Cache files consist of a magic number, the key (the hash of the source and compile options), the bytecode length, a hash of the bytecode, then the bytecode.
+	// If the file is truncated or corrupted, the length or bytecode hash won't match, and we recompile and overwrite the file.
+	const std::string cachefile_path = disk_cache_dir.empty() ? std::string() : (disk_cache_dir + "/" + toHexString(hashcode) + ".luaub");
+	if(!disk_cache_dir.empty() && FileUtils::fileExists(cachefile_path))
+	{
+		try
+		{
+			const std::string contents = FileUtils::readEntireFile(cachefile_path);
+			const size_t header_size = sizeof(uint32) + sizeof(uint64) * 3;
+			if(contents.size() > header_size)
+			{
+				uint32 magic;
+				uint64 file_hashcode, bytecode_len, bytecode_hash;
+				std::memcpy(&magic,         contents.data(),                                         sizeof(uint32));
+				std::memcpy(&file_hashcode, contents.data() + sizeof(uint32),                        sizeof(uint64));
+				std::memcpy(&bytecode_len,  contents.data() + sizeof(uint32) + sizeof(uint64),       sizeof(uint64));
+				std::memcpy(&bytecode_hash, contents.data() + sizeof(uint32) + sizeof(uint64) * 2,   sizeof(uint64));
+				if(magic == BYTECODE_CACHE_FILE_MAGIC && file_hashcode == hashcode && bytecode_len == contents.size() - header_size && 
+					XXH64(contents.data() + header_size, bytecode_len, /*seed=*/1) == bytecode_hash)
+				{
+					const std::string bytecode = contents.substr(header_size);
+
+					Lock lock(mutex);
+					mem_cache[hashcode] = bytecode;
+					num_disk_hits++;
+					return bytecode;
+				}
+			}
+			conPrint("Warning: Lua bytecode cache file '" + cachefile_path + "' is invalid, recompiling.");
+		}
+		catch(FileUtils::FileUtilsExcep& e)
+		{
+			conPrint("Warning: failed to read Lua bytecode cache file: " + e.what());
+		}
+	}
+
+	// Not in cache, compile.  Don't hold the mutex while compiling, so other scripts can be compiled concurrently.
+	const std::string bytecode = compileBytecode(script_src, compile_options);
+
+	{
+		Lock lock(mutex);
+		mem_cache[hashcode] = bytecode;
+		num_misses++;
+	}
+
+	if(!disk_cache_dir.empty())
+	{
+		try
+		{
+			const uint64 bytecode_len = bytecode.size();
+			const uint64 bytecode_hash = XXH64(bytecode.data(), bytecode.size(), /*seed=*/1);
+
+			std::string contents(sizeof(uint32) + sizeof(uint64) * 3, '\0');
+			std::memcpy(&contents[0],                                       &BYTECODE_CACHE_FILE_MAGIC, sizeof(uint32));
+			std::memcpy(&contents[sizeof(uint32)],                          &hashcode,                  sizeof(uint64));
+			std::memcpy(&contents[sizeof(uint32) + sizeof(uint64)],         &bytecode_len,              sizeof(uint64));
+			std::memcpy(&contents[sizeof(uint32) + sizeof(uint64) * 2],     &bytecode_hash,             sizeof(uint64));
+			contents += bytecode;
+			FileUtils::writeEntireFileAtomically(cachefile_path, contents.data(), contents.size());
+		}
+		catch(FileUtils::FileUtilsExcep& e)
+		{
+			conPrint("Warning: failed to write Lua bytecode cache file: " + e.what());
+		}
+	}
+
+	return bytecode;
+}
+
+
+void LuaBytecodeCache::clearMemCache()
+{
+	Lock lock(mutex);
+	mem_cache.clear();
+}
+
+
+size_t LuaBytecodeCache::numMemCacheEntries()
+{
+	Lock lock(mutex);
+	return mem_cache.size();
+}
+
+
 std::string LuaScriptExcepWithLocation::messageWithLocations()
 {
 	std::string msg;// = what();
@@ -7,14 +7,20 @@ Copyright Glare Technologies Limited 2024 -
 
 
 #include <utils/Exception.h>
+#include <utils/ThreadSafeRefCounted.h>
+#include <utils/Reference.h>
+#include <utils/Mutex.h>
 #include <Luau/Location.h>
 #include <string>
 #include <vector>
+#include <map>
 #include <limits>
 class LuaVM;
 class LuaScript;
+class LuaBytecodeCache;
 struct lua_State;
 typedef int (*lua_CFunction)(lua_State* L);
+namespace Luau { struct CompileOptions; }
 
 
 struct LuaCFunction
@@ -38,7 +44,7 @@ public:
 
 struct LuaScriptOptions
 {
-	LuaScriptOptions() : max_num_interrupts(std::numeric_limits<size_t>::max()), script_output_handler(NULL), userdata(NULL) {}
+	LuaScriptOptions() : max_num_interrupts(std::numeric_limits<size_t>::max()), script_output_handler(NULL), userdata(NULL), bytecode_cache(NULL) {}
 
 	size_t max_num_interrupts;
 
@@ -47,6 +53,8 @@ struct LuaScriptOptions
 	LuaScriptOutputHandler* script_output_handler;
 	
 	void* userdata;
+
+	LuaBytecodeCache* bytecode_cache; // If non-NULL, compiled bytecode is looked up in and added to this cache.
 };
 
 
@@ -71,6 +79,42 @@ public:
 };
 
 
+/*=====================================================================
+LuaBytecodeCache
+----------------
+Caches compiled Luau bytecode in memory, and optionally on disk, keyed by 
+a hash of the script source and compile options.
+The same script is often used by many objects, so with a shared cache 
+each unique script only needs to be compiled once.
+
+Threadsafe.
+=====================================================================*/
+class LuaBytecodeCache : public ThreadSafeRefCounted
+{
+public:
+	LuaBytecodeCache(); // In-memory caching only.
+	LuaBytecodeCache(const std::string& disk_cache_dir); // Bytecode is also persisted to files in disk_cache_dir.  Throws glare::Exception if the dir could not be created.
+
+	// Returns the bytecode for script_src compiled with compile_options, compiling it if it is not in the cache.
+	// Throws Luau::ParseErrors or Luau::ParseError if compilation fails.  Failed compilations are not cached.
+	std::string getOrCompileBytecode(const std::string& script_src, const Luau::CompileOptions& compile_options);
+
+	void clearMemCache();
+
+	size_t numMemCacheEntries();
+
+	Mutex mutex;
+	uint64 num_mem_hits				GUARDED_BY(mutex);
+	uint64 num_disk_hits			GUARDED_BY(mutex);
+	uint64 num_misses				GUARDED_BY(mutex);
+private:
+	std::string disk_cache_dir; // Empty if bytecode is not persisted to disk.
+	std::map<uint64, std::string> mem_cache	GUARDED_BY(mutex); // Map from key to bytecode.
+};
+
+typedef Reference<LuaBytecodeCache> LuaBytecodeCacheRef;
+
+
 /*=====================================================================
 LuaScript
 ---------
@@ -8,6 +8,10 @@ Copyright Glare Technologies Limited 2024 -
 
 #include <utils/Exception.h>
 #include <utils/StringUtils.h>
+#include <utils/RefCounted.h>
+#include <utils/Vector.h>
+#include <cmath>
+#include <cstring>
 #include <lualib.h>
 
 
@@ -75,6 +79,25 @@ static void serialiseVector(lua_State* state, int stack_index, const LuaSerialis
 }
 
 
+// Returns the UID of the metatable of the table at the given stack index, or std::numeric_limits<uint32>::max() if the table has no metatable.
+static uint32 getMetatableUID(lua_State* state, int table_stack_index)
+{
+	const int have_metatable = lua_getmetatable(state, table_stack_index); // Pushes onto stack if there.
+	if(have_metatable)
+	{
+		const int uid_type = lua_rawgetfield(state, /*index=*/-1, "uid"); // Get metatable uid
+		if(uid_type != LUA_TNUMBER)
+			throw glare::Exception("metatable uid was not a number");
+
+		const double uid_val = lua_tonumber(state, -1);
+		lua_pop(state, 2); // pop UID and metatable off stack
+		return (uint32)uid_val;
+	}
+	else
+		return std::numeric_limits<uint32>::max();
+}
+
+
 static void serialiseTable(lua_State* state, int table_stack_index, int depth, const LuaSerialisation::SerialisationOptions& options, BufferOutStream& serialised)
 {
 	if(serialised.getWriteIndex() + sizeof(uint8) + sizeof(uint32) * 2 > options.max_serialised_size_B)
@@ -85,23 +108,7 @@ static void serialiseTable(lua_State* state, int table_stack_index, int depth, c
 	table_stack_index = lua_absindex(state, table_stack_index); // Convert to positive index so index is still valid after pushing stuff onto stack.
 
 	// Write metatable UID as uint32, or std::numeric_limits<uint32>::max() if no metatable.
-	const int have_metatable = lua_getmetatable(state, table_stack_index); // Pushes onto stack if there.
-	if(have_metatable)
-	{
-		const int uid_type = lua_rawgetfield(state, /*index=*/-1, "uid"); // Get metatable uid
-		if(uid_type == LUA_TNUMBER)
-		{
-			const double uid_val = lua_tonumber(state, -1);
-			serialised.writeUInt32((uint32)uid_val); // Write metatable UID
-			lua_pop(state, 1); // pop UID
-		}
-		else
-			throw glare::Exception("metatable uid was not a number");
-
-		lua_pop(state, 1); // pop metatable off stack
-	}
-	else
-		serialised.writeUInt32(std::numeric_limits<uint32>::max()); // Write 'no-metatable' metatable UID.
+	serialised.writeUInt32(getMetatableUID(state, table_stack_index));
 
 
 	if(!lua_checkstack(state, /*size=*/2)) // Make sure there is space for a key-value pair
@@ -233,19 +240,24 @@ static void deserialiseNil(lua_State* state, BufferViewInStream& serialised)
 }
 
 
+// Returns the reference to the metatable with the given UID, or -1 if metatable_uid is std::numeric_limits<uint32>::max() (no metatable).
+static int getMetatableRef(HashMap<uint32, int>& metatable_uid_to_ref_map, uint32 metatable_uid)
+{
+	if(metatable_uid == std::numeric_limits<uint32>::max())
+		return -1;
+
+	auto res = metatable_uid_to_ref_map.find(metatable_uid);
+	if(res == metatable_uid_to_ref_map.end())
+		throw glare::Exception("Did not find info for metatable with uid " + toString(metatable_uid) + " in metatable_uid_to_ref_map.");
+
+	return res->second;
+}
+
+
 static void deserialiseTable(lua_State* state, HashMap<uint32, int>& metatable_uid_to_ref_map, BufferViewInStream& serialised)
 {
 	const uint32 metatable_uid = serialised.readUInt32();
-	int metatable_ref = -1;
-	if(metatable_uid != std::numeric_limits<uint32>::max())
-	{
-		// Table had a metatable
-		auto res = metatable_uid_to_ref_map.find(metatable_uid);
-		if(res == metatable_uid_to_ref_map.end())
-			throw glare::Exception("Did not find info for metatable with uid " + toString(metatable_uid) + " in metatable_uid_to_ref_map.");
-
-		metatable_ref = res->second;
-	}
+	const int metatable_ref = getMetatableRef(metatable_uid_to_ref_map, metatable_uid);
 
 	// Read number of elements
 	const uint32 num_elems = serialised.readUInt32();
@@ -326,6 +338,448 @@ void LuaSerialisation::deserialise(lua_State* state, HashMap<uint32, int>& metat
 }
 
 
+//========================== Delta serialisation ==========================
+
+// Delta format:
+// uint32 version
+// uint8 reset: if non-zero, the receiver should clear its table and field id dictionary before applying the delta.
+// uint32 root table metatable UID
+// table delta
+//
+// Table delta:
+// uint32 num ops
+// For each op:
+//    uint8 op
+//    varuint field id.  If this is the next unused field id, it is followed by the serialised key.
+//    DELTA_OP_SET_VALUE:    serialised value
+//    DELTA_OP_NEW_TABLE:    uint32 metatable UID, table delta (applied to a new empty table)
+//    DELTA_OP_UPDATE_TABLE: table delta (applied to the existing table value)
+//    DELTA_OP_REMOVE:       nothing
+
+static const uint32 DELTA_FORMAT_VERSION = 1;
+
+static const uint8 DELTA_OP_SET_VALUE		= 0;
+static const uint8 DELTA_OP_NEW_TABLE		= 1;
+static const uint8 DELTA_OP_UPDATE_TABLE	= 2;
+static const uint8 DELTA_OP_REMOVE			= 3;
+
+static const uint32 DEFAULT_MAX_NUM_DELTA_FIELD_IDS = 65536;
+
+
+// Thrown when a new field id is needed but the field id dictionary is full.
+struct DeltaFieldIdLimitReached {};
+
+
+struct LuaSerialisation::DeltaTableSnapshot : public RefCounted
+{
+	struct FieldSnapshot
+	{
+		FieldSnapshot() : last_seen_pass(0) {}
+
+		std::string value; // Serialised value, if the value is not a table.
+		Reference<DeltaTableSnapshot> table; // Snapshot of the value, if the value is a table.
+		uint32 last_seen_pass;
+	};
+
+	DeltaTableSnapshot(uint32 metatable_uid_) : metatable_uid(metatable_uid_), fields(/*empty key=*/std::numeric_limits<uint32>::max()) {}
+
+	uint32 metatable_uid;
+	HashMap<uint32, FieldSnapshot> fields; // Map from field id to snapshot of field value.
+};
+
+
+LuaSerialisation::DeltaSerialisationState::DeltaSerialisationState()
+:	field_ids(/*empty key=*/std::string()), // Serialised keys always contain at least the type byte, so are never empty.
+	max_num_field_ids(DEFAULT_MAX_NUM_DELTA_FIELD_IDS),
+	pass(0)
+{}
+
+
+LuaSerialisation::DeltaSerialisationState::~DeltaSerialisationState()
+{}
+
+
+void LuaSerialisation::DeltaSerialisationState::reset()
+{
+	root = NULL;
+	field_ids.clear();
+}
+
+
+static inline void writeVarUInt32(BufferOutStream& serialised, uint32 x)
+{
+	while(x >= 128)
+	{
+		serialised.writeUInt8((uint8)(x | 128));
+		x >>= 7;
+	}
+	serialised.writeUInt8((uint8)x);
+}
+
+
+static inline uint32 readVarUInt32(BufferViewInStream& serialised)
+{
+	uint32 x = 0;
+	for(int shift=0; shift<32; shift += 7)
+	{
+		const uint8 b = serialised.readUInt8();
+		x |= (uint32)(b & 127) << shift;
+		if((b & 128) == 0)
+			return x;
+	}
+	throw glare::Exception("Error while deserialising Lua delta: invalid field id");
+}
+
+
+static inline bool isValidDeltaKeyType(int t)
+{
+	return t == LUA_TSTRING || t == LUA_TNUMBER || t == LUA_TBOOLEAN || t == LUA_TVECTOR;
+}
+
+
+static inline void writeFieldOp(BufferOutStream& serialised, uint8 op, uint32 field_id, bool new_field_id, const std::string& key)
+{
+	serialised.writeUInt8(op);
+	writeVarUInt32(serialised, field_id);
+	if(new_field_id)
+		serialised.writeData(key.data(), key.size());
+}
+
+
+static inline void checkSerialisedSize(const BufferOutStream& serialised, const LuaSerialisation::SerialisationOptions& options)
+{
+	if(serialised.getWriteIndex() > options.max_serialised_size_B)
+		throw glare::Exception("Serialised data exceeded max_serialised_size_B");
+}
+
+
+// Writes the ops needed to bring the receiver's copy of the table, which matches 'snapshot', up to date with the table at table_stack_index.
+// Updates snapshot to match the table.
+// Returns the number of ops written.
+static uint32 serialiseTableDelta(lua_State* state, int table_stack_index, int depth, const LuaSerialisation::SerialisationOptions& options, LuaSerialisation::DeltaSerialisationState& delta_state, 
+	LuaSerialisation::DeltaTableSnapshot& snapshot, BufferOutStream& serialised)
+{
+	if(depth > options.max_depth)
+		throw glare::Exception("Call depth exceeded while serialising Lua value.");
+
+	table_stack_index = lua_absindex(state, table_stack_index); // Convert to positive index so index is still valid after pushing stuff onto stack.
+
+	if(!lua_checkstack(state, /*size=*/2)) // Make sure there is space for a key-value pair
+		throw glare::Exception("Failed to alloc lua stack space");
+
+	// Write a placeholder for the number of ops, which will be filled in when we are done.
+	const size_t num_ops_pos = serialised.getWriteIndex();
+	serialised.writeUInt32(0);
+	uint32 num_ops = 0;
+
+	const uint32 pass = delta_state.pass;
+	const size_t initial_num_fields = snapshot.fields.size();
+	size_t num_existing_fields_seen = 0;
+	BufferOutStream& scratch = delta_state.scratch;
+
+	lua_pushnil(state); // Push first key onto stack
+	while(1)
+	{
+		int notdone = lua_next(state, table_stack_index); // pops a key from the stack, and pushes a key-value pair from the table at the given index
+		if(notdone == 0)
+			break;
+
+		// Key is at -2, value is at -1
+		if(!isValidDeltaKeyType(lua_type(state, -2)))
+			throw glare::Exception("Can't delta serialise table key of type " + std::string(lua_typename(state, lua_type(state, -2))));
+
+		// Look up field id for the key, assigning a new one if this key hasn't been seen before.
+		scratch.clear();
+		serialiseValue(state, -2, depth + 1, options, scratch);
+		const std::string key((const char*)scratch.buf.data(), scratch.buf.size());
+
+		uint32 field_id;
+		bool new_field_id = false;
+		auto id_res = delta_state.field_ids.find(key);
+		if(id_res == delta_state.field_ids.end())
+		{
+			if(delta_state.field_ids.size() >= delta_state.max_num_field_ids)
+				throw DeltaFieldIdLimitReached();
+
+			field_id = (uint32)delta_state.field_ids.size();
+			delta_state.field_ids.insert(std::make_pair(key, field_id));
+			new_field_id = true;
+		}
+		else
+			field_id = id_res->second;
+
+		auto field_res = snapshot.fields.find(field_id);
+		if(field_res != snapshot.fields.end())
+			num_existing_fields_seen++;
+		else
+			field_res = snapshot.fields.insert(std::make_pair(field_id, LuaSerialisation::DeltaTableSnapshot::FieldSnapshot())).first;
+
+		LuaSerialisation::DeltaTableSnapshot::FieldSnapshot& field = field_res->second;
+		field.last_seen_pass = pass;
+
+		if(lua_type(state, -1) == LUA_TTABLE)
+		{
+			const uint32 metatable_uid = getMetatableUID(state, -1);
+			if(field.table.nonNull() && field.table->metatable_uid == metatable_uid)
+			{
+				// Value was a table with the same metatable in the snapshot, write a delta for it, if anything changed.
+				const size_t op_pos = serialised.getWriteIndex();
+				writeFieldOp(serialised, DELTA_OP_UPDATE_TABLE, field_id, new_field_id, key);
+				if(serialiseTableDelta(state, -1, depth + 1, options, delta_state, *field.table, serialised) == 0)
+					serialised.buf.resize(op_pos); // Nothing changed, remove the op.
+				else
+					num_ops++;
+			}
+			else
+			{
+				field.value.clear();
+				field.table = new LuaSerialisation::DeltaTableSnapshot(metatable_uid);
+
+				writeFieldOp(serialised, DELTA_OP_NEW_TABLE, field_id, new_field_id, key);
+				serialised.writeUInt32(metatable_uid);
+				serialiseTableDelta(state, -1, depth + 1, options, delta_state, *field.table, serialised);
+				num_ops++;
+			}
+		}
+		else
+		{
+			scratch.clear();
+			serialiseValue(state, -1, depth + 1, options, scratch);
+
+			if(field.table.nonNull() || field.value.size() != scratch.buf.size() || std::memcmp(field.value.data(), scratch.buf.data(), scratch.buf.size()) != 0)
+			{
+				field.table = NULL;
+				field.value.assign((const char*)scratch.buf.data(), scratch.buf.size());
+
+				writeFieldOp(serialised, DELTA_OP_SET_VALUE, field_id, new_field_id, key);
+				serialised.writeData(scratch.buf.data(), scratch.buf.size());
+				num_ops++;
+			}
+		}
+
+		checkSerialisedSize(serialised, options);
+
+		lua_pop(state, 1); // Remove value, keep key on stack for next lua_next call
+	}
+
+	// If we didn't see all the fields from the snapshot, some have been removed from the table.
+	if(num_existing_fields_seen != initial_num_fields)
+	{
+		js::Vector<uint32, 16> removed_field_ids;
+		for(auto it = snapshot.fields.begin(); it != snapshot.fields.end(); ++it)
+			if(it->second.last_seen_pass != pass)
+				removed_field_ids.push_back(it->first);
+
+		for(size_t i=0; i<removed_field_ids.size(); ++i)
+		{
+			writeFieldOp(serialised, DELTA_OP_REMOVE, removed_field_ids[i], /*new_field_id=*/false, std::string());
+			snapshot.fields.erase(removed_field_ids[i]);
+			num_ops++;
+		}
+
+		checkSerialisedSize(serialised, options);
+	}
+
+	std::memcpy(serialised.buf.data() + num_ops_pos, &num_ops, sizeof(uint32));
+	return num_ops;
+}
+
+
+static void writeDelta(lua_State* state, int stack_index, const LuaSerialisation::SerialisationOptions& options, LuaSerialisation::DeltaSerialisationState& delta_state, bool force_reset, BufferOutStream& serialised)
+{
+	serialised.clear();
+	serialised.writeUInt32(DELTA_FORMAT_VERSION);
+
+	const uint32 metatable_uid = getMetatableUID(state, stack_index);
+
+	// Start from an empty snapshot if we don't have one yet, or if the metatable changed (the receiver only sets the metatable on reset).
+	const bool reset = force_reset || delta_state.root.isNull() || (delta_state.root->metatable_uid != metatable_uid);
+	if(reset)
+	{
+		delta_state.reset();
+		delta_state.root = new LuaSerialisation::DeltaTableSnapshot(metatable_uid);
+	}
+	delta_state.pass++;
+
+	serialised.writeUInt8(reset ? 1 : 0);
+	serialised.writeUInt32(metatable_uid);
+
+	serialiseTableDelta(state, stack_index, /*depth=*/0, options, delta_state, *delta_state.root, serialised);
+}
+
+
+void LuaSerialisation::serialiseDelta(lua_State* state, int stack_index, const SerialisationOptions& options, DeltaSerialisationState& delta_state, BufferOutStream& serialised)
+{
+	serialised.clear();
+
+	if(lua_type(state, stack_index) != LUA_TTABLE)
+		throw glare::Exception("Can only delta serialise tables");
+
+	stack_index = lua_absindex(state, stack_index);
+	const int initial_stack_top = lua_gettop(state);
+
+	try
+	{
+		try
+		{
+			writeDelta(state, stack_index, options, delta_state, /*force_reset=*/false, serialised);
+		}
+		catch(DeltaFieldIdLimitReached&)
+		{
+			// The field id dictionary is full, with ids for keys that may no longer be used.  Write a reset instead, which clears the dictionaries
+			// on both ends, so only keys currently in the table get ids.
+			lua_settop(state, initial_stack_top);
+			writeDelta(state, stack_index, options, delta_state, /*force_reset=*/true, serialised);
+		}
+	}
+	catch(DeltaFieldIdLimitReached&)
+	{
+		delta_state.reset();
+		throw glare::Exception("Table has more than max_num_field_ids distinct keys, so can't be delta serialised");
+	}
+	catch(glare::Exception&)
+	{
+		// The snapshot may have been partially updated, so no longer matches what the receiver has.
+		delta_state.reset();
+		throw;
+	}
+}
+
+
+LuaSerialisation::DeltaDeserialisationState::DeltaDeserialisationState()
+:	max_num_field_ids(DEFAULT_MAX_NUM_DELTA_FIELD_IDS)
+{}
+
+
+// Pushes the key for the field id read from the stream onto the top of the Lua stack.
+static void deserialiseDeltaFieldKey(lua_State* state, HashMap<uint32, int>& metatable_uid_to_ref_map, LuaSerialisation::DeltaDeserialisationState& delta_state, BufferViewInStream& serialised)
+{
+	const uint32 field_id = readVarUInt32(serialised);
+	if(field_id == delta_state.field_keys.size())
+	{
+		// This is a new field id, the serialised key follows.
+		if(delta_state.field_keys.size() >= delta_state.max_num_field_ids)
+			throw glare::Exception("Error while deserialising Lua delta: too many field ids");
+
+		const char* key_data = (const char*)serialised.currentReadPtr();
+		const size_t key_start = serialised.getReadIndex();
+
+		deserialiseValue(state, metatable_uid_to_ref_map, serialised); // Push key onto stack
+
+		delta_state.field_keys.push_back(std::string(key_data, serialised.getReadIndex() - key_start));
+	}
+	else if(field_id < delta_state.field_keys.size())
+	{
+		const std::string& key = delta_state.field_keys[field_id];
+		BufferViewInStream key_stream(ArrayRef<uint8>((const uint8*)key.data(), key.size()));
+		deserialiseValue(state, metatable_uid_to_ref_map, key_stream); // Push key onto stack
+	}
+	else
+		throw glare::Exception("Error while deserialising Lua delta: invalid field id " + toString(field_id));
+
+	const int key_type = lua_type(state, -1);
+	if(!isValidDeltaKeyType(key_type) || ((key_type == LUA_TNUMBER) && std::isnan(lua_tonumber(state, -1))))
+		throw glare::Exception("Error while deserialising Lua delta: invalid key");
+}
+
+
+static void applyTableDelta(lua_State* state, int table_stack_index, HashMap<uint32, int>& metatable_uid_to_ref_map, LuaSerialisation::DeltaDeserialisationState& delta_state, BufferViewInStream& serialised)
+{
+	table_stack_index = lua_absindex(state, table_stack_index); // Convert to positive index so index is still valid after pushing stuff onto stack.
+
+	if(!lua_checkstack(state, /*size=*/3)) // Make sure there is space for the key, value and metatable
+		throw glare::Exception("Failed to alloc lua stack space");
+
+	const uint32 num_ops = serialised.readUInt32();
+	for(uint32 i=0; i<num_ops; ++i)
+	{
+		const uint8 op = serialised.readUInt8();
+
+		deserialiseDeltaFieldKey(state, metatable_uid_to_ref_map, delta_state, serialised); // Push key onto stack
+
+		switch(op)
+		{
+			case DELTA_OP_SET_VALUE:
+			{
+				deserialiseValue(state, metatable_uid_to_ref_map, serialised); // Push value onto stack
+				lua_rawset(state, table_stack_index); // pops both the key and the value from the stack
+				break;
+			}
+			case DELTA_OP_NEW_TABLE:
+			{
+				const uint32 metatable_uid = serialised.readUInt32();
+				const int metatable_ref = getMetatableRef(metatable_uid_to_ref_map, metatable_uid);
+
+				lua_createtable(state, /*num array elems hint=*/0, /*num other elems hint=*/0);
+				applyTableDelta(state, /*table index=*/-1, metatable_uid_to_ref_map, delta_state, serialised);
+
+				if(metatable_uid != std::numeric_limits<uint32>::max())
+				{
+					lua_getref(state, metatable_ref); // Pushes metatable onto the stack.
+					lua_setmetatable(state, -2); // Pops metatable and sets it as the metatable of the new table.
+				}
+
+				lua_rawset(state, table_stack_index); // pops both the key and the new table from the stack
+				break;
+			}
+			case DELTA_OP_UPDATE_TABLE:
+			{
+				lua_pushvalue(state, -1); // Push copy of key
+				lua_rawget(state, table_stack_index); // Pops key copy, pushes existing value
+				if(lua_type(state, -1) != LUA_TTABLE)
+					throw glare::Exception("Error while deserialising Lua delta: field to update was not a table");
+
+				applyTableDelta(state, /*table index=*/-1, metatable_uid_to_ref_map, delta_state, serialised);
+
+				lua_pop(state, 2); // Pop existing value and key
+				break;
+			}
+			case DELTA_OP_REMOVE:
+			{
+				lua_pushnil(state);
+				lua_rawset(state, table_stack_index); // pops both the key and the nil from the stack
+				break;
+			}
+			default:
+				throw glare::Exception("Error while deserialising Lua delta, invalid op " + toString(op));
+		}
+	}
+}
+
+
+void LuaSerialisation::deserialiseDelta(lua_State* state, int stack_index, HashMap<uint32, int>& metatable_uid_to_ref_map, DeltaDeserialisationState& delta_state, BufferViewInStream& serialised)
+{
+	stack_index = lua_absindex(state, stack_index);
+	if(lua_type(state, stack_index) != LUA_TTABLE)
+		throw glare::Exception("Can only apply Lua delta to a table");
+
+	const uint32 version = serialised.readUInt32();
+	if(version != DELTA_FORMAT_VERSION)
+		throw glare::Exception("Error while deserialising Lua delta: invalid version " + toString(version));
+
+	const uint8 reset = serialised.readUInt8();
+	const uint32 metatable_uid = serialised.readUInt32();
+	const int metatable_ref = getMetatableRef(metatable_uid_to_ref_map, metatable_uid);
+
+	if(reset)
+	{
+		delta_state.field_keys.clear();
+		lua_cleartable(state, stack_index);
+
+		if(!lua_checkstack(state, /*size=*/1))
+			throw glare::Exception("Failed to alloc lua stack space");
+
+		if(metatable_uid != std::numeric_limits<uint32>::max())
+			lua_getref(state, metatable_ref); // Pushes metatable onto the stack.
+		else
+			lua_pushnil(state); // Setting a nil metatable removes any existing metatable.
+		lua_setmetatable(state, stack_index);
+	}
+
+	applyTableDelta(state, stack_index, metatable_uid_to_ref_map, delta_state, serialised);
+}
+
+
 #if BUILD_TESTS
 
 
@@ -334,6 +788,7 @@ void LuaSerialisation::deserialise(lua_State* state, HashMap<uint32, int>& metat
 #include "LuaUtils.h"
 #include "../utils/TestUtils.h"
 #include "../utils/TestExceptionUtils.h"
+#include "../utils/Timer.h"
 
 
 //========================== Fuzzing ==========================
@@ -399,6 +854,48 @@ public:
 };
 
 
+// Returns true if the two values are equal, comparing tables recursively.
+static bool luaValuesEqual(lua_State* state, int a_index, int b_index, int depth)
+{
+	a_index = lua_absindex(state, a_index);
+	b_index = lua_absindex(state, b_index);
+
+	if(lua_type(state, a_index) != lua_type(state, b_index))
+		return false;
+	if(lua_type(state, a_index) != LUA_TTABLE)
+		return lua_rawequal(state, a_index, b_index) != 0;
+	if(depth > 16 || (getMetatableUID(state, a_index) != getMetatableUID(state, b_index)))
+		return false;
+
+	// Check each field of a has an equal field in b
+	size_t num_a_elems = 0;
+	lua_pushnil(state); // Push first key onto stack
+	while(lua_next(state, a_index))
+	{
+		num_a_elems++;
+		lua_pushvalue(state, -2); // Push copy of key
+		lua_rawget(state, b_index); // Pops key copy, pushes b value
+		const bool equal = luaValuesEqual(state, -2, -1, depth + 1);
+		lua_pop(state, 2); // Pop b value and a value
+		if(!equal)
+		{
+			lua_pop(state, 1); // Pop key
+			return false;
+		}
+	}
+
+	size_t num_b_elems = 0;
+	lua_pushnil(state); // Push first key onto stack
+	while(lua_next(state, b_index))
+	{
+		num_b_elems++;
+		lua_pop(state, 1);
+	}
+
+	return num_a_elems == num_b_elems;
+}
+
+
 void LuaSerialisation::test()
 {
 	conPrint("LuaSerialisation::test()");
@@ -809,6 +1306,269 @@ void LuaSerialisation::test()
 		failTest(e.what());
 	}
 
+	// Test delta serialisation
+	try
+	{
+		LuaVM vm;
+		const std::string src =
+			"t = { x = 1.0, s = 'abc', v = Vec3f(1, 2, 3), m = {10, 11, 12}, sub = { a = 1, b = { c = 2 } } }  \n"
+			"function change1() t.x = 2.0   t.sub.b.c = 3  end  \n"
+			"function change2() t.s = nil   t.m = 5   t.new_field = { d = 'e', sub = { f = true } }  end  \n"
+			"function change3() t.m = { 1, 2 }   t.sub = Vec3d(1, 2, 3)   t.new_field.sub.f = nil  end  \n"
+			"function change4() t.v = { [Vec3f(1, 2, 3)] = 1, [true] = 2, [3] = 3 }  end  \n"
+			"counter = 0  \n"
+			"function change5() counter = counter + 1   t['key_' .. counter] = counter   t['key_' .. (counter - 1)] = nil  end  \n"
+			"function change6() for i=1, 40 do t['many_' .. i] = i end  end  \n"
+			"bad = { [{}] = 1 }  \n";
+		LuaScript script(&vm, LuaScriptOptions(), src);
+		script.exec();
+
+		lua_State* const state = script.thread_state;
+
+		lua_createtable(state, 0, 0); // Create table to apply the deltas to
+		const int receiver_index = lua_gettop(state);
+
+		DeltaSerialisationState delta_state;
+		DeltaDeserialisationState deserialisation_state;
+		HashMap<uint32, int> metatable_uid_to_ref_map(/*empty key=*/std::numeric_limits<uint32>::max());
+		metatable_uid_to_ref_map[1] = vm.Vec3dMetaTable_ref;
+		BufferOutStream serialised;
+
+		// Serialises a delta of t, applies it to the receiver table, and checks the receiver table now equals t.  Returns the delta size.
+		auto sendDelta = [&]() -> size_t
+		{
+			lua_getglobal(state, "t"); // push onto stack
+			serialiseDelta(state, /*stack index=*/-1, SerialisationOptions(), delta_state, serialised);
+			testAssert(lua_gettop(state) == receiver_index + 1); // Check stack has been returned to initial size
+			lua_pop(state, 1);
+
+			BufferViewInStream instream(ArrayRef<uint8>(serialised.buf.data(), serialised.buf.size()));
+			deserialiseDelta(state, receiver_index, metatable_uid_to_ref_map, deserialisation_state, instream);
+			testAssert(instream.endOfStream());
+			testAssert(lua_gettop(state) == receiver_index); // Check stack has been returned to initial size
+
+			lua_getglobal(state, "t"); // push onto stack
+			testAssert(luaValuesEqual(state, -1, receiver_index, /*depth=*/0));
+			lua_pop(state, 1);
+			return serialised.buf.size();
+		};
+		auto callFunction = [&](const char* name)
+		{
+			lua_getglobal(state, name); // pushes onto stack
+			lua_call(state, /*nargs=*/0, /*nresults=*/0);
+		};
+
+		const size_t full_size = sendDelta(); // First delta contains the whole table.
+		testAssert(deserialisation_state.field_keys.size() == delta_state.field_ids.size());
+
+		// Nothing has changed, so the delta should just be the header and an empty op list.
+		const size_t unchanged_size = sendDelta();
+		testAssert(unchanged_size == sizeof(uint32) + sizeof(uint8) + sizeof(uint32) + sizeof(uint32));
+
+		// Changes to existing fields should just use field ids, not key strings.
+		callFunction("change1");
+		const size_t change1_size = sendDelta();
+		conPrint("full delta: " + toString(full_size) + " B, unchanged delta: " + toString(unchanged_size) + " B, change1 delta: " + toString(change1_size) + " B");
+		testAssert(change1_size <= unchanged_size + 2 * (1 + 1 + 9) + 2 * (1 + 1 + sizeof(uint32))); // 2 value ops and 2 table update ops, all with 1 byte field ids
+
+		// Test removing fields, replacing a table with a number, and adding a new table
+		callFunction("change2");
+		sendDelta();
+
+		// Test replacing a number with a table, a table with a table with a metatable, and removing a field of a nested table
+		callFunction("change3");
+		sendDelta();
+
+		// Test vector, boolean and number keys
+		callFunction("change4");
+		sendDelta();
+
+		// Test resetting the delta state: the next delta should contain the whole table again.
+		delta_state.reset();
+		testAssert(sendDelta() > unchanged_size);
+		sendDelta();
+
+		// Test that the field id dictionaries stay within max_num_field_ids when new keys keep being added and old ones removed.
+		// When the dictionary is full, a reset delta should be sent, which clears both dictionaries.
+		{
+			delta_state.max_num_field_ids = deserialisation_state.max_num_field_ids = 32;
+			int num_resets = 0;
+			for(int i=0; i<100; ++i)
+			{
+				callFunction("change5");
+				sendDelta();
+				if(serialised.buf[sizeof(uint32)] != 0) // If the reset byte was set:
+					num_resets++;
+				testAssert(delta_state.field_ids.size() <= 32);
+				testAssert(deserialisation_state.field_keys.size() == delta_state.field_ids.size());
+			}
+			testAssert(num_resets >= 3); // About 20 new keys fit between resets.
+
+			// A table with more distinct keys than the limit can't be delta serialised.
+			callFunction("change6");
+			testThrowsExcepContainingString([&]() { sendDelta(); }, "max_num_field_ids");
+			testAssert(delta_state.root.isNull());
+			lua_settop(state, receiver_index); // Restore stack
+
+			// The receiver rejects deltas that would take it over its limit.
+			delta_state.max_num_field_ids = DEFAULT_MAX_NUM_DELTA_FIELD_IDS;
+			deserialisation_state.max_num_field_ids = 32;
+			testThrowsExcepContainingString([&]() { sendDelta(); }, "too many field ids");
+			lua_settop(state, receiver_index); // Restore stack
+
+			deserialisation_state.max_num_field_ids = DEFAULT_MAX_NUM_DELTA_FIELD_IDS;
+			delta_state.reset();
+			sendDelta();
+		}
+
+		// Test that table keys are not supported, and that the delta state is reset when serialisation fails.
+		{
+			lua_getglobal(state, "bad"); // push onto stack
+			const int initial_stack_size = lua_gettop(state);
+
+			DeltaSerialisationState bad_delta_state;
+			testThrowsExcepContainingString([&]() {
+				serialiseDelta(state, /*stack index=*/-1, SerialisationOptions(), bad_delta_state, serialised);
+			}, "key");
+			testAssert(bad_delta_state.root.isNull());
+
+			lua_settop(state, initial_stack_size); // Restore stack
+			lua_pop(state, 1);
+		}
+
+		// Test that serialising a non-table fails
+		testThrowsExcepContainingString([&]() {
+			lua_pushnumber(state, 1.0);
+			serialiseDelta(state, /*stack index=*/-1, SerialisationOptions(), delta_state, serialised);
+		}, "table");
+		lua_settop(state, receiver_index); // Restore stack
+
+		// Test applying a delta with an invalid field id
+		{
+			BufferOutStream bad;
+			bad.writeUInt32(DELTA_FORMAT_VERSION);
+			bad.writeUInt8(0); // reset
+			bad.writeUInt32(std::numeric_limits<uint32>::max()); // metatable UID
+			bad.writeUInt32(1); // num ops
+			bad.writeUInt8(DELTA_OP_REMOVE);
+			bad.writeUInt8(100); // field id
+
+			testThrowsExcepContainingString([&]() {
+				DeltaDeserialisationState bad_deserialisation_state;
+				BufferViewInStream instream(ArrayRef<uint8>(bad.buf.data(), bad.buf.size()));
+				deserialiseDelta(state, receiver_index, metatable_uid_to_ref_map, bad_deserialisation_state, instream);
+			}, "field id");
+			lua_settop(state, receiver_index); // Restore stack
+		}
+	}
+	catch(glare::Exception& e)
+	{
+		failTest(e.what());
+	}
+
+	// Benchmark delta serialisation of a large, mostly unchanged table, compared with full serialisation.
+	try
+	{
+		LuaVM vm;
+		const std::string src =
+			"big = {}  \n"
+			"for i=1, 10000 do big['object_' .. i] = { pos = Vec3f(i, 0, 0), health = 100, name = 'object ' .. i, flags = { visible = true, selected = false } } end  \n"
+			"frame = 0  \n"
+			"function update()  \n"
+			"	frame = frame + 1  \n"
+			"	for i=1, 100 do  \n" // Change 1% of the objects each frame
+			"		local ob = big['object_' .. ((frame * 100 + i) % 10000 + 1)]  \n"
+			"		ob.health = ob.health - 1  \n"
+			"		ob.pos = Vec3f(frame, i, 0)  \n"
+			"	end  \n"
+			"end  \n";
+		LuaScript script(&vm, LuaScriptOptions(), src);
+		script.exec();
+
+		lua_State* const state = script.thread_state;
+
+		lua_createtable(state, 0, 0); // Create table to apply the deltas to
+		const int receiver_index = lua_gettop(state);
+
+		SerialisationOptions options;
+		options.max_serialised_size_B = 100000000;
+		DeltaSerialisationState delta_state;
+		DeltaDeserialisationState deserialisation_state;
+		HashMap<uint32, int> metatable_uid_to_ref_map(/*empty key=*/std::numeric_limits<uint32>::max());
+		BufferOutStream serialised;
+
+		// Send initial full delta
+		lua_getglobal(state, "big"); // push onto stack
+		serialiseDelta(state, /*stack index=*/-1, options, delta_state, serialised);
+		lua_pop(state, 1);
+		{
+			BufferViewInStream instream(ArrayRef<uint8>(serialised.buf.data(), serialised.buf.size()));
+			deserialiseDelta(state, receiver_index, metatable_uid_to_ref_map, deserialisation_state, instream);
+		}
+		const size_t initial_delta_size = serialised.buf.size();
+
+		const int num_frames = 20;
+		double full_serialise_time = 0;
+		double full_deserialise_time = 0;
+		double delta_serialise_time = 0;
+		double delta_deserialise_time = 0;
+		size_t full_size = 0;
+		size_t delta_size = 0;
+		for(int i=0; i<num_frames; ++i)
+		{
+			lua_getglobal(state, "update"); // pushes onto stack
+			lua_call(state, /*nargs=*/0, /*nresults=*/0);
+
+			lua_getglobal(state, "big"); // push onto stack
+
+			// Full serialisation
+			{
+				Timer timer;
+				serialise(state, /*stack index=*/-1, options, serialised);
+				full_serialise_time += timer.elapsed();
+				full_size += serialised.buf.size();
+
+				timer.reset();
+				BufferViewInStream instream(ArrayRef<uint8>(serialised.buf.data(), serialised.buf.size()));
+				deserialise(state, metatable_uid_to_ref_map, instream);
+				full_deserialise_time += timer.elapsed();
+				lua_pop(state, 1); // Pop deserialised table
+			}
+
+			// Delta serialisation
+			{
+				Timer timer;
+				serialiseDelta(state, /*stack index=*/-1, options, delta_state, serialised);
+				delta_serialise_time += timer.elapsed();
+				delta_size += serialised.buf.size();
+
+				timer.reset();
+				BufferViewInStream instream(ArrayRef<uint8>(serialised.buf.data(), serialised.buf.size()));
+				deserialiseDelta(state, receiver_index, metatable_uid_to_ref_map, deserialisation_state, instream);
+				delta_deserialise_time += timer.elapsed();
+				testAssert(instream.endOfStream());
+			}
+
+			lua_pop(state, 1); // Pop big
+		}
+
+		lua_getglobal(state, "big"); // push onto stack
+		testAssert(luaValuesEqual(state, -1, receiver_index, /*depth=*/0));
+		lua_pop(state, 1);
+
+		conPrint("Initial delta size:     " + toString(initial_delta_size) + " B");
+		conPrint("Full serialisation:     " + toString(full_size / num_frames) + " B/frame, serialise: " + doubleToStringNSigFigs(full_serialise_time / num_frames * 1.0e3, 4) + " ms/frame, deserialise: " + 
+			doubleToStringNSigFigs(full_deserialise_time / num_frames * 1.0e3, 4) + " ms/frame");
+		conPrint("Delta serialisation:    " + toString(delta_size / num_frames) + " B/frame, serialise: " + doubleToStringNSigFigs(delta_serialise_time / num_frames * 1.0e3, 4) + " ms/frame, apply: " + 
+			doubleToStringNSigFigs(delta_deserialise_time / num_frames * 1.0e3, 4) + " ms/frame");
+
+		testAssert(delta_size * 10 < full_size);
+	}
+	catch(glare::Exception& e)
+	{
+		failTest(e.what());
+	}
+
 	conPrint("LuaSerialisation::test() done");
 }
 
@@ -10,6 +10,9 @@ Copyright Glare Technologies Limited 2024 -
 #include <utils/BufferInStream.h>
 #include <utils/BufferViewInStream.h>
 #include <utils/HashMap.h>
+#include <utils/Reference.h>
+#include <string>
+#include <vector>
 struct lua_State;
 
 
@@ -34,6 +37,43 @@ public:
 	// metatable_uid_to_ref_map is a map from metatable UID (each metatable will have a UID value stored in it at 'uid'), to metatable reference.
 	// This is used for setting the metatable of deserialised tables.
 	static void deserialise(lua_State* state, HashMap<uint32, int>& metatable_uid_to_ref_map, BufferViewInStream& serialised_data);
+
+
+	// Delta serialisation.
+	// Serialises only the fields of a table that have changed since the previous serialiseDelta() call with the same DeltaSerialisationState.
+	// Table keys are written as small integer field ids.  The key value itself is only written the first time a key is used.
+	// The first delta (or the first delta after reset()) contains the whole table.
+	// The field id dictionaries are limited to max_num_field_ids keys.  If a delta would need more, it is written as a reset instead, which clears the dictionaries.
+	// Only string, number, boolean and vector table keys are supported.
+	struct DeltaTableSnapshot;
+	struct DeltaSerialisationState
+	{
+		DeltaSerialisationState();
+		~DeltaSerialisationState();
+
+		// The next delta will contain the whole table, and will reset the receiver's DeltaDeserialisationState.
+		void reset();
+
+		Reference<DeltaTableSnapshot> root; // Snapshot of the table as of the last serialiseDelta() call.
+		HashMap<std::string, uint32> field_ids; // Map from serialised key to field id.
+		uint32 max_num_field_ids; // Should match the receiver's DeltaDeserialisationState::max_num_field_ids.
+		uint32 pass;
+		BufferOutStream scratch;
+	};
+	// If an exception is thrown, delta_state is reset.
+	static void serialiseDelta(lua_State* state, int stack_index, const SerialisationOptions& options, DeltaSerialisationState& delta_state, BufferOutStream& serialised_out);
+
+	struct DeltaDeserialisationState
+	{
+		DeltaDeserialisationState();
+
+		std::vector<std::string> field_keys; // Serialised key for each field id.
+		uint32 max_num_field_ids; // Deltas that would make field_keys larger than this are rejected.
+	};
+	// Applies a delta written by serialiseDelta() to the table at the given stack index.
+	// Deltas from the same DeltaSerialisationState must be applied in order, to the same table, with the same DeltaDeserialisationState.
+	// Leaves stack in same state as before execution.
+	static void deserialiseDelta(lua_State* state, int stack_index, HashMap<uint32, int>& metatable_uid_to_ref_map, DeltaDeserialisationState& delta_state, BufferViewInStream& serialised_data);
 	
 	static void test();
 };
@@ -14,8 +14,12 @@ Copyright Glare Technologies Limited 2024 -
 #include "../utils/FileUtils.h"
 #include "../utils/PlatformUtils.h"
 #include "../utils/Timer.h"
+#include "../utils/Lock.h"
+#include "../maths/PCG32.h"
+#include <cstring>
 #include <lualib.h>
 #include <luacode.h>
+#include <Luau/Compiler.h>
 
 
 
@@ -245,6 +249,54 @@ public:
 };
 
 
+struct TestMallocAllocator
+{
+	void* alloc(size_t size) { return ::malloc(size); }
+	void free(void* ptr, size_t /*size*/) { ::free(ptr); }
+	void* realloc(void* ptr, size_t /*original_size*/, size_t new_size) { return ::realloc(ptr, new_size); }
+};
+
+
+// Simulates the allocations Luau makes through the allocation callback for table array and hash parts:
+// many live tables, each growing by doubling from 16 B to 512 B, then being freed.
+// Returns elapsed time.
+template <class AllocatorType>
+static double timeTableGrowthAllocPattern(AllocatorType& allocator)
+{
+	const size_t num_live = 1024;
+	std::vector<std::pair<uint8*, size_t>> live(num_live, std::make_pair((uint8*)NULL, (size_t)0));
+
+	Timer timer;
+	for(size_t i=0; i<4000000; ++i)
+	{
+		std::pair<uint8*, size_t>& a = live[(i * 7919) % num_live];
+		if(a.first == NULL)
+		{
+			a.second = 16;
+			a.first = (uint8*)allocator.alloc(a.second);
+		}
+		else if(a.second < 512)
+		{
+			a.first = (uint8*)allocator.realloc(a.first, a.second, a.second * 2);
+			a.second *= 2;
+		}
+		else
+		{
+			allocator.free(a.first, a.second);
+			a.first = NULL;
+			continue;
+		}
+		a.first[a.second - 1] = (uint8)i; // Touch the memory
+	}
+
+	for(size_t i=0; i<num_live; ++i)
+		if(live[i].first)
+			allocator.free(live[i].first, live[i].second);
+
+	return timer.elapsed();
+}
+
+
 void LuaTests::test()
 {
 	conPrint("LuaTests::test()");
@@ -455,6 +507,156 @@ void LuaTests::test()
 			failTest("Failed:" + e.what());
 		}
 
+		//========================== Test LuaSmallBlockAllocator ==========================
+		{
+			LuaSmallBlockAllocator allocator;
+
+			struct TestAllocation
+			{
+				uint8* ptr;
+				size_t size;
+				uint8 val;
+			};
+			std::vector<TestAllocation> allocs;
+			PCG32 rng(1);
+
+			// Checks the allocation still has the value it was filled with.
+			auto checkAllocation = [](const TestAllocation& a, size_t check_size)
+			{
+				for(size_t z=0; z<check_size; ++z)
+					testAssert(a.ptr[z] == a.val);
+			};
+
+			for(int i=0; i<200000; ++i)
+			{
+				const uint32 op = rng.nextUInt(10);
+				const size_t new_size = 1 + rng.nextUInt((rng.nextUInt(10) == 0) ? 4000 : 300); // Mostly small blocks, some large ones.
+
+				if(op < 4 || allocs.empty())
+				{
+					TestAllocation a;
+					a.ptr = (uint8*)allocator.alloc(new_size);
+					a.size = new_size;
+					a.val = (uint8)i;
+					testAssert(a.ptr && ((uint64)a.ptr % LuaSmallBlockAllocator::SIZE_CLASS_GRANULARITY == 0));
+					std::memset(a.ptr, a.val, a.size);
+					allocs.push_back(a);
+				}
+				else if(op < 7)
+				{
+					TestAllocation& a = allocs[rng.nextUInt((uint32)allocs.size())];
+					checkAllocation(a, a.size);
+					a.ptr = (uint8*)allocator.realloc(a.ptr, a.size, new_size);
+					testAssert(a.ptr && ((uint64)a.ptr % LuaSmallBlockAllocator::SIZE_CLASS_GRANULARITY == 0));
+					checkAllocation(a, myMin(a.size, new_size)); // Check contents were preserved
+					a.size = new_size;
+					a.val = (uint8)i;
+					std::memset(a.ptr, a.val, a.size);
+				}
+				else
+				{
+					const size_t index = rng.nextUInt((uint32)allocs.size());
+					checkAllocation(allocs[index], allocs[index].size);
+					allocator.free(allocs[index].ptr, allocs[index].size);
+					allocs[index] = allocs.back();
+					allocs.pop_back();
+				}
+			}
+
+			for(size_t i=0; i<allocs.size(); ++i)
+			{
+				checkAllocation(allocs[i], allocs[i].size);
+				allocator.free(allocs[i].ptr, allocs[i].size);
+			}
+			conPrint("LuaSmallBlockAllocator num slabs: " + toString(allocator.numSlabs()));
+
+			// All slabs should now be empty, and only up to MAX_NUM_EMPTY_SLABS of them kept.
+			testAssert(allocator.numSlabs() == allocator.numEmptySlabs());
+			testAssert(allocator.numSlabs() <= LuaSmallBlockAllocator::MAX_NUM_EMPTY_SLABS);
+		}
+
+		//========================== Test LuaSmallBlockAllocator reuses slabs freed by one size class for another ==========================
+		{
+			LuaSmallBlockAllocator allocator;
+
+			// Makes 2000 blocks in each size class in turn, freeing the previous ones.  The live memory never needs more than 
+			// the slabs for one size class, and memory freed from one size class should be reused for the next.
+			const size_t num_blocks = 2000;
+			const size_t max_slabs_per_class = Maths::roundedUpDivide(num_blocks * LuaSmallBlockAllocator::MAX_SMALL_BLOCK_SIZE, LuaSmallBlockAllocator::SLAB_SIZE - 64) + 1; // Allowing 64 B for the slab header.
+			std::vector<void*> blocks(num_blocks);
+			size_t max_num_slabs = 0;
+			for(size_t size_class=0; size_class<LuaSmallBlockAllocator::NUM_SIZE_CLASSES; ++size_class)
+			{
+				const size_t size = LuaSmallBlockAllocator::blockSizeForSizeClass(size_class);
+				for(size_t i=0; i<num_blocks; ++i)
+				{
+					blocks[i] = allocator.alloc(size);
+					testAssert(blocks[i] != NULL);
+					std::memset(blocks[i], (int)i, size);
+				}
+				max_num_slabs = myMax(max_num_slabs, allocator.numSlabs());
+
+				for(size_t i=0; i<num_blocks; ++i)
+				{
+					testAssert(((uint8*)blocks[i])[size - 1] == (uint8)i);
+					allocator.free(blocks[i], size);
+				}
+			}
+			conPrint("LuaSmallBlockAllocator max num slabs with size class churn: " + toString(max_num_slabs));
+			testAssert(max_num_slabs <= max_slabs_per_class + LuaSmallBlockAllocator::MAX_NUM_EMPTY_SLABS);
+			testAssert(allocator.numSlabs() <= LuaSmallBlockAllocator::MAX_NUM_EMPTY_SLABS);
+		}
+
+		//========================== Benchmark LuaSmallBlockAllocator against malloc on a Luau-like allocation pattern ==========================
+		{
+			TestMallocAllocator malloc_allocator;
+			LuaSmallBlockAllocator small_block_allocator;
+			const double malloc_time      = timeTableGrowthAllocPattern(malloc_allocator);
+			const double small_block_time = timeTableGrowthAllocPattern(small_block_allocator);
+			conPrint("Table growth alloc pattern: malloc: " + doubleToStringNSigFigs(malloc_time * 1.0e3, 4) + " ms, LuaSmallBlockAllocator: " + 
+				doubleToStringNSigFigs(small_block_time * 1.0e3, 4) + " ms (" + doubleToStringNSigFigs(malloc_time / small_block_time, 3) + "x)");
+		}
+
+		//========================== Test small block allocator accounting matches malloc accounting, and compare script run times ==========================
+		try
+		{
+			// Creates lots of small tables and strings, so is mostly GC and allocation work.
+			const std::string src = 
+				"local t = {}  \n"
+				"for i=1, 300000 do  \n"
+				"	local a = { i, i + 1, x = i, s = 'str' .. i }  \n"
+				"	a[3] = i  \n"
+				"	t[(i % 1000) + 1] = a  \n"
+				"end  \n";
+
+			double times[2];
+			int64 total_allocated[2];
+			int64 high_water_mark[2];
+			for(int i=0; i<2; ++i)
+			{
+				LuaVM vm(/*use_small_block_allocator=*/i == 1);
+				vm.max_total_mem_allowed = 64 * 1024 * 1024;
+
+				Timer timer;
+				LuaScript script(&vm, LuaScriptOptions(), src);
+				script.exec();
+				times[i] = timer.elapsed();
+
+				total_allocated[i] = vm.total_allocated;
+				high_water_mark[i] = vm.total_allocated_high_water_mark;
+			}
+
+			conPrint("Table churn script: malloc: " + doubleToStringNSigFigs(times[0] * 1.0e3, 4) + " ms, LuaSmallBlockAllocator: " + doubleToStringNSigFigs(times[1] * 1.0e3, 4) + " ms");
+
+			// The allocation sequence doesn't depend on the allocator (the script doesn't use pointers as table keys), so the accounting should be identical.
+			testAssert(total_allocated[0] == total_allocated[1]);
+			testAssert(high_water_mark[0] == high_water_mark[1]);
+		}
+		catch(glare::Exception& e)
+		{
+			failTest("Failed:" + e.what());
+		}
+
 		//========================== Test maximum memory usage ==========================
 		try
 		{
@@ -1002,6 +1204,141 @@ void LuaTests::test()
 		}
 
 
+		//========================== Test LuaBytecodeCache ==========================
+		try
+		{
+			LuaVM vm;
+			vm.max_total_mem_allowed = 100000000;
+
+			// Make a largish script, so compilation time is significant.
+			std::string src;
+			for(int i=0; i<200; ++i)
+				src += "function f" + toString(i) + "(x)\n    local y = x * " + toString(i) + "\n    if y > 10 then return y - 1 else return y + 1 end\nend\n";
+			src += "assert(f3(5) == 14, 'f3(5) == 14')\n";
+
+			const int N = 200;
+
+			Timer timer;
+			for(int i=0; i<N; ++i)
+			{
+				LuaScriptOptions options;
+				LuaScript script(&vm, options, src);
+				script.exec();
+			}
+			const double no_cache_time = timer.elapsed();
+
+			LuaBytecodeCacheRef cache = new LuaBytecodeCache();
+			timer.reset();
+			for(int i=0; i<N; ++i)
+			{
+				LuaScriptOptions options;
+				options.bytecode_cache = cache.ptr();
+				LuaScript script(&vm, options, src);
+				script.exec();
+			}
+			const double cache_time = timer.elapsed();
+
+			{
+				Lock lock(cache->mutex);
+				testAssert(cache->num_misses == 1);
+				testAssert(cache->num_mem_hits == N - 1);
+			}
+			testAssert(cache->numMemCacheEntries() == 1);
+
+			conPrint("Creating " + toString(N) + " LuaScripts: without bytecode cache: " + doubleToStringNSigFigs(no_cache_time * 1.0e3, 4) + " ms, with bytecode cache: " + 
+				doubleToStringNSigFigs(cache_time * 1.0e3, 4) + " ms (" + doubleToStringNSigFigs(no_cache_time / cache_time, 3) + "x speedup)");
+
+			// Compile errors should not be cached, and should still throw LuaScriptExcepWithLocation.
+			for(int i=0; i<2; ++i)
+			{
+				try
+				{
+					LuaScriptOptions options;
+					options.bytecode_cache = cache.ptr();
+					LuaScript script(&vm, options, "function x");
+					failTest("Exception expected");
+				}
+				catch(LuaScriptExcepWithLocation& e)
+				{
+					testAssert(!e.errors.empty());
+				}
+			}
+			testAssert(cache->numMemCacheEntries() == 1);
+
+			// Different compile options should give a different cache entry.
+			Luau::CompileOptions compile_options;
+			compile_options.optimizationLevel = 2;
+			cache->getOrCompileBytecode(src, compile_options);
+			compile_options.optimizationLevel = 0;
+			cache->getOrCompileBytecode(src, compile_options);
+			cache->getOrCompileBytecode(src, compile_options);
+			testAssert(cache->numMemCacheEntries() == 3);
+			{
+				Lock lock(cache->mutex);
+				testAssert(cache->num_misses == 3);
+			}
+
+			// Test disk persistence: a new cache using the same dir should load the bytecode from disk instead of compiling it.
+			const std::string cache_dir = PlatformUtils::getTempDirPath() + "/lua_bytecode_cache_test";
+			if(FileUtils::fileExists(cache_dir))
+				FileUtils::deleteDirectoryRecursive(cache_dir);
+			{
+				LuaBytecodeCacheRef disk_cache = new LuaBytecodeCache(cache_dir);
+				LuaScriptOptions options;
+				options.bytecode_cache = disk_cache.ptr();
+				LuaScript script(&vm, options, src);
+				script.exec();
+				Lock lock(disk_cache->mutex);
+				testAssert(disk_cache->num_misses == 1);
+			}
+			{
+				LuaBytecodeCacheRef disk_cache = new LuaBytecodeCache(cache_dir);
+				LuaScriptOptions options;
+				options.bytecode_cache = disk_cache.ptr();
+				LuaScript script(&vm, options, src);
+				script.exec();
+				Lock lock(disk_cache->mutex);
+				testAssert(disk_cache->num_misses == 0);
+				testAssert(disk_cache->num_disk_hits == 1);
+			}
+
+			// Test that truncated and corrupted cache files are detected, and the script is recompiled and the cache file rewritten.
+			const std::vector<std::string> cache_files = FileUtils::getFilesInDirFullPaths(cache_dir);
+			testAssert(cache_files.size() == 1);
+			const std::string valid_contents = FileUtils::readEntireFile(cache_files[0]);
+			for(int i=0; i<2; ++i)
+			{
+				std::string bad_contents = valid_contents;
+				if(i == 0)
+					bad_contents.resize(valid_contents.size() - 10); // Truncate
+				else
+					bad_contents[valid_contents.size() / 2 + 7] ^= 0x10; // Flip a bit in the bytecode
+				FileUtils::writeEntireFile(cache_files[0], bad_contents);
+
+				{
+					LuaBytecodeCacheRef disk_cache = new LuaBytecodeCache(cache_dir);
+					LuaScriptOptions options;
+					options.bytecode_cache = disk_cache.ptr();
+					LuaScript script(&vm, options, src);
+					script.exec();
+					Lock lock(disk_cache->mutex);
+					testAssert(disk_cache->num_misses == 1);
+					testAssert(disk_cache->num_disk_hits == 0);
+				}
+				testAssert(FileUtils::readEntireFile(cache_files[0]) == valid_contents);
+			}
+			FileUtils::deleteDirectoryRecursive(cache_dir);
+		}
+		catch(LuaScriptExcepWithLocation& e)
+		{
+			failTest("Failed:" + e.messageWithLocations());
+		}
+		catch(glare::Exception& e)
+		{
+			failTest("Failed:" + e.what());
+		}
+
+
 		//========================== Test creating a table with a metatable and __index and __newindex metamethod ==========================
 		try
 		{
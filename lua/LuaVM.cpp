@@ -15,6 +15,20 @@ Copyright Glare Technologies Limited 2024 -
 #include <lualib.h>
 #include <Luau/Common.h>
 #include <limits>
+#include <cstring>
+
+
+// Updates total_allocated for an allocation size change, throwing an exception if the new total would exceed max_total_mem_allowed.
+static inline void updateTotalAllocated(LuaVM* lua_vm, int64 size_change)
+{
+	const int64 new_total_allocated = lua_vm->total_allocated + size_change;
+
+	if(new_total_allocated > lua_vm->max_total_mem_allowed)
+		throw glare::Exception("Tried to allocate more Lua memory than max total allowed amount of " + toString(lua_vm->max_total_mem_allowed) + " B");
+
+	lua_vm->total_allocated = new_total_allocated;
+	lua_vm->total_allocated_high_water_mark = myMax(lua_vm->total_allocated_high_water_mark, new_total_allocated);
+}
 
 
 static void* glareLuaAlloc(void* user_data, void* ptr, size_t original_size, size_t new_size)
@@ -30,32 +44,38 @@ static void* glareLuaAlloc(void* user_data, void* ptr, size_t original_size, siz
 	}
 	else
 	{
-		if(new_size != 0 && original_size == 0)
-		{
-			const int64 new_total_allocated = lua_vm->total_allocated + (int64)new_size;
-
-			if(new_total_allocated > lua_vm->max_total_mem_allowed)
-				throw glare::Exception("Tried to allocate more Lua memory than max total allowed amount of " + toString(lua_vm->max_total_mem_allowed) + " B");
-
-			lua_vm->total_allocated = new_total_allocated;
-			lua_vm->total_allocated_high_water_mark = myMax(lua_vm->total_allocated_high_water_mark, new_total_allocated);
+		updateTotalAllocated(lua_vm, (int64)new_size - (int64)original_size);
 
+		if(original_size == 0)
 			return malloc(new_size);
-		}
 		else
-		{
-			// Realloc behaviour
-			const int64 new_total_allocated = lua_vm->total_allocated + ((int64)new_size - (int64)original_size);
+			return realloc(ptr, new_size); // Realloc behaviour
+	}
+}
 
-			if(new_total_allocated > lua_vm->max_total_mem_allowed)
-				throw glare::Exception("Tried to allocate more Lua memory than max total allowed amount of " + toString(lua_vm->max_total_mem_allowed) + " B");
 
-			lua_vm->total_allocated = new_total_allocated;
-			lua_vm->total_allocated_high_water_mark = myMax(lua_vm->total_allocated_high_water_mark, new_total_allocated);
+// Allocation callback using the VM's small block allocator.  Accounting is the same as for glareLuaAlloc.
+static void* glareLuaPooledAlloc(void* user_data, void* ptr, size_t original_size, size_t new_size)
+{
+	LuaVM* lua_vm = (LuaVM*)user_data;
+	LuaSmallBlockAllocator& allocator = lua_vm->small_block_allocator;
 
-			void* res = realloc(ptr, new_size);
-			return res;
-		}
+	if(new_size == 0)
+	{
+		lua_vm->total_allocated -= (int64)original_size;
+
+		if(ptr)
+			allocator.free(ptr, original_size);
+		return NULL;
+	}
+	else
+	{
+		updateTotalAllocated(lua_vm, (int64)new_size - (int64)original_size);
+
+		if(original_size == 0)
+			return allocator.alloc(new_size);
+		else
+			return allocator.realloc(ptr, original_size, new_size); // Realloc behaviour
 	}
 }
 
@@ -141,7 +161,125 @@ static int Vec3dEqualityOperator(lua_State* state)
 }
 
 
-LuaVM::LuaVM()
+LuaSmallBlockAllocator::LuaSmallBlockAllocator()
+{
+	static_assert(sizeof(Slab) <= SLAB_HEADER_SIZE, "sizeof(Slab) <= SLAB_HEADER_SIZE");
+	static_assert(SLAB_HEADER_SIZE % SIZE_CLASS_GRANULARITY == 0, "SLAB_HEADER_SIZE % SIZE_CLASS_GRANULARITY == 0");
+
+	for(size_t i=0; i<NUM_SIZE_CLASSES; ++i)
+		available_slabs[i] = NULL;
+}
+
+
+LuaSmallBlockAllocator::~LuaSmallBlockAllocator()
+{
+	for(size_t i=0; i<slabs.size(); ++i)
+		::free(slabs[i]);
+}
+
+
+// Makes an empty slab for size_class, reusing an empty slab if there is one, and adds it to the available list.
+LuaSmallBlockAllocator::Slab* LuaSmallBlockAllocator::addAvailableSlab(size_t size_class)
+{
+	Slab* slab;
+	if(!empty_slabs.empty())
+	{
+		slab = empty_slabs.back();
+		empty_slabs.pop_back();
+	}
+	else
+	{
+		slab = (Slab*)::malloc(SLAB_SIZE);
+		if(!slab)
+			return NULL;
+
+		// Insert into slabs, keeping it sorted by address.
+		slabs.push_back(slab);
+		size_t i = slabs.size() - 1;
+		for(; i > 0 && (uintptr_t)slabs[i - 1] > (uintptr_t)slab; --i)
+			slabs[i] = slabs[i - 1];
+		slabs[i] = slab;
+	}
+
+	slab->free_list = NULL;
+	slab->unused_pos = (uint8*)slab + SLAB_HEADER_SIZE;
+	slab->size_class = (uint32)size_class;
+	slab->num_live_blocks = 0;
+	slab->available = false;
+	addToAvailableList(slab);
+	return slab;
+}
+
+
+void LuaSmallBlockAllocator::addToAvailableList(Slab* slab)
+{
+	assert(!slab->available);
+	Slab*& head = available_slabs[slab->size_class];
+	slab->prev_available = NULL;
+	slab->next_available = head;
+	if(head)
+		head->prev_available = slab;
+	head = slab;
+	slab->available = true;
+}
+
+
+void LuaSmallBlockAllocator::removeFromAvailableList(Slab* slab)
+{
+	assert(slab->available);
+	if(slab->prev_available)
+		slab->prev_available->next_available = slab->next_available;
+	else
+		available_slabs[slab->size_class] = slab->next_available;
+	if(slab->next_available)
+		slab->next_available->prev_available = slab->prev_available;
+	slab->available = false;
+}
+
+
+// Called when the last live block in a slab is freed.  Keeps the slab for reuse by any size class, or frees it if there are already enough empty slabs.
+void LuaSmallBlockAllocator::releaseEmptySlab(Slab* slab)
+{
+	if(slab->available)
+		removeFromAvailableList(slab);
+
+	if(empty_slabs.size() < MAX_NUM_EMPTY_SLABS)
+	{
+		empty_slabs.push_back(slab);
+		return;
+	}
+
+	// Remove from slabs, keeping it sorted.
+	size_t i = 0;
+	while(slabs[i] != slab)
+		i++;
+	for(; i + 1 < slabs.size(); ++i)
+		slabs[i] = slabs[i + 1];
+	slabs.pop_back();
+
+	::free(slab);
+}
+
+
+void* LuaSmallBlockAllocator::realloc(void* ptr, size_t original_size, size_t new_size)
+{
+	if(!isSmallBlockSize(original_size) && !isSmallBlockSize(new_size))
+		return ::realloc(ptr, new_size);
+
+	if(isSmallBlockSize(original_size) && isSmallBlockSize(new_size) && (sizeClassForSize(original_size) == sizeClassForSize(new_size)))
+		return ptr; // Block is already big enough.
+
+	void* new_block = alloc(new_size);
+	if(!new_block)
+		return NULL;
+
+	std::memcpy(new_block, ptr, myMin(original_size, new_size));
+	free(ptr, original_size);
+	return new_block;
+}
+
+
+LuaVM::LuaVM(bool use_small_block_allocator)
 :	state(NULL),
 	total_allocated(0),
 	total_allocated_high_water_mark(0),
@@ -159,7 +297,7 @@ LuaVM::LuaVM()
 
 	try
 	{
-		state = lua_newstate(glareLuaAlloc, /*ud (auxiliary data to `frealloc')=*/this);
+		state = lua_newstate(use_small_block_allocator ? glareLuaPooledAlloc : glareLuaAlloc, /*ud (auxiliary data to `frealloc')=*/this);
 		if(!state)
 			throw glare::Exception("lua_newstate failed.");
 
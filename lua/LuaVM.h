@@ -7,10 +7,168 @@ Copyright Glare Technologies Limited 2024 -
 
 
 #include "../utils/Platform.h"
+#include "../utils/Vector.h"
+#include <stdlib.h>
 struct lua_State;
 typedef int (*lua_CFunction)(lua_State* L);
 
 
+/*=====================================================================
+LuaSmallBlockAllocator
+----------------------
+Size-class pool allocator for the allocations Luau makes through the 
+LuaVM allocation callback.
+
+Blocks of up to MAX_SMALL_BLOCK_SIZE bytes are rounded up to a multiple of 
+SIZE_CLASS_GRANULARITY and carved out of SLAB_SIZE slabs.  Each slab only 
+holds blocks of one size class.  Freed blocks go on a free list in their slab, 
+so allocation and free are mostly just a list push or pop.  Reallocs within 
+the same size class don't move the block.
+A slab whose blocks have all been freed is kept for reuse by any size class, 
+up to MAX_NUM_EMPTY_SLABS of them, and any more are returned to the system.  
+So memory freed in one size class doesn't stay tied to it.
+Larger allocations use malloc/realloc/free.
+
+Not thread-safe: each LuaVM has its own allocator, and a Lua VM is only 
+used by one thread at a time.
+=====================================================================*/
+class LuaSmallBlockAllocator
+{
+public:
+	LuaSmallBlockAllocator();
+	~LuaSmallBlockAllocator();
+
+	static const size_t SIZE_CLASS_GRANULARITY = 16; // Also the alignment of small blocks, matching malloc on 64-bit platforms.
+	static const size_t MAX_SMALL_BLOCK_SIZE = 1024;
+	static const size_t NUM_SIZE_CLASSES = MAX_SMALL_BLOCK_SIZE / SIZE_CLASS_GRANULARITY;
+	static const size_t SLAB_SIZE = 64 * 1024;
+	static const size_t MAX_NUM_EMPTY_SLABS = 4;
+
+	// Returns NULL on failure.  size must be > 0.
+	inline void* alloc(size_t size);
+
+	// size must be the size the block was allocated with.
+	inline void free(void* ptr, size_t size);
+
+	// Returns NULL on failure, in which case the original block is left allocated.
+	void* realloc(void* ptr, size_t original_size, size_t new_size);
+
+	size_t numSlabs() const { return slabs.size(); } // Including empty slabs kept for reuse.
+	size_t numEmptySlabs() const { return empty_slabs.size(); }
+
+	static inline bool isSmallBlockSize(size_t size) { return size <= MAX_SMALL_BLOCK_SIZE; }
+	static inline size_t sizeClassForSize(size_t size) { return (size - 1) / SIZE_CLASS_GRANULARITY; } // size must be > 0
+	static inline size_t blockSizeForSizeClass(size_t size_class) { return (size_class + 1) * SIZE_CLASS_GRANULARITY; }
+
+private:
+	GLARE_DISABLE_COPY(LuaSmallBlockAllocator);
+
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	// Header at the start of each slab, followed by the blocks.
+	struct Slab
+	{
+		FreeBlock* free_list; // Freed blocks in this slab.
+		uint8* unused_pos; // Start of the space at the end of the slab that hasn't been handed out yet.
+		Slab* prev_available; // Links in the list of slabs of this size class with space for another block.
+		Slab* next_available;
+		uint32 size_class;
+		uint32 num_live_blocks;
+		bool available; // Is this slab in available_slabs[size_class]?
+	};
+	static const size_t SLAB_HEADER_SIZE = 64; // sizeof(Slab), rounded up to a multiple of SIZE_CLASS_GRANULARITY.
+
+	inline static bool slabIsFull(const Slab* slab) { return !slab->free_list && (slab->unused_pos + blockSizeForSizeClass(slab->size_class) > (const uint8*)slab + SLAB_SIZE); }
+	inline Slab* findSlab(void* ptr) const;
+
+	Slab* addAvailableSlab(size_t size_class); // Returns NULL on failure.
+	void addToAvailableList(Slab* slab);
+	void removeFromAvailableList(Slab* slab);
+	void releaseEmptySlab(Slab* slab);
+
+	Slab* available_slabs[NUM_SIZE_CLASSES]; // Head of the list of slabs with space for another block, for each size class.
+	js::Vector<Slab*, 16> slabs; // All slabs, including empty ones, sorted by address so findSlab() can do a binary search.
+	js::Vector<Slab*, 16> empty_slabs; // Slabs with no live blocks, not in any available list.
+};
+
+
+void* LuaSmallBlockAllocator::alloc(size_t size)
+{
+	if(!isSmallBlockSize(size))
+		return ::malloc(size);
+
+	const size_t size_class = sizeClassForSize(size);
+	Slab* slab = available_slabs[size_class];
+	if(!slab)
+	{
+		slab = addAvailableSlab(size_class);
+		if(!slab)
+			return NULL;
+	}
+
+	void* block;
+	if(slab->free_list)
+	{
+		block = slab->free_list;
+		slab->free_list = slab->free_list->next;
+	}
+	else
+	{
+		block = slab->unused_pos;
+		slab->unused_pos += blockSizeForSizeClass(size_class);
+	}
+	slab->num_live_blocks++;
+
+	if(slabIsFull(slab))
+		removeFromAvailableList(slab);
+	return block;
+}
+
+
+LuaSmallBlockAllocator::Slab* LuaSmallBlockAllocator::findSlab(void* ptr) const
+{
+	// Find the last slab starting at or before ptr.
+	size_t lo = 0;
+	size_t hi = slabs.size(); // Invariant: the slab is in [lo, hi).
+	while(hi - lo > 1)
+	{
+		const size_t mid = (lo + hi) / 2;
+		if((uintptr_t)slabs[mid] <= (uintptr_t)ptr)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	assert((uintptr_t)slabs[lo] <= (uintptr_t)ptr && (uintptr_t)ptr < (uintptr_t)slabs[lo] + SLAB_SIZE);
+	return slabs[lo];
+}
+
+
+void LuaSmallBlockAllocator::free(void* ptr, size_t size)
+{
+	if(!isSmallBlockSize(size))
+	{
+		::free(ptr);
+		return;
+	}
+
+	Slab* slab = findSlab(ptr);
+	assert(slab->size_class == sizeClassForSize(size));
+
+	FreeBlock* block = (FreeBlock*)ptr;
+	block->next = slab->free_list;
+	slab->free_list = block;
+	slab->num_live_blocks--;
+
+	if(slab->num_live_blocks == 0)
+		releaseEmptySlab(slab);
+	else if(!slab->available)
+		addToAvailableList(slab);
+}
+
+
 /*=====================================================================
 LuaVM
 -----
@@ -18,7 +176,8 @@ LuaVM
 class LuaVM
 {
 public:
-	LuaVM();
+	// If use_small_block_allocator is false, all allocations go directly to malloc/realloc/free.
+	LuaVM(bool use_small_block_allocator = true);
 	~LuaVM();
 
 	// Call once you have finished adding global functions
@@ -29,10 +188,12 @@ public:
 
 	lua_State* state;
 
-	int64 total_allocated;
+	int64 total_allocated; // Sum of the sizes requested by Luau, doesn't include size-class rounding or unused slab space.
 	int64 total_allocated_high_water_mark;
 	int64 max_total_mem_allowed;
 
+	LuaSmallBlockAllocator small_block_allocator;
+
 	bool init_finished;
 
 	int Vec3dMetaTable_ref;
@@ -7,6 +7,8 @@ Copyright Glare Technologies Limited 2020 -
 
 
 #include "MySocket.h"
+#include "UDPSocket.h"
+#include "IPAddress.h"
 #include "MyThread.h"
 #include "Networking.h"
 #include "../utils/TestUtils.h"
@@ -588,6 +590,172 @@ public:
 
 
 
+// Reads packets from a non-blocking socket until num_packets have been read.  Fails the test if they don't all arrive within a few seconds.
+static void readUDPPacketsUntil(UDPSocket& socket, std::vector<UDPSocket::IncomingPacket>& packets, size_t num_packets, bool use_batched_reads, std::vector<uint32>& received_ids_out)
+{
+	Timer timer;
+	while(received_ids_out.size() < num_packets)
+	{
+		size_t num_read;
+		if(use_batched_reads)
+			num_read = socket.readPackets(packets.data(), packets.size());
+		else
+		{
+			packets[0].len = socket.readPacket(packets[0].buf, packets[0].buflen, packets[0].sender_ip, packets[0].sender_port);
+			num_read = (packets[0].len > 0) ? 1 : 0;
+		}
+
+		for(size_t i=0; i<num_read; ++i)
+		{
+			testAssert(packets[i].len >= sizeof(uint32));
+			uint32 id;
+			std::memcpy(&id, packets[i].buf, sizeof(uint32));
+			received_ids_out.push_back(id);
+		}
+
+		if(timer.elapsed() > 5)
+			failTest("Timed out waiting for UDP packets, received " + toString(received_ids_out.size()) + " / " + toString(num_packets));
+	}
+}
+
+
+static void testUDPSockets()
+{
+	conPrint("testUDPSockets()");
+
+	const int port = 5679;
+	UDPSocket receiver;
+	receiver.bindToPort(port, /*reuse_address=*/true);
+	receiver.setBlocking(false);
+
+	UDPSocket sender;
+	sender.createClientSocket(/*use_IPv6=*/false);
+
+	const IPAddress dest_ip("127.0.0.1");
+
+	//===================== Test batched sends and receives ==========================
+	{
+		// Send packets of varying sizes, with the packet index at the start.
+		const size_t num_packets = 200;
+		std::vector<std::vector<unsigned char> > packet_data(num_packets);
+		std::vector<UDPSocket::OutgoingPacket> packets(num_packets);
+		for(size_t i=0; i<num_packets; ++i)
+		{
+			packet_data[i].resize(4 + i * 5);
+			for(size_t z=0; z<packet_data[i].size(); ++z)
+				packet_data[i][z] = (unsigned char)(i + z);
+			const uint32 id = (uint32)i;
+			std::memcpy(packet_data[i].data(), &id, sizeof(uint32));
+
+			packets[i].data = packet_data[i].data();
+			packets[i].datalen = packet_data[i].size();
+			packets[i].dest_ip = dest_ip;
+			packets[i].dest_port = port;
+		}
+
+		std::vector<unsigned char> bufs(num_packets * 2048);
+		std::vector<UDPSocket::IncomingPacket> incoming(num_packets);
+		for(size_t i=0; i<num_packets; ++i)
+		{
+			incoming[i].buf = bufs.data() + i * 2048;
+			incoming[i].buflen = 2048;
+		}
+
+		// Send in groups, reading each group back before sending the next, so as not to overflow the receive buffer.
+		size_t num_read = 0;
+		for(size_t i=0; i<num_packets; i += 50)
+		{
+			sender.sendPackets(packets.data() + i, 50);
+
+			Timer timer;
+			while(num_read < i + 50)
+			{
+				num_read += receiver.readPackets(incoming.data() + num_read, num_packets - num_read);
+				if(timer.elapsed() > 5)
+					failTest("Timed out waiting for UDP packets");
+			}
+		}
+		testAssert(num_read == num_packets);
+
+		// Check the contents of the packets.
+		for(size_t i=0; i<num_packets; ++i)
+		{
+			uint32 id;
+			std::memcpy(&id, incoming[i].buf, sizeof(uint32));
+			testAssert(id < num_packets);
+			testAssert(incoming[i].len == packet_data[id].size());
+			testAssert(std::memcmp(incoming[i].buf, packet_data[id].data(), packet_data[id].size()) == 0);
+			testAssert(incoming[i].sender_port == sender.getThisEndPort());
+		}
+
+		// Non-blocking read with no packets available
+		testAssert(receiver.readPackets(incoming.data(), num_packets) == 0);
+
+		// Sending zero packets should be fine
+		sender.sendPackets(packets.data(), 0);
+	}
+
+	//===================== Benchmark packets/s over loopback ==========================
+	{
+		const size_t group_size = 64; // Send this many packets before reading them back, so as not to overflow the receive buffer.
+		const size_t num_packets = group_size * 1600;
+		const size_t packet_size = 100; // Typical voice/position update size.
+
+		std::vector<unsigned char> bufs(group_size * 2048);
+		std::vector<UDPSocket::IncomingPacket> incoming(group_size);
+		for(size_t i=0; i<group_size; ++i)
+		{
+			incoming[i].buf = bufs.data() + i * 2048;
+			incoming[i].buflen = 2048;
+		}
+
+		std::vector<unsigned char> packet_data(group_size * packet_size, 1);
+		std::vector<UDPSocket::OutgoingPacket> packets(group_size);
+		for(size_t i=0; i<group_size; ++i)
+		{
+			packets[i].data = packet_data.data() + i * packet_size;
+			packets[i].datalen = packet_size;
+			packets[i].dest_ip = dest_ip;
+			packets[i].dest_port = port;
+		}
+
+		for(int batched=0; batched<2; ++batched)
+		{
+			std::vector<uint32> received_ids;
+			received_ids.reserve(num_packets);
+
+			Timer timer;
+			for(size_t i=0; i<num_packets; i += group_size)
+			{
+				for(size_t z=0; z<group_size; ++z)
+				{
+					const uint32 id = (uint32)(i + z);
+					std::memcpy(packet_data.data() + z * packet_size, &id, sizeof(uint32));
+				}
+
+				if(batched)
+					sender.sendPackets(packets.data(), group_size);
+				else
+					for(size_t z=0; z<group_size; ++z)
+						sender.sendPacket(packets[z].data, packets[z].datalen, dest_ip, port);
+
+				readUDPPacketsUntil(receiver, incoming, i + group_size, /*use_batched_reads=*/batched != 0, received_ids);
+			}
+			const double elapsed = timer.elapsed();
+
+			testAssert(received_ids.size() == num_packets);
+			for(size_t i=0; i<received_ids.size(); ++i)
+				testAssert(received_ids[i] == i);
+
+			conPrint(std::string(batched ? "Batched (sendPackets/readPackets)" : "Single packet (sendPacket/readPacket)") + ": sent and received " + toString(received_ids.size()) + " " + toString(packet_size) + " B packets over loopback in " + 
+				doubleToStringNSigFigs(elapsed, 4) + " s (" + doubleToStringNSigFigs(received_ids.size() / elapsed, 4) + " packets/s)");
+		}
+	}
+
+	conPrint("testUDPSockets(): done.");
+}
+
+
 void SocketTests::test()
 {
 	conPrint("SocketTests::test()");
@@ -716,6 +884,10 @@ void SocketTests::test()
 	{}*/
 	
 	
+	//===================== Test UDP sockets ==========================
+	testUDPSockets();
+	
+	
 	conPrint("SocketTests::test(): done.");
 }
 
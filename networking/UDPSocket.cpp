@@ -13,6 +13,7 @@ Copyright Glare Technologies Limited 2023 -
 #include <assert.h>
 #include "../utils/Lock.h"
 #include "../utils/StringUtils.h"
+#include "../maths/mathstypes.h"
 #include <string.h> // for memset()
 #if defined(_WIN32)
 #include <winsock2.h>
@@ -31,6 +32,9 @@ Copyright Glare Technologies Limited 2023 -
 #include <fcntl.h>
 //#include <poll.h>
 #endif
+#if defined(__linux__)
+#include <sys/uio.h> // iovec
+#endif
 #include <RuntimeCheck.h>
 
 
@@ -43,6 +47,13 @@ static const int SOCKET_ERROR = -1;
 #endif
 
 
+// Size of the destination address for sendto(), sendmmsg() etc.
+static SockLenType destAddressSize(const IPAddress& dest_ip)
+{
+	return (dest_ip.getVersion() == IPAddress::Version_4) ? sizeof(struct sockaddr) : sizeof(sockaddr_storage); // We need to use sizeof(struct sockaddr) for IPv4 address on Mac or we get an 'invalid argument' error.
+}
+
+
 UDPSocket::UDPSocket() // create outgoing socket
 {
 	socket_handle = nullSocketHandle();
@@ -257,7 +268,7 @@ void UDPSocket::sendPacket(const void* data, size_t datalen, const IPAddress& de
 	//-----------------------------------------------------------------
 	const int numbytessent = ::sendto(socket_handle, (const char*)data, (int)datalen, 0, 
 		(struct sockaddr*)&dest_address, 
-		(dest_ip.getVersion() == IPAddress::Version_4) ? sizeof(struct sockaddr) : sizeof(sockaddr_storage) // We need to use sizeof(struct sockaddr) for IPv4 address on Mac or we get an 'invalid argument' error.
+		destAddressSize(dest_ip)
 	);
 	
 	if(numbytessent == SOCKET_ERROR)
@@ -306,6 +317,144 @@ size_t UDPSocket::readPacket(unsigned char* buf, size_t buflen, IPAddress& sende
 }
 
 
+#if defined(__linux__)
+static const size_t MAX_MMSG_BATCH_SIZE = 64; // Max number of packets per sendmmsg() or recvmmsg() call.
+#endif
+
+
+void UDPSocket::sendPackets(const OutgoingPacket* packets, size_t num_packets)
+{
+#if defined(__linux__)
+	struct mmsghdr msgs[MAX_MMSG_BATCH_SIZE];
+	struct iovec iovecs[MAX_MMSG_BATCH_SIZE];
+	sockaddr_storage dest_addresses[MAX_MMSG_BATCH_SIZE];
+
+	for(size_t batch_start = 0; batch_start < num_packets; batch_start += MAX_MMSG_BATCH_SIZE)
+	{
+		const size_t batch_size = myMin(num_packets - batch_start, MAX_MMSG_BATCH_SIZE);
+		for(size_t i=0; i<batch_size; ++i)
+		{
+			const OutgoingPacket& packet = packets[batch_start + i];
+			packet.dest_ip.fillOutSockAddr(dest_addresses[i], packet.dest_port);
+
+			iovecs[i].iov_base = (void*)packet.data;
+			iovecs[i].iov_len = packet.datalen;
+
+			std::memset(&msgs[i], 0, sizeof(msgs[i]));
+			msgs[i].msg_hdr.msg_name = &dest_addresses[i];
+			msgs[i].msg_hdr.msg_namelen = destAddressSize(packet.dest_ip);
+			msgs[i].msg_hdr.msg_iov = &iovecs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		// sendmmsg may send fewer packets than requested, so keep going until the whole batch has been sent.
+		size_t num_sent = 0;
+		while(num_sent < batch_size)
+		{
+			const int res = ::sendmmsg(socket_handle, msgs + num_sent, (unsigned int)(batch_size - num_sent), /*flags=*/0);
+			if(res == SOCKET_ERROR)
+				throw makeMySocketExcepFromLastErrorCode("error while writing to UDP socket");
+
+			for(int i=0; i<res; ++i)
+				if(msgs[num_sent + i].msg_len < iovecs[num_sent + i].iov_len)
+					throw MySocketExcep("error: could not get all bytes in one packet.");
+
+			num_sent += res;
+		}
+	}
+#else
+	for(size_t i=0; i<num_packets; ++i)
+		sendPacket(packets[i].data, packets[i].datalen, packets[i].dest_ip, packets[i].dest_port);
+#endif
+}
+
+
+size_t UDPSocket::readPackets(IncomingPacket* packets, size_t num_packets)
+{
+#if defined(__linux__)
+	struct mmsghdr msgs[MAX_MMSG_BATCH_SIZE];
+	struct iovec iovecs[MAX_MMSG_BATCH_SIZE];
+	sockaddr_storage from_addresses[MAX_MMSG_BATCH_SIZE];
+
+	size_t num_read = 0;
+	while(num_read < num_packets)
+	{
+		const size_t batch_size = myMin(num_packets - num_read, MAX_MMSG_BATCH_SIZE);
+		for(size_t i=0; i<batch_size; ++i)
+		{
+			IncomingPacket& packet = packets[num_read + i];
+			iovecs[i].iov_base = packet.buf;
+			iovecs[i].iov_len = packet.buflen;
+
+			std::memset(&msgs[i], 0, sizeof(msgs[i]));
+			msgs[i].msg_hdr.msg_name = &from_addresses[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(from_addresses[i]);
+			msgs[i].msg_hdr.msg_iov = &iovecs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		// For the first batch, MSG_WAITFORONE blocks until a packet is available (if the socket is blocking), then reads any further available packets without blocking.
+		// Subsequent batches don't block.
+		const int flags = (num_read == 0) ? MSG_WAITFORONE : MSG_DONTWAIT;
+		const int res = ::recvmmsg(socket_handle, msgs, (unsigned int)batch_size, flags, /*timeout=*/NULL);
+		if(res == SOCKET_ERROR)
+		{
+			if(errno == EAGAIN || errno == EWOULDBLOCK)
+				break; // No more packets available.
+
+			throw MySocketExcep("Error while reading from UDP socket: " + Networking::getError());
+		}
+
+		for(int i=0; i<res; ++i)
+		{
+			IncomingPacket& packet = packets[num_read + i];
+			packet.len = msgs[i].msg_len;
+			packet.sender_ip = IPAddress(from_addresses[i]);
+			packet.sender_port = Networking::getPortFromSockAddr(from_addresses[i]);
+		}
+		num_read += res;
+
+		if((size_t)res < batch_size) // If we didn't fill the batch then there are no more packets available.
+			break;
+	}
+	return num_read;
+#else
+	size_t num_read = 0;
+	while(num_read < num_packets)
+	{
+		if(num_read > 0 && !isReadableWithoutBlocking())
+			break;
+
+		IncomingPacket& packet = packets[num_read];
+		packet.len = readPacket(packet.buf, packet.buflen, packet.sender_ip, packet.sender_port);
+		if(packet.len == 0 && num_read == 0) // NOTE: zero-length packets are indistinguishable from no packet available in non-blocking mode here.
+			break;
+		num_read++;
+	}
+	return num_read;
+#endif
+}
+
+
+// Returns true if a packet can be read from the socket without blocking.
+bool UDPSocket::isReadableWithoutBlocking()
+{
+	fd_set read_sockset;
+	FD_ZERO(&read_sockset);
+	FD_SET(socket_handle, &read_sockset);
+
+	timeval wait_period;
+	wait_period.tv_sec = 0;
+	wait_period.tv_usec = 0;
+
+	const int num_ready = select((int)(socket_handle + 1), &read_sockset, NULL, NULL, &wait_period);
+	if(num_ready == SOCKET_ERROR)
+		throw MySocketExcep("select failed: " + Networking::getError());
+
+	return num_ready > 0;
+}
+
+
 void UDPSocket::setBlocking(bool blocking)
 {
 #if defined(_WIN32)
@@ -18,8 +18,8 @@ Copyright Glare Technologies Limited 2023 -
 #endif
 #include <stddef.h> // for size_t
 
+#include "IPAddress.h"
 #include "../utils/ThreadSafeRefCounted.h"
-class IPAddress;
 class Packet;
 
 
@@ -29,6 +29,9 @@ UDPSocket
 Provides an interface to the net's connectionless service
 
 Methods throw MySocketExcep on failure.
+
+sendPackets() and readPackets() send and receive many packets per syscall, using sendmmsg() and recvmmsg() on Linux.
+On other platforms they loop over single packet sends and receives.
 =====================================================================*/
 class UDPSocket : public ThreadSafeRefCounted
 {
@@ -55,6 +58,32 @@ public:
 	// Returns num bytes read.  If the socket has been set to non-blocking mode, returns 0 if there are no packets to read.
 	size_t readPacket(unsigned char* buf, size_t buflen, IPAddress& sender_ip_out, int& senderport_out);
 
+
+	struct OutgoingPacket
+	{
+		const void* data;
+		size_t datalen;
+		IPAddress dest_ip;
+		int dest_port;
+	};
+
+	// Sends all the packets.  createClientSocket() or bindToPort() should be called first.
+	void sendPackets(const OutgoingPacket* packets, size_t num_packets);
+
+	struct IncomingPacket
+	{
+		unsigned char* buf; // Set by caller
+		size_t buflen; // Set by caller
+		size_t len; // Num bytes received
+		IPAddress sender_ip;
+		int sender_port;
+	};
+
+	// Reads up to num_packets packets.  Blocks until at least one packet has been read, unless the socket has been set to non-blocking mode.
+	// Further packets are only read if they are available without blocking.
+	// Returns the number of packets read.  If the socket has been set to non-blocking mode, returns 0 if there are no packets to read.
+	size_t readPackets(IncomingPacket* packets, size_t num_packets);
+
 	void setBlocking(bool blocking);
 
 	void enableBroadcast();
@@ -69,6 +98,7 @@ private:
 	void setAddressReuseEnabled(bool enabled);
 	SOCKETHANDLE_TYPE nullSocketHandle();
 	bool isSockHandleValid(SOCKETHANDLE_TYPE handle);
+	bool isReadableWithoutBlocking();
 
 	SOCKETHANDLE_TYPE socket_handle;
 };
@@ -14,25 +14,99 @@ Copyright Glare Technologies Limited 2022 -
 #include "../utils/Timer.h"
 #include "../utils/ConPrint.h"
 #include "../utils/RuntimeCheck.h"
+#include "../utils/Lock.h"
+#include "../utils/EventFD.h"
+#include "../maths/SSE.h"
+#include <zlib.h>
 #include <string.h>
 
 
+static const size_t MAX_FRAME_HEADER_SIZE = 10; // Max size of an unmasked frame header
+
+static const size_t MIN_DIRECT_WRITE_SHARED_FRAME_SIZE = 16384; // Shared frames at least this large are written directly from the shared buffer, instead of being copied into buffer_out.
+
+static const uint8 DEFLATE_SYNC_FLUSH_TAIL[4] = { 0x00, 0x00, 0xFF, 0xFF }; // Empty stored block that ends a Z_SYNC_FLUSH.  Removed from the end of compressed messages, see RFC 7692 section 7.2.1.
+
+
 WebSocket::WebSocket(SocketInterfaceRef underlying_socket_)
 {
 	underlying_socket = underlying_socket_;
 
 	need_header_read = true;
 	payload_i = 0;
+	cur_frame_start = 0;
+	header_fin = true;
+	frame_compressed = false;
+	reading_compressed_message = false;
+
+	deflate_stream = NULL;
+	inflate_stream = NULL;
+	deflate_no_context_takeover = false;
+	inflated_data_read_i = 0;
+	cur_message_inflated_size = 0;
+	max_inflated_message_size = 64 * 1024 * 1024;
+	send_queue_event_fd = NULL;
 }
 
 
 WebSocket::~WebSocket()
 {
+	if(deflate_stream)
+	{
+		deflateEnd(deflate_stream);
+		delete deflate_stream;
+	}
+	if(inflate_stream)
+	{
+		inflateEnd(inflate_stream);
+		delete inflate_stream;
+	}
+}
+
+
+void WebSocket::enableDeflate(const WebSocketDeflateParams& params, bool is_server)
+{
+	if(!params.enabled || deflate_stream)
+		return;
+
+	const int window_bits = is_server ? params.server_max_window_bits : params.client_max_window_bits;
+	if(window_bits < 9 || window_bits > 15) // zlib doesn't support raw deflate with a window size of 256 (8 bits).
+		throw MySocketExcep("Unsupported permessage-deflate window bits: " + toString(window_bits));
+
+	deflate_no_context_takeover = is_server ? params.server_no_context_takeover : params.client_no_context_takeover;
+
+	deflate_stream = new z_stream_s();
+	// Negative window bits means a raw deflate stream, with no zlib header or checksum.
+	if(deflateInit2(deflate_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -window_bits, /*memLevel=*/8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		delete deflate_stream;
+		deflate_stream = NULL;
+		throw MySocketExcep("deflateInit2 failed");
+	}
+
+	// The other end may use any window size up to 15 bits, a 15 bit window handles all of them.
+	inflate_stream = new z_stream_s();
+	if(inflateInit2(inflate_stream, -15) != Z_OK)
+	{
+		delete inflate_stream;
+		inflate_stream = NULL;
+		deflateEnd(deflate_stream);
+		delete deflate_stream;
+		deflate_stream = NULL;
+		throw MySocketExcep("inflateInit2 failed");
+	}
 }
 
 
 void WebSocket::write(const void* data, size_t datalen)
 {
+	if(datalen == 0)
+		return;
+
+	// If this is the first data for the current frame, reserve space for the frame header, which is filled in when the frame is finished.
+	if(buffer_out.buf.size() == cur_frame_start)
+		buffer_out.buf.resize(cur_frame_start + MAX_FRAME_HEADER_SIZE);
+
 	// Append data to our output buffer.  Output data will be written to the underlying socket in the flush() method.
 	buffer_out.writeData(data, datalen);
 }
@@ -40,8 +114,7 @@ void WebSocket::write(const void* data, size_t datalen)
 
 void WebSocket::write(const void* data, size_t datalen, FractionListener* frac)
 {
-	// Append data to our output buffer.  Output data will be written to the underlying socket in the flush() method.
-	buffer_out.writeData(data, datalen);
+	write(data, datalen);
 }
 
 
@@ -106,18 +179,61 @@ if readlen is greater than the payload length, then we want to keep reading fram
               buf read                                       buf read (continued)
 
 */
+// XORs len bytes of src with the masking key, starting at key byte key_offset % 4, and writes the result to dest.  dest may be equal to src.
+static void unmaskData(uint8* dest, const uint8* src, size_t len, const uint8* masking_key, size_t key_offset)
+{
+	uint8 key[4]; // Masking key rotated so that it starts at key_offset
+	for(size_t i=0; i<4; ++i)
+		key[i] = masking_key[(key_offset + i) % 4];
+
+	uint32 key32;
+	std::memcpy(&key32, key, 4);
+
+	// Since 16 is a multiple of 4, each 16 byte block uses the same (rotated) key.
+	const __m128i key128 = _mm_set1_epi32((int)key32);
+	size_t i = 0;
+	for(; i + 64 <= len; i += 64)
+	{
+		const __m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i b = _mm_loadu_si128((const __m128i*)(src + i + 16));
+		const __m128i c = _mm_loadu_si128((const __m128i*)(src + i + 32));
+		const __m128i d = _mm_loadu_si128((const __m128i*)(src + i + 48));
+		_mm_storeu_si128((__m128i*)(dest + i),      _mm_xor_si128(a, key128));
+		_mm_storeu_si128((__m128i*)(dest + i + 16), _mm_xor_si128(b, key128));
+		_mm_storeu_si128((__m128i*)(dest + i + 32), _mm_xor_si128(c, key128));
+		_mm_storeu_si128((__m128i*)(dest + i + 48), _mm_xor_si128(d, key128));
+	}
+	for(; i + 16 <= len; i += 16)
+		_mm_storeu_si128((__m128i*)(dest + i), _mm_xor_si128(_mm_loadu_si128((const __m128i*)(src + i)), key128));
+
+	for(; i<len; ++i)
+		dest[i] = src[i] ^ key[i % 4];
+}
+
+
 void WebSocket::readTo(void* buffer, size_t readlen, FractionListener* frac)
 {
 	size_t buffer_write_i = 0;
 	size_t amount_still_to_read = readlen;
 	while(amount_still_to_read > 0)
 	{
-		if(need_header_read)
+		if(inflated_data_read_i < inflated_data.size())
+		{
+			// Return data already inflated from a compressed frame.
+			const size_t len = myMin(inflated_data.size() - inflated_data_read_i, amount_still_to_read);
+			std::memcpy((uint8*)buffer + buffer_write_i, inflated_data.data() + inflated_data_read_i, len);
+			inflated_data_read_i += len;
+			buffer_write_i += len;
+			amount_still_to_read -= len;
+		}
+		else if(need_header_read)
 		{
 			// Read first 2 bytes of header
 			temp_buffer.resize(2);
 			underlying_socket->readData(temp_buffer.data(), 2);
 
+			this->header_fin = (temp_buffer[0] & 0x80) != 0; // FIN bit.  Set on the final frame of a message.
+			const bool rsv1 = (temp_buffer[0] & 0x40) != 0; // RSV1 bit.  Set on the first frame of a compressed message with permessage-deflate.
 			this->header_opcode = temp_buffer[0] & 0xF; // Opcode.  4 bits
 			const uint32 mask = temp_buffer[1] & 0x80; // Mask bit.  Defines whether the "Payload data" is masked.
 			this->payload_len = temp_buffer[1] & 0x7F; // Payload length.  7 bits.
@@ -174,6 +290,18 @@ void WebSocket::readTo(void* buffer, size_t readlen, FractionListener* frac)
 			this->payload_remaining = payload_len;
 			this->payload_i = 0;
 
+			if(rsv1)
+			{
+				if(!inflate_stream)
+					throw MySocketExcep("Received compressed websocket frame, but permessage-deflate was not negotiated");
+				if(header_opcode != 0x1 && header_opcode != 0x2) // "the "Per-Message Compressed" bit ... MUST NOT be set on control frames or non-first fragments" - RFC 7692
+					throw MySocketExcep("RSV1 bit set on websocket continuation or control frame");
+			}
+
+			if(header_opcode == 0x1 || header_opcode == 0x2) // Text or binary frame: start of a new message.
+				reading_compressed_message = rsv1;
+			this->frame_compressed = (header_opcode <= 0x2) && reading_compressed_message;
+
 			need_header_read = false;
 		}
 		else
@@ -183,31 +311,26 @@ void WebSocket::readTo(void* buffer, size_t readlen, FractionListener* frac)
 			// Note that we aren't interested in the chunking of the underlying stream into messages that the websockets protocol provides.
 			// So we treat continuation frames the same as text and binary.
 
-			if(header_opcode <= 0x2) // Continuation, text or binary frame:
+			if(frame_compressed) // Compressed continuation, text or binary frame:
+			{
+				readAndInflateFramePayload(); // Inflated data is returned at the top of the loop.
+				need_header_read = true;
+			}
+			else if(header_opcode <= 0x2) // Continuation, text or binary frame:
 			{
 				// The calling code still desires amount_still_to_read bytes of data.
 				// Read that much, or the remaining payload size, whichever is less.
 				const size_t payload_len_to_read = myMin(payload_remaining, amount_still_to_read);
 
-				// Read payload_len_to_read bytes from the underlying sock, unmask, and write to buffer.
-				// Do this in chunks of max length 2048 bytes.
-				size_t offset = 0;
-				while(offset < payload_len_to_read)
-				{
-					const size_t chunk_size = myMin<size_t>(2048ull, payload_len_to_read - offset);
-					
-					temp_buffer.resizeNoCopy(chunk_size);
-					underlying_socket->readData(temp_buffer.data(), chunk_size);
-
-					const size_t buffer_write_i_plus_offset = buffer_write_i + offset;
-					
-					runtimeCheck(buffer_write_i_plus_offset + chunk_size <= readlen);
-					for(size_t z=0; z<chunk_size; ++z)
-						((uint8*)buffer)[buffer_write_i_plus_offset + z] = temp_buffer[z] ^ masking_key[(payload_i + z) % 4]; // Copy unmasked data from temp_buffer to the out-buffer.
-
-					offset += chunk_size;
-					payload_i += chunk_size;
-				}
+				// Read payload_len_to_read bytes from the underlying sock directly into the buffer, then unmask in place.
+				runtimeCheck(buffer_write_i + payload_len_to_read <= readlen);
+				uint8* const dest = (uint8*)buffer + buffer_write_i;
+				underlying_socket->readData(dest, payload_len_to_read);
+
+				if(masking_key[0] != 0 || masking_key[1] != 0 || masking_key[2] != 0 || masking_key[3] != 0)
+					unmaskData(dest, dest, payload_len_to_read, masking_key, payload_i);
+
+				payload_i += payload_len_to_read;
 
 				payload_remaining -= payload_len_to_read;
 				buffer_write_i += payload_len_to_read;
@@ -247,6 +370,73 @@ void WebSocket::readTo(void* buffer, size_t readlen, FractionListener* frac)
 }
 
 
+// Reads the whole payload of the current compressed frame, and inflates it into inflated_data.
+void WebSocket::readAndInflateFramePayload()
+{
+	assert(inflate_stream);
+
+	if(payload_len > max_inflated_message_size)
+		throw MySocketExcep("Compressed websocket frame too large: " + toString(payload_len) + " B");
+
+	compressed_data.resizeNoCopy(payload_len + sizeof(DEFLATE_SYNC_FLUSH_TAIL));
+	underlying_socket->readData(compressed_data.data(), payload_len);
+
+	if(masking_key[0] != 0 || masking_key[1] != 0 || masking_key[2] != 0 || masking_key[3] != 0)
+		unmaskData(compressed_data.data(), compressed_data.data(), payload_len, masking_key, /*key_offset=*/0);
+
+	// Append the tail that the sender removed from the end of the message.
+	size_t compressed_len = payload_len;
+	if(header_fin)
+	{
+		std::memcpy(compressed_data.data() + payload_len, DEFLATE_SYNC_FLUSH_TAIL, sizeof(DEFLATE_SYNC_FLUSH_TAIL));
+		compressed_len += sizeof(DEFLATE_SYNC_FLUSH_TAIL);
+	}
+
+	payload_remaining = 0;
+	inflated_data.resize(0);
+	inflated_data_read_i = 0;
+
+	inflate_stream->next_in = compressed_data.data();
+	inflate_stream->avail_in = (uInt)compressed_len;
+	while(1)
+	{
+		const size_t chunk_size = myMax<size_t>(4096, compressed_len * 4);
+		const size_t old_size = inflated_data.size();
+		inflated_data.resize(old_size + chunk_size);
+
+		inflate_stream->next_out = inflated_data.data() + old_size;
+		inflate_stream->avail_out = (uInt)chunk_size;
+		const int result = inflate(inflate_stream, Z_SYNC_FLUSH);
+		inflated_data.resize(old_size + (chunk_size - inflate_stream->avail_out));
+
+		cur_message_inflated_size += chunk_size - inflate_stream->avail_out;
+		if(cur_message_inflated_size > max_inflated_message_size)
+			throw MySocketExcep("Inflated websocket message too large");
+
+		if(result == Z_STREAM_END)
+		{
+			// The sender finished the deflate stream with a final block.  Start a new stream, for the rest of this payload and for following messages.
+			inflateReset(inflate_stream);
+
+			// If only the sync flush tail we appended is left, there is no more data: the tail isn't a complete block by itself, so don't inflate it.
+			if(inflate_stream->avail_in <= compressed_len - payload_len)
+				break;
+			continue;
+		}
+		else if(result == Z_BUF_ERROR) // No progress possible: all input consumed.
+			break;
+		else if(result != Z_OK)
+			throw MySocketExcep("Error while inflating websocket message");
+
+		if(inflate_stream->avail_out != 0 && inflate_stream->avail_in == 0) // If output space remains, all available output has been produced.
+			break;
+	}
+
+	if(header_fin)
+		cur_message_inflated_size = 0;
+}
+
+
 void WebSocket::ungracefulShutdown()
 {
 	underlying_socket->ungracefulShutdown();
@@ -331,49 +521,384 @@ void WebSocket::writeData(const void* data, size_t num_bytes)
 }
 
 
-// Needs to support datalen = 0 for sending close opcodes etc.
-void WebSocket::writeDataInFrame(uint8 opcode, const uint8* data, size_t datalen)
+// Writes the header for an unmasked frame with the given opcode and payload length to header, which must have space for MAX_FRAME_HEADER_SIZE bytes.
+// Returns the header size.
+static size_t makeFrameHeader(uint8* header, uint8 opcode, size_t datalen, bool compressed = false)
 {
-	uint8 frame_prefix[10];
-	frame_prefix[0] = /*fin=*/0x80 | opcode;
+	header[0] = /*fin=*/0x80 | (compressed ? /*rsv1=*/0x40 : 0) | opcode;
 
-	// Work out payload len and write header to the socket.
 	if(datalen <= 125)
 	{
-		frame_prefix[1] = (uint8)datalen;
-
-		underlying_socket->writeData(frame_prefix, 2);
+		header[1] = (uint8)datalen;
+		return 2;
 	}
-	else if(datalen <= 65536)
+	else if(datalen <= 65535)
 	{
-		frame_prefix[1] = 126;
-		frame_prefix[2] = (uint8)(datalen >> 8);
-		frame_prefix[3] = (uint8)(datalen & 0xFF);
-
-		underlying_socket->writeData(frame_prefix, 4);
+		header[1] = 126;
+		header[2] = (uint8)(datalen >> 8);
+		header[3] = (uint8)(datalen & 0xFF);
+		return 4;
 	}
 	else
 	{
-		frame_prefix[1] = 127;
+		header[1] = 127;
 		for(int i=0; i<8; ++i)
-			frame_prefix[2 + i] = (uint8)((datalen >> (8*(7 - i))) & 0xFF);
+			header[2 + i] = (uint8)((datalen >> (8*(7 - i))) & 0xFF);
+		return 10;
+	}
+}
+
 
-		underlying_socket->writeData(frame_prefix, 10);
+// Writes a frame directly to the underlying socket with a single write.  Used for control frames.
+// Needs to support datalen = 0 for sending close opcodes etc.
+void WebSocket::writeDataInFrame(uint8 opcode, const uint8* data, size_t datalen)
+{
+	js::Vector<uint8, 16> frame(MAX_FRAME_HEADER_SIZE + datalen);
+	const size_t header_size = makeFrameHeader(frame.data(), opcode, datalen);
+	if(datalen > 0)
+		std::memcpy(frame.data() + header_size, data, datalen);
+
+	underlying_socket->writeData(frame.data(), header_size + datalen);
+}
+
+
+// Replaces the payload of the current frame in buffer_out with the compressed payload.
+void WebSocket::compressCurrentFramePayload()
+{
+	assert(deflate_stream);
+
+	const size_t payload_start = cur_frame_start + MAX_FRAME_HEADER_SIZE;
+	const size_t payload_len = buffer_out.buf.size() - payload_start;
+	runtimeCheck(payload_len <= (size_t)std::numeric_limits<uInt>::max());
+
+	compressed_data.resize(0);
+	deflate_stream->next_in = buffer_out.buf.data() + payload_start;
+	deflate_stream->avail_in = (uInt)payload_len;
+	do
+	{
+		const size_t chunk_size = myMax<size_t>(1024, payload_len / 2 + 64);
+		const size_t old_size = compressed_data.size();
+		compressed_data.resize(old_size + chunk_size);
+
+		deflate_stream->next_out = compressed_data.data() + old_size;
+		deflate_stream->avail_out = (uInt)chunk_size;
+		const int result = deflate(deflate_stream, Z_SYNC_FLUSH);
+		if(result != Z_OK && result != Z_BUF_ERROR)
+			throw MySocketExcep("Error while deflating websocket message");
+
+		compressed_data.resize(old_size + (chunk_size - deflate_stream->avail_out));
 	}
+	while(deflate_stream->avail_out == 0); // If deflate filled the output buffer, there may be more output pending.
+
+	// Remove the 0x00 0x00 0xFF 0xFF tail of the sync flush.
+	runtimeCheck(compressed_data.size() >= sizeof(DEFLATE_SYNC_FLUSH_TAIL) && 
+		std::memcmp(compressed_data.data() + compressed_data.size() - sizeof(DEFLATE_SYNC_FLUSH_TAIL), DEFLATE_SYNC_FLUSH_TAIL, sizeof(DEFLATE_SYNC_FLUSH_TAIL)) == 0);
+	const size_t compressed_len = compressed_data.size() - sizeof(DEFLATE_SYNC_FLUSH_TAIL);
+
+	buffer_out.buf.resize(payload_start + compressed_len);
+	std::memcpy(buffer_out.buf.data() + payload_start, compressed_data.data(), compressed_len);
+
+	if(deflate_no_context_takeover)
+		deflateReset(deflate_stream);
+}
+
+
+void WebSocket::finishMessage()
+{
+	if(buffer_out.buf.size() == cur_frame_start)
+		return; // No data has been written for the current frame.
+
+	if(deflate_stream)
+		compressCurrentFramePayload();
+
+	uint8* const frame = buffer_out.buf.data() + cur_frame_start;
+	const size_t frame_payload_len = buffer_out.buf.size() - (cur_frame_start + MAX_FRAME_HEADER_SIZE);
+
+	uint8 header[MAX_FRAME_HEADER_SIZE];
+	const size_t header_size = makeFrameHeader(header, /*opcode (binary frame)=*/0x2, frame_payload_len, /*compressed=*/deflate_stream != NULL);
+
+	// Move the payload down so there is no gap between the header and the payload, then write the header.
+	std::memmove(frame + header_size, frame + MAX_FRAME_HEADER_SIZE, frame_payload_len);
+	std::memcpy(frame, header, header_size);
 
-	// Write payload data to the socket
+	buffer_out.buf.resize(cur_frame_start + header_size + frame_payload_len);
+	cur_frame_start = buffer_out.buf.size();
+}
+
+
+SharedWebSocketFrameRef WebSocket::makeSharedFrame(const void* data, size_t datalen)
+{
+	uint8 header[MAX_FRAME_HEADER_SIZE];
+	const size_t header_size = makeFrameHeader(header, /*opcode (binary frame)=*/0x2, datalen);
+
+	SharedWebSocketFrameRef frame = new glare::SharedImmutableArray<uint8>();
+	frame->resizeNoCopy(header_size + datalen);
+	std::memcpy(frame->data(), header, header_size);
 	if(datalen > 0)
-		underlying_socket->writeData(data, datalen);
+		std::memcpy(frame->data() + header_size, data, datalen);
+	return frame;
+}
+
+
+void WebSocket::enqueueSharedFrame(const SharedWebSocketFrameRef& frame)
+{
+	Lock lock(send_queue_mutex);
+	const bool was_empty = send_queue.empty();
+	send_queue.push_back(frame);
+
+	// Wake the owning thread if it hasn't already been woken for frames still in the queue.
+	// If the queue was non-empty, the owning thread hasn't flushed since the last notify, so will pick up this frame as well.
+	if(was_empty && send_queue_event_fd)
+		send_queue_event_fd->notify();
+}
+
+
+void WebSocket::setSendQueueEventFD(EventFD* event_fd)
+{
+	Lock lock(send_queue_mutex);
+	send_queue_event_fd = event_fd;
 }
 
 
-// Write all unflushed data written to this socket to the underlying socket.
+bool WebSocket::hasQueuedFrames()
+{
+	Lock lock(send_queue_mutex);
+	return !send_queue.empty();
+}
+
+
+void WebSocket::broadcast(const void* data, size_t datalen, const std::vector<Reference<WebSocket> >& sockets)
+{
+	SharedWebSocketFrameRef frame = makeSharedFrame(data, datalen);
+	for(size_t i=0; i<sockets.size(); ++i)
+		sockets[i]->enqueueSharedFrame(frame);
+}
+
+
+// Write all unflushed data written to this socket, and any queued shared frames, to the underlying socket.
 void WebSocket::flush()
 {
-	if(buffer_out.buf.size() > 0)
 	{
-		writeDataInFrame(/*opcode (binary frame)=*/0x2, buffer_out.buf.data(), buffer_out.buf.size());
+		Lock lock(send_queue_mutex);
+		frames_to_send.swap(send_queue);
+	}
+
+	if(!frames_to_send.empty())
+	{
+		finishMessage();
+
+		// Copy small frames into buffer_out, so they are sent with a single write along with the other messages.
+		for(size_t i=0; i<frames_to_send.size(); ++i)
+		{
+			const glare::SharedImmutableArray<uint8>& frame = *frames_to_send[i];
+			if(frame.size() >= MIN_DIRECT_WRITE_SHARED_FRAME_SIZE)
+			{
+				if(buffer_out.buf.size() > 0)
+					underlying_socket->writeData(buffer_out.buf.data(), buffer_out.buf.size());
+				buffer_out.buf.resize(0);
+
+				underlying_socket->writeData(frame.data(), frame.size());
+			}
+			else
+				buffer_out.writeData(frame.data(), frame.size());
+		}
+		frames_to_send.clear();
+
+		if(buffer_out.buf.size() > 0)
+			underlying_socket->writeData(buffer_out.buf.data(), buffer_out.buf.size());
+	}
+	else if(cur_frame_start == 0)
+	{
+		// There are no finished frames, just (possibly) the current frame.
+		// Write the header directly before the payload in the reserved space, so we don't need to move the payload.
+		if(buffer_out.buf.size() > 0)
+		{
+			if(deflate_stream)
+				compressCurrentFramePayload();
+
+			const size_t frame_payload_len = buffer_out.buf.size() - MAX_FRAME_HEADER_SIZE;
+
+			uint8 header[MAX_FRAME_HEADER_SIZE];
+			const size_t header_size = makeFrameHeader(header, /*opcode (binary frame)=*/0x2, frame_payload_len, /*compressed=*/deflate_stream != NULL);
+
+			uint8* const frame = buffer_out.buf.data() + MAX_FRAME_HEADER_SIZE - header_size;
+			std::memcpy(frame, header, header_size);
 
-		buffer_out.buf.resize(0);
+			underlying_socket->writeData(frame, header_size + frame_payload_len);
+		}
+	}
+	else
+	{
+		finishMessage();
+
+		underlying_socket->writeData(buffer_out.buf.data(), buffer_out.buf.size());
 	}
+
+	buffer_out.buf.resize(0);
+	cur_frame_start = 0;
+}
+
+
+//---------------------------------------- WebSocketDeflateParams ----------------------------------------
+
+
+struct ExtensionParam
+{
+	std::string name;
+	std::string value;
+	bool has_value;
+};
+
+struct Extension
+{
+	std::string name;
+	std::vector<ExtensionParam> params;
+};
+
+
+// Parses a Sec-WebSocket-Extensions header value, e.g. "permessage-deflate; client_max_window_bits, permessage-deflate; server_max_window_bits=10"
+// See https://datatracker.ietf.org/doc/html/rfc6455#section-9.1
+static void parseExtensions(const std::string& header_value, std::vector<Extension>& extensions_out)
+{
+	extensions_out.resize(0);
+
+	const std::vector<std::string> extension_strings = split(header_value, ',');
+	for(size_t i=0; i<extension_strings.size(); ++i)
+	{
+		const std::vector<std::string> parts = split(extension_strings[i], ';');
+		Extension extension;
+		extension.name = stripHeadAndTailWhitespace(parts[0]);
+		if(extension.name.empty())
+			continue;
+
+		for(size_t z=1; z<parts.size(); ++z)
+		{
+			ExtensionParam param;
+			const std::string::size_type equals_pos = parts[z].find('=');
+			param.has_value = equals_pos != std::string::npos;
+			param.name = stripHeadAndTailWhitespace(param.has_value ? parts[z].substr(0, equals_pos) : parts[z]);
+			if(param.has_value)
+			{
+				param.value = stripHeadAndTailWhitespace(parts[z].substr(equals_pos + 1));
+				if(param.value.size() >= 2 && param.value[0] == '"' && param.value.back() == '"') // Values may be quoted strings.
+					param.value = param.value.substr(1, param.value.size() - 2);
+			}
+			extension.params.push_back(param);
+		}
+
+		extensions_out.push_back(extension);
+	}
+}
+
+
+// Parses a window bits param value, which must be an integer in [8, 15].  Returns false if invalid.
+static bool parseWindowBits(const std::string& value, int& bits_out)
+{
+	if(value.empty() || value.size() > 2 || value[0] == '0')
+		return false;
+	int bits = 0;
+	for(size_t i=0; i<value.size(); ++i)
+	{
+		if(value[i] < '0' || value[i] > '9')
+			return false;
+		bits = bits * 10 + (value[i] - '0');
+	}
+	if(bits < 8 || bits > 15)
+		return false;
+	bits_out = bits;
+	return true;
+}
+
+
+// Parses the params of a permessage-deflate extension.  Returns false if there are unknown, duplicated or invalid params.
+// If client_max_window_bits is present without a value, client_max_window_bits_out is set to 15.
+static bool parseDeflateParams(const std::vector<ExtensionParam>& params, WebSocketDeflateParams& params_out, bool& got_server_max_window_bits_out, bool& got_client_max_window_bits_out)
+{
+	params_out = WebSocketDeflateParams();
+	params_out.enabled = true;
+	got_server_max_window_bits_out = false;
+	got_client_max_window_bits_out = false;
+
+	for(size_t i=0; i<params.size(); ++i)
+	{
+		const ExtensionParam& param = params[i];
+		if(param.name == "server_no_context_takeover")
+		{
+			if(params_out.server_no_context_takeover || param.has_value)
+				return false;
+			params_out.server_no_context_takeover = true;
+		}
+		else if(param.name == "client_no_context_takeover")
+		{
+			if(params_out.client_no_context_takeover || param.has_value)
+				return false;
+			params_out.client_no_context_takeover = true;
+		}
+		else if(param.name == "server_max_window_bits")
+		{
+			if(got_server_max_window_bits_out || !param.has_value || !parseWindowBits(param.value, params_out.server_max_window_bits))
+				return false;
+			got_server_max_window_bits_out = true;
+		}
+		else if(param.name == "client_max_window_bits")
+		{
+			if(got_client_max_window_bits_out || (param.has_value && !parseWindowBits(param.value, params_out.client_max_window_bits)))
+				return false;
+			got_client_max_window_bits_out = true;
+		}
+		else
+			return false;
+	}
+	return true;
+}
+
+
+std::string WebSocketDeflateParams::toExtensionHeaderValue() const
+{
+	std::string s = "permessage-deflate";
+	if(server_no_context_takeover)
+		s += "; server_no_context_takeover";
+	if(client_no_context_takeover)
+		s += "; client_no_context_takeover";
+	if(server_max_window_bits < 15)
+		s += "; server_max_window_bits=" + toString(server_max_window_bits);
+	if(client_max_window_bits < 15)
+		s += "; client_max_window_bits=" + toString(client_max_window_bits);
+	return s;
+}
+
+
+WebSocketDeflateParams WebSocketDeflateParams::negotiateFromClientOffers(const std::string& extensions_header_value, const WebSocketDeflateParams& server_prefs)
+{
+	if(!server_prefs.enabled)
+		return WebSocketDeflateParams();
+
+	std::vector<Extension> extensions;
+	parseExtensions(extensions_header_value, extensions);
+
+	// The client lists offers in order of preference, so accept the first one we can.
+	for(size_t i=0; i<extensions.size(); ++i)
+	{
+		if(extensions[i].name != "permessage-deflate")
+			continue;
+
+		WebSocketDeflateParams offer;
+		bool got_server_max_window_bits, got_client_max_window_bits;
+		if(!parseDeflateParams(extensions[i].params, offer, got_server_max_window_bits, got_client_max_window_bits))
+			continue; // "A server MUST decline an extension negotiation offer ... if the negotiation offer contains an extension parameter not defined for use in an offer" etc.
+
+		WebSocketDeflateParams result;
+		result.enabled = true;
+		result.server_no_context_takeover = offer.server_no_context_takeover || server_prefs.server_no_context_takeover;
+		result.client_no_context_takeover = offer.client_no_context_takeover || server_prefs.client_no_context_takeover;
+		result.server_max_window_bits = myMin(offer.server_max_window_bits, server_prefs.server_max_window_bits);
+		if(result.server_max_window_bits < 9)
+			continue; // zlib can't compress with an 8 bit window, so decline this offer.
+
+		// We can only ask the client to limit its window size if it said it supports that.
+		result.client_max_window_bits = got_client_max_window_bits ? myMin(offer.client_max_window_bits, server_prefs.client_max_window_bits) : 15;
+		return result;
+	}
+
+	return WebSocketDeflateParams();
 }
@@ -9,8 +9,43 @@ Copyright Glare Technologies Limited 2022 -
 #include "SocketInterface.h"
 #include "../utils/BufferOutStream.h"
 #include "../utils/Vector.h"
+#include "../utils/SharedImmutableArray.h"
+#include "../utils/Mutex.h"
+#include <string>
+#include <vector>
 class FractionListener;
 class EventFD;
+struct z_stream_s;
+
+
+/*=====================================================================
+WebSocketDeflateParams
+----------------------
+Parameters for the permessage-deflate extension.
+See https://datatracker.ietf.org/doc/html/rfc7692
+=====================================================================*/
+struct WebSocketDeflateParams
+{
+	WebSocketDeflateParams() : enabled(false), server_no_context_takeover(false), client_no_context_takeover(false), server_max_window_bits(15), client_max_window_bits(15) {}
+
+	bool enabled;
+	bool server_no_context_takeover; // If true, the server resets its compression context after each message.
+	bool client_no_context_takeover; // If true, the client resets its compression context after each message.
+	int server_max_window_bits; // LZ77 window size (log2) used by the server compressor.  In [9, 15].
+	int client_max_window_bits; // LZ77 window size (log2) used by the client compressor.  In [8, 15].
+
+	// Returns the value for a Sec-WebSocket-Extensions header, e.g. "permessage-deflate; server_no_context_takeover"
+	// Used by the server in the handshake response.
+	std::string toExtensionHeaderValue() const;
+
+	// Chooses the first acceptable permessage-deflate offer in a client's Sec-WebSocket-Extensions header value, combined with the server preferences.
+	// Returns params with enabled = false if there is no acceptable offer.
+	static WebSocketDeflateParams negotiateFromClientOffers(const std::string& extensions_header_value, const WebSocketDeflateParams& server_prefs);
+};
+
+
+// A complete websocket frame, built once and shared between connections that send the same message.
+typedef Reference<glare::SharedImmutableArray<uint8> > SharedWebSocketFrameRef;
 
 
 /*=====================================================================
@@ -20,6 +55,17 @@ Implements reading and writing over a websocket connection.
 See https://tools.ietf.org/html/rfc6455 for the websocket specification.
 
 The write methods append data to a local buffer, which is written to the underlying socket in the flush() method.
+Each flush() sends the buffered data as a single binary frame (message).
+To send several messages with a single write to the underlying socket, call finishMessage() after writing each message, 
+then flush() once.
+
+To send the same message to many connections, use broadcast(), or makeSharedFrame() and enqueueSharedFrame().
+The frame is built once, and each connection writes it from the shared buffer in its next flush().
+The thread that owns a connection can be woken when a frame is queued on it: set an EventFD with setSendQueueEventFD(),
+and block in readable(event_fd) instead of a read call.  When readable() returns false, read() the event_fd and call flush().
+
+If the permessage-deflate extension has been negotiated, call enableDeflate() before reading or writing any messages.
+Each message is then compressed with a per-connection zlib stream, and received compressed messages are inflated.
 =====================================================================*/
 class WebSocket final : public SocketInterface
 {
@@ -28,6 +74,16 @@ public:
 
 	virtual ~WebSocket();
 
+	// Enables permessage-deflate compression with the negotiated params.  Does nothing if params.enabled is false.
+	// is_server determines which of the server_ or client_ params apply to the messages we send.
+	// Throws MySocketExcep on failure.
+	void enableDeflate(const WebSocketDeflateParams& params, bool is_server);
+
+	bool deflateEnabled() const { return deflate_stream != NULL; }
+
+	// Reading a compressed message that inflates to more than this size throws an exception.  Guards against decompression bombs.
+	void setMaxInflatedMessageSize(size_t max_size) { max_inflated_message_size = max_size; }
+
 
 	// Calls shutdown on the socket, then closes the socket handle.
 	// This will cause the socket to return from any blocking calls.
@@ -67,6 +123,28 @@ public:
 
 	virtual void flush() override;
 
+	// Ends the current message: data written since the last flush() or finishMessage() call is made into a complete binary frame.
+	// The frame is not written to the underlying socket until flush() is called, so many small messages can be coalesced into one socket write.
+	void finishMessage();
+
+	// Makes a complete unmasked, uncompressed binary frame containing the message, for sending on server-side connections with enqueueSharedFrame().
+	static SharedWebSocketFrameRef makeSharedFrame(const void* data, size_t datalen);
+
+	// Adds a frame to the send queue of this connection.  Queued frames are written in the next flush() call, after any data written with write().
+	// Threadsafe, so may be called from threads other than the one that reads from and flushes this socket.
+	// The frame is not compressed even if permessage-deflate is enabled, which is allowed since compression is per-message.
+	// If the send queue was empty, notifies the event_fd set with setSendQueueEventFD(), if any.
+	void enqueueSharedFrame(const SharedWebSocketFrameRef& frame);
+
+	bool hasQueuedFrames();
+
+	// Sets an event_fd to notify when a frame is added to the empty send queue, so the owning thread can wake up and flush().  Can be NULL.
+	// event_fd must outlive this socket, or be unset first.
+	void setSendQueueEventFD(EventFD* event_fd);
+
+	// Builds a frame for the message once, and enqueues it on each of the sockets.  flush() still needs to be called on each socket.
+	static void broadcast(const void* data, size_t datalen, const std::vector<Reference<WebSocket> >& sockets);
+
 
 	void readTo(void* buffer, size_t numbytes);
 	void readTo(void* buffer, size_t numbytes, FractionListener* frac);
@@ -96,8 +174,11 @@ private:
 	WebSocket& operator = (const WebSocket& other);
 
 	void writeDataInFrame(uint8 opcode, const uint8* data, size_t datalen);
+	void compressCurrentFramePayload();
+	void readAndInflateFramePayload();
 
-	BufferOutStream buffer_out;
+	BufferOutStream buffer_out; // Finished frames, followed by reserved space for the current frame header and the current frame payload.
+	size_t cur_frame_start; // Index in buffer_out of the start of the current (unfinished) frame.
 
 	js::Vector<uint8, 16> temp_buffer;
 
@@ -107,6 +188,24 @@ private:
 	size_t payload_remaining;
 	size_t payload_i;
 	uint32 header_opcode;
+	bool header_fin;
+	bool frame_compressed; // Is the payload of the current frame compressed?
+	bool reading_compressed_message; // Did the first frame of the current (possibly fragmented) message have the RSV1 (compressed) bit set?
+
+	// permessage-deflate state
+	z_stream_s* deflate_stream;
+	z_stream_s* inflate_stream;
+	bool deflate_no_context_takeover;
+	js::Vector<uint8, 16> compressed_data; // Deflate output when writing, compressed frame payload when reading.
+	js::Vector<uint8, 16> inflated_data; // Inflated data from the current compressed frame, not yet returned from readTo().
+	size_t inflated_data_read_i;
+	size_t cur_message_inflated_size;
+	size_t max_inflated_message_size;
+
+	Mutex send_queue_mutex;
+	std::vector<SharedWebSocketFrameRef> send_queue		GUARDED_BY(send_queue_mutex);
+	EventFD* send_queue_event_fd						GUARDED_BY(send_queue_mutex);
+	std::vector<SharedWebSocketFrameRef> frames_to_send; // send_queue is swapped into this in flush(), so the mutex isn't held while writing.
 
 	SocketInterfaceRef underlying_socket;
 };
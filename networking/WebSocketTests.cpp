@@ -14,11 +14,16 @@ Copyright Glare Technologies Limited 2022 -
 #include "MyThread.h"
 #include "Networking.h"
 #include "../utils/TestUtils.h"
+#include "../utils/TestExceptionUtils.h"
 #include "../utils/ConPrint.h"
 #include "../utils/StringUtils.h"
 #include "../utils/PlatformUtils.h"
 #include "../utils/SocketBufferOutStream.h"
+#include "../utils/Timer.h"
+#include "../utils/EventFD.h"
+#include "../maths/PCG32.h"
 #include <cstring>
+#include <zlib.h>
 #include <ContainerUtils.h>
 
 
@@ -115,7 +120,7 @@ static WebSocketRef makeWebSocketWithFramesWithPayloadLenN(size_t n, bool maskin
 	{
 		appendByte(query, mask_bit | (uint8)n); // Mask bit | payload len
 	}
-	else if(n <= 65536)
+	else if(n <= 65535)
 	{
 		appendByte(query, mask_bit | (uint8)126); // Mask bit | payload len
 		appendByte(query, (uint8)(n >> 8));
@@ -163,6 +168,53 @@ static WebSocketRef makeWebSocketWithFramesWithPayloadLenN(size_t n, bool maskin
 
 
 
+static size_t frameHeaderSize(size_t payload_len)
+{
+	if(payload_len <= 125)
+		return 2;
+	else if(payload_len <= 65535)
+		return 4;
+	else
+		return 10;
+}
+
+
+// Compresses s as a raw deflate stream, finishing with the given flush mode.
+static std::vector<uint8> rawDeflate(const std::string& s, int flush)
+{
+	z_stream stream;
+	std::memset(&stream, 0, sizeof(stream));
+	testAssert(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, /*window bits (negative for raw deflate)=*/-15, /*mem level=*/8, Z_DEFAULT_STRATEGY) == Z_OK);
+
+	std::vector<uint8> compressed(deflateBound(&stream, (uLong)s.size()) + 16);
+	stream.next_in = (Bytef*)s.data();
+	stream.avail_in = (uInt)s.size();
+	stream.next_out = compressed.data();
+	stream.avail_out = (uInt)compressed.size();
+	const int result = deflate(&stream, flush);
+	testAssert(result == ((flush == Z_FINISH) ? Z_STREAM_END : Z_OK));
+	compressed.resize(compressed.size() - stream.avail_out);
+	deflateEnd(&stream);
+	return compressed;
+}
+
+
+// Reads num_bytes of payload data from the frames in the given buffers, using a WebSocket.
+// If deflate_params is enabled, the frames are read as a client with permessage-deflate enabled.
+static std::vector<uint8> readBackFrames(const std::vector<std::vector<uint8> >& frame_buffers, size_t num_bytes, const WebSocketDeflateParams& deflate_params = WebSocketDeflateParams())
+{
+	TestSocketRef test_socket = new TestSocket();
+	for(size_t i=0; i<frame_buffers.size(); ++i)
+		test_socket->buffers.push_back(frame_buffers[i]);
+
+	WebSocketRef web_socket = new WebSocket(test_socket);
+	web_socket->enableDeflate(deflate_params, /*is_server=*/false);
+	std::vector<uint8> data(num_bytes);
+	web_socket->readData(data.data(), num_bytes);
+	return data;
+}
+
+
 void WebSocketTests::test()
 {
 	conPrint("WebSocketTests::test()");
@@ -370,13 +422,7 @@ void WebSocketTests::test()
 			web_socket->flush();
 			web_socket->flush(); // Test flush again with no pending data.
 
-			size_t header_size;
-			if(n <= 125)
-				header_size = 2;
-			else if(n <= 65536)
-				header_size = 4;
-			else
-				header_size = 10;
+			const size_t header_size = frameHeaderSize(n);
 
 			if(n == 0)
 			{
@@ -384,19 +430,576 @@ void WebSocketTests::test()
 			}
 			else
 			{
-				testAssert(test_socket->dest_buffers.size() == 2);
+				testAssert(test_socket->dest_buffers.size() == 1); // Header and payload should be written with a single write.
 
-				const std::vector<uint8>& header_buf = test_socket->dest_buffers[0];
-				testAssert(header_buf.size() == header_size);
+				const std::vector<uint8>& frame_buf = test_socket->dest_buffers[0];
+				testAssert(frame_buf.size() == header_size + n);
+				testAssert(frame_buf[0] == (0x80 | 0x2)); // Fin | binary opcode
 
-				const std::vector<uint8>& payload_buf = test_socket->dest_buffers[1];
-				testAssert((int)payload_buf.size() == n);
 				for(int i=0; i<n; ++i)
-					testAssert(payload_buf[i] == i % fill_pattern_modulus);
+					testAssert(frame_buf[header_size + i] == i % fill_pattern_modulus);
 			}
 		}
 	}
 
+	// Test payload lengths around the header size boundaries, and check the frames can be read back.
+	{
+		const size_t lens[] = { 1, 125, 126, 65535, 65536, 65537 };
+		for(size_t z=0; z<staticArrayNumElems(lens); ++z)
+		{
+			const size_t n = lens[z];
+			std::vector<uint8> data(n);
+			for(size_t i=0; i<n; ++i)
+				data[i] = (uint8)(i % fill_pattern_modulus);
+
+			TestSocketRef test_socket = new TestSocket();
+			WebSocketRef web_socket = new WebSocket(test_socket);
+			web_socket->writeData(data.data(), data.size());
+			web_socket->flush();
+
+			testAssert(test_socket->dest_buffers.size() == 1);
+			testAssert(test_socket->dest_buffers[0].size() == frameHeaderSize(n) + n);
+
+			testAssert(readBackFrames(test_socket->dest_buffers, n) == data);
+		}
+	}
+
+	//--------------------------- Test batched writes ------------------------------
+	{
+		TestSocketRef test_socket = new TestSocket();
+		WebSocketRef web_socket = new WebSocket(test_socket);
+
+		std::vector<uint8> expected;
+		std::vector<size_t> message_lens;
+		for(size_t n=0; n<300; n += 7)
+		{
+			std::vector<uint8> data(n);
+			for(size_t i=0; i<n; ++i)
+				data[i] = (uint8)((n + i) % fill_pattern_modulus);
+
+			// Write each message in two parts, to check the parts end up in the same frame.
+			web_socket->writeData(data.data(), n / 2);
+			web_socket->writeData(data.data() + n / 2, n - n / 2);
+			web_socket->finishMessage();
+			web_socket->finishMessage(); // Test finishMessage() with no data written, shouldn't write an empty frame.
+
+			if(n > 0)
+				message_lens.push_back(n);
+			ContainerUtils::append(expected, data);
+		}
+
+		testAssert(test_socket->dest_buffers.size() == 0); // Nothing should be written until flush()
+		web_socket->flush();
+		testAssert(test_socket->dest_buffers.size() == 1); // All messages should be written with a single write.
+
+		// Check the frame boundaries
+		const std::vector<uint8>& buf = test_socket->dest_buffers[0];
+		size_t frame_start = 0;
+		for(size_t i=0; i<message_lens.size(); ++i)
+		{
+			testAssert(frame_start + 2 <= buf.size());
+			testAssert(buf[frame_start] == (0x80 | 0x2)); // Fin | binary opcode
+			testAssert((buf[frame_start + 1] & 0x7F) == (message_lens[i] <= 125 ? message_lens[i] : 126));
+			frame_start += frameHeaderSize(message_lens[i]) + message_lens[i];
+		}
+		testAssert(frame_start == buf.size());
+
+		testAssert(readBackFrames(test_socket->dest_buffers, expected.size()) == expected);
+
+		// Test mixing finishMessage() and a final unfinished message
+		test_socket->dest_buffers.clear();
+		const uint8 a[] = { 1, 2, 3 };
+		const uint8 b[] = { 4, 5 };
+		web_socket->writeData(a, sizeof(a));
+		web_socket->finishMessage();
+		web_socket->writeData(b, sizeof(b));
+		web_socket->flush();
+		testAssert(test_socket->dest_buffers.size() == 1);
+		testAssert(test_socket->dest_buffers[0].size() == 2 + sizeof(a) + 2 + sizeof(b));
+		testAssert(readBackFrames(test_socket->dest_buffers, 5) == std::vector<uint8>({ 1, 2, 3, 4, 5 }));
+	}
+
+
+	//--------------------------- Test permessage-deflate negotiation ------------------------------
+	{
+		WebSocketDeflateParams server_prefs;
+		server_prefs.enabled = true;
+
+		// Typical browser offer
+		WebSocketDeflateParams params = WebSocketDeflateParams::negotiateFromClientOffers("permessage-deflate; client_max_window_bits", server_prefs);
+		testAssert(params.enabled && !params.server_no_context_takeover && !params.client_no_context_takeover && params.server_max_window_bits == 15 && params.client_max_window_bits == 15);
+		testAssert(params.toExtensionHeaderValue() == "permessage-deflate");
+
+		// Server not accepting the extension
+		testAssert(!WebSocketDeflateParams::negotiateFromClientOffers("permessage-deflate; client_max_window_bits", WebSocketDeflateParams()).enabled);
+		testAssert(!WebSocketDeflateParams::negotiateFromClientOffers("", server_prefs).enabled);
+		testAssert(!WebSocketDeflateParams::negotiateFromClientOffers("x-webkit-deflate-frame", server_prefs).enabled);
+
+		// Client limiting the server window size, and asking for no context takeover
+		params = WebSocketDeflateParams::negotiateFromClientOffers("x-webkit-deflate-frame, permessage-deflate; server_no_context_takeover; server_max_window_bits=10", server_prefs);
+		testAssert(params.enabled && params.server_no_context_takeover && params.server_max_window_bits == 10 && params.client_max_window_bits == 15);
+		testAssert(params.toExtensionHeaderValue() == "permessage-deflate; server_no_context_takeover; server_max_window_bits=10");
+		params = WebSocketDeflateParams::negotiateFromClientOffers("permessage-deflate;server_max_window_bits=\"11\"", server_prefs);
+		testAssert(params.enabled && params.server_max_window_bits == 11);
+
+		// Invalid offers should be declined, falling back to later offers if present.
+		const char* invalid_offers[] = { "permessage-deflate; foo", "permessage-deflate; server_no_context_takeover; server_no_context_takeover", "permessage-deflate; server_max_window_bits",
+			"permessage-deflate; server_max_window_bits=16", "permessage-deflate; server_max_window_bits=7", "permessage-deflate; client_max_window_bits=abc", "permessage-deflate; server_no_context_takeover=1",
+			"permessage-deflate; server_max_window_bits=8" /* zlib can't compress with an 8 bit window */ };
+		for(size_t i=0; i<staticArrayNumElems(invalid_offers); ++i)
+		{
+			testAssert(!WebSocketDeflateParams::negotiateFromClientOffers(invalid_offers[i], server_prefs).enabled);
+			params = WebSocketDeflateParams::negotiateFromClientOffers(std::string(invalid_offers[i]) + ", permessage-deflate; client_no_context_takeover", server_prefs);
+			testAssert(params.enabled && params.client_no_context_takeover && params.server_max_window_bits == 15);
+		}
+
+		// Server preferences.  The server can only limit the client window size if the client offered client_max_window_bits.
+		server_prefs.server_no_context_takeover = true;
+		server_prefs.client_no_context_takeover = true;
+		server_prefs.server_max_window_bits = 12;
+		server_prefs.client_max_window_bits = 10;
+		params = WebSocketDeflateParams::negotiateFromClientOffers("permessage-deflate; client_max_window_bits", server_prefs);
+		testAssert(params.enabled && params.server_no_context_takeover && params.client_no_context_takeover && params.server_max_window_bits == 12 && params.client_max_window_bits == 10);
+		testAssert(params.toExtensionHeaderValue() == "permessage-deflate; server_no_context_takeover; client_no_context_takeover; server_max_window_bits=12; client_max_window_bits=10");
+		params = WebSocketDeflateParams::negotiateFromClientOffers("permessage-deflate; client_max_window_bits=9", server_prefs);
+		testAssert(params.client_max_window_bits == 9);
+		params = WebSocketDeflateParams::negotiateFromClientOffers("permessage-deflate", server_prefs);
+		testAssert(params.enabled && params.client_max_window_bits == 15);
+	}
+
+	//--------------------------- Test reading compressed messages ------------------------------
+	{
+		WebSocketDeflateParams params;
+		params.enabled = true;
+
+		// Examples from RFC 7692 section 7.2.3.
+		// A message containing "Hello" in a single compressed frame.
+		const std::vector<uint8> hello_frame({ 0xc1, 0x07, 0xf2, 0x48, 0xcd, 0xc9, 0xc9, 0x07, 0x00 });
+		testAssert(readBackFrames({ hello_frame }, 5, params) == std::vector<uint8>({ 'H', 'e', 'l', 'l', 'o' }));
+
+		// Compressed and fragmented.  Only the first frame has the RSV1 bit set.
+		testAssert(readBackFrames({ { 0x41, 0x03, 0xf2, 0x48, 0xcd }, { 0x80, 0x04, 0xc9, 0xc9, 0x07, 0x00 } }, 5, params) == std::vector<uint8>({ 'H', 'e', 'l', 'l', 'o' }));
+
+		// A second message using the context (LZ77 window) of the first message.
+		testAssert(readBackFrames({ hello_frame, { 0xc1, 0x05, 0xf2, 0x00, 0x11, 0x00, 0x00 } }, 10, params) == std::vector<uint8>({ 'H', 'e', 'l', 'l', 'o', 'H', 'e', 'l', 'l', 'o' }));
+
+		// Masked, and interleaved with a ping frame, read with a single byte at a time.
+		{
+			std::vector<uint8> frame({ 0xc1, 0x87, 1, 2, 3, 4 });
+			for(size_t i=2; i<hello_frame.size(); ++i)
+				frame.push_back(hello_frame[i] ^ (uint8)(1 + (i - 2) % 4));
+
+			TestSocketRef test_socket = new TestSocket();
+			test_socket->buffers.push_back({ 0x41, 0x03, 0xf2, 0x48, 0xcd });
+			test_socket->buffers.push_back({ 0x89, 0x00 }); // Ping
+			test_socket->buffers.push_back({ 0x80, 0x04, 0xc9, 0xc9, 0x07, 0x00 });
+			test_socket->buffers.push_back(frame);
+			WebSocketRef web_socket = new WebSocket(test_socket);
+			web_socket->enableDeflate(params, /*is_server=*/true);
+
+			std::string s;
+			for(int i=0; i<10; ++i)
+			{
+				char c;
+				web_socket->readData(&c, 1);
+				s.push_back(c);
+			}
+			testAssert(s == "HelloHello");
+		}
+
+		// Compressed frames are an error if the extension wasn't negotiated, and RSV1 isn't allowed on continuation frames.
+		testThrowsExcepContainingString([&]() { readBackFrames({ hello_frame }, 5); }, "not negotiated");
+		testThrowsExcepContainingString([&]() { readBackFrames({ { 0x01, 0x01, 'a' }, { 0xc0, 0x07, 0xf2, 0x48, 0xcd, 0xc9, 0xc9, 0x07, 0x00 } }, 6, params); }, "RSV1");
+
+		// Uncompressed messages may be sent when the extension is enabled.
+		testAssert(readBackFrames({ { 0x82, 0x02, 'a', 'b' }, hello_frame }, 7, params) == std::vector<uint8>({ 'a', 'b', 'H', 'e', 'l', 'l', 'o' }));
+
+		// A message with a final (BFINAL) deflate block, followed by a new deflate stream in the same message, then another message.
+		// All of the data after the final block should be inflated.
+		{
+			std::vector<uint8> frame({ 0xc1, 0 });
+			ContainerUtils::append(frame, rawDeflate("Hello", Z_FINISH));
+			std::vector<uint8> world = rawDeflate("World", Z_SYNC_FLUSH);
+			world.resize(world.size() - 4); // Remove the 0x00 0x00 0xff 0xff sync flush tail.
+			ContainerUtils::append(frame, world);
+			frame[1] = (uint8)(frame.size() - 2);
+			testAssert(readBackFrames({ frame, hello_frame }, 15, params) == std::vector<uint8>({ 'H', 'e', 'l', 'l', 'o', 'W', 'o', 'r', 'l', 'd', 'H', 'e', 'l', 'l', 'o' }));
+
+			// Just a final block.
+			frame = { 0xc1, 0 };
+			ContainerUtils::append(frame, rawDeflate("World", Z_FINISH));
+			frame[1] = (uint8)(frame.size() - 2);
+			testAssert(readBackFrames({ frame, hello_frame }, 10, params) == std::vector<uint8>({ 'W', 'o', 'r', 'l', 'd', 'H', 'e', 'l', 'l', 'o' }));
+		}
+	}
+
+	//--------------------------- Test compressed writes ------------------------------
+	for(int no_context_takeover=0; no_context_takeover<2; ++no_context_takeover)
+	{
+		WebSocketDeflateParams params;
+		params.enabled = true;
+		params.server_no_context_takeover = no_context_takeover != 0;
+
+		TestSocketRef test_socket = new TestSocket();
+		WebSocketRef web_socket = new WebSocket(test_socket);
+		web_socket->enableDeflate(params, /*is_server=*/true);
+		testAssert(web_socket->deflateEnabled());
+
+		// Write some JSON-like object updates, as well as some large messages.
+		std::vector<uint8> expected;
+		size_t num_messages = 0;
+		for(int i=0; i<1000; ++i)
+		{
+			const std::string msg = "{\"type\": \"ObjectTransformUpdate\", \"uid\": " + toString(1000 + i % 37) + ", \"pos\": [" + toString(i * 0.25) + ", " + toString(12.5 + i % 7) + ", 1.75], \"rot\": [0, 0, 1, " + 
+				toString(i % 360) + "], \"name\": \"object_" + toString(i % 37) + "\"}";
+			web_socket->writeData(msg.data(), msg.size());
+			ContainerUtils::append(expected, std::vector<uint8>(msg.begin(), msg.end()));
+			num_messages++;
+
+			if(i % 100 == 50)
+			{
+				// Large, poorly compressible message, so the deflate output needs several chunks.
+				std::vector<uint8> data(100000);
+				PCG32 rng(i);
+				for(size_t z=0; z<data.size(); ++z)
+					data[z] = (uint8)rng.nextUInt(256);
+				web_socket->finishMessage();
+				web_socket->writeData(data.data(), data.size());
+				ContainerUtils::append(expected, data);
+				num_messages++;
+			}
+
+			if(i % 10 == 9)
+				web_socket->flush();
+			else
+				web_socket->finishMessage();
+		}
+		web_socket->flush();
+
+		// Check each frame has the RSV1 bit set.
+		size_t num_frames = 0;
+		size_t total_compressed_size = 0;
+		for(size_t i=0; i<test_socket->dest_buffers.size(); ++i)
+		{
+			const std::vector<uint8>& buf = test_socket->dest_buffers[i];
+			total_compressed_size += buf.size();
+			size_t frame_start = 0;
+			while(frame_start < buf.size())
+			{
+				testAssert(buf[frame_start] == (0x80 | 0x40 | 0x2)); // Fin | RSV1 | binary opcode
+				const uint8 len7 = buf[frame_start + 1] & 0x7F;
+				size_t payload_len = len7;
+				if(len7 == 126)
+					payload_len = ((size_t)buf[frame_start + 2] << 8) | buf[frame_start + 3];
+				else if(len7 == 127)
+				{
+					payload_len = 0;
+					for(int z=0; z<8; ++z)
+						payload_len = (payload_len << 8) | buf[frame_start + 2 + z];
+				}
+				frame_start += frameHeaderSize(payload_len) + payload_len;
+				num_frames++;
+			}
+			testAssert(frame_start == buf.size());
+		}
+		testAssert(num_frames == num_messages);
+
+		testAssert(readBackFrames(test_socket->dest_buffers, expected.size(), params) == expected);
+
+		// Check the JSON-like messages on their own
+		test_socket->dest_buffers.clear();
+		size_t json_size = 0;
+		for(int i=0; i<1000; ++i)
+		{
+			const std::string msg = "{\"type\": \"ObjectTransformUpdate\", \"uid\": " + toString(1000 + i % 37) + ", \"pos\": [" + toString(i * 0.25) + ", 13.5, 1.75], \"rot\": [0, 0, 1, " + toString(i % 360) + "]}";
+			web_socket->writeData(msg.data(), msg.size());
+			web_socket->flush();
+			json_size += msg.size() + 2;
+		}
+		size_t compressed_json_size = 0;
+		for(size_t i=0; i<test_socket->dest_buffers.size(); ++i)
+			compressed_json_size += test_socket->dest_buffers[i].size();
+
+		conPrint("permessage-deflate (" + std::string(no_context_takeover ? "no context takeover" : "context takeover") + "): total frames size: " + toString(total_compressed_size) + " B for " + toString(expected.size()) + " B of data, " + 
+			"JSON-like messages: " + toString(json_size) + " B -> " + toString(compressed_json_size) + " B (" + doubleToStringNSigFigs((double)json_size / compressed_json_size, 3) + "x)");
+		if(!no_context_takeover)
+			testAssert(compressed_json_size * 3 < json_size);
+	}
+
+	// Test that a message that inflates to a very large size is rejected.
+	{
+		WebSocketDeflateParams params;
+		params.enabled = true;
+
+		TestSocketRef test_socket = new TestSocket();
+		WebSocketRef web_socket = new WebSocket(test_socket);
+		web_socket->enableDeflate(params, /*is_server=*/true);
+		const std::vector<uint8> zeroes(1 << 20, 0);
+		web_socket->writeData(zeroes.data(), zeroes.size());
+		web_socket->flush();
+		testAssert(test_socket->dest_buffers.size() == 1 && test_socket->dest_buffers[0].size() < 2000);
+
+		TestSocketRef read_test_socket = new TestSocket();
+		read_test_socket->buffers.push_back(test_socket->dest_buffers[0]);
+		WebSocketRef read_web_socket = new WebSocket(read_test_socket);
+		read_web_socket->enableDeflate(params, /*is_server=*/false);
+		read_web_socket->setMaxInflatedMessageSize(100000);
+		std::vector<uint8> buf(zeroes.size());
+		testThrowsExcepContainingString([&]() { read_web_socket->readData(buf.data(), buf.size()); }, "too large");
+	}
+
+
+	//--------------------------- Test shared frames / broadcast ------------------------------
+	{
+		// Shared frames should be the same as frames written normally.
+		const size_t lens[] = { 0, 1, 125, 126, 65535, 65536 };
+		for(size_t z=0; z<staticArrayNumElems(lens); ++z)
+		{
+			const size_t n = lens[z];
+			std::vector<uint8> data(n);
+			for(size_t i=0; i<n; ++i)
+				data[i] = (uint8)(i % fill_pattern_modulus);
+
+			SharedWebSocketFrameRef frame = WebSocket::makeSharedFrame(data.data(), n);
+			testAssert(frame->size() == frameHeaderSize(n) + n);
+
+			if(n > 0)
+			{
+				TestSocketRef test_socket = new TestSocket();
+				WebSocketRef web_socket = new WebSocket(test_socket);
+				web_socket->writeData(data.data(), n);
+				web_socket->flush();
+				testAssert(test_socket->dest_buffers.size() == 1 && test_socket->dest_buffers[0] == std::vector<uint8>(frame->begin(), frame->end()));
+			}
+		}
+
+		// Queued frames are sent after locally written messages, small frames are coalesced into one write.
+		{
+			TestSocketRef test_socket = new TestSocket();
+			WebSocketRef web_socket = new WebSocket(test_socket);
+
+			const uint8 a[] = { 1, 2, 3 };
+			const uint8 b[] = { 4, 5 };
+			const uint8 c[] = { 6 };
+			web_socket->writeData(a, sizeof(a));
+			web_socket->enqueueSharedFrame(WebSocket::makeSharedFrame(b, sizeof(b)));
+			web_socket->enqueueSharedFrame(WebSocket::makeSharedFrame(c, sizeof(c)));
+			testAssert(web_socket->hasQueuedFrames());
+			testAssert(test_socket->dest_buffers.size() == 0);
+			web_socket->flush();
+			testAssert(!web_socket->hasQueuedFrames());
+			testAssert(test_socket->dest_buffers.size() == 1);
+			testAssert(readBackFrames(test_socket->dest_buffers, 6) == std::vector<uint8>({ 1, 2, 3, 4, 5, 6 }));
+
+			// Large frames are written directly from the shared buffer.
+			test_socket->dest_buffers.clear();
+			const std::vector<uint8> large(100000, 7);
+			web_socket->enqueueSharedFrame(WebSocket::makeSharedFrame(a, sizeof(a)));
+			web_socket->enqueueSharedFrame(WebSocket::makeSharedFrame(large.data(), large.size()));
+			web_socket->enqueueSharedFrame(WebSocket::makeSharedFrame(b, sizeof(b)));
+			web_socket->flush();
+			testAssert(test_socket->dest_buffers.size() == 3);
+			testAssert(test_socket->dest_buffers[1].size() == frameHeaderSize(large.size()) + large.size());
+			std::vector<uint8> expected(a, a + sizeof(a));
+			ContainerUtils::append(expected, large);
+			expected.push_back(4);
+			expected.push_back(5);
+			testAssert(readBackFrames(test_socket->dest_buffers, expected.size()) == expected);
+		}
+
+#if !defined(_WIN32) && !defined(__APPLE__) && !defined(EMSCRIPTEN)
+		// Enqueueing a frame on an empty send queue notifies the send queue event_fd, so the owning thread wakes up.
+		{
+			TestSocketRef test_socket = new TestSocket();
+			WebSocketRef web_socket = new WebSocket(test_socket);
+			EventFD event_fd;
+			web_socket->setSendQueueEventFD(&event_fd);
+
+			const uint8 a[] = { 1, 2, 3 };
+			web_socket->enqueueSharedFrame(WebSocket::makeSharedFrame(a, sizeof(a)));
+			web_socket->enqueueSharedFrame(WebSocket::makeSharedFrame(a, sizeof(a)));
+			testAssert(event_fd.read() == 1); // Only the first frame should have notified.
+			web_socket->flush();
+
+			// Enqueue from another thread, while this thread blocks waiting on the event_fd.
+			class EnqueueThread : public MyThread
+			{
+			public:
+				virtual void run() { PlatformUtils::Sleep(10); socket->enqueueSharedFrame(frame); }
+				WebSocketRef socket;
+				SharedWebSocketFrameRef frame;
+			};
+			Reference<EnqueueThread> thread = new EnqueueThread();
+			thread->socket = web_socket;
+			thread->frame = WebSocket::makeSharedFrame(a, sizeof(a));
+			thread->launch();
+			testAssert(event_fd.read() == 1);
+			thread->join();
+			web_socket->flush();
+			testAssert(readBackFrames(test_socket->dest_buffers, 9) == std::vector<uint8>({ 1, 2, 3, 1, 2, 3, 1, 2, 3 }));
+
+			web_socket->setSendQueueEventFD(NULL);
+		}
+#endif
+
+		// Shared frames are sent uncompressed on connections with permessage-deflate enabled.
+		{
+			WebSocketDeflateParams params;
+			params.enabled = true;
+
+			TestSocketRef test_socket = new TestSocket();
+			WebSocketRef web_socket = new WebSocket(test_socket);
+			web_socket->enableDeflate(params, /*is_server=*/true);
+			const std::string msg_a = "compressed compressed compressed";
+			const std::string msg_b = "not compressed";
+			web_socket->writeData(msg_a.data(), msg_a.size());
+			web_socket->enqueueSharedFrame(WebSocket::makeSharedFrame(msg_b.data(), msg_b.size()));
+			web_socket->flush();
+			web_socket->writeData(msg_a.data(), msg_a.size());
+			web_socket->flush();
+
+			testAssert(test_socket->dest_buffers.size() == 2);
+			const std::vector<uint8> read_data = readBackFrames(test_socket->dest_buffers, msg_a.size() * 2 + msg_b.size(), params);
+			testAssert(std::string(read_data.begin(), read_data.end()) == msg_a + msg_b + msg_a);
+		}
+	}
+
+	//--------------------------- Benchmark broadcasting a message to many connections ------------------------------
+	{
+		const size_t num_connections = 1000;
+		std::string msg;
+		for(int i=0; msg.size() < 2000; ++i)
+			msg += "{\"type\": \"ObjectTransformUpdate\", \"uid\": " + toString(1000 + i) + ", \"pos\": [" + toString(i * 0.25) + ", 13.5, 1.75]}";
+
+		for(int use_deflate=0; use_deflate<2; ++use_deflate)
+		{
+			WebSocketDeflateParams params;
+			params.enabled = use_deflate != 0;
+
+			std::vector<TestSocketRef> test_sockets(num_connections);
+			std::vector<WebSocketRef> sockets(num_connections);
+			for(size_t i=0; i<num_connections; ++i)
+			{
+				test_sockets[i] = new TestSocket();
+				sockets[i] = new WebSocket(test_sockets[i]);
+				sockets[i]->enableDeflate(params, /*is_server=*/true);
+			}
+
+			const int num_iters = 10;
+
+			// Write the message to each connection separately: framed (and compressed if deflate is enabled) once per connection.
+			Timer timer;
+			for(int z=0; z<num_iters; ++z)
+				for(size_t i=0; i<num_connections; ++i)
+				{
+					sockets[i]->writeData(msg.data(), msg.size());
+					sockets[i]->flush();
+				}
+			const double per_connection_elapsed = timer.elapsed() / num_iters;
+
+			for(size_t i=0; i<num_connections; ++i)
+				test_sockets[i]->dest_buffers.clear();
+
+			// Broadcast: the frame is built once.
+			timer.reset();
+			for(int z=0; z<num_iters; ++z)
+			{
+				WebSocket::broadcast(msg.data(), msg.size(), sockets);
+				for(size_t i=0; i<num_connections; ++i)
+					sockets[i]->flush();
+			}
+			const double broadcast_elapsed = timer.elapsed() / num_iters;
+
+			for(size_t i=0; i<num_connections; ++i)
+			{
+				testAssert(test_sockets[i]->dest_buffers.size() == num_iters);
+				testAssert(test_sockets[i]->dest_buffers[0].size() == frameHeaderSize(msg.size()) + msg.size());
+			}
+			const std::vector<uint8> read_data = readBackFrames({ test_sockets[num_connections - 1]->dest_buffers[0] }, msg.size(), params);
+			testAssert(std::string(read_data.begin(), read_data.end()) == msg);
+
+			conPrint("Sending a " + toString(msg.size()) + " B message to " + toString(num_connections) + " connections" + (use_deflate ? " (permessage-deflate)" : "") + ": per connection: " + 
+				doubleToStringNSigFigs(per_connection_elapsed * 1.0e3, 4) + " ms, broadcast: " + doubleToStringNSigFigs(broadcast_elapsed * 1.0e3, 4) + " ms");
+		}
+	}
+
+
+	//--------------------------- Benchmark unmasking ------------------------------
+	{
+		const size_t N = 1 << 20;
+		const int num_frames = 64;
+		WebSocketRef sock = makeWebSocketWithFramesWithPayloadLenN(N, /*masking=*/true, num_frames, fill_pattern_modulus);
+
+		std::vector<uint8> buffer(N);
+		Timer timer;
+		for(int i=0; i<num_frames; ++i)
+			sock->readData(buffer.data(), N);
+		const double elapsed = timer.elapsed();
+
+		for(size_t i = 0; i < buffer.size(); ++i)
+			testAssert(buffer[i] == ((i % fill_pattern_modulus) ^ (i % 4)));
+
+		// Compare against the byte-at-a-time unmasking loop on the same data, without the socket reads.
+		std::vector<uint8> masked(N);
+		for(size_t i=0; i<N; ++i)
+			masked[i] = (uint8)(i % fill_pattern_modulus);
+		const uint8 masking_key[4] = { 0, 1, 2, 3 };
+		timer.reset();
+		for(int i=0; i<num_frames; ++i)
+			for(size_t z=0; z<N; ++z)
+				buffer[z] = masked[z] ^ masking_key[z % 4];
+		const double scalar_elapsed = timer.elapsed();
+		testAssert(buffer[N - 1] == ((N - 1) % fill_pattern_modulus ^ ((N - 1) % 4)));
+
+		const double total_MB = (double)N * num_frames / (1 << 20);
+		conPrint("Masked frame read: " + doubleToStringNSigFigs(total_MB / elapsed, 4) + " MB/s (including test socket reads), byte-at-a-time unmask alone: " + 
+			doubleToStringNSigFigs(total_MB / scalar_elapsed, 4) + " MB/s");
+	}
+
+	//--------------------------- Benchmark batched writes of small messages ------------------------------
+	{
+		const int num_messages = 100000;
+		const uint8 message[32] = { 0 };
+
+		TestSocketRef test_socket = new TestSocket();
+		WebSocketRef web_socket = new WebSocket(test_socket);
+
+		// Flush after each message: one socket write per message.
+		Timer timer;
+		for(int i=0; i<num_messages; ++i)
+		{
+			web_socket->writeData(message, sizeof(message));
+			web_socket->flush();
+		}
+		const double unbatched_elapsed = timer.elapsed();
+		const size_t unbatched_num_writes = test_socket->dest_buffers.size();
+		test_socket->dest_buffers.clear();
+
+		// Batch 100 messages per flush.
+		timer.reset();
+		for(int i=0; i<num_messages; ++i)
+		{
+			web_socket->writeData(message, sizeof(message));
+			if(i % 100 == 99)
+				web_socket->flush();
+			else
+				web_socket->finishMessage();
+		}
+		web_socket->flush();
+		const double batched_elapsed = timer.elapsed();
+		const size_t batched_num_writes = test_socket->dest_buffers.size();
+
+		testAssert(unbatched_num_writes == num_messages);
+		testAssert(batched_num_writes == num_messages / 100);
+		size_t total_size = 0;
+		for(size_t i=0; i<test_socket->dest_buffers.size(); ++i)
+			total_size += test_socket->dest_buffers[i].size();
+		testAssert(total_size == num_messages * (2 + sizeof(message)));
+
+		conPrint("Writing " + toString(num_messages) + " 32 B messages: unbatched: " + toString(unbatched_num_writes) + " socket writes, " + doubleToStringNSigFigs(unbatched_elapsed * 1.0e3, 4) + 
+			" ms, batched: " + toString(batched_num_writes) + " socket writes, " + doubleToStringNSigFigs(batched_elapsed * 1.0e3, 4) + " ms");
+	}
+
 
 	conPrint("WebSocketTests::test(): done.");
 }
@@ -14,6 +14,7 @@ Copyright Glare Technologies Limited 2026 -
 #include "VAO.h"
 #include "VBO.h"
 #include "VertexBufferAllocator.h"
+#include "../graphics/GaussianSplatChunks.h"
 #include "../maths/Matrix4f.h"
 #include "../maths/mathstypes.h"
 #include "../utils/ArrayRef.h"
@@ -27,6 +28,7 @@ Copyright Glare Technologies Limited 2026 -
 #include "../utils/TaskManager.h"
 #include "../utils/ThreadSafeRefCounted.h"
 #include "../utils/Vector.h"
+#include <algorithm>
 #include <assert.h>
 #include <cstring>
 #include <limits>
@@ -41,20 +43,49 @@ Copyright Glare Technologies Limited 2026 -
 static const float min_resort_move_threshold_ws = 0.1f;
 static const float resort_threshold_dist_fraction = 0.05f;
 
+// Range of the number of high key bits the incremental sort buckets on - see sortIncrementally().
+static const int incremental_sort_min_bucket_bits = 16;
+static const int incremental_sort_max_bucket_bits = 20;
+
 // How many depth sorts may be in flight at once.  Each holds a scratch allocation proportional to its cloud, so this
 // caps sort memory at roughly this many times the largest cloud, rather than letting it scale with the world.
 static const int max_concurrent_sorts = 2;
 
+// A chunk is drawn with its coarse LOD splats once their error - the furthest any of them has moved a splat - projects to
+// less than this many pixels.
+static const float max_coarse_lod_error_px = 2.f;
+
+// A change in the chunk selection that adds or removes at most this fraction of the selected splats is patched into the
+// cloud's last sorted order, so the next sort can still be incremental - see patchLastSortedOrder().
+static const float max_patched_selection_change_fraction = 0.25f;
+
 
 // One registered splat object, and the range of its owning cloud's arrays that it occupies.
 struct CloudMember
 {
 	GaussianSplatRenderer::Handle handle;
-	GaussianSplatDataRef splat_data; // The original object-space data.  Kept so that a move, or a re-bake into a different cloud after a merge, starts from the source rather than accumulating error over repeated re-bakes.
+	// The original object-space data, in one of its two forms: exactly one of these is non-null.  Kept so that a move, or a re-bake into a
+	// different cloud after a merge, starts from the source rather than accumulating error over repeated re-bakes.  The data texture
+	// is also packed straight from it - see packSplatTexels().
+	GaussianSplatDataRef splat_data;
+	QuantisedGaussianSplatDataRef quantised_splat_data;
+
+	size_t sourceDataMemUsageBytes() const
+	{
+		if(quantised_splat_data.nonNull())
+			return quantised_splat_data->memUsageBytes();
+		return splat_data->positions.dataSizeBytes() + splat_data->scales.dataSizeBytes() + splat_data->rotations.dataSizeBytes() + splat_data->colours.dataSizeBytes();
+	}
 
-	size_t offset, count; // This member's range within its cloud's arrays, and within its GPU texture and index VBO.
+	// The source data split into chunks, each with a coarse LOD.  Built once from the object-space data, so unaffected by the pose.
+	GaussianSplatChunksRef chunks;
+
+	// This member's range within its cloud's arrays, and within its GPU texture.  The first chunks->numSplats() splats of
+	// it are the source splats in chunk order, followed by the chunks' coarse LOD splats.
+	size_t offset, count;
 
 	js::AABBox aabb_ws; // Padded by the splat extent, not just bounding the splat centres - see bakeMember().
+	js::Vector<js::AABBox, 16> chunk_aabbs_ws; // Likewise padded, and bounding both levels of detail of each chunk.
 
 	// The pose, kept so that a merge can re-bake this member into a different cloud without the caller supplying it again.
 	Vec4f translation_ws;
@@ -69,8 +100,9 @@ class SplatCloud : public RefCounted
 {
 public:
 	SplatCloud()
-	:	cloud_id(0), gpu_capacity_splats(0), total_splats(0), structure_generation(0), sort_in_flight(false),
-		have_last_sort_cam_pos(false), last_sort_cam_pos_ws(0.f), aabb_ws(js::AABBox::emptyAABBox()), added_to_engine(false)
+	:	cloud_id(0), gpu_capacity_splats(0), total_splats(0), structure_generation(0), positions_version(0), selection_version(0), num_selected_splats(0), sort_in_flight(false),
+		have_last_sort_cam_pos(false), last_sort_cam_pos_ws(0.f), last_sorted_generation(0), last_sorted_positions_version(0), last_sorted_selection_version(0),
+		aabb_ws(js::AABBox::emptyAABBox()), added_to_engine(false)
 	{}
 
 	uint64 cloud_id; // Stable, never reused.  Sort results carry it, so a result for a cloud that has since been merged away can be dropped.
@@ -79,21 +111,39 @@ public:
 	bool added_to_engine; // False between allocCloud() and the first member being baked in - see addCloudToEngineIfNeeded().
 	Reference<VBO> instance_index_vbo;
 	size_t gpu_capacity_splats; // Allocated capacity of the data texture and index VBO, in splats.  total_splats <= gpu_capacity_splats always.
-	size_t total_splats;
+	size_t total_splats; // Including the members' coarse LOD splats.
 
-	// World-space splat data for this cloud's members, concatenated in member order.
+	// World-space splat positions for this cloud's members, concatenated in member order.  These are what the depth sort and
+	// chunk bounds work from.  The other attributes aren't kept here: packSplatTexels() reads them from each member's source
+	// data, quantised or not, when uploading, which saves 40 bytes per splat.
 	js::Vector<Vec3f, 16> positions;
-	js::Vector<Vec3f, 16> scales;
-	js::Vector<Vec4f, 16> rotations; // (x, y, z, w)
-	js::Vector<Vec4f, 16> colours;
 
 	std::vector<CloudMember> members;
 	js::AABBox aabb_ws; // The union of the members' padded bounds.  Doubles as the merge test and, via ob, the cull and draw-order box.
 
 	uint64 structure_generation; // Bumped by anything that renumbers the cloud, which invalidates an in-flight sort's indices.
+	uint64 positions_version; // Bumped by anything that moves splats without renumbering them, which invalidates last_sorted_positions.
+
+	// The level of detail each chunk was last selected at, for each chunk of each member in member order - see updateChunkSelection().
+	// Only the splats of the selected chunks are sorted and drawn.
+	js::Vector<uint8, 16> chunk_lods; // GaussianSplatChunks::ChunkLOD values.
+	uint64 selection_version; // Bumped whenever chunk_lods changes.  last_sorted_order is then out of date until patched - see patchLastSortedOrder().
+	size_t num_selected_splats;
 	bool sort_in_flight; // True from when a sort is kicked off until its precise result is applied.  The coarse result doesn't clear it.
 	bool have_last_sort_cam_pos;
 	Vec4f last_sort_cam_pos_ws; // Camera position as of the last sort kicked off (not necessarily completed).
+
+	// The order from the last applied precise sort, and the positions permuted into that order.  After a small camera move
+	// the order is still nearly sorted, so the next sort starts from it, reading the positions sequentially - see
+	// sortIncrementally().  Only valid while the generation, positions version and selection version they were computed for
+	// are current, although a small selection change can be patched in.  Handed to the sort's scratch while a sort is in
+	// flight, rather than copied, so empty then.
+	js::Vector<uint32, 16> last_sorted_order;
+	js::Vector<Vec3f, 16> last_sorted_positions;
+	js::Vector<uint8, 16> last_sorted_chunk_lods; // The chunk selection last_sorted_order holds the splats of.
+	uint64 last_sorted_generation;
+	uint64 last_sorted_positions_version;
+	uint64 last_sorted_selection_version;
 };
 
 
@@ -103,13 +153,24 @@ public:
 class GaussianSplatSortScratch : public ThreadSafeRefCounted
 {
 public:
+	GaussianSplatSortScratch() : in_previous_order(false) {}
+
 	struct SortItem
 	{
 		uint32 key;
-		uint32 splat_index;
+		uint32 snapshot_index; // Index into positions_snapshot.
 	};
 
-	js::Vector<Vec3f, 16> positions_snapshot; // A frozen copy of one cloud's positions, taken on the main thread when a sort is kicked off.  The worker only ever reads this, never the live arrays.
+	// A frozen copy of the positions of the splats of one cloud's selected chunks, taken on the main thread when a sort is
+	// kicked off.  The worker only ever reads this, never the live arrays.
+	js::Vector<Vec3f, 16> positions_snapshot;
+
+	// positions_snapshot[i] is the position of splat previous_order[i].  If in_previous_order is true, this is the cloud's
+	// last precise order, otherwise the selected splats in index order.
+	js::Vector<uint32, 16> previous_order;
+	bool in_previous_order;
+
+	js::Vector<uint8, 16> chunk_lods; // The cloud's chunk selection when the sort was kicked off, which the snapshot holds the splats of.
 
 	js::Vector<SortItem, 16> items; // Sort input, and the precise stage's output.
 	js::Vector<SortItem, 16> working_space; // Scratch space for the sort routines, and the coarse stage's output.
@@ -118,8 +179,10 @@ public:
 	// can't overwrite a coarse result the main thread hasn't consumed yet.
 	js::Vector<uint32, 16> coarse_indices;
 	js::Vector<uint32, 16> precise_indices;
+	js::Vector<Vec3f, 16> sorted_positions; // positions_snapshot permuted into the precise order, for the cloud's next sort to start from.
 
-	js::Vector<uint32, 16> temp_counts; // Bucket counts for Sort::radixSort32BitKey().
+	js::Vector<uint32, 16> temp_counts; // Bucket counts for Sort::parallelRadixSort32BitKey().
+	js::Vector<uint32, 16> incremental_counts; // Bucket counts for sortIncrementally().
 };
 
 
@@ -145,22 +208,55 @@ size_t texHeightForSplatCount(size_t num_splats)
 }
 
 
-// Packs a range of splats into RGBA32F texels: 4 texels per splat.
-void packSplatTexels(const js::Vector<Vec3f, 16>& positions, const js::Vector<Vec3f, 16>& scales, const js::Vector<Vec4f, 16>& rotations,
-	const js::Vector<Vec4f, 16>& colours, size_t begin_splat, size_t end_splat, float* texel_data)
+// Packs splat i of splat_data, with member's pose applied, into 4 RGBA32F texels at t.  pos is the splat's world-space
+// position, already baked into the cloud by bakeSplat().
+// SplatSource is GaussianSplatData or QuantisedGaussianSplatData - both have the same get*() accessors.
+template <class SplatSource>
+inline void packSplat(const SplatSource& splat_data, size_t i, const CloudMember& member, const Vec3f& pos, float* t)
 {
-	for(size_t i=begin_splat; i<end_splat; ++i)
+	const Vec3f scale = splat_data.getScale(i) * member.uniform_scale_ws;
+	const Vec4f os_rot = splat_data.getRotation(i); // (x, y, z, w)
+	const Vec4f rot = (member.rotation_ws * Quat<float>(os_rot[0], os_rot[1], os_rot[2], os_rot[3])).v; // Quat::v is already (x, y, z, w), matching our storage convention.
+	const Vec4f col = splat_data.getColour(i); // Colour and opacity aren't affected by the pose.
+
+	t[ 0] = pos.x;      t[ 1] = pos.y;      t[ 2] = pos.z;      t[ 3] = scale.x;
+	t[ 4] = scale.y;    t[ 5] = scale.z;    t[ 6] = rot[0];     t[ 7] = rot[1];
+	t[ 8] = rot[2];     t[ 9] = rot[3];     t[10] = col[0];     t[11] = col[1];
+	t[12] = col[2];     t[13] = col[3];     // t[14] and t[15] are left as zero.
+}
+
+
+// Packs splats [begin, end) of member's range, relative to member.offset, into texel_data.  See CloudMember::offset for the layout.
+template <class SplatSource>
+void packMemberSplatTexels(const SplatSource& splat_data, const SplatCloud& cloud, const CloudMember& member, size_t begin, size_t end, float* texel_data)
+{
+	const GaussianSplatChunks& chunks = *member.chunks;
+	const size_t num_source_splats = chunks.numSplats();
+
+	for(size_t z=begin; z<myMin(end, num_source_splats); ++z)
+		packSplat(splat_data, chunks.splat_order[z], member, cloud.positions[member.offset + z], texel_data + (z - begin) * texels_per_splat * 4);
+
+	for(size_t z=myMax(begin, num_source_splats); z<end; ++z)
+		packSplat(chunks.lod_splats, z - num_source_splats, member, cloud.positions[member.offset + z], texel_data + (z - begin) * texels_per_splat * 4);
+}
+
+
+// Packs a range of the cloud's splats into RGBA32F texels: 4 texels per splat.
+void packSplatTexels(const SplatCloud& cloud, size_t begin_splat, size_t end_splat, float* texel_data)
+{
+	for(size_t m=0; m<cloud.members.size(); ++m)
 	{
-		const Vec3f& pos   = positions[i];
-		const Vec3f& scale = scales[i];
-		const Vec4f& rot   = rotations[i];
-		const Vec4f& col   = colours[i];
-
-		float* const t = texel_data + (i - begin_splat) * texels_per_splat * 4;
-		t[ 0] = pos.x;      t[ 1] = pos.y;      t[ 2] = pos.z;      t[ 3] = scale.x;
-		t[ 4] = scale.y;    t[ 5] = scale.z;    t[ 6] = rot[0];     t[ 7] = rot[1];
-		t[ 8] = rot[2];     t[ 9] = rot[3];     t[10] = col[0];     t[11] = col[1];
-		t[12] = col[2];     t[13] = col[3];     // t[14] and t[15] are left as zero.
+		const CloudMember& member = cloud.members[m];
+		const size_t begin = myMax(begin_splat, member.offset);
+		const size_t end   = myMin(end_splat, member.offset + member.count);
+		if(begin >= end)
+			continue;
+
+		float* const member_texel_data = texel_data + (begin - begin_splat) * texels_per_splat * 4;
+		if(member.quantised_splat_data.nonNull())
+			packMemberSplatTexels(*member.quantised_splat_data, cloud, member, begin - member.offset, end - member.offset, member_texel_data);
+		else
+			packMemberSplatTexels(*member.splat_data, cloud, member, begin - member.offset, end - member.offset, member_texel_data);
 	}
 }
 
@@ -225,6 +321,82 @@ Reference<OpenGLMeshRenderData> makeInstancedQuadMeshData(VertexBufferAllocator&
 }
 
 
+typedef GaussianSplatSortScratch::SortItem SortItem;
+struct SortItemGetKey { inline uint32 operator () (const SortItem& item) const { return item.key; } };
+
+
+// Insertion sorts items by key, giving up and returning false once more than max_moves items have been moved.  items is
+// left in some permutation of its original contents either way.
+bool insertionSortWithMoveLimit(SortItem* items, size_t num_items, size_t max_moves)
+{
+	size_t num_moves = 0;
+	for(size_t i=1; i<num_items; ++i)
+	{
+		const SortItem item = items[i];
+		size_t j = i;
+		while(j > 0 && items[j - 1].key > item.key)
+		{
+			items[j] = items[j - 1];
+			j--;
+		}
+		items[j] = item;
+
+		num_moves += i - j;
+		if(num_moves > max_moves)
+			return false;
+	}
+	return true;
+}
+
+
+// Sorts items, which are in the cloud's previous precise order but with keys for the new camera position, into
+// working_space.
+//
+// After a camera move the previous order is still nearly sorted - each splat has only moved a short way from where it
+// was in it.  So a stable counting-sort pass on the high bits of the key, with a bucket per few splats, reads and writes
+// memory almost sequentially rather than scattering all over it, and leaves only a few splats out of order within each
+// bucket, which an insertion sort then fixes up.  The same pass over an unordered input is much slower than the 3-pass
+// radix sort, since both the counts and the output are then accessed randomly.
+//
+// Returns false if the insertion sort turned out to need too many moves, after a large camera move, in which case the
+// caller should sort from scratch.  items is left unmodified either way.
+bool sortIncrementally(GaussianSplatSortScratch& scratch)
+{
+	const js::Vector<SortItem, 16>& items = scratch.items;
+	js::Vector<SortItem, 16>& working_space = scratch.working_space;
+	const size_t num_items = items.size();
+
+	// Aim for around 4 splats per bucket, with the counts capped at 4MB.
+	int bucket_bits = incremental_sort_min_bucket_bits;
+	while(bucket_bits < incremental_sort_max_bucket_bits && ((size_t)4 << bucket_bits) < num_items)
+		bucket_bits++;
+	const int shift = 32 - bucket_bits;
+	const size_t num_buckets = (size_t)1 << bucket_bits;
+
+	js::Vector<uint32, 16>& counts = scratch.incremental_counts;
+	counts.resizeNoCopy(num_buckets);
+	std::memset(counts.data(), 0, num_buckets * sizeof(uint32));
+
+	for(size_t i=0; i<num_items; ++i)
+		counts[items[i].key >> shift]++;
+
+	// Compute exclusive prefix sum
+	uint32 sum = 0;
+	for(size_t b=0; b<num_buckets; ++b)
+	{
+		const uint32 count = counts[b];
+		counts[b] = sum;
+		sum += count;
+	}
+
+	for(size_t i=0; i<num_items; ++i)
+		working_space[counts[items[i].key >> shift]++] = items[i];
+
+	// The move limit is roughly where finishing off with the insertion sort starts to cost more than sorting from scratch would.
+	return insertionSortWithMoveLimit(working_space.data(), num_items, /*max moves=*/num_items * 4);
+}
+
+
 // Result of a background depth-sort, handed back to the main thread.  think() checks cloud_id, to drop results for a
 // cloud that has since been merged away or removed, and then generation, to drop results whose cloud has been
 // renumbered since.
@@ -239,7 +411,10 @@ public:
 
 	uint64 cloud_id;
 	uint64 generation;
+	uint64 positions_version;
+	uint64 selection_version;
 	Stage stage;
+	bool incremental; // For the precise stage: was the previous order re-sorted incrementally, rather than sorted from scratch?
 	Reference<GaussianSplatSortScratch> scratch; // Holds the result buffer, and keeps it alive even if the renderer was torn down while the sort ran.
 
 	// Back-to-front (farthest first) instance order, ready to write into the cloud's instance_index_vbo.
@@ -251,19 +426,21 @@ public:
 class GaussianSplatSortTask : public glare::Task
 {
 public:
-	GaussianSplatSortTask(uint64 cloud_id_, uint64 generation_, const Reference<GaussianSplatSortScratch>& scratch_, const Matrix4f& world_to_cam_,
-		ThreadSafeQueue<Reference<ThreadMessage> >* result_queue_)
-	:	cloud_id(cloud_id_), generation(generation_), scratch(scratch_), world_to_cam(world_to_cam_), result_queue(result_queue_)
+	GaussianSplatSortTask(uint64 cloud_id_, uint64 generation_, uint64 positions_version_, uint64 selection_version_, const Reference<GaussianSplatSortScratch>& scratch_,
+		const Matrix4f& world_to_cam_, ThreadSafeQueue<Reference<ThreadMessage> >* result_queue_, glare::TaskManager* task_manager_)
+	:	cloud_id(cloud_id_), generation(generation_), positions_version(positions_version_), selection_version(selection_version_), scratch(scratch_), world_to_cam(world_to_cam_),
+		result_queue(result_queue_), task_manager(task_manager_)
 	{}
 
 	virtual void run(size_t /*thread_index*/) override
 	{
-		typedef GaussianSplatSortScratch::SortItem SortItem;
-		struct SortItemGetKey { inline uint32 operator () (const SortItem& item) const { return item.key; } };
-
 		const js::Vector<Vec3f, 16>& positions = scratch->positions_snapshot; // The frozen snapshot, never the live arrays.
 		const size_t num_splats = positions.size();
 
+		// If the snapshot is in the cloud's previous order, so are the items, so after a small camera move they are already
+		// nearly sorted.
+		const bool snapshot_in_previous_order = scratch->in_previous_order;
+
 		js::Vector<SortItem, 16>& items = scratch->items;
 		js::Vector<SortItem, 16>& working_space = scratch->working_space;
 		items.resizeNoCopy(num_splats);
@@ -279,7 +456,7 @@ public:
 			const Vec3f& p = positions[i];
 			const float dist = maskWToZero(world_to_cam * Vec4f(p.x, p.y, p.z, 1.f)).length(); // world_to_cam is a rigid transform, so this is the true world-space distance.
 			items[i].key = bitCast<uint32>(dist);
-			items[i].splat_index = (uint32)i;
+			items[i].snapshot_index = (uint32)i;
 			min_dist = myMin(min_dist, dist);
 			max_dist = myMax(max_dist, dist);
 		}
@@ -292,6 +469,15 @@ public:
 		for(size_t i=0; i<num_splats; ++i)
 			items[i].key = (uint32)((double)(max_dist - bitCast<float>(items[i].key)) * key_scale);
 
+		// The incremental sort is fast enough that the coarse stage isn't needed.  The linear key mapping changes with the
+		// distance range, but it is monotonic, so the previous order is no less sorted for it.
+		if(snapshot_in_previous_order && sortIncrementally(*scratch))
+		{
+			writePreciseResults(working_space);
+			enqueueResult(GaussianSplatSortResultMsg::Stage_Precise, /*incremental=*/true);
+			return;
+		}
+
 		// Stage 1: a single counting-sort pass over the top coarse_key_bits of the key.  Much cheaper than the precise
 		// sort below, and already fine-grained enough to look right on its own, so it's posted immediately rather than
 		// leaving the view in the pre-move order until the precise sort finishes.
@@ -301,39 +487,63 @@ public:
 
 			scratch->coarse_indices.resizeNoCopy(num_splats);
 			for(size_t i=0; i<num_splats; ++i)
-				scratch->coarse_indices[i] = working_space[i].splat_index;
+				scratch->coarse_indices[i] = splatIndex(working_space[i].snapshot_index);
 
-			enqueueResult(GaussianSplatSortResultMsg::Stage_Coarse);
+			enqueueResult(GaussianSplatSortResultMsg::Stage_Coarse, /*incremental=*/false);
 		}
 
-		// Stage 2: the precise sort.  Stage 1 only wrote to working_space, which radixSort32BitKey() treats as scratch
+		// Stage 2: the precise sort.  Stage 1 only wrote to working_space, which the radix sort treats as scratch
 		// anyway, so items is still in its original order here.
-		scratch->temp_counts.resizeNoCopy(6144); // The size Sort::radixSort32BitKey() requires.
-		Sort::radixSort32BitKey(items.data(), working_space.data(), num_splats, SortItemGetKey(), scratch->temp_counts.data(), scratch->temp_counts.size());
+		// Large clouds are split over the task manager this task is running on.  runTaskGroup() runs any of the sort's tasks that
+		// no other thread has started on this thread, so this doesn't stall if the other threads are busy.
+		Sort::parallelRadixSort32BitKey(*task_manager, items.data(), working_space.data(), num_splats, SortItemGetKey(), scratch->temp_counts);
+
+		writePreciseResults(items);
+		enqueueResult(GaussianSplatSortResultMsg::Stage_Precise, /*incremental=*/false);
+	}
 
+private:
+	uint32 splatIndex(uint32 snapshot_index) const
+	{
+		return scratch->previous_order[snapshot_index];
+	}
+
+	// Writes the precise draw order, and the snapshot positions permuted into that order for the cloud's next sort.  The
+	// latter is a random gather after a sort from scratch, but close to sequential after an incremental one.
+	void writePreciseResults(const js::Vector<SortItem, 16>& sorted_items)
+	{
+		const size_t num_splats = sorted_items.size();
 		scratch->precise_indices.resizeNoCopy(num_splats);
+		scratch->sorted_positions.resizeNoCopy(num_splats);
 		for(size_t i=0; i<num_splats; ++i)
-			scratch->precise_indices[i] = items[i].splat_index;
-
-		enqueueResult(GaussianSplatSortResultMsg::Stage_Precise);
+		{
+			const uint32 snapshot_index = sorted_items[i].snapshot_index;
+			scratch->precise_indices[i] = splatIndex(snapshot_index);
+			scratch->sorted_positions[i] = scratch->positions_snapshot[snapshot_index];
+		}
 	}
 
-private:
-	void enqueueResult(GaussianSplatSortResultMsg::Stage stage)
+	void enqueueResult(GaussianSplatSortResultMsg::Stage stage, bool incremental)
 	{
 		Reference<GaussianSplatSortResultMsg> msg = new GaussianSplatSortResultMsg();
 		msg->cloud_id = cloud_id;
 		msg->generation = generation;
+		msg->positions_version = positions_version;
+		msg->selection_version = selection_version;
 		msg->stage = stage;
+		msg->incremental = incremental;
 		msg->scratch = scratch;
 		result_queue->enqueue(msg);
 	}
 
 	uint64 cloud_id;
 	uint64 generation;
+	uint64 positions_version;
+	uint64 selection_version;
 	Reference<GaussianSplatSortScratch> scratch; // Keeps the snapshot and working buffers alive for the duration of the task.
 	Matrix4f world_to_cam;
 	ThreadSafeQueue<Reference<ThreadMessage> >* result_queue;
+	glare::TaskManager* task_manager;
 };
 
 
@@ -341,7 +551,7 @@ private:
 
 
 GaussianSplatRenderer::GaussianSplatRenderer(OpenGLEngine& opengl_engine_)
-:	opengl_engine(&opengl_engine_), next_handle(1), next_cloud_id(1), num_sorts_in_flight(0)
+:	opengl_engine(&opengl_engine_), next_handle(1), next_cloud_id(1), num_sorts_in_flight(0), num_incremental_sorts(0), num_full_sorts(0)
 {}
 
 
@@ -406,7 +616,8 @@ size_t GaussianSplatRenderer::numSplatsInWorld() const
 {
 	size_t num = 0;
 	for(size_t i=0; i<clouds.size(); ++i)
-		num += clouds[i]->total_splats;
+		for(size_t m=0; m<clouds[i]->members.size(); ++m)
+			num += clouds[i]->members[m].chunks->numSplats(); // Not counting the coarse LOD splats.
 	return num;
 }
 
@@ -425,8 +636,9 @@ bool GaussianSplatRenderer::isValidHandle(Handle handle) const
 
 std::string GaussianSplatRenderer::getDiagnostics() const
 {
-	size_t num_merged_clouds = 0, largest_cloud_splats = 0, total_splats = 0;
-	uint64 tex_bytes = 0, index_vbo_bytes = 0;
+	size_t num_merged_clouds = 0, largest_cloud_splats = 0, total_splats = 0, total_lod_splats = 0;
+	size_t num_chunks = 0, num_full_chunks = 0, num_coarse_chunks = 0;
+	uint64 tex_bytes = 0, index_vbo_bytes = 0, sort_order_bytes = 0, source_data_bytes = 0, chunk_bytes = 0;
 	for(size_t i=0; i<clouds.size(); ++i)
 	{
 		const SplatCloud& cloud = *clouds[i];
@@ -435,9 +647,27 @@ std::string GaussianSplatRenderer::getDiagnostics() const
 		if(cloud.members.size() > 1)
 			num_merged_clouds++;
 
+		num_chunks += cloud.chunk_lods.size();
+		for(size_t c=0; c<cloud.chunk_lods.size(); ++c)
+		{
+			if(cloud.chunk_lods[c] == GaussianSplatChunks::ChunkLOD_Full)
+				num_full_chunks++;
+			else if(cloud.chunk_lods[c] == GaussianSplatChunks::ChunkLOD_Coarse)
+				num_coarse_chunks++;
+		}
+
 		// Both are sized to the cloud's capacity, not its splat count: 4 RGBA32F texels and one uint32 index per splat.
 		tex_bytes       += (uint64)cloud.gpu_capacity_splats * texels_per_splat * 4 * sizeof(float);
 		index_vbo_bytes += (uint64)cloud.gpu_capacity_splats * sizeof(uint32);
+
+		sort_order_bytes += (uint64)(cloud.last_sorted_order.size() * sizeof(uint32) + cloud.last_sorted_positions.size() * sizeof(Vec3f));
+
+		for(size_t m=0; m<cloud.members.size(); ++m)
+		{
+			source_data_bytes += cloud.members[m].sourceDataMemUsageBytes();
+			chunk_bytes += cloud.members[m].chunks->memUsageBytes();
+			total_lod_splats += cloud.members[m].chunks->numLODSplats();
+		}
 	}
 
 	uint64 scratch_bytes = 0;
@@ -446,18 +676,24 @@ std::string GaussianSplatRenderer::getDiagnostics() const
 		const GaussianSplatSortScratch& s = *free_scratch[i];
 		scratch_bytes += (uint64)(s.positions_snapshot.size() * sizeof(Vec3f) + s.items.size() * sizeof(GaussianSplatSortScratch::SortItem) +
 			s.working_space.size() * sizeof(GaussianSplatSortScratch::SortItem) + s.coarse_indices.size() * sizeof(uint32) +
-			s.precise_indices.size() * sizeof(uint32) + s.temp_counts.size() * sizeof(uint32));
+			s.precise_indices.size() * sizeof(uint32) + s.temp_counts.size() * sizeof(uint32) + s.previous_order.size() * sizeof(uint32) +
+			s.sorted_positions.size() * sizeof(Vec3f) + s.incremental_counts.size() * sizeof(uint32));
 	}
 
 	std::string s;
 	s += "Splat objects: " + toString(handle_to_cloud.size()) + "\n";
 	s += "Drawable clouds: " + toString(clouds.size()) + " (" + toString(num_merged_clouds) + " merged)\n";
 	s += "Clouds drawn last frame: " + toString(opengl_engine->last_num_splat_clouds_drawn) + "\n";
-	s += "Splats: " + uInt64ToStringCommaSeparated(total_splats) + " total, " + uInt64ToStringCommaSeparated(largest_cloud_splats) + " in largest cloud\n";
+	s += "Splats: " + uInt64ToStringCommaSeparated(total_splats) + " total (" + uInt64ToStringCommaSeparated(total_lod_splats) + " coarse LOD), " + uInt64ToStringCommaSeparated(largest_cloud_splats) + " in largest cloud\n";
 	s += "Splats drawn last frame: " + uInt64ToStringCommaSeparated(opengl_engine->last_num_splats_drawn) + "\n";
+	s += "Chunks: " + toString(num_chunks) + " total, " + toString(num_full_chunks) + " visible at full detail, " + toString(num_coarse_chunks) + " coarse\n";
 	s += "Sorts in flight: " + toString(num_sorts_in_flight) + " / " + toString(max_concurrent_sorts) + "\n";
+	s += "Sorts done: " + toString(num_incremental_sorts) + " incremental, " + toString(num_full_sorts) + " full\n";
 	s += "GPU mem: " + getMBSizeString((size_t)tex_bytes) + " data textures, " + getMBSizeString((size_t)index_vbo_bytes) + " index VBOs\n";
 	s += "Sort scratch pooled: " + toString(free_scratch.size()) + " buffers, " + getMBSizeString((size_t)scratch_bytes) + "\n";
+	s += "Last sorted orders: " + getMBSizeString((size_t)sort_order_bytes) + "\n";
+	s += "Source splat data: " + getMBSizeString((size_t)source_data_bytes) + "\n"; // Data shared between several objects is counted once per object.
+	s += "Chunk data: " + getMBSizeString((size_t)chunk_bytes) + "\n";
 	s += "Splat shader prog built:   " + boolToString(shader_prog && shader_prog->isBuilt()) + "\n";
 	s += "Resolve shader prog built: " + boolToString(resolve_prog && resolve_prog->isBuilt()) + "\n";
 
@@ -468,7 +704,7 @@ std::string GaussianSplatRenderer::getDiagnostics() const
 	{
 		const SplatCloud& cloud = *clouds[i];
 		s += "  cloud " + toString(cloud.cloud_id) + ": " + toString(cloud.members.size()) + (cloud.members.size() == 1 ? " member, " : " members, ") +
-			uInt64ToStringCommaSeparated(cloud.total_splats) + " splats" + (cloud.sort_in_flight ? ", sorting" : "") + "\n";
+			uInt64ToStringCommaSeparated(cloud.total_splats) + " splats, " + uInt64ToStringCommaSeparated(cloud.num_selected_splats) + " selected" + (cloud.sort_in_flight ? ", sorting" : "") + "\n";
 	}
 	if(clouds.size() > max_clouds_to_list)
 		s += "  (" + toString(clouds.size() - max_clouds_to_list) + " more)\n";
@@ -584,7 +820,7 @@ void GaussianSplatRenderer::uploadTexelRowsForSplatRange(SplatCloud& cloud, size
 	const size_t row_end_splat_excl = myMin(cloud.total_splats, (end_row * splat_tex_width) / texels_per_splat);
 
 	js::Vector<float, 16> texel_data(splat_tex_width * num_rows * 4, 0.f);
-	packSplatTexels(cloud.positions, cloud.scales, cloud.rotations, cloud.colours, row_start_splat, row_end_splat_excl, texel_data.data());
+	packSplatTexels(cloud, row_start_splat, row_end_splat_excl, texel_data.data());
 
 	cloud.ob->materials[0].albedo_texture->loadRegionIntoExistingTexture(/*mipmap_level=*/0, /*x=*/0, /*y=*/start_row, /*z=*/0,
 		/*region_w=*/splat_tex_width, /*region_h=*/num_rows, /*region_d=*/1, /*src_row_stride_B=*/splat_tex_width * 4 * sizeof(float),
@@ -592,15 +828,36 @@ void GaussianSplatRenderer::uploadTexelRowsForSplatRange(SplatCloud& cloud, size
 }
 
 
-void GaussianSplatRenderer::writeIdentityIndices(SplatCloud& cloud, size_t first_splat, size_t num_splats)
+void GaussianSplatRenderer::writeUnsortedIndices(SplatCloud& cloud)
 {
-	if(num_splats == 0)
-		return;
+	// Select every chunk at full detail, i.e. every member's source splats but none of its coarse LOD splats.  think()
+	// refines the selection on the next frame.
+	size_t num_chunks = 0, num_source_splats = 0;
+	for(size_t m=0; m<cloud.members.size(); ++m)
+	{
+		num_chunks += cloud.members[m].chunks->chunks.size();
+		num_source_splats += cloud.members[m].chunks->numSplats();
+	}
+
+	cloud.chunk_lods.resizeNoCopy(num_chunks);
+	for(size_t c=0; c<num_chunks; ++c)
+		cloud.chunk_lods[c] = (uint8)GaussianSplatChunks::ChunkLOD_Full;
+	cloud.num_selected_splats = num_source_splats;
+	cloud.selection_version++;
+
+	js::Vector<uint32, 16> indices(num_source_splats);
+	size_t i = 0;
+	for(size_t m=0; m<cloud.members.size(); ++m)
+	{
+		const CloudMember& member = cloud.members[m];
+		for(size_t z=0; z<member.chunks->numSplats(); ++z)
+			indices[i++] = (uint32)(member.offset + z);
+	}
+	assert(i == num_source_splats);
 
-	js::Vector<uint32, 16> indices(num_splats);
-	for(size_t i=0; i<num_splats; ++i)
-		indices[i] = (uint32)(first_splat + i);
-	cloud.instance_index_vbo->updateData(first_splat * sizeof(uint32), indices.data(), indices.size() * sizeof(uint32));
+	if(num_source_splats > 0)
+		cloud.instance_index_vbo->updateData(0, indices.data(), indices.size() * sizeof(uint32));
+	cloud.ob->num_instances_to_draw = (int)num_source_splats;
 }
 
 
@@ -619,7 +876,7 @@ void GaussianSplatRenderer::ensureGpuCapacity(SplatCloud& cloud, size_t needed_s
 
 	// Repack every splat into a fresh, bigger texture.  Growth is rare, so this cost isn't paid on every append.
 	js::Vector<float, 16> texel_data(splat_tex_width * new_tex_h * 4, 0.f);
-	packSplatTexels(cloud.positions, cloud.scales, cloud.rotations, cloud.colours, 0, cloud.total_splats, texel_data.data());
+	packSplatTexels(cloud, 0, cloud.total_splats, texel_data.data());
 
 	cloud.ob->materials[0].albedo_texture = new OpenGLTexture(splat_tex_width, new_tex_h, opengl_engine,
 		ArrayRef<uint8>((const uint8*)texel_data.data(), texel_data.size() * sizeof(float)),
@@ -648,48 +905,287 @@ void GaussianSplatRenderer::ensureGpuCapacity(SplatCloud& cloud, size_t needed_s
 }
 
 
-// Bakes member.splat_data into cloud's arrays at member.offset, using member's stored pose, and sets member.aabb_ws.
+// Bakes the position of splat i of splat_data into cloud.positions at dest, using member's stored pose, and enlarges aabb_ws to hold the splat.
+// SplatSource is GaussianSplatData or QuantisedGaussianSplatData - both have the same get*() accessors.
 //
-// The bounds are grown by each splat's own radius, rather than just holding the splat centres.  A splat is drawn as a
+// The bounds are grown by the splat's own radius, rather than just holding the splat centre.  A splat is drawn as a
 // quad extending well beyond its centre, so centre-only bounds would let two clouds whose bounds are marginally
 // disjoint still have their fringe splats interpenetrating - and the partitioning would then leave them in separate
 // clouds with no separating plane between them, which is the one failure that produces a wrong compositing order.
-static void bakeMember(SplatCloud& cloud, CloudMember& member)
+template <class SplatSource>
+static inline void bakeSplat(const SplatSource& splat_data, size_t i, const CloudMember& member, SplatCloud& cloud, size_t dest, js::AABBox& aabb_ws)
 {
-	const GaussianSplatData& splat_data = *member.splat_data;
 	const Vec4f translation_ws = member.translation_ws;
 	const Quat<float>& rotation_ws = member.rotation_ws;
 	const float uniform_scale_ws = member.uniform_scale_ws;
 
-	js::AABBox aabb_ws = js::AABBox::emptyAABBox();
+	const Vec3f os_pos   = splat_data.getPosition(i);
+	const Vec3f os_scale = splat_data.getScale(i);
+
+	const Vec4f rotated = rotation_ws.rotateVector(Vec4f(uniform_scale_ws * os_pos.x, uniform_scale_ws * os_pos.y, uniform_scale_ws * os_pos.z, 0.f));
+	const Vec4f world_pos = translation_ws + rotated; // translation_ws.w == 1 and rotated.w == 0, so world_pos.w == 1, as a point should be.
+
+	const Vec3f world_scale = os_scale * uniform_scale_ws;
+
+	cloud.positions[dest] = toVec3f(world_pos);
+
+	const float radius = splat_cutoff_sigmas * myMax(world_scale.x, myMax(world_scale.y, world_scale.z));
+	aabb_ws.enlargeToHoldPoint(world_pos - Vec4f(radius, radius, radius, 0.f));
+	aabb_ws.enlargeToHoldPoint(world_pos + Vec4f(radius, radius, radius, 0.f));
+}
+
+
+// Bakes the positions of the member's source splats, in chunk order, and its chunks' coarse LOD splats into cloud.positions at member.offset,
+// and computes the member's and each chunk's world-space bounds.
+template <class SplatSource>
+static void bakeSplats(const SplatSource& splat_data, CloudMember& member, SplatCloud& cloud)
+{
+	const GaussianSplatChunks& chunks = *member.chunks;
+	const size_t lod_offset = member.offset + chunks.numSplats();
+
+	member.aabb_ws = js::AABBox::emptyAABBox();
+	member.chunk_aabbs_ws.resizeNoCopy(chunks.chunks.size());
 
-	const size_t num_splats = splat_data.numSplats();
-	for(size_t i=0; i<num_splats; ++i)
+	for(size_t c=0; c<chunks.chunks.size(); ++c)
 	{
-		const Vec3f& os_pos   = splat_data.positions[i];
-		const Vec3f& os_scale = splat_data.scales[i];
-		const Vec4f& os_rot   = splat_data.rotations[i]; // (x, y, z, w)
+		const GaussianSplatChunks::Chunk& chunk = chunks.chunks[c];
 
-		const Vec4f rotated = rotation_ws.rotateVector(Vec4f(uniform_scale_ws * os_pos.x, uniform_scale_ws * os_pos.y, uniform_scale_ws * os_pos.z, 0.f));
-		const Vec4f world_pos = translation_ws + rotated; // translation_ws.w == 1 and rotated.w == 0, so world_pos.w == 1, as a point should be.
+		js::AABBox chunk_aabb_ws = js::AABBox::emptyAABBox();
+		for(size_t i=chunk.begin; i<chunk.end; ++i)
+			bakeSplat(splat_data, chunks.splat_order[i], member, cloud, member.offset + i, chunk_aabb_ws);
+		for(size_t i=chunk.lod_begin; i<chunk.lod_end; ++i)
+			bakeSplat(chunks.lod_splats, i, member, cloud, lod_offset + i, chunk_aabb_ws);
+
+		member.chunk_aabbs_ws[c] = chunk_aabb_ws;
+		member.aabb_ws.enlargeToHoldAABBox(chunk_aabb_ws);
+	}
+}
+
+
+// Bakes the member's source positions into cloud.positions at member.offset, and sets member.aabb_ws and member.chunk_aabbs_ws.
+static void bakeMember(SplatCloud& cloud, CloudMember& member)
+{
+	if(member.quantised_splat_data.nonNull())
+		bakeSplats(*member.quantised_splat_data, member, cloud);
+	else
+		bakeSplats(*member.splat_data, member, cloud);
+}
 
-		const Quat<float> os_quat(os_rot[0], os_rot[1], os_rot[2], os_rot[3]);
-		const Quat<float> world_quat = rotation_ws * os_quat;
 
-		const Vec3f world_scale = os_scale * uniform_scale_ws;
+// Culls and LOD-selects every chunk of the cloud.  If the selection changed, the cloud's current draw order is for the old
+// selection - chunks that have just come into view are missing from it - so a re-sort is requested.
+static void updateChunkSelection(SplatCloud& cloud, const GaussianSplatChunks::ViewParams& view_params)
+{
+	bool changed = false;
+	size_t num_selected_splats = 0;
+	size_t cloud_chunk_i = 0;
+	for(size_t m=0; m<cloud.members.size(); ++m)
+	{
+		const CloudMember& member = cloud.members[m];
+		const GaussianSplatChunks& chunks = *member.chunks;
+		for(size_t c=0; c<chunks.chunks.size(); ++c)
+		{
+			const GaussianSplatChunks::Chunk& chunk = chunks.chunks[c];
+			const GaussianSplatChunks::ChunkLOD lod = GaussianSplatChunks::selectChunkLOD(member.chunk_aabbs_ws[c], chunk.lod_error * member.uniform_scale_ws, view_params);
+
+			if(cloud.chunk_lods[cloud_chunk_i] != (uint8)lod)
+			{
+				cloud.chunk_lods[cloud_chunk_i] = (uint8)lod;
+				changed = true;
+			}
+			cloud_chunk_i++;
+
+			if(lod == GaussianSplatChunks::ChunkLOD_Full)
+				num_selected_splats += chunk.end - chunk.begin;
+			else if(lod == GaussianSplatChunks::ChunkLOD_Coarse)
+				num_selected_splats += chunk.lod_end - chunk.lod_begin;
+		}
+	}
+	assert(cloud_chunk_i == cloud.chunk_lods.size());
+
+	cloud.num_selected_splats = num_selected_splats;
+	if(changed)
+	{
+		cloud.selection_version++;
+		cloud.have_last_sort_cam_pos = false;
+	}
+}
 
-		const size_t dest = member.offset + i;
-		cloud.positions[dest] = toVec3f(world_pos);
-		cloud.scales   [dest] = world_scale;
-		cloud.rotations[dest] = world_quat.v; // Quat::v is already (x, y, z, w), matching our storage convention.
-		cloud.colours  [dest] = splat_data.colours[i]; // Colour and opacity aren't affected by the cloud's pose, but re-deriving them keeps this the single place a member's data is written.
 
-		const float radius = splat_cutoff_sigmas * myMax(world_scale.x, myMax(world_scale.y, world_scale.z));
-		aabb_ws.enlargeToHoldPoint(world_pos - Vec4f(radius, radius, radius, 0.f));
-		aabb_ws.enlargeToHoldPoint(world_pos + Vec4f(radius, radius, radius, 0.f));
+// Gets the range of the cloud's splats that are drawn for chunk c of the member at the given level of detail.  Returns
+// false if the chunk is culled.
+static bool getChunkSplatRange(const CloudMember& member, size_t c, uint8 lod, size_t& begin_out, size_t& end_out)
+{
+	const GaussianSplatChunks& chunks = *member.chunks;
+	const GaussianSplatChunks::Chunk& chunk = chunks.chunks[c];
+	if(lod == GaussianSplatChunks::ChunkLOD_Full)
+	{
+		begin_out = member.offset + chunk.begin;
+		end_out   = member.offset + chunk.end;
+		return true;
+	}
+	else if(lod == GaussianSplatChunks::ChunkLOD_Coarse)
+	{
+		begin_out = member.offset + chunks.numSplats() + chunk.lod_begin;
+		end_out   = member.offset + chunks.numSplats() + chunk.lod_end;
+		return true;
+	}
+	else
+		return false;
+}
+
+
+// Writes the indices of the splats of the cloud's selected chunks, and their positions, in index order.
+static void gatherSelectedSplats(const SplatCloud& cloud, js::Vector<uint32, 16>& indices_out, js::Vector<Vec3f, 16>& positions_out)
+{
+	indices_out.resizeNoCopy(cloud.num_selected_splats);
+	positions_out.resizeNoCopy(cloud.num_selected_splats);
+
+	size_t num = 0;
+	size_t cloud_chunk_i = 0;
+	for(size_t m=0; m<cloud.members.size(); ++m)
+	{
+		const CloudMember& member = cloud.members[m];
+		for(size_t c=0; c<member.chunks->chunks.size(); ++c)
+		{
+			size_t begin, end;
+			if(!getChunkSplatRange(member, c, cloud.chunk_lods[cloud_chunk_i++], begin, end))
+				continue;
+
+			for(size_t i=begin; i<end; ++i)
+			{
+				indices_out[num] = (uint32)i;
+				positions_out[num] = cloud.positions[i];
+				num++;
+			}
+		}
+	}
+	assert(num == cloud.num_selected_splats);
+}
+
+
+// Brings the cloud's last sorted order up to date with its current chunk selection, so that the next sort can start from
+// it rather than from scratch: the splats of chunks no longer drawn at the same level of detail are removed, and those of
+// newly selected chunks are appended in index order.  The appended splats don't need to be anywhere near their sorted
+// place, as the incremental sort's bucketing pass moves every splat to its bucket whatever its starting position - it is
+// only the order within each bucket that the previous order has to get nearly right.
+//
+// Returns false, leaving the order untouched, if the change is too large for that to be worth it.
+static bool patchLastSortedOrder(SplatCloud& cloud)
+{
+	if(cloud.last_sorted_chunk_lods.size() != cloud.chunk_lods.size())
+		return false;
+
+	// Find the ranges of splats removed from and added to the selection.
+	std::vector<std::pair<size_t, size_t> > removed_ranges, added_ranges;
+	size_t num_removed = 0, num_added = 0;
+	size_t cloud_chunk_i = 0;
+	for(size_t m=0; m<cloud.members.size(); ++m)
+	{
+		const CloudMember& member = cloud.members[m];
+		for(size_t c=0; c<member.chunks->chunks.size(); ++c, ++cloud_chunk_i)
+		{
+			const uint8 old_lod = cloud.last_sorted_chunk_lods[cloud_chunk_i];
+			const uint8 new_lod = cloud.chunk_lods[cloud_chunk_i];
+			if(old_lod == new_lod)
+				continue;
+
+			size_t begin, end;
+			if(getChunkSplatRange(member, c, old_lod, begin, end))
+			{
+				removed_ranges.push_back(std::make_pair(begin, end));
+				num_removed += end - begin;
+			}
+			if(getChunkSplatRange(member, c, new_lod, begin, end))
+			{
+				added_ranges.push_back(std::make_pair(begin, end));
+				num_added += end - begin;
+			}
+		}
+	}
+
+	if((float)(num_removed + num_added) > max_patched_selection_change_fraction * (float)cloud.num_selected_splats)
+		return false;
+
+	// Remove the splats in removed_ranges, keeping the order of the rest.  The full and coarse ranges of a member are
+	// interleaved in the chunk loop above, so sort the ranges to binary search them.
+	if(!removed_ranges.empty())
+	{
+		std::sort(removed_ranges.begin(), removed_ranges.end());
+
+		size_t num_kept = 0;
+		for(size_t i=0; i<cloud.last_sorted_order.size(); ++i)
+		{
+			const size_t splat_i = cloud.last_sorted_order[i];
+			// Find the last range starting at or before splat_i.
+			const std::vector<std::pair<size_t, size_t> >::const_iterator it = std::upper_bound(removed_ranges.begin(), removed_ranges.end(), std::make_pair(splat_i, std::numeric_limits<size_t>::max()));
+			const bool removed = it != removed_ranges.begin() && splat_i < (it - 1)->second;
+			if(!removed)
+			{
+				cloud.last_sorted_order[num_kept] = cloud.last_sorted_order[i];
+				cloud.last_sorted_positions[num_kept] = cloud.last_sorted_positions[i];
+				num_kept++;
+			}
+		}
+		assert(num_kept + num_removed == cloud.last_sorted_order.size());
+		cloud.last_sorted_order.resize(num_kept);
+		cloud.last_sorted_positions.resize(num_kept);
+	}
+
+	for(size_t r=0; r<added_ranges.size(); ++r)
+		for(size_t i=added_ranges[r].first; i<added_ranges[r].second; ++i)
+		{
+			cloud.last_sorted_order.push_back((uint32)i);
+			cloud.last_sorted_positions.push_back(cloud.positions[i]);
+		}
+	assert(cloud.last_sorted_order.size() == cloud.num_selected_splats);
+
+	cloud.last_sorted_chunk_lods = cloud.chunk_lods;
+	cloud.last_sorted_selection_version = cloud.selection_version;
+	return true;
+}
+
+
+// Keeps a precise sort result's order and sorted positions for the cloud's next sort to start from.  The result's scratch
+// is back in the pool by now, so its buffers can be taken rather than copied.
+static void keepLastSortedOrder(SplatCloud& cloud, const GaussianSplatSortResultMsg& msg)
+{
+	cloud.last_sorted_order.swapWith(msg.scratch->precise_indices);
+	cloud.last_sorted_positions.swapWith(msg.scratch->sorted_positions);
+	cloud.last_sorted_chunk_lods.swapWith(msg.scratch->chunk_lods);
+	cloud.last_sorted_generation = msg.generation;
+	cloud.last_sorted_positions_version = msg.positions_version;
+	cloud.last_sorted_selection_version = msg.selection_version;
+}
+
+
+// Freezes a snapshot of the positions of the splats of the cloud's selected chunks into scratch on the main thread, before
+// handing off to the worker, so the worker never touches the live, growable arrays.
+//
+// If the last precise order is still valid - the same numbering of splats, no moves and the same chunk selection since, or
+// a selection change small enough to patch in - the snapshot is the positions in that order instead, so the worker can
+// start from it.  The sort's result replaces them anyway, so they are moved rather than copied.
+static void prepareSortSnapshot(SplatCloud& cloud, GaussianSplatSortScratch& scratch)
+{
+	const bool last_sorted_order_valid = cloud.last_sorted_generation == cloud.structure_generation && cloud.last_sorted_positions_version == cloud.positions_version &&
+		!cloud.last_sorted_order.empty() &&
+		(cloud.last_sorted_selection_version == cloud.selection_version || patchLastSortedOrder(cloud));
+
+	if(last_sorted_order_valid && cloud.last_sorted_order.size() == cloud.num_selected_splats)
+	{
+		cloud.last_sorted_order.swapWith(scratch.previous_order);
+		cloud.last_sorted_positions.swapWith(scratch.positions_snapshot);
+		scratch.in_previous_order = true;
 	}
+	else
+	{
+		gatherSelectedSplats(cloud, scratch.previous_order, scratch.positions_snapshot);
+		scratch.in_previous_order = false;
+	}
+	cloud.last_sorted_order.clear(); // Either stale, or now holding the scratch's old buffer.
+	cloud.last_sorted_positions.clear();
 
-	member.aabb_ws = aabb_ws;
+	scratch.chunk_lods = cloud.chunk_lods;
 }
 
 
@@ -715,9 +1211,6 @@ void GaussianSplatRenderer::appendMemberToCloud(SplatCloud& cloud, const CloudMe
 	const size_t new_total = old_total + member_in.count;
 
 	cloud.positions.resize(new_total);
-	cloud.scales   .resize(new_total);
-	cloud.rotations.resize(new_total);
-	cloud.colours  .resize(new_total);
 
 	cloud.members.push_back(member_in);
 	CloudMember& member = cloud.members.back();
@@ -725,19 +1218,19 @@ void GaussianSplatRenderer::appendMemberToCloud(SplatCloud& cloud, const CloudMe
 	bakeMember(cloud, member);
 
 	cloud.total_splats = new_total;
-	cloud.ob->num_instances_to_draw = (int)new_total;
 
 	ensureGpuCapacity(cloud, new_total);
 
 	uploadTexelRowsForSplatRange(cloud, old_total, member_in.count); // If ensureGpuCapacity() just repacked everything, this re-uploads the same correct data, which is harmless.
-	writeIdentityIndices(cloud, old_total, member_in.count); // Again redundant but harmless if ensureGpuCapacity() just rebuilt the whole VBO.
+	writeUnsortedIndices(cloud);
 
 	rebuildCloudAABB(cloud);
 	addCloudToEngineIfNeeded(cloud); // For the first member: only now does the cloud have real bounds and an instance count for the engine to cache.
 
-	// The appended splats are in identity order relative to the rest, so the cloud needs a fresh sort.  This doesn't
-	// bump structure_generation: a pure append leaves existing indices meaningful, so an in-flight sort's result still
-	// applies to the prefix it covers.
+	// The appended splats are in index order relative to the rest, so the cloud needs a fresh sort.  An in-flight sort's
+	// result wouldn't include them, so it is dropped too - though in practice members are only ever appended to a freshly
+	// allocated cloud, which has none.
+	cloud.structure_generation++;
 	cloud.have_last_sort_cam_pos = false;
 }
 
@@ -753,19 +1246,14 @@ void GaussianSplatRenderer::rebuildCloud(SplatCloud& cloud)
 
 	cloud.total_splats = total;
 	cloud.positions.resize(total);
-	cloud.scales   .resize(total);
-	cloud.rotations.resize(total);
-	cloud.colours  .resize(total);
 
 	for(size_t m=0; m<cloud.members.size(); ++m)
 		bakeMember(cloud, cloud.members[m]);
 
-	cloud.ob->num_instances_to_draw = (int)total;
-
 	ensureGpuCapacity(cloud, total);
 
 	uploadTexelRowsForSplatRange(cloud, 0, total);
-	writeIdentityIndices(cloud, 0, total);
+	writeUnsortedIndices(cloud);
 
 	rebuildCloudAABB(cloud);
 	addCloudToEngineIfNeeded(cloud);
@@ -832,23 +1320,50 @@ void GaussianSplatRenderer::mergeIntersectingClouds(SplatCloud& seed_cloud)
 }
 
 
-GaussianSplatRenderer::Handle GaussianSplatRenderer::addObject(const GaussianSplatDataRef& splat_data, const Vec4f& translation_ws,
+GaussianSplatRenderer::Handle GaussianSplatRenderer::addObject(const GaussianSplatDataRef& splat_data, const GaussianSplatChunksRef& chunks, const Vec4f& translation_ws,
 	const Quat<float>& rotation_ws, float uniform_scale_ws)
 {
-	buildShadersIfNeeded();
+	CloudMember member;
+	member.splat_data = splat_data;
+	member.chunks = chunks;
+	member.translation_ws = translation_ws;
+	member.rotation_ws = rotation_ws;
+	member.uniform_scale_ws = uniform_scale_ws;
+	return addMember(member);
+}
 
-	const size_t max_splats = maxSplatsPerCloud();
-	if(splat_data->numSplats() > max_splats)
-		throw glare::Exception("Can't render a splat cloud with " + toString(splat_data->numSplats()) + " splats: the per-cloud limit is " + toString(max_splats) + ".");
 
+GaussianSplatRenderer::Handle GaussianSplatRenderer::addObject(const QuantisedGaussianSplatDataRef& splat_data, const GaussianSplatChunksRef& chunks, const Vec4f& translation_ws,
+	const Quat<float>& rotation_ws, float uniform_scale_ws)
+{
 	CloudMember member;
-	member.handle = next_handle++;
-	member.splat_data = splat_data;
-	member.offset = 0; // Assigned by appendMemberToCloud().
-	member.count = splat_data->numSplats();
+	member.quantised_splat_data = splat_data;
+	member.chunks = chunks;
 	member.translation_ws = translation_ws;
 	member.rotation_ws = rotation_ws;
 	member.uniform_scale_ws = uniform_scale_ws;
+	return addMember(member);
+}
+
+
+GaussianSplatRenderer::Handle GaussianSplatRenderer::addMember(CloudMember& member)
+{
+	// The chunks' splat_order indexes the source data, so would read out of bounds if built from something else.
+	const size_t num_source_splats = member.quantised_splat_data.nonNull() ? member.quantised_splat_data->numSplats() : member.splat_data->numSplats();
+	if(member.chunks.isNull() || member.chunks->numSplats() != num_source_splats)
+		throw glare::Exception("The splat chunks passed to GaussianSplatRenderer::addObject() weren't built from the splat data.");
+
+	buildShadersIfNeeded();
+
+	member.count = member.chunks->numSplats() + member.chunks->numLODSplats();
+
+	const size_t max_splats = maxSplatsPerCloud();
+	if(member.count > max_splats)
+		throw glare::Exception("Can't render a splat cloud with " + toString(member.chunks->numSplats()) + " splats: with its coarse LOD splats that is " + toString(member.count) +
+			", and the per-cloud limit is " + toString(max_splats) + ".");
+
+	member.handle = next_handle++;
+	member.offset = 0; // Assigned by appendMemberToCloud().
 
 	// Start the member in a cloud of its own and then let the partitioning merge it, rather than deciding up front
 	// which cloud it belongs in.  Baking is what produces the member's bounds, and the bounds are what the merge test
@@ -887,6 +1402,7 @@ bool GaussianSplatRenderer::updateObjectTransform(Handle handle, const Vec4f& tr
 			// This member's splats may now be in the wrong depth order relative to the rest of the cloud.  This doesn't
 			// bump structure_generation: offsets and counts are unchanged, so an in-flight sort's indices stay meaningful.
 			cloud.have_last_sort_cam_pos = false;
+			cloud.positions_version++;
 
 			// The cloud's bounds have moved, so it may now touch clouds it didn't before.  Note that the reverse is not
 			// checked: a cloud is never split back apart once merged.  An over-merged cloud draws correctly, just with
@@ -968,6 +1484,10 @@ void GaussianSplatRenderer::drainSortResults()
 			free_scratch.push_back(msg->scratch);
 			if(cloud)
 				cloud->sort_in_flight = false;
+			if(msg->incremental)
+				num_incremental_sorts++;
+			else
+				num_full_sorts++;
 		}
 
 		// Drop results for a cloud that has since been merged away or removed, and results computed before a
@@ -991,12 +1511,17 @@ void GaussianSplatRenderer::drainSortResults()
 
 		if(!superseded_this_frame)
 		{
-			// The snapshot this was computed from may be a strict prefix of the current, possibly since-grown cloud.
-			// Only write as many bytes as the result actually covers: any appended tail beyond it already holds valid
-			// identity-order indices written by appendMemberToCloud().
+			// The result only holds the splats of the chunks selected when the sort was kicked off.  If the selection has
+			// changed since, it is still drawn - better than the older order it replaces - and the change has already
+			// requested another sort.
 			const js::Vector<uint32, 16>& sorted_indices = msg->sortedIndices();
-			cloud->instance_index_vbo->updateData(0, sorted_indices.data(), sorted_indices.size() * sizeof(uint32));
+			if(!sorted_indices.empty())
+				cloud->instance_index_vbo->updateData(0, sorted_indices.data(), sorted_indices.size() * sizeof(uint32));
+			cloud->ob->num_instances_to_draw = (int)sorted_indices.size();
 		}
+
+		if(msg->stage == GaussianSplatSortResultMsg::Stage_Precise)
+			keepLastSortedOrder(*cloud, *msg);
 	}
 
 	completed_msgs.clear(); // Drop the references, so a scratch just returned to the pool isn't kept alive by a stale message.
@@ -1044,6 +1569,15 @@ void GaussianSplatRenderer::kickOffSorts()
 		if(best_cloud == NULL)
 			break;
 
+		if(best_cloud->num_selected_splats == 0)
+		{
+			// Every chunk is culled, so there is nothing to sort or draw.
+			best_cloud->ob->num_instances_to_draw = 0;
+			best_cloud->have_last_sort_cam_pos = true;
+			best_cloud->last_sort_cam_pos_ws = cam_pos_ws;
+			continue;
+		}
+
 		Reference<GaussianSplatSortScratch> scratch;
 		if(free_scratch.empty())
 			scratch = new GaussianSplatSortScratch();
@@ -1053,10 +1587,7 @@ void GaussianSplatRenderer::kickOffSorts()
 			free_scratch.pop_back();
 		}
 
-		// Freeze a snapshot of the cloud's current positions on the main thread before handing off to the worker, so the
-		// worker never touches the live, growable arrays.
-		scratch->positions_snapshot.resizeNoCopy(best_cloud->total_splats);
-		std::memcpy(scratch->positions_snapshot.data(), best_cloud->positions.data(), best_cloud->total_splats * sizeof(Vec3f));
+		prepareSortSnapshot(*best_cloud, *scratch);
 
 		best_cloud->sort_in_flight = true;
 		best_cloud->have_last_sort_cam_pos = true;
@@ -1066,7 +1597,8 @@ void GaussianSplatRenderer::kickOffSorts()
 		Matrix4f world_to_cam;
 		scene->cam_to_world.getInverseForAffine3Matrix(world_to_cam);
 
-		task_manager->addTask(new GaussianSplatSortTask(best_cloud->cloud_id, best_cloud->structure_generation, scratch, world_to_cam, &sort_result_queue));
+		task_manager->addTask(new GaussianSplatSortTask(best_cloud->cloud_id, best_cloud->structure_generation, best_cloud->positions_version, best_cloud->selection_version, scratch,
+			world_to_cam, &sort_result_queue, task_manager));
 	}
 }
 
@@ -1088,13 +1620,522 @@ void GaussianSplatRenderer::think()
 	const float focal_x = (float)viewport_dims.x * scene->lens_sensor_dist / scene->use_sensor_width;
 	const float focal_y = (float)viewport_dims.y * scene->lens_sensor_dist / scene->use_sensor_height;
 
+	GaussianSplatChunks::ViewParams view_params;
+	view_params.frustum_planes = scene->frustum_clip_planes;
+	view_params.num_frustum_planes = scene->num_frustum_clip_planes;
+	view_params.cam_pos_ws = scene->cam_to_world.getColumn(3);
+	view_params.lod_dist_factor = myMax(focal_x, focal_y) / max_coarse_lod_error_px;
+
 	for(size_t i=0; i<clouds.size(); ++i)
 	{
 		OpenGLMaterial& mat = clouds[i]->ob->materials[0];
 		mat.user_uniform_vals[0].vec2 = Vec2f((float)viewport_dims.x, (float)viewport_dims.y);
 		mat.user_uniform_vals[1].vec2 = Vec2f(focal_x, focal_y);
 		// user_uniform_vals[2] (splat_tex_width) is constant, and was set in allocCloud().
+
+		updateChunkSelection(*clouds[i], view_params);
 	}
 
 	kickOffSorts();
 }
+
+
+#if BUILD_TESTS
+
+
+#include "../maths/PCG32.h"
+#include "../utils/TestUtils.h"
+#include <algorithm>
+
+
+namespace
+{
+
+
+// Sets up scratch.items for the camera at campos_ws the same way GaussianSplatSortTask does: inverted linear distance keys over the
+// snapshot's distance range, so that ascending key order is farthest-first.
+void computeTestSortItems(GaussianSplatSortScratch& scratch, const Vec3f& campos_ws)
+{
+	const size_t num = scratch.positions_snapshot.size();
+	scratch.items.resizeNoCopy(num);
+	scratch.working_space.resizeNoCopy(num);
+
+	float min_dist = std::numeric_limits<float>::max();
+	float max_dist = 0;
+	for(size_t i=0; i<num; ++i)
+	{
+		const float dist = (scratch.positions_snapshot[i] - campos_ws).length();
+		min_dist = myMin(min_dist, dist);
+		max_dist = myMax(max_dist, dist);
+	}
+	const double key_scale = (double)std::numeric_limits<uint32>::max() / (double)myMax(max_dist - min_dist, 1.0e-9f);
+	for(size_t i=0; i<num; ++i)
+	{
+		scratch.items[i].key = (uint32)((double)(max_dist - (scratch.positions_snapshot[i] - campos_ws).length()) * key_scale);
+		scratch.items[i].snapshot_index = (uint32)i;
+	}
+}
+
+
+void stableSortByKey(js::Vector<SortItem, 16>& items)
+{
+	std::stable_sort(items.begin(), items.end(), [](const SortItem& a, const SortItem& b) { return a.key < b.key; });
+}
+
+
+void testSortItemsEqual(const js::Vector<SortItem, 16>& a, const js::Vector<SortItem, 16>& b)
+{
+	testAssert(a.size() == b.size());
+	for(size_t i=0; i<a.size(); ++i)
+	{
+		testAssert(a[i].key == b[i].key);
+		testAssert(a[i].snapshot_index == b[i].snapshot_index);
+	}
+}
+
+
+// Checks that items is a permutation of the snapshot indices 0..items.size()-1.
+void testIsSnapshotIndexPermutation(const js::Vector<SortItem, 16>& items)
+{
+	std::vector<bool> seen(items.size(), false);
+	for(size_t i=0; i<items.size(); ++i)
+	{
+		testAssert(items[i].snapshot_index < items.size());
+		testAssert(!seen[items[i].snapshot_index]);
+		seen[items[i].snapshot_index] = true;
+	}
+}
+
+
+// Checks that order is a permutation of all the splats, in back-to-front order as seen from campos_ws.
+void testIsBackToFront(const js::Vector<uint32, 16>& order, const js::Vector<Vec3f, 16>& positions, const Vec3f& campos_ws)
+{
+	testAssert(order.size() == positions.size());
+	std::vector<bool> seen(positions.size(), false);
+	for(size_t i=0; i<order.size(); ++i)
+	{
+		testAssert(order[i] < positions.size());
+		testAssert(!seen[order[i]]);
+		seen[order[i]] = true;
+
+		// Allow for key quantisation, and for the sort task computing distances through world_to_cam rather than directly.
+		if(i > 0)
+			testAssert((positions[order[i - 1]] - campos_ws).length() >= (positions[order[i]] - campos_ws).length() - 1.0e-3f);
+	}
+}
+
+
+// Checks that order holds the splats of the cloud's selected chunks, in back-to-front order as seen from campos_ws.
+void testIsBackToFrontSelection(const js::Vector<uint32, 16>& order, const SplatCloud& cloud, const Vec3f& campos_ws)
+{
+	js::Vector<uint32, 16> selected_indices;
+	js::Vector<Vec3f, 16> selected_positions;
+	gatherSelectedSplats(cloud, selected_indices, selected_positions);
+
+	std::vector<uint32> sorted_order(order.begin(), order.end());
+	std::vector<uint32> sorted_selected_indices(selected_indices.begin(), selected_indices.end());
+	std::sort(sorted_order.begin(), sorted_order.end());
+	std::sort(sorted_selected_indices.begin(), sorted_selected_indices.end());
+	testAssert(sorted_order == sorted_selected_indices);
+
+	for(size_t i=1; i<order.size(); ++i)
+		testAssert((cloud.positions[order[i - 1]] - campos_ws).length() >= (cloud.positions[order[i]] - campos_ws).length() - 1.0e-3f);
+}
+
+
+// Runs a GaussianSplatSortTask for the camera at campos_ws, and returns the precise result message, checking that a coarse
+// result is posted before it exactly when the sort wasn't incremental.
+Reference<GaussianSplatSortResultMsg> runTestSortTask(glare::TaskManager& task_manager, const Reference<GaussianSplatSortScratch>& scratch, const Vec3f& campos_ws, uint64 selection_version = 1)
+{
+	ThreadSafeQueue<Reference<ThreadMessage> > result_queue;
+	GaussianSplatSortTask task(/*cloud_id=*/1, /*generation=*/1, /*positions_version=*/1, selection_version, scratch,
+		Matrix4f::translationMatrix(-campos_ws.x, -campos_ws.y, -campos_ws.z), &result_queue, &task_manager);
+	task.run(0);
+
+	testAssert(result_queue.size() == 1 || result_queue.size() == 2);
+	const bool got_coarse = result_queue.size() == 2;
+
+	Reference<ThreadMessage> msg;
+	if(got_coarse)
+	{
+		result_queue.dequeue(msg);
+		testAssert(msg.downcast<GaussianSplatSortResultMsg>()->stage == GaussianSplatSortResultMsg::Stage_Coarse);
+	}
+	result_queue.dequeue(msg);
+	Reference<GaussianSplatSortResultMsg> precise = msg.downcast<GaussianSplatSortResultMsg>();
+	testAssert(precise->stage == GaussianSplatSortResultMsg::Stage_Precise);
+	testAssert(precise->incremental == !got_coarse);
+	return precise;
+}
+
+
+} // end anonymous namespace
+
+
+void GaussianSplatRenderer::test()
+{
+	conPrint("GaussianSplatRenderer::test()");
+
+	PCG32 rng(1);
+
+	//------------ insertionSortWithMoveLimit(): matches a full stable sort when within the move limit ------------
+	{
+		// Nearly sorted keys, with duplicates, so that stability matters.
+		js::Vector<SortItem, 16> items(1000);
+		for(size_t i=0; i<items.size(); ++i)
+		{
+			items[i].key = (uint32)(i / 4 + rng.nextUInt(8));
+			items[i].snapshot_index = (uint32)i;
+		}
+		js::Vector<SortItem, 16> ref = items;
+		stableSortByKey(ref);
+
+		testAssert(insertionSortWithMoveLimit(items.data(), items.size(), /*max moves=*/std::numeric_limits<size_t>::max()));
+		testSortItemsEqual(items, ref);
+
+		// Already sorted input needs no moves at all.
+		testAssert(insertionSortWithMoveLimit(items.data(), items.size(), /*max moves=*/0));
+		testSortItemsEqual(items, ref);
+
+		testAssert(insertionSortWithMoveLimit(items.data(), /*num_items=*/0, /*max moves=*/0));
+	}
+
+	//------------ insertionSortWithMoveLimit(): bails out once over the move limit ------------
+	{
+		// Reversed keys need n(n-1)/2 moves.
+		js::Vector<SortItem, 16> items(1000);
+		for(size_t i=0; i<items.size(); ++i)
+		{
+			items[i].key = (uint32)(items.size() - i);
+			items[i].snapshot_index = (uint32)i;
+		}
+
+		testAssert(!insertionSortWithMoveLimit(items.data(), items.size(), /*max moves=*/items.size() * 4));
+		testIsSnapshotIndexPermutation(items); // Left in some permutation of the input.
+
+		// Exactly at the limit is still allowed.
+		for(size_t i=0; i<items.size(); ++i)
+		{
+			items[i].key = (uint32)(items.size() - i);
+			items[i].snapshot_index = (uint32)i;
+		}
+		testAssert(insertionSortWithMoveLimit(items.data(), items.size(), /*max moves=*/items.size() * (items.size() - 1) / 2));
+		for(size_t i=0; i<items.size(); ++i)
+			testAssert(items[i].key == (uint32)(i + 1));
+	}
+
+	// A dense cloud around the origin, plus one distant floater.  The floater stretches the distance range, and so the linear
+	// key range, so the dense cloud's splats share a few hundred buckets of the incremental sort's counting pass, with many
+	// splats per bucket.  Their order within each bucket is then down to the previous order, which is what a large camera
+	// jump invalidates.
+	const size_t num_splats = 20000;
+	js::Vector<Vec3f, 16> positions(num_splats);
+	for(size_t i=0; i<num_splats - 1; ++i)
+		positions[i] = Vec3f(rng.unitRandom() - 0.5f, rng.unitRandom() - 0.5f, rng.unitRandom() - 0.5f);
+	positions[num_splats - 1] = Vec3f(0, 0, 1000.f);
+
+	const Vec3f campos_a(5.f, 0, 0);
+	const Vec3f campos_a_moved(5.001f, 0.001f, 0);
+	const Vec3f campos_b(-5.f, 0, 0); // A jump to the opposite side of the cloud, which reverses its order.
+
+	//------------ sortIncrementally(): matches a full sort after a small camera move, and bails out after a large jump ------------
+	{
+		GaussianSplatSortScratch scratch;
+
+		// Sort from scratch for campos_a, and put the snapshot into that order, as the renderer does for the next sort.
+		scratch.positions_snapshot = positions;
+		computeTestSortItems(scratch, campos_a);
+		stableSortByKey(scratch.items);
+		{
+			js::Vector<Vec3f, 16> sorted_positions(num_splats);
+			for(size_t i=0; i<num_splats; ++i)
+				sorted_positions[i] = positions[scratch.items[i].snapshot_index];
+			scratch.positions_snapshot = sorted_positions;
+		}
+
+		// Small move
+		computeTestSortItems(scratch, campos_a_moved);
+		const js::Vector<SortItem, 16> items_before = scratch.items;
+		js::Vector<SortItem, 16> ref = scratch.items;
+		stableSortByKey(ref);
+
+		testAssert(sortIncrementally(scratch));
+		testSortItemsEqual(scratch.working_space, ref);
+		testSortItemsEqual(scratch.items, items_before); // items is left unmodified.
+
+		// Large jump: gives up rather than finishing with a very long insertion sort.
+		computeTestSortItems(scratch, campos_b);
+		const js::Vector<SortItem, 16> items_before_jump = scratch.items;
+
+		testAssert(!sortIncrementally(scratch));
+		testSortItemsEqual(scratch.items, items_before_jump);
+		testIsSnapshotIndexPermutation(scratch.working_space);
+	}
+
+	//------------ GaussianSplatSortTask: incremental after a small move, falling back to the full sort after a large jump ------------
+	{
+		glare::TaskManager task_manager(2);
+		Reference<GaussianSplatSortScratch> scratch = new GaussianSplatSortScratch();
+
+		// First sort: no previous order to start from.
+		scratch->positions_snapshot = positions;
+		scratch->previous_order.resize(num_splats);
+		for(size_t i=0; i<num_splats; ++i)
+			scratch->previous_order[i] = (uint32)i;
+		scratch->in_previous_order = false;
+
+		Reference<GaussianSplatSortResultMsg> msg = runTestSortTask(task_manager, scratch, campos_a);
+		testAssert(!msg->incremental);
+		testIsBackToFront(msg->sortedIndices(), positions, campos_a);
+
+		// Small move: sorted incrementally, starting from the previous result.
+		scratch->positions_snapshot = js::Vector<Vec3f, 16>(scratch->sorted_positions);
+		scratch->previous_order = js::Vector<uint32, 16>(scratch->precise_indices);
+		scratch->in_previous_order = true;
+
+		msg = runTestSortTask(task_manager, scratch, campos_a_moved);
+		testAssert(msg->incremental);
+		testIsBackToFront(msg->sortedIndices(), positions, campos_a_moved);
+
+		// Large jump: the incremental sort gives up, and the task falls back to the coarse and full precise sorts.
+		scratch->positions_snapshot = js::Vector<Vec3f, 16>(scratch->sorted_positions);
+		scratch->previous_order = js::Vector<uint32, 16>(scratch->precise_indices);
+		scratch->in_previous_order = true;
+
+		msg = runTestSortTask(task_manager, scratch, campos_b);
+		testAssert(!msg->incremental);
+		testIsBackToFront(msg->sortedIndices(), positions, campos_b);
+	}
+
+	//------------ Texel packing reads each member's source data, quantised or not, with the member's pose applied ------------
+	{
+		GaussianSplatDataRef splat_data = new GaussianSplatData();
+		for(size_t i=0; i<5000; ++i)
+		{
+			const Vec3f pos(rng.unitRandom(), rng.unitRandom(), rng.unitRandom());
+			splat_data->positions.push_back(pos);
+			splat_data->scales.push_back(Vec3f(0.01f + rng.unitRandom() * 0.04f, 0.01f + rng.unitRandom() * 0.04f, 0.01f + rng.unitRandom() * 0.04f));
+			splat_data->rotations.push_back(normalise(Vec4f(rng.unitRandom() - 0.5f, rng.unitRandom() - 0.5f, rng.unitRandom() - 0.5f, rng.unitRandom() - 0.5f)));
+			splat_data->colours.push_back(Vec4f(rng.unitRandom(), rng.unitRandom(), rng.unitRandom(), rng.unitRandom()));
+			splat_data->aabb_os.enlargeToHoldPoint(Vec4f(pos.x, pos.y, pos.z, 1.f));
+		}
+		QuantisedGaussianSplatDataRef quantised = QuantisedGaussianSplatData::quantise(*splat_data);
+
+		// Two members of one cloud: the first with the unquantised data, the second with the quantised data.
+		SplatCloud cloud;
+		for(int m=0; m<2; ++m)
+		{
+			CloudMember member;
+			member.handle = m + 1;
+			if(m == 0)
+				member.splat_data = splat_data;
+			else
+				member.quantised_splat_data = quantised;
+			member.chunks = (m == 0) ? GaussianSplatChunks::build(*splat_data) : GaussianSplatChunks::build(*quantised);
+			member.offset = cloud.total_splats;
+			member.count = member.chunks->numSplats() + member.chunks->numLODSplats();
+			member.translation_ws = Vec4f(10.f, 0, (float)m, 1);
+			member.rotation_ws = Quat<float>::fromAxisAndAngle(normalise(Vec3f(1, 1, 0)), 0.5f);
+			member.uniform_scale_ws = 2.f;
+
+			cloud.total_splats += member.count;
+			cloud.positions.resize(cloud.total_splats);
+			cloud.members.push_back(member);
+			bakeMember(cloud, cloud.members.back());
+		}
+
+		js::Vector<float, 16> texels(cloud.total_splats * texels_per_splat * 4, 0.f);
+		packSplatTexels(cloud, 0, cloud.total_splats, texels.data());
+
+		// Packing a sub-range straddling the two members should give the same texels.
+		{
+			const size_t begin = cloud.members[0].count - 10;
+			const size_t end = cloud.members[0].count + 10;
+			js::Vector<float, 16> range_texels((end - begin) * texels_per_splat * 4, 0.f);
+			packSplatTexels(cloud, begin, end, range_texels.data());
+			for(size_t i=0; i<range_texels.size(); ++i)
+				testAssert(range_texels[i] == texels[begin * texels_per_splat * 4 + i]);
+		}
+
+		// Check each member's source splats against the original data with the pose applied.  The quantised member is
+		// allowed its quantisation error.
+		for(int m=0; m<2; ++m)
+		{
+			const CloudMember& member = cloud.members[m];
+			const float pos_eps    = (m == 0) ? 1.0e-5f : 1.0e-3f;
+			const float scale_eps  = (m == 0) ? 1.0e-6f : 1.0e-3f;
+			const float colour_eps = (m == 0) ? 0.f : 0.01f;
+			for(size_t z=0; z<member.chunks->numSplats(); ++z)
+			{
+				const size_t src_i = member.chunks->splat_order[z];
+				const float* t = &texels[(member.offset + z) * texels_per_splat * 4];
+
+				const Vec3f os_pos = splat_data->positions[src_i];
+				const Vec4f expected_pos = member.translation_ws + member.rotation_ws.rotateVector(Vec4f(os_pos.x, os_pos.y, os_pos.z, 0.f) * member.uniform_scale_ws);
+				for(int c=0; c<3; ++c)
+				{
+					testAssert(std::fabs(t[c] - expected_pos[c]) <= pos_eps);
+					testAssert(t[c] == cloud.positions[member.offset + z][c]);
+					testAssert(std::fabs(t[3 + c] - splat_data->scales[src_i][c] * member.uniform_scale_ws) <= scale_eps);
+					testAssert(std::fabs(t[10 + c] - splat_data->colours[src_i][c]) <= colour_eps);
+				}
+				testAssert(std::fabs(t[13] - splat_data->colours[src_i][3]) <= colour_eps);
+
+				const Vec4f os_rot = splat_data->rotations[src_i];
+				const Vec4f expected_rot = (member.rotation_ws * Quat<float>(os_rot[0], os_rot[1], os_rot[2], os_rot[3])).v;
+				testAssert(std::fabs(dot(Vec4f(t[6], t[7], t[8], t[9]), expected_rot)) > 0.999f); // q and -q are the same rotation.
+			}
+		}
+	}
+
+	//------------ Chunk selection changes: small ones are patched into the last sorted order, so the next sort stays incremental ------------
+	{
+		glare::TaskManager task_manager(2);
+
+		// 16 clusters of 4096 splats spaced out along the x axis.  The chunks are built by median splits along the longest axis,
+		// so each cluster is one chunk, and a plane across the x axis culls whole clusters.
+		const size_t num_clusters = 16;
+		const size_t splats_per_cluster = 4096;
+		GaussianSplatDataRef splat_data = new GaussianSplatData();
+		for(size_t c=0; c<num_clusters; ++c)
+			for(size_t i=0; i<splats_per_cluster; ++i)
+			{
+				const Vec3f pos((float)c * 10.f + rng.unitRandom(), rng.unitRandom(), rng.unitRandom());
+				splat_data->positions.push_back(pos);
+				splat_data->scales.push_back(Vec3f(0.01f));
+				splat_data->rotations.push_back(Vec4f(0, 0, 0, 1));
+				splat_data->colours.push_back(Vec4f(1, 1, 1, 0.5f));
+				splat_data->aabb_os.enlargeToHoldPoint(Vec4f(pos.x, pos.y, pos.z, 1.f));
+			}
+
+		// Set up a cloud holding it the way appendMemberToCloud() does, minus the GL parts.
+		SplatCloud cloud;
+		{
+			CloudMember member;
+			member.handle = 1;
+			member.splat_data = splat_data;
+			member.chunks = GaussianSplatChunks::build(*splat_data);
+			member.offset = 0;
+			member.count = member.chunks->numSplats() + member.chunks->numLODSplats();
+			member.translation_ws = Vec4f(0, 0, 0, 1);
+			member.rotation_ws = Quat<float>::identity();
+			member.uniform_scale_ws = 1.f;
+			testAssert(member.chunks->chunks.size() == num_clusters);
+
+			cloud.total_splats = member.count;
+			cloud.positions.resize(cloud.total_splats);
+			cloud.members.push_back(member);
+			bakeMember(cloud, cloud.members.back());
+
+			cloud.chunk_lods.resize(num_clusters, (uint8)GaussianSplatChunks::ChunkLOD_Culled);
+			cloud.structure_generation = 1; // Matching the results runTestSortTask() returns.
+			cloud.positions_version = 1;
+		}
+
+		// A view that sees everything at full detail.  Frustum planes are added below to cull clusters.
+		GaussianSplatChunks::ViewParams view_params;
+		view_params.frustum_planes = NULL;
+		view_params.num_frustum_planes = 0;
+		view_params.cam_pos_ws = Vec4f(-20.f, 0.5f, 0.5f, 1.f);
+		view_params.lod_dist_factor = 1.0e10f; // Never coarse.
+		Vec3f campos(-20.f, 0.5f, 0.5f);
+
+		Reference<GaussianSplatSortScratch> scratch = new GaussianSplatSortScratch();
+
+		// Kicks off a sort as kickOffSorts() does, runs it, and keeps the result as drainSortResults() does.  Returns whether the
+		// snapshot was in the previous order, and checks the sort was then incremental.
+		auto sortCloud = [&]() -> bool
+		{
+			prepareSortSnapshot(cloud, *scratch);
+			const bool in_previous_order = scratch->in_previous_order;
+			if(in_previous_order)
+			{
+				// The snapshot should hold the positions of the splats of the current selection.
+				testAssert(scratch->previous_order.size() == cloud.num_selected_splats);
+				for(size_t i=0; i<scratch->previous_order.size(); ++i)
+					testAssert(scratch->positions_snapshot[i] == cloud.positions[scratch->previous_order[i]]);
+			}
+
+			Reference<GaussianSplatSortResultMsg> msg = runTestSortTask(task_manager, scratch, campos, cloud.selection_version);
+			testAssert(msg->incremental == in_previous_order);
+			testIsBackToFrontSelection(msg->sortedIndices(), cloud, campos);
+			keepLastSortedOrder(cloud, *msg);
+			return in_previous_order;
+		};
+
+		// Everything in view: the first sort is from scratch, and the next, after a small move, is incremental.
+		updateChunkSelection(cloud, view_params);
+		testAssert(cloud.num_selected_splats == num_clusters * splats_per_cluster);
+		testAssert(!sortCloud());
+		campos.x += 0.01f;
+		testAssert(sortCloud());
+
+		// Culling the last cluster changes the selection.  That is small enough to patch, so the sort is still incremental.
+		{
+			const uint64 selection_version = cloud.selection_version;
+			const Planef plane(Vec4f(1, 0, 0, 0), 145.f);
+			view_params.frustum_planes = &plane;
+			view_params.num_frustum_planes = 1;
+			updateChunkSelection(cloud, view_params);
+			testAssert(cloud.selection_version != selection_version);
+			testAssert(cloud.num_selected_splats == (num_clusters - 1) * splats_per_cluster);
+			testAssert(sortCloud());
+		}
+
+		// Bringing it back into view is likewise patched.
+		view_params.frustum_planes = NULL;
+		view_params.num_frustum_planes = 0;
+		updateChunkSelection(cloud, view_params);
+		testAssert(cloud.num_selected_splats == num_clusters * splats_per_cluster);
+		testAssert(sortCloud());
+
+		// As is switching a cluster to its coarse LOD splats.
+		cloud.chunk_lods[3] = (uint8)GaussianSplatChunks::ChunkLOD_Coarse;
+		cloud.num_selected_splats = (num_clusters - 1) * splats_per_cluster + splats_per_cluster / GaussianSplatChunks::lod_merge_size;
+		cloud.selection_version++;
+		testAssert(sortCloud());
+
+		// A selection change while a sort is in flight: the result is for the selection the sort was kicked off with, and is
+		// patched to the new selection when the next sort is kicked off.
+		{
+			prepareSortSnapshot(cloud, *scratch);
+			testAssert(scratch->in_previous_order);
+			testAssert(cloud.last_sorted_order.empty()); // Handed to the scratch.
+
+			cloud.chunk_lods[3] = (uint8)GaussianSplatChunks::ChunkLOD_Full;
+			cloud.chunk_lods[0] = (uint8)GaussianSplatChunks::ChunkLOD_Culled;
+			cloud.num_selected_splats = (num_clusters - 1) * splats_per_cluster;
+			const uint64 kicked_off_selection_version = cloud.selection_version++;
+
+			Reference<GaussianSplatSortResultMsg> msg = runTestSortTask(task_manager, scratch, campos, kicked_off_selection_version);
+			testAssert(msg->incremental);
+			keepLastSortedOrder(cloud, *msg);
+			testAssert(cloud.last_sorted_selection_version != cloud.selection_version);
+
+			testAssert(sortCloud());
+		}
+
+		// Culling half the clusters is too large a change to patch, so the sort starts from scratch.
+		{
+			const Planef plane(Vec4f(1, 0, 0, 0), 75.f);
+			view_params.frustum_planes = &plane;
+			view_params.num_frustum_planes = 1;
+			updateChunkSelection(cloud, view_params);
+			testAssert(cloud.num_selected_splats == 8 * splats_per_cluster);
+			testAssert(!sortCloud());
+			testAssert(sortCloud()); // And then incremental again.
+		}
+
+		// Renumbering the cloud invalidates the last sorted order whatever the selection does.
+		cloud.structure_generation++;
+		view_params.num_frustum_planes = 0;
+		updateChunkSelection(cloud, view_params);
+		prepareSortSnapshot(cloud, *scratch);
+		testAssert(!scratch->in_previous_order);
+	}
+
+	conPrint("GaussianSplatRenderer::test() done.");
+}
+
+
+#endif // BUILD_TESTS
@@ -6,7 +6,9 @@ Copyright Glare Technologies Limited 2026 -
 #pragma once
 
 
+#include "../graphics/GaussianSplatChunks.h"
 #include "../graphics/GaussianSplatData.h"
+#include "../graphics/QuantisedGaussianSplatData.h"
 #include "../maths/Quat.h"
 #include "../maths/Vec4f.h"
 #include "../physics/jscol_aabbox.h"
@@ -67,7 +69,25 @@ centres alone.
 
 Within a cloud, splat data is baked into world space, so the GLObject's
 ob_to_world_matrix stays identity, and each member owns a [offset, count) range
-of the shared arrays.
+of the shared arrays.  Only the world-space positions are kept on the CPU, for
+the depth sort and bounds.  The data texture is packed from each member's
+source data, quantised or not, with the pose applied as it is packed.
+
+Chunks
+------
+Each member's splats are also split into spatially compact chunks, each with a
+coarse LOD of merged splats - see GaussianSplatChunks.  A member's range holds
+its splats in chunk order, followed by the coarse LOD splats of all its chunks.
+Every frame, think() culls each chunk against the view frustum, and picks its
+coarse LOD if that is within max_coarse_lod_error_px of the full detail on screen.
+Only the splats of the selected chunks are sorted and drawn, so most of a large
+cloud that is out of view, or far away, costs nothing to sort.
+
+A change in the selection requests a re-sort, and is drawn when that lands:
+until then the cloud is drawn with the previous selection.  So a chunk coming
+into view at the edge of the screen can appear a few frames late.  A small
+change is patched into the cloud's last sorted order, so that re-sort can
+still be incremental - see below.
 
 The depth sort runs on a worker thread in two stages: a fast approximate
 counting sort is posted first so the view updates promptly, followed by a
@@ -75,16 +95,21 @@ precise radix sort.  Splats are sorted by distance from the camera rather than
 by depth along the view axis, which makes the resulting order invariant to
 camera rotation, so only camera *movement* triggers a re-sort - and the distance
 a cloud's camera must move to earn one scales with how far away the cloud is.
+(Rotation can still change which chunks are selected, which does trigger one.)
+
+Re-sorts are usually incremental: each cloud keeps its last precise order, and
+its positions permuted into that order, and the next sort starts from there.
+After a camera move that order is still nearly sorted, which makes a single
+fine bucketing pass plus an insertion sort about twice as fast as sorting from
+scratch.  After a large move the insertion sort gives up, and the two-stage
+sort above is used instead.
 
 Concurrency: a sort worker never reads the live splat arrays, since the main
-thread can reallocate them.  think() copies the positions into a snapshot buffer
-on the main thread when it kicks a sort off, and the worker only reads that.  A
-plain append while a sort is in flight is safe without extra bookkeeping,
-because the in-flight result only covers a prefix of the splats and the appended
-tail is already in identity order.  Anything that renumbers a cloud bumps its
-structure_generation, which every result carries and which think() checks before
-applying a result; results for a cloud that has since been merged away are
-dropped by cloud id.
+thread can reallocate them.  think() copies the selected splats' positions into
+a snapshot buffer on the main thread when it kicks a sort off, and the worker
+only reads that.  Anything that renumbers a cloud bumps its structure_generation,
+which every result carries and which think() checks before applying a result;
+results for a cloud that has since been merged away are dropped by cloud id.
 
 Not handled:
  - order-independent transparency.
@@ -106,10 +131,17 @@ public:
 	static const Handle invalid_handle = 0;
 
 	// Bakes splat_data's positions/scales/rotations into world space with the given pose, and registers the result.
+	// chunks must have been built from splat_data by GaussianSplatChunks::build().  That takes a while for a large cloud,
+	// so should be done on the thread that loaded the splat data, not the render thread this is called on.
 	// Note that non-uniform scaling isn't supported.
 	//
-	// Throws glare::Exception if splat_data has more splats than maxSplatsPerCloud()
-	Handle addObject(const GaussianSplatDataRef& splat_data, const Vec4f& translation_ws, const Quat<float>& rotation_ws, float uniform_scale_ws);
+	// Throws glare::Exception if splat_data has more splats than maxSplatsPerCloud(), or if chunks wasn't built from it.
+	Handle addObject(const GaussianSplatDataRef& splat_data, const GaussianSplatChunksRef& chunks, const Vec4f& translation_ws, const Quat<float>& rotation_ws, float uniform_scale_ws);
+
+	// As above, but keeps the quantised data as the object's source data, instead of the ~3x larger unquantised data.
+	// The data texture is packed from the quantised data, and the depth sort works from positions decoded from it.
+	// See SOGDecoder::decodeQuantised() for loading straight to this form.
+	Handle addObject(const QuantisedGaussianSplatDataRef& splat_data, const GaussianSplatChunksRef& chunks, const Vec4f& translation_ws, const Quat<float>& rotation_ws, float uniform_scale_ws);
 
 	// Re-bakes a cloud with a new pose.  Returns false if the handle isn't valid.
 	bool updateObjectTransform(Handle handle, const Vec4f& translation_ws, const Quat<float>& rotation_ws, float uniform_scale_ws);
@@ -144,6 +176,9 @@ public:
 	// OpenGLEngine::draw(), after the frame's camera transform has been set.
 	void think();
 
+	// Tests the depth-sort routines.  Doesn't need an OpenGL context.
+	static void test();
+
 private:
 	GLARE_DISABLE_COPY(GaussianSplatRenderer);
 
@@ -156,9 +191,10 @@ private:
 	void ensureGpuCapacity(SplatCloud& cloud, size_t needed_splats); // Grows the data texture and instance index VBO if needed.
 	void rebuildVAO(SplatCloud& cloud); // Rebuilds vert_vao against the current instance index VBO - needed whenever that VBO is replaced.
 	void uploadTexelRowsForSplatRange(SplatCloud& cloud, size_t first_splat, size_t num_splats_to_upload); // Repacks and re-uploads just the texture rows spanning the given splat range.
-	void writeIdentityIndices(SplatCloud& cloud, size_t first_splat, size_t num_splats); // Writes an identity draw order over the given range of the instance index VBO.
+	void writeUnsortedIndices(SplatCloud& cloud); // Selects every chunk at full detail, and writes those splats to the instance index VBO in index order.
 	void rebuildCloudAABB(SplatCloud& cloud); // Recomputes the cloud AABB as the union of its members' bounds.  O(num members), not O(num splats).
 
+	Handle addMember(CloudMember& member); // Puts the member in a new cloud, then merges as needed.  Assigns member.handle.
 	void appendMemberToCloud(SplatCloud& cloud, const CloudMember& member); // Fast path: bakes one member onto the tail and uploads only the affected rows.  member.offset is assigned here.
 	void rebuildCloud(SplatCloud& cloud); // Re-bakes every member from its stored pose.  Used after a merge or a removal, where offsets change.
 	void mergeIntersectingClouds(SplatCloud& seed_cloud); // Merges any cloud whose AABB intersects seed_cloud into it, to a fixpoint.
@@ -180,6 +216,8 @@ private:
 	// clouds must not mean N copies of them.  Borrowed for the duration of a sort, returned when its precise result lands.
 	std::vector<Reference<GaussianSplatSortScratch> > free_scratch;
 	int num_sorts_in_flight;
+	uint64 num_incremental_sorts; // Precise sorts completed by re-sorting the previous order - see sortIncrementally() in GaussianSplatRenderer.cpp.
+	uint64 num_full_sorts;
 
 	ThreadSafeQueue<Reference<ThreadMessage> > sort_result_queue; // Shared by every cloud; results carry the cloud id they belong to.
 	js::Vector<Reference<ThreadMessage>, 16> completed_msgs;
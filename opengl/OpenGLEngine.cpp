@@ -23,6 +23,7 @@ Copyright Glare Technologies Limited 2023 -
 #include "TimestampQuery.h"
 #include "BufferedTimeElapsedQuery.h"
 #include "../graphics/TextureProcessing.h"
+#include "../graphics/TextureDiskCache.h"
 #include "../graphics/ImageMap.h"
 #include "../graphics/SRGBUtils.h"
 #include "../graphics/PerlinNoise.h"
@@ -468,6 +469,8 @@ OpenGLEngine::OpenGLEngine(const OpenGLEngineSettings& settings_)
 	tex_CPU_mem_usage(0),
 	tex_GPU_mem_usage(0),
 	last_anim_update_duration(0),
+	last_anim_pose_eval_duration(0),
+	last_anim_apply_duration(0),
 	last_draw_CPU_time(0),
 	last_fps(0),
 	query_profiling_enabled(false),
@@ -500,6 +503,8 @@ OpenGLEngine::OpenGLEngine(const OpenGLEngineSettings& settings_)
 	last_final_imaging_GPU_time(0),
 	last_fog_post_process_GPU_time(0),
 	last_num_animated_obs_processed(0),
+	last_num_shared_anim_poses(0),
+	last_num_animated_obs_lod_skipped(0),
 	last_num_decal_batches_drawn(0),
 	next_program_index(0),
 	use_bindless_textures(false),
@@ -527,6 +532,8 @@ OpenGLEngine::OpenGLEngine(const OpenGLEngineSettings& settings_)
 	global_sky_probe_needs_bake(false),
 	//object_pool_allocator(sizeof(GLObject), /*alignment=*/16, /*block capacity=*/1024),
 	running_in_renderdoc(false),
+	anim_pose_indices(/*empty key=*/AnimationPoseKey()),
+	num_shared_anim_poses(0),
 	add_debug_obs(false),
 	async_texture_loader(NULL),
 	current_bound_phong_uniform_buf_ob_index(0),
@@ -1765,6 +1772,18 @@ void OpenGLEngine::initialise(const std::string& data_dir_, Reference<TextureSer
 	high_priority_task_manager = high_priority_task_manager_;
 	mem_allocator = mem_allocator_;
 
+	if(!settings.texture_disk_cache_dir.empty())
+	{
+		try
+		{
+			texture_disk_cache = new TextureDiskCache(settings.texture_disk_cache_dir, settings.max_texture_disk_cache_size_B);
+		}
+		catch(glare::Exception& e)
+		{
+			conPrint("Warning: failed to create texture disk cache: " + e.what()); // Textures will still be loaded, just without caching.
+		}
+	}
+
 	if(!static_init_done)
 		staticInit();
 
@@ -1815,6 +1834,11 @@ void OpenGLEngine::initialise(const std::string& data_dir_, Reference<TextureSer
 	this->texture_compression_BC6H_support = false; // Initial value, can be enabled by EXT_texture_compression_bptc detection below.
 #else
 	this->texture_compression_BC6H_support = true;
+#endif
+#if EMSCRIPTEN
+	this->texture_compression_RGTC_support = false; // Can be enabled by EXT_texture_compression_rgtc detection below.
+#else
+	this->texture_compression_RGTC_support = true; // RGTC is core in OpenGL 3.0
 #endif
 	this->GL_ARB_bindless_texture_support = false;
 	this->clip_control_support = false;
@@ -1854,6 +1878,7 @@ void OpenGLEngine::initialise(const std::string& data_dir_, Reference<TextureSer
 		if(stringEqual(ext, "EXT_clip_control")) this->clip_control_support = true;
 		if(stringEqual(ext, "OES_texture_float_linear")) this->float_texture_filtering_support = true;
 		if(stringEqual(ext, "EXT_texture_compression_bptc")) this->texture_compression_BC6H_support = true;
+		if(stringEqual(ext, "EXT_texture_compression_rgtc")) this->texture_compression_RGTC_support = true;
 		if(stringEqual(ext, "EXT_disjoint_timer_query_webgl2")) this->EXT_disjoint_timer_query_webgl2_support = true;
 #endif
 	}
@@ -4325,11 +4350,13 @@ static void checkMaterial(const OpenGLMaterial& mat)
 #define SIMPLE_DOUBLE_SIDED_FLAG			128
 #define SWIZZLE_ALBEDO_TEX_R_TO_RGB_FLAG	256 // If the texture is a single channel texture, we want to make it render as greyscale (as opposed to red), e.g. set tex_col.x,y,z = tex_col.x in the frag shader.
 #define CONVERT_ALBEDO_FROM_SRGB_FLAG		512 // convert albedo texture colour from non-linear sRGB to linear sRGB in frag shader
+#define NORMAL_MAP_IS_TWO_CHANNEL_FLAG		1024 // Normal map just stores X and Y (e.g. BC5 compressed), so Z needs to be reconstructed in the frag shader.
 
 
 static int computeUniformFlagsForMat(const OpenGLMaterial& opengl_mat, const OpenGLMeshRenderData& mesh_data)
 {
 	const bool swizzle_albedo_tex_r_to_rgb = opengl_mat.albedo_texture && (opengl_mat.albedo_texture->getInternalFormat() == GL_R8);
+	const bool normal_map_is_two_channel = opengl_mat.normal_map && (opengl_mat.normal_map->getFormat() == OpenGLTextureFormat::Format_Compressed_BC5_Uint8);
 	
 	return
 		(mesh_data.has_shading_normals						? HAVE_SHADING_NORMALS_FLAG			: 0) |
@@ -4341,7 +4368,8 @@ static int computeUniformFlagsForMat(const OpenGLMaterial& opengl_mat, const Ope
 		(opengl_mat.normal_map.nonNull()					? HAVE_NORMAL_MAP_FLAG				: 0) |
 		(opengl_mat.simple_double_sided						? SIMPLE_DOUBLE_SIDED_FLAG			: 0) |
 		(swizzle_albedo_tex_r_to_rgb						? SWIZZLE_ALBEDO_TEX_R_TO_RGB_FLAG	: 0) |
-		(opengl_mat.convert_albedo_from_srgb				? CONVERT_ALBEDO_FROM_SRGB_FLAG		: 0);
+		(opengl_mat.convert_albedo_from_srgb				? CONVERT_ALBEDO_FROM_SRGB_FLAG		: 0) |
+		(normal_map_is_two_channel							? NORMAL_MAP_IS_TWO_CHANNEL_FLAG	: 0);
 }
 
 
@@ -5219,6 +5247,17 @@ Reference<OpenGLTexture> OpenGLEngine::getTexture(const std::string& tex_path, c
 }
 
 
+BlockCompressionOptions OpenGLEngine::getBlockCompressionOptions(const TextureParams& params) const
+{
+	BlockCompressionOptions options;
+	if(params.is_normal_map && texture_compression_RGTC_support)
+		options.format = BlockCompressionOptions::Format_BC5;
+	else if(params.use_BC7_compression && texture_compression_BC6H_support)
+		options.format = BlockCompressionOptions::Format_BC7;
+	return options;
+}
+
+
 // If the texture identified by key has been loaded into OpenGL, then return the OpenGL texture.
 // If the texture is not loaded, return a null reference.
 Reference<OpenGLTexture> OpenGLEngine::getTextureIfLoaded(const OpenGLTextureKey& texture_key)
@@ -5950,10 +5989,19 @@ void OpenGLEngine::sortBatchDrawInfos()
 
 	temp2_batch_draw_info.resizeNoCopy(temp_batch_draw_info.size());
 
-	const int num_buckets = 6144; // As required by radixSort32BitKey().
-	temp_counts.resize(num_buckets);
+	if(main_task_manager)
+	{
+		// Sorts on this thread unless there are a lot of batches, skipping passes where all keys have the same digit.
+		Sort::parallelRadixSort32BitKey(*main_task_manager, /*data=*/temp_batch_draw_info.data(), /*working_space=*/temp2_batch_draw_info.data(), /*num_items=*/temp_batch_draw_info.size(), 
+			BatchDrawInfoGetKey(), temp_counts);
+	}
+	else
+	{
+		const int num_buckets = 6144; // As required by radixSort32BitKey().
+		temp_counts.resize(num_buckets);
 	
-	Sort::radixSort32BitKey/*data=*/(temp_batch_draw_info.data(), /*working_space=*/temp2_batch_draw_info.data(), /*num_items=*/temp_batch_draw_info.size(), BatchDrawInfoGetKey(), temp_counts.data(), temp_counts.size());
+		Sort::radixSort32BitKey/*data=*/(temp_batch_draw_info.data(), /*working_space=*/temp2_batch_draw_info.data(), /*num_items=*/temp_batch_draw_info.size(), BatchDrawInfoGetKey(), temp_counts.data(), temp_counts.size());
+	}
 }
 
 
@@ -6393,388 +6441,232 @@ static inline void assertCurrentProgramIsZero()
 }
 
 
-class ComputeAnimatedObJointMatricesTask : public glare::Task
+static inline Matrix4f makeNodeTRS(const Vec4f& trans, const Quatf& rot, const Vec4f& scale)
 {
-public:
-	virtual void run(size_t /*thread_index*/)
-	{
-		while(1)
-		{
-			const int64 index_to_process = next_ob_i->increment();
-			if(index_to_process >= (int64)animated_obs_to_process->size())
-				break;
-
-			GLObject* const ob = (*animated_obs_to_process)[index_to_process];
-
-			const AnimationData& anim_data = ob->mesh_data->animation_data;
-
-			if(!anim_data.animations.empty())
-			{
-				ob->anim_node_data.resize(anim_data.nodes.size());
-
-				const float DEBUG_SPEED_FACTOR = 1;
+	const Matrix4f rot_mat = rot.toMatrix();
+	return Matrix4f(
+		rot_mat.getColumn(0) * copyToAll<0>(scale),
+		rot_mat.getColumn(1) * copyToAll<1>(scale),
+		rot_mat.getColumn(2) * copyToAll<2>(scale),
+		setWToOne(trans));
+}
 
-				const AnimationDatum& anim_datum_a                       = *anim_data.animations        [myClamp(ob->current_anim_i, 0, (int)anim_data.animations.size() - 1)];
-				const std::vector<PerAnimationNodeData>& anim_a_node_data = anim_data.per_anim_node_data[myClamp(ob->current_anim_i, 0, (int)anim_data.animations.size() - 1)];
 
-				const int use_next_anim_i = (ob->next_anim_i == -1) ? ob->current_anim_i : ob->next_anim_i;
-				const AnimationDatum& anim_datum_b                        = *anim_data.animations       [myClamp(use_next_anim_i,    0, (int)anim_data.animations.size() - 1)];
-				const std::vector<PerAnimationNodeData>& anim_b_node_data = anim_data.per_anim_node_data[myClamp(use_next_anim_i,    0, (int)anim_data.animations.size() - 1)];
+bool computeAnimationPoseKey(const GLObject& ob, float current_time, AnimationPoseKey& key_out)
+{
+	const AnimationData& anim_data = ob.mesh_data->animation_data;
+	if(anim_data.animations.empty())
+		return false;
 
-				const float transition_frac = (float)Maths::smoothStep<double>(ob->transition_start_time, ob->transition_end_time, current_time);
+	const int num_anims = (int)anim_data.animations.size();
+	const int anim_a_i = myClamp(ob.current_anim_i, 0, num_anims - 1);
+	const int anim_b_i = myClamp((ob.next_anim_i == -1) ? ob.current_anim_i : ob.next_anim_i, 0, num_anims - 1);
 
-				const float unwrapped_use_in_anim_time = (current_time + (float)ob->use_time_offset) * DEBUG_SPEED_FACTOR;
+	const float transition_frac = (float)Maths::smoothStep<double>(ob.transition_start_time, ob.transition_end_time, current_time);
+	const int quantised_transition_frac = myClamp((int)(transition_frac * AnimationPoseKey::TRANSITION_FRAC_STEPS + 0.5f), 0, AnimationPoseKey::TRANSITION_FRAC_STEPS);
 
-				assert(anim_datum_a.anim_len > 0);
-				assert(anim_datum_b.anim_len > 0);
-				const float use_in_anim_time_a = Maths::floatMod(unwrapped_use_in_anim_time, anim_datum_a.anim_len);
-				const float use_in_anim_time_b = Maths::floatMod(unwrapped_use_in_anim_time, anim_datum_b.anim_len);
+	const float unwrapped_use_in_anim_time = current_time + (float)ob.use_time_offset;
 
+	const float anim_len_a = anim_data.animations[anim_a_i]->anim_len;
+	const float anim_len_b = anim_data.animations[anim_b_i]->anim_len;
+	assert(anim_len_a > 0);
+	assert(anim_len_b > 0);
 
-				// For each input accessor that the animation uses, we have an array of keyframe times.
-				// For each such array, find the current and next keyframe, and interpolation fraction, based on the current time.
-				// Store in a AnimationKeyFrameLocation in key_frame_locs.
-				//
-				// We are doing 2 important optimisations here:
-				// The first is that many nodes in a skeleton may use the same input accessor.  We don't want to search the keyframe times for the correct keyframe every time
-				// the input accessor is used by a node, so we do the search once for the input accessor, and store the results in key_frame_locs.
-				//
-				// The second optimisation is that a particular animation may only use 1 or a few input accessors.
-				// For example the avatar idle animation only uses input accessor 9, and there are 33 input accessors in total.
-				// So for the idle animation we only need to do the keyframe search for input accessor 9, not the 32 other accessors.
+	key_out.anim_data = &anim_data;
+	key_out.quantised_transition_frac = quantised_transition_frac;
 
-				const size_t keyframe_times_size = myMax(anim_data.keyframe_times.size(), anim_datum_a.m_keyframe_times.size(), anim_datum_b.m_keyframe_times.size());
-				key_frame_locs.resizeNoCopy(keyframe_times_size * 2); // keyframe times for animation a are first, then keyframe times for animation b.
+	// If only one of the animations contributes to the pose, don't distinguish keys on the other animation, so more objects can share the pose.
+	if(quantised_transition_frac < AnimationPoseKey::TRANSITION_FRAC_STEPS) // If animation a is used:
+	{
+		key_out.anim_a_i = anim_a_i;
+		key_out.quantised_time_a = (int)(Maths::floatMod(unwrapped_use_in_anim_time, anim_len_a) * AnimationPoseKey::TIMES_PER_SEC);
+	}
+	else
+	{
+		key_out.anim_a_i = 0;
+		key_out.quantised_time_a = 0;
+	}
 
-				//------------------------ Compute keyframe times for animation a -------------------------
-				if(transition_frac < 1.f) // At transition_frac = 1, result is fully animation b, a is used if transition_frac < 1
-				{
-					const js::Vector<KeyFrameTimeInfo>& keyframe_times_a = (!anim_datum_a.m_keyframe_times.empty()) ? anim_datum_a.m_keyframe_times : anim_data.keyframe_times;
+	if(quantised_transition_frac > 0) // If animation b is used:
+	{
+		key_out.anim_b_i = anim_b_i;
+		key_out.quantised_time_b = (int)(Maths::floatMod(unwrapped_use_in_anim_time, anim_len_b) * AnimationPoseKey::TIMES_PER_SEC);
+	}
+	else
+	{
+		key_out.anim_b_i = 0;
+		key_out.quantised_time_b = 0;
+	}
 
-					for(size_t q=0; q<anim_datum_a.used_input_accessor_indices.size(); ++q)
-					{
-						const int input_accessor_i = anim_datum_a.used_input_accessor_indices[q];
+	return true;
+}
 
-						const KeyFrameTimeInfo& keyframe_time_info = keyframe_times_a[input_accessor_i];
-						assert(keyframe_time_info.times_size == (int)keyframe_time_info.times.size());
 
-						const float in_anim_time = use_in_anim_time_a;
-						AnimationKeyFrameLocation& key_frame_loc = key_frame_locs[input_accessor_i];
+void evalSharedAnimationPose(SharedAnimationPose& shared_pose)
+{
+	const AnimationPoseKey& key = shared_pose.key;
+	const AnimationData& anim_data = *key.anim_data;
 
-						// If keyframe times are equally spaced, we can skip the binary search stuff, and just compute the keyframes we are between directly.
-						if(keyframe_time_info.equally_spaced && (keyframe_time_info.t_back == anim_datum_a.anim_len))
-						{
-							if(use_in_anim_time_a < keyframe_time_info.t_0)
-							{
-								key_frame_loc.i_0 = 0;
-								key_frame_loc.i_1 = 0;
-								key_frame_loc.frac = 0;
-							}
-							else
-							{
-								const float t_minus_t_0 = use_in_anim_time_a - keyframe_time_info.t_0;
-								assert(t_minus_t_0 >= 0);
+	// Sample at the quantised times, so that all objects sharing this pose get exactly the same result.
+	const float recip_times_per_sec = 1.f / AnimationPoseKey::TIMES_PER_SEC;
+	anim_data.samplePose(key.anim_a_i, key.anim_b_i, key.quantised_time_a * recip_times_per_sec, key.quantised_time_b * recip_times_per_sec, 
+		(float)key.quantised_transition_frac / AnimationPoseKey::TRANSITION_FRAC_STEPS, shared_pose.key_frame_locs, shared_pose.pose);
 
-								int index = (int)(t_minus_t_0 * keyframe_time_info.recip_spacing);
+	const AnimationPose& pose = shared_pose.pose;
+	shared_pose.node_matrices.resizeNoCopy(anim_data.nodes.size());
 
-								const float frac = (t_minus_t_0 - (float)index * keyframe_time_info.spacing) * keyframe_time_info.recip_spacing; // Fraction of way through frame
-								assert(frac >= -0.001f && frac < 1.001f);
+	for(size_t n=0; n<anim_data.sorted_nodes.size(); ++n)
+	{
+		const int node_i = anim_data.sorted_nodes[n];
+		const AnimationNodeData& node_data = anim_data.nodes[node_i];
 
-								if(index >= keyframe_time_info.times_size)
-									index = 0;
+		const Matrix4f TRS = makeNodeTRS(pose.trans[node_i], pose.rot[node_i], pose.scale[node_i]);
 
-								int next_index = index + 1;
-								if(next_index >= keyframe_time_info.times_size)
-									next_index = 0;
+		shared_pose.node_matrices[node_i] = (node_data.parent_index == -1) ? TRS : (shared_pose.node_matrices[node_data.parent_index] * node_data.retarget_adjustment * TRS);
+	}
 
-								key_frame_loc.i_0 = index;
-								key_frame_loc.i_1 = next_index;
-								key_frame_loc.frac = frac;
-							}
-						}
-						else
-						{
-							const std::vector<float>& time_vals = keyframe_time_info.times;
+	const size_t joint_nodes_size = anim_data.joint_nodes.size();
+	shared_pose.joint_matrices.resizeNoCopy(joint_nodes_size);
+	for(size_t i=0; i<joint_nodes_size; ++i)
+	{
+		const int node_i = anim_data.joint_nodes[i];
+		shared_pose.joint_matrices[i] = shared_pose.node_matrices[node_i] * anim_data.nodes[node_i].inverse_bind_matrix;
+	}
+}
 
-							if(keyframe_time_info.times_size != 0)
-							{
-								if(keyframe_time_info.times_size == 1)
-								{
-									key_frame_loc.i_0 = 0;
-									key_frame_loc.i_1 = 0;
-									key_frame_loc.frac = 0;
-								}
-								else
-								{
-									assert(time_vals.size() >= 2);
-
-									// TODO: use incremental search based on the position last frame, instead of using upper_bound.  (or combine)
-
-									/*
-									frame 0                     frame 1                        frame 2                      frame 3
-									|----------------------------|-----------------------------|-----------------------------|-------------------------> time
-									^                            ^            ^                ^
-									cur_frame_i                             in_anim_time
-									index                        next_index
-									*/
-
-									// Find current frame
-									auto res = std::upper_bound(time_vals.begin(), time_vals.end(), in_anim_time); // "Finds the position of the first element in an ordered range that has a value that is greater than a specified value"
-									int next_index = (int)(res - time_vals.begin());
-									assert(next_index >= 0 && next_index <= (int)time_vals.size());
-									int index = next_index - 1;
-									assert(index >= -1 && index < (int)time_vals.size());
-
-									next_index = myMin(next_index, keyframe_time_info.times_size - 1);
-									assert(next_index >= 0 && next_index < (int)time_vals.size());
-
-									if(index < 0) // This is the case when use_in_anim_time_a < t_0.  In this case we want to clamp the output values to the keyframe 0 values.
-									{
-										key_frame_loc.i_0 = 0;
-										key_frame_loc.i_1 = 0;
-										key_frame_loc.frac = 0;
-									}
-									else
-									{
-										const float index_time = time_vals[index];
-
-										float frac;
-										frac = (in_anim_time - index_time) / (time_vals[next_index] - index_time);
-
-										if(!(frac >= 0 && frac <= 1)) // TEMP: handle NaNs
-											frac = 0;
-
-										key_frame_loc.i_0 = index;
-										key_frame_loc.i_1 = next_index;
-										key_frame_loc.frac = frac;
-									}
-								}
-							}
-						}
-					}
-				}
 
-				//------------------------ Compute keyframe times for animation b -------------------------
-				if(transition_frac > 0.f) // At transition_frac = 0, result is fully animation a, b is used if transition_frac > 0
-				{
-					const js::Vector<KeyFrameTimeInfo>& keyframe_times_b = (!anim_datum_b.m_keyframe_times.empty()) ? anim_datum_b.m_keyframe_times : anim_data.keyframe_times;
+void applySharedAnimationPose(const SharedAnimationPose& shared_pose, GLObject& ob, js::Vector<Matrix4f, 16>& node_matrices)
+{
+	const AnimationData& anim_data = *shared_pose.key.anim_data;
+	const AnimationPose& pose = shared_pose.pose;
+	const size_t num_nodes = anim_data.nodes.size();
 
-					for(size_t q=0; q<anim_datum_b.used_input_accessor_indices.size(); ++q)
-					{
-						const int input_accessor_i = anim_datum_b.used_input_accessor_indices[q];
+	ob.anim_node_data.resize(num_nodes);
 
-						const KeyFrameTimeInfo& keyframe_time_info = keyframe_times_b[input_accessor_i];
-						assert(keyframe_time_info.times_size == (int)keyframe_time_info.times.size());
+	bool has_procedural_modifications = false;
+	const Matrix4f identity = Matrix4f::identity();
+	for(size_t i=0; i<num_nodes; ++i)
+		if(ob.anim_node_data[i].procedural_rot_mask != 0 || !(ob.anim_node_data[i].procedural_transform == identity))
+		{
+			has_procedural_modifications = true;
+			break;
+		}
 
-						const float in_anim_time = use_in_anim_time_b;
-						AnimationKeyFrameLocation& key_frame_loc = key_frame_locs[keyframe_times_size + input_accessor_i]; // The keyframe_times_size offset is to get keyframe locations for animation b.
+	if(!has_procedural_modifications)
+	{
+		// The shared node and joint matrices are exactly what we would compute for this object, so just copy them.
+		for(size_t n=0; n<anim_data.sorted_nodes.size(); ++n)
+		{
+			const int node_i = anim_data.sorted_nodes[n];
+			GLObjectAnimNodeData& ob_anim_node_data_i = ob.anim_node_data[node_i];
+			ob_anim_node_data_i.last_pre_proc_to_object = shared_pose.node_matrices[node_i];
+			ob_anim_node_data_i.last_rot = pose.rot[node_i];
+			ob_anim_node_data_i.node_hierarchical_to_object = shared_pose.node_matrices[node_i];
+		}
 
-						// If keyframe times are equally spaced, we can skip the binary search stuff, and just compute the keyframes we are between directly.
-						if(keyframe_time_info.equally_spaced && (keyframe_time_info.t_back == anim_datum_b.anim_len))
-						{
-							if(in_anim_time < keyframe_time_info.t_0)
-							{
-								key_frame_loc.i_0 = 0;
-								key_frame_loc.i_1 = 0;
-								key_frame_loc.frac = 0;
-							}
-							else
-							{
-								const float t_minus_t_0 = in_anim_time - keyframe_time_info.t_0;
-								assert(t_minus_t_0 >= 0);
+		const size_t joint_nodes_size = shared_pose.joint_matrices.size();
+		ob.joint_matrices.resizeNoCopy(joint_nodes_size);
+		for(size_t i=0; i<joint_nodes_size; ++i)
+			ob.joint_matrices[i] = shared_pose.joint_matrices[i];
+	}
+	else
+	{
+		// Recompute the node hierarchy from the shared local node transforms, applying the procedural rotations and transforms.
+		node_matrices.resizeNoCopy(num_nodes); // A temp buffer to store node transforms that we can look up parent node transforms in.
 
-								int index = (int)(t_minus_t_0 * keyframe_time_info.recip_spacing);
+		for(size_t n=0; n<anim_data.sorted_nodes.size(); ++n)
+		{
+			const int node_i = anim_data.sorted_nodes[n];
+			const AnimationNodeData& node_data = anim_data.nodes[node_i];
+			GLObjectAnimNodeData& ob_anim_node_data_i = ob.anim_node_data[node_i];
 
-								const float frac = (t_minus_t_0 - (float)index * keyframe_time_info.spacing) * keyframe_time_info.recip_spacing; // Fraction of way through frame
-								assert(frac >= -0.001f && frac < 1.001f);
+			const Quatf rot = select(ob_anim_node_data_i.procedural_rot, pose.rot[node_i], bitcastToVec4f(Vec4i(ob_anim_node_data_i.procedural_rot_mask)));
 
-								if(index >= keyframe_time_info.times_size)
-									index = 0;
+			const Matrix4f TRS = makeNodeTRS(pose.trans[node_i], rot, pose.scale[node_i]);
 
-								int next_index = index + 1;
-								if(next_index >= keyframe_time_info.times_size)
-									next_index = 0;
+			const Matrix4f last_pre_proc_to_object = (node_data.parent_index == -1) ? TRS : (node_matrices[node_data.parent_index] * node_data.retarget_adjustment * TRS); // Transform without procedural_transform applied
+			const Matrix4f node_transform = last_pre_proc_to_object * ob_anim_node_data_i.procedural_transform;
 
-								key_frame_loc.i_0 = index;
-								key_frame_loc.i_1 = next_index;
-								key_frame_loc.frac = frac;
-							}
-						}
-						else
-						{
-							const std::vector<float>& time_vals = keyframe_time_info.times;
+			node_matrices[node_i] = node_transform;
 
-							if(keyframe_time_info.times_size != 0)
-							{
-								if(keyframe_time_info.times_size == 1)
-								{
-									key_frame_loc.i_0 = 0;
-									key_frame_loc.i_1 = 0;
-									key_frame_loc.frac = 0;
-								}
-								else
-								{
-									assert(time_vals.size() >= 2);
-
-									// Find current frame
-									auto res = std::upper_bound(time_vals.begin(), time_vals.end(), in_anim_time); // "Finds the position of the first element in an ordered range that has a value that is greater than a specified value"
-									int next_index = (int)(res - time_vals.begin());
-									assert(next_index >= 0 && next_index <= (int)time_vals.size());
-									int index = next_index - 1;
-									assert(index >= -1 && index < (int)time_vals.size());
-
-									next_index = myMin(next_index, keyframe_time_info.times_size - 1);
-									assert(next_index >= 0 && next_index < (int)time_vals.size());
-
-									if(index < 0) // This is the case when use_in_anim_time_b < t_0.  In this case we want to clamp the output values to the keyframe 0 values.
-									{
-										key_frame_loc.i_0 = 0;
-										key_frame_loc.i_1 = 0;
-										key_frame_loc.frac = 0;
-									}
-									else
-									{
-										const float index_time = time_vals[index];
-
-										float frac;
-										frac = (in_anim_time - index_time) / (time_vals[next_index] - index_time);
-
-										if(!(frac >= 0 && frac <= 1)) // TEMP: handle NaNs
-											frac = 0;
-
-										key_frame_loc.i_0 = index;
-										key_frame_loc.i_1 = next_index;
-										key_frame_loc.frac = frac;
-									}
-								}
-							}
-						}
-					}
-				}
-
-				node_matrices.resizeNoCopy(anim_data.sorted_nodes.size()); // A temp buffer to store node transforms that we can look up parent node transforms in.
-
-				const js::Vector<js::Vector<Vec4f, 16> >& output_data_a = (!anim_datum_a.m_output_data.empty()) ? anim_datum_a.m_output_data : anim_data.output_data;
-				const js::Vector<js::Vector<Vec4f, 16> >& output_data_b = (!anim_datum_b.m_output_data.empty()) ? anim_datum_b.m_output_data : anim_data.output_data;
+			ob_anim_node_data_i.last_pre_proc_to_object = last_pre_proc_to_object;
+			ob_anim_node_data_i.last_rot = rot;
+			ob_anim_node_data_i.node_hierarchical_to_object = node_transform;
+		}
 
-				for(size_t n=0; n<anim_data.sorted_nodes.size(); ++n)
-				{
-					const int node_i = anim_data.sorted_nodes[n];
-					const AnimationNodeData& node_data = anim_data.nodes[node_i];
-					const PerAnimationNodeData& node_a = anim_a_node_data[node_i];
-					const PerAnimationNodeData& node_b = anim_b_node_data[node_i];
-
-					Vec4f trans_a = node_data.trans;
-					Vec4f trans_b = node_data.trans;
-					Quatf rot_a   = node_data.rot;
-					Quatf rot_b   = node_data.rot;
-					Vec4f scale_a = node_data.scale;
-					Vec4f scale_b = node_data.scale;
-
-					if(transition_frac < 1.f) // At transition_frac = 1, result is fully animation b, a is used if transition_frac < 1
-					{
-						if(node_a.translation_input_accessor >= 0)
-						{
-							//conPrint("anim_datum_a: " + anim_datum_a.name + "," + toString(anim_data.keyframe_times[node_a.translation_input_accessor].back()));
+		const size_t joint_nodes_size = anim_data.joint_nodes.size();
+		ob.joint_matrices.resizeNoCopy(joint_nodes_size);
+		for(size_t i=0; i<joint_nodes_size; ++i)
+		{
+			const int node_i = anim_data.joint_nodes[i];
+			ob.joint_matrices[i] = node_matrices[node_i] * anim_data.nodes[node_i].inverse_bind_matrix;
+		}
+	}
+}
 
-							const int i_0    = key_frame_locs[node_a.translation_input_accessor].i_0;
-							const int i_1    = key_frame_locs[node_a.translation_input_accessor].i_1;
-							const float frac = key_frame_locs[node_a.translation_input_accessor].frac;
 
-							// read translation values from output accessor.
-							const Vec4f trans_0 = (output_data_a[node_a.translation_output_accessor])[i_0];
-							const Vec4f trans_1 = (output_data_a[node_a.translation_output_accessor])[i_1];
-							trans_a = Maths::lerp(trans_0, trans_1, frac); // TODO: handle step interpolation, cubic lerp etc..
-						}
+int animationUpdatePeriodForProjectedSize(float proj_len)
+{
+	if(proj_len > 0.1f)
+		return 1;
+	else if(proj_len > 0.03f)
+		return 2;
+	else
+		return 4;
+}
 
-						if(node_a.rotation_input_accessor >= 0)
-						{
-							const int i_0    = key_frame_locs[node_a.rotation_input_accessor].i_0;
-							const int i_1    = key_frame_locs[node_a.rotation_input_accessor].i_1;
-							const float frac = key_frame_locs[node_a.rotation_input_accessor].frac;
-
-							// read rotation values from output accessor
-							const Quatf rot_0 = Quatf((output_data_a[node_a.rotation_output_accessor])[i_0]);
-							const Quatf rot_1 = Quatf((output_data_a[node_a.rotation_output_accessor])[i_1]);
-							rot_a = Quatf::nlerp(rot_0, rot_1, frac);
-						}
 
-						if(node_a.scale_input_accessor >= 0)
-						{
-							const int i_0    = key_frame_locs[node_a.scale_input_accessor].i_0;
-							const int i_1    = key_frame_locs[node_a.scale_input_accessor].i_1;
-							const float frac = key_frame_locs[node_a.scale_input_accessor].frac;
-
-							// read scale values from output accessor
-							const Vec4f scale_0 = (output_data_a[node_a.scale_output_accessor])[i_0];
-							const Vec4f scale_1 = (output_data_a[node_a.scale_output_accessor])[i_1];
-							scale_a = Maths::lerp(scale_0, scale_1, frac);
-						}
-					}
+bool shouldUpdateAnimationInFrame(const GLObject* ob, int update_period, uint64 frame_num)
+{
+	assert(Maths::isPowerOfTwo(update_period));
 
-					if(transition_frac > 0.f) // At transition_frac = 0, result is fully animation a, b is used if transition_frac > 0
-					{
-						if(node_b.translation_input_accessor >= 0)
-						{
-							const int i_0    = key_frame_locs[keyframe_times_size + node_b.translation_input_accessor].i_0; // The keyframe_times_size offset is to get keyframe locations for animation b.
-							const int i_1    = key_frame_locs[keyframe_times_size + node_b.translation_input_accessor].i_1;
-							const float frac = key_frame_locs[keyframe_times_size + node_b.translation_input_accessor].frac;
-
-							// read translation values from output accessor.
-							const Vec4f trans_0 = (output_data_b[node_b.translation_output_accessor])[i_0];
-							const Vec4f trans_1 = (output_data_b[node_b.translation_output_accessor])[i_1];
-							trans_b = Maths::lerp(trans_0, trans_1, frac); // TODO: handle step interpolation, cubic lerp etc..
-						}
+	// Use a hash of the object address as a per-object frame offset.
+	const uint64 offset = ((uint64)(size_t)ob * 11400714819323198485ull) >> 32;
+	return ((frame_num + offset) & (uint64)(update_period - 1)) == 0;
+}
 
-						if(node_b.rotation_input_accessor >= 0)
-						{
-							const int i_0    = key_frame_locs[keyframe_times_size + node_b.rotation_input_accessor].i_0;
-							const int i_1    = key_frame_locs[keyframe_times_size + node_b.rotation_input_accessor].i_1;
-							const float frac = key_frame_locs[keyframe_times_size + node_b.rotation_input_accessor].frac;
-
-							// read rotation values from output accessor
-							const Quatf rot_0 = Quatf((output_data_b[node_b.rotation_output_accessor])[i_0]);
-							const Quatf rot_1 = Quatf((output_data_b[node_b.rotation_output_accessor])[i_1]);
-							rot_b = Quatf::nlerp(rot_0, rot_1, frac);
-						}
 
-						if(node_b.scale_input_accessor >= 0)
-						{
-							const int i_0    = key_frame_locs[keyframe_times_size + node_b.scale_input_accessor].i_0;
-							const int i_1    = key_frame_locs[keyframe_times_size + node_b.scale_input_accessor].i_1;
-							const float frac = key_frame_locs[keyframe_times_size + node_b.scale_input_accessor].frac;
-
-							// read scale values from output accessor
-							const Vec4f scale_0 = (output_data_b[node_b.scale_output_accessor])[i_0];
-							const Vec4f scale_1 = (output_data_b[node_b.scale_output_accessor])[i_1];
-							scale_b = Maths::lerp(scale_0, scale_1, frac);
-						}
-					}
+// Evaluates each unique animation pose for the frame.  See computeAnimationPoseKey().
+class EvalSharedAnimationPosesTask : public glare::Task
+{
+public:
+	virtual void run(size_t /*thread_index*/)
+	{
+		while(1)
+		{
+			const int64 index_to_process = next_pose_i->increment();
+			if(index_to_process >= (int64)num_poses)
+				break;
 
-					GLObjectAnimNodeData& ob_anim_node_data_i = ob->anim_node_data[node_i];
+			evalSharedAnimationPose((*shared_poses)[index_to_process]);
+		}
+	}
 
-					const Vec4f trans = Maths::lerp(trans_a, trans_b, transition_frac);
-					const Quatf anim_rot = Quatf::nlerp(rot_a, rot_b, transition_frac);
-					const Quatf rot = select(ob_anim_node_data_i.procedural_rot, anim_rot, bitcastToVec4f(Vec4i(ob_anim_node_data_i.procedural_rot_mask)));
-					const Vec4f scale = Maths::lerp(scale_a, scale_b, transition_frac);
+	glare::AtomicInt* next_pose_i;
+	std::vector<SharedAnimationPose>* shared_poses;
+	size_t num_poses;
+};
 
-					const Matrix4f rot_mat = rot.toMatrix();
 
-					const Matrix4f TRS(
-						rot_mat.getColumn(0) * copyToAll<0>(scale),
-						rot_mat.getColumn(1) * copyToAll<1>(scale),
-						rot_mat.getColumn(2) * copyToAll<2>(scale),
-						setWToOne(trans));
+class ComputeAnimatedObJointMatricesTask : public glare::Task
+{
+public:
+	virtual void run(size_t /*thread_index*/)
+	{
+		while(1)
+		{
+			const int64 index_to_process = next_ob_i->increment();
+			if(index_to_process >= (int64)animated_obs_to_process->size())
+				break;
 
-					const Matrix4f last_pre_proc_to_object = (node_data.parent_index == -1) ? TRS : (node_matrices[node_data.parent_index] * node_data.retarget_adjustment * TRS); // Transform without procedural_transform applied
-					const Matrix4f node_transform = last_pre_proc_to_object * ob->anim_node_data[node_i].procedural_transform;
+			GLObject* const ob = (*animated_obs_to_process)[index_to_process];
 
-					node_matrices[node_i] = node_transform;
+			const AnimationData& anim_data = ob->mesh_data->animation_data;
 
-					ob_anim_node_data_i.last_pre_proc_to_object = last_pre_proc_to_object;
-					ob_anim_node_data_i.last_rot = rot;
-					ob_anim_node_data_i.node_hierarchical_to_object = node_transform;
-				}
+			const int pose_i = (*animated_ob_pose_indices)[index_to_process];
+			if(pose_i >= 0) // If the object has animations, it will have been assigned a shared pose:
+			{
+				applySharedAnimationPose((*shared_poses)[pose_i], *ob, node_matrices);
 			}
 			else // else if anim_data.animations.empty():
 			{
@@ -6788,16 +6680,8 @@ public:
 					{
 						const int node_i = anim_data.sorted_nodes[n];
 						const AnimationNodeData& node_data = anim_data.nodes[node_i];
-						const Vec4f trans = node_data.trans;
-						const Quatf rot = node_data.rot;
-						const Vec4f scale = node_data.scale;
 
-						const Matrix4f rot_mat = rot.toMatrix();
-						const Matrix4f TRS(
-							rot_mat.getColumn(0) * copyToAll<0>(scale),
-							rot_mat.getColumn(1) * copyToAll<1>(scale),
-							rot_mat.getColumn(2) * copyToAll<2>(scale),
-							setWToOne(trans));
+						const Matrix4f TRS = makeNodeTRS(node_data.trans, node_data.rot, node_data.scale);
 
 						const Matrix4f last_pre_proc_to_object = (node_data.parent_index == -1) ? TRS : (node_matrices[node_data.parent_index] * TRS);
 						const Matrix4f node_transform = last_pre_proc_to_object * ob->anim_node_data[node_i].procedural_transform;
@@ -6806,34 +6690,31 @@ public:
 
 						ob->anim_node_data[node_i].node_hierarchical_to_object = node_transform;
 					}
-				}
-			}
 
-			const size_t joint_nodes_size = anim_data.joint_nodes.size();
-			if(!anim_data.animations.empty() || (joint_nodes_size > 0))
-			{
-				ob->joint_matrices.resizeNoCopy(joint_nodes_size);
+					const size_t joint_nodes_size = anim_data.joint_nodes.size();
+					ob->joint_matrices.resizeNoCopy(joint_nodes_size);
 
-				for(size_t i=0; i<joint_nodes_size; ++i)
-				{
-					const int node_i = anim_data.joint_nodes[i];
+					for(size_t i=0; i<joint_nodes_size; ++i)
+					{
+						const int node_i = anim_data.joint_nodes[i];
 
-					ob->joint_matrices[i] = node_matrices[node_i] * anim_data.nodes[node_i].inverse_bind_matrix;
+						ob->joint_matrices[i] = node_matrices[node_i] * anim_data.nodes[node_i].inverse_bind_matrix;
 
-					//conPrint("joint_matrices[" + toString(i) + "]: (joint node: " + toString(node_i) + ", '" + anim_data.nodes[node_i].name + "')");
-					//conPrint(ob->joint_matrices[i].toString());
+						//conPrint("joint_matrices[" + toString(i) + "]: (joint node: " + toString(node_i) + ", '" + anim_data.nodes[node_i].name + "')");
+						//conPrint(ob->joint_matrices[i].toString());
+					}
 				}
 			}
 		}
 	}
 
-	float current_time;
 	glare::AtomicInt* next_ob_i;
 	js::Vector<GLObject*, 16>* animated_obs_to_process;
+	js::Vector<int, 16>* animated_ob_pose_indices;
+	std::vector<SharedAnimationPose>* shared_poses;
 
 	// Some temporary vectors:
 	js::Vector<Matrix4f, 16> node_matrices;
-	js::Vector<AnimationKeyFrameLocation, 16> key_frame_locs;
 };
 
 
@@ -7751,6 +7632,8 @@ void OpenGLEngine::draw()
 
 
 	double anim_update_duration = 0;
+	double anim_pose_eval_duration = 0;
+	double anim_apply_duration = 0;
 
 
 	// Unload unused textures if we have exceeded our texture mem usage budget.
@@ -7814,6 +7697,7 @@ void OpenGLEngine::draw()
 	const Vec4f campos_ws = this->getCameraPositionWS();
 	Timer anim_profile_timer;
 	uint32 num_animated_obs_processed = 0;
+	uint32 num_animated_obs_lod_skipped = 0;
 	if(!cur_scene->animated_objects.empty())
 	{
 		ZoneScopedN("Animated objects"); // Tracy profiler
@@ -7824,6 +7708,7 @@ void OpenGLEngine::draw()
 			GLObject* const ob = it->getPointer();
 
 			bool visible_and_large_enough = AABBIntersectsFrustum(anim_shadow_clip_planes, num_anim_shadow_clip_planes_used, anim_shadow_vol_aabb, ob->aabb_ws);
+			bool update_this_frame = true;
 			if(visible_and_large_enough)
 			{
 				// Don't update anim data for object if it is too small as seen from the camera.
@@ -7831,15 +7716,73 @@ void OpenGLEngine::draw()
 				const float recip_dist = (ob->aabb_ws.centroid() - campos_ws).fastApproxRecipLength();
 				const float proj_len = ob_w * recip_dist;
 				visible_and_large_enough = proj_len > 0.01f;
+
+				// Update objects that are fairly small on screen less often.
+				update_this_frame = shouldUpdateAnimationInFrame(ob, animationUpdatePeriodForProjectedSize(proj_len), cur_scene->frame_num);
+				if(visible_and_large_enough && !update_this_frame && !ob->joint_matrices.empty())
+					num_animated_obs_lod_skipped++;
 			}
 
-			const bool process = visible_and_large_enough || ob->joint_matrices.empty(); // If the joint matrices are empty we need to compute them at least once, so they don't contain garbage data that is read from.
+			const bool process = (visible_and_large_enough && update_this_frame) || ob->joint_matrices.empty(); // If the joint matrices are empty we need to compute them at least once, so they don't contain garbage data that is read from.
 			if(process)
 				animated_obs_to_process.push_back(ob);
 		}
 		num_animated_obs_processed = (uint32)animated_obs_to_process.size();
 
 
+		// Work out the animation pose for each object.  Objects with the same animation state (e.g. crowds of instances playing the same animation in sync)
+		// will share a pose, so that the keyframes for each unique pose are only sampled once per frame.
+		anim_pose_indices.clear();
+		num_shared_anim_poses = 0;
+		animated_ob_pose_indices.resizeNoCopy(animated_obs_to_process.size());
+		for(size_t i=0; i<animated_obs_to_process.size(); ++i)
+		{
+			AnimationPoseKey key;
+			if(computeAnimationPoseKey(*animated_obs_to_process[i], this->current_time, key))
+			{
+				const auto res = anim_pose_indices.insert(std::make_pair(key, (uint32)num_shared_anim_poses));
+				if(res.second) // If key was inserted (was not already in map):
+				{
+					if(num_shared_anim_poses >= shared_anim_poses.size())
+						shared_anim_poses.resize(num_shared_anim_poses + 1);
+					shared_anim_poses[num_shared_anim_poses].key = key;
+					num_shared_anim_poses++;
+				}
+				animated_ob_pose_indices[i] = (int)res.first->second;
+			}
+			else
+				animated_ob_pose_indices[i] = -1;
+		}
+
+
+		Timer anim_phase_timer;
+		if(num_shared_anim_poses > 0)
+		{
+			const size_t num_eval_pose_tasks = myClamp(num_shared_anim_poses, (size_t)1, high_priority_task_manager->getNumThreads());
+
+			while(eval_anim_pose_tasks.size() < num_eval_pose_tasks)
+				eval_anim_pose_tasks.push_back(new EvalSharedAnimationPosesTask());
+
+			animated_objects_task_group->tasks.resize(num_eval_pose_tasks);
+
+			glare::AtomicInt next_pose_i(0);
+
+			for(size_t t=0; t<num_eval_pose_tasks; ++t)
+			{
+				EvalSharedAnimationPosesTask* task = eval_anim_pose_tasks[t].downcastToPtr<EvalSharedAnimationPosesTask>();
+				task->next_pose_i = &next_pose_i;
+				task->shared_poses = &shared_anim_poses;
+				task->num_poses = num_shared_anim_poses;
+
+				animated_objects_task_group->tasks[t] = task;
+			}
+
+			high_priority_task_manager->runTaskGroup(animated_objects_task_group);
+		}
+		anim_pose_eval_duration = anim_phase_timer.elapsed();
+
+
+		anim_phase_timer.reset();
 		if(!animated_obs_to_process.empty())
 		{
 			const size_t num_animated_ob_tasks = myClamp(animated_obs_to_process.size(), (size_t)1, high_priority_task_manager->getNumThreads());
@@ -7855,15 +7798,17 @@ void OpenGLEngine::draw()
 			{
 				ComputeAnimatedObJointMatricesTask* task = animated_objects_tasks[t].downcastToPtr<ComputeAnimatedObJointMatricesTask>();
 				//task->processed = 0;
-				task->current_time = this->current_time;
 				task->next_ob_i = &next_ob_i;
 				task->animated_obs_to_process = &animated_obs_to_process;
+				task->animated_ob_pose_indices = &animated_ob_pose_indices;
+				task->shared_poses = &shared_anim_poses;
 
 				animated_objects_task_group->tasks[t] = task;
 			}
 
 			high_priority_task_manager->runTaskGroup(animated_objects_task_group);
 		}
+		anim_apply_duration = anim_phase_timer.elapsed();
 
 
 		// Create/update debug visualisation of the joints
@@ -7925,6 +7870,8 @@ void OpenGLEngine::draw()
 	}
 
 	this->last_num_animated_obs_processed = num_animated_obs_processed;
+	this->last_num_shared_anim_poses = (uint32)num_shared_anim_poses;
+	this->last_num_animated_obs_lod_skipped = num_animated_obs_lod_skipped;
 	anim_update_duration = anim_profile_timer.elapsed();
 
 
@@ -8712,6 +8659,8 @@ void OpenGLEngine::draw()
 	{
 		last_draw_CPU_time = draw_method_timer.elapsed();
 		last_anim_update_duration = anim_update_duration;
+		last_anim_pose_eval_duration = anim_pose_eval_duration;
+		last_anim_apply_duration = anim_apply_duration;
 
 		num_frames_since_fps_timer_reset++;
 		if(fps_display_timer.elapsed() > 1.0)
@@ -13434,6 +13383,12 @@ Reference<OpenGLTexture> OpenGLEngine::loadCubeMap(const std::vector<Reference<M
 }
 
 
+void OpenGLEngine::setTextureDiskCache(const Reference<TextureDiskCache>& cache)
+{
+	texture_disk_cache = cache;
+}
+
+
 // If the texture identified by key has been loaded into OpenGL, then return the OpenGL texture.
 // Otherwise load the texture from map2d into OpenGL immediately.
 Reference<OpenGLTexture> OpenGLEngine::getOrLoadOpenGLTextureForMap2D(const OpenGLTextureKey& key, const Map2D& map2d, const TextureParams& params)
@@ -13467,7 +13422,8 @@ Reference<OpenGLTexture> OpenGLEngine::getOrLoadOpenGLTextureForMap2D(const Open
 	else
 	{
 		const bool use_compression = params.allow_compression && this->DXTTextureCompressionSupportedAndEnabled() && params.use_mipmaps && OpenGLTexture::areTextureDimensionsValidForCompression(map2d); // The non mip-mapping code-path doesn't allow compression
-		texture_data = TextureProcessing::buildTextureData(&map2d, this->mem_allocator.ptr(), this->main_task_manager, use_compression, params.use_mipmaps, params.convert_float_to_half);
+		texture_data = TextureProcessing::buildTextureData(&map2d, this->mem_allocator.ptr(), this->main_task_manager, use_compression, params.use_mipmaps, params.convert_float_to_half, this->texture_disk_cache.ptr(), 
+			getBlockCompressionOptions(params));
 	}
 
 	OpenGLTextureLoadingProgress loading_progress;
@@ -14211,8 +14167,11 @@ std::string OpenGLEngine::getDiagnostics() const
 	s += "\n";
 
 	s += "FPS: " + doubleToStringNDecimalPlaces(last_fps, 1) + "\n";
-	s += "last_anim_update_duration: " + doubleToStringNSigFigs(last_anim_update_duration * 1.0e3, 4) + " ms\n";
-	s += "Processed " + toString(last_num_animated_obs_processed) + " / " + toString(current_scene->animated_objects.size()) + " animated obs\n";
+	s += "last_anim_update_duration: " + doubleToStringNSigFigs(last_anim_update_duration * 1.0e3, 4) + " ms (pose eval: " + doubleToStringNSigFigs(last_anim_pose_eval_duration * 1.0e3, 4) + 
+		" ms, joint matrices: " + doubleToStringNSigFigs(last_anim_apply_duration * 1.0e3, 4) + " ms)\n";
+	s += "Processed " + toString(last_num_animated_obs_processed) + " / " + toString(current_scene->animated_objects.size()) + " animated obs (" + 
+		toString(last_num_animated_obs_lod_skipped) + " skipped by update-rate LOD)\n";
+	s += "Unique animation poses: " + toString(last_num_shared_anim_poses) + "\n";
 	s += "draw_CPU_time: " + doubleToStringNSigFigs(last_draw_CPU_time * 1.0e3, 4) + " ms\n"; 
 	s += "\n";
 	s += "----GPU times----\n";
@@ -14279,6 +14238,7 @@ std::string OpenGLEngine::getDiagnostics() const
 	s += "texture s3tc support: " + boolToString(texture_compression_s3tc_support) + "\n";
 	s += "texture ETC support: " + boolToString(texture_compression_ETC_support) + "\n";
 	s += "texture BC6H support: " + boolToString(texture_compression_BC6H_support) + "\n";
+	s += "texture RGTC support: " + boolToString(texture_compression_RGTC_support) + "\n";
 	s += "GL_KHR_parallel_shader_compile: " + boolToString(parallel_shader_compile_support) + "\n";
 #if EMSCRIPTEN
 	s += "EXT_color_buffer_float_support: " + boolToString(EXT_color_buffer_float_support) + "\n";
@@ -51,6 +51,7 @@ Copyright Glare Technologies Limited 2023 -
 #include "../utils/Array.h"
 #include "../utils/Mutex.h"
 #include "../utils/LinearIterSet.h"
+#include "../utils/HashMap.h"
 #include "../utils/UniqueRef.h"
 #include "../physics/HashedGrid2.h"
 #include <assert.h>
@@ -60,6 +61,8 @@ namespace Indigo { class Mesh; }
 namespace glare { class TaskManager; }
 class Map2D;
 class TextureServer;
+class TextureDiskCache;
+struct BlockCompressionOptions;
 class UInt8ComponentValueTraits;
 class TerrainSystem;
 class RenderBuffer;
@@ -489,7 +492,7 @@ public:
 
 	OpenGLEngineSettings() : enable_debug_output(false), shadow_mapping(false), shadow_mapping_detail(ShadowMappingDetail_medium), compress_textures(false), render_to_offscreen_renderbuffers(true), screenspace_refl_and_refr(true), depth_fog(false), render_sun_and_clouds(true), render_water_caustics(true), 
 		max_tex_CPU_mem_usage(1024 * 1024 * 1024ull), max_tex_GPU_mem_usage(1024 * 1024 * 1024ull), use_grouped_vbo_allocator(true), msaa_samples(4), allow_bindless_textures(true), 
-		allow_multi_draw_indirect(true), use_multiple_phong_uniform_bufs(false), ssao_support(true), ssao(false), irradiance_probes_support(false) {}
+		allow_multi_draw_indirect(true), use_multiple_phong_uniform_bufs(false), ssao_support(true), ssao(false), irradiance_probes_support(false), max_texture_disk_cache_size_B(2 * 1024 * 1024 * 1024ull) {}
 
 	bool enable_debug_output;
 	bool shadow_mapping;
@@ -521,6 +524,9 @@ public:
 	// code is compiled out of the material shaders, so the runtime probe flags below have no effect.
 	// Cannot be toggled at runtime, since it changes how the shaders are compiled.
 	bool irradiance_probes_support;
+
+	std::string texture_disk_cache_dir; // If non-empty, processed (MIP-mapped and DXT compressed) texture data is cached on disk in this dir.  See TextureDiskCache.  Default: empty (no disk cache).
+	uint64 max_texture_disk_cache_size_B; // Least recently used cache files are removed to keep the total size under this.  Default: 2GB
 };
 
 
@@ -881,6 +887,79 @@ struct SplatCloudRange
 void orderSplatCloudsBackToFront(const GLObject** clouds, size_t num_clouds, const Vec4f& campos_ws, js::Vector<SplatCloudRange, 16>& range_stack);
 
 
+// Identifies a sampled animation pose, so that animated objects in the same pose can share it.
+// Animation times and the transition fraction are quantised, so that objects playing the same animations at (almost) the same time get the same key.
+// The key refers to the AnimationData and animation indices (which identify the AnimationDatums), as default node transforms and retargetting
+// adjustments are per-AnimationData.
+struct AnimationPoseKey
+{
+	AnimationPoseKey() : anim_data(NULL), anim_a_i(0), anim_b_i(0), quantised_time_a(0), quantised_time_b(0), quantised_transition_frac(0) {}
+
+	bool operator == (const AnimationPoseKey& other) const
+	{
+		return anim_data == other.anim_data && anim_a_i == other.anim_a_i && anim_b_i == other.anim_b_i && quantised_time_a == other.quantised_time_a && 
+			quantised_time_b == other.quantised_time_b && quantised_transition_frac == other.quantised_transition_frac;
+	}
+	bool operator != (const AnimationPoseKey& other) const { return !(*this == other); }
+
+	static const int TIMES_PER_SEC = 1000; // Animation time is quantised to 1 ms.
+	static const int TRANSITION_FRAC_STEPS = 1024;
+
+	const AnimationData* anim_data;
+	int anim_a_i;
+	int anim_b_i;
+	int quantised_time_a; // Time in animation a, in units of 1 / TIMES_PER_SEC seconds.
+	int quantised_time_b;
+	int quantised_transition_frac; // In [0, TRANSITION_FRAC_STEPS], 0 = fully animation a, TRANSITION_FRAC_STEPS = fully animation b.
+};
+
+
+struct AnimationPoseKeyHash
+{
+	size_t operator() (const AnimationPoseKey& key) const
+	{
+		size_t h = (size_t)key.anim_data >> 4;
+		h = h * 31 + (size_t)key.anim_a_i;
+		h = h * 31 + (size_t)key.anim_b_i;
+		h = h * 31 + (size_t)key.quantised_time_a;
+		h = h * 31 + (size_t)key.quantised_time_b;
+		h = h * 31 + (size_t)key.quantised_transition_frac;
+		return h;
+	}
+};
+
+
+// An animation pose evaluated once per frame, and shared by all animated objects with the same AnimationPoseKey.
+struct SharedAnimationPose
+{
+	AnimationPoseKey key;
+	AnimationPose pose; // Local transformation of each node.
+	js::Vector<Matrix4f, 16> node_matrices; // Node to object space transformation for each node, without any procedural transforms applied.
+	js::Vector<Matrix4f, 16> joint_matrices;
+	js::Vector<AnimationKeyFrameLocation, 16> key_frame_locs; // Keyframe search state for AnimationData::samplePose().  Kept between frames, as a pose slot usually holds the same animation next frame.
+};
+
+
+// Computes the pose key for the current animation state of the object.  Returns false if the object's mesh has no animations.
+bool computeAnimationPoseKey(const GLObject& ob, float current_time, AnimationPoseKey& key_out);
+
+// Samples the keyframes for shared_pose.key, and computes the node and joint matrices.
+void evalSharedAnimationPose(SharedAnimationPose& shared_pose);
+
+// Sets the object's anim_node_data and joint_matrices from the shared pose.  If the object has procedural node transforms or rotations,
+// the node hierarchy is recomputed for it from the shared local node transforms.  node_matrices is working space.
+// Used by OpenGLEngine::draw(); declared here so OpenGLEngineTests can reach them.
+void applySharedAnimationPose(const SharedAnimationPose& shared_pose, GLObject& ob, js::Vector<Matrix4f, 16>& node_matrices);
+
+// Animation update-rate LOD: returns the number of frames between animation updates for an object with projected size proj_len (object width / distance from camera).
+// Objects that are small on screen are updated less often.
+int animationUpdatePeriodForProjectedSize(float proj_len);
+
+// Returns true if an object with the given update period should have its animation updated in frame frame_num.
+// The update frames of different objects are staggered, so the cost of the less frequently updated objects is spread evenly over frames.
+bool shouldUpdateAnimationInFrame(const GLObject* ob, int update_period, uint64 frame_num);
+
+
 
 // Matches MaterialData defined in common_frag_structures.glsl
 // Used for transparent mats also.
@@ -1186,8 +1265,15 @@ public:
 
 	Reference<TextureServer>& getTextureServer() { return texture_server; } // May be NULL
 
+	// The disk cache is created in initialise() if settings.texture_disk_cache_dir is non-empty.  It can also be set directly, for example to share a cache with texture loading tasks.
+	Reference<TextureDiskCache>& getTextureDiskCache() { return texture_disk_cache; } // May be NULL
+	void setTextureDiskCache(const Reference<TextureDiskCache>& cache);
+
 	bool DXTTextureCompressionSupportedAndEnabled() const { return texture_compression_s3tc_support && settings.compress_textures; }
 
+	// Block compression format to use for an 8-bit texture with the given params, if it is compressed.  Falls back to DXT if BC7 or BC5 aren't supported.
+	BlockCompressionOptions getBlockCompressionOptions(const TextureParams& params) const;
+
 	TextureAllocator& getTextureAllocator() { return texture_allocator; }
 	//------------------------------- End texture loading ------------------------------------
 
@@ -1678,6 +1764,8 @@ private:
 
 	Reference<TextureServer> texture_server;
 
+	Reference<TextureDiskCache> texture_disk_cache; // If non-null, processed (MIP-mapped and DXT compressed) texture data is cached on disk.
+
 	Reference<FrameBuffer> target_frame_buffer;
 
 	glare::TaskManager* main_task_manager; // Used for building 8-bit texture data (DXT compression, mip-map data building).
@@ -1690,7 +1778,8 @@ public:
 
 	bool texture_compression_s3tc_support;
 	bool texture_compression_ETC_support;
-	bool texture_compression_BC6H_support;
+	bool texture_compression_BC6H_support; // BC6H and BC7 are both part of BPTC, so this is used for BC7 support as well.
+	bool texture_compression_RGTC_support; // BC4 and BC5
 	bool GL_ARB_bindless_texture_support;
 	bool clip_control_support;
 	bool GL_ARB_shader_storage_buffer_object_support;
@@ -1739,7 +1828,7 @@ private:
 	// Working space for drawSplatClouds()'s ordering pass, kept to avoid allocating every frame.
 	js::Vector<const GLObject*, 16> visible_splat_clouds;
 	js::Vector<SplatCloudRange, 16> splat_cloud_range_stack;
-	std::vector<uint32> temp_counts;
+	js::Vector<uint32, 16> temp_counts;
 	uint32 num_prog_changes;
 	uint32 num_vao_binds;
 	uint32 num_vbo_binds;
@@ -1793,6 +1882,8 @@ private:
 	double last_fog_post_process_GPU_time;
 
 	uint32 last_num_animated_obs_processed;
+	uint32 last_num_shared_anim_poses;
+	uint32 last_num_animated_obs_lod_skipped; // Number of animated objects that were visible but not updated this frame due to the animation update-rate LOD.
 
 	uint32 last_num_decal_batches_drawn;
 
@@ -1803,6 +1894,8 @@ private:
 
 
 	double last_anim_update_duration;
+	double last_anim_pose_eval_duration; // Part of last_anim_update_duration spent sampling keyframes for the unique poses.
+	double last_anim_apply_duration; // Part of last_anim_update_duration spent computing node hierarchy and joint matrices for each object.
 public:
 	double last_draw_CPU_time;
 private:
@@ -1894,6 +1987,12 @@ private:
 	std::vector<glare::TaskRef> animated_objects_tasks;
 	glare::TaskGroupRef animated_objects_task_group;
 
+	HashMap<AnimationPoseKey, uint32, AnimationPoseKeyHash> anim_pose_indices; // Map from pose key to index in shared_anim_poses.  Rebuilt each frame.
+	std::vector<SharedAnimationPose> shared_anim_poses; // Only the first num_shared_anim_poses are used in the current frame.  Kept between frames to reuse the memory.
+	size_t num_shared_anim_poses;
+	js::Vector<int, 16> animated_ob_pose_indices; // Index into shared_anim_poses for each object in animated_obs_to_process, or -1 if the object has no animations.
+	std::vector<glare::TaskRef> eval_anim_pose_tasks;
+
 
 	js::Vector<uint8, 16> data_updates_buffer;
 	SSBORef data_updates_ssbo;
@@ -9,7 +9,9 @@ Copyright Glare Technologies Limited 2016 -
 
 #include "OpenGLEngine.h"
 #include "GLMeshBuilding.h"
+#include "GaussianSplatRenderer.h"
 #include "../graphics/TextureProcessing.h"
+#include "../graphics/TextureDiskCache.h"
 #include "../graphics/ImageMap.h"
 #include "../graphics/imformatdecoder.h"
 #include "../graphics/bitmap.h"
@@ -22,7 +24,10 @@ Copyright Glare Technologies Limited 2016 -
 #include "../utils/ConPrint.h"
 #include "../utils/Exception.h"
 #include "../utils/FileUtils.h"
+#include "../utils/PlatformUtils.h"
 #include "../utils/IncludeHalf.h"
+#include "../utils/HashMap.h"
+#include "../utils/Timer.h"
 #ifndef NO_GIF_SUPPORT
 #include <graphics/GifDecoder.h>
 #endif
@@ -285,6 +290,213 @@ static void testSplatCloudOrdering()
 }
 
 
+//==================================== Shared animation poses ====================================
+//
+// Tests and benchmarks computeAnimationPoseKey(), evalSharedAnimationPose() and applySharedAnimationPose(), which OpenGLEngine::draw() uses
+// so that animated objects in the same pose share a single keyframe evaluation per frame.
+
+
+// Computes the joint matrices of the object directly from its animation state, without the time quantisation or pose sharing of the pose key path.
+static void computePerObjectJointMatrices(const GLObject& ob, float current_time, js::Vector<Matrix4f, 16>& joint_matrices_out)
+{
+	const AnimationData& anim_data = ob.mesh_data->animation_data;
+	const int num_anims = (int)anim_data.animations.size();
+	const int anim_a_i = myClamp(ob.current_anim_i, 0, num_anims - 1);
+	const int anim_b_i = myClamp((ob.next_anim_i == -1) ? ob.current_anim_i : ob.next_anim_i, 0, num_anims - 1);
+	const float transition_frac = (float)Maths::smoothStep<double>(ob.transition_start_time, ob.transition_end_time, current_time);
+	const float unwrapped_use_in_anim_time = current_time + (float)ob.use_time_offset;
+
+	AnimationPose pose;
+	js::Vector<AnimationKeyFrameLocation, 16> key_frame_locs;
+	anim_data.samplePose(anim_a_i, anim_b_i, Maths::floatMod(unwrapped_use_in_anim_time, anim_data.animations[anim_a_i]->anim_len), 
+		Maths::floatMod(unwrapped_use_in_anim_time, anim_data.animations[anim_b_i]->anim_len), transition_frac, key_frame_locs, pose);
+
+	js::Vector<Matrix4f, 16> node_matrices(anim_data.nodes.size());
+	for(size_t n=0; n<anim_data.sorted_nodes.size(); ++n)
+	{
+		const int node_i = anim_data.sorted_nodes[n];
+		const AnimationNodeData& node_data = anim_data.nodes[node_i];
+		const Matrix4f TRS = Matrix4f::translationMatrix(pose.trans[node_i]) * pose.rot[node_i].toMatrix() * Matrix4f::scaleMatrix(pose.scale[node_i][0], pose.scale[node_i][1], pose.scale[node_i][2]);
+		node_matrices[node_i] = (node_data.parent_index == -1) ? TRS : (node_matrices[node_data.parent_index] * node_data.retarget_adjustment * TRS);
+	}
+
+	joint_matrices_out.resize(anim_data.joint_nodes.size());
+	for(size_t i=0; i<anim_data.joint_nodes.size(); ++i)
+		joint_matrices_out[i] = node_matrices[anim_data.joint_nodes[i]] * anim_data.nodes[anim_data.joint_nodes[i]].inverse_bind_matrix;
+}
+
+
+static void testSharedAnimationPoses()
+{
+	conPrint("testSharedAnimationPoses()");
+
+	BatchedMeshRef mesh = BatchedMesh::readFromFile(TestUtils::getTestReposDir() + "/testfiles/bmesh/Fox_glb_3500729461392160556.bmesh", NULL);
+
+	Reference<OpenGLMeshRenderData> mesh_data = new OpenGLMeshRenderData();
+	mesh_data->animation_data = mesh->animation_data;
+	const AnimationData& anim_data = mesh_data->animation_data;
+	testAssert(!anim_data.animations.empty() && !anim_data.joint_nodes.empty());
+
+	const float current_time = 12.345f;
+
+	// Make a crowd of instances.  Half are in sync, the rest are spread over 10 time offsets, and some are transitioning to another animation.
+	const int num_obs = 1000;
+	std::vector<GLObjectRef> obs(num_obs);
+	for(int i=0; i<num_obs; ++i)
+	{
+		obs[i] = new GLObject();
+		obs[i]->mesh_data = mesh_data;
+		obs[i]->current_anim_i = 0;
+		obs[i]->next_anim_i = (i % 7 == 0) ? 1 : -1;
+		obs[i]->transition_start_time = current_time - 0.1;
+		obs[i]->transition_end_time = current_time + 0.1;
+		obs[i]->use_time_offset = (i < num_obs / 2) ? 0.0 : (double)(i % 10) * 0.1;
+	}
+
+	//------------ Objects with the same animation state get the same key ------------
+	{
+		AnimationPoseKey key_a, key_b, key_c;
+		testAssert(computeAnimationPoseKey(*obs[1], current_time, key_a));
+		testAssert(computeAnimationPoseKey(*obs[2], current_time, key_b));
+		testAssert(computeAnimationPoseKey(*obs[num_obs - 1], current_time, key_c));
+		testAssert(key_a == key_b);
+		testAssert(key_a != key_c);
+		testAssert(AnimationPoseKeyHash()(key_a) == AnimationPoseKeyHash()(key_b));
+	}
+
+	js::Vector<Matrix4f, 16> node_matrices;
+
+	//------------ Per-object evaluation (one pose evaluation per object) ------------
+	std::vector<js::Vector<Matrix4f, 16>> ref_joint_matrices(num_obs);
+	double per_object_time = 1.0e10;
+	for(int iter=0; iter<10; ++iter)
+	{
+		Timer timer;
+		SharedAnimationPose pose;
+		for(int i=0; i<num_obs; ++i)
+		{
+			computeAnimationPoseKey(*obs[i], current_time, pose.key);
+			evalSharedAnimationPose(pose);
+			applySharedAnimationPose(pose, *obs[i], node_matrices);
+		}
+		per_object_time = myMin(per_object_time, timer.elapsed());
+	}
+	for(int i=0; i<num_obs; ++i)
+		ref_joint_matrices[i] = obs[i]->joint_matrices;
+
+	//------------ Shared evaluation (one pose evaluation per unique pose) ------------
+	const AnimationPoseKey empty_key;
+	HashMap<AnimationPoseKey, uint32, AnimationPoseKeyHash> pose_indices(empty_key);
+	std::vector<SharedAnimationPose> shared_poses;
+	double shared_time = 1.0e10;
+	for(int iter=0; iter<10; ++iter)
+	{
+		Timer timer;
+		pose_indices.clear();
+		size_t num_poses = 0;
+		for(int i=0; i<num_obs; ++i)
+		{
+			AnimationPoseKey key;
+			computeAnimationPoseKey(*obs[i], current_time, key);
+			const auto res = pose_indices.insert(std::make_pair(key, (uint32)num_poses));
+			if(res.second)
+			{
+				if(num_poses >= shared_poses.size())
+					shared_poses.resize(num_poses + 1);
+				shared_poses[num_poses++].key = key;
+			}
+		}
+		for(size_t p=0; p<num_poses; ++p)
+			evalSharedAnimationPose(shared_poses[p]);
+		for(int i=0; i<num_obs; ++i)
+		{
+			AnimationPoseKey key;
+			computeAnimationPoseKey(*obs[i], current_time, key);
+			applySharedAnimationPose(shared_poses[pose_indices.find(key)->second], *obs[i], node_matrices);
+		}
+		shared_time = myMin(shared_time, timer.elapsed());
+
+		if(iter == 0)
+			conPrint("Num unique poses for " + toString(num_obs) + " objects: " + toString(num_poses));
+	}
+
+	// Sharing should give exactly the same results.
+	for(int i=0; i<num_obs; ++i)
+	{
+		testAssert(obs[i]->joint_matrices.size() == ref_joint_matrices[i].size());
+		for(size_t z=0; z<ref_joint_matrices[i].size(); ++z)
+			testAssert(obs[i]->joint_matrices[z] == ref_joint_matrices[i][z]);
+	}
+
+	// The shared poses should match poses computed directly for each object, up to the error from quantising the animation time and transition fraction.
+	{
+		js::Vector<Matrix4f, 16> per_object_joint_matrices;
+		float max_error = 0;
+		float max_abs_val = 0;
+		for(int i=0; i<num_obs; ++i)
+		{
+			computePerObjectJointMatrices(*obs[i], current_time, per_object_joint_matrices);
+			testAssert(obs[i]->joint_matrices.size() == per_object_joint_matrices.size());
+			for(size_t z=0; z<per_object_joint_matrices.size(); ++z)
+				for(int e=0; e<16; ++e)
+				{
+					max_error   = myMax(max_error, std::fabs(obs[i]->joint_matrices[z].e[e] - per_object_joint_matrices[z].e[e]));
+					max_abs_val = myMax(max_abs_val, std::fabs(per_object_joint_matrices[z].e[e]));
+				}
+		}
+		conPrint("Max joint matrix element error vs per-object evaluation: " + doubleToStringNSigFigs(max_error, 4) + " (max element magnitude: " + doubleToStringNSigFigs(max_abs_val, 4) + ")");
+		testAssert(max_error <= 1.0e-2f * max_abs_val);
+	}
+
+	conPrint("Per-object pose evaluation: " + doubleToStringNSigFigs(per_object_time * 1.0e3, 4) + " ms");
+	conPrint("Shared pose evaluation:     " + doubleToStringNSigFigs(shared_time * 1.0e3, 4) + " ms (" + doubleToStringNSigFigs(per_object_time / shared_time, 3) + "x speedup)");
+
+	//------------ Objects with procedural transforms still get their own node hierarchy ------------
+	{
+		GLObject& ob = *obs[1];
+		const int node_i = anim_data.joint_nodes[0];
+		ob.anim_node_data[node_i].procedural_transform = Matrix4f::translationMatrix(0, 0, 1);
+
+		AnimationPoseKey key;
+		computeAnimationPoseKey(ob, current_time, key);
+		const SharedAnimationPose& shared_pose = shared_poses[pose_indices.find(key)->second];
+		applySharedAnimationPose(shared_pose, ob, node_matrices);
+
+		testAssert(ob.anim_node_data[node_i].node_hierarchical_to_object == shared_pose.node_matrices[node_i] * Matrix4f::translationMatrix(0, 0, 1));
+		testAssert(ob.anim_node_data[node_i].last_pre_proc_to_object == shared_pose.node_matrices[node_i]);
+		testAssert(!(ob.joint_matrices[0] == shared_pose.joint_matrices[0]));
+
+		ob.anim_node_data[node_i].procedural_transform = Matrix4f::identity();
+	}
+
+	//------------ Animation update-rate LOD ------------
+	{
+		testAssert(animationUpdatePeriodForProjectedSize(0.5f) == 1);
+		testAssert(animationUpdatePeriodForProjectedSize(0.05f) == 2);
+		testAssert(animationUpdatePeriodForProjectedSize(0.02f) == 4);
+
+		// Each object should be updated exactly once every update_period frames, and the updates should be spread over the frames.
+		for(int update_period=1; update_period<=4; update_period *= 2)
+		{
+			std::vector<int> num_updated_in_frame(update_period, 0);
+			for(int i=0; i<num_obs; ++i)
+			{
+				int num_updates = 0;
+				for(int f=0; f<update_period; ++f)
+					if(shouldUpdateAnimationInFrame(obs[i].ptr(), update_period, /*frame_num=*/1000 + f))
+					{
+						num_updates++;
+						num_updated_in_frame[f]++;
+					}
+				testAssert(num_updates == 1);
+			}
+			for(int f=0; f<update_period; ++f)
+				testAssert(num_updated_in_frame[f] > num_obs / (2 * update_period));
+		}
+	}
+}
+
+
 static void doTest(const std::string& /*indigo_base_dir*/, const std::string& mesh_path)
 {
 	//--------------------- Do perf and functionality tests ----------------------------
@@ -578,12 +790,55 @@ static void doTextureChunkedLoadingTests(OpenGLEngine& engine)
 }
 
 
+// Check that loading a texture through the engine uses the engine's texture disk cache: the first load should build and insert the texture data, 
+// and loading the same texture again after it has been removed should get the texture data from the disk cache.
+static void doTextureDiskCacheTest(OpenGLEngine& engine)
+{
+	if(!engine.DXTTextureCompressionSupportedAndEnabled())
+		return; // Only compressed texture data is cached.
+
+	const Reference<TextureDiskCache> original_cache = engine.getTextureDiskCache();
+
+	const std::string cache_dir = PlatformUtils::getTempDirPath() + "/opengl_engine_texture_disk_cache_test";
+	if(FileUtils::fileExists(cache_dir))
+		FileUtils::deleteDirectoryRecursive(cache_dir);
+
+	Reference<TextureDiskCache> cache = new TextureDiskCache(cache_dir, /*max size=*/100000000);
+	engine.setTextureDiskCache(cache);
+
+	ImageMapUInt8Ref map = new ImageMapUInt8(256, 256, 4);
+	for(size_t i=0; i<map->getDataSize(); ++i)
+		map->getData()[i] = (uint8)((i * 7) ^ (i >> 9));
+
+	const OpenGLTextureKey key("disk_cache_test_tex");
+	for(int i=0; i<2; ++i)
+	{
+		Reference<OpenGLTexture> opengl_tex = engine.getOrLoadOpenGLTextureForMap2D(key, *map);
+		testAssert(opengl_tex->xRes() == 256 && opengl_tex->yRes() == 256);
+		engine.removeOpenGLTexture(key);
+	}
+
+	{
+		Lock lock(cache->mutex);
+		testAssert(cache->num_misses == 1);
+		testAssert(cache->num_hits == 1);
+	}
+	testAssert(cache->numEntries() == 1);
+
+	engine.setTextureDiskCache(original_cache);
+	cache = NULL;
+	FileUtils::deleteDirectoryRecursive(cache_dir);
+}
+
+
 void doTextureLoadingTests(OpenGLEngine& engine)
 {
 	try
 	{
 		doTextureChunkedLoadingTests(engine);
 
+		doTextureDiskCacheTest(engine);
+
 		const bool original_use_canonical_paths = engine.getTextureServer()->useCanonicalPaths();
 		engine.getTextureServer()->setUseCanonicalPathKeys(original_use_canonical_paths);
 
@@ -615,6 +870,8 @@ void test(const std::string& indigo_base_dir)
 	conPrint("OpenGLEngineTests::test()");
 
 	testSplatCloudOrdering(); // Doesn't need a GL context or any test data.
+	GaussianSplatRenderer::test(); // Doesn't need a GL context.
+	testSharedAnimationPoses(); // Doesn't need a GL context.
 #if 0
 
 	doTest(indigo_base_dir, TestUtils::getTestReposDir() + "/testscenes/arrow.igmesh"); // Has both tris and quads
@@ -36,6 +36,9 @@ Copyright Glare Technologies Limited 2022 -
 #define GL_TEXTURE_MAX_ANISOTROPY_EXT							0x84FE
 #define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT						0x84FF
 #define GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT					0x8E8F
+#define GL_COMPRESSED_RGBA_BPTC_UNORM							0x8E8C
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM						0x8E8D
+#define GL_COMPRESSED_RG_RGTC2									0x8DBD
 
 // For emscripten
 #define GL_DEPTH_COMPONENT32F             0x8CAC
@@ -178,7 +181,9 @@ bool OpenGLTexture::hasAlpha() const
 		format == Format_Compressed_DXT_SRGBA_Uint8 ||
 		format == Format_Compressed_DXT_RGBA_Uint8 ||
 		format == Format_Compressed_ETC2_RGBA_Uint8 ||
-		format == Format_Compressed_ETC2_SRGBA_Uint8;
+		format == Format_Compressed_ETC2_SRGBA_Uint8 ||
+		format == Format_Compressed_BC7_RGBA_Uint8 ||
+		format == Format_Compressed_BC7_SRGBA_Uint8;
 }
 
 
@@ -308,6 +313,23 @@ void OpenGLTexture::getGLFormat(OpenGLTextureFormat format_, GLint& internal_for
 		gl_format = GL_RGBA;
 		type = GL_UNSIGNED_BYTE;
 		break;
+	case Format_Compressed_BC7_RGB_Uint8:
+	case Format_Compressed_BC7_RGBA_Uint8:
+		internal_format = GL_COMPRESSED_RGBA_BPTC_UNORM;
+		gl_format = GL_RGBA;
+		type = GL_UNSIGNED_BYTE;
+		break;
+	case Format_Compressed_BC7_SRGB_Uint8:
+	case Format_Compressed_BC7_SRGBA_Uint8:
+		internal_format = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+		gl_format = GL_RGBA;
+		type = GL_UNSIGNED_BYTE;
+		break;
+	case Format_Compressed_BC5_Uint8:
+		internal_format = GL_COMPRESSED_RG_RGTC2;
+		gl_format = GL_RG;
+		type = GL_UNSIGNED_BYTE;
+		break;
 	}
 }
 
@@ -369,6 +391,9 @@ std::string getStringForGLInternalFormat(GLint internal_format)
 		case GL_EXT_COMPRESSED_SRGB_S3TC_DXT1_EXT: return "GL_EXT_COMPRESSED_SRGB_S3TC_DXT1_EXT";
 		case GL_EXT_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT: return "GL_EXT_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT";
 		case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT: return "GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT";
+		case GL_COMPRESSED_RGBA_BPTC_UNORM: return "GL_COMPRESSED_RGBA_BPTC_UNORM";
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM: return "GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM";
+		case GL_COMPRESSED_RG_RGTC2: return "GL_COMPRESSED_RG_RGTC2";
 
 		case GL_COMPRESSED_RGB8_ETC2: return "GL_COMPRESSED_RGB8_ETC2";
 		case GL_COMPRESSED_RGBA8_ETC2_EAC: return "GL_COMPRESSED_RGB8_ETC2";
@@ -576,6 +601,11 @@ void OpenGLTexture::doCreateTexture(ArrayRef<uint8> tex_data,
 	if((this->format == Format_Compressed_BC6H) && opengl_engine && !opengl_engine->texture_compression_BC6H_support)
 		throw glare::Exception("Tried to load BC6H texture but BC6H format is not supported");
 
+	// BC7 is part of the same BPTC extension as BC6H.
+	if((this->format == Format_Compressed_BC7_RGB_Uint8 || this->format == Format_Compressed_BC7_RGBA_Uint8 || this->format == Format_Compressed_BC7_SRGB_Uint8 || this->format == Format_Compressed_BC7_SRGBA_Uint8) && 
+		opengl_engine && !opengl_engine->texture_compression_BC6H_support)
+		throw glare::Exception("Tried to load BC7 texture but BPTC formats are not supported");
+
 	const bool is_MSAA_tex = this->texture_target == GL_TEXTURE_2D_MULTISAMPLE;
 
 	glActiveTexture(GL_TEXTURE0); // Make sure we don't overwrite a texture binding to a non-zero texture unit (tex unit zero is the scratch texture unit).
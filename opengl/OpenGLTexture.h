@@ -230,9 +230,11 @@ public:
 
 struct TextureParams
 {
-	TextureParams() : allow_compression(true), use_sRGB(true), use_mipmaps(true), convert_float_to_half(true), filtering(OpenGLTexture::Filtering_Fancy), wrapping(OpenGLTexture::Wrapping_Repeat) {}
+	TextureParams() : allow_compression(true), use_BC7_compression(false), is_normal_map(false), use_sRGB(true), use_mipmaps(true), convert_float_to_half(true), filtering(OpenGLTexture::Filtering_Fancy), wrapping(OpenGLTexture::Wrapping_Repeat) {}
 
 	bool allow_compression;
+	bool use_BC7_compression; // When compressing, use BC7 instead of DXT (BC1/BC3), if BPTC texture compression is supported.
+	bool is_normal_map; // When compressing, use BC5 to store just X and Y, if RGTC texture compression is supported.  Z is reconstructed in the shader.
 	bool use_sRGB;
 	bool use_mipmaps;
 	bool convert_float_to_half;
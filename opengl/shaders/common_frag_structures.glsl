@@ -55,6 +55,7 @@ layout (std140) uniform MaterialCommonUniforms
 #define SIMPLE_DOUBLE_SIDED_FLAG			128
 #define SWIZZLE_ALBEDO_TEX_R_TO_RGB_FLAG	256
 #define CONVERT_ALBEDO_FROM_SRGB_FLAG		512
+#define NORMAL_MAP_IS_TWO_CHANNEL_FLAG		1024
 
 
 #define CameraType_Identity					0
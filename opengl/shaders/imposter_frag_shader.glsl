@@ -65,8 +65,12 @@ void main()
 
 	// TEMP: get normals from normal map
 	if((matdata.flags & HAVE_NORMAL_MAP_FLAG) != 0)
+	{
 		use_normal_ws = texture(NORMAL_MAP,  matdata.texture_upper_left_matrix_col0 * use_texture_coords.x + matdata.texture_upper_left_matrix_col1 * use_texture_coords.y + matdata.texture_matrix_translation).xyz * 2.0 - 
 			vec3(1,1,1);
+		if((matdata.flags & NORMAL_MAP_IS_TWO_CHANNEL_FLAG) != 0) // If the normal map just stores X and Y (BC5), reconstruct Z.
+			use_normal_ws.z = sqrt(max(0.0, 1.0 - dot(use_normal_ws.xy, use_normal_ws.xy)));
+	}
 
 	// Rotate normals vector around z-axis:
 	float phi = imposter_rot;
@@ -406,6 +406,8 @@ void main()
 		vec2 st = main_tex_coords;
 		vec3 norm_map_v = texture(NORMAL_MAP, st).xyz;
 		norm_map_v = norm_map_v * 2.0 - vec3(1.0);
+		if((use_flags & NORMAL_MAP_IS_TWO_CHANNEL_FLAG) != 0) // If the normal map just stores X and Y (BC5), reconstruct Z.
+			norm_map_v.z = sqrt(max(0.0, 1.0 - dot(norm_map_v.xy, norm_map_v.xy)));
 #if VERT_TANGENTS
 		vec3 bitangent_ws = cross(unit_normal_ws, tangent_ws.xyz) * tangent_ws.w; // From GLTF spec
 
@@ -8,6 +8,9 @@ Copyright Glare Technologies Limited 2022 -
 
 #include <utils/Vector.h>
 #include <utils/HashSet.h>
+#include <utils/Sort.h>
+#include <utils/TaskManager.h>
+#include <utility>
 
 
 template <typename Key, typename HashFunc>
@@ -22,9 +25,29 @@ public:
 };
 
 
+// An entry in the sorted cell array used by the batched broadphase.
+struct HashedGrid2CellEntry
+{
+	uint32 bucket_i;
+	uint32 object_i;
+};
+
+
 /*=====================================================================
 HashedGrid2
 -----------
+Can be used in two ways:
+
+Incremental: insert() and remove() keys one at a time, keys are stored in a HashSet per bucket.
+
+Batched broadphase: call buildBroadphase() once per frame with the AABBs of all objects.
+This emits a (bucket index, object index) entry for every cell each object overlaps,
+radix sorts the entries by bucket index, and builds an offset table so the objects in a bucket
+are a contiguous range of the sorted array.
+queryBroadphase() and findBroadphaseOverlappingPairs() then answer many queries in one pass.
+Objects are referred to by their index in the AABB array passed to buildBroadphase().
+
+Tests are in HashedGridTests.
 =====================================================================*/
 template <typename Key, typename HashFunc>
 class HashedGrid2
@@ -154,8 +177,358 @@ public:
 	}
 
 
+	//----------------------------------- Batched broadphase -----------------------------------
+
+	// Rebuilds the sorted cell array from the given object AABBs.  task_manager may be NULL, in which case the build is done on the calling thread.
+	void buildBroadphase(const js::AABBox* aabbs, size_t num_objects, glare::TaskManager* task_manager);
+
+	// For each query AABB, finds the indices of all objects (as passed to buildBroadphase) with AABBs overlapping it.
+	// Results for query q are in object_indices_out[query_offsets_out[q] .. query_offsets_out[q + 1]).  Each object is returned at most once per query.
+	void queryBroadphase(const js::AABBox* query_aabbs, size_t num_queries, js::Vector<uint32, 16>& query_offsets_out, js::Vector<uint32, 16>& object_indices_out, 
+		glare::TaskManager* task_manager) const;
+
+	// Finds all pairs of objects with overlapping AABBs.  Each pair is returned once, with pair.first < pair.second.
+	void findBroadphaseOverlappingPairs(js::Vector<std::pair<uint32, uint32>, 16>& pairs_out, glare::TaskManager* task_manager) const;
+
+	size_t numBroadphaseObjects() const { return bp_aabbs.size(); }
+	size_t numBroadphaseCellEntries() const { return bp_entries.size(); }
+
+	// Object i was found in the cell with indices (x, y, z), while searching for overlaps with an object or query AABB 'other'.
+	// Returns true if (x, y, z) is the minimum cell of the intersection of the two AABBs.  This is used to avoid reporting the same overlap from multiple cells.
+	inline bool isFirstSharedCell(const js::AABBox& a, const js::AABBox& b, int x, int y, int z) const
+	{
+		const Vec4i first_cell = bucketIndicesForPoint(max(a.min_, b.min_));
+		return first_cell[0] == x && first_cell[1] == y && first_cell[2] == z;
+	}
+
+
 	float recip_cell_w;
 	float cell_w;
 	js::Vector<HashedGrid2Bucket<Key, HashFunc>, 16> buckets;
 	uint32 hash_mask; // hash_mask = buckets_size - 1;
+
+	// Batched broadphase data, built in buildBroadphase().
+	js::Vector<js::AABBox, 32> bp_aabbs; // Copy of the AABB of each object.
+	js::Vector<uint32, 16> bp_object_entry_offsets; // Index of the first cell entry for each object, before sorting.  Has num_objects + 1 elements.
+	js::Vector<HashedGrid2CellEntry, 16> bp_entries; // Cell entries, sorted by bucket index.
+	js::Vector<HashedGrid2CellEntry, 16> bp_entries_working; // Working space for sorting.
+	js::Vector<uint32, 16> bp_bucket_offsets; // Index of first entry in bp_entries for each bucket.  Has num buckets + 1 elements.
+	js::Vector<uint32, 16> bp_sort_temp_counts;
+};
+
+
+//----------------------------------- Batched broadphase tasks -----------------------------------
+
+
+template <typename Key, typename HashFunc>
+struct HashedGrid2BroadphaseClosure
+{
+	HashedGrid2<Key, HashFunc>* grid;
+};
+
+
+// Computes the number of cells overlapped by each object.
+template <typename Key, typename HashFunc>
+class HashedGrid2CountCellsTask : public glare::Task
+{
+public:
+	HashedGrid2CountCellsTask(const HashedGrid2BroadphaseClosure<Key, HashFunc>& closure_, size_t begin_, size_t end_) : closure(closure_), begin(begin_), end(end_) {}
+
+	virtual void run(size_t thread_index)
+	{
+		HashedGrid2<Key, HashFunc>& grid = *closure.grid;
+		for(size_t i=begin; i<end; ++i)
+			grid.bp_object_entry_offsets[i] = (uint32)grid.numCellsForAABB(grid.bp_aabbs[i]);
+	}
+
+	HashedGrid2BroadphaseClosure<Key, HashFunc> closure;
+	size_t begin, end;
+};
+
+
+// Writes the (unsorted) cell entries for each object.
+template <typename Key, typename HashFunc>
+class HashedGrid2WriteEntriesTask : public glare::Task
+{
+public:
+	HashedGrid2WriteEntriesTask(const HashedGrid2BroadphaseClosure<Key, HashFunc>& closure_, size_t begin_, size_t end_) : closure(closure_), begin(begin_), end(end_) {}
+
+	virtual void run(size_t thread_index)
+	{
+		HashedGrid2<Key, HashFunc>& grid = *closure.grid;
+		HashedGrid2CellEntry* const entries = grid.bp_entries_working.data();
+		for(size_t i=begin; i<end; ++i)
+		{
+			const Vec4i min_bucket_i = grid.bucketIndicesForPoint(grid.bp_aabbs[i].min_);
+			const Vec4i max_bucket_i = grid.bucketIndicesForPoint(grid.bp_aabbs[i].max_);
+
+			uint32 write_i = grid.bp_object_entry_offsets[i];
+			for(int x=min_bucket_i[0]; x <= max_bucket_i[0]; ++x)
+			for(int y=min_bucket_i[1]; y <= max_bucket_i[1]; ++y)
+			for(int z=min_bucket_i[2]; z <= max_bucket_i[2]; ++z)
+			{
+				entries[write_i].bucket_i = grid.computeHash(x, y, z);
+				entries[write_i].object_i = (uint32)i;
+				write_i++;
+			}
+			assert(write_i == grid.bp_object_entry_offsets[i + 1]);
+		}
+	}
+
+	HashedGrid2BroadphaseClosure<Key, HashFunc> closure;
+	size_t begin, end;
+};
+
+
+// Finds objects overlapping a range of query AABBs.  Writes results to task-local arrays which are concatenated afterwards.
+template <typename Key, typename HashFunc>
+class HashedGrid2QueryTask : public glare::Task
+{
+public:
+	virtual void run(size_t thread_index)
+	{
+		const HashedGrid2<Key, HashFunc>& grid = *grid_;
+		const HashedGrid2CellEntry* const entries = grid.bp_entries.data();
+		const uint32* const bucket_offsets = grid.bp_bucket_offsets.data();
+		const js::AABBox* const aabbs = grid.bp_aabbs.data();
+
+		query_num_results.resizeNoCopy(end - begin);
+		object_indices.clear();
+
+		for(size_t q=begin; q<end; ++q)
+		{
+			const js::AABBox& query_aabb = query_aabbs[q];
+			const size_t initial_num = object_indices.size();
+
+			const Vec4i min_bucket_i = grid.bucketIndicesForPoint(query_aabb.min_);
+			const Vec4i max_bucket_i = grid.bucketIndicesForPoint(query_aabb.max_);
+
+			for(int x=min_bucket_i[0]; x <= max_bucket_i[0]; ++x)
+			for(int y=min_bucket_i[1]; y <= max_bucket_i[1]; ++y)
+			for(int z=min_bucket_i[2]; z <= max_bucket_i[2]; ++z)
+			{
+				const uint32 bucket_i = grid.computeHash(x, y, z);
+				const uint32 entries_end = bucket_offsets[bucket_i + 1];
+				for(uint32 e=bucket_offsets[bucket_i]; e<entries_end; ++e)
+				{
+					const uint32 object_i = entries[e].object_i;
+					if(aabbs[object_i].intersectsAABB(query_aabb) && grid.isFirstSharedCell(aabbs[object_i], query_aabb, x, y, z))
+						object_indices.push_back(object_i);
+				}
+			}
+
+			query_num_results[q - begin] = (uint32)(object_indices.size() - initial_num);
+		}
+	}
+
+	const HashedGrid2<Key, HashFunc>* grid_;
+	const js::AABBox* query_aabbs;
+	size_t begin, end;
+	js::Vector<uint32, 16> query_num_results;
+	js::Vector<uint32, 16> object_indices;
 };
+
+
+// Finds overlapping pairs for objects in a range of buckets.
+template <typename Key, typename HashFunc>
+class HashedGrid2PairsTask : public glare::Task
+{
+public:
+	virtual void run(size_t thread_index)
+	{
+		const HashedGrid2<Key, HashFunc>& grid = *grid_;
+		const HashedGrid2CellEntry* const entries = grid.bp_entries.data();
+		const uint32* const bucket_offsets = grid.bp_bucket_offsets.data();
+		const js::AABBox* const aabbs = grid.bp_aabbs.data();
+
+		pairs.clear();
+
+		for(size_t b=begin; b<end; ++b)
+		{
+			const uint32 entries_begin = bucket_offsets[b];
+			const uint32 entries_end   = bucket_offsets[b + 1];
+			for(uint32 i=entries_begin; i<entries_end; ++i)
+			{
+				const uint32 object_a = entries[i].object_i;
+				const js::AABBox& aabb_a = aabbs[object_a];
+				for(uint32 j=i+1; j<entries_end; ++j)
+				{
+					const uint32 object_b = entries[j].object_i;
+					const js::AABBox& aabb_b = aabbs[object_b];
+					if(aabb_a.intersectsAABB(aabb_b))
+					{
+						// Only report the pair from the bucket of the first cell they share, as they may share many cells.
+						const Vec4i first_cell = grid.bucketIndicesForPoint(max(aabb_a.min_, aabb_b.min_));
+						if(grid.computeHash(first_cell) == (uint32)b)
+							pairs.push_back(std::make_pair(myMin(object_a, object_b), myMax(object_a, object_b)));
+					}
+				}
+			}
+		}
+	}
+
+	const HashedGrid2<Key, HashFunc>* grid_;
+	size_t begin, end;
+	js::Vector<std::pair<uint32, uint32>, 16> pairs;
+};
+
+
+template <typename Key, typename HashFunc>
+void HashedGrid2<Key, HashFunc>::buildBroadphase(const js::AABBox* aabbs, size_t num_objects, glare::TaskManager* task_manager)
+{
+	assert(num_objects < std::numeric_limits<uint32>::max());
+
+	bp_aabbs.resizeNoCopy(num_objects);
+	for(size_t i=0; i<num_objects; ++i)
+		bp_aabbs[i] = aabbs[i];
+
+	HashedGrid2BroadphaseClosure<Key, HashFunc> closure;
+	closure.grid = this;
+
+	// Count number of cells overlapped by each object
+	bp_object_entry_offsets.resizeNoCopy(num_objects + 1);
+	if(task_manager)
+		task_manager->runParallelForTasks<HashedGrid2CountCellsTask<Key, HashFunc>, HashedGrid2BroadphaseClosure<Key, HashFunc>>(closure, 0, num_objects);
+	else
+		HashedGrid2CountCellsTask<Key, HashFunc>(closure, 0, num_objects).run(0);
+
+	// Compute exclusive prefix sum of cell counts
+	size_t sum = 0;
+	for(size_t i=0; i<num_objects; ++i)
+	{
+		const uint32 count = bp_object_entry_offsets[i];
+		bp_object_entry_offsets[i] = (uint32)sum;
+		sum += count;
+	}
+	bp_object_entry_offsets[num_objects] = (uint32)sum;
+	assert(sum < std::numeric_limits<uint32>::max());
+
+	// Write cell entries
+	bp_entries_working.resizeNoCopy(sum);
+	bp_entries.resizeNoCopy(sum);
+	if(task_manager)
+		task_manager->runParallelForTasks<HashedGrid2WriteEntriesTask<Key, HashFunc>, HashedGrid2BroadphaseClosure<Key, HashFunc>>(closure, 0, num_objects);
+	else
+		HashedGrid2WriteEntriesTask<Key, HashFunc>(closure, 0, num_objects).run(0);
+
+	// Sort entries by bucket index.  The sort is stable, so entries for the same object in the same bucket (from different cells with the same hash) will be adjacent.
+	// The sorted entries are left in bp_entries_working.
+	const auto get_bucket_i = [](const HashedGrid2CellEntry& e) { return e.bucket_i; };
+	if(task_manager)
+		Sort::parallelRadixSort32BitKey(*task_manager, bp_entries_working.data(), bp_entries.data(), sum, get_bucket_i, bp_sort_temp_counts);
+	else
+	{
+		bp_sort_temp_counts.resizeNoCopy(2048 * 3);
+		Sort::radixSort32BitKey(bp_entries_working.data(), bp_entries.data(), sum, get_bucket_i, bp_sort_temp_counts.data(), bp_sort_temp_counts.size());
+	}
+
+	// Remove duplicate entries, writing to bp_entries, and count number of entries in each bucket.
+	// These are single linear passes, so are left on the calling thread.
+	const size_t num_buckets = buckets.size();
+	bp_bucket_offsets.resizeNoCopy(num_buckets + 1);
+	for(size_t i=0; i<num_buckets + 1; ++i)
+		bp_bucket_offsets[i] = 0;
+
+	size_t num_unique = 0;
+	for(size_t i=0; i<sum; ++i)
+	{
+		const HashedGrid2CellEntry entry = bp_entries_working[i];
+		if(num_unique == 0 || entry.bucket_i != bp_entries[num_unique - 1].bucket_i || entry.object_i != bp_entries[num_unique - 1].object_i)
+		{
+			bp_entries[num_unique++] = entry;
+			bp_bucket_offsets[entry.bucket_i + 1]++;
+		}
+	}
+	bp_entries.resize(num_unique);
+
+	// Compute prefix sum to get bucket offsets
+	for(size_t i=0; i<num_buckets; ++i)
+		bp_bucket_offsets[i + 1] += bp_bucket_offsets[i];
+	assert(bp_bucket_offsets[num_buckets] == num_unique);
+}
+
+
+template <typename Key, typename HashFunc>
+void HashedGrid2<Key, HashFunc>::queryBroadphase(const js::AABBox* query_aabbs, size_t num_queries, js::Vector<uint32, 16>& query_offsets_out, js::Vector<uint32, 16>& object_indices_out, 
+	glare::TaskManager* task_manager) const
+{
+	query_offsets_out.resizeNoCopy(num_queries + 1);
+	object_indices_out.clear();
+
+	const size_t num_tasks = task_manager ? myMax<size_t>(1, myMin(num_queries, task_manager->getConcurrency())) : 1;
+	const size_t num_per_task = Maths::roundedUpDivide(num_queries, num_tasks);
+
+	glare::TaskGroupRef group = new glare::TaskGroup();
+	group->tasks.resize(num_tasks);
+	for(size_t t=0; t<num_tasks; ++t)
+	{
+		HashedGrid2QueryTask<Key, HashFunc>* task = new HashedGrid2QueryTask<Key, HashFunc>();
+		task->grid_ = this;
+		task->query_aabbs = query_aabbs;
+		task->begin = myMin(t * num_per_task, num_queries);
+		task->end   = myMin((t + 1) * num_per_task, num_queries);
+		group->tasks[t] = task;
+	}
+
+	if(task_manager)
+		task_manager->runTaskGroup(group);
+	else
+		group->tasks[0]->run(0);
+
+	// Concatenate task results
+	size_t num_results = 0;
+	for(size_t t=0; t<num_tasks; ++t)
+		num_results += static_cast<HashedGrid2QueryTask<Key, HashFunc>*>(group->tasks[t].ptr())->object_indices.size();
+	object_indices_out.resizeNoCopy(num_results);
+
+	size_t write_i = 0;
+	for(size_t t=0; t<num_tasks; ++t)
+	{
+		const HashedGrid2QueryTask<Key, HashFunc>* task = static_cast<HashedGrid2QueryTask<Key, HashFunc>*>(group->tasks[t].ptr());
+		for(size_t q=task->begin; q<task->end; ++q)
+		{
+			query_offsets_out[q] = (uint32)write_i;
+			write_i += task->query_num_results[q - task->begin];
+		}
+		if(!task->object_indices.empty())
+			std::memcpy(&object_indices_out[query_offsets_out[task->begin]], task->object_indices.data(), task->object_indices.dataSizeBytes());
+	}
+	query_offsets_out[num_queries] = (uint32)write_i;
+	assert(write_i == num_results);
+}
+
+
+template <typename Key, typename HashFunc>
+void HashedGrid2<Key, HashFunc>::findBroadphaseOverlappingPairs(js::Vector<std::pair<uint32, uint32>, 16>& pairs_out, glare::TaskManager* task_manager) const
+{
+	pairs_out.clear();
+	if(bp_bucket_offsets.empty()) // If buildBroadphase() has not been called:
+		return;
+
+	const size_t num_buckets = buckets.size();
+	const size_t num_tasks = task_manager ? task_manager->getConcurrency() : 1;
+	const size_t num_per_task = Maths::roundedUpDivide(num_buckets, num_tasks);
+
+	glare::TaskGroupRef group = new glare::TaskGroup();
+	group->tasks.resize(num_tasks);
+	for(size_t t=0; t<num_tasks; ++t)
+	{
+		HashedGrid2PairsTask<Key, HashFunc>* task = new HashedGrid2PairsTask<Key, HashFunc>();
+		task->grid_ = this;
+		task->begin = myMin(t * num_per_task, num_buckets);
+		task->end   = myMin((t + 1) * num_per_task, num_buckets);
+		group->tasks[t] = task;
+	}
+
+	if(task_manager)
+		task_manager->runTaskGroup(group);
+	else
+		group->tasks[0]->run(0);
+
+	for(size_t t=0; t<num_tasks; ++t)
+	{
+		const HashedGrid2PairsTask<Key, HashFunc>* task = static_cast<HashedGrid2PairsTask<Key, HashFunc>*>(group->tasks[t].ptr());
+		for(size_t i=0; i<task->pairs.size(); ++i)
+			pairs_out.push_back(task->pairs[i]);
+	}
+}
@@ -11,6 +11,7 @@ Generated at Thu Sep 09 12:53:49 +1200 2010
 
 
 #include "HashedGrid.h"
+#include "HashedGrid2.h"
 #include "../utils/Clock.h"
 #include "../maths/PCG32.h"
 #include "../utils/ConPrint.h"
@@ -18,6 +19,8 @@ Generated at Thu Sep 09 12:53:49 +1200 2010
 #include "../utils/StringUtils.h"
 #include "../utils/TestUtils.h"
 #include "../maths/vec3.h"
+#include "../utils/TaskManager.h"
+#include <algorithm>
 
 
 static void perfTests()
@@ -75,10 +78,178 @@ static void perfTests()
 }
 
 
+static js::AABBox makeRandomAABB(PCG32& rng, float world_w, float max_half_w)
+{
+	const Vec4f centre(rng.unitRandom() * world_w, rng.unitRandom() * world_w, rng.unitRandom() * world_w, 1);
+	const Vec4f half_w(rng.unitRandom() * max_half_w, rng.unitRandom() * max_half_w, rng.unitRandom() * max_half_w, 0);
+	return js::AABBox(centre - half_w, centre + half_w);
+}
+
+
+static void testBroadphase(glare::TaskManager* task_manager)
+{
+	// Test batched broadphase queries and pair finding against brute-force results.
+	for(int iter=0; iter<4; ++iter)
+	{
+		PCG32 rng(iter + 1);
+		const int num_objects = 1000;
+		const float world_w = (iter % 2 == 0) ? 50.f : 2000.f; // Use a large world for some iters, so that we get lots of hash collisions (many cells mapping to the same bucket).
+		std::vector<js::AABBox> aabbs(num_objects);
+		for(int i=0; i<num_objects; ++i)
+			aabbs[i] = makeRandomAABB(rng, world_w, /*max half w=*/(i % 10 == 0) ? 6.f : 1.f); // Make every 10th object larger, so it overlaps lots of cells.
+
+		HashedGrid2<int, std::hash<int>> grid(/*cell_w=*/2.f, /*num_buckets=*/256, /*expected_num_items_per_bucket=*/4, /*empty key=*/-1);
+		grid.buildBroadphase(aabbs.data(), num_objects, (iter < 2) ? NULL : task_manager);
+		testAssert(grid.numBroadphaseObjects() == num_objects);
+
+		// Test queries
+		const int num_queries = 300;
+		std::vector<js::AABBox> query_aabbs(num_queries);
+		for(int i=0; i<num_queries; ++i)
+			query_aabbs[i] = makeRandomAABB(rng, world_w, /*max half w=*/3.f);
+
+		js::Vector<uint32, 16> query_offsets;
+		js::Vector<uint32, 16> object_indices;
+		grid.queryBroadphase(query_aabbs.data(), num_queries, query_offsets, object_indices, (iter < 2) ? NULL : task_manager);
+		testAssert(query_offsets.size() == num_queries + 1);
+
+		for(int q=0; q<num_queries; ++q)
+		{
+			std::vector<uint32> results(object_indices.begin() + query_offsets[q], object_indices.begin() + query_offsets[q + 1]);
+			std::sort(results.begin(), results.end());
+
+			std::vector<uint32> ref_results;
+			for(int i=0; i<num_objects; ++i)
+				if(aabbs[i].intersectsAABB(query_aabbs[q]))
+					ref_results.push_back((uint32)i);
+
+			testAssert(results == ref_results);
+		}
+
+		// Test pairs
+		js::Vector<std::pair<uint32, uint32>, 16> pairs;
+		grid.findBroadphaseOverlappingPairs(pairs, (iter < 2) ? NULL : task_manager);
+		std::vector<std::pair<uint32, uint32>> sorted_pairs(pairs.begin(), pairs.end());
+		std::sort(sorted_pairs.begin(), sorted_pairs.end());
+
+		std::vector<std::pair<uint32, uint32>> ref_pairs;
+		for(int a=0; a<num_objects; ++a)
+		for(int b=a+1; b<num_objects; ++b)
+			if(aabbs[a].intersectsAABB(aabbs[b]))
+				ref_pairs.push_back(std::make_pair((uint32)a, (uint32)b));
+
+		testAssert(sorted_pairs == ref_pairs);
+	}
+
+	// Test that a parallel build gives the same results as a serial one, with enough cell entries that the parallel build sorts
+	// them with the parallel radix sort, which the smaller tests above don't reach.
+	{
+		PCG32 rng(1);
+		const int num_objects = 20000;
+		std::vector<js::AABBox> aabbs(num_objects);
+		for(int i=0; i<num_objects; ++i)
+			aabbs[i] = makeRandomAABB(rng, /*world_w=*/500.f, /*max half w=*/3.f);
+
+		HashedGrid2<int, std::hash<int>> grid(/*cell_w=*/2.f, /*num_buckets=*/1 << 16, /*expected_num_items_per_bucket=*/4, /*empty key=*/-1);
+
+		js::Vector<uint32, 16> query_offsets[2];
+		js::Vector<uint32, 16> object_indices[2];
+		js::Vector<std::pair<uint32, uint32>, 16> pairs[2];
+		for(int t=0; t<2; ++t)
+		{
+			glare::TaskManager* use_task_manager = (t == 0) ? NULL : task_manager;
+			grid.buildBroadphase(aabbs.data(), num_objects, use_task_manager);
+			grid.queryBroadphase(aabbs.data(), num_objects, query_offsets[t], object_indices[t], use_task_manager);
+			grid.findBroadphaseOverlappingPairs(pairs[t], use_task_manager);
+		}
+		testAssert(grid.numBroadphaseCellEntries() > 100000);
+
+		// The sort is stable in both cases, so the cell entries, and so the query results, should be in the same order.
+		testAssert(query_offsets[0] == query_offsets[1]);
+		testAssert(object_indices[0] == object_indices[1]);
+
+		std::vector<std::pair<uint32, uint32>> sorted_pairs[2];
+		for(int t=0; t<2; ++t)
+		{
+			sorted_pairs[t].assign(pairs[t].begin(), pairs[t].end());
+			std::sort(sorted_pairs[t].begin(), sorted_pairs[t].end());
+		}
+		testAssert(sorted_pairs[0] == sorted_pairs[1]);
+	}
+
+	// Perf test: crowd of avatars/projectiles
+	{
+		PCG32 rng(1);
+		const int num_objects = 20000;
+		const float world_w = 500.f;
+		std::vector<js::AABBox> aabbs(num_objects);
+		for(int i=0; i<num_objects; ++i)
+			aabbs[i] = makeRandomAABB(rng, world_w, /*max half w=*/1.f);
+
+		HashedGrid2<int, std::hash<int>> grid(/*cell_w=*/4.f, /*num_buckets=*/1 << 16, /*expected_num_items_per_bucket=*/4, /*empty key=*/-1);
+
+		// Compare against inserting into the per-bucket hash sets and querying one-at-a-time.
+		{
+			Timer timer;
+			for(int i=0; i<num_objects; ++i)
+				grid.insert(i, aabbs[i]);
+			const double insert_time = timer.elapsed();
+			timer.reset();
+
+			size_t num_hits = 0;
+			for(int i=0; i<num_objects; ++i)
+			{
+				const Vec4i min_bucket_i = grid.bucketIndicesForPoint(aabbs[i].min_);
+				const Vec4i max_bucket_i = grid.bucketIndicesForPoint(aabbs[i].max_);
+				for(int x=min_bucket_i[0]; x <= max_bucket_i[0]; ++x)
+				for(int y=min_bucket_i[1]; y <= max_bucket_i[1]; ++y)
+				for(int z=min_bucket_i[2]; z <= max_bucket_i[2]; ++z)
+				{
+					const auto& bucket = grid.getBucketForIndices(x, y, z);
+					for(auto it = bucket.objects.begin(); it != bucket.objects.end(); ++it)
+						if(aabbs[*it].intersectsAABB(aabbs[i]))
+							num_hits++;
+				}
+			}
+			conPrint("HashSet insert: " + doubleToStringNSigFigs(insert_time * 1.0e3, 4) + " ms");
+			conPrint("HashSet one-at-a-time queries: " + doubleToStringNSigFigs(timer.elapsed() * 1.0e3, 4) + " ms (" + toString(num_hits) + " hits, including duplicates)");
+			grid.clear();
+		}
+
+		for(int t=0; t<2; ++t)
+		{
+			glare::TaskManager* use_task_manager = (t == 0) ? NULL : task_manager;
+
+			Timer timer;
+			grid.buildBroadphase(aabbs.data(), num_objects, use_task_manager);
+			const double build_time = timer.elapsed();
+			timer.reset();
+
+			js::Vector<uint32, 16> query_offsets;
+			js::Vector<uint32, 16> object_indices;
+			grid.queryBroadphase(aabbs.data(), num_objects, query_offsets, object_indices, use_task_manager);
+			const double query_time = timer.elapsed();
+			timer.reset();
+
+			js::Vector<std::pair<uint32, uint32>, 16> pairs;
+			grid.findBroadphaseOverlappingPairs(pairs, use_task_manager);
+			const double pairs_time = timer.elapsed();
+
+			conPrint(std::string(t == 0 ? "Serial" : "Parallel") + " broadphase build: " + doubleToStringNSigFigs(build_time * 1.0e3, 4) + " ms (" + toString(grid.numBroadphaseCellEntries()) + " cell entries)");
+			conPrint("    batch query:  " + doubleToStringNSigFigs(query_time * 1.0e3, 4) + " ms (" + toString(object_indices.size()) + " hits)");
+			conPrint("    find pairs:   " + doubleToStringNSigFigs(pairs_time * 1.0e3, 4) + " ms (" + toString(pairs.size()) + " pairs)");
+		}
+	}
+}
+
+
 void HashedGridTests::test()
 {
 	conPrint("HashedGridTests::test()");
 
+	glare::TaskManager task_manager;
+	testBroadphase(&task_manager);
+
 	perfTests();
 
 	/*
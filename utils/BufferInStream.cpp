@@ -7,6 +7,7 @@ Copyright Glare Technologies Limited 2021 -
 
 
 #include "Exception.h"
+#include "StringUtils.h"
 #include <cstring> // For std::memcpy
 
 
@@ -55,67 +56,12 @@ void BufferInStream::clear() // Resizes buffer to zero, resets read_index to zer
 }
 
 
-uint8 BufferInStream::readUInt8()
-{
-	if(!canReadNBytes(sizeof(uint8)))
-		throw glare::Exception("Read past end of buffer.");
-
-	uint8 x;
-	std::memcpy(&x, &buf[read_index], sizeof(x));
-	read_index += sizeof(x);
-	return x;
-}
-
-
-int32 BufferInStream::readInt32()
-{
-	if(!canReadNBytes(sizeof(int32)))
-		throw glare::Exception("Read past end of buffer.");
-
-	int32 x;
-	std::memcpy(&x, &buf[read_index], sizeof(x));
-	read_index += sizeof(x);
-	return x;
-}
-
-
-uint32 BufferInStream::readUInt32()
-{
-	if(!canReadNBytes(sizeof(uint32)))
-		throw glare::Exception("Read past end of buffer.");
-
-	uint32 x;
-	std::memcpy(&x, &buf[read_index], sizeof(x));
-	read_index += sizeof(x);
-	return x;
-}
-
-
-void BufferInStream::readData(void* target_buf, size_t num_bytes)
-{
-	if(num_bytes > 0)
-	{
-		if(!canReadNBytes(num_bytes))
-			throw glare::Exception("Read past end of buffer.");
-
-		std::memcpy(target_buf, &buf[read_index], num_bytes);
-		read_index += num_bytes;
-	}
-}
-
-
 bool BufferInStream::endOfStream()
 {
 	return read_index >= buf.size();
 }
 
 
-bool BufferInStream::canReadNBytes(size_t N) const
-{
-	return ((read_index + N) <= buf.size()) && !Maths::unsignedIntAdditionWraps(read_index, N);
-}
-
-
 void BufferInStream::setReadIndex(size_t i)
 {
 	if(i > buf.size())
@@ -130,3 +76,20 @@ void BufferInStream::advanceReadIndex(size_t n)
 		throw glare::Exception("Invalid number of bytes to advance for advanceReadIndex - read past end of file.");
 	read_index += n;
 }
+
+
+const std::string BufferInStream::readStringLengthFirst(size_t max_string_length)
+{
+	// Read string byte size
+	const uint32 size = readUInt32();
+	if((size_t)size > max_string_length)
+		throw glare::Exception("String length too long (length=" + toString(size) + ")");
+
+	std::string s(size, '\0'); // Use fill constructor
+
+	// Read content
+	if(size > 0)
+		readData(&s[0], size);
+
+	return s;
+}
@@ -10,6 +10,8 @@ Copyright Glare Technologies Limited 2022 -
 #include "Vector.h"
 #include "AllocatorVector.h"
 #include "ArrayRef.h"
+#include "Exception.h"
+#include <cstring> // For std::memcpy
 #include <vector>
 
 
@@ -17,6 +19,9 @@ Copyright Glare Technologies Limited 2022 -
 BufferInStream
 --------------
 Input stream that reads from a buffer
+
+The commonly used read methods are defined inline below, so that calls made through a
+BufferInStream reference are devirtualised and inlined.
 =====================================================================*/
 class BufferInStream final : public RandomAccessInStream
 {
@@ -36,6 +41,11 @@ public:
 	virtual void readData(void* buf, size_t num_bytes);
 	virtual bool endOfStream();
 
+	// Same as the InStream methods, but with non-virtual reads.
+	float readFloat();
+	uint64 readUInt64();
+	[[nodiscard]] const std::string readStringLengthFirst(size_t max_string_length);
+
 	virtual bool canReadNBytes(size_t N) const;
 	virtual void setReadIndex(size_t i);
 	virtual void advanceReadIndex(size_t n);
@@ -49,3 +59,75 @@ public:
 	glare::AllocatorVector<unsigned char, 16> buf;
 	size_t read_index;
 };
+
+
+inline uint8 BufferInStream::readUInt8()
+{
+	if(!canReadNBytes(sizeof(uint8)))
+		throw glare::Exception("Read past end of buffer.");
+
+	uint8 x;
+	std::memcpy(&x, &buf[read_index], sizeof(x));
+	read_index += sizeof(x);
+	return x;
+}
+
+
+inline int32 BufferInStream::readInt32()
+{
+	if(!canReadNBytes(sizeof(int32)))
+		throw glare::Exception("Read past end of buffer.");
+
+	int32 x;
+	std::memcpy(&x, &buf[read_index], sizeof(x));
+	read_index += sizeof(x);
+	return x;
+}
+
+
+inline uint32 BufferInStream::readUInt32()
+{
+	if(!canReadNBytes(sizeof(uint32)))
+		throw glare::Exception("Read past end of buffer.");
+
+	uint32 x;
+	std::memcpy(&x, &buf[read_index], sizeof(x));
+	read_index += sizeof(x);
+	return x;
+}
+
+
+inline void BufferInStream::readData(void* target_buf, size_t num_bytes)
+{
+	if(num_bytes > 0)
+	{
+		if(!canReadNBytes(num_bytes))
+			throw glare::Exception("Read past end of buffer.");
+
+		std::memcpy(target_buf, &buf[read_index], num_bytes);
+		read_index += num_bytes;
+	}
+}
+
+
+inline bool BufferInStream::canReadNBytes(size_t N) const
+{
+	return ((read_index + N) <= buf.size()) && !Maths::unsignedIntAdditionWraps(read_index, N);
+}
+
+
+
+inline float BufferInStream::readFloat()
+{
+	float x;
+	readData(&x, sizeof(x));
+	return x;
+}
+
+
+inline uint64 BufferInStream::readUInt64()
+{
+	uint64 x;
+	readData(&x, sizeof(x));
+	return x;
+}
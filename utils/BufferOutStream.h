@@ -8,12 +8,17 @@ Copyright Glare Technologies Limited 2023 -
 
 #include "RandomAccessOutStream.h"
 #include "AllocatorVector.h"
+#include "Exception.h"
+#include <cstring> // For std::memcpy
 
 
 /*=====================================================================
 BufferOutStream
 ---------------
 Output stream that writes to a buffer.
+
+The write methods are defined inline below, so that calls made through a
+BufferOutStream reference are devirtualised and inlined.
 =====================================================================*/
 class BufferOutStream final : public RandomAccessOutStream
 {
@@ -35,3 +40,66 @@ public:
 
 	glare::AllocatorVector<unsigned char, 16> buf;
 };
+
+
+inline void BufferOutStream::writeUInt8(uint8 x)
+{
+	try
+	{
+		const size_t pos = buf.size(); // Get position to write to (also current size of buffer)
+		buf.resize(pos + sizeof(x)); // Resize buffer to make room for new uint32
+		std::memcpy(&buf[pos], &x, sizeof(x)); // Copy x to buffer.
+	}
+	catch(std::bad_alloc&)
+	{
+		throw glare::Exception("Memory alloc failure while writing to buffer.");
+	}
+}
+
+
+inline void BufferOutStream::writeInt32(int32 x)
+{
+	try
+	{
+		const size_t pos = buf.size(); // Get position to write to (also current size of buffer)
+		buf.resize(pos + sizeof(x)); // Resize buffer to make room for new uint32
+		std::memcpy(&buf[pos], &x, sizeof(x)); // Copy x to buffer.
+	}
+	catch(std::bad_alloc&)
+	{
+		throw glare::Exception("Memory alloc failure while writing to buffer.");
+	}
+}
+
+
+inline void BufferOutStream::writeUInt32(uint32 x)
+{
+	try
+	{
+		const size_t pos = buf.size(); // Get position to write to (also current size of buffer)
+		buf.resize(pos + sizeof(x)); // Resize buffer to make room for new uint32
+		std::memcpy(&buf[pos], &x, sizeof(x)); // Copy x to buffer.
+	}
+	catch(std::bad_alloc&)
+	{
+		throw glare::Exception("Memory alloc failure while writing to buffer.");
+	}
+}
+
+
+inline void BufferOutStream::writeData(const void* data, size_t num_bytes)
+{
+	if(num_bytes > 0)
+	{
+		try
+		{
+			const size_t pos = buf.size(); // Get position to write to (also current size of buffer)
+			buf.resize(pos + num_bytes); // Resize buffer to make room for new data
+			std::memcpy(&buf[pos], data, num_bytes); // Copy data to buffer.
+		}
+		catch(std::bad_alloc&)
+		{
+			throw glare::Exception("Memory alloc failure while writing to buffer.");
+		}
+	}
+}
@@ -7,6 +7,7 @@ Copyright Glare Technologies Limited 2022 -
 
 
 #include "Exception.h"
+#include "StringUtils.h"
 #include <cstring> // For std::memcpy
 
 
@@ -21,55 +22,12 @@ BufferViewInStream::~BufferViewInStream()
 }
 
 
-int32 BufferViewInStream::readInt32()
-{
-	if(!canReadNBytes(sizeof(int32)))
-		throw glare::Exception("Read past end of buffer.");
-
-	int32 x;
-	std::memcpy(&x, &data.data()[read_index], sizeof(x));
-	read_index += sizeof(x);
-	return x;
-}
-
-
-uint32 BufferViewInStream::readUInt32()
-{
-	if(!canReadNBytes(sizeof(uint32)))
-		throw glare::Exception("Read past end of buffer.");
-
-	uint32 x;
-	std::memcpy(&x, &data.data()[read_index], sizeof(x));
-	read_index += sizeof(x);
-	return x;
-}
-
-
-void BufferViewInStream::readData(void* target_buf, size_t num_bytes)
-{
-	if(num_bytes > 0)
-	{
-		if(!canReadNBytes(num_bytes))
-			throw glare::Exception("Read past end of buffer.");
-
-		std::memcpy(target_buf, &data.data()[read_index], num_bytes);
-		read_index += num_bytes;
-	}
-}
-
-
 bool BufferViewInStream::endOfStream()
 {
 	return read_index >= data.size();
 }
 
 
-bool BufferViewInStream::canReadNBytes(size_t N) const
-{
-	return ((read_index + N) <= data.size()) && !Maths::unsignedIntAdditionWraps(read_index, N);
-}
-
-
 void BufferViewInStream::setReadIndex(size_t i)
 {
 	if(i > data.size())
@@ -86,25 +44,18 @@ void BufferViewInStream::advanceReadIndex(size_t n)
 }
 
 
-uint8 BufferViewInStream::readUInt8()
+const std::string BufferViewInStream::readStringLengthFirst(size_t max_string_length)
 {
-	if(!canReadNBytes(sizeof(uint8)))
-		throw glare::Exception("Read past end of buffer.");
+	// Read string byte size
+	const uint32 size = readUInt32();
+	if((size_t)size > max_string_length)
+		throw glare::Exception("String length too long (length=" + toString(size) + ")");
 
-	uint8 x;
-	std::memcpy(&x, data.data() + read_index, sizeof(x));
-	read_index += sizeof(x);
-	return x;
-}
+	std::string s(size, '\0'); // Use fill constructor
 
+	// Read content
+	if(size > 0)
+		readData(&s[0], size);
 
-uint16 BufferViewInStream::readUInt16()
-{
-	if(!canReadNBytes(sizeof(uint16)))
-		throw glare::Exception("Read past end of file.");
-
-	uint16 x;
-	std::memcpy(&x, data.data() + read_index, sizeof(x));
-	read_index += sizeof(x);
-	return x;
+	return s;
 }
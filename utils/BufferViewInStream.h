@@ -8,6 +8,8 @@ Copyright Glare Technologies Limited 2022 -
 
 #include "RandomAccessInStream.h"
 #include "ArrayRef.h"
+#include "Exception.h"
+#include <cstring> // For std::memcpy
 
 
 /*=====================================================================
@@ -15,6 +17,10 @@ BufferViewInStream
 ------------------
 Input stream that reads from a buffer.
 Just holds a pointer to the buffer.
+
+The commonly used read methods are defined inline below.  Since the class is final,
+calls made through a BufferViewInStream reference (rather than an InStream reference) are
+devirtualised and can be inlined into the caller, e.g. into templated decoders.
 =====================================================================*/
 class BufferViewInStream final : public RandomAccessInStream
 {
@@ -30,6 +36,11 @@ public:
 	uint8 readUInt8();
 	uint16 readUInt16();
 
+	// Same as the InStream methods, but with non-virtual reads.
+	float readFloat();
+	uint64 readUInt64();
+	[[nodiscard]] const std::string readStringLengthFirst(size_t max_string_length);
+
 	// RandomAccessInStream interface:
 	virtual bool canReadNBytes(size_t N) const override;
 	virtual void setReadIndex(size_t i) override;
@@ -44,3 +55,87 @@ private:
 	ArrayRef<uint8> data;
 	size_t read_index;
 };
+
+
+inline int32 BufferViewInStream::readInt32()
+{
+	if(!canReadNBytes(sizeof(int32)))
+		throw glare::Exception("Read past end of buffer.");
+
+	int32 x;
+	std::memcpy(&x, &data.data()[read_index], sizeof(x));
+	read_index += sizeof(x);
+	return x;
+}
+
+
+inline uint32 BufferViewInStream::readUInt32()
+{
+	if(!canReadNBytes(sizeof(uint32)))
+		throw glare::Exception("Read past end of buffer.");
+
+	uint32 x;
+	std::memcpy(&x, &data.data()[read_index], sizeof(x));
+	read_index += sizeof(x);
+	return x;
+}
+
+
+inline void BufferViewInStream::readData(void* target_buf, size_t num_bytes)
+{
+	if(num_bytes > 0)
+	{
+		if(!canReadNBytes(num_bytes))
+			throw glare::Exception("Read past end of buffer.");
+
+		std::memcpy(target_buf, &data.data()[read_index], num_bytes);
+		read_index += num_bytes;
+	}
+}
+
+
+inline bool BufferViewInStream::canReadNBytes(size_t N) const
+{
+	return ((read_index + N) <= data.size()) && !Maths::unsignedIntAdditionWraps(read_index, N);
+}
+
+
+inline uint8 BufferViewInStream::readUInt8()
+{
+	if(!canReadNBytes(sizeof(uint8)))
+		throw glare::Exception("Read past end of buffer.");
+
+	uint8 x;
+	std::memcpy(&x, data.data() + read_index, sizeof(x));
+	read_index += sizeof(x);
+	return x;
+}
+
+
+inline uint16 BufferViewInStream::readUInt16()
+{
+	if(!canReadNBytes(sizeof(uint16)))
+		throw glare::Exception("Read past end of file.");
+
+	uint16 x;
+	std::memcpy(&x, data.data() + read_index, sizeof(x));
+	read_index += sizeof(x);
+	return x;
+}
+
+
+
+inline float BufferViewInStream::readFloat()
+{
+	float x;
+	readData(&x, sizeof(x));
+	return x;
+}
+
+
+inline uint64 BufferViewInStream::readUInt64()
+{
+	uint64 x;
+	readData(&x, sizeof(x));
+	return x;
+}
@@ -482,6 +482,163 @@ static void testRadixSort32BitKey()
 }
 
 
+struct KeyAndIndex
+{
+	uint64 key;
+	uint32 index; // Index in the original array, for checking stability.
+};
+
+struct KeyAndIndexGetKey32
+{
+	inline uint32 operator () (const KeyAndIndex& x) const { return (uint32)x.key; }
+};
+
+struct KeyAndIndexGetKey64
+{
+	inline uint64 operator () (const KeyAndIndex& x) const { return x.key; }
+};
+
+struct KeyAndIndexLessThan32
+{
+	inline bool operator () (const KeyAndIndex& a, const KeyAndIndex& b) const { return (uint32)a.key < (uint32)b.key; }
+};
+
+struct KeyAndIndexLessThan64
+{
+	inline bool operator () (const KeyAndIndex& a, const KeyAndIndex& b) const { return a.key < b.key; }
+};
+
+struct UInt64GetKey
+{
+	inline uint64 operator () (const uint64 x) const { return x; }
+};
+
+
+// Check parallelRadixSort32BitKey and parallelRadixSort64BitKey give the same results as std::stable_sort.
+// key_mask is used to test keys where some passes can be skipped.
+static void testParallelRadixSortForNumItems(glare::TaskManager& task_manager, size_t N, uint64 key_mask, js::Vector<uint32, 16>& temp_counts)
+{
+	PCG32 rng(1);
+	std::vector<KeyAndIndex> original(N);
+	for(size_t i=0; i<N; ++i)
+	{
+		original[i].key = (((uint64)rng.genrand_int32() << 32) | rng.genrand_int32()) & key_mask;
+		original[i].index = (uint32)i;
+	}
+	std::vector<KeyAndIndex> working_space(N);
+
+	// 32-bit keys
+	{
+		std::vector<KeyAndIndex> data = original;
+		parallelRadixSort32BitKey(task_manager, data.data(), working_space.data(), N, KeyAndIndexGetKey32(), temp_counts);
+
+		std::vector<KeyAndIndex> ref = original;
+		std::stable_sort(ref.begin(), ref.end(), KeyAndIndexLessThan32());
+		for(size_t i=0; i<N; ++i)
+			testAssert(data[i].index == ref[i].index);
+	}
+
+	// 64-bit keys
+	{
+		std::vector<KeyAndIndex> data = original;
+		parallelRadixSort64BitKey(task_manager, data.data(), working_space.data(), N, KeyAndIndexGetKey64(), temp_counts);
+
+		std::vector<KeyAndIndex> ref = original;
+		std::stable_sort(ref.begin(), ref.end(), KeyAndIndexLessThan64());
+		for(size_t i=0; i<N; ++i)
+			testAssert(data[i].index == ref[i].index);
+	}
+}
+
+
+static void testParallelRadixSort()
+{
+	conPrint("testParallelRadixSort()");
+
+	js::Vector<uint32, 16> temp_counts;
+	for(size_t num_threads=0; num_threads<=4; num_threads += 2)
+	{
+		glare::TaskManager task_manager(num_threads);
+		const size_t sizes[] = { 0, 1, 2, 100, 2047, 2049, 100000, 300001 };
+		for(size_t i=0; i<staticArrayNumElems(sizes); ++i)
+		{
+			testParallelRadixSortForNumItems(task_manager, sizes[i], /*key mask=*/0xFFFFFFFFFFFFFFFFull, temp_counts);
+			testParallelRadixSortForNumItems(task_manager, sizes[i], /*key mask=*/0x00000000000FFFFFull, temp_counts); // Only the first 2 passes are needed.
+			testParallelRadixSortForNumItems(task_manager, sizes[i], /*key mask=*/0xFFF0000000000003ull, temp_counts); // Passes in the middle can be skipped.
+			testParallelRadixSortForNumItems(task_manager, sizes[i], /*key mask=*/0, temp_counts); // All passes can be skipped.
+		}
+	}
+
+	// Scaling benchmark, 32-bit and 64-bit keys, serial vs parallel.
+	{
+		glare::TaskManager task_manager;
+		conPrint("Parallel radix sort benchmark (" + toString(task_manager.getConcurrency()) + " tasks)");
+
+		const size_t sizes[] = { 10000, 100000, 1000000 }; // Add larger sizes, e.g. 10000000 and 50000000, to benchmark scaling on large inputs.
+		for(size_t i=0; i<staticArrayNumElems(sizes); ++i)
+		{
+			const size_t N = sizes[i];
+			const int num_trials = (N <= 1000000) ? 10 : 2;
+
+			PCG32 rng(1);
+			{
+				std::vector<uint32> original(N);
+				for(size_t z=0; z<N; ++z)
+					original[z] = rng.genrand_int32();
+				std::vector<uint32> data(N);
+				std::vector<uint32> working_space(N);
+				std::vector<uint32> serial_temp_counts(6144);
+
+				double serial_time = 1.0e10;
+				double parallel_time = 1.0e10;
+				for(int t=0; t<num_trials; ++t)
+				{
+					data = original;
+					Timer timer;
+					radixSort32BitKey(data.data(), working_space.data(), N, UInt32GetKey(), serial_temp_counts.data(), serial_temp_counts.size());
+					serial_time = myMin(serial_time, timer.elapsed());
+
+					data = original;
+					timer.reset();
+					parallelRadixSort32BitKey(task_manager, data.data(), working_space.data(), N, UInt32GetKey(), temp_counts);
+					parallel_time = myMin(parallel_time, timer.elapsed());
+				}
+				for(size_t z=1; z<N; ++z)
+					testAssert(data[z - 1] <= data[z]);
+
+				conPrint("N: " + toString(N) + ", 32-bit keys: radixSort32BitKey: " + doubleToStringNSigFigs(1.0e-6 * N / serial_time, 4) + " M keys/s, parallelRadixSort32BitKey: " + 
+					doubleToStringNSigFigs(1.0e-6 * N / parallel_time, 4) + " M keys/s (" + doubleToStringNSigFigs(serial_time / parallel_time, 3) + "x)");
+			}
+			{
+				std::vector<uint64> original(N);
+				for(size_t z=0; z<N; ++z)
+					original[z] = ((uint64)rng.genrand_int32() << 32) | rng.genrand_int32();
+				std::vector<uint64> data(N);
+				std::vector<uint64> working_space(N);
+
+				double parallel_time = 1.0e10;
+				double std_sort_time = 1.0e10;
+				for(int t=0; t<num_trials; ++t)
+				{
+					data = original;
+					Timer timer;
+					parallelRadixSort64BitKey(task_manager, data.data(), working_space.data(), N, UInt64GetKey(), temp_counts);
+					parallel_time = myMin(parallel_time, timer.elapsed());
+
+					data = original;
+					timer.reset();
+					std::sort(data.begin(), data.end());
+					std_sort_time = myMin(std_sort_time, timer.elapsed());
+				}
+
+				conPrint("N: " + toString(N) + ", 64-bit keys: std::sort: " + doubleToStringNSigFigs(1.0e-6 * N / std_sort_time, 4) + " M keys/s, parallelRadixSort64BitKey: " + 
+					doubleToStringNSigFigs(1.0e-6 * N / parallel_time, 4) + " M keys/s (" + doubleToStringNSigFigs(std_sort_time / parallel_time, 3) + "x)");
+			}
+		}
+	}
+}
+
+
 void test()
 {
 	conPrint("Sort::test()");
@@ -492,6 +649,8 @@ void test()
 
 
 	testRadixSort32BitKey();
+
+	testParallelRadixSort();
 	
 	//const uint32 N = 5000000;
 
@@ -44,6 +44,21 @@ namespace Sort
 	template<class T, class GetKey>
 	inline void radixSort32BitKey(T* __restrict data, T* __restrict working_space, size_t num_items, GetKey getKey, uint32* temp_counts, size_t temp_counts_size);
 
+	/*
+	Parallel, stable, LSD radix sorts with 11-bit digits.
+	Each pass counts the items in each bucket for each task's range of items, prefix sums the counts so that each task has its own write position in each bucket,
+	then scatters the items in parallel.  Passes where all keys have the same digit are skipped.
+	The sorted items are left in data.  working_space should have at least num_items elements.
+	temp_counts is resized as needed, and can be reused between sorts to avoid allocations.
+	For small numbers of items, or if the task manager has no threads, the sort is just done on the calling thread.
+	GetKey operator () should return a uint32 integer for parallelRadixSort32BitKey, and a uint64 integer for parallelRadixSort64BitKey.
+	*/
+	template<class T, class GetKey>
+	inline void parallelRadixSort32BitKey(glare::TaskManager& task_manager, T* data, T* working_space, size_t num_items, GetKey getKey, js::Vector<uint32, 16>& temp_counts);
+
+	template<class T, class GetKey>
+	inline void parallelRadixSort64BitKey(glare::TaskManager& task_manager, T* data, T* working_space, size_t num_items, GetKey getKey, js::Vector<uint32, 16>& temp_counts);
+
 	/*
 	Counting sorts.  Efficient for when the total number of different buckets/keys is relatively small.
 	*/
@@ -955,4 +970,240 @@ namespace Sort
 			data[i] = working_space[i];
 	}
 
+
+	template <class T, class GetKey>
+	class RadixSortCountTask : public glare::Task
+	{
+	public:
+		RadixSortCountTask(GetKey getKey_, size_t begin_, size_t end_, uint32* counts_) : getKey(getKey_), begin(begin_), end(end_), counts(counts_) {}
+
+		virtual void run(size_t thread_index)
+		{
+			const T* const in_ = in;
+			uint32* const counts_ = counts;
+			const int shift = shift_amount;
+
+			for(size_t i=0; i<(1 << 11); ++i)
+				counts_[i] = 0;
+
+			for(size_t i=begin; i<end; ++i)
+				counts_[BitUtils::getLowestNBits((uint64)getKey(in_[i]) >> shift, 11)]++;
+		}
+
+		GetKey getKey;
+		size_t begin, end;
+		uint32* counts;
+		const T* in;
+		int shift_amount;
+	};
+
+
+	template <class T, class GetKey>
+	class RadixSortScatterTask : public glare::Task
+	{
+	public:
+		RadixSortScatterTask(GetKey getKey_, size_t begin_, size_t end_, uint32* bucket_write_i_) : getKey(getKey_), begin(begin_), end(end_), bucket_write_i(bucket_write_i_) {}
+
+		virtual void run(size_t thread_index)
+		{
+			const T* const in_ = in;
+			T* const out_ = out;
+			uint32* const bucket_write_i_ = bucket_write_i;
+			const int shift = shift_amount;
+
+			for(size_t i=begin; i<end; ++i)
+			{
+				const T val = in_[i];
+				out_[bucket_write_i_[BitUtils::getLowestNBits((uint64)getKey(val) >> shift, 11)]++] = val;
+			}
+		}
+
+		GetKey getKey;
+		size_t begin, end;
+		uint32* bucket_write_i;
+		const T* in;
+		T* out;
+		int shift_amount;
+	};
+
+
+	template <class T>
+	class RadixSortCopyTask : public glare::Task
+	{
+	public:
+		RadixSortCopyTask(const T* in_, T* out_, size_t begin_, size_t end_) : in(in_), out(out_), begin(begin_), end(end_) {}
+
+		virtual void run(size_t thread_index)
+		{
+			for(size_t i=begin; i<end; ++i)
+				out[i] = in[i];
+		}
+
+		const T* in;
+		T* out;
+		size_t begin, end;
+	};
+
+
+	// Serial version of parallelRadixSort() below.
+	// Since the counts for the whole array don't depend on the order of the items, the counts for all passes can be computed in a single pass over the data.
+	template<class T, class GetKey>
+	void serialRadixSortWithPassSkipping(T* data, T* working_space, size_t num_items, GetKey getKey, int num_key_bits, js::Vector<uint32, 16>& temp_counts)
+	{
+		const int radix_bits = 11;
+		const size_t num_buckets = 1 << radix_bits;
+		const int num_passes = (num_key_bits + radix_bits - 1) / radix_bits;
+
+		temp_counts.resizeNoCopy(num_passes * num_buckets);
+		for(size_t i=0; i<num_passes * num_buckets; ++i)
+			temp_counts[i] = 0;
+
+		uint32* const counts = temp_counts.data();
+		for(size_t i=0; i<num_items; ++i)
+		{
+			const uint64 key = getKey(data[i]);
+			for(int p=0; p<num_passes; ++p)
+				counts[p * num_buckets + BitUtils::getLowestNBits(key >> (p * radix_bits), radix_bits)]++;
+		}
+
+		T* src = data;
+		T* dst = working_space;
+		for(int p=0; p<num_passes; ++p)
+		{
+			uint32* const pass_counts = counts + p * num_buckets;
+
+			// Compute exclusive prefix sum
+			uint32 sum = 0;
+			bool all_in_one_bucket = false;
+			for(size_t b=0; b<num_buckets; ++b)
+			{
+				const uint32 count = pass_counts[b];
+				pass_counts[b] = sum;
+				sum += count;
+				if(count == num_items)
+					all_in_one_bucket = true;
+			}
+
+			if(all_in_one_bucket) // If all keys have the same digit for this pass, the pass would not change the order, so skip it.
+				continue;
+
+			const int shift = p * radix_bits;
+			for(size_t i=0; i<num_items; ++i)
+			{
+				const T val = src[i];
+				dst[pass_counts[BitUtils::getLowestNBits((uint64)getKey(val) >> shift, radix_bits)]++] = val;
+			}
+
+			mySwap(src, dst);
+		}
+
+		if(src != data)
+			for(size_t i=0; i<num_items; ++i)
+				data[i] = working_space[i];
+	}
+
+
+	template<class T, class GetKey>
+	void parallelRadixSort(glare::TaskManager& task_manager, T* data, T* working_space, size_t num_items, GetKey getKey, int num_key_bits, js::Vector<uint32, 16>& temp_counts)
+	{
+		assert(num_items <= std::numeric_limits<uint32>::max());
+
+		const int radix_bits = 11;
+		const size_t num_buckets = 1 << radix_bits;
+		const size_t count_padding = 32; // Pad the counts for each task to avoid false sharing.  See parallelStableNWayPartition().
+		const size_t stride = num_buckets + count_padding;
+
+		// Give each task a reasonable amount of work, since each pass has some fixed costs per task (zeroing counts, and the prefix sum).
+		const size_t min_items_per_task = 1 << 15;
+		const size_t num_tasks = myMax<size_t>(1, myMin(task_manager.getConcurrency(), num_items / min_items_per_task));
+		const size_t items_per_task = Maths::roundedUpDivide(num_items, num_tasks);
+
+		if(num_tasks == 1)
+		{
+			serialRadixSortWithPassSkipping(data, working_space, num_items, getKey, num_key_bits, temp_counts);
+			return;
+		}
+
+		temp_counts.resizeNoCopy(num_tasks * stride);
+
+		glare::TaskGroupRef count_group   = new glare::TaskGroup();
+		glare::TaskGroupRef scatter_group = new glare::TaskGroup();
+		count_group  ->tasks.resize(num_tasks);
+		scatter_group->tasks.resize(num_tasks);
+		for(size_t t=0; t<num_tasks; ++t)
+		{
+			const size_t begin = myMin(num_items, t       * items_per_task);
+			const size_t end   = myMin(num_items, (t + 1) * items_per_task);
+			count_group  ->tasks[t] = new RadixSortCountTask  <T, GetKey>(getKey, begin, end, &temp_counts[t * stride]);
+			scatter_group->tasks[t] = new RadixSortScatterTask<T, GetKey>(getKey, begin, end, &temp_counts[t * stride]);
+		}
+
+		T* src = data;
+		T* dst = working_space;
+		for(int shift=0; shift<num_key_bits; shift += radix_bits)
+		{
+			for(size_t t=0; t<num_tasks; ++t)
+			{
+				RadixSortCountTask<T, GetKey>* task = static_cast<RadixSortCountTask<T, GetKey>*>(count_group->tasks[t].ptr());
+				task->in = src;
+				task->shift_amount = shift;
+			}
+			task_manager.runTaskGroup(count_group);
+
+			// Compute the exclusive prefix sum over buckets, and over tasks within each bucket, which gives the write position for each task in each bucket.
+			// Items are written in task order within each bucket, which keeps the sort stable.
+			uint32 sum = 0;
+			bool all_in_one_bucket = false;
+			for(size_t b=0; b<num_buckets; ++b)
+			{
+				const uint32 bucket_begin = sum;
+				for(size_t t=0; t<num_tasks; ++t)
+				{
+					const uint32 count = temp_counts[t * stride + b];
+					temp_counts[t * stride + b] = sum;
+					sum += count;
+				}
+				if(sum - bucket_begin == num_items)
+					all_in_one_bucket = true;
+			}
+
+			if(all_in_one_bucket) // If all keys have the same digit for this pass, the pass would not change the order, so skip it.
+				continue;
+
+			for(size_t t=0; t<num_tasks; ++t)
+			{
+				RadixSortScatterTask<T, GetKey>* task = static_cast<RadixSortScatterTask<T, GetKey>*>(scatter_group->tasks[t].ptr());
+				task->in = src;
+				task->out = dst;
+				task->shift_amount = shift;
+			}
+			task_manager.runTaskGroup(scatter_group);
+
+			mySwap(src, dst);
+		}
+
+		if(src != data) // If the result of the last pass is in working_space, copy it back to data.
+		{
+			glare::TaskGroupRef copy_group = new glare::TaskGroup();
+			copy_group->tasks.resize(num_tasks);
+			for(size_t t=0; t<num_tasks; ++t)
+				copy_group->tasks[t] = new RadixSortCopyTask<T>(working_space, data, myMin(num_items, t * items_per_task), myMin(num_items, (t + 1) * items_per_task));
+			task_manager.runTaskGroup(copy_group);
+		}
+	}
+
+
+	template<class T, class GetKey>
+	void parallelRadixSort32BitKey(glare::TaskManager& task_manager, T* data, T* working_space, size_t num_items, GetKey getKey, js::Vector<uint32, 16>& temp_counts)
+	{
+		parallelRadixSort(task_manager, data, working_space, num_items, getKey, /*num key bits=*/32, temp_counts);
+	}
+
+
+	template<class T, class GetKey>
+	void parallelRadixSort64BitKey(glare::TaskManager& task_manager, T* data, T* working_space, size_t num_items, GetKey getKey, js::Vector<uint32, 16>& temp_counts)
+	{
+		parallelRadixSort(task_manager, data, working_space, num_items, getKey, /*num key bits=*/64, temp_counts);
+	}
+
 } // end namespace Sort
@@ -51,7 +51,12 @@ public:
 
 	virtual void handleRequest(const RequestInfo& request_info, ReplyInfo& reply_info) = 0;
 
+	// If getWebSocketDeflateParams() returns params with enabled = true, socket is a WebSocket, with permessage-deflate already enabled if it was agreed 
+	// in the handshake, so should be used directly rather than wrapped in another WebSocket.  Otherwise socket is the underlying connection.
 	virtual void handleWebSocketConnection(const RequestInfo& /*request_info*/, Reference<SocketInterface>& /*socket*/) { throw glare::Exception("Not handling websocket connections"); }
+
+	// Server preferences for the websocket permessage-deflate extension.  Return params with enabled = true to accept client offers of the extension.
+	virtual WebSocketDeflateParams getWebSocketDeflateParams() { return WebSocketDeflateParams(); }
 };
 
 
@@ -7,6 +7,7 @@ Copyright Glare Technologies Limited 2021 -
 
 
 #include <networking/IPAddress.h>
+#include <networking/WebSocket.h>
 #include <UnsafeString.h>
 #include <utils/Reference.h>
 #include <utils/ThreadSafeRefCounted.h>
@@ -107,6 +108,9 @@ public:
 	bool deflate_accept_encoding;
 	bool zstd_accept_encoding;
 
+	// permessage-deflate params negotiated in the websocket handshake.  If enabled, the socket passed to RequestHandler::handleWebSocketConnection() is a WebSocket with deflate already enabled.
+	WebSocketDeflateParams websocket_deflate_params;
+
 	IPAddress client_ip_address;
 	bool tls_connection;
 
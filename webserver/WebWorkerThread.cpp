@@ -18,6 +18,7 @@ Copyright Glare Technologies Limited 2024 -
 #include <Base64.h>
 #include <Exception.h>
 #include <networking/MySocket.h>
+#include <networking/WebSocket.h>
 #include <Lock.h>
 #include <StringUtils.h>
 #include <PlatformUtils.h>
@@ -277,6 +278,7 @@ WorkerThread::HandleRequestResult WorkerThread::handleSingleRequest(size_t reque
 
 	std::string websocket_key;
 	std::string websocket_protocol;
+	std::string websocket_extensions;
 	std::string encoded_websocket_reply_key;
 	std::string content_type;
 	std::string multipart_form_data_boundary;
@@ -418,6 +420,13 @@ WorkerThread::HandleRequestResult WorkerThread::handleSingleRequest(size_t reque
 		{
 			websocket_protocol = toString(field_value);
 		}
+		else if(StringUtils::equalCaseInsensitive(field_name, "sec-websocket-extensions"))
+		{
+			// The header may occur multiple times, which is equivalent to a single header with comma-separated values.
+			if(!websocket_extensions.empty())
+				websocket_extensions += ", ";
+			websocket_extensions += toString(field_value);
+		}
 		else if(StringUtils::equalCaseInsensitive(field_name, "upgrade"))
 		{
 			// For websockets:
@@ -445,12 +454,17 @@ WorkerThread::HandleRequestResult WorkerThread::handleSingleRequest(size_t reque
 	// Do websockets handshake
 	if(!encoded_websocket_reply_key.empty())
 	{
+		const WebSocketDeflateParams server_deflate_prefs = request_handler->getWebSocketDeflateParams();
+		if(!websocket_extensions.empty())
+			request_info.websocket_deflate_params = WebSocketDeflateParams::negotiateFromClientOffers(websocket_extensions, server_deflate_prefs);
+
 		const std::string response = ""
 			"HTTP/1.1 101 Switching Protocols\r\n"
 			"Upgrade: websocket\r\n"
 			"Connection: Upgrade\r\n"
 			"Sec-WebSocket-Accept: " + encoded_websocket_reply_key + "\r\n"
-			"Sec-WebSocket-Protocol: " + websocket_protocol + "\r\n"
+			"Sec-WebSocket-Protocol: " + websocket_protocol + "\r\n" + 
+			(request_info.websocket_deflate_params.enabled ? ("Sec-WebSocket-Extensions: " + request_info.websocket_deflate_params.toExtensionHeaderValue() + "\r\n") : std::string()) +
 			"Cache-Control: no-cache\r\n"
 			"Pragma:no-cache\r\n"
 			"\r\n";
@@ -460,7 +474,7 @@ WorkerThread::HandleRequestResult WorkerThread::handleSingleRequest(size_t reque
 		// Advance request_start_index to point to after end of this post body.
 		request_start_index += request_header_size; // TODO: skip over content as well (if content length > 0)?
 
-		handleWebsocketConnection(request_info); // May throw exception
+		handleWebsocketConnection(request_info, /*wrap_in_web_socket=*/server_deflate_prefs.enabled); // May throw exception
 
 		return HandleRequestResult_ConnectionHandledElsewhere;
 	}
@@ -735,13 +749,24 @@ static void moveToFrontOfBufferAndTrimBuffer(std::vector<uint8>& socket_buffer,
 }
 
 
-void WorkerThread::handleWebsocketConnection(RequestInfo& request_info)
+void WorkerThread::handleWebsocketConnection(RequestInfo& request_info, bool wrap_in_web_socket)
 {
 	if(VERBOSE) conPrint("WorkerThread: Connection upgraded to websocket connection.");
 
 	socket->enableTCPKeepAlive(30.0f); // Keep alive the connection.
 
-	this->request_handler->handleWebSocketConnection(request_info, socket);
+	// Handlers that accept permessage-deflate get a WebSocket, with compression enabled if the extension was agreed in the handshake, 
+	// since the extension applies from the first message after the handshake.
+	// The socket member is left as the underlying connection, so kill() can still shut it down.
+	Reference<SocketInterface> handler_socket = socket;
+	if(wrap_in_web_socket)
+	{
+		WebSocketRef web_socket = new WebSocket(socket);
+		web_socket->enableDeflate(request_info.websocket_deflate_params, /*is_server=*/true);
+		handler_socket = web_socket;
+	}
+
+	this->request_handler->handleWebSocketConnection(request_info, handler_socket);
 }
 
 
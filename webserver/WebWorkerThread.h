@@ -56,7 +56,7 @@ public:
 
 	void doRunMainLoop();
 private:
-	void handleWebsocketConnection(RequestInfo& request_info);
+	void handleWebsocketConnection(RequestInfo& request_info, bool wrap_in_web_socket);
 	
 	// Returns if should keep connection alive
 	enum HandleRequestResult